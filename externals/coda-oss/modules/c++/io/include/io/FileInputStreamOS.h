@@ -170,6 +170,20 @@ protected:
      *
      */
     virtual sys::SSize_T readImpl(void* buffer, size_t len);
+
+    /*!
+     * Read up to len bytes of data starting at offset, without moving the
+     * current offset
+     *
+     * \param offset Byte offset from the start of the file
+     * \param buffer Buffer to read into
+     * \param len The length to read
+     * \throw except::IOException
+     * \return  The number of bytes read, or -1 if EOF
+     */
+    virtual sys::SSize_T readAtImpl(sys::Off_T offset,
+                                    void* buffer,
+                                    size_t len);
 };
 }
 
@@ -27,6 +27,7 @@
 #include "io/OutputStream.h"
 #include "io/BidirectionalStream.h"
 #include "io/Seekable.h"
+#include "sys/Mutex.h"
 
 /*!
  *  \file
@@ -50,6 +51,48 @@ public:
     virtual ~SeekableInputStream()
     {}
     using InputStream::streamTo;
+
+    /*!
+     * Read up to len bytes of data, starting at offset bytes from the start
+     * of the stream, like pread().  Streams that can read without seeking
+     * (such as files) leave the current offset alone, so several threads
+     * may call this concurrently on the same stream.  Other streams fall
+     * back to seeking and reading under a lock, then seeking back, which is
+     * safe among calls to readAt() but not alongside seek() or read() calls
+     * in other threads.
+     *
+     * \param offset Byte offset from the start of the stream
+     * \param buffer Buffer to read into
+     * \param len The length to read
+     * \param verifyFullRead If set to true, checks to see if 'len' bytes
+     * were read and, if not, throws.  Defaults to false.
+     * \throw IOException
+     * \return  The number of bytes read, or -1 if offset is at or past EOF.
+     * If 'verifyFullRead' is true, this will always return 'len' bytes if it
+     * didn't throw.
+     */
+    sys::SSize_T readAt(sys::Off_T offset,
+                        void* buffer,
+                        size_t len,
+                        bool verifyFullRead = false);
+
+protected:
+    /*!
+     * Read up to len bytes of data starting at offset.  By default, this
+     * seeks to offset, reads, and seeks back.
+     *
+     * \param offset Byte offset from the start of the stream
+     * \param buffer Buffer to read into
+     * \param len The length to read
+     * \throw IOException
+     * \return  The number of bytes read, or -1 if EOF
+     */
+    virtual sys::SSize_T readAtImpl(sys::Off_T offset,
+                                    void* buffer,
+                                    size_t len);
+
+private:
+    sys::Mutex mReadAtMutex;
 };
 
 class SeekableOutputStream :
@@ -56,4 +56,18 @@ sys::SSize_T io::FileInputStreamOS::readImpl(void* buffer, size_t len)
     return static_cast<sys::SSize_T>(len);
 }
 
+sys::SSize_T io::FileInputStreamOS::readAtImpl(sys::Off_T offset,
+                                               void* buffer,
+                                               size_t len)
+{
+    const sys::Off_T fileLength = mFile.length();
+    if (offset >= fileLength)
+        return io::InputStream::IS_EOF;
+    if (len > static_cast<sys::Size_T>(fileLength - offset))
+        len = static_cast<sys::Size_T>(fileLength - offset);
+
+    mFile.readAt(offset, buffer, len);
+    return static_cast<sys::SSize_T>(len);
+}
+
 #endif
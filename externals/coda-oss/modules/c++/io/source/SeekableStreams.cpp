@@ -0,0 +1,77 @@
+/* =========================================================================
+ * This file is part of io-c++ 
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <sstream>
+
+#include <except/Exception.h>
+#include <io/SeekableStreams.h>
+
+namespace io
+{
+sys::SSize_T SeekableInputStream::readAt(sys::Off_T offset,
+                                         void* buffer,
+                                         size_t len,
+                                         bool verifyFullRead)
+{
+    const sys::SSize_T numBytes = readAtImpl(offset, buffer, len);
+    if (verifyFullRead)
+    {
+        if (numBytes == -1)
+        {
+            std::ostringstream ostr;
+            ostr << "Tried to read " << len << " bytes at offset " << offset
+                 << " but read failed";
+            throw except::IOException(Ctxt(ostr.str()));
+        }
+        else if (numBytes != static_cast<sys::SSize_T>(len))
+        {
+            std::ostringstream ostr;
+            ostr << "Tried to read " << len << " bytes at offset " << offset
+                 << " but only read " << numBytes << " bytes";
+            throw except::IOException(Ctxt(ostr.str()));
+        }
+    }
+
+    return numBytes;
+}
+
+sys::SSize_T SeekableInputStream::readAtImpl(sys::Off_T offset,
+                                             void* buffer,
+                                             size_t len)
+{
+    mReadAtMutex.lock();
+    try
+    {
+        const sys::Off_T previous = tell();
+        seek(offset, START);
+        const sys::SSize_T numBytes = read(buffer, len);
+        seek(previous, START);
+        mReadAtMutex.unlock();
+        return numBytes;
+    }
+    catch (...)
+    {
+        mReadAtMutex.unlock();
+        throw;
+    }
+}
+}
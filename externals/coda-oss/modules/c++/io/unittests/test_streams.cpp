@@ -93,6 +93,42 @@ TEST_CASE(testByteStream)
     TEST_ASSERT_EQ(std::string(buf), "test");
 }
 
+TEST_CASE(testReadAt)
+{
+    const std::string outFile = "test_read_at.txt";
+    {
+        io::FileOutputStream out(outFile);
+        out.write("0123456789");
+    }
+
+    io::FileInputStream fileStream(outFile);
+    io::ByteStream byteStream;
+    byteStream.write("0123456789");
+
+    io::SeekableInputStream* const streams[] = {&fileStream, &byteStream};
+    for (size_t ii = 0; ii < 2; ++ii)
+    {
+        // Reading at an offset doesn't move the stream
+        io::SeekableInputStream& stream = *streams[ii];
+        stream.seek(2, io::Seekable::START);
+        sys::byte buf[255];
+        TEST_ASSERT_EQ(stream.readAt(6, buf, 3), 3);
+        TEST_ASSERT_EQ(std::string(buf, 3), "678");
+        TEST_ASSERT_EQ(stream.tell(), 2);
+
+        TEST_ASSERT_EQ(stream.readAt(8, buf, 5), 2);
+        TEST_ASSERT_EQ(std::string(buf, 2), "89");
+        TEST_ASSERT_EQ(stream.readAt(10, buf, 1), io::InputStream::IS_EOF);
+        TEST_EXCEPTION(stream.readAt(8, buf, 5, true));
+
+        stream.read(buf, 2);
+        TEST_ASSERT_EQ(std::string(buf, 2), "23");
+    }
+
+    fileStream.close();
+    sys::OS().remove(outFile);
+}
+
 TEST_CASE(testProxyOutputStream)
 {
     io::StringStream stream;
@@ -300,6 +336,7 @@ int main(int, char**)
 {
     TEST_CHECK(testStringStream);
     TEST_CHECK(testByteStream);
+    TEST_CHECK(testReadAt);
     TEST_CHECK(testProxyOutputStream);
     TEST_CHECK(testCountingOutputStream);
     TEST_CHECK(testBufferViewStream);
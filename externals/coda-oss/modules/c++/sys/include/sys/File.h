@@ -180,6 +180,21 @@ public:
      */
     void readInto(void* buffer, size_t size);
 
+    /*!
+     *  Read 'size' bytes from the File into a buffer, starting at
+     *  'offset' bytes from the start of the file rather than at the
+     *  current offset.  Blocks.
+     *  Since no seek is needed, several threads may call this
+     *  concurrently on the same File.  The current offset is left alone.
+     *  If size is 0, no OS level read operation occurs.
+     *  If offset + size is > length of file, an exception occurs.
+     *
+     *  \param offset The offset from the start of the file
+     *  \param buffer The buffer to put to
+     *  \param size The number of bytes
+     */
+    void readAt(sys::Off_T offset, void* buffer, size_t size);
+
     /*!
      *  Write from a buffer 'size' bytes into the 
      *  file.
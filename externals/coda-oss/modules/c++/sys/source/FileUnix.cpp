@@ -92,6 +92,46 @@ void sys::File::readInto(void* buffer, Size_T size)
     throw sys::SystemException(Ctxt("Unknown read state"));
 }
 
+void sys::File::readAt(sys::Off_T offset, void* buffer, size_t size)
+{
+    size_t totalBytesRead = 0;
+    sys::byte* bufferPtr = static_cast<sys::byte*>(buffer);
+
+    for (int i = 1; i <= _SYS_MAX_READ_ATTEMPTS && totalBytesRead < size; i++)
+    {
+        const ssize_t bytesRead = ::pread(mHandle,
+                                          bufferPtr + totalBytesRead,
+                                          size - totalBytesRead,
+                                          offset + totalBytesRead);
+
+        switch (bytesRead)
+        {
+        case -1: /* Some type of error occured */
+            switch (errno)
+            {
+            case EINTR:
+            case EAGAIN: /* A non-fatal error occured, keep trying */
+                break;
+
+            default: /* We failed */
+                throw sys::SystemException(Ctxt("While reading from file"));
+            }
+            break;
+
+        case 0: /* EOF (unexpected) */
+            throw sys::SystemException(Ctxt("Unexpected end of file"));
+
+        default: /* We made progress */
+            totalBytesRead += bytesRead;
+        }
+    }
+
+    if (totalBytesRead != size)
+    {
+        throw sys::SystemException(Ctxt("Unknown read state"));
+    }
+}
+
 void sys::File::writeFrom(const void* buffer, size_t size)
 {
     size_t bytesActuallyWritten = 0;
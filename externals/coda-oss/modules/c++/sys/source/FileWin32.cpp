@@ -22,6 +22,7 @@
 
 #ifdef WIN32
 
+#include <string.h>
 #include <limits>
 #include <cmath>
 #include "sys/File.h"
@@ -91,6 +92,103 @@ void sys::File::readInto(void* buffer, size_t size)
     }
 }
 
+namespace
+{
+// Closes a handle that readAt() opened for itself
+class ScopedHandle
+{
+public:
+    explicit ScopedHandle(HANDLE handle) :
+        mHandle(handle)
+    {
+    }
+
+    ~ScopedHandle()
+    {
+        CloseHandle(mHandle);
+    }
+
+    HANDLE get() const
+    {
+        return mHandle;
+    }
+
+private:
+    ScopedHandle(const ScopedHandle& );
+    ScopedHandle& operator=(const ScopedHandle& );
+
+    const HANDLE mHandle;
+};
+}
+
+void sys::File::readAt(sys::Off_T offset, void* buffer, size_t size)
+{
+    static const size_t MAX_READ_SIZE = std::numeric_limits<DWORD>::max();
+    if (size == 0)
+    {
+        return;
+    }
+
+    // ReadFile() on a synchronous handle moves its file pointer even when
+    // it's given an offset.  Read through a separate overlapped handle
+    // instead: it has no file pointer of its own, and it leaves mHandle's
+    // alone, so concurrent seek() and read() calls are unaffected.
+    const ScopedHandle handle(ReOpenFile(mHandle,
+                                         GENERIC_READ,
+                                         FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                         FILE_FLAG_OVERLAPPED));
+    if (handle.get() == INVALID_HANDLE_VALUE)
+    {
+        throw sys::SystemException(Ctxt("Error reopening file for reading"));
+    }
+
+    size_t bytesRead = 0;
+    size_t bytesRemaining = size;
+
+    sys::byte* bufferPtr = static_cast<sys::byte*>(buffer);
+
+    while (bytesRead < size)
+    {
+        const DWORD bytesToRead = static_cast<DWORD>(
+                std::min(MAX_READ_SIZE, bytesRemaining));
+
+        ULARGE_INTEGER where;
+        where.QuadPart = static_cast<ULONGLONG>(offset + bytesRead);
+        OVERLAPPED overlapped;
+        memset(&overlapped, 0, sizeof(overlapped));
+        overlapped.Offset = where.LowPart;
+        overlapped.OffsetHigh = where.HighPart;
+
+        // This is the only request on the handle, so waiting on the handle
+        // itself is enough to know when it's done
+        DWORD bytesThisRead = 0;
+        if ((!ReadFile(handle.get(),
+                       bufferPtr + bytesRead,
+                       bytesToRead,
+                       NULL,
+                       &overlapped) &&
+             GetLastError() != ERROR_IO_PENDING) ||
+            !GetOverlappedResult(handle.get(),
+                                 &overlapped,
+                                 &bytesThisRead,
+                                 TRUE))
+        {
+            if (GetLastError() == ERROR_HANDLE_EOF)
+            {
+                throw sys::SystemException(Ctxt("Unexpected end of file"));
+            }
+            throw sys::SystemException(Ctxt("Error reading from file"));
+        }
+        else if (bytesThisRead == 0)
+        {
+            throw sys::SystemException(Ctxt("Unexpected end of file"));
+        }
+
+        bytesRead += bytesThisRead;
+        bytesRemaining -= bytesThisRead;
+    }
+}
+
 void sys::File::writeFrom(const void* buffer, size_t size)
 {
     static const size_t MAX_WRITE_SIZE = std::numeric_limits<DWORD>::max();
@@ -27,6 +27,7 @@
 #include <complex>
 
 #include <types/RowCol.h>
+#include <six/ThreadPool.h>
 
 namespace cphd
 {
@@ -44,6 +45,21 @@ void byteSwap(void* buffer,
               size_t numElements,
               size_t numThreads);
 
+/*
+ *  \func byteSwap
+ *  \brief Threaded byte-swapping on an existing thread pool
+ *
+ *  \param buffer Buffer to swap (contents will be overridden)
+ *  \param elemSize Size of each element in 'buffer'
+ *  \param numElements Number of elements in 'buffer'
+ *  \param threadPool Threads to use for byte-swapping.  Small buffers
+ *  are swapped on the calling thread.
+ */
+void byteSwap(void* buffer,
+              size_t elemSize,
+              size_t numElements,
+              six::ThreadPool& threadPool);
+
 /*
  *  \func byteSwapAndPromote
  *  \brief Threaded byte-swapping and promote input to complex<floats>
@@ -67,6 +83,13 @@ void byteSwapAndPromote(const void* input,
                         size_t numThreads,
                         std::complex<float>* output);
 
+//! Same as above, using an existing thread pool
+void byteSwapAndPromote(const void* input,
+                        size_t elementSize,
+                        const types::RowCol<size_t>& dims,
+                        six::ThreadPool& threadPool,
+                        std::complex<float>* output);
+
 /*
  *  \func byteSwapAndScale
  *  \brief Threaded byte-swapping and promote input to complex<floats>
@@ -92,6 +115,14 @@ void byteSwapAndScale(const void* input,
                       const double* scaleFactors,
                       size_t numThreads,
                       std::complex<float>* output);
+
+//! Same as above, using an existing thread pool
+void byteSwapAndScale(const void* input,
+                      size_t elementSize,
+                      const types::RowCol<size_t>& dims,
+                      const double* scaleFactors,
+                      six::ThreadPool& threadPool,
+                      std::complex<float>* output);
 }
 
 #endif
@@ -23,13 +23,18 @@
 #define __CPHD_CPHD_READER_H__
 
 #include <memory>
+#include <vector>
 
 #include <sys/Conf.h>
+#include <six/MappedFile.h>
+#include <six/ThreadPool.h>
 
 #include <cphd/Metadata.h>
 #include <cphd/FileHeader.h>
 #include <cphd/PVPBlock.h>
+#include <cphd/PVPView.h>
 #include <cphd/Wideband.h>
+#include <cphd/WidebandStream.h>
 #include <cphd/SupportBlock.h>
 
 namespace cphd
@@ -44,6 +49,23 @@ namespace cphd
 class CPHDReader
 {
 public:
+    /*
+     *  \enum PVPMode
+     *  \brief How the per vector parameters are made available
+     */
+    enum PVPMode
+    {
+        //! Decode the whole PVP block into a PVPBlock up front
+        LOAD_PVP,
+
+        /*!
+         *  Provide a PVPView of the undecoded PVP block.  When reading
+         *  from a file the block is memory mapped, so only the pages that
+         *  are accessed are read from disk.
+         */
+        VIEW_PVP
+    };
+
     /*
      *  \func CPHDReader constructor
      *  \brief Construct CPHDReader from an input stream
@@ -61,6 +83,26 @@ public:
                std::shared_ptr<logging::Logger> logger =
                        std::shared_ptr<logging::Logger>());
 
+    /*
+     *  \func CPHDReader constructor
+     *  \brief Construct CPHDReader from an input stream
+     *
+     *  \param inStream Input stream containing CPHD file
+     *  \param numThreads Number of threads for parallelization
+     *  \param pvpMode Whether to load the PVP block or view it in place.
+     *  A stream cannot be mapped, so VIEW_PVP reads the raw block into
+     *  memory without decoding it.
+     *  \param schemaPaths (Optional) XML schemas for validation
+     *  \param logger (Optional) Provide custom log
+     */
+    CPHDReader(std::shared_ptr<io::SeekableInputStream> inStream,
+               size_t numThreads,
+               PVPMode pvpMode,
+               const std::vector<std::string>& schemaPaths =
+                       std::vector<std::string>(),
+               std::shared_ptr<logging::Logger> logger =
+                       std::shared_ptr<logging::Logger>());
+
     /*
      *  \func CPHDReader constructor
      *  \brief Construct CPHDReader from a file pathname
@@ -78,6 +120,65 @@ public:
                std::shared_ptr<logging::Logger> logger =
                        std::shared_ptr<logging::Logger>());
 
+    /*
+     *  \func CPHDReader constructor
+     *  \brief Construct CPHDReader from a file pathname
+     *
+     *  \param fromFile File path of CPHD file
+     *  \param numThreads Number of threads for parallelization
+     *  \param pvpMode Whether to load the PVP block or memory map it
+     *  and view it in place
+     *  \param schemaPaths (Optional) XML schemas for validation
+     *  \param logger (Optional) Provide custom log
+     */
+    CPHDReader(const std::string& fromFile,
+               size_t numThreads,
+               PVPMode pvpMode,
+               const std::vector<std::string>& schemaPaths =
+                       std::vector<std::string>(),
+               std::shared_ptr<logging::Logger> logger =
+                       std::shared_ptr<logging::Logger>());
+
+    /*
+     *  \func CPHDReader constructor
+     *  \brief Construct CPHDReader from an input stream
+     *
+     *  \param inStream Input stream containing CPHD file
+     *  \param threadPool Threads for parallelization.  The pool may be
+     *  shared with other readers and writers.
+     *  \param pvpMode (Optional) Whether to load the PVP block or view it
+     *  in place
+     *  \param schemaPaths (Optional) XML schemas for validation
+     *  \param logger (Optional) Provide custom log
+     */
+    CPHDReader(std::shared_ptr<io::SeekableInputStream> inStream,
+               std::shared_ptr<six::ThreadPool> threadPool,
+               PVPMode pvpMode = LOAD_PVP,
+               const std::vector<std::string>& schemaPaths =
+                       std::vector<std::string>(),
+               std::shared_ptr<logging::Logger> logger =
+                       std::shared_ptr<logging::Logger>());
+
+    /*
+     *  \func CPHDReader constructor
+     *  \brief Construct CPHDReader from a file pathname
+     *
+     *  \param fromFile File path of CPHD file
+     *  \param threadPool Threads for parallelization.  The pool may be
+     *  shared with other readers and writers.
+     *  \param pvpMode (Optional) Whether to load the PVP block or memory
+     *  map it and view it in place
+     *  \param schemaPaths (Optional) XML schemas for validation
+     *  \param logger (Optional) Provide custom log
+     */
+    CPHDReader(const std::string& fromFile,
+               std::shared_ptr<six::ThreadPool> threadPool,
+               PVPMode pvpMode = LOAD_PVP,
+               const std::vector<std::string>& schemaPaths =
+                       std::vector<std::string>(),
+               std::shared_ptr<logging::Logger> logger =
+                       std::shared_ptr<logging::Logger>());
+
     //! Get parameter functions
     size_t getNumChannels() const
     {
@@ -125,10 +226,12 @@ public:
         return *mMetadata;
     }
     //! Get per vector parameters
-    const PVPBlock& getPVPBlock() const
-    {
-        return *mPVPBlock;
-    }
+    //! \throws except::Exception If the reader was opened with VIEW_PVP
+    const PVPBlock& getPVPBlock() const;
+
+    //! Get a view of the per vector parameters
+    //! \throws except::Exception If the reader was opened with LOAD_PVP
+    const PVPView& getPVPView() const;
     //! Get signal data
     const Wideband& getWideband() const
     {
@@ -140,7 +243,52 @@ public:
         return *mSupportBlock;
     }
 
+    /*
+     *  \func getWidebandStream
+     *  \brief Read a channel of signal data in blocks of vectors, with the
+     *  next block prefetched on a background thread.  No other wideband
+     *  reads should be made while the stream is in use.
+     *
+     *  \param channel 0-based channel to read
+     *  \param vectorsPerBlock Number of vectors to read at a time
+     *  \param outputType Format of the blocks
+     *  \param vectorScaleFactors (Optional) Per-vector scale factors for
+     *  the whole channel, applied to COMPLEX_FLOAT output
+     *  \param numBuffers (Optional) Number of blocks to keep in flight
+     *
+     *  \return The stream, which must not outlive this reader
+     */
+    std::unique_ptr<WidebandStream> getWidebandStream(
+            size_t channel,
+            size_t vectorsPerBlock,
+            WidebandStream::OutputType outputType,
+            const std::vector<double>& vectorScaleFactors =
+                    std::vector<double>(),
+            size_t numBuffers = 2) const
+    {
+        return std::unique_ptr<WidebandStream>(
+                new WidebandStream(*mWideband,
+                                   channel,
+                                   vectorsPerBlock,
+                                   outputType,
+                                   *mThreadPool,
+                                   vectorScaleFactors,
+                                   numBuffers));
+    }
+
+    /*
+     *  Get the reader's threads, e.g. to pass to Wideband::read() so that
+     *  repeated reads reuse them
+     */
+    six::ThreadPool& getThreadPool() const
+    {
+        return *mThreadPool;
+    }
+
 private:
+    //! Threads for byte swapping, shared with the caller
+    std::shared_ptr<six::ThreadPool> mThreadPool;
+
     // Keep info about the CPHD collection
     //! New cphd file header
     FileHeader mFileHeader;
@@ -150,16 +298,27 @@ private:
     std::unique_ptr<SupportBlock> mSupportBlock;
     //! Per Vector Parameter info read in from CPHD file
     std::unique_ptr<PVPBlock> mPVPBlock;
+    //! Mapping of the PVP block (VIEW_PVP from a file)
+    std::unique_ptr<six::MappedFile> mPVPMapping;
+    //! Raw PVP block (VIEW_PVP from a stream)
+    std::vector<sys::ubyte> mPVPBuffer;
+    //! View of the mapped or raw PVP block
+    std::unique_ptr<PVPView> mPVPView;
     //! Signal block book-keeping info read in from CPHD file
     std::unique_ptr<Wideband> mWideband;
 
     /*
      *  Read in header, metadata, supportblock, pvpblock and wideband
+     *  If pathname is non-empty, it is the file inStream reads from
      */
     void initialize(std::shared_ptr<io::SeekableInputStream> inStream,
-                    size_t numThreads,
+                    PVPMode pvpMode,
+                    const std::string& pathname,
                     std::shared_ptr<logging::Logger> logger,
                     const std::vector<std::string>& schemaPaths);
+
+    void viewPVP(io::SeekableInputStream& inStream,
+                 const std::string& pathname);
 };
 }
 
@@ -34,6 +34,7 @@
 #include <cphd/Metadata.h>
 #include <cphd/PVP.h>
 #include <cphd/PVPBlock.h>
+#include <six/ThreadPool.h>
 
 namespace cphd
 {
@@ -51,11 +52,22 @@ public:
      *  \brief Constructor
      *
      *  \param stream The seekable output stream to be written
-     *  \param numThreads Number of threads for parallel processing
+     *  \param numThreads Number of threads for parallel processing.
+     *  0 uses all CPUs.
      */
     DataWriter(std::shared_ptr<io::SeekableOutputStream> stream,
                size_t numThreads);
 
+    /*
+     *  \func DataWriter
+     *  \brief Constructor
+     *
+     *  \param stream The seekable output stream to be written
+     *  \param threadPool Threads for parallel processing
+     */
+    DataWriter(std::shared_ptr<io::SeekableOutputStream> stream,
+               std::shared_ptr<six::ThreadPool> threadPool);
+
     /*
      *  Destructor
      */
@@ -76,8 +88,8 @@ public:
 protected:
     //! Output stream of CPHD
     std::shared_ptr<io::SeekableOutputStream> mStream;
-    //! Number of threads for parallelism
-    const size_t mNumThreads;
+    //! Threads for parallelism
+    const std::shared_ptr<six::ThreadPool> mThreadPool;
 };
 
 /*
@@ -97,10 +109,23 @@ public:
      *  \param stream The seekable output stream to be written
      *  \param numThreads Number of threads for parallel processing
      *  \param scratchSize Size of buffer to be used for scratch space
+     *  \param numScratchBuffers (Optional) Number of scratch buffers.  With
+     *  more than one, each buffer is written to the stream on a background
+     *  thread while the next one is byte swapped.
      */
     DataWriterLittleEndian(std::shared_ptr<io::SeekableOutputStream> stream,
                            size_t numThreads,
-                           size_t scratchSize);
+                           size_t scratchSize,
+                           size_t numScratchBuffers = 1);
+
+    //! Same as above, using an existing thread pool
+    DataWriterLittleEndian(std::shared_ptr<io::SeekableOutputStream> stream,
+                           std::shared_ptr<six::ThreadPool> threadPool,
+                           size_t scratchSize,
+                           size_t numScratchBuffers = 1);
+
+    //! Waits for any pending writes
+    virtual ~DataWriterLittleEndian();
 
     /*
      *  \func operator()
@@ -115,10 +140,14 @@ public:
                             size_t elementSize);
 
 private:
+    class AsyncWriter;
+
     // Size of scratch space
     const size_t mScratchSize;
     // Scratch space buffer
     const mem::ScopedArray<sys::byte> mScratch;
+    // Background writes when there is more than one scratch buffer
+    std::unique_ptr<AsyncWriter> mAsyncWriter;
 };
 
 /*
@@ -141,6 +170,10 @@ public:
     DataWriterBigEndian(std::shared_ptr<io::SeekableOutputStream> stream,
                         size_t numThreads);
 
+    //! Same as above, using an existing thread pool
+    DataWriterBigEndian(std::shared_ptr<io::SeekableOutputStream> stream,
+                        std::shared_ptr<six::ThreadPool> threadPool);
+
     /*
      *  \func operator()
      *  \brief Overload operator performs write
@@ -185,13 +218,17 @@ public:
      *  \param scratchSpaceSize (Optional) The maximum size of internal scratch space
      *         that may be used if byte swapping is necessary.
      *         Default is 4 MB
+     *  \param numScratchBuffers (Optional) Number of scratch buffers of
+     *         scratchSpaceSize to byte swap into.  With more than one,
+     *         byte swapping overlaps writing to the stream.
      */
     CPHDWriter(
             const Metadata& metadata,
             std::shared_ptr<io::SeekableOutputStream> stream,
             const std::vector<std::string>& schemaPaths = std::vector<std::string>(),
             size_t numThreads = 0,
-            size_t scratchSpaceSize = 4 * 1024 * 1024);
+            size_t scratchSpaceSize = 4 * 1024 * 1024,
+            size_t numScratchBuffers = 1);
 
     /*
      *  \func Constructor
@@ -211,13 +248,69 @@ public:
      *  \param scratchSpaceSize (Optional) The maximum size of internal scratch space
      *         that may be used if byte swapping is necessary.
      *         Default is 4 MB
+     *  \param numScratchBuffers (Optional) Number of scratch buffers of
+     *         scratchSpaceSize to byte swap into.  With more than one,
+     *         byte swapping overlaps writing to the stream.
      */
     CPHDWriter(
             const Metadata& metadata,
             const std::string& pathname,
             const std::vector<std::string>& schemaPaths = std::vector<std::string>(),
             size_t numThreads = 0,
-            size_t scratchSpaceSize = 4 * 1024 * 1024);
+            size_t scratchSpaceSize = 4 * 1024 * 1024,
+            size_t numScratchBuffers = 1);
+
+    /*
+     *  \func Constructor
+     *  \brief Sets up the internal structure of the CPHDWriter
+     *
+     *  \param metadata A filled out metadata struct for the file that will be
+     *         written. The data.arraySize and data.numCPHDChannels will be
+     *         filled in internally. All other data must be provided.
+     *  \param stream Seekable output stream to be written to
+     *  \param threadPool Threads to use for processing.  The pool may be
+     *         shared with other readers and writers.
+     *  \param schemaPaths (Optional) A vector of XML schema paths for validation
+     *  \param scratchSpaceSize (Optional) The maximum size of internal scratch space
+     *         that may be used if byte swapping is necessary.
+     *         Default is 4 MB
+     *  \param numScratchBuffers (Optional) Number of scratch buffers of
+     *         scratchSpaceSize to byte swap into.  With more than one,
+     *         byte swapping overlaps writing to the stream.
+     */
+    CPHDWriter(
+            const Metadata& metadata,
+            std::shared_ptr<io::SeekableOutputStream> stream,
+            std::shared_ptr<six::ThreadPool> threadPool,
+            const std::vector<std::string>& schemaPaths = std::vector<std::string>(),
+            size_t scratchSpaceSize = 4 * 1024 * 1024,
+            size_t numScratchBuffers = 1);
+
+    /*
+     *  \func Constructor
+     *  \brief Sets up the internal structure of the CPHDWriter
+     *
+     *  \param metadata A filled out metadata struct for the file that will be
+     *         written. The data.arraySize and data.numCPHDChannels will be
+     *         filled in internally. All other data must be provided.
+     *  \param pathname The file path to be written to
+     *  \param threadPool Threads to use for processing.  The pool may be
+     *         shared with other readers and writers.
+     *  \param schemaPaths (Optional) A vector of XML schema paths for validation
+     *  \param scratchSpaceSize (Optional) The maximum size of internal scratch space
+     *         that may be used if byte swapping is necessary.
+     *         Default is 4 MB
+     *  \param numScratchBuffers (Optional) Number of scratch buffers of
+     *         scratchSpaceSize to byte swap into.  With more than one,
+     *         byte swapping overlaps writing to the stream.
+     */
+    CPHDWriter(
+            const Metadata& metadata,
+            const std::string& pathname,
+            std::shared_ptr<six::ThreadPool> threadPool,
+            const std::vector<std::string>& schemaPaths = std::vector<std::string>(),
+            size_t scratchSpaceSize = 4 * 1024 * 1024,
+            size_t numScratchBuffers = 1);
 
     /*
      *  \func write
@@ -269,6 +362,32 @@ public:
                              mMetadata.data.getSupportArrayById(id).bytesPerElement);
     }
 
+    /*
+     *  \func writeSupportData
+     *  \brief Writes a range of rows of the specified support array
+     *
+     *  Seeks to the rows' position in the support block, so ranges may be
+     *  written in any order once the metadata has been written.
+     *
+     *  \param data A pointer to the first row to write
+     *  \param id The unique identifier of the support array
+     *  \param firstRow 0-based first row to write
+     *  \param numRows Number of rows to write
+     *
+     *  \throws except::Exception If the rows are out of bounds
+     */
+    template <typename T>
+    void writeSupportData(const T* data,
+                          const std::string& id,
+                          size_t firstRow,
+                          size_t numRows)
+    {
+        writeSupportRowsImpl(reinterpret_cast<const sys::ubyte*>(data),
+                             id,
+                             firstRow,
+                             numRows);
+    }
+
     /*
      *  \func writeSupportData
      *  \brief Writes all of the support Arrays to the file
@@ -303,6 +422,36 @@ public:
      */
     void writePVPData(const PVPBlock& PVPBlock);
 
+    /*
+     *  \func writeMetadata
+     *  \brief Writes the header and metadata into the file, sizing the
+     *  PVP block from data.numBytesPVP
+     *
+     *  Use this when the PVP block will be written by vector range rather
+     *  than from a complete PVPBlock.
+     */
+    void writeMetadata();
+
+    /*
+     *  \func writePVPData
+     *  \brief Writes the PVP sets of a range of vectors to the file
+     *
+     *  Seeks to the vectors' position in the PVP block, so ranges may be
+     *  written in any order once the metadata has been written.
+     *
+     *  \param data Native endian PVP sets, data.numBytesPVP bytes each, as
+     *  produced by PVPBlock::getPVPdata()
+     *  \param channel 0-based channel
+     *  \param firstVector 0-based first vector to write
+     *  \param numVectors Number of vectors to write
+     *
+     *  \throws except::Exception If the vectors are out of bounds
+     */
+    void writePVPData(const sys::ubyte* data,
+                      size_t channel,
+                      size_t firstVector,
+                      size_t numVectors);
+
     /*
      *  \func writeCPHDData
      *  \brief Writes a chunk of CPHD data to disk. To create a proper
@@ -325,6 +474,27 @@ public:
                        size_t numElements,
                        size_t channel = 1);
 
+    /*
+     *  \func writeCPHDData
+     *  \brief Writes the signal data of a range of vectors to disk
+     *
+     *  Seeks to the vectors' position in the signal block, so ranges may
+     *  be written in any order once the metadata has been written.
+     *
+     *  \param data The samples of numVectors complete vectors
+     *  \param channel 0-based channel
+     *  \param firstVector 0-based first vector to write
+     *  \param numVectors Number of vectors to write
+     *
+     *  \throws except::Exception If the vectors are out of bounds or the
+     *  signal data is compressed
+     */
+    template <typename T>
+    void writeCPHDData(const T* data,
+                       size_t channel,
+                       size_t firstVector,
+                       size_t numVectors);
+
     void close()
     {
         mStream->close();
@@ -363,6 +533,21 @@ private:
     void writeSupportDataImpl(const sys::ubyte* data,
                               size_t numElements, size_t elementSize);
 
+    /*
+     *  Implementation of write support rows
+     */
+    void writeSupportRowsImpl(const sys::ubyte* data,
+                              const std::string& id,
+                              size_t firstRow,
+                              size_t numRows);
+
+    /*
+     *  Validate a range of vectors to write
+     */
+    void checkVectorRange(size_t channel,
+                          size_t firstVector,
+                          size_t numVectors) const;
+
     //! DataWriter object
     std::unique_ptr<DataWriter> mDataWriter;
 
@@ -375,8 +560,10 @@ private:
     const size_t mElementSize;
     //! size of scratch space for byte swapping
     const size_t mScratchSpaceSize;
-    //! number of threads for parallelism
-    const size_t mNumThreads;
+    //! number of scratch buffers for byte swapping
+    const size_t mNumScratchBuffers;
+    //! threads for parallelism
+    const std::shared_ptr<six::ThreadPool> mThreadPool;
     //! schemas for XML validation
     const std::vector<std::string> mSchemaPaths;
     //! Output stream contains CPHD file
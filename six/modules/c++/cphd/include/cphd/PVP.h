@@ -401,6 +401,19 @@ struct Pvp
     //! Get total byte size of pvp set
     size_t sizeInBytes() const;
 
+    /*
+     *  \func getParameters
+     *
+     *  \brief Describe the layout of a pvp set
+     *
+     *  Lists every parameter that has an offset, including optional and
+     *  added parameters, in order of offset.  The name of each parameter
+     *  is its member name here (e.g. "txPos"), or its name in addedPVP.
+     *
+     *  \return The size, offset, format and name of each parameter
+     */
+    std::vector<APVPType> getParameters() const;
+
     /*
      *  \func setOffset
      *
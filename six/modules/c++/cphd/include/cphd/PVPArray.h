@@ -0,0 +1,340 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CPHD_PVP_ARRAY_H__
+#define __CPHD_PVP_ARRAY_H__
+
+#include <complex>
+#include <map>
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+#include <sys/Conf.h>
+#include <mem/BufferView.h>
+#include <except/Exception.h>
+#include <six/Parameter.h>
+#include <cphd/Types.h>
+#include <cphd/PVP.h>
+
+namespace cphd
+{
+/*
+ *  \struct AddedPVP
+ *  \brief Template Specialization to get additional pvp
+ *
+ *  Mimics function template specialization
+ *
+ * \tparam T Desired type to convert to
+ */
+template<typename T>
+struct AddedPVP
+{
+    T getAddedPVP(const six::Parameter& val) const
+    {
+        return static_cast<T>(val);
+    }
+};
+template<typename T>
+struct AddedPVP<std::complex<T> >
+{
+    std::complex<T> getAddedPVP(const six::Parameter& val) const
+    {
+        return val.getComplex<T>();
+    }
+};
+template<>
+struct AddedPVP<std::string>
+{
+    std::string getAddedPVP(const six::Parameter& val) const
+    {
+        return val.str();
+    }
+};
+
+/*!
+ *  \struct PVPArray
+ *
+ *  \brief Columnar storage for the PVP sets of one channel
+ *
+ *  Each parameter is held in its own contiguous array, indexed by
+ *  vector number, so that e.g. every TxPos of a channel can be
+ *  handed out as a single Vector3 pointer. Optional parameters only
+ *  get storage when they are enabled in the Pvp metadata, and are
+ *  initialized to six::Init::undefined until set. Added parameters
+ *  are held as typed columns keyed by name.
+ */
+struct PVPArray
+{
+    /*!
+     *  \struct AddedColumn
+     *
+     *  \brief Storage for one added (custom) parameter
+     *
+     *  Binary formats (F4, U2, CI8, ...) are stored packed, one
+     *  native-endian element per vector. Any other format (strings
+     *  and multiple-parameter formats) is stored as a string
+     *  per vector.
+     */
+    struct AddedColumn
+    {
+        //! Default constructor
+        AddedColumn();
+
+        /*!
+         *  \func AddedColumn
+         *  \brief Allocate storage for a parameter
+         *
+         *  \param param Metadata of the added parameter
+         *  \param numVectors Number of vectors in the channel
+         */
+        AddedColumn(const APVPType& param, size_t numVectors);
+
+        //! Returns the PVP format of the column
+        const std::string& getFormat() const
+        {
+            return mFormat;
+        }
+
+        /*!
+         *  \func getElementSize
+         *  \brief Size of one packed element
+         *
+         *  \return Returns the number of bytes of each element, or 0
+         *  if the column is not stored in binary form
+         */
+        size_t getElementSize() const
+        {
+            return mElementSize;
+        }
+
+        //! Returns true if the value of a vector has been set
+        bool isSet(size_t vector) const
+        {
+            return mIsSet[vector];
+        }
+
+        /*!
+         *  \func get
+         *  \brief Get the value of one vector as a parameter
+         *
+         *  \param vector 0 based vector index
+         */
+        six::Parameter get(size_t vector) const;
+
+        /*!
+         *  \func set
+         *  \brief Set the value of one vector from a parameter
+         *
+         *  \param vector 0 based vector index
+         *  \param value Value to convert into the column format
+         */
+        void set(size_t vector, const six::Parameter& value);
+
+        /*!
+         *  \func setBytes
+         *  \brief Set the value of one vector from its binary form
+         *
+         *  \param vector 0 based vector index
+         *  \param input Binary parameter data of size byteSize
+         *  \param byteSize Number of bytes allocated to the parameter
+         */
+        void setBytes(size_t vector, const sys::byte* input, size_t byteSize);
+
+        /*!
+         *  \func getBytes
+         *  \brief Write the value of one vector in its binary form
+         *
+         *  \param vector 0 based vector index
+         *  \param byteSize Number of bytes allocated to the parameter
+         *  \param[out] output Buffer of at least byteSize bytes
+         *
+         *  \throws except::Exception If the value was never set
+         */
+        void getBytes(size_t vector, size_t byteSize, sys::ubyte* output) const;
+
+        //! Packed binary elements, empty for non-binary formats
+        const sys::byte* data() const
+        {
+            return mData.empty() ? NULL : &mData[0];
+        }
+
+        //! Equality operators
+        bool operator==(const AddedColumn& other) const
+        {
+            return mFormat == other.mFormat &&
+                   mElementSize == other.mElementSize &&
+                   mData == other.mData &&
+                   mStrings == other.mStrings &&
+                   mIsSet == other.mIsSet;
+        }
+        bool operator!=(const AddedColumn& other) const
+        {
+            return !((*this) == other);
+        }
+
+    private:
+        std::string mFormat;
+        size_t mElementSize;
+        std::vector<sys::byte> mData;
+        std::vector<std::string> mStrings;
+        std::vector<bool> mIsSet;
+    };
+
+    //! Default constructor
+    PVPArray();
+
+    /*!
+     *  \func PVPArray
+     *  \brief Allocate every column required by the metadata
+     *
+     *  \param pvp A filled out pvp structure, used to determine which
+     *  optional and added parameters need storage
+     *  \param numVectors Number of vectors in the channel
+     */
+    PVPArray(const Pvp& pvp, size_t numVectors);
+
+    //! Returns the number of vectors in the channel
+    size_t getNumVectors() const
+    {
+        return txTime.size();
+    }
+
+    /*
+     *  \func write
+     *
+     *  \brief Fills every vector from binary PVP data
+     *
+     *  \param pvp A filled out pvp structure, used for the byte
+     *  offset of each parameter within a set
+     *  \param numBytesPerVector Stride between consecutive sets in input
+     *  \param input Native-endian PVP data for getNumVectors() sets
+     */
+    void write(const Pvp& pvp,
+               size_t numBytesPerVector,
+               const sys::byte* input);
+
+    /*
+     *  \func read
+     *
+     *  \brief Writes every vector out as binary PVP data
+     *
+     *  \param pvp A filled out pvp structure, used for the byte
+     *  offset of each parameter within a set
+     *  \param numBytesPerVector Stride between consecutive sets in output
+     *  \param[out] output Buffer for getNumVectors() sets
+     *
+     *  \throws except::Exception If an added parameter was never set
+     */
+    void read(const Pvp& pvp,
+              size_t numBytesPerVector,
+              sys::ubyte* output) const;
+
+    /*
+     *  \func getAddedPVPArray
+     *
+     *  \brief Contiguous view of a binary added parameter
+     *
+     *  \tparam T Native type matching the parameter format
+     *  (e.g. float for F4, std::complex<sys::Int16_T> for CI4)
+     *  \param name Unique name of the added parameter
+     *
+     *  \throws except::Exception If the parameter does not exist, or is
+     *  not stored as elements of size sizeof(T)
+     */
+    template<typename T>
+    mem::BufferView<const T> getAddedPVPArray(const std::string& name) const
+    {
+        std::map<std::string, AddedColumn>::const_iterator it =
+                addedPVP.find(name);
+        if (it == addedPVP.end())
+        {
+            throw except::Exception(Ctxt(
+                    "Parameter was not specified in XML"));
+        }
+        if (it->second.getElementSize() != sizeof(T))
+        {
+            throw except::Exception(Ctxt(
+                    "Parameter " + name + " with format " +
+                    it->second.getFormat() + " cannot be viewed as the "
+                    "requested type"));
+        }
+        return mem::BufferView<const T>(
+                reinterpret_cast<const T*>(it->second.data()),
+                getNumVectors());
+    }
+
+    //! Equality operators
+    bool operator==(const PVPArray& other) const
+    {
+        return txTime == other.txTime && txPos == other.txPos &&
+                txVel == other.txVel && rcvTime == other.rcvTime &&
+                rcvPos == other.rcvPos && rcvVel == other.rcvVel &&
+                srpPos == other.srpPos && aFDOP == other.aFDOP &&
+                aFRR1 == other.aFRR1 && aFRR2 == other.aFRR2 &&
+                fx1 == other.fx1 && fx2 == other.fx2 &&
+                toa1 == other.toa1 && toa2 == other.toa2 &&
+                tdTropoSRP == other.tdTropoSRP && sc0 == other.sc0 &&
+                scss == other.scss &&
+                ampSF == other.ampSF && fxN1 == other.fxN1 &&
+                fxN2 == other.fxN2 && toaE1 == other.toaE1 &&
+                toaE2 == other.toaE2 && tdIonoSRP == other.tdIonoSRP &&
+                signal == other.signal && addedPVP == other.addedPVP;
+    }
+    bool operator!=(const PVPArray& other) const
+    {
+        return !((*this) == other);
+    }
+
+    //! Required Parameters
+    std::vector<double> txTime;
+    std::vector<Vector3> txPos;
+    std::vector<Vector3> txVel;
+    std::vector<double> rcvTime;
+    std::vector<Vector3> rcvPos;
+    std::vector<Vector3> rcvVel;
+    std::vector<Vector3> srpPos;
+    std::vector<double> aFDOP;
+    std::vector<double> aFRR1;
+    std::vector<double> aFRR2;
+    std::vector<double> fx1;
+    std::vector<double> fx2;
+    std::vector<double> toa1;
+    std::vector<double> toa2;
+    std::vector<double> tdTropoSRP;
+    std::vector<double> sc0;
+    std::vector<double> scss;
+
+    //! (Optional) Parameters, empty if not enabled
+    std::vector<double> ampSF;
+    std::vector<double> fxN1;
+    std::vector<double> fxN2;
+    std::vector<double> toaE1;
+    std::vector<double> toaE2;
+    std::vector<double> tdIonoSRP;
+    std::vector<sys::Int64_T> signal;
+
+    //! (Optional) Additional parameters
+    std::map<std::string, AddedColumn> addedPVP;
+};
+}
+#endif
@@ -32,45 +32,13 @@
 #include <cphd/Types.h>
 #include <cphd/Data.h>
 #include <cphd/PVP.h>
+#include <cphd/PVPArray.h>
 #include <cphd/Metadata.h>
 #include <cphd/ByteSwap.h>
 #include <six/Parameter.h>
 
 namespace cphd
 {
-/*
- *  \struct AddedPVP
- *  \brief Template Specialization to get additional pvp
- *
- *  Mimics function template specialization
- *
- * \tparam T Desired type to convert to
- */
-template<typename T>
-struct AddedPVP
-{
-    T getAddedPVP(const six::Parameter& val) const
-    {
-        return static_cast<T>(val);
-    }
-};
-template<typename T>
-struct AddedPVP<std::complex<T> >
-{
-    std::complex<T> getAddedPVP(const six::Parameter& val) const
-    {
-        return val.getComplex<T>();
-    }
-};
-template<>
-struct AddedPVP<std::string>
-{
-    std::string getAddedPVP(const six::Parameter& val) const
-    {
-        return val.str();
-    }
-};
-
 /*!
  *  \struct PVPBlock
  *
@@ -181,11 +149,11 @@ struct PVPBlock
     T getAddedPVP(size_t channel, size_t set, const std::string& name) const
     {
         verifyChannelVector(channel, set);
-        if(mData[channel][set].addedPVP.count(name) == 1)
+        auto it = mData[channel].addedPVP.find(name);
+        if(it != mData[channel].addedPVP.end() && it->second.isSet(set))
         {
             AddedPVP<T> aP;
-            return aP.getAddedPVP(mData[channel][set].addedPVP.find(name)->second);
-            // return AddPVPNamespace::getAddedPVP<T>(mData[channel][set].addedPVP.find(name)->second);
+            return aP.getAddedPVP(it->second.get(set));
         }
         throw except::Exception(Ctxt(
                 "Parameter was not set"));
@@ -223,10 +191,12 @@ struct PVPBlock
         verifyChannelVector(channel, set);
         if(mPvp.addedPVP.count(name) != 0)
         {
-            if(mData[channel][set].addedPVP.count(name) == 0)
+            PVPArray::AddedColumn& column = mData[channel].addedPVP.find(name)->second;
+            if(!column.isSet(set))
             {
-                mData[channel][set].addedPVP[name] = six::Parameter();
-                mData[channel][set].addedPVP.find(name)->second.setValue(value);
+                six::Parameter param;
+                param.setValue(value);
+                column.set(set, param);
                 return;
             }
             throw except::Exception(Ctxt(
@@ -236,6 +206,17 @@ struct PVPBlock
                                 "Parameter was not specified in XML"));
     }
 
+    /*
+     *  \func getPVPArray
+     *  \brief Columnar access to all PVP sets of a channel
+     *
+     *  Each parameter is a contiguous array indexed by vector, e.g.
+     *  getPVPArray(0).txPos.data() points at every TxPos of channel 0.
+     *
+     *  \param channel 0 based index
+     */
+    const PVPArray& getPVPArray(size_t channel) const;
+
     /*
      *  \func getPVPdata
      *  \brief This will return a contiguous buffer all the PVP data.
@@ -257,6 +238,19 @@ struct PVPBlock
     void getPVPdata(size_t channel,
                     void*  data) const;
 
+    /*
+     *  \func setPVPdata
+     *  \brief Set every PVP set of a channel from a contiguous buffer
+     *
+     *  The buffer has the same layout as the one filled by getPVPdata(),
+     *  native-endian with getNumBytesPVPSet() bytes per set.
+     *
+     *  \param channel 0 based index
+     *  \param data Buffer of getPVPsize(channel) bytes
+     */
+    void setPVPdata(size_t channel,
+                    const void* data);
+
     /*
      *  \func getNumBytesVBP
      *  \brief Number of bytes per PVP seet
@@ -327,6 +321,12 @@ struct PVPBlock
                     sys::Off_T sizePVP,
                     size_t numThreads);
 
+    //! Same as above, byte swapping on an existing thread pool
+    sys::Off_T load(io::SeekableInputStream& inStream,
+                    sys::Off_T startPVP,
+                    sys::Off_T sizePVP,
+                    six::ThreadPool& threadPool);
+
     //! Equality operators
     bool operator==(const PVPBlock& other) const
     {
@@ -339,110 +339,9 @@ struct PVPBlock
         return !((*this) == other);
     }
 
-protected:
-    /*!
-     *  \struct PVPSet
-     *
-     *  \brief Parameters for each vector
-     *
-     *  Stores a single set of parameters
-     *  Each channel consists of a PVP Array,
-     *  which consists of multiple sets
-     */
-    struct PVPSet
-    {
-        /*!
-         *  \func PVPSet
-         *
-         *  \brief Default constructor
-         */
-        PVPSet();
-
-        /*
-         *  \func write
-         *
-         *  \brief Writes binary data input into PVP Set
-         *
-         *  \param pvpBlock A pvpBlock struct to access optional parameter flags
-         *  \param pvp A filled out pvp sturcture. This will be used for
-         *  information on where to allocate memory and set each
-         *  parameter in a PVP set.
-         *  \param input A pointer to an array of bytes that contains the
-         *  parameter data to write into the pvp set
-         */
-        void write(const PVPBlock& pvpBlock, const Pvp& pvp, const sys::byte* input);
-
-        /*
-         *  \func read
-         *
-         *  \brief Read PVP set into binary data output
-         *
-         *  \param pvp A filled out pvp sturcture. This will be used for
-         *  information on where to allocate memory and set each
-         *  parameter in a PVP set.
-         *  \param[out] output A pointer to an array of allocated bytes that
-         *  will be written to
-         */
-        void read(const Pvp& pvp, sys::ubyte* output) const;
-
-        //! Equality operators
-        bool operator==(const PVPSet& other) const
-        {
-            return txTime == other.txTime && txPos == other.txPos &&
-                    txVel == other.txVel && rcvTime == other.rcvTime &&
-                    rcvPos == other.rcvPos && rcvVel == other.rcvVel &&
-                    srpPos == other.srpPos && aFDOP == other.aFDOP &&
-                    aFRR1 == other.aFRR1 && aFRR2 == other.aFRR2 &&
-                    fx1 == other.fx1 && fx2 == other.fx2 &&
-                    toa1 == other.toa1 && toa2 == other.toa2 &&
-                    tdTropoSRP == other.tdTropoSRP && sc0 == other.sc0 &&
-                    scss == other.scss &&
-                    ampSF == other.ampSF && fxN1 == other.fxN1 &&
-                    fxN2 == other.fxN2 && toaE1 == other.toaE1 &&
-                    toaE2 == other.toaE2 && tdIonoSRP == other.tdIonoSRP &&
-                    signal == other.signal && addedPVP == other.addedPVP;
-        }
-        bool operator!=(const PVPSet& other) const
-        {
-            return !((*this) == other);
-        }
-
-        //! Required Parameters
-        double txTime;
-        Vector3 txPos;
-        Vector3 txVel;
-        double rcvTime;
-        Vector3 rcvPos;
-        Vector3 rcvVel;
-        Vector3 srpPos;
-        double aFDOP;
-        double aFRR1;
-        double aFRR2;
-        double fx1;
-        double fx2;
-        double toa1;
-        double toa2;
-        double tdTropoSRP;
-        double sc0;
-        double scss;
-
-        //! (Optional) Parameters
-        mem::ScopedCopyablePtr<double> ampSF;
-        mem::ScopedCopyablePtr<double> fxN1;
-        mem::ScopedCopyablePtr<double> fxN2;
-        mem::ScopedCopyablePtr<double> toaE1;
-        mem::ScopedCopyablePtr<double> toaE2;
-        mem::ScopedCopyablePtr<double> tdIonoSRP;
-        mem::ScopedCopyablePtr<sys::Int64_T> signal;
-
-        //! (Optional) Additional parameters
-        std::unordered_map<std::string,six::Parameter> addedPVP;
-    };
-    friend std::ostream& operator<< (std::ostream& os, const PVPSet& p);
-
 private:
-    //! The PVP Block [Num Channles][Num Parameters]
-    std::vector<std::vector<PVPSet> > mData;
+    //! The PVP Block, one columnar PVP Array per channel
+    std::vector<PVPArray> mData;
     //! Number of bytes per PVP vector
     size_t mNumBytesPerVector;
     //! PVP block metadata
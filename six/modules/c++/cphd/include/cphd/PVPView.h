@@ -0,0 +1,204 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CPHD_PVP_VIEW_H__
+#define __CPHD_PVP_VIEW_H__
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+#include <sys/Conf.h>
+#include <except/Exception.h>
+#include <cphd/Types.h>
+#include <cphd/Data.h>
+#include <cphd/PVP.h>
+#include <cphd/PVPArray.h>
+
+namespace cphd
+{
+/*!
+ *  \class PVPView
+ *
+ *  \brief Read-only view of a PVP block as it is stored in a CPHD file
+ *
+ *  Unlike PVPBlock, nothing is decoded up front.  The view points at the
+ *  raw, big-endian PVP block (typically a memory mapping of the file),
+ *  and each parameter is located using the offsets in the Pvp metadata
+ *  and byte-swapped when it is accessed.  This makes it cheap to inspect
+ *  a few parameters of a large file.
+ *
+ *  The view does not own the PVP block, which must outlive it.
+ */
+class PVPView
+{
+public:
+    /*!
+     *  \func PVPView
+     *
+     *  \brief Constructor
+     *
+     *  \param pvp A filled out pvp structure, used for the location and
+     *  format of each parameter in a PVP set
+     *  \param data A filled out data structure, used for the number of
+     *  channels and vectors, and the number of bytes per PVP set
+     *  \param pvpBlock The PVP block, exactly as stored in the file
+     *  \param sizePVP Size of the PVP block in bytes
+     *
+     *  \throws except::Exception If sizePVP does not match the size
+     *  calculated from the metadata
+     */
+    PVPView(const Pvp& pvp,
+            const Data& data,
+            const void* pvpBlock,
+            sys::Off_T sizePVP);
+
+    //! Number of channels in the block
+    size_t getNumChannels() const
+    {
+        return mChannels.size();
+    }
+
+    //! 0-based channel number
+    size_t getNumVectors(size_t channel) const;
+
+    //! Number of bytes per PVP set
+    size_t getNumBytesPVPSet() const
+    {
+        return mNumBytesPerVector;
+    }
+
+    /*
+     *  \func getPVPdata
+     *  \brief Raw PVP sets of a channel, in file (big-endian) byte order
+     *
+     *  \param channel 0 based index
+     */
+    const sys::ubyte* getPVPdata(size_t channel) const;
+
+    /*!
+     *  \func verifyChannelVector
+     *
+     *  \brief Verify channel and vector indexes provided are valid
+     *
+     *  \throws except::Exception If channel or vector is out of range
+     */
+    void verifyChannelVector(size_t channel, size_t vector) const;
+
+    //! Getter functions
+    double getTxTime(size_t channel, size_t set) const;
+    Vector3 getTxPos(size_t channel, size_t set) const;
+    Vector3 getTxVel(size_t channel, size_t set) const;
+    double getRcvTime(size_t channel, size_t set) const;
+    Vector3 getRcvPos(size_t channel, size_t set) const;
+    Vector3 getRcvVel(size_t channel, size_t set) const;
+    Vector3 getSRPPos(size_t channel, size_t set) const;
+    double getaFDOP(size_t channel, size_t set) const;
+    double getaFRR1(size_t channel, size_t set) const;
+    double getaFRR2(size_t channel, size_t set) const;
+    double getFx1(size_t channel, size_t set) const;
+    double getFx2(size_t channel, size_t set) const;
+    double getTOA1(size_t channel, size_t set) const;
+    double getTOA2(size_t channel, size_t set) const;
+    double getTdTropoSRP(size_t channel, size_t set) const;
+    double getSC0(size_t channel, size_t set) const;
+    double getSCSS(size_t channel, size_t set) const;
+    double getAmpSF(size_t channel, size_t set) const;
+    double getFxN1(size_t channel, size_t set) const;
+    double getFxN2(size_t channel, size_t set) const;
+    double getTOAE1(size_t channel, size_t set) const;
+    double getTOAE2(size_t channel, size_t set) const;
+    double getTdIonoSRP(size_t channel, size_t set) const;
+    sys::Int64_T getSignal(size_t channel, size_t set) const;
+
+    template<typename T>
+    T getAddedPVP(size_t channel, size_t set, const std::string& name) const
+    {
+        AddedPVP<T> aP;
+        return aP.getAddedPVP(getAddedParameter(channel, set, name));
+    }
+
+    //! Get optional parameter flags
+    bool hasAmpSF() const
+    {
+        return isEnabled(mPvp.ampSF);
+    }
+    bool hasFxN1() const
+    {
+        return isEnabled(mPvp.fxN1);
+    }
+    bool hasFxN2() const
+    {
+        return isEnabled(mPvp.fxN2);
+    }
+    bool hasToaE1() const
+    {
+        return isEnabled(mPvp.toaE1);
+    }
+    bool hasToaE2() const
+    {
+        return isEnabled(mPvp.toaE2);
+    }
+    bool hasTDIonoSRP() const
+    {
+        return isEnabled(mPvp.tdIonoSRP);
+    }
+    bool hasSignal() const
+    {
+        return isEnabled(mPvp.signal);
+    }
+
+private:
+    static bool isEnabled(const PVPType& param);
+
+    const sys::ubyte* getParameter(const PVPType& param,
+                                   size_t channel,
+                                   size_t set) const;
+
+    template<typename T>
+    T get(const PVPType& param, size_t channel, size_t set) const;
+
+    template<typename T>
+    T getOptional(const PVPType& param, size_t channel, size_t set) const;
+
+    Vector3 getVector3(const PVPType& param,
+                       size_t channel,
+                       size_t set) const;
+
+    six::Parameter getAddedParameter(size_t channel,
+                                     size_t set,
+                                     const std::string& name) const;
+
+private:
+    //! PVP block metadata
+    Pvp mPvp;
+    //! Number of bytes per PVP vector
+    size_t mNumBytesPerVector;
+    //! Start of each channel's PVP sets
+    std::vector<const sys::ubyte*> mChannels;
+    //! Number of vectors of each channel
+    std::vector<size_t> mNumVectors;
+    //! Whether values need swapping to native byte order
+    bool mSwap;
+};
+}
+#endif
@@ -0,0 +1,117 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CPHD_SAMPLE_CONVERSION_H__
+#define __CPHD_SAMPLE_CONVERSION_H__
+
+#include <stddef.h>
+#include <complex>
+
+namespace cphd
+{
+/*
+ *  \enum InstructionSet
+ *  \brief Vector instructions the sample conversion kernels may use
+ *
+ *  All instruction sets produce bitwise identical results.
+ */
+enum InstructionSet
+{
+    INSTRUCTION_SET_SCALAR,
+    INSTRUCTION_SET_SSE2,
+    INSTRUCTION_SET_AVX2
+};
+
+/*
+ *  \func getBestInstructionSet
+ *  \brief Best instruction set supported by both this build and the CPU
+ *  it's running on.  This is determined once and cached.
+ */
+InstructionSet getBestInstructionSet();
+
+/*
+ *  \func swapBytes
+ *  \brief Single-threaded, in place byte-swapping
+ *
+ *  \param buffer Buffer to swap (contents will be overridden)
+ *  \param elemSize Size of each element in 'buffer'.  Sizes other than
+ *  2, 4 and 8 are always swapped with scalar code.
+ *  \param numElements Number of elements in 'buffer'
+ *  \param instructionSet Instructions to use.  This is limited to
+ *  getBestInstructionSet().
+ */
+void swapBytes(void* buffer,
+               size_t elemSize,
+               size_t numElements,
+               InstructionSet instructionSet = getBestInstructionSet());
+
+/*
+ *  \func promoteSamples
+ *  \brief Single-threaded conversion of CPHD samples to complex<float>,
+ *  optionally byte-swapping them first
+ *
+ *  \param input Samples to promote
+ *  \param elementSize Size of each complex sample in 'input' (2, 4 or 8)
+ *  \param numSamples Number of complex samples in 'input'
+ *  \param byteSwap Whether to byte-swap each component first
+ *  \param output Promoted samples
+ *  \param instructionSet Instructions to use.  This is limited to
+ *  getBestInstructionSet().
+ *
+ *  \throws except::Exception If elementSize is not one of (2, 4 or 8)
+ */
+void promoteSamples(const void* input,
+                    size_t elementSize,
+                    size_t numSamples,
+                    bool byteSwap,
+                    std::complex<float>* output,
+                    InstructionSet instructionSet = getBestInstructionSet());
+
+/*
+ *  \func scaleSamples
+ *  \brief Single-threaded conversion of CPHD samples to complex<float>,
+ *  optionally byte-swapping them first, and scaling them
+ *
+ *  The scaling is performed in double precision before the result is
+ *  rounded to float.
+ *
+ *  \param input Samples to scale
+ *  \param elementSize Size of each complex sample in 'input' (2, 4 or 8)
+ *  \param numSamples Number of complex samples in 'input'
+ *  \param byteSwap Whether to byte-swap each component first
+ *  \param scaleFactor Factor to scale each sample by
+ *  \param output Scaled samples
+ *  \param instructionSet Instructions to use.  This is limited to
+ *  getBestInstructionSet().
+ *
+ *  \throws except::Exception If elementSize is not one of (2, 4 or 8)
+ */
+void scaleSamples(const void* input,
+                  size_t elementSize,
+                  size_t numSamples,
+                  bool byteSwap,
+                  double scaleFactor,
+                  std::complex<float>* output,
+                  InstructionSet instructionSet = getBestInstructionSet());
+}
+
+#endif
@@ -46,6 +46,8 @@ namespace cphd
  *  \brief This class contains information about the SupportBlock CPHD data.
  */
 //  Provides methods to read support block data from CPHD file/stream
+//  Like Wideband, reads use positional reads on the stream, so several
+//  threads may call read() concurrently on a shared CPHDReader
 class SupportBlock
 {
 public:
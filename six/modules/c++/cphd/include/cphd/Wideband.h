@@ -31,6 +31,8 @@
 #include <io/SeekableStreams.h>
 #include <mem/BufferView.h>
 #include <mem/ScopedArray.h>
+#include <six/Decimation.h>
+#include <six/ThreadPool.h>
 #include <sys/Conf.h>
 #include <types/RowCol.h>
 
@@ -42,11 +44,19 @@ namespace cphd
  */
 //  It contains the cphd::Data structure (for channel and vector sizes).
 //  Provides methods read wideband data from CPHD file/stream
+//  Reads use positional reads on the stream rather than seeking it, so
+//  several threads may call read() concurrently, such as to read different
+//  channels from one shared CPHDReader.  Don't seek or read the stream
+//  elsewhere while doing so, unless it is a file stream.
 class Wideband
 {
 public:
     static const size_t ALL;
 
+    //! Default number of bytes of converted samples readDecimated() holds
+    //! at a time
+    static const size_t DEFAULT_SWATH_BYTES;
+
     /*!
      *  \func Wideband
      *
@@ -146,6 +156,22 @@ public:
               size_t numThreads,
               const mem::BufferView<sys::ubyte>& data) const;
 
+    /*!
+     *  \func read
+     *
+     *  \brief Same as above, but swaps on an existing thread pool
+     *
+     *  Prefer this when making many reads, so that threads are not
+     *  started and joined on every call.
+     */
+    void read(size_t channel,
+              size_t firstVector,
+              size_t lastVector,
+              size_t firstSample,
+              size_t lastSample,
+              six::ThreadPool& threadPool,
+              const mem::BufferView<sys::ubyte>& data) const;
+
     /*!
      *  \func read
      *
@@ -248,6 +274,94 @@ public:
               const mem::BufferView<sys::ubyte>& scratch,
               const mem::BufferView<std::complex<float>>& data) const;
 
+    /*!
+     *  \func read
+     *
+     *  \brief Same as above, but scales, promotes and swaps on an
+     *  existing thread pool
+     */
+    void read(size_t channel,
+              size_t firstVector,
+              size_t lastVector,
+              size_t firstSample,
+              size_t lastSample,
+              const std::vector<double>& vectorScaleFactors,
+              six::ThreadPool& threadPool,
+              const mem::BufferView<sys::ubyte>& scratch,
+              const mem::BufferView<std::complex<float>>& data) const;
+
+    /*!
+     *  \func readDecimated
+     *
+     *  \brief Read a decimated, detected quicklook of the specified
+     *  channel, vector(s), and sample(s)
+     *
+     *  Vectors are decimated like rows, and samples like columns, as
+     *  described by six::Decimation.  Only the vectors that the decimation
+     *  uses are read, a swath at a time.  They're scaled, promoted, and
+     *  reduced across the threads in threadPool.
+     *
+     *  \param channel 0-based channel
+     *  \param firstVector 0-based first vector to read (inclusive)
+     *  \param lastVector 0-based last vector to read (inclusive).  Use ALL to
+     *   read all vectors
+     *  \param firstSample 0-based first sample to read (inclusive)
+     *  \param lastSample 0-based last sample to read (inclusive).  Use ALL to
+     *   read all samples
+     *  \param decimation How to decimate the vectors and samples
+     *  \param vectorScaleFactors One scale factor for each vector from
+     *   firstVector to lastVector, or empty to not scale
+     *  \param threadPool Threads to convert and reduce the samples on
+     *  \param[out] data A pre allocated mem::BufferView that will hold the
+     *   power of the decimated samples.  Use getDecimatedDims() to size it.
+     *  \param swathBytes (Optional) Approximate number of bytes of converted
+     *   samples to hold at a time.  At least one decimated vector is always
+     *   read.
+     *
+     *  \throw except::Exception If invalid channel, firstVector, lastVector,
+     *   firstSample or lastSample
+     *  \throw except::Exception If scaleFactors vector size is not equal to
+     *   number of vectors
+     *  \throw except::Exception If data is too small
+     *  \throw except::Exception If wideband data is compressed
+     */
+    void readDecimated(size_t channel,
+                       size_t firstVector,
+                       size_t lastVector,
+                       size_t firstSample,
+                       size_t lastSample,
+                       const six::Decimation& decimation,
+                       const std::vector<double>& vectorScaleFactors,
+                       six::ThreadPool& threadPool,
+                       const mem::BufferView<float>& data,
+                       size_t swathBytes = DEFAULT_SWATH_BYTES) const;
+
+    /*!
+     *  \func getDecimatedDims
+     *
+     *  \brief Gets the dimensions of a decimated read
+     *
+     *  \param channel 0-based channel
+     *  \param firstVector 0-based first vector to read (inclusive)
+     *  \param lastVector 0-based last vector to read (inclusive).  Use ALL to
+     *  read all vectors
+     *  \param firstSample 0-based first sample to read (inclusive)
+     *  \param lastSample 0-based last sample to read (inclusive).  Use ALL to
+     *  read all samples
+     *  \param decimation How the vectors and samples are decimated
+     */
+    types::RowCol<size_t> getDecimatedDims(
+            size_t channel,
+            size_t firstVector,
+            size_t lastVector,
+            size_t firstSample,
+            size_t lastSample,
+            const six::Decimation& decimation) const
+    {
+        return decimation.getDecimatedDims(getBufferDims(
+                channel, firstVector, lastVector, firstSample, lastSample));
+    }
+
     /*!
      *  \func read
      *
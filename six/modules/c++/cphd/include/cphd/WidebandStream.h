@@ -0,0 +1,219 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CPHD_WIDEBAND_STREAM_H__
+#define __CPHD_WIDEBAND_STREAM_H__
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+#include <except/Exception.h>
+#include <mem/BufferView.h>
+#include <sys/Conf.h>
+#include <sys/ConditionVar.h>
+#include <sys/Mutex.h>
+#include <sys/Thread.h>
+#include <six/ThreadPool.h>
+#include <cphd/Wideband.h>
+
+namespace cphd
+{
+/*!
+ *  \class WidebandStream
+ *  \brief Reads one channel of wideband data as a sequence of blocks of
+ *  vectors, prefetching on a background thread
+ *
+ *  While the caller processes block N, block N + 1 is read and converted
+ *  into the next buffer of a small ring.  The buffers are allocated once,
+ *  up front, and reused for every block.
+ *
+ *  \code
+ *  cphd::WidebandStream stream(reader.getWideband(), channel, 1024,
+ *                              cphd::WidebandStream::COMPLEX_FLOAT,
+ *                              reader.getThreadPool());
+ *  while (const cphd::WidebandStream::Block* block = stream.next())
+ *  {
+ *      process(block->getComplexData(), block->getNumVectors());
+ *  }
+ *  \endcode
+ *
+ *  The background thread reads through the Wideband's input stream, so
+ *  no other reads should be made on the same Wideband while a
+ *  WidebandStream is in use.
+ */
+class WidebandStream
+{
+public:
+    /*!
+     *  \enum OutputType
+     *  \brief Format of the blocks returned by next()
+     */
+    enum OutputType
+    {
+        //! Samples in their stored format, byte swapped to native endianness
+        RAW,
+
+        //! Samples promoted (and optionally scaled) to complex<float>
+        COMPLEX_FLOAT
+    };
+
+    /*!
+     *  \class Block
+     *  \brief A contiguous range of vectors.  Each vector contains all
+     *  of the channel's samples.
+     */
+    class Block
+    {
+    public:
+        Block();
+
+        //! 0-based index of the first vector in the block
+        size_t getFirstVector() const
+        {
+            return mFirstVector;
+        }
+
+        //! Number of vectors in the block.  The last block may be short.
+        size_t getNumVectors() const
+        {
+            return mNumVectors;
+        }
+
+        //! Number of samples in each vector
+        size_t getNumSamples() const
+        {
+            return mNumSamples;
+        }
+
+        //! Block data for RAW streams
+        //! \throws except::Exception If the stream is COMPLEX_FLOAT
+        mem::BufferView<sys::ubyte> getData() const;
+
+        //! Block data for COMPLEX_FLOAT streams
+        //! \throws except::Exception If the stream is RAW
+        mem::BufferView<std::complex<float> > getComplexData() const;
+
+    private:
+        friend class WidebandStream;
+
+        OutputType mOutputType;
+        size_t mFirstVector;
+        size_t mNumVectors;
+        size_t mNumSamples;
+        size_t mElementSize;
+
+        //! RAW output, or scratch space for COMPLEX_FLOAT conversion
+        std::vector<sys::ubyte> mData;
+        std::vector<std::complex<float> > mComplexData;
+        std::vector<double> mScaleFactors;
+    };
+
+    /*!
+     *  Allocate the buffers and start prefetching.  A channel with no
+     *  vectors gives an empty stream with no background thread.
+     *
+     *  \param wideband Wideband to read from.  This must outlive the stream.
+     *  \param channel 0-based channel to read
+     *  \param vectorsPerBlock Number of vectors to read at a time
+     *  \param outputType Format of the blocks
+     *  \param threadPool Threads for byte swapping and conversion.  This
+     *  must outlive the stream.
+     *  \param vectorScaleFactors (Optional) Per-vector scale factors for
+     *  the whole channel, applied to COMPLEX_FLOAT output.  If this is
+     *  empty, the samples are not scaled.
+     *  \param numBuffers (Optional) Number of blocks in the ring.  This is
+     *  at least 2: one for the caller and one being prefetched.
+     *
+     *  \throws except::Exception If the channel is invalid, vectorsPerBlock
+     *  is 0, the channel is compressed and can't be read in pieces, or
+     *  there are the wrong number of scale factors
+     */
+    WidebandStream(const Wideband& wideband,
+                   size_t channel,
+                   size_t vectorsPerBlock,
+                   OutputType outputType,
+                   six::ThreadPool& threadPool,
+                   const std::vector<double>& vectorScaleFactors =
+                           std::vector<double>(),
+                   size_t numBuffers = 2);
+
+    //! Stops prefetching and joins the background thread
+    ~WidebandStream();
+
+    /*!
+     *  Get the next block, waiting for it to be read if necessary.  The
+     *  previously returned block is given back to the background thread
+     *  to be refilled, so it must not be used after this call.
+     *
+     *  \return The next block, or NULL once the whole channel has been read
+     *
+     *  \throws except::Exception If reading the block failed
+     */
+    const Block* next();
+
+    //! Total number of blocks in the channel
+    size_t getNumBlocks() const
+    {
+        return mNumBlocks;
+    }
+
+private:
+    // Noncopyable
+    WidebandStream(const WidebandStream& );
+    const WidebandStream& operator=(const WidebandStream& );
+
+    class Prefetcher;
+
+    // Runs on the background thread
+    void prefetch();
+
+    void readBlock(size_t blockNum, Block& block);
+
+private:
+    const Wideband& mWideband;
+    const size_t mChannel;
+    const size_t mVectorsPerBlock;
+    const OutputType mOutputType;
+    six::ThreadPool& mThreadPool;
+    const std::vector<double> mVectorScaleFactors;
+    size_t mNumVectors;
+    size_t mNumBlocks;
+
+    std::vector<Block> mBlocks;
+
+    // Guarded by mMutex
+    size_t mNumRead;
+    size_t mNumReleased;
+    size_t mNumConsumed;
+    bool mHoldingBlock;
+    bool mCancelled;
+    std::unique_ptr<except::Exception> mError;
+
+    sys::Mutex mMutex;
+    sys::ConditionVar mBlockRead;
+    sys::ConditionVar mBlockReleased;
+    std::unique_ptr<sys::Thread> mThread;
+};
+}
+
+#endif
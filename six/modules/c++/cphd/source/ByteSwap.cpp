@@ -19,32 +19,17 @@
  * see <http://www.gnu.org/licenses/>.
  *
  */
+#include <vector>
+
 #include <sys/Conf.h>
 #include <mt/ThreadPlanner.h>
-#include <mt/ThreadGroup.h>
 #include <cphd/ByteSwap.h>
+#include <cphd/SampleConversion.h>
 
 namespace
 {
-// TODO: Maybe this should go in sys/Conf.h
-//       It's more flexible in that it properly handles float's - you can't
-//       just call sys::byteSwap(floatVal) because the compiler may change the
-//       byte-swapped float value into a valid IEEE value beforehand.
-// TODO: If we're really looking to optimize this, could specialize it for
-//       sizes of 2, 4, and 8 to eliminate the for loop
-template <typename T>
-inline
-void byteSwap(const void* in, T& out)
-{
-    const sys::ubyte* const inPtr = static_cast<const sys::ubyte*>(in);
-    sys::ubyte* const outPtr = reinterpret_cast<sys::ubyte*>(&out);
-
-    for (size_t ii = 0, jj = sizeof(T) - 1; ii < jj; ++ii, --jj)
-    {
-        outPtr[ii] = inPtr[jj];
-        outPtr[jj] = inPtr[ii];
-    }
-}
+// Buffers smaller than this aren't worth splitting across threads
+const size_t MIN_ELEMENTS_PER_CHUNK = 16 * 1024;
 
 class ByteSwapRunnable : public sys::Runnable
 {
@@ -61,7 +46,7 @@ public:
 
     virtual void run()
     {
-        sys::byteSwap(mBuffer, mElemSize, mNumElements);
+        cphd::swapBytes(mBuffer, mElemSize, mNumElements);
     }
 
 private:
@@ -88,26 +73,11 @@ public:
 
     virtual void run()
     {
-        InT real(0);
-        InT imag(0);
-
-        for (size_t row = 0, inIdx = 0, outIdx = 0; row < mDims.row; ++row)
-        {
-            for (size_t col = 0;
-                 col < mDims.col;
-                 ++col, inIdx += sizeof(std::complex<InT>), ++outIdx)
-            {
-                // Have to be careful here - can't treat mInput as a
-                // std::complex<InT> directly in case InT is a float (see
-                // explanation in byteSwap() comments)
-                const sys::ubyte* const input = mInput + inIdx;
-                byteSwap(input, real);
-                byteSwap(input + sizeof(InT), imag);
-
-                mOutput[outIdx] = std::complex<float>(real,
-                                                      imag);
-            }
-        }
+        cphd::promoteSamples(mInput,
+                             sizeof(std::complex<InT>),
+                             mDims.area(),
+                             true,
+                             mOutput);
     }
 
 private:
@@ -137,28 +107,15 @@ public:
 
     virtual void run()
     {
-        InT real(0);
-        InT imag(0);
-
-        for (size_t row = 0, inIdx = 0, outIdx = 0; row < mDims.row; ++row)
+        const size_t inRowSize = mDims.col * sizeof(std::complex<InT>);
+        for (size_t row = 0; row < mDims.row; ++row)
         {
-            const double scaleFactor(mScaleFactors[row]);
-
-            for (size_t col = 0;
-                 col < mDims.col;
-                 ++col, inIdx += sizeof(std::complex<InT>), ++outIdx)
-            {
-                // Have to be careful here - can't treat mInput as a
-                // std::complex<InT> directly in case InT is a float (see
-                // explanation in byteSwap() comments)
-                const sys::ubyte* const input = mInput + inIdx;
-                byteSwap(input, real);
-                byteSwap(input + sizeof(InT), imag);
-
-                mOutput[outIdx] = std::complex<float>(
-                        static_cast<float>(real * scaleFactor),
-                        static_cast<float>(imag * scaleFactor));
-            }
+            cphd::scaleSamples(mInput + row * inRowSize,
+                               sizeof(std::complex<InT>),
+                               mDims.col,
+                               true,
+                               mScaleFactors[row],
+                               mOutput + row * mDims.col);
         }
     }
 
@@ -172,75 +129,59 @@ private:
 template <typename InT>
 void byteSwapAndPromote(const void* input,
                       const types::RowCol<size_t>& dims,
-                      size_t numThreads,
+                      six::ThreadPool& threadPool,
                       std::complex<float>* output)
 {
-    if (numThreads <= 1)
-    {
-        ByteSwapAndPromoteRunnable<InT>(input, 0, dims.row, dims.col,output).run();
-    }
-    else
-    {
-        mt::ThreadGroup threads;
-        const mt::ThreadPlanner planner(dims.row, numThreads);
+    const mt::ThreadPlanner planner(
+            dims.row,
+            threadPool.getNumChunks(dims.area(), MIN_ELEMENTS_PER_CHUNK));
 
-        size_t threadNum(0);
-        size_t startRow(0);
-        size_t numRowsThisThread(0);
-        while (planner.getThreadInfo(threadNum++,
-                                     startRow,
-                                     numRowsThisThread))
-        {
-            std::auto_ptr<sys::Runnable> scaler(
-                new ByteSwapAndPromoteRunnable<InT>(
-                    input,
-                    startRow,
-                    numRowsThisThread,
-                    dims.col,
-                    output));
-            threads.createThread(scaler);
-        }
-
-        threads.joinAll();
+    std::vector<ByteSwapAndPromoteRunnable<InT> > runnables;
+    size_t threadNum(0);
+    size_t startRow(0);
+    size_t numRowsThisThread(0);
+    while (planner.getThreadInfo(threadNum++,
+                                 startRow,
+                                 numRowsThisThread))
+    {
+        runnables.push_back(ByteSwapAndPromoteRunnable<InT>(
+                input,
+                startRow,
+                numRowsThisThread,
+                dims.col,
+                output));
     }
+    threadPool.runEach(runnables);
 }
 
 template <typename InT>
 void byteSwapAndScale(const void* input,
                       const types::RowCol<size_t>& dims,
                       const double* scaleFactors,
-                      size_t numThreads,
+                      six::ThreadPool& threadPool,
                       std::complex<float>* output)
 {
-    if (numThreads <= 1)
-    {
-        ByteSwapAndScaleRunnable<InT>(input, 0, dims.row, dims.col,
-                                      scaleFactors, output).run();
-    }
-    else
-    {
-        mt::ThreadGroup threads;
-        const mt::ThreadPlanner planner(dims.row, numThreads);
+    const mt::ThreadPlanner planner(
+            dims.row,
+            threadPool.getNumChunks(dims.area(), MIN_ELEMENTS_PER_CHUNK));
 
-        size_t threadNum(0);
-        size_t startRow(0);
-        size_t numRowsThisThread(0);
-        while (planner.getThreadInfo(threadNum++,
-                                     startRow,
-                                     numRowsThisThread))
-        {
-            std::auto_ptr<sys::Runnable> scaler(new ByteSwapAndScaleRunnable<InT>(
-                    input,
-                    startRow,
-                    numRowsThisThread,
-                    dims.col,
-                    scaleFactors,
-                    output));
-            threads.createThread(scaler);
-        }
-
-        threads.joinAll();
+    std::vector<ByteSwapAndScaleRunnable<InT> > runnables;
+    size_t threadNum(0);
+    size_t startRow(0);
+    size_t numRowsThisThread(0);
+    while (planner.getThreadInfo(threadNum++,
+                                 startRow,
+                                 numRowsThisThread))
+    {
+        runnables.push_back(ByteSwapAndScaleRunnable<InT>(
+                input,
+                startRow,
+                numRowsThisThread,
+                dims.col,
+                scaleFactors,
+                output));
     }
+    threadPool.runEach(runnables);
 }
 }
 
@@ -251,52 +192,73 @@ void byteSwap(void* buffer,
               size_t numElements,
               size_t numThreads)
 {
-    if (numThreads <= 1)
-    {
-        sys::byteSwap(buffer,
-                      static_cast<unsigned short>(elemSize),
-                      numElements);
-    }
-    else
-    {
-        mt::ThreadGroup threads;
-        const mt::ThreadPlanner planner(numElements, numThreads);
+    six::ThreadPool threadPool(numThreads);
+    byteSwap(buffer, elemSize, numElements, threadPool);
+}
 
-        size_t threadNum(0);
-        size_t startElement(0);
-        size_t numElementsThisThread(0);
-        while (planner.getThreadInfo(threadNum++,
-                                     startElement,
-                                     numElementsThisThread))
-        {
-            std::auto_ptr<sys::Runnable> thread(new ByteSwapRunnable(
-                    buffer,
-                    elemSize,
-                    startElement,
-                    numElementsThisThread));
+void byteSwap(void* buffer,
+              size_t elemSize,
+              size_t numElements,
+              six::ThreadPool& threadPool)
+{
+    const mt::ThreadPlanner planner(
+            numElements,
+            threadPool.getNumChunks(numElements, MIN_ELEMENTS_PER_CHUNK));
 
-            threads.createThread(thread);
-        }
-        threads.joinAll();
+    std::vector<ByteSwapRunnable> runnables;
+    size_t threadNum(0);
+    size_t startElement(0);
+    size_t numElementsThisThread(0);
+    while (planner.getThreadInfo(threadNum++,
+                                 startElement,
+                                 numElementsThisThread))
+    {
+        runnables.push_back(ByteSwapRunnable(buffer,
+                                             elemSize,
+                                             startElement,
+                                             numElementsThisThread));
     }
+    threadPool.runEach(runnables);
 }
 
 void byteSwapAndPromote(const void* input,
+                        size_t elementSize,
+                        const types::RowCol<size_t>& dims,
+                        size_t numThreads,
+                        std::complex<float>* output)
+{
+    six::ThreadPool threadPool(numThreads);
+    byteSwapAndPromote(input, elementSize, dims, threadPool, output);
+}
+
+void byteSwapAndScale(const void* input,
                       size_t elementSize,
                       const types::RowCol<size_t>& dims,
+                      const double* scaleFactors,
                       size_t numThreads,
                       std::complex<float>* output)
+{
+    six::ThreadPool threadPool(numThreads);
+    byteSwapAndScale(input, elementSize, dims, scaleFactors, threadPool,
+                     output);
+}
+
+void byteSwapAndPromote(const void* input,
+                      size_t elementSize,
+                      const types::RowCol<size_t>& dims,
+                      six::ThreadPool& threadPool,
+                      std::complex<float>* output)
 {
     switch (elementSize)
     {
     case 2:
-        ::byteSwapAndPromote<sys::Int8_T>(input, dims, numThreads, output);
+        ::byteSwapAndPromote<sys::Int8_T>(input, dims, threadPool, output);
         break;
     case 4:
-        ::byteSwapAndPromote<sys::Int16_T>(input, dims, numThreads, output);
+        ::byteSwapAndPromote<sys::Int16_T>(input, dims, threadPool, output);
         break;
     case 8:
-        ::byteSwapAndPromote<float>(input, dims, numThreads, output);
+        ::byteSwapAndPromote<float>(input, dims, threadPool, output);
         break;
     default:
         throw except::Exception(Ctxt(
@@ -308,21 +270,21 @@ void byteSwapAndScale(const void* input,
                       size_t elementSize,
                       const types::RowCol<size_t>& dims,
                       const double* scaleFactors,
-                      size_t numThreads,
+                      six::ThreadPool& threadPool,
                       std::complex<float>* output)
 {
     switch (elementSize)
     {
     case 2:
-        ::byteSwapAndScale<sys::Int8_T>(input, dims, scaleFactors, numThreads,
+        ::byteSwapAndScale<sys::Int8_T>(input, dims, scaleFactors, threadPool,
                                         output);
         break;
     case 4:
-        ::byteSwapAndScale<sys::Int16_T>(input, dims, scaleFactors, numThreads,
+        ::byteSwapAndScale<sys::Int16_T>(input, dims, scaleFactors, threadPool,
                                          output);
         break;
     case 8:
-        ::byteSwapAndScale<float>(input, dims, scaleFactors, numThreads,
+        ::byteSwapAndScale<float>(input, dims, scaleFactors, threadPool,
                                   output);
         break;
     default:
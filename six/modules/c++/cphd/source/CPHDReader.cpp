@@ -34,25 +34,98 @@ namespace cphd
 CPHDReader::CPHDReader(std::shared_ptr<io::SeekableInputStream> inStream,
                        size_t numThreads,
                        const std::vector<std::string>& schemaPaths,
-                       std::shared_ptr<logging::Logger> logger)
+                       std::shared_ptr<logging::Logger> logger) :
+    mThreadPool(new six::ThreadPool(numThreads))
 {
-    initialize(inStream, numThreads, logger, schemaPaths);
+    initialize(inStream, LOAD_PVP, "", logger, schemaPaths);
+}
+
+CPHDReader::CPHDReader(std::shared_ptr<io::SeekableInputStream> inStream,
+                       size_t numThreads,
+                       PVPMode pvpMode,
+                       const std::vector<std::string>& schemaPaths,
+                       std::shared_ptr<logging::Logger> logger) :
+    mThreadPool(new six::ThreadPool(numThreads))
+{
+    initialize(inStream, pvpMode, "", logger, schemaPaths);
+}
+
+CPHDReader::CPHDReader(std::shared_ptr<io::SeekableInputStream> inStream,
+                       std::shared_ptr<six::ThreadPool> threadPool,
+                       PVPMode pvpMode,
+                       const std::vector<std::string>& schemaPaths,
+                       std::shared_ptr<logging::Logger> logger) :
+    mThreadPool(threadPool)
+{
+    initialize(inStream, pvpMode, "", logger, schemaPaths);
 }
 
 CPHDReader::CPHDReader(const std::string& fromFile,
                        size_t numThreads,
                        const std::vector<std::string>& schemaPaths,
-                       std::shared_ptr<logging::Logger> logger)
+                       std::shared_ptr<logging::Logger> logger) :
+    mThreadPool(new six::ThreadPool(numThreads))
 {
     initialize(std::shared_ptr<io::SeekableInputStream>(
-        new io::FileInputStream(fromFile)), numThreads, logger, schemaPaths);
+        new io::FileInputStream(fromFile)), LOAD_PVP, fromFile,
+        logger, schemaPaths);
+}
+
+CPHDReader::CPHDReader(const std::string& fromFile,
+                       size_t numThreads,
+                       PVPMode pvpMode,
+                       const std::vector<std::string>& schemaPaths,
+                       std::shared_ptr<logging::Logger> logger) :
+    mThreadPool(new six::ThreadPool(numThreads))
+{
+    initialize(std::shared_ptr<io::SeekableInputStream>(
+        new io::FileInputStream(fromFile)), pvpMode, fromFile,
+        logger, schemaPaths);
+}
+
+CPHDReader::CPHDReader(const std::string& fromFile,
+                       std::shared_ptr<six::ThreadPool> threadPool,
+                       PVPMode pvpMode,
+                       const std::vector<std::string>& schemaPaths,
+                       std::shared_ptr<logging::Logger> logger) :
+    mThreadPool(threadPool)
+{
+    initialize(std::shared_ptr<io::SeekableInputStream>(
+        new io::FileInputStream(fromFile)), pvpMode, fromFile,
+        logger, schemaPaths);
+}
+
+const PVPBlock& CPHDReader::getPVPBlock() const
+{
+    if (mPVPBlock.get() == NULL)
+    {
+        throw except::Exception(Ctxt(
+                "PVP block was not loaded; use getPVPView()"));
+    }
+    return *mPVPBlock;
+}
+
+const PVPView& CPHDReader::getPVPView() const
+{
+    if (mPVPView.get() == NULL)
+    {
+        throw except::Exception(Ctxt(
+                "PVP block was loaded; use getPVPBlock()"));
+    }
+    return *mPVPView;
 }
 
 void CPHDReader::initialize(std::shared_ptr<io::SeekableInputStream> inStream,
-                            size_t numThreads,
+                            PVPMode pvpMode,
+                            const std::string& pathname,
                             std::shared_ptr<logging::Logger> logger,
                             const std::vector<std::string>& schemaPaths)
 {
+    if (mThreadPool.get() == NULL)
+    {
+        throw except::Exception(Ctxt("A thread pool is required"));
+    }
+
     mFileHeader.read(*inStream);
 
     // Read in the XML string
@@ -73,16 +146,57 @@ void CPHDReader::initialize(std::shared_ptr<io::SeekableInputStream> inStream,
                         mFileHeader.getSupportBlockByteOffset(),
                         mFileHeader.getSupportBlockSize()));
 
-    // Load the PVPBlock into memory
-    mPVPBlock.reset(new PVPBlock(mMetadata->pvp, mMetadata->data));
-    mPVPBlock->load(*inStream,
-                    mFileHeader.getPvpBlockByteOffset(),
-                    mFileHeader.getPvpBlockSize(),
-                    numThreads);
+    if (pvpMode == VIEW_PVP)
+    {
+        viewPVP(*inStream, pathname);
+    }
+    else
+    {
+        // Load the PVPBlock into memory
+        mPVPBlock.reset(new PVPBlock(mMetadata->pvp, mMetadata->data));
+        mPVPBlock->load(*inStream,
+                        mFileHeader.getPvpBlockByteOffset(),
+                        mFileHeader.getPvpBlockSize(),
+                        *mThreadPool);
+    }
 
     // Setup for wideband reading
     mWideband.reset(new Wideband(inStream, *mMetadata,
                                  mFileHeader.getSignalBlockByteOffset(),
                                  mFileHeader.getSignalBlockSize()));
 }
+
+void CPHDReader::viewPVP(io::SeekableInputStream& inStream,
+                         const std::string& pathname)
+{
+    const sys::Off_T sizePVP = mFileHeader.getPvpBlockSize();
+    const sys::ubyte* pvpBlock = NULL;
+    if (!pathname.empty())
+    {
+        mPVPMapping.reset(new six::MappedFile(
+                pathname,
+                mFileHeader.getPvpBlockByteOffset(),
+                static_cast<size_t>(sizePVP)));
+        pvpBlock = mPVPMapping->getData();
+    }
+    else
+    {
+        // Can't map a stream, so just read the block without decoding it
+        mPVPBuffer.resize(static_cast<size_t>(sizePVP));
+        if (!mPVPBuffer.empty())
+        {
+            if (inStream.readAt(mFileHeader.getPvpBlockByteOffset(),
+                                reinterpret_cast<sys::byte*>(&mPVPBuffer[0]),
+                                mPVPBuffer.size()) !=
+                static_cast<sys::SSize_T>(mPVPBuffer.size()))
+            {
+                throw except::Exception(Ctxt("EOF reached during PVP read"));
+            }
+            pvpBlock = &mPVPBuffer[0];
+        }
+    }
+
+    mPVPView.reset(new PVPView(mMetadata->pvp, mMetadata->data,
+                               pvpBlock, sizePVP));
+}
 }
@@ -19,6 +19,13 @@
  * see <http://www.gnu.org/licenses/>.
  *
  */
+#include <deque>
+#include <exception>
+
+#include <mt/CriticalSection.h>
+#include <sys/ConditionVar.h>
+#include <sys/Mutex.h>
+#include <sys/Thread.h>
 #include <cphd/ByteSwap.h>
 #include <cphd/CPHDWriter.h>
 #include <cphd/CPHDXMLControl.h>
@@ -32,7 +39,15 @@ namespace cphd
 DataWriter::DataWriter(std::shared_ptr<io::SeekableOutputStream> stream,
                        size_t numThreads) :
     mStream(stream),
-    mNumThreads(numThreads == 0 ? sys::OS().getNumCPUs() : numThreads)
+    mThreadPool(new six::ThreadPool(
+            numThreads == 0 ? sys::OS().getNumCPUs() : numThreads))
+{
+}
+
+DataWriter::DataWriter(std::shared_ptr<io::SeekableOutputStream> stream,
+                       std::shared_ptr<six::ThreadPool> threadPool) :
+    mStream(stream),
+    mThreadPool(threadPool)
 {
 }
 
@@ -40,13 +55,204 @@ DataWriter::~DataWriter()
 {
 }
 
+/*
+ *  Ring of scratch buffers that are written to the stream on a background
+ *  thread, in the order they were filled
+ */
+class DataWriterLittleEndian::AsyncWriter
+{
+public:
+    AsyncWriter(io::SeekableOutputStream& stream,
+                size_t numBuffers,
+                size_t bufferSize) :
+        mStream(stream),
+        mBuffers(numBuffers, std::vector<sys::byte>(bufferSize)),
+        mNumQueued(0),
+        mNumWritten(0),
+        mShutdown(false),
+        mQueueChanged(&mMutex),
+        mBufferWritten(&mMutex)
+    {
+        mThread.reset(new sys::Thread(new Writer(*this)));
+        mThread->start();
+    }
+
+    ~AsyncWriter()
+    {
+        {
+            mt::CriticalSection<sys::Mutex> lock(&mMutex);
+            mShutdown = true;
+            mQueueChanged.broadcast();
+        }
+        try
+        {
+            mThread->join();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    //! Waits for the next buffer in the ring to be free
+    sys::byte* getBuffer()
+    {
+        const size_t numBuffers = mBuffers.size();
+        waitForWrites(mNumQueued < numBuffers ? 0 :
+                                                mNumQueued - numBuffers + 1);
+        return mBuffers[mNumQueued % numBuffers].data();
+    }
+
+    //! Queues the buffer from getBuffer() to be written
+    void write(size_t numBytes)
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        mSizes.push_back(numBytes);
+        ++mNumQueued;
+        mQueueChanged.broadcast();
+    }
+
+    //! Waits for every queued buffer to be written
+    void flush()
+    {
+        waitForWrites(mNumQueued);
+    }
+
+private:
+    class Writer : public sys::Runnable
+    {
+    public:
+        explicit Writer(AsyncWriter& writer) :
+            mWriter(writer)
+        {
+        }
+
+        virtual void run()
+        {
+            mWriter.run();
+        }
+
+    private:
+        AsyncWriter& mWriter;
+    };
+
+    void waitForWrites(size_t numWrites)
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        while (mNumWritten < numWrites && !mError.get())
+        {
+            mBufferWritten.wait();
+        }
+        if (mError.get())
+        {
+            throw except::Exception(*mError);
+        }
+    }
+
+    void run()
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        while (true)
+        {
+            while (!mShutdown && mSizes.empty())
+            {
+                mQueueChanged.wait();
+            }
+            if (mSizes.empty())
+            {
+                break;
+            }
+
+            const sys::byte* const buffer =
+                    mBuffers[mNumWritten % mBuffers.size()].data();
+            const size_t numBytes = mSizes.front();
+            lock.manualUnlock();
+
+            std::unique_ptr<except::Exception> error;
+            try
+            {
+                mStream.write(buffer, numBytes);
+            }
+            catch (const except::Exception& ex)
+            {
+                error.reset(new except::Exception(ex));
+            }
+            catch (const std::exception& ex)
+            {
+                error.reset(new except::Exception(Ctxt(ex.what())));
+            }
+            catch (...)
+            {
+                error.reset(new except::Exception(Ctxt("Unknown exception")));
+            }
+
+            lock.manualLock();
+            if (error.get())
+            {
+                // Nothing after a failed write can be written in order
+                mError.reset(error.release());
+                mSizes.clear();
+            }
+            else
+            {
+                mSizes.pop_front();
+                ++mNumWritten;
+            }
+            mBufferWritten.broadcast();
+        }
+    }
+
+private:
+    io::SeekableOutputStream& mStream;
+    std::vector<std::vector<sys::byte> > mBuffers;
+
+    // Only used by the thread that owns the DataWriter
+    size_t mNumQueued;
+
+    // Guarded by mMutex
+    std::deque<size_t> mSizes;
+    size_t mNumWritten;
+    bool mShutdown;
+    std::unique_ptr<except::Exception> mError;
+
+    sys::Mutex mMutex;
+    sys::ConditionVar mQueueChanged;
+    sys::ConditionVar mBufferWritten;
+    std::unique_ptr<sys::Thread> mThread;
+};
+
 DataWriterLittleEndian::DataWriterLittleEndian(
         std::shared_ptr<io::SeekableOutputStream> stream,
         size_t numThreads,
-        size_t scratchSize) :
+        size_t scratchSize,
+        size_t numScratchBuffers) :
     DataWriter(stream, numThreads),
     mScratchSize(scratchSize),
-    mScratch(new sys::byte[mScratchSize])
+    mScratch(numScratchBuffers > 1 ? NULL : new sys::byte[mScratchSize])
+{
+    if (numScratchBuffers > 1)
+    {
+        mAsyncWriter.reset(
+                new AsyncWriter(*mStream, numScratchBuffers, mScratchSize));
+    }
+}
+
+DataWriterLittleEndian::DataWriterLittleEndian(
+        std::shared_ptr<io::SeekableOutputStream> stream,
+        std::shared_ptr<six::ThreadPool> threadPool,
+        size_t scratchSize,
+        size_t numScratchBuffers) :
+    DataWriter(stream, threadPool),
+    mScratchSize(scratchSize),
+    mScratch(numScratchBuffers > 1 ? NULL : new sys::byte[mScratchSize])
+{
+    if (numScratchBuffers > 1)
+    {
+        mAsyncWriter.reset(
+                new AsyncWriter(*mStream, numScratchBuffers, mScratchSize));
+    }
+}
+
+DataWriterLittleEndian::~DataWriterLittleEndian()
 {
 }
 
@@ -61,17 +267,33 @@ void DataWriterLittleEndian::operator()(const sys::ubyte* data,
         const size_t dataToProcess =
                 std::min(mScratchSize, dataSize - dataProcessed);
 
-        memcpy(mScratch.get(), data + dataProcessed, dataToProcess);
+        sys::byte* const scratch = mAsyncWriter.get() ?
+                mAsyncWriter->getBuffer() : mScratch.get();
 
-        cphd::byteSwap(mScratch.get(),
+        memcpy(scratch, data + dataProcessed, dataToProcess);
+
+        cphd::byteSwap(scratch,
                        elementSize,
                        dataToProcess / elementSize,
-                       mNumThreads);
+                       *mThreadPool);
 
-        mStream->write(mScratch.get(), dataToProcess);
+        if (mAsyncWriter.get())
+        {
+            mAsyncWriter->write(dataToProcess);
+        }
+        else
+        {
+            mStream->write(scratch, dataToProcess);
+        }
 
         dataProcessed += dataToProcess;
     }
+
+    // Callers may seek or write directly to the stream next
+    if (mAsyncWriter.get())
+    {
+        mAsyncWriter->flush();
+    }
 }
 
 DataWriterBigEndian::DataWriterBigEndian(
@@ -80,6 +302,13 @@ DataWriterBigEndian::DataWriterBigEndian(
 {
 }
 
+DataWriterBigEndian::DataWriterBigEndian(
+        std::shared_ptr<io::SeekableOutputStream> stream,
+        std::shared_ptr<six::ThreadPool> threadPool) :
+    DataWriter(stream, threadPool)
+{
+}
+
 void DataWriterBigEndian::operator()(const sys::ubyte* data,
                                      size_t numElements,
                                      size_t elementSize)
@@ -92,53 +321,75 @@ CPHDWriter::CPHDWriter(const Metadata& metadata,
                        std::shared_ptr<io::SeekableOutputStream> outStream,
                        const std::vector<std::string>& schemaPaths,
                        size_t numThreads,
-                       size_t scratchSpaceSize) :
-    mMetadata(metadata),
-    mElementSize(metadata.data.getNumBytesPerSample()),
-    mScratchSpaceSize(scratchSpaceSize),
-    mNumThreads(numThreads),
-    mSchemaPaths(schemaPaths),
-    mStream(outStream)
+                       size_t scratchSpaceSize,
+                       size_t numScratchBuffers) :
+    CPHDWriter(metadata,
+               outStream,
+               std::make_shared<six::ThreadPool>(
+                       numThreads == 0 ? sys::OS().getNumCPUs() : numThreads),
+               schemaPaths,
+               scratchSpaceSize,
+               numScratchBuffers)
 {
-    // Get the correct dataWriter.
-    // The CPHD file needs to be big endian.
-    if (sys::isBigEndianSystem())
-    {
-        mDataWriter.reset(new DataWriterBigEndian(mStream, mNumThreads));
-    }
-    else
-    {
-        mDataWriter.reset(new DataWriterLittleEndian(mStream,
-                                                     mNumThreads,
-                                                     mScratchSpaceSize));
-    }
 }
 
 CPHDWriter::CPHDWriter(const Metadata& metadata,
                        const std::string& pathname,
                        const std::vector<std::string>& schemaPaths,
                        size_t numThreads,
-                       size_t scratchSpaceSize) :
+                       size_t scratchSpaceSize,
+                       size_t numScratchBuffers) :
+    CPHDWriter(metadata,
+               std::make_shared<io::FileOutputStream>(pathname),
+               std::make_shared<six::ThreadPool>(
+                       numThreads == 0 ? sys::OS().getNumCPUs() : numThreads),
+               schemaPaths,
+               scratchSpaceSize,
+               numScratchBuffers)
+{
+}
+
+CPHDWriter::CPHDWriter(const Metadata& metadata,
+                       const std::string& pathname,
+                       std::shared_ptr<six::ThreadPool> threadPool,
+                       const std::vector<std::string>& schemaPaths,
+                       size_t scratchSpaceSize,
+                       size_t numScratchBuffers) :
+    CPHDWriter(metadata,
+               std::make_shared<io::FileOutputStream>(pathname),
+               threadPool,
+               schemaPaths,
+               scratchSpaceSize,
+               numScratchBuffers)
+{
+}
+
+CPHDWriter::CPHDWriter(const Metadata& metadata,
+                       std::shared_ptr<io::SeekableOutputStream> outStream,
+                       std::shared_ptr<six::ThreadPool> threadPool,
+                       const std::vector<std::string>& schemaPaths,
+                       size_t scratchSpaceSize,
+                       size_t numScratchBuffers) :
     mMetadata(metadata),
     mElementSize(metadata.data.getNumBytesPerSample()),
     mScratchSpaceSize(scratchSpaceSize),
-    mNumThreads(numThreads),
-    mSchemaPaths(schemaPaths)
+    mNumScratchBuffers(numScratchBuffers),
+    mThreadPool(threadPool),
+    mSchemaPaths(schemaPaths),
+    mStream(outStream)
 {
-    // Initialize output stream
-    mStream.reset(new io::FileOutputStream(pathname));
-
     // Get the correct dataWriter.
     // The CPHD file needs to be big endian.
     if (sys::isBigEndianSystem())
     {
-        mDataWriter.reset(new DataWriterBigEndian(mStream, mNumThreads));
+        mDataWriter.reset(new DataWriterBigEndian(mStream, mThreadPool));
     }
     else
     {
         mDataWriter.reset(new DataWriterLittleEndian(mStream,
-                                                     mNumThreads,
-                                                     mScratchSpaceSize));
+                                                     mThreadPool,
+                                                     mScratchSpaceSize,
+                                                     mNumScratchBuffers));
     }
 }
 
@@ -276,6 +527,11 @@ void CPHDWriter::writeMetadata(const PVPBlock& pvpBlock)
         throw except::Exception(ostr.str());
     }
 
+    writeMetadata();
+}
+
+void CPHDWriter::writeMetadata()
+{
     const size_t numChannels = mMetadata.data.getNumChannels();
     size_t totalSupportSize = 0;
     size_t totalPVPSize = 0;
@@ -290,7 +546,8 @@ void CPHDWriter::writeMetadata(const PVPBlock& pvpBlock)
 
     for (size_t ii = 0; ii < numChannels; ++ii)
     {
-        totalPVPSize += pvpBlock.getPVPsize(ii);
+        totalPVPSize += mMetadata.data.getNumVectors(ii) *
+                mMetadata.data.getNumBytesPVPSet();
         totalCPHDSize += mMetadata.data.getNumVectors(ii) *
                 mMetadata.data.getNumSamples(ii) * mElementSize;
     }
@@ -323,6 +580,68 @@ void CPHDWriter::writePVPData(const PVPBlock& pvpBlock)
     }
 }
 
+void CPHDWriter::checkVectorRange(size_t channel,
+                                  size_t firstVector,
+                                  size_t numVectors) const
+{
+    if (channel >= mMetadata.data.getNumChannels())
+    {
+        std::ostringstream ostr;
+        ostr << "Channel " << channel << " is out of bounds";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+    if (firstVector + numVectors > mMetadata.data.getNumVectors(channel))
+    {
+        std::ostringstream ostr;
+        ostr << "Vectors [" << firstVector << ", "
+             << firstVector + numVectors << ") are out of bounds for channel "
+             << channel;
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+}
+
+void CPHDWriter::writePVPData(const sys::ubyte* data,
+                              size_t channel,
+                              size_t firstVector,
+                              size_t numVectors)
+{
+    checkVectorRange(channel, firstVector, numVectors);
+
+    const size_t numBytesPVP = mMetadata.data.getNumBytesPVPSet();
+    mStream->seek(mHeader.getPvpBlockByteOffset() +
+                          mMetadata.data.channels[channel].pvpArrayByteOffset +
+                          static_cast<sys::Off_T>(firstVector) * numBytesPVP,
+                  io::SeekableOutputStream::START);
+
+    //! The vector based parameters are always 64 bit
+    (*mDataWriter)(data, numVectors * numBytesPVP / 8, 8);
+}
+
+void CPHDWriter::writeSupportRowsImpl(const sys::ubyte* data,
+                                      const std::string& id,
+                                      size_t firstRow,
+                                      size_t numRows)
+{
+    const Data::SupportArray supportArray =
+            mMetadata.data.getSupportArrayById(id);
+    if (firstRow + numRows > supportArray.numRows)
+    {
+        std::ostringstream ostr;
+        ostr << "Rows [" << firstRow << ", " << firstRow + numRows
+             << ") are out of bounds for support array " << id;
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+
+    const size_t rowSize = supportArray.numCols * supportArray.bytesPerElement;
+    mStream->seek(mHeader.getSupportBlockByteOffset() +
+                          supportArray.arrayByteOffset +
+                          static_cast<sys::Off_T>(firstRow) * rowSize,
+                  io::SeekableOutputStream::START);
+    writeSupportDataImpl(data,
+                         numRows * supportArray.numCols,
+                         supportArray.bytesPerElement);
+}
+
 template <typename T>
 void CPHDWriter::writeCPHDData(const T* data,
                                size_t numElements,
@@ -362,4 +681,52 @@ template void CPHDWriter::writeCPHDData<std::complex<sys::Int16_T>>(
 
 template void CPHDWriter::writeCPHDData<std::complex<float>>(
         const std::complex<float>* data, size_t numElements, size_t channel);
+
+template <typename T>
+void CPHDWriter::writeCPHDData(const T* data,
+                               size_t channel,
+                               size_t firstVector,
+                               size_t numVectors)
+{
+    if (mMetadata.data.isCompressed())
+    {
+        throw except::Exception(Ctxt(
+                "Compressed signal data cannot be written by vector range"));
+    }
+    if (mElementSize != sizeof(T))
+    {
+        throw except::Exception(
+                Ctxt("Incorrect buffer data type used for metadata!"));
+    }
+
+    checkVectorRange(channel, firstVector, numVectors);
+
+    const size_t numSamples = mMetadata.data.getNumSamples(channel);
+    mStream->seek(mHeader.getSignalBlockByteOffset() +
+                          mMetadata.data.channels[channel].signalArrayByteOffset +
+                          static_cast<sys::Off_T>(firstVector) * numSamples *
+                                  mElementSize,
+                  io::SeekableOutputStream::START);
+
+    writeCPHDDataImpl(reinterpret_cast<const sys::ubyte*>(data),
+                      numVectors * numSamples);
+}
+
+template void CPHDWriter::writeCPHDData<std::complex<sys::Int8_T>>(
+        const std::complex<sys::Int8_T>* data,
+        size_t channel,
+        size_t firstVector,
+        size_t numVectors);
+
+template void CPHDWriter::writeCPHDData<std::complex<sys::Int16_T>>(
+        const std::complex<sys::Int16_T>* data,
+        size_t channel,
+        size_t firstVector,
+        size_t numVectors);
+
+template void CPHDWriter::writeCPHDData<std::complex<float>>(
+        const std::complex<float>* data,
+        size_t channel,
+        size_t firstVector,
+        size_t numVectors);
 }
@@ -26,6 +26,7 @@
 #include <xml/lite/MinidomParser.h>
 
 #include <six/XMLControl.h>
+#include <six/XMLControlFactory.h>
 #include <cphd/CPHDXMLControl.h>
 #include <cphd/CPHDXMLParser.h>
 #include <cphd/Enums.h>
@@ -80,10 +81,15 @@ std::string CPHDXMLControl::toXMLString(
         bool prettyPrint)
 {
     std::unique_ptr<xml::lite::Document> doc(toXML(metadata, schemaPaths));
+    if (!prettyPrint)
+    {
+        std::string xml;
+        six::appendXML(*doc->getRootElement(), xml);
+        return xml;
+    }
+
     io::StringStream ss;
-    (prettyPrint) ?
-            doc->getRootElement()->prettyPrint(ss) :
-            doc->getRootElement()->print(ss);
+    doc->getRootElement()->prettyPrint(ss);
     return ss.stream().str();
 }
 
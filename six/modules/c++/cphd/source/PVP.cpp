@@ -20,6 +20,7 @@
  *
  */
 
+#include <algorithm>
 #include <complex>
 #include <sys/Conf.h>
 #include <six/Init.h>
@@ -188,6 +189,65 @@ size_t Pvp::sizeInBytes() const
     return getReqSetSize() * PVPType::WORD_BYTE_SIZE;
 }
 
+namespace
+{
+void addParameter(const PVPType& param,
+                  const std::string& name,
+                  std::vector<APVPType>& parameters)
+{
+    if (!six::Init::isUndefined<size_t>(param.getOffset()))
+    {
+        APVPType parameter;
+        parameter.setData(param.getSize(),
+                          param.getOffset(),
+                          param.getFormat(),
+                          name);
+        parameters.push_back(parameter);
+    }
+}
+
+bool isBefore(const APVPType& lhs, const APVPType& rhs)
+{
+    return lhs.getOffset() < rhs.getOffset();
+}
+}
+
+std::vector<APVPType> Pvp::getParameters() const
+{
+    std::vector<APVPType> parameters;
+    addParameter(txTime, "txTime", parameters);
+    addParameter(txPos, "txPos", parameters);
+    addParameter(txVel, "txVel", parameters);
+    addParameter(rcvTime, "rcvTime", parameters);
+    addParameter(rcvPos, "rcvPos", parameters);
+    addParameter(rcvVel, "rcvVel", parameters);
+    addParameter(srpPos, "srpPos", parameters);
+    addParameter(ampSF, "ampSF", parameters);
+    addParameter(aFDOP, "aFDOP", parameters);
+    addParameter(aFRR1, "aFRR1", parameters);
+    addParameter(aFRR2, "aFRR2", parameters);
+    addParameter(fx1, "fx1", parameters);
+    addParameter(fx2, "fx2", parameters);
+    addParameter(fxN1, "fxN1", parameters);
+    addParameter(fxN2, "fxN2", parameters);
+    addParameter(toa1, "toa1", parameters);
+    addParameter(toa2, "toa2", parameters);
+    addParameter(toaE1, "toaE1", parameters);
+    addParameter(toaE2, "toaE2", parameters);
+    addParameter(tdTropoSRP, "tdTropoSRP", parameters);
+    addParameter(tdIonoSRP, "tdIonoSRP", parameters);
+    addParameter(sc0, "sc0", parameters);
+    addParameter(scss, "scss", parameters);
+    addParameter(signal, "signal", parameters);
+    for (auto it = addedPVP.begin(); it != addedPVP.end(); ++it)
+    {
+        addParameter(it->second, it->first, parameters);
+    }
+
+    std::stable_sort(parameters.begin(), parameters.end(), isBefore);
+    return parameters;
+}
+
 std::ostream& operator<< (std::ostream& os, const PVPType& p)
 {
     os << "    Size           : " << p.getSize() << "\n"
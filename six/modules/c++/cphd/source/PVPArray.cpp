@@ -0,0 +1,373 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include <six/Init.h>
+#include <cphd/PVPArray.h>
+
+namespace
+{
+// Convert between the binary and the six::Parameter form of an added PVP
+typedef six::Parameter (*DecodeFunc)(const sys::byte*);
+typedef void (*EncodeFunc)(const six::Parameter&, sys::byte*);
+
+template <typename T>
+six::Parameter decode(const sys::byte* input)
+{
+    T value;
+    memcpy(&value, input, sizeof(T));
+    six::Parameter param;
+    param.setValue(value);
+    return param;
+}
+
+template <typename T>
+void encode(const six::Parameter& param, sys::byte* output)
+{
+    const T value = cphd::AddedPVP<T>().getAddedPVP(param);
+    memcpy(output, &value, sizeof(T));
+}
+
+struct FormatCodec
+{
+    const char* format;
+    size_t size;
+    DecodeFunc decode;
+    EncodeFunc encode;
+};
+
+// Binary formats listed in table 10.2 of the CPHD 1.0 spec
+const FormatCodec CODECS[] =
+{
+    { "F4", sizeof(float), &decode<float>, &encode<float> },
+    { "F8", sizeof(double), &decode<double>, &encode<double> },
+    { "U1", sizeof(sys::Uint8_T), &decode<sys::Uint8_T>, &encode<sys::Uint8_T> },
+    { "U2", sizeof(sys::Uint16_T), &decode<sys::Uint16_T>, &encode<sys::Uint16_T> },
+    { "U4", sizeof(sys::Uint32_T), &decode<sys::Uint32_T>, &encode<sys::Uint32_T> },
+    { "U8", sizeof(sys::Uint64_T), &decode<sys::Uint64_T>, &encode<sys::Uint64_T> },
+    { "I1", sizeof(sys::Int8_T), &decode<sys::Int8_T>, &encode<sys::Int8_T> },
+    { "I2", sizeof(sys::Int16_T), &decode<sys::Int16_T>, &encode<sys::Int16_T> },
+    { "I4", sizeof(sys::Int32_T), &decode<sys::Int32_T>, &encode<sys::Int32_T> },
+    { "I8", sizeof(sys::Int64_T), &decode<sys::Int64_T>, &encode<sys::Int64_T> },
+    { "CI2", sizeof(std::complex<sys::Int8_T>),
+      &decode<std::complex<sys::Int8_T> >, &encode<std::complex<sys::Int8_T> > },
+    { "CI4", sizeof(std::complex<sys::Int16_T>),
+      &decode<std::complex<sys::Int16_T> >, &encode<std::complex<sys::Int16_T> > },
+    { "CI8", sizeof(std::complex<sys::Int32_T>),
+      &decode<std::complex<sys::Int32_T> >, &encode<std::complex<sys::Int32_T> > },
+    { "CI16", sizeof(std::complex<sys::Int64_T>),
+      &decode<std::complex<sys::Int64_T> >, &encode<std::complex<sys::Int64_T> > },
+    { "CF8", sizeof(std::complex<float>),
+      &decode<std::complex<float> >, &encode<std::complex<float> > },
+    { "CF16", sizeof(std::complex<double>),
+      &decode<std::complex<double> >, &encode<std::complex<double> > }
+};
+
+// Returns NULL for formats that are stored as strings
+const FormatCodec* findCodec(const std::string& format)
+{
+    for (size_t ii = 0; ii < sizeof(CODECS) / sizeof(CODECS[0]); ++ii)
+    {
+        if (format == CODECS[ii].format)
+        {
+            return &CODECS[ii];
+        }
+    }
+    return NULL;
+}
+
+template <typename T>
+inline void setColumn(const cphd::PVPType& param,
+                      size_t numBytesPerVector,
+                      const sys::byte* input,
+                      std::vector<T>& dest)
+{
+    const sys::byte* ptr = input + param.getByteOffset();
+    for (size_t ii = 0; ii < dest.size(); ++ii, ptr += numBytesPerVector)
+    {
+        memcpy(&dest[ii], ptr, sizeof(T));
+    }
+}
+
+inline void setColumn(const cphd::PVPType& param,
+                      size_t numBytesPerVector,
+                      const sys::byte* input,
+                      std::vector<cphd::Vector3>& dest)
+{
+    const sys::byte* ptr = input + param.getByteOffset();
+    for (size_t ii = 0; ii < dest.size(); ++ii, ptr += numBytesPerVector)
+    {
+        memcpy(&dest[ii][0], ptr, sizeof(double));
+        memcpy(&dest[ii][1], ptr + sizeof(double), sizeof(double));
+        memcpy(&dest[ii][2], ptr + 2 * sizeof(double), sizeof(double));
+    }
+}
+
+template <typename T>
+inline void getColumn(const std::vector<T>& src,
+                      const cphd::PVPType& param,
+                      size_t numBytesPerVector,
+                      sys::ubyte* output)
+{
+    sys::ubyte* ptr = output + param.getByteOffset();
+    for (size_t ii = 0; ii < src.size(); ++ii, ptr += numBytesPerVector)
+    {
+        memcpy(ptr, &src[ii], sizeof(T));
+    }
+}
+
+inline void getColumn(const std::vector<cphd::Vector3>& src,
+                      const cphd::PVPType& param,
+                      size_t numBytesPerVector,
+                      sys::ubyte* output)
+{
+    sys::ubyte* ptr = output + param.getByteOffset();
+    for (size_t ii = 0; ii < src.size(); ++ii, ptr += numBytesPerVector)
+    {
+        const double values[] = { src[ii][0], src[ii][1], src[ii][2] };
+        memcpy(ptr, values, sizeof(values));
+    }
+}
+
+template <typename T>
+inline void allocateOptional(const cphd::PVPType& param,
+                             size_t numVectors,
+                             std::vector<T>& dest)
+{
+    if (!six::Init::isUndefined<size_t>(param.getOffset()))
+    {
+        dest.assign(numVectors, six::Init::undefined<T>());
+    }
+}
+}
+
+namespace cphd
+{
+PVPArray::AddedColumn::AddedColumn() :
+    mElementSize(0)
+{
+}
+
+PVPArray::AddedColumn::AddedColumn(const APVPType& param, size_t numVectors) :
+    mFormat(param.getFormat()),
+    mElementSize(0),
+    mIsSet(numVectors, false)
+{
+    const FormatCodec* const codec = findCodec(mFormat);
+    if (codec)
+    {
+        mElementSize = codec->size;
+        mData.resize(mElementSize * numVectors);
+    }
+    else
+    {
+        mStrings.resize(numVectors);
+    }
+}
+
+six::Parameter PVPArray::AddedColumn::get(size_t vector) const
+{
+    if (mElementSize)
+    {
+        return findCodec(mFormat)->decode(&mData[vector * mElementSize]);
+    }
+    six::Parameter param;
+    param.setValue(mStrings[vector]);
+    return param;
+}
+
+void PVPArray::AddedColumn::set(size_t vector, const six::Parameter& value)
+{
+    if (mElementSize)
+    {
+        findCodec(mFormat)->encode(value, &mData[vector * mElementSize]);
+    }
+    else
+    {
+        mStrings[vector] = value.str();
+    }
+    mIsSet[vector] = true;
+}
+
+void PVPArray::AddedColumn::setBytes(size_t vector,
+                                     const sys::byte* input,
+                                     size_t byteSize)
+{
+    if (mElementSize)
+    {
+        memcpy(&mData[vector * mElementSize], input, mElementSize);
+    }
+    else
+    {
+        mStrings[vector].assign(input, byteSize);
+    }
+    mIsSet[vector] = true;
+}
+
+void PVPArray::AddedColumn::getBytes(size_t vector,
+                                     size_t byteSize,
+                                     sys::ubyte* output) const
+{
+    if (!mIsSet[vector])
+    {
+        throw except::Exception(Ctxt(
+            "Incorrect number of additional parameters instantiated"));
+    }
+    if (mElementSize)
+    {
+        memcpy(output, &mData[vector * mElementSize], mElementSize);
+    }
+    else
+    {
+        const std::string& value = mStrings[vector];
+        const size_t numBytes = std::min(value.size(), byteSize);
+        memcpy(output, value.data(), numBytes);
+        memset(output + numBytes, 0, byteSize - numBytes);
+    }
+}
+
+PVPArray::PVPArray()
+{
+}
+
+PVPArray::PVPArray(const Pvp& p, size_t numVectors) :
+    txTime(numVectors, six::Init::undefined<double>()),
+    txPos(numVectors, six::Init::undefined<Vector3>()),
+    txVel(numVectors, six::Init::undefined<Vector3>()),
+    rcvTime(numVectors, six::Init::undefined<double>()),
+    rcvPos(numVectors, six::Init::undefined<Vector3>()),
+    rcvVel(numVectors, six::Init::undefined<Vector3>()),
+    srpPos(numVectors, six::Init::undefined<Vector3>()),
+    aFDOP(numVectors, six::Init::undefined<double>()),
+    aFRR1(numVectors, six::Init::undefined<double>()),
+    aFRR2(numVectors, six::Init::undefined<double>()),
+    fx1(numVectors, six::Init::undefined<double>()),
+    fx2(numVectors, six::Init::undefined<double>()),
+    toa1(numVectors, six::Init::undefined<double>()),
+    toa2(numVectors, six::Init::undefined<double>()),
+    tdTropoSRP(numVectors, six::Init::undefined<double>()),
+    sc0(numVectors, six::Init::undefined<double>()),
+    scss(numVectors, six::Init::undefined<double>())
+{
+    allocateOptional(p.ampSF, numVectors, ampSF);
+    allocateOptional(p.fxN1, numVectors, fxN1);
+    allocateOptional(p.fxN2, numVectors, fxN2);
+    allocateOptional(p.toaE1, numVectors, toaE1);
+    allocateOptional(p.toaE2, numVectors, toaE2);
+    allocateOptional(p.tdIonoSRP, numVectors, tdIonoSRP);
+    allocateOptional(p.signal, numVectors, signal);
+
+    for (auto it = p.addedPVP.begin(); it != p.addedPVP.end(); ++it)
+    {
+        addedPVP[it->first] = AddedColumn(it->second, numVectors);
+    }
+}
+
+void PVPArray::write(const Pvp& p,
+                     size_t numBytesPerVector,
+                     const sys::byte* input)
+{
+    ::setColumn(p.txTime, numBytesPerVector, input, txTime);
+    ::setColumn(p.txPos, numBytesPerVector, input, txPos);
+    ::setColumn(p.txVel, numBytesPerVector, input, txVel);
+    ::setColumn(p.rcvTime, numBytesPerVector, input, rcvTime);
+    ::setColumn(p.rcvPos, numBytesPerVector, input, rcvPos);
+    ::setColumn(p.rcvVel, numBytesPerVector, input, rcvVel);
+    ::setColumn(p.srpPos, numBytesPerVector, input, srpPos);
+    ::setColumn(p.aFDOP, numBytesPerVector, input, aFDOP);
+    ::setColumn(p.aFRR1, numBytesPerVector, input, aFRR1);
+    ::setColumn(p.aFRR2, numBytesPerVector, input, aFRR2);
+    ::setColumn(p.fx1, numBytesPerVector, input, fx1);
+    ::setColumn(p.fx2, numBytesPerVector, input, fx2);
+    ::setColumn(p.toa1, numBytesPerVector, input, toa1);
+    ::setColumn(p.toa2, numBytesPerVector, input, toa2);
+    ::setColumn(p.tdTropoSRP, numBytesPerVector, input, tdTropoSRP);
+    ::setColumn(p.sc0, numBytesPerVector, input, sc0);
+    ::setColumn(p.scss, numBytesPerVector, input, scss);
+
+    // Disabled optional columns are empty, so these are no-ops for them
+    ::setColumn(p.ampSF, numBytesPerVector, input, ampSF);
+    ::setColumn(p.fxN1, numBytesPerVector, input, fxN1);
+    ::setColumn(p.fxN2, numBytesPerVector, input, fxN2);
+    ::setColumn(p.toaE1, numBytesPerVector, input, toaE1);
+    ::setColumn(p.toaE2, numBytesPerVector, input, toaE2);
+    ::setColumn(p.tdIonoSRP, numBytesPerVector, input, tdIonoSRP);
+    ::setColumn(p.signal, numBytesPerVector, input, signal);
+
+    for (auto it = p.addedPVP.begin(); it != p.addedPVP.end(); ++it)
+    {
+        AddedColumn& column = addedPVP.find(it->first)->second;
+        const sys::byte* ptr = input + it->second.getByteOffset();
+        for (size_t ii = 0; ii < getNumVectors(); ++ii, ptr += numBytesPerVector)
+        {
+            column.setBytes(ii, ptr, it->second.getByteSize());
+        }
+    }
+}
+
+void PVPArray::read(const Pvp& p,
+                    size_t numBytesPerVector,
+                    sys::ubyte* output) const
+{
+    ::getColumn(txTime, p.txTime, numBytesPerVector, output);
+    ::getColumn(txPos, p.txPos, numBytesPerVector, output);
+    ::getColumn(txVel, p.txVel, numBytesPerVector, output);
+    ::getColumn(rcvTime, p.rcvTime, numBytesPerVector, output);
+    ::getColumn(rcvPos, p.rcvPos, numBytesPerVector, output);
+    ::getColumn(rcvVel, p.rcvVel, numBytesPerVector, output);
+    ::getColumn(srpPos, p.srpPos, numBytesPerVector, output);
+    ::getColumn(aFDOP, p.aFDOP, numBytesPerVector, output);
+    ::getColumn(aFRR1, p.aFRR1, numBytesPerVector, output);
+    ::getColumn(aFRR2, p.aFRR2, numBytesPerVector, output);
+    ::getColumn(fx1, p.fx1, numBytesPerVector, output);
+    ::getColumn(fx2, p.fx2, numBytesPerVector, output);
+    ::getColumn(toa1, p.toa1, numBytesPerVector, output);
+    ::getColumn(toa2, p.toa2, numBytesPerVector, output);
+    ::getColumn(tdTropoSRP, p.tdTropoSRP, numBytesPerVector, output);
+    ::getColumn(sc0, p.sc0, numBytesPerVector, output);
+    ::getColumn(scss, p.scss, numBytesPerVector, output);
+
+    ::getColumn(ampSF, p.ampSF, numBytesPerVector, output);
+    ::getColumn(fxN1, p.fxN1, numBytesPerVector, output);
+    ::getColumn(fxN2, p.fxN2, numBytesPerVector, output);
+    ::getColumn(toaE1, p.toaE1, numBytesPerVector, output);
+    ::getColumn(toaE2, p.toaE2, numBytesPerVector, output);
+    ::getColumn(tdIonoSRP, p.tdIonoSRP, numBytesPerVector, output);
+    ::getColumn(signal, p.signal, numBytesPerVector, output);
+
+    if (addedPVP.size() != p.addedPVP.size())
+    {
+        throw except::Exception(Ctxt(
+            "Incorrect number of additional parameters instantiated"));
+    }
+    for (auto it = p.addedPVP.begin(); it != p.addedPVP.end(); ++it)
+    {
+        const AddedColumn& column = addedPVP.find(it->first)->second;
+        sys::ubyte* ptr = output + it->second.getByteOffset();
+        for (size_t ii = 0; ii < getNumVectors(); ++ii, ptr += numBytesPerVector)
+        {
+            column.getBytes(ii, it->second.getByteSize(), ptr);
+        }
+    }
+}
+}
@@ -34,371 +34,87 @@
 
 namespace
 {
-// Set data from data block into data struct
-template <typename T> inline void setData(const sys::byte* data,
-                    T& dest)
+// Optional parameters are undefined until set, and have no storage
+// at all if they are not enabled
+template <typename T> inline bool isSet(const std::vector<T>& column,
+                                        size_t vector)
 {
-    memcpy(&dest, data, sizeof(T));
+    return !column.empty() && !six::Init::isUndefined<T>(column[vector]);
 }
 
-inline void setData(const sys::byte* data,
-                    cphd::Vector3& dest)
+template <typename T> inline T getOptional(const std::vector<T>& column,
+                                           size_t vector)
 {
-    setData(data, dest[0]);
-    setData(data + sizeof(double), dest[1]);
-    setData(data + 2*sizeof(double), dest[2]);
-}
-
-// Get data from data struct and put into data block
-template <typename T> inline void getData(sys::ubyte* dest,
-                    T value)
-{
-    memcpy(dest, &value, sizeof(T));
-}
-
-template <typename T> inline void getData(sys::ubyte* dest,
-                    T* value, size_t size)
-{
-    memcpy(dest, value, size);
-}
-
-inline void getData(sys::ubyte* dest,
-                    const cphd::Vector3& value)
-{
-    getData(dest, value[0]);
-    getData(dest + sizeof(double), value[1]);
-    getData(dest + 2*sizeof(double), value[2]);
-}
+    if (!isSet(column, vector))
+    {
+        throw except::Exception(Ctxt(
+                        "Parameter was not set"));
+    }
+    return column[vector];
 }
 
-namespace cphd
+// Print a single PVP set of a channel
+void printVector(std::ostream& os, const cphd::PVPArray& p, size_t jj)
 {
+    os << "  TxTime         : " << p.txTime[jj] << "\n"
+        << "  TxPos         : " << p.txPos[jj] << "\n"
+        << "  TxVel         : " << p.txVel[jj] << "\n"
+        << "  RcvTime       : " << p.rcvTime[jj] << "\n"
+        << "  RcvPos        : " << p.rcvPos[jj] << "\n"
+        << "  RcvVel        : " << p.rcvVel[jj] << "\n"
+        << "  SRPPos        : " << p.srpPos[jj] << "\n"
+        << "  aFDOP         : " << p.aFDOP[jj] << "\n"
+        << "  aFRR1         : " << p.aFRR1[jj] << "\n"
+        << "  aFRR2         : " << p.aFRR2[jj] << "\n"
+        << "  Fx1           : " << p.fx1[jj] << "\n"
+        << "  Fx2           : " << p.fx2[jj] << "\n"
+        << "  TOA1          : " << p.toa1[jj] << "\n"
+        << "  TOA2          : " << p.toa2[jj] << "\n"
+        << "  TdTropoSRP    : " << p.tdTropoSRP[jj] << "\n"
+        << "  SC0           : " << p.sc0[jj] << "\n"
+        << "  SCSS          : " << p.scss[jj] << "\n";
 
-PVPBlock::PVPSet::PVPSet() :
-    txTime(six::Init::undefined<double>()),
-    txPos(six::Init::undefined<Vector3>()),
-    txVel(six::Init::undefined<Vector3>()),
-    rcvTime(six::Init::undefined<double>()),
-    rcvPos(six::Init::undefined<Vector3>()),
-    rcvVel(six::Init::undefined<Vector3>()),
-    srpPos(six::Init::undefined<Vector3>()),
-    aFDOP(six::Init::undefined<double>()),
-    aFRR1(six::Init::undefined<double>()),
-    aFRR2(six::Init::undefined<double>()),
-    fx1(six::Init::undefined<double>()),
-    fx2(six::Init::undefined<double>()),
-    toa1(six::Init::undefined<double>()),
-    toa2(six::Init::undefined<double>()),
-    tdTropoSRP(six::Init::undefined<double>()),
-    sc0(six::Init::undefined<double>()),
-    scss(six::Init::undefined<double>())
-{
-}
-
-void PVPBlock::PVPSet::write(const PVPBlock& pvpBlock, const Pvp& p, const sys::byte* input)
-{
-    ::setData(input + p.txTime.getByteOffset(), txTime);
-    ::setData(input + p.txPos.getByteOffset(), txPos);
-    ::setData(input + p.txVel.getByteOffset(), txVel);
-    ::setData(input + p.rcvTime.getByteOffset(), rcvTime);
-    ::setData(input + p.rcvPos.getByteOffset(), rcvPos);
-    ::setData(input + p.rcvVel.getByteOffset(), rcvVel);
-    ::setData(input + p.srpPos.getByteOffset(), srpPos);
-    ::setData(input + p.aFDOP.getByteOffset(), aFDOP);
-    ::setData(input + p.aFRR1.getByteOffset(), aFRR1);
-    ::setData(input + p.aFRR2.getByteOffset(), aFRR2);
-    ::setData(input + p.fx1.getByteOffset(), fx1);
-    ::setData(input + p.fx2.getByteOffset(), fx2);
-    ::setData(input + p.toa1.getByteOffset(), toa1);
-    ::setData(input + p.toa2.getByteOffset(), toa2);
-    ::setData(input + p.tdTropoSRP.getByteOffset(), tdTropoSRP);
-    ::setData(input + p.sc0.getByteOffset(), sc0);
-    ::setData(input + p.scss.getByteOffset(), scss);
-
-    if (pvpBlock.hasAmpSF())
-    {
-        ampSF.reset(new double());
-        ::setData(input + p.ampSF.getByteOffset(), *ampSF);
-    }
-    if (pvpBlock.hasFxN1())
+    if (isSet(p.ampSF, jj))
     {
-        fxN1.reset(new double());
-        ::setData(input + p.fxN1.getByteOffset(), *fxN1);
+        os << "  AmpSF         : " << p.ampSF[jj] << "\n";
     }
-    if (pvpBlock.hasFxN2())
+    if (isSet(p.fxN1, jj))
     {
-        fxN2.reset(new double());
-        ::setData(input + p.fxN2.getByteOffset(), *fxN2);
+        os << "  FxN1          : " << p.fxN1[jj] << "\n";
     }
-    if (pvpBlock.hasToaE1())
+    if (isSet(p.fxN2, jj))
     {
-        toaE1.reset(new double());
-        ::setData(input + p.toaE1.getByteOffset(), *toaE1);
+        os << "  FxN2          : " << p.fxN2[jj] << "\n";
     }
-    if (pvpBlock.hasToaE2())
+    if (isSet(p.toaE1, jj))
     {
-        toaE2.reset(new double());
-        ::setData(input + p.toaE2.getByteOffset(), *toaE2);
+        os << "  TOAE1         : " << p.toaE1[jj] << "\n";
     }
-    if (pvpBlock.hasTDIonoSRP())
+    if (isSet(p.toaE2, jj))
     {
-        tdIonoSRP.reset(new double());
-        ::setData(input + p.tdIonoSRP.getByteOffset(), *tdIonoSRP);
+        os << "  TOAE2         : " << p.toaE2[jj] << "\n";
     }
-    if (pvpBlock.hasSignal())
+    if (isSet(p.tdIonoSRP, jj))
     {
-        signal.reset(new sys::Int64_T());
-        ::setData(input + p.signal.getByteOffset(), *signal);
+        os << "  TdIonoSRP     : " << p.tdIonoSRP[jj] << "\n";
     }
-    for (auto it = p.addedPVP.begin(); it != p.addedPVP.end(); ++it)
+    if (isSet(p.signal, jj))
     {
-        if (it->second.getFormat() == "F4")
-        {
-            float val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
-        }
-        else if (it->second.getFormat() == "F8")
-        {
-            double val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
-        }
-        else if (it->second.getFormat() == "U1")
-        {
-            sys::Uint8_T val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
-        }
-        else if (it->second.getFormat() == "U2")
-        {
-            sys::Uint16_T val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
-        }
-        else if (it->second.getFormat() == "U4")
-        {
-            sys::Uint32_T val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
-        }
-        else if (it->second.getFormat() == "U8")
-        {
-            sys::Uint64_T val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
-        }
-        else if (it->second.getFormat() == "I1")
-        {
-            sys::Int8_T val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
-        }
-        else if (it->second.getFormat() == "I2")
-        {
-            sys::Int16_T val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
-        }
-        else if (it->second.getFormat() == "I4")
-        {
-            sys::Int32_T val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
-        }
-        else if (it->second.getFormat() == "I8")
-        {
-            sys::Int64_T val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
-        }
-        else if (it->second.getFormat() == "CI2")
-        {
-            std::complex<sys::Int8_T> val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
-        }
-        else if (it->second.getFormat() == "CI4")
-        {
-            std::complex<sys::Int16_T> val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
-        }
-        else if (it->second.getFormat() == "CI8")
-        {
-            std::complex<sys::Int32_T> val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
-        }
-        else if (it->second.getFormat() == "CI16")
-        {
-            std::complex<sys::Int64_T> val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
-        }
-        else if (it->second.getFormat() == "CF8")
-        {
-            std::complex<float> val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
-        }
-        else if (it->second.getFormat() == "CF16")
-        {
-            std::complex<double> val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
-        }
-        else
-        {
-            std::string val;
-            val.assign(input + it->second.getByteOffset(), it->second.getByteSize());
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
-        }
+        os << "  SIGNAL     : " << p.signal[jj] << "\n";
     }
-}
 
-void PVPBlock::PVPSet::read(const Pvp& p, sys::ubyte* dest) const
-{
-    ::getData(dest + p.txTime.getByteOffset(), txTime);
-    ::getData(dest + p.txPos.getByteOffset(), txPos);
-    ::getData(dest + p.txVel.getByteOffset(), txVel);
-    ::getData(dest + p.rcvTime.getByteOffset(), rcvTime);
-    ::getData(dest + p.rcvPos.getByteOffset(), rcvPos);
-    ::getData(dest + p.rcvVel.getByteOffset(), rcvVel);
-    ::getData(dest + p.srpPos.getByteOffset(), srpPos);
-    ::getData(dest + p.aFDOP.getByteOffset(), aFDOP);
-    ::getData(dest + p.aFRR1.getByteOffset(), aFRR1);
-    ::getData(dest + p.aFRR2.getByteOffset(), aFRR2);
-    ::getData(dest + p.fx1.getByteOffset(), fx1);
-    ::getData(dest + p.fx2.getByteOffset(), fx2);
-    ::getData(dest + p.toa1.getByteOffset(), toa1);
-    ::getData(dest + p.toa2.getByteOffset(), toa2);
-    ::getData(dest + p.tdTropoSRP.getByteOffset(), tdTropoSRP);
-    ::getData(dest + p.sc0.getByteOffset(), sc0);
-    ::getData(dest + p.scss.getByteOffset(), scss);
-
-    if (ampSF.get())
-    {
-        ::getData(dest + p.ampSF.getByteOffset(), *ampSF);
-    }
-    if (fxN1.get())
-    {
-        ::getData(dest + p.fxN1.getByteOffset(), *fxN1);
-    }
-    if (fxN2.get())
-    {
-        ::getData(dest + p.fxN2.getByteOffset(), *fxN2);
-    }
-    if (toaE1.get())
-    {
-        ::getData(dest + p.toaE1.getByteOffset(), *toaE1);
-    }
-    if (toaE2.get())
-    {
-        ::getData(dest + p.toaE2.getByteOffset(), *toaE2);
-    }
-    if (tdIonoSRP.get())
-    {
-        ::getData(dest + p.tdIonoSRP.getByteOffset(), *tdIonoSRP);
-    }
-    if (signal.get())
-    {
-        ::getData(dest + p.signal.getByteOffset(), *signal);
-    }
-    if (addedPVP.size() != p.addedPVP.size())
-    {
-        throw except::Exception(Ctxt(
-            "Incorrect number of additional parameters instantiated"));
-    }
     for (auto it = p.addedPVP.begin(); it != p.addedPVP.end(); ++it)
     {
-        if (it->second.getFormat() == "F4")
-        {
-            ::getData(dest + it->second.getByteOffset(), static_cast<float>(addedPVP.find(it->first)->second));
-        }
-        else if (it->second.getFormat() == "F8")
-        {
-            ::getData(dest + it->second.getByteOffset(), static_cast<double>(addedPVP.find(it->first)->second));
-        }
-        else if (it->second.getFormat() == "U1")
-        {
-            ::getData(dest + it->second.getByteOffset(), static_cast<sys::Uint8_T>(addedPVP.find(it->first)->second));
-        }
-        else if (it->second.getFormat() == "U2")
-        {
-            ::getData(dest + it->second.getByteOffset(), static_cast<sys::Uint16_T>(addedPVP.find(it->first)->second));
-        }
-        else if (it->second.getFormat() == "U4")
-        {
-            ::getData(dest + it->second.getByteOffset(), static_cast<sys::Uint32_T>(addedPVP.find(it->first)->second));
-        }
-        else if (it->second.getFormat() == "U8")
-        {
-            ::getData(dest + it->second.getByteOffset(), static_cast<sys::Uint64_T>(addedPVP.find(it->first)->second));
-        }
-        else if (it->second.getFormat() == "I1")
-        {
-            ::getData(dest + it->second.getByteOffset(), static_cast<sys::Int8_T>(addedPVP.find(it->first)->second));
-        }
-        else if (it->second.getFormat() == "I2")
-        {
-            ::getData(dest + it->second.getByteOffset(), static_cast<sys::Int16_T>(addedPVP.find(it->first)->second));
-        }
-        else if (it->second.getFormat() == "I4")
-        {
-            ::getData(dest + it->second.getByteOffset(), static_cast<sys::Int32_T>(addedPVP.find(it->first)->second));
-        }
-        else if (it->second.getFormat() == "I8")
-        {
-            ::getData(dest + it->second.getByteOffset(), static_cast<sys::Int64_T>(addedPVP.find(it->first)->second));
-        }
-        else if (it->second.getFormat() == "CI2")
-        {
-            ::getData(dest + it->second.getByteOffset(), addedPVP.find(it->first)->second.getComplex<sys::Int8_T>());
-        }
-        else if (it->second.getFormat() == "CI4")
-        {
-            ::getData(dest + it->second.getByteOffset(), addedPVP.find(it->first)->second.getComplex<sys::Int16_T>());
-        }
-        else if (it->second.getFormat() == "CI8")
-        {
-            ::getData(dest + it->second.getByteOffset(), addedPVP.find(it->first)->second.getComplex<sys::Int32_T>());
-        }
-        else if (it->second.getFormat() == "CI16")
+        if (it->second.isSet(jj))
         {
-            ::getData(dest + it->second.getByteOffset(), addedPVP.find(it->first)->second.getComplex<sys::Int64_T>());
-        }
-        else if (it->second.getFormat() == "CF8")
-        {
-            ::getData(dest + it->second.getByteOffset(), addedPVP.find(it->first)->second.getComplex<float>());
-        }
-        else if (it->second.getFormat() == "CF16")
-        {
-            ::getData(dest + it->second.getByteOffset(), addedPVP.find(it->first)->second.getComplex<double>());
-        }
-        else
-        {
-            ::getData(dest + it->second.getByteOffset(), addedPVP.find(it->first)->second.str().c_str(), it->second.getByteSize());
+            os << "  Additional Parameter : " << it->second.get(jj).str() << "\n";
         }
     }
 }
+}
+
+namespace cphd
+{
 
 /*
  * Initialize PVP Array with a data object
@@ -414,10 +130,10 @@ PVPBlock::PVPBlock(const Pvp& p, const Data& d) :
 {
     mPvp = p;
     mNumBytesPerVector = d.getNumBytesPVPSet();
-    mData.resize(d.getNumChannels());
+    mData.reserve(d.getNumChannels());
     for (size_t ii = 0; ii < d.getNumChannels(); ++ii)
     {
-        mData[ii].resize(d.getNumVectors(ii));
+        mData.push_back(PVPArray(mPvp, d.getNumVectors(ii)));
     }
     size_t calculateBytesPerVector = mPvp.getReqSetSize()*sizeof(double);
     if (six::Init::isUndefined<size_t>(mNumBytesPerVector) ||
@@ -446,15 +162,15 @@ PVPBlock::PVPBlock(size_t numChannels,
     mTDIonoSRPEnabled(!six::Init::isUndefined<size_t>(p.tdIonoSRP.getOffset())),
     mSignalEnabled(!six::Init::isUndefined<size_t>(p.signal.getOffset()))
 {
-    mData.resize(numChannels);
     if(numChannels != numVectors.size())
     {
         throw except::Exception(Ctxt(
                 "number of vector dims provided does not match number of channels"));
     }
+    mData.reserve(numChannels);
     for (size_t ii = 0; ii < numChannels; ++ii)
     {
-        mData[ii].resize(numVectors[ii]);
+        mData.push_back(PVPArray(mPvp, numVectors[ii]));
     }
     size_t calculateBytesPerVector = mPvp.getReqSetSize()*sizeof(double);
     if (six::Init::isUndefined<size_t>(mNumBytesPerVector) ||
@@ -480,13 +196,9 @@ PVPBlock::PVPBlock(size_t numChannels,
 
     for (size_t channel = 0; channel < numChannels; ++channel)
     {
-        const sys::byte* buf = static_cast<const sys::byte*>(data[channel]);
-
-        for (size_t vector = 0; vector < numVectors[channel]; ++vector)
-        {
-            mData[channel][vector].write(*this, mPvp, buf);
-            buf += mPvp.sizeInBytes();
-        }
+        mData[channel].write(mPvp,
+                             mPvp.sizeInBytes(),
+                             static_cast<const sys::byte*>(data[channel]));
     }
 }
 
@@ -502,7 +214,7 @@ void PVPBlock::verifyChannelVector(size_t channel, size_t vector) const
         throw except::Exception(Ctxt(
                 "Invalid channel number: " + str::toString<size_t>(channel)));
     }
-    if (vector >= mData[channel].size())
+    if (vector >= mData[channel].getNumVectors())
     {
         throw except::Exception(Ctxt(
                 "Invalid vector number: " + str::toString<size_t>(vector)));
@@ -512,7 +224,13 @@ void PVPBlock::verifyChannelVector(size_t channel, size_t vector) const
 size_t PVPBlock::getPVPsize(size_t channel) const
 {
     verifyChannelVector(channel, 0);
-    return getNumBytesPVPSet() * mData[channel].size();
+    return getNumBytesPVPSet() * mData[channel].getNumVectors();
+}
+
+const PVPArray& PVPBlock::getPVPArray(size_t channel) const
+{
+    verifyChannelVector(channel, 0);
+    return mData[channel];
 }
 
 void PVPBlock::getPVPdata(size_t channel,
@@ -529,21 +247,33 @@ void PVPBlock::getPVPdata(size_t channel,
                           void* data) const
 {
     verifyChannelVector(channel, 0);
-    const size_t numBytes = getNumBytesPVPSet();
-    sys::ubyte* ptr = static_cast<sys::ubyte*>(data);
+    mData[channel].read(mPvp,
+                        getNumBytesPVPSet(),
+                        static_cast<sys::ubyte*>(data));
+}
 
-    for (size_t ii = 0;
-         ii < mData[channel].size();
-         ++ii, ptr += numBytes)
-    {
-        mData[channel][ii].read(mPvp, ptr);
-    }
+void PVPBlock::setPVPdata(size_t channel,
+                          const void* data)
+{
+    verifyChannelVector(channel, 0);
+    mData[channel].write(mPvp,
+                         getNumBytesPVPSet(),
+                         static_cast<const sys::byte*>(data));
 }
 
 sys::Off_T PVPBlock::load(io::SeekableInputStream& inStream,
                      sys::Off_T startPVP,
                      sys::Off_T sizePVP,
                      size_t numThreads)
+{
+    six::ThreadPool threadPool(numThreads);
+    return load(inStream, startPVP, sizePVP, threadPool);
+}
+
+sys::Off_T PVPBlock::load(io::SeekableInputStream& inStream,
+                     sys::Off_T startPVP,
+                     sys::Off_T sizePVP,
+                     six::ThreadPool& threadPool)
 {
     // Allocate the buffers
     size_t numBytesIn(0);
@@ -565,11 +295,9 @@ sys::Off_T PVPBlock::load(io::SeekableInputStream& inStream,
 
     const bool swapToLittleEndian = !(sys::isBigEndianSystem());
 
-    // Seek to start of PVPBlock
+    // Read from the start of PVPBlock
     size_t totalBytesRead(0);
-    inStream.seek(startPVP, io::Seekable::START);
     std::vector<sys::ubyte> readBuf;
-    const size_t numBytesPerVector = getNumBytesPVPSet();
 
     // Read the data for each channel
     for (size_t ii = 0; ii < mData.size(); ++ii)
@@ -578,7 +306,8 @@ sys::Off_T PVPBlock::load(io::SeekableInputStream& inStream,
         if (!readBuf.empty())
         {
             sys::byte* const buf = reinterpret_cast<sys::byte*>(&readBuf[0]);
-            sys::SSize_T bytesThisRead = inStream.read(buf, readBuf.size());
+            sys::SSize_T bytesThisRead = inStream.readAt(
+                    startPVP + totalBytesRead, buf, readBuf.size());
             if (bytesThisRead == io::InputStream::IS_EOF)
             {
                 std::ostringstream oss;
@@ -594,14 +323,10 @@ sys::Off_T PVPBlock::load(io::SeekableInputStream& inStream,
                 byteSwap(buf,
                          sizeof(double),
                          readBuf.size() / sizeof(double),
-                         numThreads);
+                         threadPool);
             }
 
-            sys::byte* ptr = buf;
-            for (size_t jj = 0; jj < mData[ii].size(); ++jj, ptr += numBytesPerVector)
-            {
-                mData[ii][jj].write(*this, mPvp, ptr);
-            }
+            mData[ii].write(mPvp, getNumBytesPVPSet(), buf);
         }
     }
     return totalBytesRead;
@@ -610,282 +335,247 @@ sys::Off_T PVPBlock::load(io::SeekableInputStream& inStream,
 double PVPBlock::getTxTime(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    return mData[channel][set].txTime;
+    return mData[channel].txTime[set];
 }
 
 Vector3 PVPBlock::getTxPos(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    return mData[channel][set].txPos;
+    return mData[channel].txPos[set];
 }
 
 Vector3 PVPBlock::getTxVel(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    return mData[channel][set].txVel;
+    return mData[channel].txVel[set];
 }
 
 double PVPBlock::getRcvTime(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    return mData[channel][set].rcvTime;
+    return mData[channel].rcvTime[set];
 }
 
 Vector3 PVPBlock::getRcvPos(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    return mData[channel][set].rcvPos;
+    return mData[channel].rcvPos[set];
 }
 
 Vector3 PVPBlock::getRcvVel(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    return mData[channel][set].rcvVel;
+    return mData[channel].rcvVel[set];
 }
 
 Vector3 PVPBlock::getSRPPos(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    return mData[channel][set].srpPos;
+    return mData[channel].srpPos[set];
 }
 
 double PVPBlock::getaFDOP(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    return mData[channel][set].aFDOP;
+    return mData[channel].aFDOP[set];
 }
 
 double PVPBlock::getaFRR1(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    return mData[channel][set].aFRR1;
+    return mData[channel].aFRR1[set];
 }
 
 double PVPBlock::getaFRR2(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    return mData[channel][set].aFRR2;
+    return mData[channel].aFRR2[set];
 }
 
 double PVPBlock::getFx1(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    return mData[channel][set].fx1;
+    return mData[channel].fx1[set];
 }
 
 double PVPBlock::getFx2(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    return mData[channel][set].fx2;
+    return mData[channel].fx2[set];
 }
 
 double PVPBlock::getTOA1(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    return mData[channel][set].toa1;
+    return mData[channel].toa1[set];
 }
 
 double PVPBlock::getTOA2(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    return mData[channel][set].toa2;
+    return mData[channel].toa2[set];
 }
 
 double PVPBlock::getTdTropoSRP(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    return mData[channel][set].tdTropoSRP;
+    return mData[channel].tdTropoSRP[set];
 }
 
 double PVPBlock::getSC0(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    return mData[channel][set].sc0;
+    return mData[channel].sc0[set];
 }
 
 double PVPBlock::getSCSS(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    return mData[channel][set].scss;
+    return mData[channel].scss[set];
 }
 
 double PVPBlock::getAmpSF(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    if (mData[channel][set].ampSF.get())
-    {
-        return *mData[channel][set].ampSF;
-    }
-    throw except::Exception(Ctxt(
-                    "Parameter was not set"));
+    return getOptional(mData[channel].ampSF, set);
 }
 
 double PVPBlock::getFxN1(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    if (mData[channel][set].fxN1.get())
-    {
-        return *mData[channel][set].fxN1;
-    }
-    throw except::Exception(Ctxt(
-                    "Parameter was not set"));
+    return getOptional(mData[channel].fxN1, set);
 }
 
 double PVPBlock::getFxN2(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    if (mData[channel][set].fxN2.get())
-    {
-        return *mData[channel][set].fxN2;
-    }
-    throw except::Exception(Ctxt(
-                    "Parameter was not set"));
+    return getOptional(mData[channel].fxN2, set);
 }
 
 double PVPBlock::getTOAE1(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    if (mData[channel][set].toaE1.get())
-    {
-        return *mData[channel][set].toaE1;
-    }
-    throw except::Exception(Ctxt(
-                    "Parameter was not set"));
+    return getOptional(mData[channel].toaE1, set);
 }
 
 double PVPBlock::getTOAE2(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    if (mData[channel][set].toaE2.get())
-    {
-        return *mData[channel][set].toaE2;
-    }
-    throw except::Exception(Ctxt(
-                    "Parameter was not set"));
+    return getOptional(mData[channel].toaE2, set);
 }
 
 double PVPBlock::getTdIonoSRP(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    if (mData[channel][set].tdIonoSRP.get())
-    {
-        return *mData[channel][set].tdIonoSRP;
-    }
-    throw except::Exception(Ctxt(
-                    "Parameter was not set"));
+    return getOptional(mData[channel].tdIonoSRP, set);
 }
 
 sys::Int64_T PVPBlock::getSignal(size_t channel, size_t set) const
 {
     verifyChannelVector(channel, set);
-    if (mData[channel][set].signal.get())
-    {
-        return *mData[channel][set].signal;
-    }
-    throw except::Exception(Ctxt(
-                    "Parameter was not set"));
+    return getOptional(mData[channel].signal, set);
 }
 
 void PVPBlock::setTxTime(double value, size_t channel, size_t vector)
 {
     verifyChannelVector(channel, vector);
-    mData[channel][vector].txTime = value;
+    mData[channel].txTime[vector] = value;
 }
 
 void PVPBlock::setTxPos(const cphd::Vector3& value, size_t channel, size_t vector)
 {
     verifyChannelVector(channel, vector);
-    mData[channel][vector].txPos = value;
+    mData[channel].txPos[vector] = value;
 }
 
 void PVPBlock::setTxVel(const cphd::Vector3& value, size_t channel, size_t vector)
 {
     verifyChannelVector(channel, vector);
-    mData[channel][vector].txVel = value;
+    mData[channel].txVel[vector] = value;
 }
 
 void PVPBlock::setRcvTime(double value, size_t channel, size_t vector)
 {
     verifyChannelVector(channel, vector);
-    mData[channel][vector].rcvTime = value;
+    mData[channel].rcvTime[vector] = value;
 }
 
 void PVPBlock::setRcvPos(const cphd::Vector3& value, size_t channel, size_t vector)
 {
     verifyChannelVector(channel, vector);
-    mData[channel][vector].rcvPos = value;
+    mData[channel].rcvPos[vector] = value;
 }
 
 void PVPBlock::setRcvVel(const cphd::Vector3& value, size_t channel, size_t vector)
 {
     verifyChannelVector(channel, vector);
-    mData[channel][vector].rcvVel = value;
+    mData[channel].rcvVel[vector] = value;
 }
 
 void PVPBlock::setSRPPos(const cphd::Vector3& value, size_t channel, size_t vector)
 {
     verifyChannelVector(channel, vector);
-    mData[channel][vector].srpPos = value;
+    mData[channel].srpPos[vector] = value;
 }
 
 void PVPBlock::setaFDOP(double value, size_t channel, size_t vector)
 {
     verifyChannelVector(channel, vector);
-    mData[channel][vector].aFDOP = value;
+    mData[channel].aFDOP[vector] = value;
 }
 
 void PVPBlock::setaFRR1(double value, size_t channel, size_t vector)
 {
     verifyChannelVector(channel, vector);
-    mData[channel][vector].aFRR1 = value;
+    mData[channel].aFRR1[vector] = value;
 }
 
 void PVPBlock::setaFRR2(double value, size_t channel, size_t vector)
 {
     verifyChannelVector(channel, vector);
-    mData[channel][vector].aFRR2 = value;
+    mData[channel].aFRR2[vector] = value;
 }
 
 void PVPBlock::setFx1(double value, size_t channel, size_t vector)
 {
     verifyChannelVector(channel, vector);
-    mData[channel][vector].fx1 = value;
+    mData[channel].fx1[vector] = value;
 }
 
 void PVPBlock::setFx2(double value, size_t channel, size_t vector)
 {
     verifyChannelVector(channel, vector);
-    mData[channel][vector].fx2 = value;
+    mData[channel].fx2[vector] = value;
 }
 
 void PVPBlock::setTOA1(double value, size_t channel, size_t vector)
 {
     verifyChannelVector(channel, vector);
-    mData[channel][vector].toa1 = value;
+    mData[channel].toa1[vector] = value;
 }
 
 void PVPBlock::setTOA2(double value, size_t channel, size_t vector)
 {
     verifyChannelVector(channel, vector);
-    mData[channel][vector].toa2 = value;
+    mData[channel].toa2[vector] = value;
 }
 
 void PVPBlock::setTdTropoSRP(double value, size_t channel, size_t vector)
 {
     verifyChannelVector(channel, vector);
-    mData[channel][vector].tdTropoSRP = value;
+    mData[channel].tdTropoSRP[vector] = value;
 }
 
 void PVPBlock::setSC0(double value, size_t channel, size_t vector)
 {
     verifyChannelVector(channel, vector);
-    mData[channel][vector].sc0 = value;
+    mData[channel].sc0[vector] = value;
 }
 
 void PVPBlock::setSCSS(double value, size_t channel, size_t vector)
 {
     verifyChannelVector(channel, vector);
-    mData[channel][vector].scss = value;
+    mData[channel].scss[vector] = value;
 }
 
 void PVPBlock::setAmpSF(double value, size_t channel, size_t vector)
@@ -893,7 +583,7 @@ void PVPBlock::setAmpSF(double value, size_t channel, size_t vector)
     verifyChannelVector(channel, vector);
     if (hasAmpSF())
     {
-        mData[channel][vector].ampSF.reset(new double(value));
+        mData[channel].ampSF[vector] = value;
         return;
     }
     throw except::Exception(Ctxt(
@@ -905,7 +595,7 @@ void PVPBlock::setFxN1(double value, size_t channel, size_t vector)
     verifyChannelVector(channel, vector);
     if (hasFxN1())
     {
-        mData[channel][vector].fxN1.reset(new double(value));
+        mData[channel].fxN1[vector] = value;
         return;
     }
     throw except::Exception(Ctxt(
@@ -917,7 +607,7 @@ void PVPBlock::setFxN2(double value, size_t channel, size_t vector)
     verifyChannelVector(channel, vector);
     if (hasFxN2())
     {
-        mData[channel][vector].fxN2.reset(new double(value));
+        mData[channel].fxN2[vector] = value;
         return;
     }
     throw except::Exception(Ctxt(
@@ -929,7 +619,7 @@ void PVPBlock::setTOAE1(double value, size_t channel, size_t vector)
     verifyChannelVector(channel, vector);
     if (hasToaE1())
     {
-        mData[channel][vector].toaE1.reset(new double(value));
+        mData[channel].toaE1[vector] = value;
         return;
     }
     throw except::Exception(Ctxt(
@@ -941,7 +631,7 @@ void PVPBlock::setTOAE2(double value, size_t channel, size_t vector)
     verifyChannelVector(channel, vector);
     if (hasToaE2())
     {
-        mData[channel][vector].toaE2.reset(new double(value));
+        mData[channel].toaE2[vector] = value;
         return;
     }
     throw except::Exception(Ctxt(
@@ -953,7 +643,7 @@ void PVPBlock::setTdIonoSRP(double value, size_t channel, size_t vector)
     verifyChannelVector(channel, vector);
     if (hasTDIonoSRP())
     {
-        mData[channel][vector].tdIonoSRP.reset(new double(value));
+        mData[channel].tdIonoSRP[vector] = value;
         return;
     }
     throw except::Exception(Ctxt(
@@ -965,70 +655,13 @@ void PVPBlock::setSignal(sys::Int64_T value, size_t channel, size_t vector)
     verifyChannelVector(channel, vector);
     if (hasSignal())
     {
-        mData[channel][vector].signal.reset(new sys::Int64_T(value));
+        mData[channel].signal[vector] = value;
         return;
     }
     throw except::Exception(Ctxt(
                             "Parameter was not specified in XML"));
 }
 
-std::ostream& operator<< (std::ostream& os, const PVPBlock::PVPSet& p)
-{
-    os << "  TxTime         : " << p.txTime << "\n"
-        << "  TxPos         : " << p.txPos << "\n"
-        << "  TxVel         : " << p.txVel << "\n"
-        << "  RcvTime       : " << p.rcvTime << "\n"
-        << "  RcvPos        : " << p.rcvPos << "\n"
-        << "  RcvVel        : " << p.rcvVel << "\n"
-        << "  SRPPos        : " << p.srpPos << "\n"
-        << "  aFDOP         : " << p.aFDOP << "\n"
-        << "  aFRR1         : " << p.aFRR1 << "\n"
-        << "  aFRR2         : " << p.aFRR2 << "\n"
-        << "  Fx1           : " << p.fx1 << "\n"
-        << "  Fx2           : " << p.fx2 << "\n"
-        << "  TOA1          : " << p.toa1 << "\n"
-        << "  TOA2          : " << p.toa2 << "\n"
-        << "  TdTropoSRP    : " << p.tdTropoSRP << "\n"
-        << "  SC0           : " << p.sc0 << "\n"
-        << "  SCSS          : " << p.scss << "\n";
-
-    if (p.ampSF.get())
-    {
-        os << "  AmpSF         : " << *p.ampSF << "\n";
-    }
-    if (p.fxN1.get())
-    {
-        os << "  FxN1          : " << *p.fxN1 << "\n";
-    }
-    if (p.fxN2.get())
-    {
-        os << "  FxN2          : " << *p.fxN2 << "\n";
-    }
-    if (p.toaE1.get())
-    {
-        os << "  TOAE1         : " << *p.toaE1 << "\n";
-    }
-    if (p.toaE2.get())
-    {
-        os << "  TOAE2         : " << *p.toaE2 << "\n";
-    }
-    if (p.tdIonoSRP.get())
-    {
-        os << "  TdIonoSRP     : " << *p.tdIonoSRP << "\n";
-    }
-    if (p.signal.get())
-    {
-        os << "  SIGNAL     : " << *p.signal << "\n";
-    }
-
-    for (auto it = p.addedPVP.begin(); it != p.addedPVP.end(); ++it)
-    {
-        os << "  Additional Parameter : " << it->second.str() << "\n";
-    }
-    return os;
-}
-
-
 std::ostream& operator<< (std::ostream& os, const PVPBlock& p)
 {
     os << "PVPBlock:: \n";
@@ -1046,21 +679,17 @@ std::ostream& operator<< (std::ostream& os, const PVPBlock& p)
 
         for (size_t ii = 0; ii < p.mData.size(); ++ii)
         {
-            if (p.mData[ii].empty())
+            if (p.mData[ii].getNumVectors() == 0)
             {
                 os << "[" << ii << "] mData: (empty)\n";
             }
             else
             {
-                for (size_t jj = 0; jj < p.mData[ii].size(); ++jj)
+                for (size_t jj = 0; jj < p.mData[ii].getNumVectors(); ++jj)
                 {
-                    if (p.mData[ii].empty())
-                    {
-                        os << "[" << ii << "] [" << jj << "] mData: (empty)\n";
-                    }
-                    else {
-                        os << "[" << ii << "] [" << jj << "] mData: " << p.mData[ii][jj] << "\n";
-                    }
+                    os << "[" << ii << "] [" << jj << "] mData: ";
+                    printVector(os, p.mData[ii], jj);
+                    os << "\n";
                 }
             }
         }
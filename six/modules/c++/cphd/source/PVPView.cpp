@@ -0,0 +1,293 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+#include <sstream>
+
+#include <six/Init.h>
+#include <str/Convert.h>
+#include <cphd/PVPView.h>
+
+namespace cphd
+{
+PVPView::PVPView(const Pvp& pvp,
+                 const Data& data,
+                 const void* pvpBlock,
+                 sys::Off_T sizePVP) :
+    mPvp(pvp),
+    mNumBytesPerVector(data.getNumBytesPVPSet()),
+    mSwap(!sys::isBigEndianSystem())
+{
+    const size_t calculateBytesPerVector = mPvp.getReqSetSize() * sizeof(double);
+    if (six::Init::isUndefined<size_t>(mNumBytesPerVector) ||
+        calculateBytesPerVector > mNumBytesPerVector)
+    {
+        std::ostringstream oss;
+        oss << "PVP size specified in metadata: " << mNumBytesPerVector
+            << " does not match PVP size calculated: " << calculateBytesPerVector;
+        throw except::Exception(Ctxt(oss.str()));
+    }
+
+    const sys::ubyte* ptr = static_cast<const sys::ubyte*>(pvpBlock);
+    size_t numBytes(0);
+    mChannels.reserve(data.getNumChannels());
+    mNumVectors.reserve(data.getNumChannels());
+    for (size_t ii = 0; ii < data.getNumChannels(); ++ii)
+    {
+        const size_t numVectors = data.getNumVectors(ii);
+        mChannels.push_back(ptr + numBytes);
+        mNumVectors.push_back(numVectors);
+        numBytes += numVectors * mNumBytesPerVector;
+    }
+
+    if (numBytes != static_cast<size_t>(sizePVP))
+    {
+        std::ostringstream oss;
+        oss << "PVPView: calculated PVP size(" << numBytes
+            << ") != header PVP_DATA_SIZE(" << sizePVP << ")";
+        throw except::Exception(Ctxt(oss.str()));
+    }
+}
+
+size_t PVPView::getNumVectors(size_t channel) const
+{
+    verifyChannelVector(channel, 0);
+    return mNumVectors[channel];
+}
+
+const sys::ubyte* PVPView::getPVPdata(size_t channel) const
+{
+    verifyChannelVector(channel, 0);
+    return mChannels[channel];
+}
+
+void PVPView::verifyChannelVector(size_t channel, size_t vector) const
+{
+    if (channel >= mChannels.size())
+    {
+        throw except::Exception(Ctxt(
+                "Invalid channel number: " + str::toString<size_t>(channel)));
+    }
+    if (vector >= mNumVectors[channel])
+    {
+        throw except::Exception(Ctxt(
+                "Invalid vector number: " + str::toString<size_t>(vector)));
+    }
+}
+
+bool PVPView::isEnabled(const PVPType& param)
+{
+    return !six::Init::isUndefined<size_t>(param.getOffset());
+}
+
+const sys::ubyte* PVPView::getParameter(const PVPType& param,
+                                        size_t channel,
+                                        size_t set) const
+{
+    verifyChannelVector(channel, set);
+    return mChannels[channel] + set * mNumBytesPerVector +
+            param.getByteOffset();
+}
+
+template<typename T>
+T PVPView::get(const PVPType& param, size_t channel, size_t set) const
+{
+    // The block may not be aligned for T, so copy the bytes out
+    T value;
+    memcpy(&value, getParameter(param, channel, set), sizeof(T));
+    return mSwap ? sys::byteSwap(value) : value;
+}
+
+template<typename T>
+T PVPView::getOptional(const PVPType& param, size_t channel, size_t set) const
+{
+    if (!isEnabled(param))
+    {
+        throw except::Exception(Ctxt(
+                        "Parameter was not set"));
+    }
+    return get<T>(param, channel, set);
+}
+
+Vector3 PVPView::getVector3(const PVPType& param,
+                            size_t channel,
+                            size_t set) const
+{
+    double values[3];
+    memcpy(values, getParameter(param, channel, set), sizeof(values));
+    if (mSwap)
+    {
+        sys::byteSwap(values, sizeof(double), 3);
+    }
+
+    Vector3 vec;
+    vec[0] = values[0];
+    vec[1] = values[1];
+    vec[2] = values[2];
+    return vec;
+}
+
+six::Parameter PVPView::getAddedParameter(size_t channel,
+                                          size_t set,
+                                          const std::string& name) const
+{
+    std::map<std::string, APVPType>::const_iterator it =
+            mPvp.addedPVP.find(name);
+    if (it == mPvp.addedPVP.end())
+    {
+        throw except::Exception(Ctxt(
+                "Parameter was not set"));
+    }
+
+    // Decode the same way PVPBlock::load() does: swap as 8 byte words,
+    // then interpret the bytes according to the parameter's format
+    std::vector<sys::byte> buf(it->second.getByteSize());
+    memcpy(&buf[0], getParameter(it->second, channel, set), buf.size());
+    if (mSwap)
+    {
+        sys::byteSwap(&buf[0], sizeof(double), buf.size() / sizeof(double));
+    }
+
+    PVPArray::AddedColumn column(it->second, 1);
+    column.setBytes(0, &buf[0], buf.size());
+    return column.get(0);
+}
+
+double PVPView::getTxTime(size_t channel, size_t set) const
+{
+    return get<double>(mPvp.txTime, channel, set);
+}
+
+Vector3 PVPView::getTxPos(size_t channel, size_t set) const
+{
+    return getVector3(mPvp.txPos, channel, set);
+}
+
+Vector3 PVPView::getTxVel(size_t channel, size_t set) const
+{
+    return getVector3(mPvp.txVel, channel, set);
+}
+
+double PVPView::getRcvTime(size_t channel, size_t set) const
+{
+    return get<double>(mPvp.rcvTime, channel, set);
+}
+
+Vector3 PVPView::getRcvPos(size_t channel, size_t set) const
+{
+    return getVector3(mPvp.rcvPos, channel, set);
+}
+
+Vector3 PVPView::getRcvVel(size_t channel, size_t set) const
+{
+    return getVector3(mPvp.rcvVel, channel, set);
+}
+
+Vector3 PVPView::getSRPPos(size_t channel, size_t set) const
+{
+    return getVector3(mPvp.srpPos, channel, set);
+}
+
+double PVPView::getaFDOP(size_t channel, size_t set) const
+{
+    return get<double>(mPvp.aFDOP, channel, set);
+}
+
+double PVPView::getaFRR1(size_t channel, size_t set) const
+{
+    return get<double>(mPvp.aFRR1, channel, set);
+}
+
+double PVPView::getaFRR2(size_t channel, size_t set) const
+{
+    return get<double>(mPvp.aFRR2, channel, set);
+}
+
+double PVPView::getFx1(size_t channel, size_t set) const
+{
+    return get<double>(mPvp.fx1, channel, set);
+}
+
+double PVPView::getFx2(size_t channel, size_t set) const
+{
+    return get<double>(mPvp.fx2, channel, set);
+}
+
+double PVPView::getTOA1(size_t channel, size_t set) const
+{
+    return get<double>(mPvp.toa1, channel, set);
+}
+
+double PVPView::getTOA2(size_t channel, size_t set) const
+{
+    return get<double>(mPvp.toa2, channel, set);
+}
+
+double PVPView::getTdTropoSRP(size_t channel, size_t set) const
+{
+    return get<double>(mPvp.tdTropoSRP, channel, set);
+}
+
+double PVPView::getSC0(size_t channel, size_t set) const
+{
+    return get<double>(mPvp.sc0, channel, set);
+}
+
+double PVPView::getSCSS(size_t channel, size_t set) const
+{
+    return get<double>(mPvp.scss, channel, set);
+}
+
+double PVPView::getAmpSF(size_t channel, size_t set) const
+{
+    return getOptional<double>(mPvp.ampSF, channel, set);
+}
+
+double PVPView::getFxN1(size_t channel, size_t set) const
+{
+    return getOptional<double>(mPvp.fxN1, channel, set);
+}
+
+double PVPView::getFxN2(size_t channel, size_t set) const
+{
+    return getOptional<double>(mPvp.fxN2, channel, set);
+}
+
+double PVPView::getTOAE1(size_t channel, size_t set) const
+{
+    return getOptional<double>(mPvp.toaE1, channel, set);
+}
+
+double PVPView::getTOAE2(size_t channel, size_t set) const
+{
+    return getOptional<double>(mPvp.toaE2, channel, set);
+}
+
+double PVPView::getTdIonoSRP(size_t channel, size_t set) const
+{
+    return getOptional<double>(mPvp.tdIonoSRP, channel, set);
+}
+
+sys::Int64_T PVPView::getSignal(size_t channel, size_t set) const
+{
+    return getOptional<sys::Int64_T>(mPvp.signal, channel, set);
+}
+}
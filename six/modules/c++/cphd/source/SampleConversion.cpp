@@ -0,0 +1,593 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+#include <algorithm>
+
+#include <sys/Conf.h>
+#include <except/Exception.h>
+#include <str/Convert.h>
+#include <cphd/SampleConversion.h>
+
+// SSE2 is part of x86-64, so only AVX2 needs to be checked for at runtime
+#if defined(__x86_64__) || defined(_M_X64)
+#define CPHD_X86_64_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define CPHD_TARGET_AVX2
+#else
+#define CPHD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+// The scalar kernels are the reference implementation.  The vectorized
+// kernels process blocks of components with the same arithmetic (in
+// particular, scaling is done in double precision and rounded once to
+// float) and fall back to these for any remainder.
+
+template <typename T>
+inline T load(const sys::ubyte* in, bool byteSwap)
+{
+    // Can't byte-swap a float in a register, as the compiler may change
+    // the swapped value into a valid IEEE value, so swap the bytes
+    T out;
+    sys::ubyte* const outPtr = reinterpret_cast<sys::ubyte*>(&out);
+    if (byteSwap)
+    {
+        for (size_t ii = 0; ii < sizeof(T); ++ii)
+        {
+            outPtr[ii] = in[sizeof(T) - 1 - ii];
+        }
+    }
+    else
+    {
+        memcpy(outPtr, in, sizeof(T));
+    }
+    return out;
+}
+
+template <typename InT>
+void promoteScalar(const sys::ubyte* input,
+                   size_t numComponents,
+                   bool byteSwap,
+                   float* output)
+{
+    for (size_t ii = 0; ii < numComponents; ++ii, input += sizeof(InT))
+    {
+        output[ii] = static_cast<float>(load<InT>(input, byteSwap));
+    }
+}
+
+template <typename InT>
+void scaleScalar(const sys::ubyte* input,
+                 size_t numComponents,
+                 bool byteSwap,
+                 double scaleFactor,
+                 float* output)
+{
+    for (size_t ii = 0; ii < numComponents; ++ii, input += sizeof(InT))
+    {
+        output[ii] = static_cast<float>(
+                load<InT>(input, byteSwap) * scaleFactor);
+    }
+}
+
+#if defined(CPHD_X86_64_SIMD)
+// SSE2 kernels process 8 components at a time
+const size_t SSE2_STEP = 8;
+
+inline __m128i sse2Swap16(__m128i v)
+{
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+inline __m128i sse2Swap32(__m128i v)
+{
+    v = sse2Swap16(v);
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+inline __m128i sse2Swap64(__m128i v)
+{
+    v = sse2Swap16(v);
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    return _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+// Loads 8 integer components, sign extended to 32 bits
+inline void sse2Load(const sys::ubyte* in, bool ,
+                     sys::Int8_T* , __m128i& lo, __m128i& hi)
+{
+    const __m128i v8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in));
+    const __m128i v16 = _mm_srai_epi16(_mm_unpacklo_epi8(v8, v8), 8);
+    lo = _mm_srai_epi32(_mm_unpacklo_epi16(v16, v16), 16);
+    hi = _mm_srai_epi32(_mm_unpackhi_epi16(v16, v16), 16);
+}
+
+inline void sse2Load(const sys::ubyte* in, bool byteSwap,
+                     sys::Int16_T* , __m128i& lo, __m128i& hi)
+{
+    __m128i v16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    if (byteSwap)
+    {
+        v16 = sse2Swap16(v16);
+    }
+    lo = _mm_srai_epi32(_mm_unpacklo_epi16(v16, v16), 16);
+    hi = _mm_srai_epi32(_mm_unpackhi_epi16(v16, v16), 16);
+}
+
+// Loads 8 float components
+inline void sse2Load(const sys::ubyte* in, bool byteSwap,
+                     float* , __m128& lo, __m128& hi)
+{
+    __m128i vLo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    __m128i vHi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16));
+    if (byteSwap)
+    {
+        vLo = sse2Swap32(vLo);
+        vHi = sse2Swap32(vHi);
+    }
+    lo = _mm_castsi128_ps(vLo);
+    hi = _mm_castsi128_ps(vHi);
+}
+
+inline __m128 sse2ToFloat(__m128i v)
+{
+    return _mm_cvtepi32_ps(v);
+}
+
+inline __m128 sse2ToFloat(__m128 v)
+{
+    return v;
+}
+
+inline __m128 sse2Scale(__m128i v, __m128d scale)
+{
+    const __m128 lo = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtepi32_pd(v), scale));
+    const __m128 hi = _mm_cvtpd_ps(
+            _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(v, 8)), scale));
+    return _mm_movelh_ps(lo, hi);
+}
+
+inline __m128 sse2Scale(__m128 v, __m128d scale)
+{
+    const __m128 lo = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(v), scale));
+    const __m128 hi = _mm_cvtpd_ps(
+            _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(v, v)), scale));
+    return _mm_movelh_ps(lo, hi);
+}
+
+// Integer components are widened to 32 bit integers, floats stay floats
+template <typename InT>
+struct SSE2Vector
+{
+    typedef __m128i Type;
+};
+
+template <>
+struct SSE2Vector<float>
+{
+    typedef __m128 Type;
+};
+
+template <typename InT>
+void promoteSSE2(const sys::ubyte* input,
+                 size_t numComponents,
+                 bool byteSwap,
+                 float* output)
+{
+    typedef typename SSE2Vector<InT>::Type VecT;
+    size_t ii = 0;
+    for (; ii + SSE2_STEP <= numComponents; ii += SSE2_STEP)
+    {
+        VecT lo;
+        VecT hi;
+        sse2Load(input + ii * sizeof(InT), byteSwap,
+                 static_cast<InT*>(NULL), lo, hi);
+        _mm_storeu_ps(output + ii, sse2ToFloat(lo));
+        _mm_storeu_ps(output + ii + 4, sse2ToFloat(hi));
+    }
+    promoteScalar<InT>(input + ii * sizeof(InT), numComponents - ii,
+                       byteSwap, output + ii);
+}
+
+template <typename InT>
+void scaleSSE2(const sys::ubyte* input,
+               size_t numComponents,
+               bool byteSwap,
+               double scaleFactor,
+               float* output)
+{
+    typedef typename SSE2Vector<InT>::Type VecT;
+    const __m128d scale = _mm_set1_pd(scaleFactor);
+    size_t ii = 0;
+    for (; ii + SSE2_STEP <= numComponents; ii += SSE2_STEP)
+    {
+        VecT lo;
+        VecT hi;
+        sse2Load(input + ii * sizeof(InT), byteSwap,
+                 static_cast<InT*>(NULL), lo, hi);
+        _mm_storeu_ps(output + ii, sse2Scale(lo, scale));
+        _mm_storeu_ps(output + ii + 4, sse2Scale(hi, scale));
+    }
+    scaleScalar<InT>(input + ii * sizeof(InT), numComponents - ii,
+                     byteSwap, scaleFactor, output + ii);
+}
+
+void swapBytesSSE2(sys::ubyte* buffer, size_t elemSize, size_t numElements)
+{
+    const size_t numBytes = elemSize * numElements;
+    size_t ii = 0;
+    for (; ii + 16 <= numBytes; ii += 16)
+    {
+        __m128i* const ptr = reinterpret_cast<__m128i*>(buffer + ii);
+        __m128i v = _mm_loadu_si128(ptr);
+        switch (elemSize)
+        {
+        case 2:
+            v = sse2Swap16(v);
+            break;
+        case 4:
+            v = sse2Swap32(v);
+            break;
+        default:
+            v = sse2Swap64(v);
+            break;
+        }
+        _mm_storeu_si128(ptr, v);
+    }
+    sys::byteSwap(buffer + ii, static_cast<unsigned short>(elemSize),
+                  (numBytes - ii) / elemSize);
+}
+
+// AVX2 kernels also process 8 components at a time, but with a single
+// 256 bit register
+const size_t AVX2_STEP = 8;
+
+CPHD_TARGET_AVX2
+inline __m128i avx2SwapMask128(size_t elemSize)
+{
+    switch (elemSize)
+    {
+    case 2:
+        return _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6,
+                             9, 8, 11, 10, 13, 12, 15, 14);
+    case 4:
+        return _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+                             11, 10, 9, 8, 15, 14, 13, 12);
+    default:
+        return _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0,
+                             15, 14, 13, 12, 11, 10, 9, 8);
+    }
+}
+
+CPHD_TARGET_AVX2
+inline __m256i avx2SwapMask(size_t elemSize)
+{
+    const __m128i mask = avx2SwapMask128(elemSize);
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(mask), mask, 1);
+}
+
+// Loads 8 integer components, sign extended to 32 bits
+CPHD_TARGET_AVX2
+inline __m256i avx2Load(const sys::ubyte* in, bool , sys::Int8_T* )
+{
+    return _mm256_cvtepi8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in)));
+}
+
+CPHD_TARGET_AVX2
+inline __m256i avx2Load(const sys::ubyte* in, bool byteSwap, sys::Int16_T* )
+{
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    if (byteSwap)
+    {
+        v = _mm_shuffle_epi8(v, avx2SwapMask128(sizeof(sys::Int16_T)));
+    }
+    return _mm256_cvtepi16_epi32(v);
+}
+
+// Loads 8 float components
+CPHD_TARGET_AVX2
+inline __m256 avx2Load(const sys::ubyte* in, bool byteSwap, float* )
+{
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+    if (byteSwap)
+    {
+        v = _mm256_shuffle_epi8(v, avx2SwapMask(sizeof(float)));
+    }
+    return _mm256_castsi256_ps(v);
+}
+
+CPHD_TARGET_AVX2
+inline __m256 avx2ToFloat(__m256i v)
+{
+    return _mm256_cvtepi32_ps(v);
+}
+
+CPHD_TARGET_AVX2
+inline __m256 avx2ToFloat(__m256 v)
+{
+    return v;
+}
+
+CPHD_TARGET_AVX2
+inline void avx2Scale(__m256i v, __m256d scale, float* output)
+{
+    const __m256d lo = _mm256_cvtepi32_pd(_mm256_castsi256_si128(v));
+    const __m256d hi = _mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1));
+    _mm_storeu_ps(output, _mm256_cvtpd_ps(_mm256_mul_pd(lo, scale)));
+    _mm_storeu_ps(output + 4, _mm256_cvtpd_ps(_mm256_mul_pd(hi, scale)));
+}
+
+CPHD_TARGET_AVX2
+inline void avx2Scale(__m256 v, __m256d scale, float* output)
+{
+    const __m256d lo = _mm256_cvtps_pd(_mm256_castps256_ps128(v));
+    const __m256d hi = _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1));
+    _mm_storeu_ps(output, _mm256_cvtpd_ps(_mm256_mul_pd(lo, scale)));
+    _mm_storeu_ps(output + 4, _mm256_cvtpd_ps(_mm256_mul_pd(hi, scale)));
+}
+
+template <typename InT>
+CPHD_TARGET_AVX2
+void promoteAVX2(const sys::ubyte* input,
+                 size_t numComponents,
+                 bool byteSwap,
+                 float* output)
+{
+    size_t ii = 0;
+    for (; ii + AVX2_STEP <= numComponents; ii += AVX2_STEP)
+    {
+        _mm256_storeu_ps(output + ii, avx2ToFloat(
+                avx2Load(input + ii * sizeof(InT), byteSwap,
+                         static_cast<InT*>(NULL))));
+    }
+    promoteScalar<InT>(input + ii * sizeof(InT), numComponents - ii,
+                       byteSwap, output + ii);
+}
+
+template <typename InT>
+CPHD_TARGET_AVX2
+void scaleAVX2(const sys::ubyte* input,
+               size_t numComponents,
+               bool byteSwap,
+               double scaleFactor,
+               float* output)
+{
+    const __m256d scale = _mm256_set1_pd(scaleFactor);
+    size_t ii = 0;
+    for (; ii + AVX2_STEP <= numComponents; ii += AVX2_STEP)
+    {
+        avx2Scale(avx2Load(input + ii * sizeof(InT), byteSwap,
+                           static_cast<InT*>(NULL)),
+                  scale,
+                  output + ii);
+    }
+    scaleScalar<InT>(input + ii * sizeof(InT), numComponents - ii,
+                     byteSwap, scaleFactor, output + ii);
+}
+
+CPHD_TARGET_AVX2
+void swapBytesAVX2(sys::ubyte* buffer, size_t elemSize, size_t numElements)
+{
+    const __m256i mask = avx2SwapMask(elemSize);
+    const size_t numBytes = elemSize * numElements;
+    size_t ii = 0;
+    for (; ii + 32 <= numBytes; ii += 32)
+    {
+        __m256i* const ptr = reinterpret_cast<__m256i*>(buffer + ii);
+        _mm256_storeu_si256(ptr,
+                            _mm256_shuffle_epi8(_mm256_loadu_si256(ptr), mask));
+    }
+    sys::byteSwap(buffer + ii, static_cast<unsigned short>(elemSize),
+                  (numBytes - ii) / elemSize);
+}
+#endif
+
+cphd::InstructionSet detectInstructionSet()
+{
+#if defined(CPHD_X86_64_SIMD)
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] >= 7)
+    {
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+
+        __cpuidex(info, 7, 0);
+        const bool avx2 = (info[1] & (1 << 5)) != 0;
+
+        // The OS also has to save the AVX registers
+        if (osxsave && avx && avx2 && (_xgetbv(0) & 6) == 6)
+        {
+            return cphd::INSTRUCTION_SET_AVX2;
+        }
+    }
+    return cphd::INSTRUCTION_SET_SSE2;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? cphd::INSTRUCTION_SET_AVX2 :
+                                            cphd::INSTRUCTION_SET_SSE2;
+#endif
+#else
+    return cphd::INSTRUCTION_SET_SCALAR;
+#endif
+}
+
+cphd::InstructionSet limit(cphd::InstructionSet instructionSet)
+{
+    return std::min(instructionSet, cphd::getBestInstructionSet());
+}
+
+template <typename InT>
+void promote(const sys::ubyte* input,
+             size_t numComponents,
+             bool byteSwap,
+             float* output,
+             cphd::InstructionSet instructionSet)
+{
+    switch (limit(instructionSet))
+    {
+#if defined(CPHD_X86_64_SIMD)
+    case cphd::INSTRUCTION_SET_AVX2:
+        promoteAVX2<InT>(input, numComponents, byteSwap, output);
+        break;
+    case cphd::INSTRUCTION_SET_SSE2:
+        promoteSSE2<InT>(
+                input, numComponents, byteSwap, output);
+        break;
+#endif
+    default:
+        promoteScalar<InT>(input, numComponents, byteSwap, output);
+        break;
+    }
+}
+
+template <typename InT>
+void scale(const sys::ubyte* input,
+           size_t numComponents,
+           bool byteSwap,
+           double scaleFactor,
+           float* output,
+           cphd::InstructionSet instructionSet)
+{
+    switch (limit(instructionSet))
+    {
+#if defined(CPHD_X86_64_SIMD)
+    case cphd::INSTRUCTION_SET_AVX2:
+        scaleAVX2<InT>(input, numComponents, byteSwap, scaleFactor, output);
+        break;
+    case cphd::INSTRUCTION_SET_SSE2:
+        scaleSSE2<InT>(
+                input, numComponents, byteSwap, scaleFactor, output);
+        break;
+#endif
+    default:
+        scaleScalar<InT>(input, numComponents, byteSwap, scaleFactor,
+                         output);
+        break;
+    }
+}
+}
+
+namespace cphd
+{
+InstructionSet getBestInstructionSet()
+{
+    static const InstructionSet best = detectInstructionSet();
+    return best;
+}
+
+void swapBytes(void* buffer,
+               size_t elemSize,
+               size_t numElements,
+               InstructionSet instructionSet)
+{
+    sys::ubyte* const bytes = static_cast<sys::ubyte*>(buffer);
+    const bool canVectorize =
+            elemSize == 2 || elemSize == 4 || elemSize == 8;
+
+    switch (canVectorize ? limit(instructionSet) : INSTRUCTION_SET_SCALAR)
+    {
+#if defined(CPHD_X86_64_SIMD)
+    case INSTRUCTION_SET_AVX2:
+        swapBytesAVX2(bytes, elemSize, numElements);
+        break;
+    case INSTRUCTION_SET_SSE2:
+        swapBytesSSE2(bytes, elemSize, numElements);
+        break;
+#endif
+    default:
+        sys::byteSwap(bytes, static_cast<unsigned short>(elemSize),
+                      numElements);
+        break;
+    }
+}
+
+void promoteSamples(const void* input,
+                    size_t elementSize,
+                    size_t numSamples,
+                    bool byteSwap,
+                    std::complex<float>* output,
+                    InstructionSet instructionSet)
+{
+    const sys::ubyte* const in = static_cast<const sys::ubyte*>(input);
+    float* const out = reinterpret_cast<float*>(output);
+    const size_t numComponents = numSamples * 2;
+
+    switch (elementSize)
+    {
+    case 2:
+        ::promote<sys::Int8_T>(in, numComponents, byteSwap, out,
+                               instructionSet);
+        break;
+    case 4:
+        ::promote<sys::Int16_T>(in, numComponents, byteSwap, out,
+                                instructionSet);
+        break;
+    case 8:
+        ::promote<float>(in, numComponents, byteSwap, out, instructionSet);
+        break;
+    default:
+        throw except::Exception(Ctxt(
+                "Unexpected element size " + str::toString(elementSize)));
+    }
+}
+
+void scaleSamples(const void* input,
+                  size_t elementSize,
+                  size_t numSamples,
+                  bool byteSwap,
+                  double scaleFactor,
+                  std::complex<float>* output,
+                  InstructionSet instructionSet)
+{
+    const sys::ubyte* const in = static_cast<const sys::ubyte*>(input);
+    float* const out = reinterpret_cast<float*>(output);
+    const size_t numComponents = numSamples * 2;
+
+    switch (elementSize)
+    {
+    case 2:
+        ::scale<sys::Int8_T>(in, numComponents, byteSwap, scaleFactor, out,
+                             instructionSet);
+        break;
+    case 4:
+        ::scale<sys::Int16_T>(in, numComponents, byteSwap, scaleFactor, out,
+                              instructionSet);
+        break;
+    case 8:
+        ::scale<float>(in, numComponents, byteSwap, scaleFactor, out,
+                       instructionSet);
+        break;
+    default:
+        throw except::Exception(Ctxt(
+                "Unexpected element size " + str::toString(elementSize)));
+    }
+}
+}
@@ -94,9 +94,8 @@ void SupportBlock::read(const std::string& id,
     // First to the start of the first support array we're going to read
     sys::Off_T inOffset = getFileOffset(id);
     sys::byte* dataPtr = reinterpret_cast<sys::byte*>(data.data);
-    mInStream->seek(inOffset, io::FileInputStream::START);
     size_t size = mData.getSupportArrayById(id).getSize();
-    mInStream->read(dataPtr, size);
+    mInStream->readAt(inOffset, dataPtr, size);
 
     if (!sys::isBigEndianSystem() && mData.getElementSize(id) > 1)
     {
@@ -20,20 +20,24 @@
  *
  */
 
+#include <algorithm>
 #include <limits>
 #include <sstream>
 
 #include <cphd/ByteSwap.h>
+#include <cphd/SampleConversion.h>
 #include <cphd/Wideband.h>
 #include <except/Exception.h>
 #include <io/FileInputStream.h>
-#include <mt/ThreadGroup.h>
 #include <mt/ThreadPlanner.h>
 #include <six/Init.h>
 #include <sys/Conf.h>
 
 namespace
 {
+// Blocks smaller than this aren't worth splitting across threads
+const size_t MIN_ELEMENTS_PER_CHUNK = 16 * 1024;
+
 template <typename InT>
 class PromoteRunnable : public sys::Runnable
 {
@@ -51,14 +55,11 @@ public:
 
     virtual void run()
     {
-        for (size_t row = 0, idx = 0; row < mDims.row; ++row)
-        {
-            for (size_t col = 0; col < mDims.col; ++col, ++idx)
-            {
-                const std::complex<InT>& input(mInput[idx]);
-                mOutput[idx] = std::complex<float>(input.real(), input.imag());
-            }
-        }
+        cphd::promoteSamples(mInput,
+                             sizeof(std::complex<InT>),
+                             mDims.area(),
+                             false,
+                             mOutput);
     }
 
 private:
@@ -86,15 +87,14 @@ public:
 
     virtual void run()
     {
-        for (size_t row = 0, idx = 0; row < mDims.row; ++row)
+        for (size_t row = 0; row < mDims.row; ++row)
         {
-            const double scaleFactor(mScaleFactors[row]);
-            for (size_t col = 0; col < mDims.col; ++col, ++idx)
-            {
-                const std::complex<InT>& input(mInput[idx]);
-                mOutput[idx] = std::complex<float>(input.real() * scaleFactor,
-                                                   input.imag() * scaleFactor);
-            }
+            cphd::scaleSamples(mInput + row * mDims.col,
+                               sizeof(std::complex<InT>),
+                               mDims.col,
+                               false,
+                               mScaleFactors[row],
+                               mOutput + row * mDims.col);
         }
     }
 
@@ -108,57 +108,45 @@ private:
 template <typename InT>
 void promote(const void* input,
              const types::RowCol<size_t>& dims,
-             size_t numThreads,
+             six::ThreadPool& threadPool,
              std::complex<float>* output)
 {
-    if (numThreads <= 1)
-    {
-        PromoteRunnable<InT>(static_cast<const std::complex<InT>*>(input),
-                             0,
-                             dims.row,
-                             dims.col,
-                             output)
-                .run();
-    }
-    else
-    {
-        mt::ThreadGroup threads;
-        const mt::ThreadPlanner planner(dims.row, numThreads);
-
-        size_t threadNum(0);
-        size_t startRow(0);
-        size_t numRowsThisThread(0);
-        while (planner.getThreadInfo(threadNum++, startRow, numRowsThisThread))
-        {
-            std::auto_ptr<sys::Runnable> scaler(new PromoteRunnable<InT>(
-                    static_cast<const std::complex<InT>*>(input),
-                    startRow,
-                    numRowsThisThread,
-                    dims.col,
-                    output));
-            threads.createThread(scaler);
-        }
-
-        threads.joinAll();
-    }
+    const mt::ThreadPlanner planner(
+            dims.row,
+            threadPool.getNumChunks(dims.area(), MIN_ELEMENTS_PER_CHUNK));
+
+    std::vector<PromoteRunnable<InT> > runnables;
+    size_t threadNum(0);
+    size_t startRow(0);
+    size_t numRowsThisThread(0);
+    while (planner.getThreadInfo(threadNum++, startRow, numRowsThisThread))
+    {
+        runnables.push_back(PromoteRunnable<InT>(
+                static_cast<const std::complex<InT>*>(input),
+                startRow,
+                numRowsThisThread,
+                dims.col,
+                output));
+    }
+    threadPool.runEach(runnables);
 }
 
 void promote(const void* input,
              size_t elementSize,
              const types::RowCol<size_t>& dims,
-             size_t numThreads,
+             six::ThreadPool& threadPool,
              std::complex<float>* output)
 {
     switch (elementSize)
     {
     case 2:
-        promote<sys::Int8_T>(input, dims, numThreads, output);
+        promote<sys::Int8_T>(input, dims, threadPool, output);
         break;
     case 4:
-        promote<sys::Int16_T>(input, dims, numThreads, output);
+        promote<sys::Int16_T>(input, dims, threadPool, output);
         break;
     case 8:
-        promote<float>(input, dims, numThreads, output);
+        promote<float>(input, dims, threadPool, output);
         break;
     default:
         throw except::Exception(
@@ -169,60 +157,47 @@ template <typename InT>
 void scale(const void* input,
            const types::RowCol<size_t>& dims,
            const double* scaleFactors,
-           size_t numThreads,
+           six::ThreadPool& threadPool,
            std::complex<float>* output)
 {
-    if (numThreads <= 1)
-    {
-        ScaleRunnable<InT>(static_cast<const std::complex<InT>*>(input),
-                           0,
-                           dims.row,
-                           dims.col,
-                           scaleFactors,
-                           output)
-                .run();
-    }
-    else
-    {
-        mt::ThreadGroup threads;
-        const mt::ThreadPlanner planner(dims.row, numThreads);
-
-        size_t threadNum(0);
-        size_t startRow(0);
-        size_t numRowsThisThread(0);
-        while (planner.getThreadInfo(threadNum++, startRow, numRowsThisThread))
-        {
-            std::auto_ptr<sys::Runnable> scaler(new ScaleRunnable<InT>(
-                    static_cast<const std::complex<InT>*>(input),
-                    startRow,
-                    numRowsThisThread,
-                    dims.col,
-                    scaleFactors,
-                    output));
-            threads.createThread(scaler);
-        }
-
-        threads.joinAll();
-    }
+    const mt::ThreadPlanner planner(
+            dims.row,
+            threadPool.getNumChunks(dims.area(), MIN_ELEMENTS_PER_CHUNK));
+
+    std::vector<ScaleRunnable<InT> > runnables;
+    size_t threadNum(0);
+    size_t startRow(0);
+    size_t numRowsThisThread(0);
+    while (planner.getThreadInfo(threadNum++, startRow, numRowsThisThread))
+    {
+        runnables.push_back(ScaleRunnable<InT>(
+                static_cast<const std::complex<InT>*>(input),
+                startRow,
+                numRowsThisThread,
+                dims.col,
+                scaleFactors,
+                output));
+    }
+    threadPool.runEach(runnables);
 }
 
 void scale(const void* input,
            size_t elementSize,
            const types::RowCol<size_t>& dims,
            const double* scaleFactors,
-           size_t numThreads,
+           six::ThreadPool& threadPool,
            std::complex<float>* output)
 {
     switch (elementSize)
     {
     case 2:
-        scale<sys::Int8_T>(input, dims, scaleFactors, numThreads, output);
+        scale<sys::Int8_T>(input, dims, scaleFactors, threadPool, output);
         break;
     case 4:
-        scale<sys::Int16_T>(input, dims, scaleFactors, numThreads, output);
+        scale<sys::Int16_T>(input, dims, scaleFactors, threadPool, output);
         break;
     case 8:
-        scale<float>(input, dims, scaleFactors, numThreads, output);
+        scale<float>(input, dims, scaleFactors, threadPool, output);
         break;
     default:
         throw except::Exception(
@@ -234,6 +209,7 @@ void scale(const void* input,
 namespace cphd
 {
 const size_t Wideband::ALL = std::numeric_limits<size_t>::max();
+const size_t Wideband::DEFAULT_SWATH_BYTES = 32000000;
 
 Wideband::Wideband(const std::string& pathname,
                    const cphd::MetadataBase& metadata,
@@ -409,9 +385,10 @@ void Wideband::readImpl(size_t channel,
     sys::byte* dataPtr = static_cast<sys::byte*>(data);
     if (dims.col == mMetadata.getNumSamples(channel))
     {
-        // Life is easy - can do a single seek and read
-        mInStream->seek(inOffset, io::FileInputStream::START);
-        mInStream->read(dataPtr, dims.row * dims.col * mElementSize);
+        // Life is easy - can do a single read
+        mInStream->readAt(inOffset,
+                          dataPtr,
+                          dims.row * dims.col * mElementSize);
     }
     else
     {
@@ -423,8 +400,7 @@ void Wideband::readImpl(size_t channel,
 
         for (size_t row = 0; row < dims.row; ++row)
         {
-            mInStream->seek(inOffset, io::FileInputStream::START);
-            mInStream->read(dataPtr, bytesPerVectorAOI);
+            mInStream->readAt(inOffset, dataPtr, bytesPerVectorAOI);
             dataPtr += bytesPerVectorAOI;
             inOffset += bytesPerVectorFile;
         }
@@ -438,8 +414,7 @@ void Wideband::readImpl(size_t channel, void* data) const
     sys::Off_T inOffset = getFileOffset(channel);
 
     sys::byte* dataPtr = static_cast<sys::byte*>(data);
-    mInStream->seek(inOffset, io::FileInputStream::START);
-    mInStream->read(dataPtr, getBytesRequiredForRead(channel));
+    mInStream->readAt(inOffset, dataPtr, getBytesRequiredForRead(channel));
 }
 
 void Wideband::read(size_t channel,
@@ -449,6 +424,24 @@ void Wideband::read(size_t channel,
                     size_t lastSample,
                     size_t numThreads,
                     const mem::BufferView<sys::ubyte>& data) const
+{
+    six::ThreadPool threadPool(numThreads);
+    read(channel,
+         firstVector,
+         lastVector,
+         firstSample,
+         lastSample,
+         threadPool,
+         data);
+}
+
+void Wideband::read(size_t channel,
+                    size_t firstVector,
+                    size_t lastVector,
+                    size_t firstSample,
+                    size_t lastSample,
+                    six::ThreadPool& threadPool,
+                    const mem::BufferView<sys::ubyte>& data) const
 {
     // Sanity checks
     types::RowCol<size_t> dims;
@@ -477,7 +470,7 @@ void Wideband::read(size_t channel,
     // Element size is half mElementSize because it's complex
     if (shouldByteSwap())
     {
-        cphd::byteSwap(data.data, mElementSize / 2, numPixels * 2, numThreads);
+        cphd::byteSwap(data.data, mElementSize / 2, numPixels * 2, threadPool);
     }
 }
 
@@ -595,6 +588,28 @@ void Wideband::read(size_t channel,
                     size_t numThreads,
                     const mem::BufferView<sys::ubyte>& scratch,
                     const mem::BufferView<std::complex<float>>& data) const
+{
+    six::ThreadPool threadPool(numThreads);
+    read(channel,
+         firstVector,
+         lastVector,
+         firstSample,
+         lastSample,
+         vectorScaleFactors,
+         threadPool,
+         scratch,
+         data);
+}
+
+void Wideband::read(size_t channel,
+                    size_t firstVector,
+                    size_t lastVector,
+                    size_t firstSample,
+                    size_t lastSample,
+                    const std::vector<double>& vectorScaleFactors,
+                    six::ThreadPool& threadPool,
+                    const mem::BufferView<sys::ubyte>& scratch,
+                    const mem::BufferView<std::complex<float>>& data) const
 {
     // Sanity checks
     types::RowCol<size_t> dims;
@@ -655,7 +670,7 @@ void Wideband::read(size_t channel,
                                    mElementSize,
                                    dims,
                                    &vectorScaleFactors[0],
-                                   numThreads,
+                                   threadPool,
                                    data.data);
         }
         else
@@ -665,7 +680,7 @@ void Wideband::read(size_t channel,
                   mElementSize,
                   dims,
                   &vectorScaleFactors[0],
-                  numThreads,
+                  threadPool,
                   data.data);
         }
     }
@@ -683,11 +698,11 @@ void Wideband::read(size_t channel,
         if (!sys::isBigEndianSystem() && mElementSize > 2)
         {
             cphd::byteSwapAndPromote(
-                    scratch.data, mElementSize, dims, numThreads, data.data);
+                    scratch.data, mElementSize, dims, threadPool, data.data);
         }
         else
         {
-            promote(scratch.data, mElementSize, dims, numThreads, data.data);
+            promote(scratch.data, mElementSize, dims, threadPool, data.data);
         }
     }
     else
@@ -707,8 +722,120 @@ void Wideband::read(size_t channel,
             cphd::byteSwap(data.data,
                            mElementSize / 2,
                            numPixels * 2,
-                           numThreads);
+                           threadPool);
+        }
+    }
+}
+
+void Wideband::readDecimated(size_t channel,
+                             size_t firstVector,
+                             size_t lastVector,
+                             size_t firstSample,
+                             size_t lastSample,
+                             const six::Decimation& decimation,
+                             const std::vector<double>& vectorScaleFactors,
+                             six::ThreadPool& threadPool,
+                             const mem::BufferView<float>& data,
+                             size_t swathBytes) const
+{
+    types::RowCol<size_t> dims;
+    checkReadInputs(
+            channel, firstVector, lastVector, firstSample, lastSample, dims);
+
+    if (!vectorScaleFactors.empty() && vectorScaleFactors.size() != dims.row)
+    {
+        std::ostringstream ostr;
+        ostr << "Expected " << dims.row << " vector scale factors but got "
+             << vectorScaleFactors.size();
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+
+    const types::RowCol<size_t> outputDims =
+            decimation.getDecimatedDims(dims);
+    if (data.size < outputDims.area())
+    {
+        std::ostringstream ostr;
+        ostr << "Need at least " << outputDims.area()
+             << " pixels but only got " << data.size;
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+
+    // Decimated vectors are read a swath at a time
+    const size_t rowsPerOutputRow = decimation.getRowsPerOutputRow();
+    const size_t bytesPerOutputRow =
+            rowsPerOutputRow * dims.col * sizeof(std::complex<float>);
+    const size_t outputRowsPerSwath = std::min(
+            std::max<size_t>(swathBytes / bytesPerOutputRow, 1),
+            outputDims.row);
+    const size_t maxSamplesPerSwath =
+            outputRowsPerSwath * rowsPerOutputRow * dims.col;
+    std::vector<std::complex<float> > samples(maxSamplesPerSwath);
+    std::vector<sys::ubyte> scratch(maxSamplesPerSwath * mElementSize);
+
+    // Skipping reads each vector that's kept by itself
+    const bool readEachVector = (decimation.method == six::Decimation::SKIP &&
+                                 decimation.factor.row > 1);
+
+    std::vector<double> scaleFactors;
+    for (size_t outputRow = 0; outputRow < outputDims.row;
+         outputRow += outputRowsPerSwath)
+    {
+        const size_t numOutputRows =
+                std::min(outputRowsPerSwath, outputDims.row - outputRow);
+        const size_t firstRow = outputRow * decimation.factor.row;
+        size_t numInputRows;
+
+        if (readEachVector)
+        {
+            numInputRows = numOutputRows;
+            for (size_t row = 0; row < numOutputRows; ++row)
+            {
+                const size_t vectorRow =
+                        firstRow + row * decimation.factor.row;
+                scaleFactors.assign(1, vectorScaleFactors.empty() ?
+                        1.0 : vectorScaleFactors[vectorRow]);
+                read(channel,
+                     firstVector + vectorRow,
+                     firstVector + vectorRow,
+                     firstSample,
+                     lastSample,
+                     scaleFactors,
+                     threadPool,
+                     mem::BufferView<sys::ubyte>(
+                             &scratch[row * dims.col * mElementSize],
+                             dims.col * mElementSize),
+                     mem::BufferView<std::complex<float> >(
+                             &samples[row * dims.col], dims.col));
+            }
         }
+        else
+        {
+            numInputRows = std::min(numOutputRows * decimation.factor.row,
+                                    dims.row - firstRow);
+            if (vectorScaleFactors.empty())
+            {
+                scaleFactors.assign(numInputRows, 1.0);
+            }
+            else
+            {
+                scaleFactors.assign(
+                        vectorScaleFactors.begin() + firstRow,
+                        vectorScaleFactors.begin() + firstRow + numInputRows);
+            }
+            read(channel,
+                 firstVector + firstRow,
+                 firstVector + firstRow + numInputRows - 1,
+                 firstSample,
+                 lastSample,
+                 scaleFactors,
+                 threadPool,
+                 mem::BufferView<sys::ubyte>(&scratch[0], scratch.size()),
+                 mem::BufferView<std::complex<float> >(&samples[0],
+                                                       samples.size()));
+        }
+
+        decimation.reduce(&samples[0], numInputRows, dims.col, threadPool,
+                          data.data + outputRow * outputDims.col);
     }
 }
 
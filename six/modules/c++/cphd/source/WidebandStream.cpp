@@ -0,0 +1,320 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <exception>
+#include <sstream>
+
+#include <mt/CriticalSection.h>
+#include <cphd/WidebandStream.h>
+
+namespace cphd
+{
+class WidebandStream::Prefetcher : public sys::Runnable
+{
+public:
+    explicit Prefetcher(WidebandStream& stream) :
+        mStream(stream)
+    {
+    }
+
+    virtual void run()
+    {
+        mStream.prefetch();
+    }
+
+private:
+    WidebandStream& mStream;
+};
+
+WidebandStream::Block::Block() :
+    mOutputType(RAW),
+    mFirstVector(0),
+    mNumVectors(0),
+    mNumSamples(0),
+    mElementSize(0)
+{
+}
+
+mem::BufferView<sys::ubyte> WidebandStream::Block::getData() const
+{
+    if (mOutputType != RAW)
+    {
+        throw except::Exception(Ctxt("Block was not read as RAW"));
+    }
+    return mem::BufferView<sys::ubyte>(
+            const_cast<sys::ubyte*>(mData.data()),
+            mNumVectors * mNumSamples * mElementSize);
+}
+
+mem::BufferView<std::complex<float> >
+WidebandStream::Block::getComplexData() const
+{
+    if (mOutputType != COMPLEX_FLOAT)
+    {
+        throw except::Exception(Ctxt("Block was not read as COMPLEX_FLOAT"));
+    }
+    return mem::BufferView<std::complex<float> >(
+            const_cast<std::complex<float>*>(mComplexData.data()),
+            mNumVectors * mNumSamples);
+}
+
+WidebandStream::WidebandStream(const Wideband& wideband,
+                               size_t channel,
+                               size_t vectorsPerBlock,
+                               OutputType outputType,
+                               six::ThreadPool& threadPool,
+                               const std::vector<double>& vectorScaleFactors,
+                               size_t numBuffers) :
+    mWideband(wideband),
+    mChannel(channel),
+    mVectorsPerBlock(vectorsPerBlock),
+    mOutputType(outputType),
+    mThreadPool(threadPool),
+    mVectorScaleFactors(vectorScaleFactors),
+    mNumVectors(0),
+    mNumBlocks(0),
+    mNumRead(0),
+    mNumReleased(0),
+    mNumConsumed(0),
+    mHoldingBlock(false),
+    mCancelled(false),
+    mBlockRead(&mMutex),
+    mBlockReleased(&mMutex)
+{
+    if (mVectorsPerBlock == 0)
+    {
+        throw except::Exception(Ctxt("Must read at least one vector per block"));
+    }
+
+    const types::RowCol<size_t> channelDims =
+            mWideband.getBufferDims(mChannel, 0, Wideband::ALL,
+                                    0, Wideband::ALL);
+    mNumVectors = channelDims.row;
+    mNumBlocks = (mNumVectors + mVectorsPerBlock - 1) / mVectorsPerBlock;
+
+    if (!mVectorScaleFactors.empty())
+    {
+        if (mOutputType != COMPLEX_FLOAT)
+        {
+            throw except::Exception(Ctxt(
+                    "Scale factors can only be applied to COMPLEX_FLOAT output"));
+        }
+        if (mVectorScaleFactors.size() != mNumVectors)
+        {
+            std::ostringstream ostr;
+            ostr << "Expected " << mNumVectors
+                 << " vector scale factors but got "
+                 << mVectorScaleFactors.size();
+            throw except::Exception(Ctxt(ostr.str()));
+        }
+    }
+
+    // An empty channel has no blocks to read, so there's nothing to prefetch
+    if (mNumVectors == 0)
+    {
+        return;
+    }
+
+    // Throws if the channel is compressed and can't be read in pieces
+    const types::RowCol<size_t> blockDims =
+            mWideband.getBufferDims(mChannel,
+                                    0,
+                                    std::min(mVectorsPerBlock, mNumVectors) - 1,
+                                    0,
+                                    Wideband::ALL);
+
+    // Allocate everything up front so that blocks are just refilled
+    const size_t elementSize = mWideband.getElementSize();
+    const size_t numPixels = blockDims.area();
+    const bool needScratch = elementSize != 8 || !mVectorScaleFactors.empty();
+
+    mBlocks.resize(std::max<size_t>(numBuffers, 2));
+    for (size_t ii = 0; ii < mBlocks.size(); ++ii)
+    {
+        Block& block(mBlocks[ii]);
+        block.mOutputType = mOutputType;
+        block.mNumSamples = blockDims.col;
+        block.mElementSize = elementSize;
+        if (mOutputType == RAW)
+        {
+            block.mData.resize(numPixels * elementSize);
+        }
+        else
+        {
+            block.mComplexData.resize(numPixels);
+            block.mScaleFactors.reserve(blockDims.row);
+            if (needScratch)
+            {
+                block.mData.resize(numPixels * elementSize);
+            }
+        }
+    }
+
+    mThread.reset(new sys::Thread(new Prefetcher(*this)));
+    mThread->start();
+}
+
+WidebandStream::~WidebandStream()
+{
+    if (!mThread.get())
+    {
+        return;
+    }
+
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        mCancelled = true;
+        mBlockReleased.broadcast();
+    }
+    try
+    {
+        mThread->join();
+    }
+    catch (...)
+    {
+    }
+}
+
+const WidebandStream::Block* WidebandStream::next()
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+
+    // Give the previous block back to be refilled
+    if (mHoldingBlock)
+    {
+        mHoldingBlock = false;
+        mNumReleased = mNumConsumed;
+        mBlockReleased.broadcast();
+    }
+
+    if (mNumConsumed == mNumBlocks)
+    {
+        return NULL;
+    }
+
+    while (mNumRead == mNumConsumed && !mError.get())
+    {
+        mBlockRead.wait();
+    }
+    if (mNumRead == mNumConsumed)
+    {
+        throw except::Exception(*mError);
+    }
+
+    const Block& block = mBlocks[mNumConsumed % mBlocks.size()];
+    ++mNumConsumed;
+    mHoldingBlock = true;
+    return &block;
+}
+
+void WidebandStream::prefetch()
+{
+    for (size_t blockNum = 0; blockNum < mNumBlocks; ++blockNum)
+    {
+        {
+            mt::CriticalSection<sys::Mutex> lock(&mMutex);
+            while (!mCancelled && blockNum - mNumReleased >= mBlocks.size())
+            {
+                mBlockReleased.wait();
+            }
+            if (mCancelled)
+            {
+                return;
+            }
+        }
+
+        std::unique_ptr<except::Exception> error;
+        try
+        {
+            readBlock(blockNum, mBlocks[blockNum % mBlocks.size()]);
+        }
+        catch (const except::Exception& ex)
+        {
+            error.reset(new except::Exception(ex));
+        }
+        catch (const std::exception& ex)
+        {
+            error.reset(new except::Exception(Ctxt(ex.what())));
+        }
+        catch (...)
+        {
+            error.reset(new except::Exception(Ctxt("Unknown exception")));
+        }
+
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        if (error.get())
+        {
+            mError.reset(error.release());
+            mBlockRead.broadcast();
+            return;
+        }
+        mNumRead = blockNum + 1;
+        mBlockRead.broadcast();
+    }
+}
+
+void WidebandStream::readBlock(size_t blockNum, Block& block)
+{
+    block.mFirstVector = blockNum * mVectorsPerBlock;
+    block.mNumVectors =
+            std::min(mVectorsPerBlock, mNumVectors - block.mFirstVector);
+    const size_t lastVector = block.mFirstVector + block.mNumVectors - 1;
+
+    const mem::BufferView<sys::ubyte> data(block.mData.data(),
+                                           block.mData.size());
+    if (mOutputType == RAW)
+    {
+        mWideband.read(mChannel,
+                       block.mFirstVector,
+                       lastVector,
+                       0,
+                       Wideband::ALL,
+                       mThreadPool,
+                       data);
+    }
+    else
+    {
+        if (mVectorScaleFactors.empty())
+        {
+            block.mScaleFactors.assign(block.mNumVectors, 1.0);
+        }
+        else
+        {
+            block.mScaleFactors.assign(
+                    mVectorScaleFactors.begin() + block.mFirstVector,
+                    mVectorScaleFactors.begin() + lastVector + 1);
+        }
+
+        mWideband.read(mChannel,
+                       block.mFirstVector,
+                       lastVector,
+                       0,
+                       Wideband::ALL,
+                       block.mScaleFactors,
+                       mThreadPool,
+                       data,
+                       mem::BufferView<std::complex<float> >(
+                               block.mComplexData.data(),
+                               block.mComplexData.size()));
+    }
+}
+}
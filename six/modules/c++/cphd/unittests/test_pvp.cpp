@@ -60,6 +60,29 @@ TEST_CASE(testAppend)
     TEST_ASSERT_TRUE(pvp.signal.getOffset() == 16);
 }
 
+TEST_CASE(testGetParameters)
+{
+    cphd::Pvp pvp;
+    pvp.append(pvp.txPos);
+    pvp.appendCustomParameter(1, "U4", "AddedParam1");
+    pvp.append(pvp.txTime);
+    pvp.append(pvp.signal);
+
+    // Only parameters with offsets, in order of offset
+    const std::vector<cphd::APVPType> parameters = pvp.getParameters();
+    TEST_ASSERT_EQ(parameters.size(), 4);
+    TEST_ASSERT_EQ(parameters[0].getName(), "txPos");
+    TEST_ASSERT_EQ(parameters[0].getSize(), 3);
+    TEST_ASSERT_EQ(parameters[0].getFormat(), "X=F8;Y=F8;Z=F8;");
+    TEST_ASSERT_EQ(parameters[1].getName(), "AddedParam1");
+    TEST_ASSERT_EQ(parameters[1].getOffset(), 3);
+    TEST_ASSERT_EQ(parameters[1].getFormat(), "U4");
+    TEST_ASSERT_EQ(parameters[2].getName(), "txTime");
+    TEST_ASSERT_EQ(parameters[2].getOffset(), 4);
+    TEST_ASSERT_EQ(parameters[3].getName(), "signal");
+    TEST_ASSERT_EQ(parameters[3].getFormat(), "I8");
+}
+
 TEST_CASE(testAddedParamsEqualityOperatorTrue)
 {
     cphd::Pvp pvp1;
@@ -110,6 +133,7 @@ int main(int /*argc*/, char** /*argv*/)
     {
         TEST_CHECK(testSimpleEqualityOperatorTrue);
         TEST_CHECK(testAppend);
+        TEST_CHECK(testGetParameters);
         TEST_CHECK(testAddedParamsEqualityOperatorTrue);
         TEST_CHECK(testSimpleEqualityOperatorFalse);
         TEST_CHECK(testAddedParamsEqualityOperatorFalse);
@@ -292,6 +292,53 @@ TEST_CASE(testPvpEquality)
     TEST_ASSERT_EQ(pvpBlock1, pvpBlock2);
 }
 
+TEST_CASE(testPvpArray)
+{
+    cphd::Pvp pvp;
+    cphd::setPVPXML(pvp);
+    pvp.setOffset(28, pvp.ampSF);
+    pvp.setCustomParameter(1, 29, "F4", "Param1");
+    cphd::PVPBlock pvpBlock(NUM_CHANNELS,
+                            std::vector<size_t>(NUM_CHANNELS, NUM_VECTORS),
+                            pvp);
+
+    for (size_t channel = 0; channel < NUM_CHANNELS; ++channel)
+    {
+        for (size_t vector = 0; vector < NUM_VECTORS; ++vector)
+        {
+            cphd::setVectorParameters(channel, vector, pvpBlock);
+            pvpBlock.setAmpSF(cphd::getRandom(), channel, vector);
+            pvpBlock.setAddedPVP(static_cast<float>(vector), channel,
+                                 vector, "Param1");
+        }
+    }
+
+    for (size_t channel = 0; channel < NUM_CHANNELS; ++channel)
+    {
+        const cphd::PVPArray& array = pvpBlock.getPVPArray(channel);
+        TEST_ASSERT_EQ(array.getNumVectors(), NUM_VECTORS);
+        TEST_ASSERT_EQ(array.ampSF.size(), NUM_VECTORS);
+        TEST_ASSERT_TRUE(array.fxN1.empty());
+
+        const cphd::Vector3* txPos = array.txPos.data();
+        const mem::BufferView<const float> param1 =
+                array.getAddedPVPArray<float>("Param1");
+        TEST_ASSERT_EQ(param1.size, NUM_VECTORS);
+        for (size_t vector = 0; vector < NUM_VECTORS; ++vector)
+        {
+            TEST_ASSERT_EQ(txPos[vector],
+                           pvpBlock.getTxPos(channel, vector));
+            TEST_ASSERT_EQ(array.ampSF[vector],
+                           pvpBlock.getAmpSF(channel, vector));
+            TEST_ASSERT_EQ(param1.data[vector],
+                           static_cast<float>(vector));
+        }
+        TEST_EXCEPTION(array.getAddedPVPArray<double>("Param1"));
+        TEST_EXCEPTION(array.getAddedPVPArray<float>("Param2"));
+    }
+    TEST_EXCEPTION(pvpBlock.getPVPArray(NUM_CHANNELS));
+}
+
 TEST_CASE(testLoadPVPBlockFromMemory)
 {
     // For ease of testing, we make the somewhat specious assumption
@@ -334,6 +381,38 @@ TEST_CASE(testLoadPVPBlockFromMemory)
     TEST_ASSERT_EQ(pvpBlock.getTxPos(0, 0)[1], 6);
     TEST_ASSERT_EQ(pvpBlock.getTxPos(0, 0)[2], 9);
 }
+
+TEST_CASE(testSetPVPdata)
+{
+    cphd::Pvp pvp;
+    cphd::setPVPXML(pvp);
+    pvp.append(pvp.ampSF);
+    pvp.appendCustomParameter(1, "F4", "Param1");
+    const std::vector<size_t> numVectors(NUM_CHANNELS, NUM_VECTORS);
+    cphd::PVPBlock pvpBlock(NUM_CHANNELS, numVectors, pvp);
+    for (size_t channel = 0; channel < NUM_CHANNELS; ++channel)
+    {
+        for (size_t vector = 0; vector < NUM_VECTORS; ++vector)
+        {
+            cphd::setVectorParameters(channel, vector, pvpBlock);
+            pvpBlock.setAmpSF(cphd::getRandom(), channel, vector);
+            pvpBlock.setAddedPVP(static_cast<float>(cphd::getRandom()),
+                                 channel, vector, "Param1");
+        }
+    }
+
+    // Copying each channel through its buffer reproduces the block
+    cphd::PVPBlock copy(NUM_CHANNELS, numVectors, pvp);
+    std::vector<sys::ubyte> buffer;
+    for (size_t channel = 0; channel < NUM_CHANNELS; ++channel)
+    {
+        pvpBlock.getPVPdata(channel, buffer);
+        TEST_ASSERT_EQ(buffer.size(), pvpBlock.getPVPsize(channel));
+        copy.setPVPdata(channel, &buffer[0]);
+    }
+    TEST_ASSERT_TRUE(copy == pvpBlock);
+    TEST_EXCEPTION(copy.setPVPdata(NUM_CHANNELS, &buffer[0]));
+}
 }
 
 int main(int , char** )
@@ -343,6 +422,8 @@ int main(int , char** )
     TEST_CHECK(testPvpOptional);
     TEST_CHECK(testPvpThrow);
     TEST_CHECK(testPvpEquality);
+    TEST_CHECK(testPvpArray);
     TEST_CHECK(testLoadPVPBlockFromMemory);
+    TEST_CHECK(testSetPVPdata);
     return 0;
 }
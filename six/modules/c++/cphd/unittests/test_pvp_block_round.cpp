@@ -25,6 +25,7 @@
 #include <cphd/Metadata.h>
 #include <cphd/PVP.h>
 #include <cphd/PVPBlock.h>
+#include <cphd/PVPView.h>
 #include <cphd/ReferenceGeometry.h>
 #include <cphd/TestDataGenerator.h>
 #include <cphd/Wideband.h>
@@ -136,6 +137,63 @@ void writeCPHD(const std::string& outPathname,
     }
 }
 
+bool checkView(const cphd::PVPView& view,
+               const cphd::Metadata& metadata,
+               const cphd::PVPBlock& pvpBlock)
+{
+    if (view.getNumChannels() != metadata.data.getNumChannels())
+    {
+        return false;
+    }
+    for (size_t ii = 0; ii < view.getNumChannels(); ++ii)
+    {
+        if (view.getNumVectors(ii) != metadata.data.getNumVectors(ii))
+        {
+            return false;
+        }
+        for (size_t jj = 0; jj < view.getNumVectors(ii); ++jj)
+        {
+            if (view.getTxTime(ii, jj) != pvpBlock.getTxTime(ii, jj) ||
+                view.getTxPos(ii, jj) != pvpBlock.getTxPos(ii, jj) ||
+                view.getTxVel(ii, jj) != pvpBlock.getTxVel(ii, jj) ||
+                view.getRcvTime(ii, jj) != pvpBlock.getRcvTime(ii, jj) ||
+                view.getRcvPos(ii, jj) != pvpBlock.getRcvPos(ii, jj) ||
+                view.getRcvVel(ii, jj) != pvpBlock.getRcvVel(ii, jj) ||
+                view.getSRPPos(ii, jj) != pvpBlock.getSRPPos(ii, jj) ||
+                view.getaFDOP(ii, jj) != pvpBlock.getaFDOP(ii, jj) ||
+                view.getaFRR1(ii, jj) != pvpBlock.getaFRR1(ii, jj) ||
+                view.getaFRR2(ii, jj) != pvpBlock.getaFRR2(ii, jj) ||
+                view.getFx1(ii, jj) != pvpBlock.getFx1(ii, jj) ||
+                view.getFx2(ii, jj) != pvpBlock.getFx2(ii, jj) ||
+                view.getTOA1(ii, jj) != pvpBlock.getTOA1(ii, jj) ||
+                view.getTOA2(ii, jj) != pvpBlock.getTOA2(ii, jj) ||
+                view.getTdTropoSRP(ii, jj) != pvpBlock.getTdTropoSRP(ii, jj) ||
+                view.getSC0(ii, jj) != pvpBlock.getSC0(ii, jj) ||
+                view.getSCSS(ii, jj) != pvpBlock.getSCSS(ii, jj))
+            {
+                return false;
+            }
+            if (view.hasFxN1() &&
+                (view.getFxN1(ii, jj) != pvpBlock.getFxN1(ii, jj) ||
+                 view.getFxN2(ii, jj) != pvpBlock.getFxN2(ii, jj)))
+            {
+                return false;
+            }
+            for (auto it = metadata.pvp.addedPVP.begin();
+                 it != metadata.pvp.addedPVP.end();
+                 ++it)
+            {
+                if (view.getAddedPVP<double>(ii, jj, it->first) !=
+                    pvpBlock.getAddedPVP<double>(ii, jj, it->first))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
 bool checkData(const std::string& pathname,
                size_t numThreads,
                cphd::Metadata& metadata,
@@ -151,7 +209,23 @@ bool checkData(const std::string& pathname,
     {
         return false;
     }
-    return true;
+
+    // Mapped from the file
+    const cphd::CPHDReader mappedReader(pathname,
+                                        numThreads,
+                                        cphd::CPHDReader::VIEW_PVP);
+    if (!checkView(mappedReader.getPVPView(), metadata, pvpBlock))
+    {
+        return false;
+    }
+
+    // Read raw from a stream
+    const cphd::CPHDReader streamReader(
+            std::shared_ptr<io::SeekableInputStream>(
+                    new io::FileInputStream(pathname)),
+            numThreads,
+            cphd::CPHDReader::VIEW_PVP);
+    return checkView(streamReader.getPVPView(), metadata, pvpBlock);
 }
 
 template <typename T>
@@ -20,9 +20,20 @@
  *
  */
 
+#include <algorithm>
+#include <complex>
+#include <vector>
+
 #include <cphd/Metadata.h>
 #include <cphd/Wideband.h>
+#include <cphd/WidebandStream.h>
 #include <io/ByteStream.h>
+#include <io/FileInputStream.h>
+#include <io/FileOutputStream.h>
+#include <six/Decimation.h>
+#include <six/ThreadPool.h>
+#include <sys/OS.h>
+#include <sys/Runnable.h>
 #include "TestCase.h"
 
 namespace
@@ -144,6 +155,195 @@ TEST_CASE(testReadChannelSubset)
     TEST_ASSERT_EQ(readData[7], 'G');
 }
 
+// Reads every other sample of a channel, a vector at a time
+class ReadChannel : public sys::Runnable
+{
+public:
+    ReadChannel(const cphd::Wideband& wideband,
+                size_t channel,
+                std::vector<sys::ubyte>& data) :
+        mWideband(wideband),
+        mChannel(channel),
+        mData(data)
+    {
+    }
+
+    virtual void run()
+    {
+        const size_t numVectors = mData.size() / 4;
+        for (size_t vector = 0; vector < numVectors; ++vector)
+        {
+            mWideband.read(mChannel, vector, vector, 1, 2, 1,
+                           mem::BufferView<sys::ubyte>(&mData[vector * 4],
+                                                       4));
+        }
+    }
+
+private:
+    const cphd::Wideband& mWideband;
+    const size_t mChannel;
+    std::vector<sys::ubyte>& mData;
+};
+
+TEST_CASE(testConcurrentChannelReads)
+{
+    const size_t numChannels = 8;
+    const size_t numVectors = 100;
+    cphd::Metadata metadata;
+    metadata.data.channels.resize(numChannels);
+    metadata.data.signalArrayFormat = cphd::SignalArrayFormat::CI2;
+
+    // Each channel has three samples per vector
+    const std::string pathname("test_concurrent_channel_reads.cphd");
+    std::vector<sys::ubyte> file(numChannels * numVectors * 6);
+    for (size_t ii = 0; ii < file.size(); ++ii)
+    {
+        file[ii] = static_cast<sys::ubyte>(ii % 251);
+    }
+    {
+        io::FileOutputStream output(pathname);
+        output.write(reinterpret_cast<const sys::byte*>(&file[0]),
+                     file.size());
+    }
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        metadata.data.channels[channel].numSamples = 3;
+        metadata.data.channels[channel].numVectors = numVectors;
+    }
+
+    // All the channels share one stream
+    auto input = std::make_shared<io::FileInputStream>(pathname);
+    const cphd::Wideband wideband(input, metadata, 0, file.size());
+    std::vector<std::vector<sys::ubyte> > data(
+            numChannels, std::vector<sys::ubyte>(numVectors * 4));
+    std::vector<ReadChannel> readers;
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        readers.push_back(ReadChannel(wideband, channel, data[channel]));
+    }
+    six::ThreadPool threadPool(4);
+    threadPool.runEach(readers);
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        for (size_t vector = 0; vector < numVectors; ++vector)
+        {
+            const size_t offset = (channel * numVectors + vector) * 6 + 2;
+            for (size_t ii = 0; ii < 4; ++ii)
+            {
+                TEST_ASSERT_EQ(static_cast<int>(data[channel][vector * 4 + ii]),
+                               static_cast<int>(file[offset + ii]));
+            }
+        }
+    }
+
+    input->close();
+    sys::OS().remove(pathname);
+}
+
+TEST_CASE(testReadDecimated)
+{
+    // CI2 samples of 9 vectors of 7 samples each
+    const types::RowCol<size_t> dims(9, 7);
+    cphd::Metadata metadata;
+    metadata.data.channels.resize(1);
+    metadata.data.channels[0].numSamples = dims.col;
+    metadata.data.channels[0].numVectors = dims.row;
+    metadata.data.signalArrayFormat = cphd::SignalArrayFormat::CI2;
+
+    auto input = std::make_shared<io::ByteStream>();
+    for (size_t vector = 0; vector < dims.row; ++vector)
+    {
+        for (size_t sample = 0; sample < dims.col; ++sample)
+        {
+            const sys::byte iq[] = {static_cast<sys::byte>(vector * 3 + sample),
+                                    static_cast<sys::byte>(vector - sample)};
+            input->write(iq, 2);
+        }
+    }
+    input->seek(0, io::Seekable::START);
+    const cphd::Wideband wideband(input, metadata, 0, dims.area() * 2);
+
+    // Read vectors 1 through 8 and samples 1 through 6 at full resolution
+    std::vector<double> scaleFactors;
+    for (size_t ii = 0; ii < 8; ++ii)
+    {
+        scaleFactors.push_back(1.0 + ii * 0.5);
+    }
+    six::ThreadPool threadPool(2);
+    const types::RowCol<size_t> readDims(8, 6);
+    std::vector<sys::ubyte> scratch(readDims.area() * 2);
+    std::vector<std::complex<float> > samples(readDims.area());
+    wideband.read(0, 1, 8, 1, 6, scaleFactors, threadPool,
+                  mem::BufferView<sys::ubyte>(&scratch[0], scratch.size()),
+                  mem::BufferView<std::complex<float> >(&samples[0],
+                                                        samples.size()));
+
+    // Vectors are decimated by 3, leaving a partial block of 2, and
+    // samples by 4, leaving a partial block of 2
+    const types::RowCol<size_t> factor(3, 4);
+    const types::RowCol<size_t> outputDims(3, 2);
+    const six::Decimation skip(factor, six::Decimation::SKIP);
+    const six::Decimation mean(factor, six::Decimation::MEAN_POWER);
+    const six::Decimation max(factor, six::Decimation::MAX_POWER);
+    TEST_ASSERT_EQ(wideband.getDecimatedDims(0, 1, 8, 1, 6, mean).row,
+                   outputDims.row);
+    TEST_ASSERT_EQ(wideband.getDecimatedDims(0, 1, 8, 1, 6, mean).col,
+                   outputDims.col);
+
+    std::vector<float> output(outputDims.area());
+    const mem::BufferView<float> outputView(&output[0], output.size());
+
+    // One vector at a time, and everything at once
+    const size_t swathBytes[] = {1, cphd::Wideband::DEFAULT_SWATH_BYTES};
+    for (size_t ii = 0; ii < sizeof(swathBytes) / sizeof(swathBytes[0]); ++ii)
+    {
+        wideband.readDecimated(0, 1, 8, 1, 6, skip, scaleFactors, threadPool,
+                               outputView, swathBytes[ii]);
+        TEST_ASSERT_ALMOST_EQ_EPS(output[1], std::norm(samples[4]), 1e-3f);
+        TEST_ASSERT_ALMOST_EQ_EPS(output[4],
+                                  std::norm(samples[6 * readDims.col]),
+                                  1e-3f);
+
+        wideband.readDecimated(0, 1, 8, 1, 6, max, scaleFactors, threadPool,
+                               outputView, swathBytes[ii]);
+        float expectedMax = 0;
+        for (size_t vector = 6; vector < 8; ++vector)
+        {
+            for (size_t sample = 4; sample < 6; ++sample)
+            {
+                expectedMax = std::max(expectedMax, std::norm(
+                        samples[vector * readDims.col + sample]));
+            }
+        }
+        TEST_ASSERT_ALMOST_EQ_EPS(output[5], expectedMax, 1e-3f);
+
+        wideband.readDecimated(0, 1, 8, 1, 6, mean, scaleFactors, threadPool,
+                               outputView, swathBytes[ii]);
+        float expectedMean = 0;
+        for (size_t vector = 3; vector < 6; ++vector)
+        {
+            for (size_t sample = 0; sample < 4; ++sample)
+            {
+                expectedMean += std::norm(
+                        samples[vector * readDims.col + sample]) / 12;
+            }
+        }
+        TEST_ASSERT_ALMOST_EQ_EPS(output[2], expectedMean, 1e-3f);
+    }
+
+    // Without scaling, and with the wrong number of scale factors
+    wideband.readDecimated(0, 0, 0, 0, 0, skip, std::vector<double>(),
+                           threadPool, outputView);
+    TEST_ASSERT_EQ(output[0], 0.0f);
+    TEST_EXCEPTION(wideband.readDecimated(0, 1, 8, 1, 6, skip,
+                                          std::vector<double>(3, 1.0),
+                                          threadPool, outputView));
+    TEST_EXCEPTION(wideband.readDecimated(
+            0, 1, 8, 1, 6, skip, scaleFactors, threadPool,
+            mem::BufferView<float>(&output[0], 5)));
+}
+
 TEST_CASE(testCannotDoPartialReadOfCompressedChannel)
 {
     auto input = std::make_shared<io::ByteStream>();
@@ -164,6 +364,123 @@ TEST_CASE(testCannotDoPartialReadOfCompressedChannel)
     TEST_EXCEPTION(wideband.read(0, 0, 0, 1, 1, 1, readData));
     TEST_EXCEPTION(wideband.getBytesRequiredForRead(0, 0, 0, 1, 1));
 }
+
+TEST_CASE(testStreamChannel)
+{
+    cphd::Metadata metadata;
+    metadata.data.channels.resize(1);
+    metadata.data.channels[0].numSamples = 2;
+    metadata.data.channels[0].numVectors = 5;
+    metadata.data.signalArrayFormat = cphd::SignalArrayFormat::CI2;
+
+    auto input = std::make_shared<io::ByteStream>();
+    input->write("0A1B");
+    input->write("2C3D");
+    input->write("4E5F");
+    input->write("6G7H");
+    input->write("8I9J");
+    input->seek(0, io::Seekable::START);
+
+    cphd::Wideband wideband(input, metadata, 0, 20);
+    six::ThreadPool threadPool(2);
+
+    // Raw blocks, with a short block at the end
+    cphd::WidebandStream rawStream(wideband, 0, 2,
+                                   cphd::WidebandStream::RAW, threadPool);
+    TEST_ASSERT_EQ(rawStream.getNumBlocks(), 3);
+    const std::string expected("0A1B2C3D4E5F6G7H8I9J");
+    size_t numBlocks = 0;
+    while (const cphd::WidebandStream::Block* block = rawStream.next())
+    {
+        TEST_ASSERT_EQ(block->getFirstVector(), numBlocks * 2);
+        TEST_ASSERT_EQ(block->getNumVectors(), numBlocks == 2 ? 1 : 2);
+        TEST_ASSERT_EQ(block->getNumSamples(), 2);
+        const mem::BufferView<sys::ubyte> data = block->getData();
+        TEST_ASSERT_EQ(data.size, block->getNumVectors() * 4);
+        TEST_ASSERT_EQ(std::string(reinterpret_cast<char*>(data.data),
+                                   data.size),
+                       expected.substr(block->getFirstVector() * 4,
+                                       data.size));
+        TEST_EXCEPTION(block->getComplexData());
+        ++numBlocks;
+    }
+    TEST_ASSERT_EQ(numBlocks, 3);
+    TEST_ASSERT_NULL(rawStream.next());
+
+    // Scaled complex blocks
+    std::vector<double> scaleFactors(5);
+    for (size_t ii = 0; ii < scaleFactors.size(); ++ii)
+    {
+        scaleFactors[ii] = ii + 1.0;
+    }
+    cphd::WidebandStream complexStream(wideband, 0, 3,
+                                       cphd::WidebandStream::COMPLEX_FLOAT,
+                                       threadPool, scaleFactors, 3);
+    numBlocks = 0;
+    while (const cphd::WidebandStream::Block* block = complexStream.next())
+    {
+        const mem::BufferView<std::complex<float> > data =
+                block->getComplexData();
+        for (size_t ii = 0; ii < data.size; ++ii)
+        {
+            const size_t vector = block->getFirstVector() + ii / 2;
+            const size_t offset = 2 * (vector * 2 + ii % 2);
+            const std::complex<float> sample(
+                    static_cast<float>(expected[offset] * (vector + 1.0)),
+                    static_cast<float>(expected[offset + 1] * (vector + 1.0)));
+            TEST_ASSERT_EQ(data.data[ii], sample);
+        }
+        ++numBlocks;
+    }
+    TEST_ASSERT_EQ(numBlocks, 2);
+
+    // Stopping early doesn't wait for the rest of the channel
+    cphd::WidebandStream earlyStream(wideband, 0, 1,
+                                     cphd::WidebandStream::RAW, threadPool);
+    TEST_ASSERT_TRUE(earlyStream.next() != NULL);
+
+    TEST_EXCEPTION(cphd::WidebandStream(wideband, 0, 0,
+                                        cphd::WidebandStream::RAW,
+                                        threadPool));
+    TEST_EXCEPTION(cphd::WidebandStream(wideband, 0, 1,
+                                        cphd::WidebandStream::COMPLEX_FLOAT,
+                                        threadPool,
+                                        std::vector<double>(4, 1.0)));
+}
+
+TEST_CASE(testStreamEmptyChannel)
+{
+    cphd::Metadata metadata;
+    metadata.data.channels.resize(2);
+    metadata.data.channels[0].numSamples = 2;
+    metadata.data.channels[0].numVectors = 0;
+    metadata.data.channels[1].numSamples = 2;
+    metadata.data.channels[1].numVectors = 1;
+    metadata.data.signalArrayFormat = cphd::SignalArrayFormat::CI2;
+
+    auto input = std::make_shared<io::ByteStream>();
+    input->write("0A1B");
+    input->seek(0, io::Seekable::START);
+
+    cphd::Wideband wideband(input, metadata, 0, 4);
+    six::ThreadPool threadPool(2);
+
+    cphd::WidebandStream rawStream(wideband, 0, 2,
+                                   cphd::WidebandStream::RAW, threadPool);
+    TEST_ASSERT_EQ(rawStream.getNumBlocks(), 0);
+    TEST_ASSERT_NULL(rawStream.next());
+    TEST_ASSERT_NULL(rawStream.next());
+
+    cphd::WidebandStream complexStream(wideband, 0, 2,
+                                       cphd::WidebandStream::COMPLEX_FLOAT,
+                                       threadPool, std::vector<double>());
+    TEST_ASSERT_NULL(complexStream.next());
+
+    TEST_EXCEPTION(cphd::WidebandStream(wideband, 0, 1,
+                                        cphd::WidebandStream::COMPLEX_FLOAT,
+                                        threadPool,
+                                        std::vector<double>(1, 1.0)));
+}
 }
 
 int main(int, char**)
@@ -171,6 +488,10 @@ int main(int, char**)
     TEST_CHECK(testReadCompressedChannel);
     TEST_CHECK(testReadUncompressedChannel);
     TEST_CHECK(testReadChannelSubset);
+    TEST_CHECK(testConcurrentChannelReads);
+    TEST_CHECK(testReadDecimated);
     TEST_CHECK(testCannotDoPartialReadOfCompressedChannel);
+    TEST_CHECK(testStreamChannel);
+    TEST_CHECK(testStreamEmptyChannel);
     return 0;
 }
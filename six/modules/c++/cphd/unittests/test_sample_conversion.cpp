@@ -0,0 +1,201 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <complex>
+#include <vector>
+
+#include <cphd/SampleConversion.h>
+#include <sys/Conf.h>
+#include "TestCase.h"
+
+namespace
+{
+// Not a multiple of any vector width, so the tails get exercised too
+const size_t NUM_SAMPLES = 1000 + 7;
+
+std::vector<sys::ubyte> getRandomBytes(size_t numBytes, size_t elementSize)
+{
+    std::vector<sys::ubyte> bytes(numBytes);
+    for (size_t ii = 0; ii < numBytes; ++ii)
+    {
+        bytes[ii] = static_cast<sys::ubyte>(rand() & 0xFF);
+    }
+
+    // Keep the floats finite so NaN payloads can't confuse the comparison
+    if (elementSize == 8)
+    {
+        float* const values = reinterpret_cast<float*>(&bytes[0]);
+        for (size_t ii = 0; ii < numBytes / sizeof(float); ++ii)
+        {
+            values[ii] = static_cast<float>(rand() - RAND_MAX / 2) / 1024;
+            if (ii % 2)
+            {
+                sys::byteSwap(&values[ii], sizeof(float), 1);
+            }
+        }
+    }
+    return bytes;
+}
+
+bool matches(const std::vector<std::complex<float> >& lhs,
+             const std::vector<std::complex<float> >& rhs)
+{
+    return lhs.size() == rhs.size() &&
+            memcmp(&lhs[0], &rhs[0], lhs.size() * sizeof(lhs[0])) == 0;
+}
+
+bool checkPromote(size_t elementSize, bool byteSwap)
+{
+    const std::vector<sys::ubyte> input =
+            getRandomBytes(NUM_SAMPLES * elementSize, elementSize);
+    std::vector<std::complex<float> > expected(NUM_SAMPLES);
+    cphd::promoteSamples(&input[0], elementSize, NUM_SAMPLES, byteSwap,
+                         &expected[0], cphd::INSTRUCTION_SET_SCALAR);
+
+    for (int set = cphd::INSTRUCTION_SET_SSE2;
+         set <= cphd::getBestInstructionSet();
+         ++set)
+    {
+        std::vector<std::complex<float> > actual(NUM_SAMPLES);
+        cphd::promoteSamples(&input[0], elementSize, NUM_SAMPLES, byteSwap,
+                             &actual[0],
+                             static_cast<cphd::InstructionSet>(set));
+        if (!matches(expected, actual))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkScale(size_t elementSize, bool byteSwap)
+{
+    const std::vector<sys::ubyte> input =
+            getRandomBytes(NUM_SAMPLES * elementSize, elementSize);
+    const double scaleFactor = 0.123456789;
+    std::vector<std::complex<float> > expected(NUM_SAMPLES);
+    cphd::scaleSamples(&input[0], elementSize, NUM_SAMPLES, byteSwap,
+                       scaleFactor, &expected[0],
+                       cphd::INSTRUCTION_SET_SCALAR);
+
+    for (int set = cphd::INSTRUCTION_SET_SSE2;
+         set <= cphd::getBestInstructionSet();
+         ++set)
+    {
+        std::vector<std::complex<float> > actual(NUM_SAMPLES);
+        cphd::scaleSamples(&input[0], elementSize, NUM_SAMPLES, byteSwap,
+                           scaleFactor, &actual[0],
+                           static_cast<cphd::InstructionSet>(set));
+        if (!matches(expected, actual))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkSwap(size_t elemSize)
+{
+    const std::vector<sys::ubyte> input =
+            getRandomBytes(NUM_SAMPLES * elemSize, 0);
+    std::vector<sys::ubyte> expected(input);
+    sys::byteSwap(&expected[0], static_cast<unsigned short>(elemSize),
+                  NUM_SAMPLES);
+
+    for (int set = cphd::INSTRUCTION_SET_SCALAR;
+         set <= cphd::getBestInstructionSet();
+         ++set)
+    {
+        std::vector<sys::ubyte> actual(input);
+        cphd::swapBytes(&actual[0], elemSize, NUM_SAMPLES,
+                        static_cast<cphd::InstructionSet>(set));
+        if (actual != expected)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE(testPromote)
+{
+    TEST_ASSERT_TRUE(checkPromote(2, false));
+    TEST_ASSERT_TRUE(checkPromote(2, true));
+    TEST_ASSERT_TRUE(checkPromote(4, false));
+    TEST_ASSERT_TRUE(checkPromote(4, true));
+    TEST_ASSERT_TRUE(checkPromote(8, false));
+    TEST_ASSERT_TRUE(checkPromote(8, true));
+}
+
+TEST_CASE(testScale)
+{
+    TEST_ASSERT_TRUE(checkScale(2, false));
+    TEST_ASSERT_TRUE(checkScale(2, true));
+    TEST_ASSERT_TRUE(checkScale(4, false));
+    TEST_ASSERT_TRUE(checkScale(4, true));
+    TEST_ASSERT_TRUE(checkScale(8, false));
+    TEST_ASSERT_TRUE(checkScale(8, true));
+}
+
+TEST_CASE(testSwap)
+{
+    TEST_ASSERT_TRUE(checkSwap(2));
+    TEST_ASSERT_TRUE(checkSwap(4));
+    TEST_ASSERT_TRUE(checkSwap(8));
+}
+
+TEST_CASE(testKnownValues)
+{
+    // Big endian Int16 (-2, 300)
+    const sys::ubyte input[] = {0xFF, 0xFE, 0x01, 0x2C};
+    std::complex<float> output;
+
+    cphd::promoteSamples(input, 4, 1, true, &output);
+    TEST_ASSERT_EQ(output, std::complex<float>(-2, 300));
+
+    cphd::scaleSamples(input, 4, 1, true, 0.5, &output);
+    TEST_ASSERT_EQ(output, std::complex<float>(-1, 150));
+
+    // Int8 (-2, 1) has nothing to swap
+    cphd::promoteSamples(input + 1, 2, 1, true, &output);
+    TEST_ASSERT_EQ(output, std::complex<float>(-2, 1));
+}
+
+TEST_CASE(testBadElementSize)
+{
+    std::vector<sys::ubyte> input(12);
+    std::complex<float> output[2];
+    TEST_EXCEPTION(cphd::promoteSamples(&input[0], 6, 2, false, output));
+    TEST_EXCEPTION(cphd::scaleSamples(&input[0], 6, 2, false, 1.0, output));
+}
+}
+
+int main(int , char** )
+{
+    TEST_CHECK(testPromote);
+    TEST_CHECK(testScale);
+    TEST_CHECK(testSwap);
+    TEST_CHECK(testKnownValues);
+    TEST_CHECK(testBadElementSize);
+    return 0;
+}
@@ -165,6 +165,61 @@ bool runTest(bool scale, const std::vector<std::complex<T> >& writeData)
     return true;
 }
 
+template<typename T>
+void runPipelinedTest(const std::string& testName,
+                      bool byVectorRange,
+                      const std::vector<std::complex<T> >& writeData)
+{
+    io::TempFile tempfile;
+    const types::RowCol<size_t> dims(128, 128);
+    const std::vector<double> scaleFactors =
+            generateScaleFactors(dims.row, false);
+    cphd::Metadata meta = cphd::Metadata();
+    setUpData(meta, dims, writeData);
+    cphd::setPVPXML(meta.pvp);
+    cphd::PVPBlock pvpBlock(meta.pvp, meta.data);
+    for (size_t ii = 0; ii < dims.row; ++ii)
+    {
+        cphd::setVectorParameters(0, ii, pvpBlock);
+    }
+
+    {
+        // Small scratch buffers so that each write is many chunks
+        auto threadPool = std::make_shared<six::ThreadPool>(2);
+        cphd::CPHDWriter writer(meta, tempfile.pathname(), threadPool,
+                                std::vector<std::string>(), 1024, 3);
+        if (byVectorRange)
+        {
+            std::vector<sys::ubyte> pvpData;
+            pvpBlock.getPVPdata(0, pvpData);
+            const size_t numBytesPVP = meta.data.getNumBytesPVPSet();
+
+            // Write the last vectors first
+            writer.writeMetadata();
+            for (size_t ii = 4; ii > 0; --ii)
+            {
+                const size_t firstVector = (ii - 1) * dims.row / 4;
+                writer.writeCPHDData(&writeData[firstVector * dims.col],
+                                     0, firstVector, dims.row / 4);
+                writer.writePVPData(&pvpData[firstVector * numBytesPVP],
+                                    0, firstVector, dims.row / 4);
+            }
+        }
+        else
+        {
+            writer.writeMetadata(pvpBlock);
+            writer.writePVPData(pvpBlock);
+            writer.writeCPHDData(writeData.data(), dims.area());
+        }
+    }
+
+    cphd::CPHDReader reader(tempfile.pathname(), 1);
+    TEST_ASSERT(reader.getPVPBlock() == pvpBlock);
+    const std::vector<std::complex<float> > readData =
+            checkData(tempfile.pathname(), 1, scaleFactors, dims);
+    TEST_ASSERT(compareVectors(readData, writeData, scaleFactors, false));
+}
+
 TEST_CASE(testUnscaledInt8)
 {
     const types::RowCol<size_t> dims(128, 128);
@@ -218,6 +273,42 @@ TEST_CASE(testScaledFloat)
     const bool scale = true;
     TEST_ASSERT_TRUE(runTest(scale, writeData))
 }
+
+TEST_CASE(testPipelinedWrite)
+{
+    const types::RowCol<size_t> dims(128, 128);
+    const std::vector<std::complex<sys::Int16_T> > writeData =
+            generateData<sys::Int16_T>(dims.area());
+    runPipelinedTest(testName, false, writeData);
+}
+
+TEST_CASE(testWriteByVectorRange)
+{
+    const types::RowCol<size_t> dims(128, 128);
+    const std::vector<std::complex<float> > writeData =
+            generateData<float>(dims.area());
+    runPipelinedTest(testName, true, writeData);
+}
+
+TEST_CASE(testWriteOutOfRange)
+{
+    io::TempFile tempfile;
+    const types::RowCol<size_t> dims(128, 128);
+    const std::vector<std::complex<float> > writeData =
+            generateData<float>(dims.area());
+    cphd::Metadata meta = cphd::Metadata();
+    setUpData(meta, dims, writeData);
+    cphd::setPVPXML(meta.pvp);
+    const std::vector<sys::ubyte> pvpData(
+            (dims.row + 1) * meta.data.getNumBytesPVPSet());
+
+    cphd::CPHDWriter writer(meta, tempfile.pathname());
+    writer.writeMetadata();
+    TEST_EXCEPTION(writer.writePVPData(&pvpData[0], 0, 1, dims.row));
+    TEST_EXCEPTION(writer.writePVPData(&pvpData[0], 1, 0, 1));
+    TEST_EXCEPTION(writer.writeCPHDData(&writeData[0], 0, dims.row, 1));
+    TEST_EXCEPTION(writer.writeCPHDData(&writeData[0], 1, 0, 1));
+}
 }
 
 int main(int argc, char** argv)
@@ -230,6 +321,9 @@ int main(int argc, char** argv)
         TEST_CHECK(testScaledInt16);
         TEST_CHECK(testUnscaledFloat);
         TEST_CHECK(testScaledFloat);
+        TEST_CHECK(testPipelinedWrite);
+        TEST_CHECK(testWriteByVectorRange);
+        TEST_CHECK(testWriteOutOfRange);
         return 0;
     }
     catch (const std::exception& ex)
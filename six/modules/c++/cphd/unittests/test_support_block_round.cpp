@@ -72,7 +72,8 @@ template<typename T>
 void writeSupportData(const std::string& outPathname, size_t numThreads,
         const std::vector<T>& writeData,
         cphd::Metadata& metadata,
-        cphd::PVPBlock& pvpBlock)
+        cphd::PVPBlock& pvpBlock,
+        bool byRow)
 {
     const size_t numChannels = 1;
     // Required but doesn't matter
@@ -87,8 +88,32 @@ void writeSupportData(const std::string& outPathname, size_t numThreads,
     }
     cphd::CPHDWriter writer(metadata, outPathname, std::vector<std::string>(), numThreads);
     writer.writeMetadata(pvpBlock);
-    writer.writeSupportData(writeData.data());
-    writer.writePVPData(pvpBlock);
+    if (byRow)
+    {
+        // Write each array a row at a time, last row first
+        for (auto it = metadata.data.supportArrayMap.begin();
+             it != metadata.data.supportArrayMap.end();
+             ++it)
+        {
+            const T* const array =
+                    writeData.data() + it->second.arrayByteOffset / sizeof(T);
+            for (size_t row = NUM_ROWS; row > 0; --row)
+            {
+                writer.writeSupportData(array + (row - 1) * NUM_COLS,
+                                        it->first,
+                                        row - 1,
+                                        1);
+            }
+        }
+        std::vector<sys::ubyte> pvpData;
+        pvpBlock.getPVPdata(0, pvpData);
+        writer.writePVPData(&pvpData[0], 0, 0, numVectors[0]);
+    }
+    else
+    {
+        writer.writeSupportData(writeData.data());
+        writer.writePVPData(pvpBlock);
+    }
 }
 
 std::vector<sys::ubyte> checkSupportData(
@@ -131,7 +156,7 @@ bool compareVectors(const std::vector<sys::ubyte>& readData,
 }
 
 template<typename T>
-bool runTest(const std::vector<T>& writeData)
+bool runTest(const std::vector<T>& writeData, bool byRow = false)
 {
     io::TempFile tempfile;
     const size_t numThreads = 1;
@@ -140,7 +165,8 @@ bool runTest(const std::vector<T>& writeData)
     setSupport<T>(meta.data);
     cphd::setPVPXML(meta.pvp);
     cphd::PVPBlock pvpBlock(meta.pvp, meta.data);
-    writeSupportData(tempfile.pathname(), numThreads, writeData, meta, pvpBlock);
+    writeSupportData(tempfile.pathname(), numThreads, writeData, meta, pvpBlock,
+                     byRow);
     const std::vector<sys::ubyte> readData =
             checkSupportData(tempfile.pathname(), NUM_SUPPORT*NUM_ROWS*NUM_COLS*sizeof(T), numThreads);
 
@@ -162,6 +188,14 @@ TEST_CASE(testSupportsDouble)
             generateSupportData<double>(NUM_SUPPORT*dims.area());
     TEST_ASSERT_TRUE(runTest(writeData));
 }
+
+TEST_CASE(testSupportsByRow)
+{
+    const types::RowCol<size_t> dims(NUM_ROWS, NUM_COLS);
+    const std::vector<double> writeData =
+            generateSupportData<double>(NUM_SUPPORT*dims.area());
+    TEST_ASSERT_TRUE(runTest(writeData, true));
+}
 }
 
 int main(int argc, char** argv)
@@ -170,6 +204,7 @@ int main(int argc, char** argv)
     {
         TEST_CHECK(testSupportsInt);
         TEST_CHECK(testSupportsDouble);
+        TEST_CHECK(testSupportsByRow);
         return 0;
     }
     catch (const std::exception& ex)
@@ -23,6 +23,7 @@
 #include <io/StringStream.h>
 #include <logging/NullLogger.h>
 #include <six/Utilities.h>
+#include <six/XMLControlFactory.h>
 #include <cphd03/CPHDXMLControl.h>
 
 // CPHD Spec is not enforced
@@ -62,10 +63,9 @@ std::string CPHDXMLControl::getSICommonURI() const
 std::string CPHDXMLControl::toXMLString(const Metadata& metadata)
 {
     std::auto_ptr<xml::lite::Document> doc(toXML(metadata));
-    io::StringStream ss;
-    doc->getRootElement()->print(ss);
-
-    return (std::string("<?xml version=\"1.0\"?>") + ss.stream().str());
+    std::string xml("<?xml version=\"1.0\"?>");
+    six::appendXML(*doc->getRootElement(), xml);
+    return xml;
 }
 
 size_t CPHDXMLControl::getXMLsize(const Metadata& metadata)
@@ -89,7 +89,21 @@ public:
                                 const types::RowCol<double>& imageGridPoint,
                                 double* r,
                                 double* rDot) const = 0;
-        
+
+    /*!
+     *  Compute the R/Rdot contours for a block of image grid points, as
+     *  computeContour() does for each one.  Sub-classes can override this
+     *  so that the batch projections make one virtual call per block
+     *  rather than one per point.
+     */
+    virtual void computeContours(const Vector3* arpCOA,
+                                 const Vector3* velCOA,
+                                 const double* timeCOA,
+                                 const types::RowCol<double>* imageGridPoints,
+                                 size_t numPoints,
+                                 double* r,
+                                 double* rDot) const;
+
     /*!
      *  Calculations for section 5.2 in SICD Image Projections:
      *  R/Rdot Contour Ground Plane Intersection
@@ -204,6 +218,79 @@ public:
                          double heightThreshold = 1.0,
                          size_t maxNumIters = 3) const;
 
+    /*!
+     *  Batch version of sceneToImage().  The points are projected a block
+     *  at a time, one step of the projection for the whole block before
+     *  the next, and blocks may be split across multiple threads.  Each
+     *  result is identical to projecting that point by itself.
+     *
+     *  \param scenePoints Scene (ground) points in 3-space
+     *  \param numPoints Number of points to project
+     *  \param[out] imageGridPoints Continuous surface image point of each
+     *  scene point.  Must hold numPoints points.
+     *  \param delta Delta values to apply for the adjustable parameters
+     *  \param numThreads Number of threads to use
+     *  \param[out] oTimeCOA Optional timeCOA of each point.  If this isn't
+     *  NULL, it must hold numPoints values.
+     *
+     *  \throws except::Exception If any point fails to converge
+     */
+    void sceneToImage(const Vector3* scenePoints,
+                      size_t numPoints,
+                      types::RowCol<double>* imageGridPoints,
+                      const AdjustableParams& delta = AdjustableParams(),
+                      size_t numThreads = 1,
+                      double* oTimeCOA = NULL) const;
+
+    /*!
+     *  Batch version of the ground plane imageToScene().  Each result is
+     *  identical to projecting that point by itself.
+     *
+     *  \param imageGridPoints Points in the image surface (continuous)
+     *  \param numPoints Number of points to project
+     *  \param groundRefPoint A ground plane reference point
+     *  \param groundPlaneNormal The ground plane normal
+     *  \param[out] scenePoints Scene (ground) point of each image point.
+     *  Must hold numPoints points.
+     *  \param delta Delta values to apply for the adjustable parameters
+     *  \param numThreads Number of threads to use
+     *  \param[out] oTimeCOA Optional timeCOA of each point.  If this isn't
+     *  NULL, it must hold numPoints values.
+     */
+    void imageToScene(const types::RowCol<double>* imageGridPoints,
+                      size_t numPoints,
+                      const Vector3& groundRefPoint,
+                      const Vector3& groundPlaneNormal,
+                      Vector3* scenePoints,
+                      const AdjustableParams& delta = AdjustableParams(),
+                      size_t numThreads = 1,
+                      double* oTimeCOA = NULL) const;
+
+    /*!
+     *  Batch version of the constant height imageToScene().  Each result
+     *  is identical to projecting that point by itself.
+     *
+     *  \param imageGridPoints Points (meters) in the image surface
+     *  (continuous)
+     *  \param numPoints Number of points to project
+     *  \param height Surface height (meters) above the WGS-84 reference
+     *  ellipsoid
+     *  \param[out] scenePoints Scene (ground) point of each image point.
+     *  Must hold numPoints points.
+     *  \param delta Delta values to apply for the adjustable parameters
+     *  \param numThreads Number of threads to use
+     *  \param heightThreshold Height threshold (meters) for convergence
+     *  \param maxNumIters Maximum number of iterations to perform
+     */
+    void imageToScene(const types::RowCol<double>* imageGridPoints,
+                      size_t numPoints,
+                      double height,
+                      Vector3* scenePoints,
+                      const AdjustableParams& delta = AdjustableParams(),
+                      size_t numThreads = 1,
+                      double heightThreshold = 1.0,
+                      size_t maxNumIters = 3) const;
+
     math::linear::MatrixMxN<2, 2> slantToImagePartials(
             const types::RowCol<double>& imageGridPoint,
             double delta = 0.0001) const;
@@ -351,6 +438,67 @@ protected:
                                 Vector3& arpCOA,
                                 Vector3& velCOA) const;
 
+private:
+    // Points are projected in blocks of this many
+    enum { BLOCK_SIZE = 256 };
+
+    class SceneToImageBlocks;
+    class ImageToSceneBlocks;
+    class ImageToHeightBlocks;
+
+    // Evaluates the polynomials, contours and adjustments of imageToScene()
+    // for each point, one step at a time
+    void computeAdjustedContours(const types::RowCol<double>* imageGridPoints,
+                                 size_t numPoints,
+                                 const AdjustableParams& delta,
+                                 double* timeCOA,
+                                 Vector3* arpCOA,
+                                 Vector3* velCOA,
+                                 double* r,
+                                 double* rDot) const;
+
+    // At most BLOCK_SIZE points
+    void sceneToImageBlock(const Vector3* scenePoints,
+                           size_t numPoints,
+                           types::RowCol<double>* imageGridPoints,
+                           const AdjustableParams& delta,
+                           double* oTimeCOA) const;
+
+    void imageToSceneBlock(const types::RowCol<double>* imageGridPoints,
+                           size_t numPoints,
+                           const Vector3& groundRefPoint,
+                           const Vector3& groundPlaneNormal,
+                           Vector3* scenePoints,
+                           const AdjustableParams& delta,
+                           double* oTimeCOA) const;
+
+    // The geodetic ground plane at the given height below the SCP, where
+    // the constant height projection starts
+    void getHeightGroundPlane(double height,
+                              Vector3& groundRefPoint,
+                              Vector3& groundPlaneNormal) const;
+
+    // Steps 2 - 7 of the constant height imageToScene()
+    Vector3 contourToHeight(double r,
+                            double rDot,
+                            const Vector3& arpCOA,
+                            const Vector3& velCOA,
+                            double height,
+                            Vector3 groundRefPoint,
+                            Vector3 groundPlaneNormal,
+                            double heightThreshold,
+                            size_t maxNumIters) const;
+
+    void imageToHeightBlock(const types::RowCol<double>* imageGridPoints,
+                            size_t numPoints,
+                            double height,
+                            const Vector3& groundRefPoint,
+                            const Vector3& groundPlaneNormal,
+                            Vector3* scenePoints,
+                            const AdjustableParams& delta,
+                            double heightThreshold,
+                            size_t maxNumIters) const;
+
 protected:
     Vector3 mSlantPlaneNormal;
     Vector3 mImagePlaneNormal;
@@ -410,6 +558,14 @@ public:
                                 double* r,
                                 double* rDot) const;
 
+    virtual void computeContours(const Vector3* arpCOA,
+                                 const Vector3* velCOA,
+                                 const double* timeCOA,
+                                 const types::RowCol<double>* imageGridPoints,
+                                 size_t numPoints,
+                                 double* r,
+                                 double* rDot) const;
+
 private:
     math::poly::OneD<double> mPolarAnglePoly;
     math::poly::OneD<double> mPolarAnglePolyPrime;
@@ -463,6 +619,14 @@ public:
                                 const types::RowCol<double>& imageGridPoint,
                                 double* r,
                                 double* rDot) const;
+
+    virtual void computeContours(const Vector3* arpCOA,
+                                 const Vector3* velCOA,
+                                 const double* timeCOA,
+                                 const types::RowCol<double>* imageGridPoints,
+                                 size_t numPoints,
+                                 double* r,
+                                 double* rDot) const;
 };
 
 typedef PlaneProjectionModel XRGYCRProjectionModel;
@@ -20,9 +20,12 @@
  *
  */
 
+#include <algorithm>
 #include <limits>
 
+#include <math/Round.h>
 #include <math/Utilities.h>
+#include <mt/Runnable1D.h>
 #include "scene/ProjectionModel.h"
 #include "scene/ECEFToLLATransform.h"
 #include "scene/Utilities.h"
@@ -33,6 +36,18 @@ const double EARTH_ROTATION_RATE = 0.000072921150; // Radians / sec
 
 const double DELTA_GP_MAX = 0.0000001;
 
+bool isZero(const scene::AdjustableParams& params)
+{
+    for (size_t ii = 0; ii < scene::AdjustableParams::NUM_PARAMS; ++ii)
+    {
+        if (params.mParams[ii] != 0.0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 // TODO: Should this be a static method instead?
 scene::Vector3 computeUnitVector(const scene::LatLonAlt& latLon)
 {
@@ -155,57 +170,315 @@ ProjectionModel::contourToGroundPlane(double rCOA, double rDotCOA,
 }
 
 
+class ProjectionModel::SceneToImageBlocks
+{
+public:
+    SceneToImageBlocks(const ProjectionModel& model,
+                       const Vector3* scenePoints,
+                       size_t numPoints,
+                       types::RowCol<double>* imageGridPoints,
+                       const AdjustableParams& delta,
+                       double* oTimeCOA) :
+        mModel(model),
+        mScenePoints(scenePoints),
+        mNumPoints(numPoints),
+        mImageGridPoints(imageGridPoints),
+        mDelta(delta),
+        mTimeCOA(oTimeCOA)
+    {
+    }
+
+    void operator()(size_t block) const
+    {
+        const size_t first = block * BLOCK_SIZE;
+        mModel.sceneToImageBlock(mScenePoints + first,
+                                 std::min<size_t>(BLOCK_SIZE,
+                                                  mNumPoints - first),
+                                 mImageGridPoints + first,
+                                 mDelta,
+                                 mTimeCOA ? mTimeCOA + first : NULL);
+    }
+
+private:
+    const ProjectionModel& mModel;
+    const Vector3* const mScenePoints;
+    const size_t mNumPoints;
+    types::RowCol<double>* const mImageGridPoints;
+    const AdjustableParams& mDelta;
+    double* const mTimeCOA;
+};
+
+class ProjectionModel::ImageToSceneBlocks
+{
+public:
+    ImageToSceneBlocks(const ProjectionModel& model,
+                       const types::RowCol<double>* imageGridPoints,
+                       size_t numPoints,
+                       const Vector3& groundRefPoint,
+                       const Vector3& groundPlaneNormal,
+                       Vector3* scenePoints,
+                       const AdjustableParams& delta,
+                       double* oTimeCOA) :
+        mModel(model),
+        mImageGridPoints(imageGridPoints),
+        mNumPoints(numPoints),
+        mGroundRefPoint(groundRefPoint),
+        mGroundPlaneNormal(groundPlaneNormal),
+        mScenePoints(scenePoints),
+        mDelta(delta),
+        mTimeCOA(oTimeCOA)
+    {
+    }
+
+    void operator()(size_t block) const
+    {
+        const size_t first = block * BLOCK_SIZE;
+        mModel.imageToSceneBlock(mImageGridPoints + first,
+                                 std::min<size_t>(BLOCK_SIZE,
+                                                  mNumPoints - first),
+                                 mGroundRefPoint,
+                                 mGroundPlaneNormal,
+                                 mScenePoints + first,
+                                 mDelta,
+                                 mTimeCOA ? mTimeCOA + first : NULL);
+    }
+
+private:
+    const ProjectionModel& mModel;
+    const types::RowCol<double>* const mImageGridPoints;
+    const size_t mNumPoints;
+    const Vector3& mGroundRefPoint;
+    const Vector3& mGroundPlaneNormal;
+    Vector3* const mScenePoints;
+    const AdjustableParams& mDelta;
+    double* const mTimeCOA;
+};
+
+class ProjectionModel::ImageToHeightBlocks
+{
+public:
+    ImageToHeightBlocks(const ProjectionModel& model,
+                        const types::RowCol<double>* imageGridPoints,
+                        size_t numPoints,
+                        double height,
+                        const Vector3& groundRefPoint,
+                        const Vector3& groundPlaneNormal,
+                        Vector3* scenePoints,
+                        const AdjustableParams& delta,
+                        double heightThreshold,
+                        size_t maxNumIters) :
+        mModel(model),
+        mImageGridPoints(imageGridPoints),
+        mNumPoints(numPoints),
+        mHeight(height),
+        mGroundRefPoint(groundRefPoint),
+        mGroundPlaneNormal(groundPlaneNormal),
+        mScenePoints(scenePoints),
+        mDelta(delta),
+        mHeightThreshold(heightThreshold),
+        mMaxNumIters(maxNumIters)
+    {
+    }
+
+    void operator()(size_t block) const
+    {
+        const size_t first = block * BLOCK_SIZE;
+        mModel.imageToHeightBlock(mImageGridPoints + first,
+                                  std::min<size_t>(BLOCK_SIZE,
+                                                   mNumPoints - first),
+                                  mHeight,
+                                  mGroundRefPoint,
+                                  mGroundPlaneNormal,
+                                  mScenePoints + first,
+                                  mDelta,
+                                  mHeightThreshold,
+                                  mMaxNumIters);
+    }
+
+private:
+    const ProjectionModel& mModel;
+    const types::RowCol<double>* const mImageGridPoints;
+    const size_t mNumPoints;
+    const double mHeight;
+    const Vector3& mGroundRefPoint;
+    const Vector3& mGroundPlaneNormal;
+    Vector3* const mScenePoints;
+    const AdjustableParams& mDelta;
+    const double mHeightThreshold;
+    const size_t mMaxNumIters;
+};
+
+void ProjectionModel::computeContours(
+        const Vector3* arpCOA,
+        const Vector3* velCOA,
+        const double* timeCOA,
+        const types::RowCol<double>* imageGridPoints,
+        size_t numPoints,
+        double* r,
+        double* rDot) const
+{
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+        computeContour(arpCOA[ii], velCOA[ii], timeCOA[ii],
+                       imageGridPoints[ii],
+                       &r[ii],
+                       &rDot[ii]);
+    }
+}
+
+void ProjectionModel::computeAdjustedContours(
+        const types::RowCol<double>* imageGridPoints,
+        size_t numPoints,
+        const AdjustableParams& delta,
+        double* timeCOA,
+        Vector3* arpCOA,
+        Vector3* velCOA,
+        double* r,
+        double* rDot) const
+{
+    // Compute the timeCOA
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+        timeCOA[ii] = mTimeCOAPoly(imageGridPoints[ii].row,
+                                   imageGridPoints[ii].col);
+    }
+
+    // Compute ARP position and velocity
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+        arpCOA[ii] = mARPPoly(timeCOA[ii]);
+        velCOA[ii] = mARPVelPoly(timeCOA[ii]);
+    }
+
+    computeContours(arpCOA, velCOA, timeCOA, imageGridPoints, numPoints,
+                    r, rDot);
+
+    // Adjustable parameters are applied after computing R/Rdot contours
+    // Adjustable parameters do not affect Rdot
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+        imageToSceneAdjustment(delta, timeCOA[ii], r[ii],
+                               arpCOA[ii], velCOA[ii]);
+    }
+}
+
 types::RowCol<double>
 ProjectionModel::sceneToImage(const Vector3& scenePoint,
                               const AdjustableParams& delta,
                               double* oTimeCOA) const
 {
-    // For scenePoint, we will compute the spherical earth
+    types::RowCol<double> imageGridPoint;
+    sceneToImageBlock(&scenePoint, 1, &imageGridPoint, delta, oTimeCOA);
+    return imageGridPoint;
+}
+
+void ProjectionModel::sceneToImage(const Vector3* scenePoints,
+                                   size_t numPoints,
+                                   types::RowCol<double>* imageGridPoints,
+                                   const AdjustableParams& delta,
+                                   size_t numThreads,
+                                   double* oTimeCOA) const
+{
+    const size_t numBlocks = math::ceilingDivide(numPoints, BLOCK_SIZE);
+    mt::run1D(numBlocks, numThreads,
+              SceneToImageBlocks(*this, scenePoints, numPoints,
+                                 imageGridPoints, delta, oTimeCOA));
+}
+
+void ProjectionModel::sceneToImageBlock(
+        const Vector3* scenePoints,
+        size_t numPoints,
+        types::RowCol<double>* imageGridPoints,
+        const AdjustableParams& delta,
+        double* oTimeCOA) const
+{
+    // For each scenePoint, we will compute the spherical earth
     // unit ground plane normal (uGPN)
-    Vector3 groundRefPoint(scenePoint);
-    Vector3 groundPlaneNormal(groundRefPoint);
-    groundPlaneNormal.normalize();
+    Vector3 groundPlaneNormal[BLOCK_SIZE];
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+        groundPlaneNormal[ii] = scenePoints[ii];
+        groundPlaneNormal[ii].normalize();
+    }
 
     // Set initial ground plane position to the scenePoint
-    Vector3 groundPlanePoint(scenePoint);
+    Vector3 groundPlanePoint[BLOCK_SIZE];
+    std::copy(scenePoints, scenePoints + numPoints, groundPlanePoint);
 
-    for (size_t i = 0; i < MAX_ITER; ++i)
+    // Points that haven't converged yet
+    size_t active[BLOCK_SIZE];
+    size_t numActive = numPoints;
+    for (size_t ii = 0; ii < numPoints; ++ii)
     {
+        active[ii] = ii;
+    }
 
-        // We are projecting the ground plane point to the image
-        // plane point.
-        Vector3 diff(mSCP - groundPlanePoint);
-
-        // Dist contains the projection difference
-        double dist = diff.dot(mImagePlaneNormal) * mScaleFactor;
+    types::RowCol<double> imageGridPoint[BLOCK_SIZE];
+    double timeCOA[BLOCK_SIZE];
+    Vector3 arpCOA[BLOCK_SIZE];
+    Vector3 velCOA[BLOCK_SIZE];
+    double r[BLOCK_SIZE];
+    double rDot[BLOCK_SIZE];
 
-        Vector3 imagePlanePoint =
-            groundPlanePoint + mSlantPlaneNormal * dist;
+    for (size_t i = 0; i < MAX_ITER && numActive > 0; ++i)
+    {
+        for (size_t jj = 0; jj < numActive; ++jj)
+        {
+            const size_t ii = active[jj];
 
-        // Compute the imageCoordinates for the plane point
-        types::RowCol<double> imageGridPoint =
-            computeImageCoordinates(imagePlanePoint);
+            // We are projecting the ground plane point to the image
+            // plane point.
+            const Vector3 diff(mSCP - groundPlanePoint[ii]);
 
-        // Find out if scene point is the same as the guessed output
-        // of imageToScene
-        diff = scenePoint - imageToScene(imageGridPoint,
-                                         groundRefPoint,
-                                         groundPlaneNormal,
-                                         delta,
-                                         oTimeCOA);
+            // Dist contains the projection difference
+            const double dist = diff.dot(mImagePlaneNormal) * mScaleFactor;
 
-        dist = diff.norm();
+            const Vector3 imagePlanePoint =
+                groundPlanePoint[ii] + mSlantPlaneNormal * dist;
 
-        if (dist < DELTA_GP_MAX)
-            return imageGridPoint;
+            // Compute the imageCoordinates for the plane point
+            imageGridPoint[jj] = computeImageCoordinates(imagePlanePoint);
+        }
 
-        // Otherwise we are not so lucky, add to our point
-        // the difference
-        groundPlanePoint += diff;
+        computeAdjustedContours(imageGridPoint, numActive, delta,
+                                timeCOA, arpCOA, velCOA, r, rDot);
 
+        size_t numStillActive = 0;
+        for (size_t jj = 0; jj < numActive; ++jj)
+        {
+            const size_t ii = active[jj];
+
+            // Find out if scene point is the same as the guessed output
+            // of imageToScene
+            const Vector3 diff = scenePoints[ii] -
+                    contourToGroundPlane(r[jj], rDot[jj],
+                                         arpCOA[jj], velCOA[jj],
+                                         groundPlaneNormal[ii],
+                                         scenePoints[ii]);
+
+            if (diff.norm() < DELTA_GP_MAX)
+            {
+                imageGridPoints[ii] = imageGridPoint[jj];
+                if (oTimeCOA != NULL)
+                {
+                    oTimeCOA[ii] = timeCOA[jj];
+                }
+            }
+            else
+            {
+                // Otherwise we are not so lucky, add to our point
+                // the difference
+                groundPlanePoint[ii] += diff;
+                active[numStillActive++] = ii;
+            }
+        }
+        numActive = numStillActive;
     }
 
-    throw except::Exception(Ctxt("Point failed to converge"));
+    if (numActive > 0)
+    {
+        throw except::Exception(Ctxt("Point failed to converge"));
+    }
 }
 
 Vector3
@@ -215,38 +488,59 @@ ProjectionModel::imageToScene(const types::RowCol<double>& imageGridPoint,
                               const AdjustableParams& delta,
                               double *oTimeCOA) const
 {
+    Vector3 scenePoint;
+    imageToSceneBlock(&imageGridPoint, 1,
+                      groundRefPoint, groundPlaneNormal,
+                      &scenePoint, delta, oTimeCOA);
+    return scenePoint;
+}
 
-    // Compute the timeCOA
-    const double timeCOA = mTimeCOAPoly(imageGridPoint.row,
-                                        imageGridPoint.col);
+void ProjectionModel::imageToScene(
+        const types::RowCol<double>* imageGridPoints,
+        size_t numPoints,
+        const Vector3& groundRefPoint,
+        const Vector3& groundPlaneNormal,
+        Vector3* scenePoints,
+        const AdjustableParams& delta,
+        size_t numThreads,
+        double* oTimeCOA) const
+{
+    const size_t numBlocks = math::ceilingDivide(numPoints, BLOCK_SIZE);
+    mt::run1D(numBlocks, numThreads,
+              ImageToSceneBlocks(*this, imageGridPoints, numPoints,
+                                 groundRefPoint, groundPlaneNormal,
+                                 scenePoints, delta, oTimeCOA));
+}
+
+void ProjectionModel::imageToSceneBlock(
+        const types::RowCol<double>* imageGridPoints,
+        size_t numPoints,
+        const Vector3& groundRefPoint,
+        const Vector3& groundPlaneNormal,
+        Vector3* scenePoints,
+        const AdjustableParams& delta,
+        double* oTimeCOA) const
+{
+    double timeCOA[BLOCK_SIZE];
+    Vector3 arpCOA[BLOCK_SIZE];
+    Vector3 velCOA[BLOCK_SIZE];
+    double r[BLOCK_SIZE];
+    double rDot[BLOCK_SIZE];
+    computeAdjustedContours(imageGridPoints, numPoints, delta,
+                            timeCOA, arpCOA, velCOA, r, rDot);
 
     if (oTimeCOA != NULL)
     {
-        *oTimeCOA = timeCOA;
+        std::copy(timeCOA, timeCOA + numPoints, oTimeCOA);
     }
 
-    // Compute ARP position
-    Vector3 arpCOA = mARPPoly(timeCOA);
-
-    // Compute ARP velocity
-    Vector3 velCOA = mARPVelPoly(timeCOA);
-
-    double r;
-    double rDot;
-
-    computeContour(arpCOA, velCOA, timeCOA,
-                   imageGridPoint,
-                   &r,
-                   &rDot);
-
-    // Adjustable parameters are applied after computing R/Rdot contours
-    // Adjustable parameters do not affect Rdot
-    imageToSceneAdjustment(delta, timeCOA, r, arpCOA, velCOA);
-
-    return contourToGroundPlane(r, rDot,
-                                arpCOA, velCOA,
-                                groundPlaneNormal,
-                                groundRefPoint);
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+        scenePoints[ii] = contourToGroundPlane(r[ii], rDot[ii],
+                                               arpCOA[ii], velCOA[ii],
+                                               groundPlaneNormal,
+                                               groundRefPoint);
+    }
 }
 
 Vector3 ProjectionModel::imageToScene(
@@ -255,6 +549,22 @@ Vector3 ProjectionModel::imageToScene(
         const AdjustableParams& delta,
         double heightThreshold,
         size_t maxNumIters) const
+{
+    Vector3 scenePoint;
+    imageToScene(&imageGridPoint, 1, height, &scenePoint, delta, 1,
+                 heightThreshold, maxNumIters);
+    return scenePoint;
+}
+
+void ProjectionModel::imageToScene(
+        const types::RowCol<double>* imageGridPoints,
+        size_t numPoints,
+        double height,
+        Vector3* scenePoints,
+        const AdjustableParams& delta,
+        size_t numThreads,
+        double heightThreshold,
+        size_t maxNumIters) const
 {
     // Sanity checks
     if (heightThreshold <= 0)
@@ -268,30 +578,78 @@ Vector3 ProjectionModel::imageToScene(
                 "Max number of iterations must be positive"));
     }
 
+    // This is the same for every point
+    Vector3 groundRefPoint;
+    Vector3 groundPlaneNormal;
+    getHeightGroundPlane(height, groundRefPoint, groundPlaneNormal);
+
+    const size_t numBlocks = math::ceilingDivide(numPoints, BLOCK_SIZE);
+    mt::run1D(numBlocks, numThreads,
+              ImageToHeightBlocks(*this, imageGridPoints, numPoints,
+                                  height, groundRefPoint, groundPlaneNormal,
+                                  scenePoints, delta,
+                                  heightThreshold, maxNumIters));
+}
+
+void ProjectionModel::getHeightGroundPlane(double height,
+                                           Vector3& groundRefPoint,
+                                           Vector3& groundPlaneNormal) const
+{
     // 1. Compute the geodetic ground plane normal at the SCP
     //    Note that this is different than the value passed in to the other
     //    imageToScene() overloading which is the spherical earth GPN (see
     //    section 5.1 for details)
     const ECEFToLLATransform ecefToLatLon;
     const LatLonAlt scpLatLon = ecefToLatLon.transform(mSCP);
-    Vector3 groundPlaneNormal = computeUnitVector(scpLatLon);
+    groundPlaneNormal = computeUnitVector(scpLatLon);
 
-    Vector3 groundRefPoint =
+    groundRefPoint =
             mSCP + (height - scpLatLon.getAlt()) * groundPlaneNormal;
+}
 
+void ProjectionModel::imageToHeightBlock(
+        const types::RowCol<double>* imageGridPoints,
+        size_t numPoints,
+        double height,
+        const Vector3& groundRefPoint,
+        const Vector3& groundPlaneNormal,
+        Vector3* scenePoints,
+        const AdjustableParams& delta,
+        double heightThreshold,
+        size_t maxNumIters) const
+{
     // Compute contour just once
-    double r;
-    double rDot;
-    const double timeCOA = mTimeCOAPoly(imageGridPoint.row,
-                                        imageGridPoint.col);
-    Vector3 arpCOA = mARPPoly(timeCOA);
-    Vector3 velCOA = mARPVelPoly(timeCOA);
-    computeContour(arpCOA, velCOA, timeCOA, imageGridPoint, &r, &rDot);
-
-    // Adjustable parameters are applied after computing R/Rdot contours
-    // Adjustable parameters do not affect Rdot
-    imageToSceneAdjustment(delta, timeCOA, r, arpCOA, velCOA);
+    double timeCOA[BLOCK_SIZE];
+    Vector3 arpCOA[BLOCK_SIZE];
+    Vector3 velCOA[BLOCK_SIZE];
+    double r[BLOCK_SIZE];
+    double rDot[BLOCK_SIZE];
+    computeAdjustedContours(imageGridPoints, numPoints, delta,
+                            timeCOA, arpCOA, velCOA, r, rDot);
+
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+        scenePoints[ii] = contourToHeight(r[ii], rDot[ii],
+                                          arpCOA[ii], velCOA[ii],
+                                          height,
+                                          groundRefPoint,
+                                          groundPlaneNormal,
+                                          heightThreshold,
+                                          maxNumIters);
+    }
+}
 
+Vector3 ProjectionModel::contourToHeight(double r,
+                                         double rDot,
+                                         const Vector3& arpCOA,
+                                         const Vector3& velCOA,
+                                         double height,
+                                         Vector3 groundRefPoint,
+                                         Vector3 groundPlaneNormal,
+                                         double heightThreshold,
+                                         size_t maxNumIters) const
+{
+    const ECEFToLLATransform ecefToLatLon;
     Vector3 gppECEF;
     Vector3 uUP;
     double deltaHeight(std::numeric_limits<double>::max());
@@ -363,6 +721,22 @@ void ProjectionModel::imageToSceneAdjustment(const AdjustableParams& delta,
                                              Vector3& arpCOA,
                                              Vector3& velCOA) const
 {
+    // An undefined frame is an error even when there's nothing to add
+    if (mErrors.mFrameType != FrameType::RIC_ECF &&
+        mErrors.mFrameType != FrameType::RIC_ECI &&
+        mErrors.mFrameType != FrameType::ECF)
+    {
+        throw except::Exception(Ctxt(
+                "Reference Frame for error parameters undefined"));
+    }
+
+    // With no adjustments, there's nothing to add, so skip evaluating the
+    // RIC transform
+    if (isZero(mAdjustableParams) && isZero(delta))
+    {
+        return;
+    }
+
     // Now Add adjustable parameters to ARP and ARP-Velocity
     // Adjustable parameters are in RIC, but ARP and ARP-Velocity are in ECEF
     // Therefore, we need to convert RIC to ECEF before proceeding
@@ -850,6 +1224,24 @@ computeContour(const Vector3& arpCOA,
 
 }
 
+void RangeAzimProjectionModel::
+computeContours(const Vector3* arpCOA,
+                const Vector3* velCOA,
+                const double* timeCOA,
+                const types::RowCol<double>* imageGridPoints,
+                size_t numPoints,
+                double* r,
+                double* rDot) const
+{
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+        RangeAzimProjectionModel::computeContour(arpCOA[ii], velCOA[ii],
+                                                 timeCOA[ii],
+                                                 imageGridPoints[ii],
+                                                 &r[ii], &rDot[ii]);
+    }
+}
+
 
 RangeZeroProjectionModel::
 RangeZeroProjectionModel(const math::poly::OneD<double>& timeCAPoly,
@@ -939,6 +1331,28 @@ computeContour(const Vector3& arpCOA,
     *rDot = velCOA.dot(vec) / *r;
 }
 
+void PlaneProjectionModel::
+computeContours(const Vector3* arpCOA,
+                const Vector3* velCOA,
+                const double* /*timeCOA*/,
+                const types::RowCol<double>* imageGridPoints,
+                size_t numPoints,
+                double* r,
+                double* rDot) const
+{
+    // Same as computeContour(), without a virtual imageGridToECEF() call
+    // per point
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+        const Vector3 vec = arpCOA[ii] -
+                ProjectionModelWithImageVectors::imageGridToECEF(
+                        imageGridPoints[ii]);
+        r[ii] = vec.norm();
+
+        rDot[ii] = velCOA[ii].dot(vec) / r[ii];
+    }
+}
+
 GeodeticProjectionModel::GeodeticProjectionModel(
         const Vector3& slantPlaneNormal,
         const Vector3& scp,
@@ -24,11 +24,13 @@
 
 #include <import/six.h>
 
+#include "six/sicd/AmplitudePhaseLUT.h"
 #include "six/sicd/Antenna.h"
 #include "six/sicd/AreaPlaneUtility.h"
 #include "six/sicd/ComplexData.h"
 #include "six/sicd/ComplexDataBuilder.h"
 #include "six/sicd/ComplexXMLControl.h"
+#include "six/sicd/ComplexXMLStreamHandler.h"
 #include "six/sicd/CropUtils.h"
 #include "six/sicd/Functor.h"
 #include "six/sicd/GeoData.h"
@@ -40,6 +42,7 @@
 #include "six/sicd/RadarCollection.h"
 #include "six/sicd/RgAzComp.h"
 #include "six/sicd/SICDMesh.h"
+#include "six/sicd/SICDReader.h"
 #include "six/sicd/SCPCOA.h"
 #include "six/sicd/Utilities.h"
 
@@ -0,0 +1,96 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_SICD_AMPLITUDE_PHASE_LUT_H__
+#define __SIX_SICD_AMPLITUDE_PHASE_LUT_H__
+
+#include <complex>
+#include <vector>
+
+#include <mem/SharedPtr.h>
+#include <sys/Conf.h>
+#include <six/Types.h>
+
+namespace six
+{
+namespace sicd
+{
+/*!
+ *  \class AmplitudePhaseLUT
+ *  \brief Complex value of every possible AMP8I_PHS8I pixel
+ *
+ *  Each AMP8I_PHS8I pixel is an 8-bit amplitude followed by an 8-bit
+ *  phase.  The amplitude is either used directly or, if the SICD has an
+ *  AmpTable, is an index into it.  The phase is in units of 1/256 cycles.
+ *  Since there are only 256 x 256 possible pixels, every one of them is
+ *  computed once up front, and conversion is a table lookup.
+ */
+class AmplitudePhaseLUT
+{
+public:
+    static const size_t NUM_VALUES = 256;
+
+    /*!
+     *  Compute the table
+     *
+     *  \param amplitudeTable SICD AmpTable, or NULL if the amplitudes are
+     *  to be used directly
+     */
+    explicit AmplitudePhaseLUT(const AmplitudeTable* amplitudeTable);
+
+    /*!
+     *  Get a table, reusing a previously computed one for the same
+     *  amplitudes if possible.  A handful of the most recently used tables
+     *  are kept.
+     *
+     *  \param amplitudeTable SICD AmpTable, or NULL if the amplitudes are
+     *  to be used directly
+     *
+     *  \return The table.  This is safe to use from multiple threads.
+     */
+    static mem::SharedPtr<const AmplitudePhaseLUT>
+    get(const AmplitudeTable* amplitudeTable);
+
+    //! \return The complex value of a pixel
+    const std::complex<float>& operator()(sys::ubyte amplitude,
+                                          sys::ubyte phase) const
+    {
+        return mTable[amplitude * NUM_VALUES + phase];
+    }
+
+    /*!
+     *  Convert AMP8I_PHS8I pixels
+     *
+     *  \param input Interleaved amplitude and phase bytes of each pixel
+     *  \param numPixels Number of pixels to convert
+     *  \param[out] output Complex value of each pixel
+     */
+    void convert(const sys::ubyte* input,
+                 size_t numPixels,
+                 std::complex<float>* output) const;
+
+private:
+    std::vector<std::complex<float> > mTable;
+};
+}
+}
+
+#endif
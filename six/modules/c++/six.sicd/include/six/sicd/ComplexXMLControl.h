@@ -63,6 +63,15 @@ protected:
      */
     virtual xml::lite::Document* toXMLImpl(const Data* data);
 
+    /*!
+     *  This function takes in a ComplexData object and writes its XML
+     *  onto the end of xml, without building a DOM.
+     *
+     *  \param data A ComplexData object
+     *  \param[in,out] xml The XML is appended to this
+     */
+    virtual void toXMLImpl(const Data* data, std::string& xml);
+
     /*!
      *  Function takes a DOM Document* node and creates a new-allocated
      *  ComplexData* populated by the DOM.  
@@ -71,7 +80,12 @@ protected:
      */
     virtual Data* fromXMLImpl(const xml::lite::Document* doc);
 
-private:
+public:
+    /*!
+     *  \param version SICD version, e.g. "1.2.1"
+     *  \return The parser for that version.  Throws if the version isn't
+     *  supported.
+     */
     std::auto_ptr<ComplexXMLParser>
     getParser(const std::string& version) const;
 };
@@ -44,8 +44,34 @@ public:
 
     xml::lite::Document* toXML(const ComplexData* data) const;
 
+    /*!
+     *  Write the SICD XML for data onto the end of xml.  This is the same
+     *  XML as printing the Document that toXML() returns, but each element
+     *  is written as soon as it's complete, so the Document is never built.
+     *  If the data can't be converted, xml is left as it was.
+     *
+     *  \param data The data to convert
+     *  \param[in,out] xml The XML is appended to this
+     */
+    void toXML(const ComplexData* data, std::string& xml);
+
+    virtual void setStreamWriter(XMLStreamWriter* writer);
+
     ComplexData* fromXML(const xml::lite::Document* doc) const;
 
+    /*!
+     *  Parse one of the elements directly under the SICD root element into
+     *  sicd.  This lets a ComplexData be filled in one element at a time
+     *  as the XML is read, rather than from a complete document.  The
+     *  RadarCollection must be parsed before the ImageFormation.  Elements
+     *  that aren't part of a SICD are ignored.
+     *
+     *  \param sectionXML The element to parse
+     *  \param sicd The data to fill in
+     */
+    void parseSectionFromXML(const XMLElem sectionXML,
+                             ComplexData* sicd) const;
+
 protected:
 
     virtual XMLElem convertGeoInfoToXML(const GeoInfo *obj,
@@ -162,6 +188,8 @@ protected:
     }
 
 private:
+    void convertSectionsToXML(const ComplexData* sicd, XMLElem root) const;
+
     XMLElem convertImageCreationToXML(const ImageCreation *obj,
                                       XMLElem parent = NULL) const;
     XMLElem convertImageDataToXML(const ImageData *obj,
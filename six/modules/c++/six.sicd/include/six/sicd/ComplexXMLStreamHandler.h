@@ -0,0 +1,142 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_SICD_COMPLEX_XML_STREAM_HANDLER_H__
+#define __SIX_SICD_COMPLEX_XML_STREAM_HANDLER_H__
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <except/Exception.h>
+#include <io/InputStream.h>
+#include <logging/Logger.h>
+#include <xml/lite/MinidomHandler.h>
+#include <six/sicd/ComplexData.h>
+#include <six/sicd/ComplexXMLControl.h>
+#include <six/sicd/ComplexXMLParser.h>
+
+namespace six
+{
+namespace sicd
+{
+/*!
+ *  \class ComplexXMLStreamHandler
+ *  \brief SAX handler that fills in a ComplexData as the XML is read
+ *
+ *  Rather than building a DOM of the whole SICD XML and then walking it,
+ *  this handler hands each element directly under the root to the
+ *  version's ComplexXMLParser as soon as that element is complete, then
+ *  throws its subtree away.  At most one top-level element is held in
+ *  memory at a time.  The parser is picked from the root element's
+ *  namespace URI.
+ *
+ *  The result is the same as ComplexXMLControl would produce from the
+ *  same XML.  The handler itself doesn't validate the XML; the parse()
+ *  that takes schema paths validates the text against the schema for the
+ *  root element's namespace, as ComplexXMLControl does.
+ */
+class ComplexXMLStreamHandler : public xml::lite::MinidomHandler
+{
+public:
+    /*!
+     *  \param log Logger passed on to the parser.  Defaults to a
+     *  NullLogger.
+     */
+    ComplexXMLStreamHandler(logging::Logger* log = NULL);
+
+    virtual void startElement(const std::string& uri,
+                              const std::string& localName,
+                              const std::string& qname,
+                              const xml::lite::Attributes& atts);
+
+    virtual void endElement(const std::string& uri,
+                            const std::string& localName,
+                            const std::string& qname);
+
+    /*!
+     *  Finish up once the XML has been read
+     *
+     *  \return The parsed data.  Throws if any required elements were
+     *  missing or repeated.
+     */
+    std::auto_ptr<ComplexData> getData();
+
+    //! The namespace URI of the root element
+    const std::string& getURI() const
+    {
+        return mURI;
+    }
+
+    /*!
+     *  Read SICD XML and parse it
+     *
+     *  \param xmlStream SICD XML
+     *  \param log Logger passed on to the parser.  Defaults to a
+     *  NullLogger.
+     *
+     *  \return The parsed data
+     */
+    static std::auto_ptr<ComplexData> parse(::io::InputStream& xmlStream,
+                                            logging::Logger* log = NULL);
+
+    /*!
+     *  Read SICD XML, validate it and parse it
+     *
+     *  \param xmlStream SICD XML
+     *  \param schemaPaths Schema paths.  If empty, the SIX_SCHEMA_PATH
+     *  environment variable will be used.
+     *  \param log Logger
+     *
+     *  \return The parsed data
+     */
+    static std::auto_ptr<ComplexData>
+    parse(::io::InputStream& xmlStream,
+          const std::vector<std::string>& schemaPaths,
+          logging::Logger& log);
+
+private:
+    static void read(::io::InputStream& xmlStream,
+                     ComplexXMLStreamHandler& handler);
+
+    void handleSection(std::auto_ptr<xml::lite::Element> sectionXML);
+
+private:
+    const ComplexXMLControl mControl;
+    std::string mURI;
+    std::string mVersion;
+    std::auto_ptr<ComplexXMLParser> mParser;
+    std::auto_ptr<ComplexData> mData;
+
+    // Number of times each element under the root has been seen
+    std::map<std::string, size_t> mCounts;
+
+    // An ImageFormation that came before the RadarCollection it needs
+    std::auto_ptr<xml::lite::Element> mImageFormationXML;
+
+    // The first error hit while parsing, rethrown by getData()
+    std::auto_ptr<except::Exception> mError;
+};
+}
+}
+
+#endif
@@ -53,7 +53,6 @@ struct ImageData
 
     /*!
      *  Indicates the pixel type and binary format of the data.
-     *  \todo We currently do not support AMP8I_PHS8I
      *
      */
     PixelType pixelType;
@@ -61,7 +60,8 @@ struct ImageData
     /*!
      *  SICD AmpTable parameter.  If the data is AMP8I_PHS8I (see above)
      *  this could be initialized, and could store a double precision
-     *  LUT (256 entries) that the phase portion signifies.
+     *  LUT (256 entries) that the amplitude portion indexes into.
+     *  See AmplitudePhaseLUT.
      *
      */
     mem::ScopedCloneablePtr<AmplitudeTable> amplitudeTable;
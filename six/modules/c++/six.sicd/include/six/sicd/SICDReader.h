@@ -0,0 +1,123 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_SICD_SICD_READER_H__
+#define __SIX_SICD_SICD_READER_H__
+
+#include <complex>
+#include <string>
+#include <vector>
+
+#include <six/NITFReadControl.h>
+#include <six/XMLControlFactory.h>
+#include <six/sicd/ComplexData.h>
+#include <six/sicd/Utilities.h>
+#include <sys/Mutex.h>
+#include <types/RowCol.h>
+
+namespace six
+{
+namespace sicd
+{
+/*!
+ * \class SICDReader
+ * \brief Keeps a SICD NITF open so that many regions can be read from it
+ *
+ * The NITF is opened, and its XML parsed, once when the reader is
+ * constructed.  Reading a region after that only reads and converts pixels,
+ * unlike Utilities::getWidebandData(), which reopens the file every time
+ * it's given a pathname.
+ *
+ * readRegion() may be called from multiple threads at once.  Without a
+ * block cache, the reads are serialized.  With one, overlapping regions are
+ * served from the cache concurrently, and only reads from the NITF itself
+ * are serialized.
+ */
+class SICDReader
+{
+public:
+    /*!
+     * Open a SICD
+     *
+     * \param pathname SICD NITF pathname
+     * \param schemaPaths (Optional) Directories or files of schemas to
+     * validate the XML against
+     * \param blockCacheBytes (Optional) Size of the block cache to keep, in
+     * bytes.  Defaults to 0, which means no cache.
+     *
+     * \throws except::Exception if the file is not a SICD
+     */
+    SICDReader(const std::string& pathname,
+               const std::vector<std::string>& schemaPaths =
+                       std::vector<std::string>(),
+               size_t blockCacheBytes = 0);
+
+    ~SICDReader();
+
+    //! \return The parsed SICD XML
+    const ComplexData& getComplexData() const
+    {
+        return *mComplexData;
+    }
+
+    //! \return Rows and columns of the image
+    types::RowCol<size_t> getDims() const
+    {
+        return types::RowCol<size_t>(mComplexData->getNumRows(),
+                                     mComplexData->getNumCols());
+    }
+
+    /*!
+     * Read a region of the image as complex floats
+     *
+     * \param offset The first row and column of the region
+     * \param extent The number of rows and columns in the region
+     * \param[out] buffer Pixels of the region.  Must hold at least
+     * extent.area() pixels.
+     * \param swathBytes (Optional) Approximate number of bytes to read at
+     * a time when the pixels need to be converted to complex float
+     *
+     * \throws except::Exception if the region is not inside the image
+     */
+    void readRegion(const types::RowCol<size_t>& offset,
+                    const types::RowCol<size_t>& extent,
+                    std::complex<float>* buffer,
+                    size_t swathBytes = Utilities::DEFAULT_SWATH_BYTES);
+
+private:
+    // Noncopyable
+    SICDReader(const SICDReader& );
+    const SICDReader& operator=(const SICDReader& );
+
+private:
+    six::XMLControlRegistry mXMLRegistry;
+    six::NITFReadControl mReader;
+
+    // Owned by the reader's container
+    const ComplexData* mComplexData;
+
+    // Serializes reads when there's no block cache
+    sys::Mutex mReadMutex;
+};
+}
+}
+
+#endif
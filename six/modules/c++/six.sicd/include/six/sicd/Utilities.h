@@ -31,7 +31,9 @@
 #include <scene/ProjectionModel.h>
 #include <six/sicd/ComplexData.h>
 #include <six/sicd/SICDMesh.h>
+#include <six/Decimation.h>
 #include <six/NITFReadControl.h>
+#include <six/ThreadPool.h>
 #include <six/sicd/AreaPlaneUtility.h>
 
 namespace six
@@ -41,6 +43,10 @@ namespace sicd
 class Utilities
 {
 public:
+    //! Default number of bytes getWidebandData() reads at a time when
+    //! converting pixels
+    static const size_t DEFAULT_SWATH_BYTES = 32000000;
+
     /*!
      * Build SceneGeometry from ComplexData members
      * \param data ComplexData from which to construct Geometry
@@ -197,7 +203,7 @@ public:
      * \return a pointer to the loaded data.
      *
      * \throws except::Exception if the pixel type of the SICD is not a
-     *           complex float32 or complex int64, or
+     *           complex float32, complex int16 or AMP8I_PHS8I, or
      *         if the buffer pointer is null
      */
     static void getWidebandData(NITFReadControl& reader,
@@ -215,18 +221,45 @@ public:
      * \param extent The number of rows and columns in the region
      * \param buffer A pointer to the buffer to load data into.  Must be
      *   at least complexData.getNumCols() * complexData.getNumRows() pixels
+     * \param swathBytes (Optional) Approximate number of bytes to read at
+     *   a time when the pixels need to be converted to complex float.  At
+     *   least one row is always read.  Each swath is read while the
+     *   previous one is converted, so twice this much scratch space is used.
      *
      * \return a pointer to the loaded data.
      *
      * \throws except::Exception if the pixel type of the SICD is not a
-     *           complex float32 or complex int64, or
+     *           complex float32, complex int16 or AMP8I_PHS8I, or
      *         if the buffer pointer is null
      */
     static void getWidebandData(NITFReadControl& reader,
                                 const ComplexData& complexData,
                                 const types::RowCol<size_t>& offset,
                                 const types::RowCol<size_t>& extent,
-                                std::complex<float>* buffer);
+                                std::complex<float>* buffer,
+                                size_t swathBytes = DEFAULT_SWATH_BYTES);
+
+    /*
+     * Same as above, but converts the pixels on threadPool instead of
+     * starting threads for this call
+     *
+     * \param reader A loaded NITFReadControl associated with the SICD
+     * \param complexData complexData associated with the SICD
+     * \param offset The starting row and column in the region
+     * \param extent The number of rows and columns in the region
+     * \param threadPool Threads to convert pixels on
+     * \param buffer A pointer to the buffer to load data into.  Must be
+     *   at least extent.area() pixels
+     * \param swathBytes (Optional) Approximate number of bytes to read at
+     *   a time when the pixels need to be converted to complex float
+     */
+    static void getWidebandData(NITFReadControl& reader,
+                                const ComplexData& complexData,
+                                const types::RowCol<size_t>& offset,
+                                const types::RowCol<size_t>& extent,
+                                six::ThreadPool& threadPool,
+                                std::complex<float>* buffer,
+                                size_t swathBytes = DEFAULT_SWATH_BYTES);
 
     /*
      * Given a loaded NITFReadControl and a ComplexData object, this
@@ -241,7 +274,7 @@ public:
      * \param buffer The functions output, will contain the image
      *
      * \throws except::Exception if the pixel type of the SICD is not a complex
-     *           float32 or complex int16
+     *           float32, complex int16 or AMP8I_PHS8I
      */
     static void getWidebandData(NITFReadControl& reader,
                                 const ComplexData& complexData,
@@ -260,15 +293,76 @@ public:
      * \param offset The first row and column in the region to be read
      * \param extent The number of rows and columns in the region
      * \param buffer The functions output, will contain the image
+     * \param swathBytes (Optional) Approximate number of bytes to read at
+     *   a time when the pixels need to be converted to complex float
      *
      * \throws except::Exception if the pixel type of the SICD is not a complex
-     *           float32 or complex int16
+     *           float32, complex int16 or AMP8I_PHS8I
      */
      static void getWidebandData(NITFReadControl& reader,
                                 const ComplexData& complexData,
                                 const types::RowCol<size_t>& offset,
                                 const types::RowCol<size_t>& extent,
-                                std::vector<std::complex<float> >& buffer);
+                                std::vector<std::complex<float> >& buffer,
+                                size_t swathBytes = DEFAULT_SWATH_BYTES);
+
+    /*
+     * Given a loaded NITFReadControl and a ComplexData object, this
+     * function reads a decimated, detected quicklook of a region.  Only
+     * the rows that the decimation uses are read, a swath at a time, and
+     * they're converted and reduced across multiple threads.  See
+     * six::Decimation for how the pixels are reduced.
+     *
+     * \param reader A loaded NITFReadControl associated with the SICD
+     * \param complexData complexData associated with the SICD
+     * \param offset The first row and column of the full resolution region
+     * \param extent The number of rows and columns in the full resolution
+     *   region
+     * \param decimation How to decimate the region
+     * \param buffer A pointer to the buffer to load the power of the
+     *   decimated pixels into.  Must be at least
+     *   decimation.getDecimatedDims(extent).area() pixels.
+     * \param swathBytes (Optional) Approximate number of bytes of
+     *   converted pixels to hold at a time.  At least one decimated row is
+     *   always read.
+     *
+     * \throws except::Exception if the pixel type of the SICD is not a
+     *           complex float32, complex int16 or AMP8I_PHS8I, or
+     *         if the buffer pointer is null
+     */
+    static void getDecimatedWidebandData(
+            NITFReadControl& reader,
+            const ComplexData& complexData,
+            const types::RowCol<size_t>& offset,
+            const types::RowCol<size_t>& extent,
+            const Decimation& decimation,
+            float* buffer,
+            size_t swathBytes = DEFAULT_SWATH_BYTES);
+
+    /*
+     * Same as above, but converts and reduces the pixels on threadPool
+     */
+    static void getDecimatedWidebandData(
+            NITFReadControl& reader,
+            const ComplexData& complexData,
+            const types::RowCol<size_t>& offset,
+            const types::RowCol<size_t>& extent,
+            const Decimation& decimation,
+            six::ThreadPool& threadPool,
+            float* buffer,
+            size_t swathBytes = DEFAULT_SWATH_BYTES);
+
+    /*
+     * Same as above, but resizes buffer to fit the decimated region
+     */
+    static void getDecimatedWidebandData(
+            NITFReadControl& reader,
+            const ComplexData& complexData,
+            const types::RowCol<size_t>& offset,
+            const types::RowCol<size_t>& extent,
+            const Decimation& decimation,
+            std::vector<float>& buffer,
+            size_t swathBytes = DEFAULT_SWATH_BYTES);
 
      /*
      * Given a SICD pathname and list of schemas, provides a representation
@@ -281,7 +375,7 @@ public:
      * \param buffer The pre-sized buffer to be read into
      *
      * \throws except::Exception if the pixel type of the SICD is not a complex
-     *           float32 or complex int16, or
+     *           float32, complex int16 or AMP8I_PHS8I, or
      *         if the buffer pointer is null
      */
     static
@@ -304,7 +398,7 @@ public:
      * \param buffer The pre-sized buffer to be read into
      *
      * \throws except::Exception if the pixel type of the SICD is not a complex
-     *           float32 or complex int16, or
+     *           float32, complex int16 or AMP8I_PHS8I, or
      *         if the buffer pointer is null
      *
      */
@@ -348,7 +442,9 @@ public:
                             bool isUpPositive=false);
 
      /* Parses the XML in 'xmlStream' and converts it into a ComplexData object.
-     * Throws if the underlying type is not complex.
+     * Throws if the underlying type is not complex.  The XML is read with a
+     * ComplexXMLStreamHandler, so only one section of it is held as a DOM
+     * at a time.
      *
      * \param xmlStream Input stream containing XML
      * \param schemaPaths Schema path(s)
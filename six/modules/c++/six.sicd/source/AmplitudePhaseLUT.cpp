@@ -0,0 +1,141 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <math.h>
+#include <string.h>
+#include <cmath>
+#include <list>
+#include <utility>
+
+#include <except/Exception.h>
+#include <mt/CriticalSection.h>
+#include <sys/Mutex.h>
+#include <six/sicd/AmplitudePhaseLUT.h>
+
+namespace
+{
+// Each table is 512 KB
+const size_t MAX_CACHED_TABLES = 4;
+
+typedef std::pair<std::vector<unsigned char>,
+                  mem::SharedPtr<const six::sicd::AmplitudePhaseLUT> >
+        CacheEntry;
+}
+
+namespace six
+{
+namespace sicd
+{
+const size_t AmplitudePhaseLUT::NUM_VALUES;
+
+AmplitudePhaseLUT::AmplitudePhaseLUT(const AmplitudeTable* amplitudeTable) :
+    mTable(NUM_VALUES * NUM_VALUES)
+{
+    if (amplitudeTable &&
+        (amplitudeTable->numEntries != NUM_VALUES ||
+         amplitudeTable->elementSize != sizeof(double)))
+    {
+        throw except::Exception(Ctxt(
+                "AmpTable must have 256 double precision entries"));
+    }
+
+    std::vector<double> cosines(NUM_VALUES);
+    std::vector<double> sines(NUM_VALUES);
+    for (size_t phase = 0; phase < NUM_VALUES; ++phase)
+    {
+        const double angle = 2 * M_PI * phase / NUM_VALUES;
+        cosines[phase] = std::cos(angle);
+        sines[phase] = std::sin(angle);
+    }
+
+    for (size_t amplitude = 0; amplitude < NUM_VALUES; ++amplitude)
+    {
+        double value = static_cast<double>(amplitude);
+        if (amplitudeTable)
+        {
+            memcpy(&value, (*amplitudeTable)[amplitude], sizeof(double));
+        }
+
+        std::complex<float>* const row = &mTable[amplitude * NUM_VALUES];
+        for (size_t phase = 0; phase < NUM_VALUES; ++phase)
+        {
+            row[phase] = std::complex<float>(
+                    static_cast<float>(value * cosines[phase]),
+                    static_cast<float>(value * sines[phase]));
+        }
+    }
+}
+
+mem::SharedPtr<const AmplitudePhaseLUT>
+AmplitudePhaseLUT::get(const AmplitudeTable* amplitudeTable)
+{
+    static sys::Mutex mutex;
+    static std::list<CacheEntry> cache;
+
+    // Tables are identified by their contents, since each SICD that's
+    // loaded has its own copy of the AmpTable
+    std::vector<unsigned char> key;
+    if (amplitudeTable)
+    {
+        key = amplitudeTable->table;
+    }
+
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mutex);
+        for (std::list<CacheEntry>::iterator it = cache.begin();
+             it != cache.end();
+             ++it)
+        {
+            if (it->first == key)
+            {
+                // Keep the most recently used tables at the front
+                cache.splice(cache.begin(), cache, it);
+                return cache.front().second;
+            }
+        }
+    }
+
+    // Build outside of the lock.  If another thread builds the same table
+    // in the meantime, both are equivalent.
+    const mem::SharedPtr<const AmplitudePhaseLUT> lut(
+            new AmplitudePhaseLUT(amplitudeTable));
+
+    mt::CriticalSection<sys::Mutex> lock(&mutex);
+    cache.push_front(CacheEntry(key, lut));
+    if (cache.size() > MAX_CACHED_TABLES)
+    {
+        cache.pop_back();
+    }
+    return lut;
+}
+
+void AmplitudePhaseLUT::convert(const sys::ubyte* input,
+                                size_t numPixels,
+                                std::complex<float>* output) const
+{
+    const std::complex<float>* const table = &mTable[0];
+    for (size_t ii = 0; ii < numPixels; ++ii, input += 2)
+    {
+        output[ii] = table[input[0] * NUM_VALUES + input[1]];
+    }
+}
+}
+}
@@ -78,66 +78,132 @@ ComplexData* ComplexXMLParser::fromXML(const xml::lite::Document* doc) const
     }
     rgAzCompXML                = getOptional(root, "RgAzComp"); // added in 1.0.0
 
-    common().parseCollectionInformationFromXML(collectionInfoXML,
-            sicd->collectionInformation.get());
+    // The elements were all looked up first so that missing ones are
+    // reported before anything is parsed
+    const XMLElem sectionsXML[] =
+    {
+        collectionInfoXML,
+        imageCreationXML,
+        imageDataXML,
+        geoDataXML,
+        gridXML,
+        timelineXML,
+        positionXML,
+        radarCollectionXML,
+        imageFormationXML,
+        scpcoaXML,
+        radiometricXML,
+        antennaXML,
+        errorStatisticsXML,
+        matchInfoXML,
+        pfaXML,
+        rmaXML,
+        rgAzCompXML
+    };
+    for (size_t ii = 0;
+         ii < sizeof(sectionsXML) / sizeof(sectionsXML[0]);
+         ++ii)
+    {
+        if (sectionsXML[ii] != NULL)
+        {
+            parseSectionFromXML(sectionsXML[ii], sicd);
+        }
+    }
+    return sicd;
+}
 
-    if (imageCreationXML != NULL)
+void ComplexXMLParser::parseSectionFromXML(const XMLElem sectionXML,
+                                           ComplexData* sicd) const
+{
+    ComplexDataBuilder builder(sicd);
+    const std::string& name = sectionXML->getLocalName();
+
+    if (name == "CollectionInfo")
+    {
+        common().parseCollectionInformationFromXML(sectionXML,
+                sicd->collectionInformation.get());
+    }
+    else if (name == "ImageCreation")
     {
         builder.addImageCreation();
-        parseImageCreationFromXML(imageCreationXML, sicd->imageCreation.get());
+        parseImageCreationFromXML(sectionXML, sicd->imageCreation.get());
     }
-
-    parseImageDataFromXML(imageDataXML, sicd->imageData.get());
-    parseGeoDataFromXML(geoDataXML, sicd->geoData.get());
-    parseGridFromXML(gridXML, sicd->grid.get());
-    parseTimelineFromXML(timelineXML, sicd->timeline.get());
-    parsePositionFromXML(positionXML, sicd->position.get());
-    parseRadarCollectionFromXML(radarCollectionXML, sicd->radarCollection.get());
-    parseImageFormationFromXML(imageFormationXML, *sicd->radarCollection, sicd->imageFormation.get());
-    parseSCPCOAFromXML(scpcoaXML, sicd->scpcoa.get());
-
-    if (radiometricXML != NULL)
+    else if (name == "ImageData")
+    {
+        parseImageDataFromXML(sectionXML, sicd->imageData.get());
+    }
+    else if (name == "GeoData")
+    {
+        parseGeoDataFromXML(sectionXML, sicd->geoData.get());
+    }
+    else if (name == "Grid")
+    {
+        parseGridFromXML(sectionXML, sicd->grid.get());
+    }
+    else if (name == "Timeline")
+    {
+        parseTimelineFromXML(sectionXML, sicd->timeline.get());
+    }
+    else if (name == "Position")
+    {
+        parsePositionFromXML(sectionXML, sicd->position.get());
+    }
+    else if (name == "RadarCollection")
+    {
+        parseRadarCollectionFromXML(sectionXML, sicd->radarCollection.get());
+    }
+    else if (name == "ImageFormation")
+    {
+        parseImageFormationFromXML(sectionXML, *sicd->radarCollection,
+                                   sicd->imageFormation.get());
+    }
+    else if (name == "SCPCOA")
+    {
+        parseSCPCOAFromXML(sectionXML, sicd->scpcoa.get());
+    }
+    else if (name == "Radiometric")
     {
         builder.addRadiometric();
-        common().parseRadiometryFromXML(radiometricXML,
+        common().parseRadiometryFromXML(sectionXML,
                                        sicd->radiometric.get());
     }
-
-    if (antennaXML != NULL)
+    else if (name == "Antenna")
     {
         builder.addAntenna();
-        parseAntennaFromXML(antennaXML, sicd->antenna.get());
+        parseAntennaFromXML(sectionXML, sicd->antenna.get());
     }
-
-    if (errorStatisticsXML != NULL)
+    else if (name == "ErrorStatistics")
     {
         builder.addErrorStatistics();
-        common().parseErrorStatisticsFromXML(errorStatisticsXML,
+        common().parseErrorStatisticsFromXML(sectionXML,
                                             sicd->errorStatistics.get());
     }
-
-    if (matchInfoXML != NULL)
+    else if (name == "MatchInfo")
     {
         builder.addMatchInformation();
-        parseMatchInformationFromXML(matchInfoXML, sicd->matchInformation.get());
+        parseMatchInformationFromXML(sectionXML,
+                                     sicd->matchInformation.get());
     }
-
-    if (pfaXML != NULL)
+    else if (name == "PFA")
     {
         sicd->pfa.reset(new PFA());
-        parsePFAFromXML(pfaXML, sicd->pfa.get());
+        parsePFAFromXML(sectionXML, sicd->pfa.get());
     }
-    if (rmaXML != NULL)
+    else if (name == "RMA")
     {
         sicd->rma.reset(new RMA());
-        parseRMAFromXML(rmaXML, sicd->rma.get());
+        parseRMAFromXML(sectionXML, sicd->rma.get());
     }
-    if (rgAzCompXML != NULL)
+    else if (name == "RgAzComp")
     {
         sicd->rgAzComp.reset(new RgAzComp());
-        parseRgAzCompFromXML(rgAzCompXML, sicd->rgAzComp.get());
+        parseRgAzCompFromXML(sectionXML, sicd->rgAzComp.get());
+    }
+    else if (name == "RGAZCOMP")
+    {
+        throw except::Exception(Ctxt(
+                "SIX library does not support RGAZCOMP element"));
     }
-    return sicd;
 }
 
 xml::lite::Document* ComplexXMLParser::toXML(const ComplexData* sicd) const
@@ -147,6 +213,51 @@ xml::lite::Document* ComplexXMLParser::toXML(const ComplexData* sicd) const
     XMLElem root = newElement("SICD");
     doc->setRootElement(root);
 
+    convertSectionsToXML(sicd, root);
+
+    //set the XMLNS
+    root->setNamespacePrefix("", getDefaultURI());
+    //        root->setNamespacePrefix("si", common().getSICommonURI());
+
+    return doc;
+}
+
+void ComplexXMLParser::toXML(const ComplexData* sicd, std::string& xml)
+{
+    const size_t offset = xml.size();
+    XMLStreamWriter writer(xml);
+    setStreamWriter(&writer);
+
+    try
+    {
+        const std::auto_ptr<xml::lite::Element> root(newElement("SICD"));
+
+        // The writer needs the XMLNS before it writes the root
+        root->setNamespacePrefix("", getDefaultURI());
+
+        convertSectionsToXML(sicd, root.get());
+        writer.finish();
+    }
+    catch (...)
+    {
+        // Don't leave half a document behind
+        xml.resize(offset);
+        setStreamWriter(NULL);
+        throw;
+    }
+
+    setStreamWriter(NULL);
+}
+
+void ComplexXMLParser::setStreamWriter(XMLStreamWriter* writer)
+{
+    XMLParser::setStreamWriter(writer);
+    mCommon->setStreamWriter(writer);
+}
+
+void ComplexXMLParser::convertSectionsToXML(const ComplexData* sicd,
+                                            XMLElem root) const
+{
     common().convertCollectionInformationToXML(
             sicd->collectionInformation.get(), root);
     if (sicd->imageCreation.get())
@@ -180,12 +291,6 @@ xml::lite::Document* ComplexXMLParser::toXML(const ComplexData* sicd) const
 
     // parse the choice per version
     convertImageFormationAlgoToXML(sicd->pfa.get(), sicd->rma.get(), sicd->rgAzComp.get(), root);
-
-    //set the XMLNS
-    root->setNamespacePrefix("", getDefaultURI());
-    //        root->setNamespacePrefix("si", common().getSICommonURI());
-
-    return doc;
 }
 
 XMLElem ComplexXMLParser::createFFTSign(const std::string& name, six::FFTSign sign,
@@ -0,0 +1,293 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <exception>
+
+#include <except/Exception.h>
+#include <io/StringStream.h>
+#include <str/Manip.h>
+#include <xml/lite/XMLReader.h>
+#include <six/sicd/ComplexXMLStreamHandler.h>
+
+namespace
+{
+// Elements under the root that ComplexXMLParser::fromXML() requires
+// exactly one of
+const char* const REQUIRED_SECTIONS[] =
+{
+    "CollectionInfo",
+    "ImageData",
+    "GeoData",
+    "Grid",
+    "Timeline",
+    "Position",
+    "RadarCollection",
+    "ImageFormation",
+    "SCPCOA"
+};
+
+bool isRequired(const std::string& name)
+{
+    for (size_t ii = 0;
+         ii < sizeof(REQUIRED_SECTIONS) / sizeof(REQUIRED_SECTIONS[0]);
+         ++ii)
+    {
+        if (name == REQUIRED_SECTIONS[ii])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// fromXML() ignores optional elements that appear more than once
+void resetOptional(const std::string& name, six::sicd::ComplexData& data)
+{
+    if (name == "ImageCreation")
+    {
+        data.imageCreation.reset();
+    }
+    else if (name == "Radiometric")
+    {
+        data.radiometric.reset();
+    }
+    else if (name == "Antenna")
+    {
+        data.antenna.reset();
+    }
+    else if (name == "ErrorStatistics")
+    {
+        data.errorStatistics.reset();
+    }
+    else if (name == "MatchInfo")
+    {
+        data.matchInformation.reset();
+    }
+    else if (name == "PFA")
+    {
+        data.pfa.reset();
+    }
+    else if (name == "RMA")
+    {
+        data.rma.reset();
+    }
+    else if (name == "RgAzComp")
+    {
+        data.rgAzComp.reset();
+    }
+}
+
+std::string getExpectedOneMessage(const std::string& name, size_t count)
+{
+    return "Expected exactly one " + name + " but got " +
+            str::toString(count);
+}
+}
+
+namespace six
+{
+namespace sicd
+{
+ComplexXMLStreamHandler::ComplexXMLStreamHandler(logging::Logger* log) :
+    mControl(log)
+{
+    // Same as six::parseData()
+    preserveCharacterData(true);
+}
+
+void ComplexXMLStreamHandler::startElement(const std::string& uri,
+                                           const std::string& localName,
+                                           const std::string& qname,
+                                           const xml::lite::Attributes& atts)
+{
+    if (nodeStack.empty())
+    {
+        mURI = uri;
+        mVersion.clear();
+        mParser.reset();
+        mData.reset();
+        mCounts.clear();
+        mImageFormationXML.reset();
+        mError.reset();
+
+        if (str::startsWith(uri, "urn:SICD:"))
+        {
+            mVersion = uri.substr(9);
+            try
+            {
+                mParser = mControl.getParser(mVersion);
+                mData.reset(new ComplexData());
+            }
+            catch (const except::Exception& ex)
+            {
+                mError.reset(new except::Exception(ex));
+            }
+        }
+        else
+        {
+            mError.reset(new except::Exception(Ctxt(
+                    "Unable to transform XML DES: Invalid XML namespace "
+                    "URI: " + uri)));
+        }
+    }
+
+    xml::lite::MinidomHandler::startElement(uri, localName, qname, atts);
+}
+
+void ComplexXMLStreamHandler::endElement(const std::string& uri,
+                                         const std::string& localName,
+                                         const std::string& qname)
+{
+    // The root and one of its children
+    const bool isSection = (nodeStack.size() == 2);
+
+    xml::lite::MinidomHandler::endElement(uri, localName, qname);
+
+    if (isSection && mError.get() == NULL)
+    {
+        // Take the section back off of the root, which stays around
+        // until the document is done
+        std::vector<xml::lite::Element*>& children =
+                nodeStack.top()->getChildren();
+        std::auto_ptr<xml::lite::Element> sectionXML(children.back());
+        children.pop_back();
+
+        // Exceptions can't be thrown back through the XML reader, so hold
+        // onto the first one until the document is done
+        try
+        {
+            handleSection(sectionXML);
+        }
+        catch (const except::Exception& ex)
+        {
+            mError.reset(new except::Exception(ex));
+        }
+        catch (const std::exception& ex)
+        {
+            mError.reset(new except::Exception(Ctxt(ex.what())));
+        }
+    }
+}
+
+void ComplexXMLStreamHandler::handleSection(
+        std::auto_ptr<xml::lite::Element> sectionXML)
+{
+    const std::string& name = sectionXML->getLocalName();
+    const size_t count = ++mCounts[name];
+    if (count == 1)
+    {
+        if (name == "ImageFormation" &&
+            mCounts.find("RadarCollection") == mCounts.end())
+        {
+            mImageFormationXML = sectionXML;
+            return;
+        }
+
+        mParser->parseSectionFromXML(sectionXML.get(), mData.get());
+
+        if (name == "RadarCollection" && mImageFormationXML.get())
+        {
+            mParser->parseSectionFromXML(mImageFormationXML.get(),
+                                         mData.get());
+            mImageFormationXML.reset();
+        }
+    }
+    else if (isRequired(name))
+    {
+        throw except::Exception(Ctxt(getExpectedOneMessage(name, count)));
+    }
+    else
+    {
+        resetOptional(name, *mData);
+    }
+}
+
+std::auto_ptr<ComplexData> ComplexXMLStreamHandler::getData()
+{
+    if (mError.get())
+    {
+        throw *mError;
+    }
+    if (mData.get() == NULL)
+    {
+        throw except::Exception(Ctxt("No SICD XML has been read"));
+    }
+
+    for (size_t ii = 0;
+         ii < sizeof(REQUIRED_SECTIONS) / sizeof(REQUIRED_SECTIONS[0]);
+         ++ii)
+    {
+        const std::map<std::string, size_t>::const_iterator it =
+                mCounts.find(REQUIRED_SECTIONS[ii]);
+        if (it == mCounts.end())
+        {
+            throw except::Exception(Ctxt(
+                    getExpectedOneMessage(REQUIRED_SECTIONS[ii], 0)));
+        }
+    }
+
+    mData->setVersion(mVersion);
+    mParser.reset();
+    return mData;
+}
+
+std::auto_ptr<ComplexData>
+ComplexXMLStreamHandler::parse(::io::InputStream& xmlStream,
+                               logging::Logger* log)
+{
+    ComplexXMLStreamHandler handler(log);
+    read(xmlStream, handler);
+    return handler.getData();
+}
+
+std::auto_ptr<ComplexData>
+ComplexXMLStreamHandler::parse(::io::InputStream& xmlStream,
+                               const std::vector<std::string>& schemaPaths,
+                               logging::Logger& log)
+{
+    // Hold onto the text so that it's validated as-is, the same as
+    // six::parseData()
+    io::StringStream xmlText;
+    xmlStream.streamTo(xmlText);
+    const std::string xml = xmlText.stream().str();
+
+    ComplexXMLStreamHandler handler(&log);
+    read(xmlText, handler);
+    XMLControl::validate(xml, handler.getURI(), schemaPaths, &log);
+    return handler.getData();
+}
+
+void ComplexXMLStreamHandler::read(::io::InputStream& xmlStream,
+                                   ComplexXMLStreamHandler& handler)
+{
+    xml::lite::XMLReader reader;
+    reader.setContentHandler(&handler);
+    try
+    {
+        reader.parse(xmlStream);
+    }
+    catch (const except::Throwable& ex)
+    {
+        throw except::Exception(ex, Ctxt("Invalid XML data"));
+    }
+}
+}
+}
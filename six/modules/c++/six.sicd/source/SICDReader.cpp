@@ -0,0 +1,99 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <except/Exception.h>
+#include <mt/CriticalSection.h>
+#include <str/Convert.h>
+#include <six/sicd/ComplexXMLControl.h>
+#include <six/sicd/SICDReader.h>
+
+namespace six
+{
+namespace sicd
+{
+SICDReader::SICDReader(const std::string& pathname,
+                       const std::vector<std::string>& schemaPaths,
+                       size_t blockCacheBytes) :
+    mComplexData(NULL)
+{
+    mXMLRegistry.addCreator(
+            six::DataType::COMPLEX,
+            new six::XMLControlCreatorT<six::sicd::ComplexXMLControl>());
+    mReader.setXMLControlRegistry(&mXMLRegistry);
+    mReader.load(pathname, schemaPaths);
+
+    const six::Data* const data = mReader.getContainer()->getData(0);
+    if (data->getDataType() != six::DataType::COMPLEX)
+    {
+        throw except::Exception(Ctxt(pathname + " is not a SICD"));
+    }
+    mComplexData = static_cast<const ComplexData*>(data);
+
+    if (blockCacheBytes > 0)
+    {
+        mReader.enableBlockCache(blockCacheBytes);
+    }
+}
+
+SICDReader::~SICDReader()
+{
+    // The reader doesn't own the registry
+    mReader.setXMLControlRegistry(NULL);
+}
+
+void SICDReader::readRegion(const types::RowCol<size_t>& offset,
+                            const types::RowCol<size_t>& extent,
+                            std::complex<float>* buffer,
+                            size_t swathBytes)
+{
+    const types::RowCol<size_t> dims = getDims();
+    if (offset.row + extent.row > dims.row ||
+        offset.col + extent.col > dims.col)
+    {
+        throw except::Exception(Ctxt(
+                "Region at (" + str::toString(offset.row) + ", " +
+                str::toString(offset.col) + ") of size (" +
+                str::toString(extent.row) + ", " +
+                str::toString(extent.col) + ") is outside of the " +
+                str::toString(dims.row) + " by " + str::toString(dims.col) +
+                " image"));
+    }
+
+    if (extent.area() == 0)
+    {
+        return;
+    }
+
+    if (mReader.getBlockCache())
+    {
+        // The cache does its own locking
+        Utilities::getWidebandData(mReader, *mComplexData, offset, extent,
+                                   buffer, swathBytes);
+    }
+    else
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mReadMutex);
+        Utilities::getWidebandData(mReader, *mComplexData, offset, extent,
+                                   buffer, swathBytes);
+    }
+}
+}
+}
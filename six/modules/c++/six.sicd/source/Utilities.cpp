@@ -19,6 +19,7 @@
  * see <http://www.gnu.org/licenses/>.
  *
  */
+#include <algorithm>
 #include <map>
 
 #include <except/Exception.h>
@@ -28,13 +29,24 @@
 #include <mem/ScopedAlignedArray.h>
 #include <six/NITFReadControl.h>
 #include <six/Utilities.h>
+#include <six/ThreadPool.h>
+#include <six/sicd/AmplitudePhaseLUT.h>
 #include <six/sicd/ComplexXMLControl.h>
+#include <six/sicd/ComplexXMLStreamHandler.h>
 #include <six/sicd/SICDMesh.h>
 #include <six/sicd/Utilities.h>
 #include <str/Manip.h>
 #include <sys/Conf.h>
+#include <sys/OS.h>
+#include <sys/Thread.h>
 #include <types/RowCol.h>
 
+// SSE2 is part of x86-64
+#if defined(__x86_64__) || defined(_M_X64)
+#define SIX_SICD_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace
 {
 void getErrors(const six::sicd::ComplexData& data, scene::Errors& errors)
@@ -59,54 +71,244 @@ six::Region buildRegion(const types::RowCol<size_t>& offset,
     return retv;
 }
 
-// Reads in ~32 MB of rows at a time, converts to complex<float>, and keeps
-// going until reads everything
+// Pixels converted per thread, at a minimum
+const size_t MIN_PIXELS_PER_CHUNK = 16 * 1024;
+
+// Converts RE16I_IM16I pixels to complex<float>
+class Int16Converter
+{
+public:
+    void convert(const sys::ubyte* input,
+                 size_t numPixels,
+                 std::complex<float>* output) const
+    {
+        const short* const in = reinterpret_cast<const short*>(input);
+        float* const out = reinterpret_cast<float*>(output);
+        const size_t numElements = numPixels * 2;
+
+        size_t ii = 0;
+#if defined(SIX_SICD_SSE2)
+        // Sign extend eight shorts at a time to ints, then convert those
+        for (; ii + 8 <= numElements; ii += 8)
+        {
+            const __m128i v16 = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(in + ii));
+            const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v16, v16), 16);
+            const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v16, v16), 16);
+            _mm_storeu_ps(out + ii, _mm_cvtepi32_ps(lo));
+            _mm_storeu_ps(out + ii + 4, _mm_cvtepi32_ps(hi));
+        }
+#endif
+        for (; ii < numElements; ++ii)
+        {
+            out[ii] = in[ii];
+        }
+    }
+};
+
+template <typename ConverterT>
+class ConvertChunk : public sys::Runnable
+{
+public:
+    ConvertChunk(const ConverterT& converter,
+                 const sys::ubyte* input,
+                 size_t numPixels,
+                 std::complex<float>* output) :
+        mConverter(converter),
+        mInput(input),
+        mNumPixels(numPixels),
+        mOutput(output)
+    {
+    }
+
+    virtual void run()
+    {
+        mConverter.convert(mInput, mNumPixels, mOutput);
+    }
+
+private:
+    const ConverterT& mConverter;
+    const sys::ubyte* mInput;
+    size_t mNumPixels;
+    std::complex<float>* mOutput;
+};
+
+// Reads a swath on a background thread
+class SwathReader : public sys::Runnable
+{
+public:
+    SwathReader(six::NITFReadControl& reader,
+                size_t imageNumber,
+                const six::Region& region,
+                std::auto_ptr<except::Exception>& error) :
+        mReader(reader),
+        mImageNumber(imageNumber),
+        mRegion(region),
+        mError(error)
+    {
+    }
+
+    virtual void run()
+    {
+        try
+        {
+            mReader.interleaved(mRegion, mImageNumber);
+        }
+        catch (const except::Exception& ex)
+        {
+            mError.reset(new except::Exception(ex));
+        }
+        catch (const std::exception& ex)
+        {
+            mError.reset(new except::Exception(Ctxt(ex.what())));
+        }
+        catch (...)
+        {
+            mError.reset(new except::Exception(Ctxt("Unknown exception")));
+        }
+    }
+
+private:
+    six::NITFReadControl& mReader;
+    const size_t mImageNumber;
+    six::Region mRegion;
+    std::auto_ptr<except::Exception>& mError;
+};
+
+// Reads in swaths of about swathBytes at a time, converts them to
+// complex<float> across multiple threads, and keeps going until it reads
+// everything.  Each swath is read on a background thread while the
+// previous one is converted.
+template <typename ConverterT>
 void readAndConvertSICD(six::NITFReadControl& reader,
                         size_t imageNumber,
                         const types::RowCol<size_t>& offset,
                         const types::RowCol<size_t>& extent,
+                        size_t bytesPerPixel,
+                        size_t swathBytes,
+                        const ConverterT& converter,
+                        six::ThreadPool& threadPool,
                         std::complex<float>* buffer)
 {
-    // One for the real component, one for imaginary of each pixel
-    const size_t elementsPerRow = extent.col * 2;
+    if (extent.area() == 0)
+    {
+        return;
+    }
+
+    const size_t bytesPerRow = extent.col * bytesPerPixel;
+    const size_t rowsPerSwath = std::min(
+            std::max<size_t>(swathBytes / bytesPerRow, 1), extent.row);
+    const size_t numSwaths = (extent.row + rowsPerSwath - 1) / rowsPerSwath;
 
-    // Get at least 32MB per read
-    const size_t rowsAtATime =
-            (32000000 / (elementsPerRow * sizeof(short))) + 1;
+    // Allocate temp buffers
+    std::vector<sys::ubyte> swaths[2];
+    swaths[0].resize(bytesPerRow * rowsPerSwath);
+    if (numSwaths > 1)
+    {
+        swaths[1].resize(bytesPerRow * rowsPerSwath);
+    }
 
-    // Allocate temp buffer
-    std::vector<short> tempVector(elementsPerRow * rowsAtATime);
-    short* const tempBuffer = &tempVector[0];
+    std::vector<ConvertChunk<ConverterT> > chunks;
 
-    const size_t endRow = offset.row + extent.row;
+    // Read the first swath up front
+    six::Region region = buildRegion(
+            offset,
+            types::RowCol<size_t>(rowsPerSwath, extent.col),
+            &swaths[0][0]);
+    reader.interleaved(region, imageNumber);
 
-    for (size_t row = offset.row, rowsToRead = rowsAtATime; row < endRow;
-         row += rowsToRead)
+    for (size_t swath = 0; swath < numSwaths; ++swath)
     {
-        // If we would read beyond the input buffer, don't
-        if (row + rowsToRead > endRow)
+        const size_t firstRow = swath * rowsPerSwath;
+        const size_t numRows = std::min(rowsPerSwath, extent.row - firstRow);
+        const sys::ubyte* const input = &swaths[swath % 2][0];
+
+        // Start reading the next swath into the other buffer
+        std::auto_ptr<except::Exception> readError;
+        std::auto_ptr<sys::Thread> readThread;
+        if (swath + 1 < numSwaths)
         {
-            rowsToRead = endRow - row;
+            const size_t nextRow = firstRow + rowsPerSwath;
+            const types::RowCol<size_t> swathOffset(offset.row + nextRow,
+                                                    offset.col);
+            const types::RowCol<size_t> swathExtent(
+                    std::min(rowsPerSwath, extent.row - nextRow), extent.col);
+            readThread.reset(new sys::Thread(new SwathReader(
+                    reader,
+                    imageNumber,
+                    buildRegion(swathOffset,
+                                swathExtent,
+                                &swaths[(swath + 1) % 2][0]),
+                    readError)));
+            readThread->start();
         }
-        
-        // Read into the temp buffer
-        types::RowCol<size_t> swathOffset(row, offset.col);
-        types::RowCol<size_t> swathExtent(rowsToRead, extent.col);
-        six::Region region = buildRegion(swathOffset, swathExtent, tempBuffer);
-        reader.interleaved(region, imageNumber);
 
-        // Take each Int16 out of the temp buffer and put it into the real
-        // buffer as a Float32
-        float* const bufferPtr = reinterpret_cast<float*>(buffer) +
-                ((row - offset.row) * elementsPerRow);
+        // Split the conversion evenly across the threads
+        std::complex<float>* const output = buffer + firstRow * extent.col;
+        const size_t numPixels = numRows * extent.col;
+        const size_t numChunks =
+                threadPool.getNumChunks(numPixels, MIN_PIXELS_PER_CHUNK);
+        const size_t pixelsPerChunk = (numPixels + numChunks - 1) / numChunks;
+
+        chunks.clear();
+        for (size_t pixel = 0; pixel < numPixels; pixel += pixelsPerChunk)
+        {
+            chunks.push_back(ConvertChunk<ConverterT>(
+                    converter,
+                    input + pixel * bytesPerPixel,
+                    std::min(pixelsPerChunk, numPixels - pixel),
+                    output + pixel));
+        }
+
+        try
+        {
+            threadPool.runEach(chunks);
+        }
+        catch (...)
+        {
+            if (readThread.get())
+            {
+                readThread->join();
+            }
+            throw;
+        }
 
-        for (size_t index = 0; index < elementsPerRow * rowsToRead; index++)
+        if (readThread.get())
         {
-            bufferPtr[index] = tempBuffer[index];
+            readThread->join();
+            if (readError.get())
+            {
+                throw except::Exception(*readError);
+            }
         }
     }
 }
 
+// Converts pixels to complex<float>, splitting them evenly across threads
+template <typename ConverterT>
+void convertSICD(const ConverterT& converter,
+                 const sys::ubyte* input,
+                 size_t numPixels,
+                 size_t bytesPerPixel,
+                 six::ThreadPool& threadPool,
+                 std::complex<float>* output)
+{
+    const size_t numChunks =
+            threadPool.getNumChunks(numPixels, MIN_PIXELS_PER_CHUNK);
+    const size_t pixelsPerChunk = (numPixels + numChunks - 1) / numChunks;
+
+    std::vector<ConvertChunk<ConverterT> > chunks;
+    for (size_t pixel = 0; pixel < numPixels; pixel += pixelsPerChunk)
+    {
+        chunks.push_back(ConvertChunk<ConverterT>(
+                converter,
+                input + pixel * bytesPerPixel,
+                std::min(pixelsPerChunk, numPixels - pixel),
+                output + pixel));
+    }
+    threadPool.runEach(chunks);
+}
+
 six::Poly2D getXYtoRowColTransform(double center,
                                    double sampleSpacing,
                                    bool rowTransform)
@@ -185,6 +387,8 @@ namespace six
 {
 namespace sicd
 {
+const size_t Utilities::DEFAULT_SWATH_BYTES;
+
 scene::SceneGeometry* Utilities::getSceneGeometry(const ComplexData* data)
 {
     scene::SceneGeometry* geom =
@@ -569,7 +773,24 @@ void Utilities::getWidebandData(NITFReadControl& reader,
                                 const ComplexData& complexData,
                                 const types::RowCol<size_t>& offset,
                                 const types::RowCol<size_t>& extent,
-                                std::complex<float>* buffer)
+                                std::complex<float>* buffer,
+                                size_t swathBytes)
+{
+    // Pixels that are read as they are don't need any other threads
+    six::ThreadPool threadPool(
+            (complexData.getPixelType() == PixelType::RE32F_IM32F) ?
+                    1 : sys::OS().getNumCPUs());
+    getWidebandData(reader, complexData, offset, extent, threadPool, buffer,
+                    swathBytes);
+}
+
+void Utilities::getWidebandData(NITFReadControl& reader,
+                                const ComplexData& complexData,
+                                const types::RowCol<size_t>& offset,
+                                const types::RowCol<size_t>& extent,
+                                six::ThreadPool& threadPool,
+                                std::complex<float>* buffer,
+                                size_t swathBytes)
 {
     const PixelType pixelType = complexData.getPixelType();
     const size_t imageNumber = 0;
@@ -594,7 +815,18 @@ void Utilities::getWidebandData(NITFReadControl& reader,
     }
     else if (pixelType == PixelType::RE16I_IM16I)
     {
-        readAndConvertSICD(reader, imageNumber, offset, extent, buffer);
+        readAndConvertSICD(reader, imageNumber, offset, extent,
+                           complexData.getNumBytesPerPixel(), swathBytes,
+                           Int16Converter(), threadPool, buffer);
+    }
+    else if (pixelType == PixelType::AMP8I_PHS8I)
+    {
+        const mem::SharedPtr<const AmplitudePhaseLUT> lut =
+                AmplitudePhaseLUT::get(
+                        complexData.imageData->amplitudeTable.get());
+        readAndConvertSICD(reader, imageNumber, offset, extent,
+                           complexData.getNumBytesPerPixel(), swathBytes,
+                           *lut, threadPool, buffer);
     }
     else
     {
@@ -618,14 +850,16 @@ void Utilities::getWidebandData(NITFReadControl& reader,
                                 const ComplexData& complexData,
                                 const types::RowCol<size_t>& offset,
                                 const types::RowCol<size_t>& extent,
-                                std::vector<std::complex<float>>& buffer)
+                                std::vector<std::complex<float>>& buffer,
+                                size_t swathBytes)
 {
     const size_t requiredNumElements = extent.area();
     buffer.resize(requiredNumElements);
 
     if (requiredNumElements > 0)
     {
-        getWidebandData(reader, complexData, offset, extent, &buffer[0]);
+        getWidebandData(reader, complexData, offset, extent, &buffer[0],
+                        swathBytes);
     }
 }
 
@@ -641,6 +875,142 @@ void Utilities::getWidebandData(NITFReadControl& reader,
     getWidebandData(reader, complexData, offset, extent, buffer);
 }
 
+void Utilities::getDecimatedWidebandData(NITFReadControl& reader,
+                                         const ComplexData& complexData,
+                                         const types::RowCol<size_t>& offset,
+                                         const types::RowCol<size_t>& extent,
+                                         const Decimation& decimation,
+                                         float* buffer,
+                                         size_t swathBytes)
+{
+    six::ThreadPool threadPool(sys::OS().getNumCPUs());
+    getDecimatedWidebandData(reader, complexData, offset, extent, decimation,
+                             threadPool, buffer, swathBytes);
+}
+
+void Utilities::getDecimatedWidebandData(NITFReadControl& reader,
+                                         const ComplexData& complexData,
+                                         const types::RowCol<size_t>& offset,
+                                         const types::RowCol<size_t>& extent,
+                                         const Decimation& decimation,
+                                         six::ThreadPool& threadPool,
+                                         float* buffer,
+                                         size_t swathBytes)
+{
+    const PixelType pixelType = complexData.getPixelType();
+    if (pixelType != PixelType::RE32F_IM32F &&
+        pixelType != PixelType::RE16I_IM16I &&
+        pixelType != PixelType::AMP8I_PHS8I)
+    {
+        throw except::Exception(
+                Ctxt(complexData.getName() + " has an unknown pixel type"));
+    }
+
+    const types::RowCol<size_t> outputDims =
+            decimation.getDecimatedDims(extent);
+    if (outputDims.area() == 0)
+    {
+        return;
+    }
+    if (buffer == NULL)
+    {
+        throw except::Exception(Ctxt(
+                "Null buffer provided to getDecimatedWidebandData"));
+    }
+
+    // Decimated rows are read a swath at a time
+    const size_t imageNumber = 0;
+    const size_t rowsPerOutputRow = decimation.getRowsPerOutputRow();
+    const size_t bytesPerOutputRow =
+            rowsPerOutputRow * extent.col * sizeof(std::complex<float>);
+    const size_t outputRowsPerSwath = std::min(
+            std::max<size_t>(swathBytes / bytesPerOutputRow, 1),
+            outputDims.row);
+
+    // Pixels that need converting are read into scratch space first
+    const size_t bytesPerPixel = complexData.getNumBytesPerPixel();
+    const size_t maxPixelsPerSwath =
+            outputRowsPerSwath * rowsPerOutputRow * extent.col;
+    std::vector<std::complex<float> > pixels(maxPixelsPerSwath);
+    std::vector<sys::ubyte> scratch;
+    if (pixelType != PixelType::RE32F_IM32F)
+    {
+        scratch.resize(maxPixelsPerSwath * bytesPerPixel);
+    }
+    sys::ubyte* const readBuffer = scratch.empty() ?
+            reinterpret_cast<sys::ubyte*>(&pixels[0]) : &scratch[0];
+
+    mem::SharedPtr<const AmplitudePhaseLUT> lut;
+    if (pixelType == PixelType::AMP8I_PHS8I)
+    {
+        lut = AmplitudePhaseLUT::get(
+                complexData.imageData->amplitudeTable.get());
+    }
+
+    for (size_t outputRow = 0; outputRow < outputDims.row;
+         outputRow += outputRowsPerSwath)
+    {
+        const size_t numOutputRows =
+                std::min(outputRowsPerSwath, outputDims.row - outputRow);
+        const size_t firstRow = outputRow * decimation.factor.row;
+        const types::RowCol<size_t> swathOffset(offset.row + firstRow,
+                                                offset.col);
+        const types::RowCol<size_t> swathExtent(
+                std::min(numOutputRows * decimation.factor.row,
+                         extent.row - firstRow),
+                extent.col);
+
+        six::Region region = buildRegion(swathOffset, swathExtent,
+                                         readBuffer);
+        size_t numInputRows;
+        if (decimation.method == Decimation::SKIP)
+        {
+            // Only the first row of each block is needed
+            reader.interleavedDecimated(
+                    region,
+                    imageNumber,
+                    types::RowCol<size_t>(decimation.factor.row, 1));
+            numInputRows = numOutputRows;
+        }
+        else
+        {
+            reader.interleaved(region, imageNumber);
+            numInputRows = swathExtent.row;
+        }
+
+        const size_t numPixels = numInputRows * extent.col;
+        if (pixelType == PixelType::RE16I_IM16I)
+        {
+            convertSICD(Int16Converter(), readBuffer, numPixels,
+                        bytesPerPixel, threadPool, &pixels[0]);
+        }
+        else if (pixelType == PixelType::AMP8I_PHS8I)
+        {
+            convertSICD(*lut, readBuffer, numPixels, bytesPerPixel,
+                        threadPool, &pixels[0]);
+        }
+
+        decimation.reduce(&pixels[0], numInputRows, extent.col, threadPool,
+                          buffer + outputRow * outputDims.col);
+    }
+}
+
+void Utilities::getDecimatedWidebandData(NITFReadControl& reader,
+                                         const ComplexData& complexData,
+                                         const types::RowCol<size_t>& offset,
+                                         const types::RowCol<size_t>& extent,
+                                         const Decimation& decimation,
+                                         std::vector<float>& buffer,
+                                         size_t swathBytes)
+{
+    buffer.resize(decimation.getDecimatedDims(extent).area());
+    if (!buffer.empty())
+    {
+        getDecimatedWidebandData(reader, complexData, offset, extent,
+                                 decimation, &buffer[0], swathBytes);
+    }
+}
+
 void Utilities::getWidebandData(const std::string& sicdPathname,
                                 const std::vector<std::string>& /*schemaPaths*/,
                                 const ComplexData& complexData,
@@ -747,17 +1117,7 @@ std::auto_ptr<ComplexData> Utilities::parseData(
         const std::vector<std::string>& schemaPaths,
         logging::Logger& log)
 {
-    XMLControlRegistry xmlRegistry;
-    xmlRegistry.addCreator(DataType::COMPLEX,
-                           new XMLControlCreatorT<ComplexXMLControl>());
-
-    std::auto_ptr<Data> data(
-            six::parseData(xmlRegistry, xmlStream, schemaPaths, log));
-
-    std::auto_ptr<ComplexData> complexData(
-            reinterpret_cast<ComplexData*>(data.release()));
-
-    return complexData;
+    return ComplexXMLStreamHandler::parse(xmlStream, schemaPaths, log);
 }
 
 std::auto_ptr<ComplexData> Utilities::parseDataFromFile(
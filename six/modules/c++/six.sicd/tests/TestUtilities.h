@@ -28,6 +28,8 @@
 
 #include <sys/OS.h>
 #include <io/ReadUtils.h>
+#include <six/NITFWriteControl.h>
+#include <six/sicd/ComplexXMLControl.h>
 #include <six/sicd/Utilities.h>
 
 // Template specialization to get appropriate pixel type
@@ -67,6 +69,67 @@ createData(const types::RowCol<size_t>& dims)
     return data;
 }
 
+// A fake SICD of any pixel type and size, along with pixels to write out for
+// it.  Each byte of the pixels starts out as its index times 7, which callers
+// are free to replace.
+struct FakeSICD
+{
+    FakeSICD(six::PixelType pixelType, const types::RowCol<size_t>& dims) :
+        data(six::sicd::Utilities::createFakeComplexData())
+    {
+        data->setPixelType(pixelType);
+        data->setNumRows(dims.row);
+        data->setNumCols(dims.col);
+
+        pixels.resize(dims.area() * data->getNumBytesPerPixel());
+        for (size_t ii = 0; ii < pixels.size(); ++ii)
+        {
+            pixels[ii] = static_cast<six::UByte>(ii * 7);
+        }
+    }
+
+    // The pixels as an array of samples
+    template <typename SampleT>
+    SampleT* getSamples()
+    {
+        return reinterpret_cast<SampleT*>(&pixels[0]);
+    }
+
+    // Writes the SICD to a NITF.  If numRowsPerSegment is nonzero, the image
+    // is split into segments of that many rows.  Any other writer options go
+    // in 'options', and 'threadPool' is given to the writer.
+    void write(const std::string& pathname,
+               size_t numRowsPerSegment = 0,
+               six::Options options = six::Options(),
+               six::ThreadPool* threadPool = NULL) const
+    {
+        six::XMLControlFactory::getInstance().addCreator(
+                six::DataType::COMPLEX,
+                new six::XMLControlCreatorT<six::sicd::ComplexXMLControl>());
+
+        // Segments are only split up once they're too big
+        if (numRowsPerSegment > 0)
+        {
+            options.setParameter(six::NITFHeaderCreator::OPT_MAX_ILOC_ROWS,
+                                 six::Parameter(numRowsPerSegment));
+            options.setParameter(six::NITFHeaderCreator::OPT_MAX_PRODUCT_SIZE,
+                                 six::Parameter(numRowsPerSegment *
+                                                data->getNumCols() *
+                                                data->getNumBytesPerPixel()));
+        }
+
+        mem::SharedPtr<six::Container> container(
+                new six::Container(six::DataType::COMPLEX));
+        container->addData(data->clone());
+        six::NITFWriteControl writer(options, container);
+        writer.setThreadPool(threadPool);
+        writer.save(&pixels[0], pathname);
+    }
+
+    std::auto_ptr<six::sicd::ComplexData> data;
+    std::vector<six::UByte> pixels;
+};
+
 // Note that this will work because SIX is forcing the NITF date/time to match
 // what's in the SICD XML and we're writing the same SICD XML in all our files
 class CompareFiles
@@ -0,0 +1,215 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Compares the allocations and time it takes to write the SICD XML for the
+// DES by building a DOM and printing it, against streaming it straight into
+// the string
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <import/six/sicd.h>
+#include <str/Convert.h>
+#include <sys/StopWatch.h>
+
+namespace
+{
+size_t numAllocations = 0;
+size_t numBytesAllocated = 0;
+}
+
+void* operator new(std::size_t size)
+{
+    ++numAllocations;
+    numBytesAllocated += size;
+    void* const ptr = std::malloc(size ? size : 1);
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) throw()
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) throw()
+{
+    std::free(ptr);
+}
+
+namespace
+{
+// A product with thousands of antenna phase center polynomials, which
+// comes to over 44,000 elements with the default of 2000
+std::auto_ptr<six::sicd::ComplexData> createData(size_t numPolys)
+{
+    std::auto_ptr<six::sicd::ComplexData> data =
+            six::sicd::Utilities::createFakeComplexData();
+    data->setPixelType(six::PixelType::RE32F_IM32F);
+
+    data->position->rcvAPC.reset(new six::sicd::RcvAPC());
+    data->position->rcvAPC->rcvAPCPolys.resize(numPolys, six::PolyXYZ(5));
+    for (size_t ii = 0; ii < numPolys; ++ii)
+    {
+        six::PolyXYZ& poly = data->position->rcvAPC->rcvAPCPolys[ii];
+        for (size_t jj = 0; jj <= poly.order(); ++jj)
+        {
+            poly[jj][0] = 1.0e6 + ii;
+            poly[jj][1] = -2.5e3 * jj;
+            poly[jj][2] = 0.125 / (jj + 1);
+        }
+    }
+    return data;
+}
+
+void printDOM(six::XMLControl& xmlControl,
+              const six::Data& data,
+              std::string& xml)
+{
+    const std::auto_ptr<xml::lite::Document> doc(
+            xmlControl.toXML(&data, std::vector<std::string>()));
+    six::appendXML(*doc->getRootElement(), xml);
+}
+
+void stream(six::XMLControl& xmlControl,
+            const six::Data& data,
+            std::string& xml)
+{
+    xmlControl.toXML(&data, std::vector<std::string>(), xml);
+}
+
+struct Result
+{
+    Result() :
+        allocations(0),
+        bytes(0),
+        millis(0)
+    {
+    }
+
+    size_t allocations;
+    size_t bytes;
+    double millis;
+    std::string xml;
+};
+
+Result run(void (*write)(six::XMLControl&, const six::Data&, std::string&),
+           six::XMLControl& xmlControl,
+           const six::Data& data,
+           size_t numIterations)
+{
+    Result result;
+    sys::RealTimeStopWatch stopWatch;
+    for (size_t ii = 0; ii < numIterations; ++ii)
+    {
+        std::string xml;
+
+        stopWatch.start();
+        const size_t allocationsBefore = numAllocations;
+        const size_t bytesBefore = numBytesAllocated;
+        write(xmlControl, data, xml);
+        result.allocations += numAllocations - allocationsBefore;
+        result.bytes += numBytesAllocated - bytesBefore;
+        result.millis += stopWatch.stop();
+        stopWatch.clear();
+
+        result.xml.swap(xml);
+    }
+
+    result.allocations /= numIterations;
+    result.bytes /= numIterations;
+    result.millis /= numIterations;
+    return result;
+}
+
+void print(const std::string& name, const Result& result)
+{
+    std::cout << name << ": " << result.allocations << " allocations ("
+              << result.bytes / 1024 << " KiB), " << result.millis
+              << " ms per write\n";
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc > 3)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                      << " [number of polys] [number of iterations]\n";
+            return 1;
+        }
+        const size_t numPolys =
+                (argc > 1) ? str::toType<size_t>(argv[1]) : 2000;
+        const size_t numIterations =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 10;
+        if (numIterations == 0)
+        {
+            std::cerr << "Need at least one iteration\n";
+            return 1;
+        }
+
+        const std::auto_ptr<six::sicd::ComplexData> data =
+                createData(numPolys);
+        six::sicd::ComplexXMLControl xmlControl;
+
+        const Result dom = run(printDOM, xmlControl, *data, numIterations);
+        const Result streamed = run(stream, xmlControl, *data, numIterations);
+        if (dom.xml != streamed.xml)
+        {
+            std::cerr << "The streamed XML doesn't match the DOM's\n";
+            return 1;
+        }
+
+        std::cout << dom.xml.size() << " bytes of XML, averaged over "
+                  << numIterations << " writes\n";
+        print("DOM     ", dom);
+        print("Streamed", streamed);
+        return 0;
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << ex.toString() << std::endl;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+    }
+    catch (...)
+    {
+        std::cerr << "Unknown exception\n";
+    }
+    return 1;
+}
@@ -0,0 +1,134 @@
+/* =========================================================================
+* This file is part of six.sicd-c++
+* =========================================================================
+*
+* (C) Copyright 2004 - 2019, MDA Information Systems LLC
+*
+* six.sicd-c++ is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this program; If not,
+* see <http://www.gnu.org/licenses/>.
+*
+*/
+#include <math.h>
+#include <string.h>
+#include <complex>
+#include <vector>
+
+#include <import/six/sicd.h>
+#include <io/TempFile.h>
+#include <six/NITFReadControl.h>
+#include "TestCase.h"
+#include "../tests/TestUtilities.h"
+
+namespace
+{
+std::auto_ptr<six::AmplitudeTable> makeAmplitudeTable()
+{
+    std::auto_ptr<six::AmplitudeTable> table(new six::AmplitudeTable());
+    for (size_t ii = 0; ii < table->numEntries; ++ii)
+    {
+        const double value = ii * 0.5 + 10;
+        memcpy((*table)[ii], &value, sizeof(double));
+    }
+    return table;
+}
+
+std::complex<float> getExpected(double amplitude, size_t phase)
+{
+    const double angle = 2 * M_PI * phase / 256;
+    return std::complex<float>(static_cast<float>(amplitude * cos(angle)),
+                               static_cast<float>(amplitude * sin(angle)));
+}
+
+TEST_CASE(testWithoutAmplitudeTable)
+{
+    const six::sicd::AmplitudePhaseLUT lut(NULL);
+    TEST_ASSERT_EQ(lut(0, 0), std::complex<float>(0, 0));
+    TEST_ASSERT_EQ(lut(3, 0), std::complex<float>(3, 0));
+    TEST_ASSERT_EQ(lut(200, 17), getExpected(200, 17));
+    TEST_ASSERT_EQ(lut(255, 255), getExpected(255, 255));
+}
+
+TEST_CASE(testWithAmplitudeTable)
+{
+    const std::auto_ptr<six::AmplitudeTable> table = makeAmplitudeTable();
+    const six::sicd::AmplitudePhaseLUT lut(table.get());
+    TEST_ASSERT_EQ(lut(0, 0), std::complex<float>(10, 0));
+    TEST_ASSERT_EQ(lut(200, 17), getExpected(110, 17));
+
+    const sys::ubyte input[] = {0, 0, 200, 17, 4, 128};
+    std::complex<float> output[3];
+    lut.convert(input, 3, output);
+    TEST_ASSERT_EQ(output[0], lut(0, 0));
+    TEST_ASSERT_EQ(output[1], lut(200, 17));
+    TEST_ASSERT_EQ(output[2], lut(4, 128));
+}
+
+TEST_CASE(testCache)
+{
+    const std::auto_ptr<six::AmplitudeTable> table = makeAmplitudeTable();
+    const std::auto_ptr<six::AmplitudeTable> copy(table->clone());
+
+    const mem::SharedPtr<const six::sicd::AmplitudePhaseLUT> lut =
+            six::sicd::AmplitudePhaseLUT::get(table.get());
+    TEST_ASSERT_EQ(lut.get(),
+                   six::sicd::AmplitudePhaseLUT::get(copy.get()).get());
+    TEST_ASSERT_TRUE(lut.get() !=
+                     six::sicd::AmplitudePhaseLUT::get(NULL).get());
+}
+
+TEST_CASE(testReadWidebandData)
+{
+    FakeSICD sicd(six::PixelType::AMP8I_PHS8I, types::RowCol<size_t>(40, 30));
+    sicd.data->imageData->amplitudeTable.reset(makeAmplitudeTable().release());
+    const six::sicd::ComplexData* const data = sicd.data.get();
+    const std::vector<six::UByte>& pixels = sicd.pixels;
+    const six::sicd::AmplitudePhaseLUT lut(
+            data->imageData->amplitudeTable.get());
+
+    io::TempFile temp;
+    sicd.write(temp.pathname());
+
+    six::NITFReadControl reader;
+    reader.load(temp.pathname());
+
+    // Read a region that doesn't start at the origin
+    const types::RowCol<size_t> offset(5, 3);
+    const types::RowCol<size_t> extent(30, 20);
+    std::vector<std::complex<float> > buffer;
+    six::sicd::Utilities::getWidebandData(reader, *data, offset, extent,
+                                          buffer);
+    TEST_ASSERT_EQ(buffer.size(), extent.area());
+
+    for (size_t row = 0; row < extent.row; ++row)
+    {
+        for (size_t col = 0; col < extent.col; ++col)
+        {
+            const size_t index =
+                    ((row + offset.row) * data->getNumCols() +
+                     col + offset.col) * 2;
+            TEST_ASSERT_EQ(buffer[row * extent.col + col],
+                           lut(pixels[index], pixels[index + 1]));
+        }
+    }
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testWithoutAmplitudeTable);
+    TEST_CHECK(testWithAmplitudeTable);
+    TEST_CHECK(testCache);
+    TEST_CHECK(testReadWidebandData);
+    return 0;
+}
@@ -0,0 +1,412 @@
+/* =========================================================================
+* This file is part of six.sicd-c++
+* =========================================================================
+*
+* (C) Copyright 2004 - 2019, MDA Information Systems LLC
+*
+* six.sicd-c++ is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this program; If not,
+* see <http://www.gnu.org/licenses/>.
+*
+*/
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <import/six/sicd.h>
+#include <scene/ECEFToLLATransform.h>
+#include "TestCase.h"
+
+namespace
+{
+// More than one block, with a partial block at the end
+const size_t NUM_POINTS = 1000;
+
+std::string findSixHome(const sys::Path& exePath)
+{
+    sys::Path sixHome = exePath.join("..");
+    do
+    {
+        const sys::Path croppedNitfs = sixHome.join("croppedNitfs");
+        if (sys::OS().isDirectory(croppedNitfs.getAbsolutePath()))
+        {
+            return sixHome;
+        }
+        sixHome = sixHome.join("..");
+    } while (sixHome.getAbsolutePath() != sixHome.join("..").getAbsolutePath());
+    return "";
+}
+
+std::auto_ptr<six::sicd::ComplexData> loadComplexData(const sys::Path& exePath)
+{
+    const std::string sixHome = findSixHome(exePath);
+    if (sixHome.empty())
+    {
+        throw except::Exception(Ctxt(
+                "Environment error: Cannot determine source tree root"));
+    }
+
+    const sys::Path sicdPathname = sys::Path(sixHome).
+        join("croppedNitfs").
+        join("SICD").
+        join("cropped_sicd_110.nitf").getAbsolutePath();
+
+    if (!sicdPathname.isFile())
+    {
+        std::ostringstream oss;
+        oss << "Environment error: Cannot find SICD file: " << sicdPathname;
+        throw except::Exception(Ctxt(oss.str()));
+    }
+
+    return six::sicd::Utilities::getComplexData(sicdPathname,
+                                                std::vector<std::string>());
+}
+
+std::auto_ptr<six::sicd::ComplexData> globalData;
+
+// Expected results below were computed a point at a time, before the batch
+// overloads existed.  Each scene point is checked at a handful of indices,
+// which cover the first and last points in each block of 256.
+struct ExpectedScenePoint
+{
+    size_t index;
+    double x;
+    double y;
+    double z;
+    double timeCOA;
+};
+
+// imageToScene() onto the plane through the SCP, normal to its ECEF vector
+const ExpectedScenePoint PLANE_POINTS[] =
+{
+    { 0, 4187163.9899467598, 907564.41662162379, 4709736.7453317968,
+      0.53404056024434199 },
+    { 1, 4187164.0025440459, 907564.29000898905, 4709736.7583671026,
+      0.53404055991318677 },
+    { 39, 4187164.4812398748, 907559.47873952915, 4709737.2537076315,
+      0.53404054732928752 },
+    { 40, 4187164.1490266523, 907564.4182948519, 4709736.6033318946,
+      0.53409657302692126 },
+    { 255, 4187165.133385228, 907562.52747285017, 4709736.0888618724,
+      0.53437663197072938 },
+    { 256, 4187165.1459824904, 907562.40086043044, 4709736.1018971587,
+      0.53437663163945692 },
+    { 257, 4187165.1585797509, 907562.27424802515, 4709736.1149324439,
+      0.53437663130818436 },
+    { 511, 4187166.2894205614, 907560.51171481004, 4709735.4454269856,
+      0.53471270336221144 },
+    { 512, 4187166.3020177977, 907560.38510262058, 4709735.4584622495,
+      0.53471270303082175 },
+    { 600, 4187166.3761452404, 907564.44171921909, 4709734.6153333373,
+      0.5348807519830322 },
+    { 767, 4187167.1006457782, 907563.56212345569, 4709734.1385809472,
+      0.5351048007926662 },
+    { 768, 4187167.1132430453, 907563.4355109199, 4709734.151616252,
+      0.53510480046113951 },
+    { 998, 4187168.2865598639, 907559.64550681878, 4709733.8326753378,
+      0.53538485442453199 },
+    { 999, 4187168.2991570849, 907559.51889472816, 4709733.8457105989,
+      0.53538485409290781 }
+};
+
+// imageToScene() at 100 m above the SCP, with no adjustments
+const ExpectedScenePoint HEIGHT_POINTS[] =
+{
+    { 0, 4187224.236113227, 907495.95872413029, 4709804.0211189762 },
+    { 1, 4187224.2487490885, 907495.83208791923, 4709804.0341975596 },
+    { 39, 4187224.7289092997, 907491.01992407534, 4709804.5311810141 },
+    { 40, 4187224.3958611055, 907495.95969787531, 4709803.8798603369 },
+    { 255, 4187225.3841379364, 907494.06502513308, 4709803.3697454669 },
+    { 256, 4187225.3967737434, 907493.93838916963, 4709803.3828239981 },
+    { 257, 4187225.4094095482, 907493.81175322202, 4709803.3959025247 },
+    { 511, 4187226.5447974005, 907492.04469405417, 4709802.7314494988 },
+    { 512, 4187226.5574331507, 907491.91805835371, 4709802.7445279742 },
+    { 600, 4187226.6323309438, 907495.97333006968, 4709801.9022388337 },
+    { 767, 4187227.3597730496, 907495.09077178163, 4709801.4287539907 },
+    { 768, 4187227.3724088771, 907494.9641356871, 4709801.4418325555 },
+    { 998, 4187228.5502209733, 907491.1699290066, 4709801.1278941585 },
+    { 999, 4187228.5628566928, 907491.04329342127, 4709801.1409726134 }
+};
+
+struct ExpectedImagePoint
+{
+    double x;
+    double y;
+    double z;
+    double row;
+    double col;
+    double timeCOA;
+};
+
+// sceneToImage() of points on the ellipsoid
+const ExpectedImagePoint IMAGE_POINTS[] =
+{
+    { 4186783.7652455191, 907959.53051761014, 4709311.7127919905,
+      -4396.3852792712614, -5499.7638222640053, 0.53404298589172605 },
+    { 4186783.777902971, 907959.40373956901, 4709311.7258935831,
+      -4396.2920073707628, -5499.7638222677306, 0.53404298555959229 },
+    { 4186784.2588837007, 907954.58618630515, 4709312.2237513503,
+      -4392.7476751853537, -5499.7638223785016, 0.53404297294659442 },
+    { 4186783.9249707256, 907959.53149020032, 4709311.5715536606,
+      -4396.3852792695534, -5499.5506037106552, 0.53409899853340725 },
+    { 4186784.913458094, 907957.63468425663, 4709311.0618854603,
+      -4394.9862007671636, -5498.4845109892958, 0.53437905676080399 },
+    { 4186784.9261154933, 907957.50790646544, 4709311.0749869989,
+      -4394.8929288661693, -5498.4845109924026, 0.5343790564287153 },
+    { 4186784.9387728879, 907957.38112868974, 4709311.0880885357,
+      -4394.7996569661991, -5498.4845109974394, 0.53437905609611969 },
+    { 4186786.0743270111, 907955.61207702011, 4709310.4240794769,
+      -4393.4938503649701, -5497.2051997162862, 0.53471512729453052 },
+    { 4186786.0869843531, 907955.485299494, 4709310.4371809606,
+      -4393.4005784652873, -5497.2051997213212, 0.53471512696181833 },
+    { 4186786.1611231677, 907959.54510621424, 4709309.5942164827,
+      -4396.3852792496391, -5496.5655439703733, 0.53488317551521369 },
+    { 4186786.888625741, 907958.66155050299, 4709309.1209739316,
+      -4395.7323759448227, -5495.7126697770564, 0.53510722375598185 },
+    { 4186786.9012831608, 907958.53477258224, 4709309.1340755047,
+      -4395.6391040459639, -5495.7126697787608, 0.53510722342400752 },
+    { 4186788.0796296764, 907954.7363053275, 4709308.8209288968,
+      -4392.8409470498937, -5494.6465771000894, 0.53538727665977459 },
+    { 4186788.0922869891, 907954.60952791839, 4709308.8340303591,
+      -4392.7476751505092, -5494.6465771031144, 0.53538727632735594 }
+};
+
+const double SCENE_TOLERANCE = 1e-6;
+const double IMAGE_TOLERANCE = 1e-6;
+const double TIME_TOLERANCE = 1e-12;
+
+struct Fixture
+{
+    Fixture() :
+        imageGridPoints(NUM_POINTS)
+    {
+        const six::sicd::ComplexData& data(*globalData);
+        six::sicd::Utilities::getModelComponents(data, geometry, model,
+                                                 areaPlane);
+
+        // Spread the points over the whole image
+        const double rowSpacing = data.grid->row->sampleSpacing;
+        const double colSpacing = data.grid->col->sampleSpacing;
+        const types::RowCol<double> scpPixel(data.imageData->scpPixel);
+        for (size_t ii = 0; ii < NUM_POINTS; ++ii)
+        {
+            const double row = (ii % 40) * (data.getNumRows() - 1) / 39.0;
+            const double col = (ii / 40) * (data.getNumCols() - 1) / 24.0;
+            imageGridPoints[ii].row = (row - scpPixel.row) * rowSpacing;
+            imageGridPoints[ii].col = (col - scpPixel.col) * colSpacing;
+        }
+
+        scp = data.geoData->scp.ecf;
+        delta.mParams[scene::AdjustableParams::ARP_RADIAL] = 3;
+        delta.mParams[scene::AdjustableParams::RANGE_BIAS] = -2;
+    }
+
+    std::auto_ptr<scene::SceneGeometry> geometry;
+    std::auto_ptr<scene::ProjectionModel> model;
+    six::sicd::AreaPlane areaPlane;
+    std::vector<types::RowCol<double> > imageGridPoints;
+    scene::Vector3 scp;
+    scene::AdjustableParams delta;
+};
+
+TEST_CASE(testImageToScenePlane)
+{
+    const Fixture fixture;
+    const scene::Vector3 groundRefPoint = fixture.scp;
+    scene::Vector3 groundPlaneNormal = groundRefPoint;
+    groundPlaneNormal.normalize();
+
+    for (size_t numThreads = 1; numThreads <= 4; numThreads += 3)
+    {
+        std::vector<scene::Vector3> scenePoints(NUM_POINTS);
+        std::vector<double> timeCOA(NUM_POINTS);
+        fixture.model->imageToScene(&fixture.imageGridPoints[0], NUM_POINTS,
+                                    groundRefPoint, groundPlaneNormal,
+                                    &scenePoints[0], fixture.delta,
+                                    numThreads, &timeCOA[0]);
+
+        for (size_t ii = 0; ii < sizeof(PLANE_POINTS) /
+                sizeof(PLANE_POINTS[0]); ++ii)
+        {
+            const ExpectedScenePoint& expected(PLANE_POINTS[ii]);
+            const scene::Vector3& actual(scenePoints[expected.index]);
+            TEST_ASSERT_ALMOST_EQ_EPS(actual[0], expected.x, SCENE_TOLERANCE);
+            TEST_ASSERT_ALMOST_EQ_EPS(actual[1], expected.y, SCENE_TOLERANCE);
+            TEST_ASSERT_ALMOST_EQ_EPS(actual[2], expected.z, SCENE_TOLERANCE);
+            TEST_ASSERT_ALMOST_EQ_EPS(timeCOA[expected.index],
+                                      expected.timeCOA, TIME_TOLERANCE);
+        }
+    }
+}
+
+TEST_CASE(testImageToSceneHeight)
+{
+    const Fixture fixture;
+    const double height = scene::ECEFToLLATransform().transform(
+            fixture.scp).getAlt() + 100;
+
+    for (size_t numThreads = 1; numThreads <= 4; numThreads += 3)
+    {
+        std::vector<scene::Vector3> scenePoints(NUM_POINTS);
+        fixture.model->imageToScene(&fixture.imageGridPoints[0], NUM_POINTS,
+                                    height, &scenePoints[0],
+                                    scene::AdjustableParams(), numThreads);
+
+        for (size_t ii = 0; ii < sizeof(HEIGHT_POINTS) /
+                sizeof(HEIGHT_POINTS[0]); ++ii)
+        {
+            const ExpectedScenePoint& expected(HEIGHT_POINTS[ii]);
+            const scene::Vector3& actual(scenePoints[expected.index]);
+            TEST_ASSERT_ALMOST_EQ_EPS(actual[0], expected.x, SCENE_TOLERANCE);
+            TEST_ASSERT_ALMOST_EQ_EPS(actual[1], expected.y, SCENE_TOLERANCE);
+            TEST_ASSERT_ALMOST_EQ_EPS(actual[2], expected.z, SCENE_TOLERANCE);
+        }
+    }
+}
+
+TEST_CASE(testSceneToImage)
+{
+    const Fixture fixture;
+
+    // Repeat the expected points so that they span several blocks
+    const size_t numExpected = sizeof(IMAGE_POINTS) / sizeof(IMAGE_POINTS[0]);
+    std::vector<scene::Vector3> scenePoints(NUM_POINTS);
+    for (size_t ii = 0; ii < NUM_POINTS; ++ii)
+    {
+        const ExpectedImagePoint& expected(IMAGE_POINTS[ii % numExpected]);
+        scenePoints[ii][0] = expected.x;
+        scenePoints[ii][1] = expected.y;
+        scenePoints[ii][2] = expected.z;
+    }
+
+    for (size_t numThreads = 1; numThreads <= 4; numThreads += 3)
+    {
+        std::vector<types::RowCol<double> > imageGridPoints(NUM_POINTS);
+        std::vector<double> timeCOA(NUM_POINTS);
+        fixture.model->sceneToImage(&scenePoints[0], NUM_POINTS,
+                                    &imageGridPoints[0], fixture.delta,
+                                    numThreads, &timeCOA[0]);
+
+        for (size_t ii = 0; ii < NUM_POINTS; ++ii)
+        {
+            const ExpectedImagePoint& expected(
+                    IMAGE_POINTS[ii % numExpected]);
+            TEST_ASSERT_ALMOST_EQ_EPS(imageGridPoints[ii].row, expected.row,
+                                      IMAGE_TOLERANCE);
+            TEST_ASSERT_ALMOST_EQ_EPS(imageGridPoints[ii].col, expected.col,
+                                      IMAGE_TOLERANCE);
+            TEST_ASSERT_ALMOST_EQ_EPS(timeCOA[ii], expected.timeCOA,
+                                      TIME_TOLERANCE);
+        }
+    }
+}
+
+// Checks a model's block contours against its contour for each point
+void checkBlockContours(const std::string& testName,
+                        const scene::ProjectionModel& model,
+                        const Fixture& fixture)
+{
+    const size_t numPoints = 300;
+    std::vector<scene::Vector3> arpCOA(numPoints);
+    std::vector<scene::Vector3> velCOA(numPoints);
+    std::vector<double> timeCOA(numPoints);
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+        timeCOA[ii] = model.computeImageTime(fixture.imageGridPoints[ii]);
+        arpCOA[ii] = model.computeARPPosition(timeCOA[ii]);
+        velCOA[ii] = model.computeARPVelocity(timeCOA[ii]);
+    }
+
+    std::vector<double> r(numPoints);
+    std::vector<double> rDot(numPoints);
+    model.computeContours(&arpCOA[0], &velCOA[0], &timeCOA[0],
+                          &fixture.imageGridPoints[0], numPoints,
+                          &r[0], &rDot[0]);
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+        double expectedR;
+        double expectedRDot;
+        model.computeContour(arpCOA[ii], velCOA[ii], timeCOA[ii],
+                             fixture.imageGridPoints[ii],
+                             &expectedR, &expectedRDot);
+        TEST_ASSERT_ALMOST_EQ_EPS(r[ii], expectedR, SCENE_TOLERANCE);
+        TEST_ASSERT_ALMOST_EQ_EPS(rDot[ii], expectedRDot, SCENE_TOLERANCE);
+    }
+}
+
+TEST_CASE(testBlockContours)
+{
+    const Fixture fixture;
+    const six::sicd::ComplexData& data(*globalData);
+    const scene::Vector3 scp = data.geoData->scp.ecf;
+    const scene::Vector3& rowVector = data.grid->row->unitVector;
+    const scene::Vector3& colVector = data.grid->col->unitVector;
+    const scene::Vector3 slantPlaneNormal =
+            fixture.geometry->getSlantPlaneZ();
+    const int lookDir = (data.scpcoa->sideOfTrack == 1) ? 1 : -1;
+
+    const scene::PlaneProjectionModel plane(
+            slantPlaneNormal, rowVector, colVector, scp,
+            data.position->arpPoly, data.grid->timeCOAPoly, lookDir);
+    checkBlockContours(testName, plane, fixture);
+
+    math::poly::OneD<double> polarAnglePoly(1);
+    polarAnglePoly[0] = 0.1;
+    polarAnglePoly[1] = 0.01;
+    math::poly::OneD<double> ksfPoly(1);
+    ksfPoly[0] = 1.0;
+    ksfPoly[1] = 0.05;
+    const scene::RangeAzimProjectionModel rangeAzim(
+            polarAnglePoly, ksfPoly,
+            slantPlaneNormal, rowVector, colVector, scp,
+            data.position->arpPoly, data.grid->timeCOAPoly, lookDir);
+    checkBlockContours(testName, rangeAzim, fixture);
+}
+
+TEST_CASE(testNoPoints)
+{
+    const Fixture fixture;
+    fixture.model->sceneToImage(NULL, 0, NULL, fixture.delta, 4);
+    fixture.model->imageToScene(NULL, 0, 0.0, NULL);
+    TEST_ASSERT_TRUE(true);
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 0)
+    {
+        std::cerr << "This test makes assumptions about the directory structure."
+            << " Make sure to call with the executable name as argv[0] so "
+            << " we can find the necessary files.\n";
+        return 1;
+    }
+    // Making this global so we don't have to re-read the file every test
+    try
+    {
+        globalData = loadComplexData(std::string(argv[0]));
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << ex.toString() << "\n";
+        return 1;
+    }
+    TEST_CHECK(testImageToScenePlane);
+    TEST_CHECK(testImageToSceneHeight);
+    TEST_CHECK(testSceneToImage);
+    TEST_CHECK(testBlockContours);
+    TEST_CHECK(testNoPoints);
+    return 0;
+}
@@ -0,0 +1,334 @@
+/* =========================================================================
+* This file is part of six.sicd-c++
+* =========================================================================
+*
+* (C) Copyright 2004 - 2019, MDA Information Systems LLC
+*
+* six.sicd-c++ is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this program; If not,
+* see <http://www.gnu.org/licenses/>.
+*
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <import/six/sicd.h>
+#include <io/FileInputStream.h>
+#include <io/StringStream.h>
+#include <logging/NullLogger.h>
+#include <six/sicd/ComplexXMLStreamHandler.h>
+#include "TestCase.h"
+
+namespace
+{
+std::string sampleXMLDir;
+
+std::string findSampleXMLDir(const sys::Path& exePath)
+{
+    sys::Path sixHome = exePath.join("..");
+    do
+    {
+        const sys::Path sampleXML = sixHome.join("six").join("modules").
+                join("c++").join("six.sicd").join("tests").join("sample_xml");
+        if (sys::OS().isDirectory(sampleXML.getAbsolutePath()))
+        {
+            return sampleXML.getAbsolutePath();
+        }
+        sixHome = sixHome.join("..");
+    } while (sixHome.getAbsolutePath() != sixHome.join("..").getAbsolutePath());
+    return "";
+}
+
+void registerComplexXMLControl()
+{
+    six::XMLControlFactory::getInstance().addCreator(
+            six::DataType::COMPLEX,
+            new six::XMLControlCreatorT<six::sicd::ComplexXMLControl>());
+}
+
+std::auto_ptr<six::sicd::ComplexData> parseString(const std::string& xml)
+{
+    io::StringStream stream;
+    stream.write(xml);
+    return six::sicd::ComplexXMLStreamHandler::parse(stream);
+}
+
+std::auto_ptr<six::Data> parseStringWithDOM(const std::string& xml)
+{
+    logging::NullLogger log;
+    return six::parseDataFromString(six::XMLControlFactory::getInstance(),
+                                    xml,
+                                    std::vector<std::string>(),
+                                    log);
+}
+
+// Fake data with every optional part of Position and ErrorStatistics
+std::string createNestedElementsXML(const std::string& version)
+{
+    std::auto_ptr<six::sicd::ComplexData> data =
+            six::sicd::Utilities::createFakeComplexData();
+    data->setPixelType(six::PixelType::RE32F_IM32F);
+    data->setVersion(version);
+
+    data->position->grpPoly = six::PolyXYZ(1);
+    data->position->grpPoly[0] = six::Vector3(1.5);
+    data->position->grpPoly[1][2] = -2.25;
+    data->position->txAPCPoly = six::PolyXYZ(2);
+    data->position->txAPCPoly[2][1] = 1e-7;
+    data->position->rcvAPC.reset(new six::sicd::RcvAPC());
+    data->position->rcvAPC->rcvAPCPolys.resize(2, six::PolyXYZ(1));
+    data->position->rcvAPC->rcvAPCPolys[1][1][0] = 3.5;
+
+    data->errorStatistics.reset(new six::ErrorStatistics());
+    six::ErrorStatistics& errorStatistics(*data->errorStatistics);
+    errorStatistics.compositeSCP.reset(new six::CompositeSCP());
+    errorStatistics.compositeSCP->xErr = 1.25;
+    errorStatistics.compositeSCP->yErr = 2.5;
+    errorStatistics.compositeSCP->xyErr = 0.125;
+
+    errorStatistics.components.reset(new six::Components());
+    six::Components& components(*errorStatistics.components);
+    components.posVelError.reset(new six::PosVelError());
+    components.posVelError->frame = six::FrameType::RIC_ECF;
+    components.posVelError->p1 = 1;
+    components.posVelError->p2 = 2;
+    components.posVelError->p3 = 3;
+    components.posVelError->v1 = 4;
+    components.posVelError->v2 = 5;
+    components.posVelError->v3 = 6;
+    components.posVelError->corrCoefs.reset(new six::CorrCoefs());
+    six::CorrCoefs& corrCoefs(*components.posVelError->corrCoefs);
+    double* const coefs[] =
+    {
+        &corrCoefs.p1p2, &corrCoefs.p1p3, &corrCoefs.p1v1, &corrCoefs.p1v2,
+        &corrCoefs.p1v3, &corrCoefs.p2p3, &corrCoefs.p2v1, &corrCoefs.p2v2,
+        &corrCoefs.p2v3, &corrCoefs.p3v1, &corrCoefs.p3v2, &corrCoefs.p3v3,
+        &corrCoefs.v1v2, &corrCoefs.v1v3, &corrCoefs.v2v3
+    };
+    for (size_t ii = 0; ii < sizeof(coefs) / sizeof(coefs[0]); ++ii)
+    {
+        *coefs[ii] = 0.05 * ii;
+    }
+    components.posVelError->positionDecorr = six::DecorrType(0.5, 0.25);
+
+    components.radarSensor.reset(new six::RadarSensor());
+    components.radarSensor->rangeBias = 0.75;
+    components.radarSensor->clockFreqSF = 1e-6;
+    components.radarSensor->rangeBiasDecorr = six::DecorrType(0.9, 0.1);
+
+    components.tropoError.reset(new six::TropoError());
+    components.tropoError->tropoRangeVertical = 2.5;
+    components.tropoError->tropoRangeDecorr = six::DecorrType(0.8, 0.2);
+
+    components.ionoError.reset(new six::IonoError());
+    components.ionoError->ionoRangeRateVertical = 0.01;
+    components.ionoError->ionoRgRgRateCC = 0.5;
+
+    six::Parameter parameter;
+    parameter.setName("Source");
+    parameter.setValue<std::string>("Test");
+    errorStatistics.additionalParameters.push_back(parameter);
+
+    return six::toXMLString(data.get(),
+                            &six::XMLControlFactory::getInstance());
+}
+
+// Removes the first element named 'name' from the SICD XML
+std::string removeElement(const std::string& xml, const std::string& name)
+{
+    const std::string start = "<" + name + ">";
+    const std::string end = "</" + name + ">";
+    const size_t startPos = xml.find(start);
+    const size_t endPos = xml.find(end, startPos);
+    return xml.substr(0, startPos) + xml.substr(endPos + end.size());
+}
+
+// Repeats the first element named 'name' in the SICD XML
+std::string repeatElement(const std::string& xml, const std::string& name)
+{
+    const std::string start = "<" + name + ">";
+    const std::string end = "</" + name + ">";
+    const size_t startPos = xml.find(start);
+    const size_t endPos = xml.find(end, startPos) + end.size();
+    return xml.substr(0, endPos) + xml.substr(startPos, endPos - startPos) +
+            xml.substr(endPos);
+}
+
+TEST_CASE(testSampleXML)
+{
+    registerComplexXMLControl();
+
+    std::vector<std::string> paths(1, sampleXMLDir);
+    const std::vector<std::string> pathnames =
+            sys::OS().search(paths, "", ".xml", false);
+    TEST_ASSERT_FALSE(pathnames.empty());
+
+    logging::NullLogger log;
+    for (size_t ii = 0; ii < pathnames.size(); ++ii)
+    {
+        const std::auto_ptr<six::Data> expected = six::parseDataFromFile(
+                six::XMLControlFactory::getInstance(),
+                pathnames[ii],
+                std::vector<std::string>(),
+                log);
+
+        io::FileInputStream stream(pathnames[ii]);
+        const std::auto_ptr<six::sicd::ComplexData> actual =
+                six::sicd::ComplexXMLStreamHandler::parse(stream);
+
+        TEST_ASSERT_EQ(actual->getVersion(), expected->getVersion());
+        TEST_ASSERT_TRUE(*actual == *expected);
+    }
+}
+
+TEST_CASE(testRoundTrip)
+{
+    registerComplexXMLControl();
+
+    std::auto_ptr<six::sicd::ComplexData> data =
+            six::sicd::Utilities::createFakeComplexData();
+    data->setPixelType(six::PixelType::RE32F_IM32F);
+    const std::string xml = six::toXMLString(
+            data.get(), &six::XMLControlFactory::getInstance());
+
+    logging::NullLogger log;
+    const std::auto_ptr<six::Data> expected = six::parseDataFromString(
+            six::XMLControlFactory::getInstance(),
+            xml,
+            std::vector<std::string>(),
+            log);
+    const std::auto_ptr<six::sicd::ComplexData> actual = parseString(xml);
+    TEST_ASSERT_TRUE(*actual == *expected);
+
+    // fromXML() only takes optional elements that appear once
+    TEST_ASSERT_TRUE(actual->imageCreation.get() != NULL);
+    TEST_ASSERT_NULL(parseString(
+            repeatElement(xml, "ImageCreation"))->imageCreation.get());
+}
+
+TEST_CASE(testNestedElements)
+{
+    registerComplexXMLControl();
+
+    const char* const versions[] = { "0.5.0", "1.2.0" };
+    for (size_t ii = 0; ii < sizeof(versions) / sizeof(versions[0]); ++ii)
+    {
+        const std::string xml = createNestedElementsXML(versions[ii]);
+
+        std::auto_ptr<six::sicd::ComplexData> actual = parseString(xml);
+        TEST_ASSERT_TRUE(*actual == *parseStringWithDOM(xml));
+        TEST_ASSERT_TRUE(actual->position->rcvAPC.get() != NULL);
+        TEST_ASSERT_EQ(actual->position->rcvAPC->rcvAPCPolys.size(), 2);
+        TEST_ASSERT_TRUE(actual->errorStatistics.get() != NULL);
+        TEST_ASSERT_TRUE(actual->errorStatistics->components.get() != NULL);
+        TEST_ASSERT_TRUE(
+                actual->errorStatistics->components->posVelError.get() !=
+                NULL);
+
+        // Optional elements that are repeated or missing are left out, the
+        // same as fromXML() does
+        const char* const optional[] =
+        {
+            "GRPPoly", "TxAPCPoly", "Components", "CorrCoefs",
+            "PositionDecorr", "ClockFreqSF", "TropoError", "AdditionalParms"
+        };
+        for (size_t jj = 0; jj < sizeof(optional) / sizeof(optional[0]); ++jj)
+        {
+            std::string edited = repeatElement(xml, optional[jj]);
+            actual = parseString(edited);
+            TEST_ASSERT_TRUE(*actual == *parseStringWithDOM(edited));
+
+            edited = removeElement(xml, optional[jj]);
+            actual = parseString(edited);
+            TEST_ASSERT_TRUE(*actual == *parseStringWithDOM(edited));
+        }
+
+        // And required ones that are repeated or missing throw
+        const char* const required[] =
+        {
+            "ARPPoly", "ARPVel", "SlantRange", "P1", "IonoRgRgRateCC"
+        };
+        for (size_t jj = 0; jj < sizeof(required) / sizeof(required[0]); ++jj)
+        {
+            TEST_EXCEPTION(parseString(repeatElement(xml, required[jj])));
+            TEST_EXCEPTION(parseString(removeElement(xml, required[jj])));
+        }
+    }
+
+    TEST_EXCEPTION(parseString(removeElement(
+            createNestedElementsXML("1.2.0"), "LayoverAng")));
+}
+
+TEST_CASE(testParseData)
+{
+    registerComplexXMLControl();
+
+    std::auto_ptr<six::sicd::ComplexData> data =
+            six::sicd::Utilities::createFakeComplexData();
+    data->setPixelType(six::PixelType::RE32F_IM32F);
+    const std::string xml = six::toXMLString(
+            data.get(), &six::XMLControlFactory::getInstance());
+
+    logging::NullLogger log;
+    const std::auto_ptr<six::sicd::ComplexData> actual =
+            six::sicd::Utilities::parseDataFromString(
+                    xml, std::vector<std::string>(), log);
+    TEST_ASSERT_TRUE(*actual == *parseStringWithDOM(xml));
+
+    // The schema paths are still checked
+    TEST_EXCEPTION(six::sicd::Utilities::parseDataFromString(
+            xml, std::vector<std::string>(1, "/does/not/exist"), log));
+}
+
+TEST_CASE(testInvalidXML)
+{
+    registerComplexXMLControl();
+
+    std::auto_ptr<six::sicd::ComplexData> data =
+            six::sicd::Utilities::createFakeComplexData();
+    data->setPixelType(six::PixelType::RE32F_IM32F);
+    const std::string xml = six::toXMLString(
+            data.get(), &six::XMLControlFactory::getInstance());
+
+    TEST_EXCEPTION(parseString(removeElement(xml, "Grid")));
+    TEST_EXCEPTION(parseString(repeatElement(xml, "Timeline")));
+    TEST_EXCEPTION(parseString("<SICD xmlns=\"urn:SICD:9.9.9\"></SICD>"));
+    TEST_EXCEPTION(parseString("<SIDD xmlns=\"urn:SIDD:2.0.0\"></SIDD>"));
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 0)
+    {
+        std::cerr << "This test makes assumptions about the directory structure."
+            << " Make sure to call with the executable name as argv[0] so "
+            << " we can find the necessary files.\n";
+        return 1;
+    }
+
+    sampleXMLDir = findSampleXMLDir(std::string(argv[0]));
+    if (sampleXMLDir.empty())
+    {
+        std::cerr << "Environment error: Cannot find sample_xml\n";
+        return 1;
+    }
+
+    TEST_CHECK(testSampleXML);
+    TEST_CHECK(testRoundTrip);
+    TEST_CHECK(testNestedElements);
+    TEST_CHECK(testParseData);
+    TEST_CHECK(testInvalidXML);
+    return 0;
+}
@@ -0,0 +1,269 @@
+/* =========================================================================
+* This file is part of six.sicd-c++
+* =========================================================================
+*
+* (C) Copyright 2004 - 2019, MDA Information Systems LLC
+*
+* six.sicd-c++ is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this program; If not,
+* see <http://www.gnu.org/licenses/>.
+*
+*/
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+#include <import/six/sicd.h>
+#include <io/TempFile.h>
+#include <six/NITFReadControl.h>
+#include "TestCase.h"
+#include "../tests/TestUtilities.h"
+
+namespace
+{
+const size_t NUM_ROWS = 37;
+const size_t NUM_COLS = 23;
+
+std::complex<float> getPixel(size_t row, size_t col)
+{
+    return std::complex<float>(
+            static_cast<float>(static_cast<short>(row * 1000 - col * 7)),
+            static_cast<float>(static_cast<short>(col * 1300 - row * 11)));
+}
+
+std::auto_ptr<six::sicd::ComplexData> writeInt16SICD(const std::string& pathname)
+{
+    FakeSICD sicd(six::PixelType::RE16I_IM16I,
+                  types::RowCol<size_t>(NUM_ROWS, NUM_COLS));
+    short* const samples = sicd.getSamples<short>();
+    for (size_t row = 0; row < NUM_ROWS; ++row)
+    {
+        for (size_t col = 0; col < NUM_COLS; ++col)
+        {
+            const std::complex<float> pixel = getPixel(row, col);
+            samples[(row * NUM_COLS + col) * 2] =
+                    static_cast<short>(pixel.real());
+            samples[(row * NUM_COLS + col) * 2 + 1] =
+                    static_cast<short>(pixel.imag());
+        }
+    }
+    sicd.write(pathname);
+    return sicd.data;
+}
+
+TEST_CASE(testReadInt16)
+{
+    six::XMLControlFactory::getInstance().addCreator(
+            six::DataType::COMPLEX,
+            new six::XMLControlCreatorT<six::sicd::ComplexXMLControl>());
+
+    io::TempFile temp;
+    const std::auto_ptr<six::sicd::ComplexData> data =
+            writeInt16SICD(temp.pathname());
+
+    six::NITFReadControl reader;
+    reader.load(temp.pathname());
+
+    // A swath smaller than a row, a few rows, and the whole region at once
+    const size_t swathBytes[] = {1, 4 * 3 * NUM_COLS + 5,
+                                 six::sicd::Utilities::DEFAULT_SWATH_BYTES};
+    const types::RowCol<size_t> offsets[] = {
+            types::RowCol<size_t>(0, 0), types::RowCol<size_t>(6, 5)};
+
+    for (size_t ii = 0; ii < sizeof(swathBytes) / sizeof(swathBytes[0]); ++ii)
+    {
+        for (size_t jj = 0; jj < sizeof(offsets) / sizeof(offsets[0]); ++jj)
+        {
+            const types::RowCol<size_t> offset = offsets[jj];
+            const types::RowCol<size_t> extent(NUM_ROWS - offset.row,
+                                               NUM_COLS - offset.col - 1);
+            std::vector<std::complex<float> > buffer;
+            six::sicd::Utilities::getWidebandData(
+                    reader, *data, offset, extent, buffer, swathBytes[ii]);
+            TEST_ASSERT_EQ(buffer.size(), extent.area());
+
+            for (size_t row = 0; row < extent.row; ++row)
+            {
+                for (size_t col = 0; col < extent.col; ++col)
+                {
+                    TEST_ASSERT_EQ(buffer[row * extent.col + col],
+                                   getPixel(row + offset.row,
+                                            col + offset.col));
+                }
+            }
+        }
+    }
+
+    // The pixels can also be converted on the caller's threads
+    six::ThreadPool threadPool(3);
+    const types::RowCol<size_t> extent(NUM_ROWS, NUM_COLS);
+    std::vector<std::complex<float> > buffer(extent.area());
+    six::sicd::Utilities::getWidebandData(
+            reader, *data, types::RowCol<size_t>(0, 0), extent, threadPool,
+            &buffer[0], 4 * 3 * NUM_COLS + 5);
+    for (size_t ii = 0; ii < buffer.size(); ++ii)
+    {
+        TEST_ASSERT_EQ(buffer[ii], getPixel(ii / NUM_COLS, ii % NUM_COLS));
+    }
+}
+
+// Straightforward decimation of a full resolution region
+std::vector<float> decimate(const std::vector<std::complex<float> >& pixels,
+                            const types::RowCol<size_t>& dims,
+                            const six::Decimation& decimation)
+{
+    const types::RowCol<size_t> outputDims =
+            decimation.getDecimatedDims(dims);
+    std::vector<float> output;
+    for (size_t row = 0; row < outputDims.row; ++row)
+    {
+        for (size_t col = 0; col < outputDims.col; ++col)
+        {
+            const size_t firstRow = row * decimation.factor.row;
+            const size_t firstCol = col * decimation.factor.col;
+            const size_t endRow = std::min(firstRow + decimation.factor.row,
+                                           dims.row);
+            const size_t endCol = std::min(firstCol + decimation.factor.col,
+                                           dims.col);
+            double sum = 0;
+            double max = 0;
+            for (size_t ii = firstRow; ii < endRow; ++ii)
+            {
+                for (size_t jj = firstCol; jj < endCol; ++jj)
+                {
+                    const double power = std::norm(pixels[ii * dims.col + jj]);
+                    sum += power;
+                    max = std::max(max, power);
+                }
+            }
+
+            if (decimation.method == six::Decimation::SKIP)
+            {
+                output.push_back(std::norm(
+                        pixels[firstRow * dims.col + firstCol]));
+            }
+            else if (decimation.method == six::Decimation::MAX_POWER)
+            {
+                output.push_back(static_cast<float>(max));
+            }
+            else
+            {
+                output.push_back(static_cast<float>(
+                        sum / ((endRow - firstRow) * (endCol - firstCol))));
+            }
+        }
+    }
+    return output;
+}
+
+TEST_CASE(testReadDecimated)
+{
+    io::TempFile temp;
+    const std::auto_ptr<six::sicd::ComplexData> data =
+            writeInt16SICD(temp.pathname());
+
+    six::NITFReadControl reader;
+    reader.load(temp.pathname());
+
+    const types::RowCol<size_t> offset(2, 3);
+    const types::RowCol<size_t> extent(NUM_ROWS - 2, NUM_COLS - 4);
+    std::vector<std::complex<float> > pixels;
+    six::sicd::Utilities::getWidebandData(reader, *data, offset, extent,
+                                          pixels);
+
+    const six::Decimation::Method methods[] = {
+            six::Decimation::SKIP, six::Decimation::MEAN_POWER,
+            six::Decimation::MAX_POWER};
+    const types::RowCol<size_t> factor(4, 3);
+
+    // A swath of one decimated row, and the whole region at once
+    const size_t swathBytes[] = {1,
+                                 six::sicd::Utilities::DEFAULT_SWATH_BYTES};
+    six::ThreadPool threadPool(2);
+
+    for (size_t ii = 0; ii < sizeof(methods) / sizeof(methods[0]); ++ii)
+    {
+        const six::Decimation decimation(factor, methods[ii]);
+        const std::vector<float> expected =
+                decimate(pixels, extent, decimation);
+        for (size_t jj = 0; jj < sizeof(swathBytes) / sizeof(swathBytes[0]);
+             ++jj)
+        {
+            std::vector<float> buffer;
+            six::sicd::Utilities::getDecimatedWidebandData(
+                    reader, *data, offset, extent, decimation, buffer,
+                    swathBytes[jj]);
+            TEST_ASSERT_EQ(buffer.size(), expected.size());
+            for (size_t kk = 0; kk < buffer.size(); ++kk)
+            {
+                TEST_ASSERT_LESSER_EQ(std::abs(buffer[kk] - expected[kk]),
+                                      expected[kk] * 1e-5f);
+            }
+        }
+
+        // The same, on the caller's threads
+        std::vector<float> buffer(expected.size());
+        six::sicd::Utilities::getDecimatedWidebandData(
+                reader, *data, offset, extent, decimation, threadPool,
+                &buffer[0]);
+        for (size_t kk = 0; kk < buffer.size(); ++kk)
+        {
+            TEST_ASSERT_LESSER_EQ(std::abs(buffer[kk] - expected[kk]),
+                                  expected[kk] * 1e-5f);
+        }
+    }
+
+    // Skipping reads the same pixels out of the NITF
+    six::Region region;
+    region.setStartRow(offset.row);
+    region.setNumRows(extent.row);
+    region.setStartCol(offset.col);
+    region.setNumCols(extent.col);
+    std::vector<short> skipped(
+            six::Decimation(factor).getDecimatedDims(extent).area() * 2);
+    region.setBuffer(reinterpret_cast<six::UByte*>(&skipped[0]));
+    reader.interleavedDecimated(region, 0, factor);
+    TEST_ASSERT_EQ(skipped[2], static_cast<short>(pixels[factor.col].real()));
+    TEST_ASSERT_EQ(skipped[skipped.size() - 1],
+                   static_cast<short>(pixels[(extent.row - 1) / factor.row *
+                                             factor.row * extent.col +
+                                             (extent.col - 1) / factor.col *
+                                             factor.col].imag()));
+}
+
+TEST_CASE(testReadEmptyRegion)
+{
+    io::TempFile temp;
+    const std::auto_ptr<six::sicd::ComplexData> data =
+            writeInt16SICD(temp.pathname());
+
+    six::NITFReadControl reader;
+    reader.load(temp.pathname());
+
+    std::vector<std::complex<float> > buffer;
+    six::sicd::Utilities::getWidebandData(reader,
+                                          *data,
+                                          types::RowCol<size_t>(0, 0),
+                                          types::RowCol<size_t>(0, NUM_COLS),
+                                          buffer);
+    TEST_ASSERT_TRUE(buffer.empty());
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testReadInt16);
+    TEST_CHECK(testReadEmptyRegion);
+    TEST_CHECK(testReadDecimated);
+    return 0;
+}
@@ -0,0 +1,184 @@
+/* =========================================================================
+* This file is part of six.sicd-c++
+* =========================================================================
+*
+* (C) Copyright 2004 - 2019, MDA Information Systems LLC
+*
+* six.sicd-c++ is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this program; If not,
+* see <http://www.gnu.org/licenses/>.
+*
+*/
+#include <string>
+#include <vector>
+
+#include <import/six/sicd.h>
+#include <io/TempFile.h>
+#include <sys/Conf.h>
+#include <six/MappedImageView.h>
+#include <six/NITFReadControl.h>
+#include "TestCase.h"
+#include "../tests/TestUtilities.h"
+
+namespace
+{
+const size_t NUM_ROWS = 37;
+const size_t NUM_COLS = 23;
+
+// Each image is split into three segments
+const size_t NUM_ROWS_PER_SEGMENT = 15;
+
+// Whether the view's rows and native reads match what was written
+bool matchesWrittenPixels(six::PixelType pixelType, size_t elementSize)
+{
+    io::TempFile file;
+    const FakeSICD sicd(pixelType, types::RowCol<size_t>(NUM_ROWS, NUM_COLS));
+    sicd.write(file.pathname(), NUM_ROWS_PER_SEGMENT);
+    const std::vector<six::UByte>& pixels = sicd.pixels;
+
+    six::NITFReadControl reader;
+    reader.load(file.pathname());
+    const six::MappedImageView view(reader, file.pathname());
+
+    const size_t rowSize = NUM_COLS * view.getNumBytesPerPixel();
+    if (view.getNumRows() != NUM_ROWS ||
+        view.getNumCols() != NUM_COLS ||
+        view.getNumSegments() != 3 ||
+        view.getNumBytesPerElement() != elementSize ||
+        view.needsByteSwap() != (elementSize > 1 &&
+                                 !sys::isBigEndianSystem()))
+    {
+        return false;
+    }
+
+    // Mapped rows are big-endian
+    std::vector<six::UByte> expected(pixels);
+    if (!sys::isBigEndianSystem())
+    {
+        sys::byteSwap(&expected[0],
+                      static_cast<unsigned short>(elementSize),
+                      expected.size() / elementSize);
+    }
+    for (size_t row = 0; row < NUM_ROWS; ++row)
+    {
+        if (!std::equal(view.getRow(row), view.getRow(row) + rowSize,
+                        &expected[row * rowSize]))
+        {
+            return false;
+        }
+    }
+
+    std::vector<six::UByte> native(pixels.size());
+    view.readNative(0, NUM_ROWS, 0, NUM_COLS, &native[0]);
+    if (native != pixels)
+    {
+        return false;
+    }
+
+    // A window across the segment boundaries, same as interleaved()
+    const size_t startRow = 10;
+    const size_t numRows = 22;
+    const size_t startCol = 5;
+    const size_t numCols = 11;
+    std::vector<six::UByte> window(
+            numRows * numCols * view.getNumBytesPerPixel());
+    view.readNative(startRow, numRows, startCol, numCols, &window[0]);
+
+    std::vector<six::UByte> interleaved(window.size());
+    six::Region region;
+    region.setStartRow(startRow);
+    region.setNumRows(numRows);
+    region.setStartCol(startCol);
+    region.setNumCols(numCols);
+    region.setBuffer(&interleaved[0]);
+    reader.interleaved(region, 0);
+    return window == interleaved;
+}
+
+TEST_CASE(testPixelTypes)
+{
+    TEST_ASSERT_TRUE(matchesWrittenPixels(six::PixelType::RE32F_IM32F, 4));
+    TEST_ASSERT_TRUE(matchesWrittenPixels(six::PixelType::RE16I_IM16I, 2));
+    TEST_ASSERT_TRUE(matchesWrittenPixels(six::PixelType::AMP8I_PHS8I, 1));
+}
+
+TEST_CASE(testSegments)
+{
+    io::TempFile file;
+    const FakeSICD sicd(six::PixelType::AMP8I_PHS8I,
+                        types::RowCol<size_t>(NUM_ROWS, NUM_COLS));
+    sicd.write(file.pathname(), NUM_ROWS_PER_SEGMENT);
+
+    // Loads its own reader
+    const six::MappedImageView view(file.pathname());
+    TEST_ASSERT_EQ(view.getNumSegments(), static_cast<size_t>(3));
+    TEST_ASSERT_EQ(view.getSegmentForRow(14).firstRow,
+                   static_cast<size_t>(0));
+    TEST_ASSERT_EQ(view.getSegmentForRow(15).firstRow,
+                   static_cast<size_t>(15));
+    TEST_ASSERT_EQ(view.getSegmentForRow(36).firstRow,
+                   static_cast<size_t>(30));
+    TEST_ASSERT_EQ(view.getSegment(2).numRows, static_cast<size_t>(7));
+    TEST_ASSERT_EQ(view.getSegment(1).rowStride, NUM_COLS * 2);
+
+    // Single byte elements are usable as they are
+    TEST_ASSERT_EQ(
+            reinterpret_cast<const six::UByte*>(
+                    view.getRowAs<sys::Uint16_T>(20)),
+            view.getRow(20));
+    TEST_EXCEPTION(view.getRowAs<sys::Uint32_T>(20));
+
+    TEST_EXCEPTION(view.getRow(NUM_ROWS));
+    std::vector<six::UByte> buffer(sicd.pixels.size());
+    TEST_EXCEPTION(view.readNative(1, NUM_ROWS, 0, NUM_COLS, &buffer[0]));
+    TEST_EXCEPTION(view.readNative(0, NUM_ROWS, 1, NUM_COLS, &buffer[0]));
+}
+
+TEST_CASE(testMismatchedFile)
+{
+    const types::RowCol<size_t> dims(NUM_ROWS, NUM_COLS);
+    io::TempFile file;
+    FakeSICD(six::PixelType::RE32F_IM32F, dims).write(file.pathname(),
+                                                      NUM_ROWS_PER_SEGMENT);
+    io::TempFile other;
+    FakeSICD(six::PixelType::AMP8I_PHS8I, dims).write(other.pathname(),
+                                                      NUM_ROWS_PER_SEGMENT);
+
+    six::NITFReadControl reader;
+    reader.load(file.pathname());
+    TEST_EXCEPTION(six::MappedImageView(reader, other.pathname()));
+    TEST_EXCEPTION(six::MappedImageView(reader, file.pathname(), 1));
+
+    // Complex pixels can't be used as they are on a little-endian host
+    const six::MappedImageView view(reader, file.pathname());
+    if (sys::isBigEndianSystem())
+    {
+        TEST_ASSERT_EQ(
+                reinterpret_cast<const six::UByte*>(
+                        view.getRowAs<sys::Uint64_T>(0)),
+                view.getRow(0));
+    }
+    else
+    {
+        TEST_EXCEPTION(view.getRowAs<sys::Uint64_T>(0));
+    }
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testPixelTypes);
+    TEST_CHECK(testSegments);
+    TEST_CHECK(testMismatchedFile);
+    return 0;
+}
@@ -0,0 +1,228 @@
+/* =========================================================================
+* This file is part of six.sicd-c++
+* =========================================================================
+*
+* (C) Copyright 2004 - 2019, MDA Information Systems LLC
+*
+* six.sicd-c++ is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this program; If not,
+* see <http://www.gnu.org/licenses/>.
+*
+*/
+#include <vector>
+
+#include <import/six/sicd.h>
+#include <io/TempFile.h>
+#include <mt/Runnable1D.h>
+#include <six/NITFBlockCache.h>
+#include <six/NITFReadControl.h>
+#include "TestCase.h"
+#include "../tests/TestUtilities.h"
+
+namespace
+{
+const size_t NUM_ROWS = 37;
+const size_t NUM_COLS = 23;
+
+six::NITFBlockCache::Block makeBlock(size_t numBytes, six::UByte value)
+{
+    return six::NITFBlockCache::Block(
+            new std::vector<six::UByte>(numBytes, value));
+}
+
+// Writes a SICD split into several image segments
+void writeSICD(const std::string& pathname, std::vector<float>& pixels)
+{
+    FakeSICD sicd(six::PixelType::RE32F_IM32F,
+                  types::RowCol<size_t>(NUM_ROWS, NUM_COLS));
+    float* const samples = sicd.getSamples<float>();
+    pixels.resize(NUM_ROWS * NUM_COLS * 2);
+    for (size_t ii = 0; ii < pixels.size(); ++ii)
+    {
+        pixels[ii] = samples[ii] = static_cast<float>(ii);
+    }
+    sicd.write(pathname, 15);
+}
+
+void read(six::NITFReadControl& reader,
+          size_t startRow,
+          size_t numRows,
+          size_t startCol,
+          size_t numCols,
+          std::vector<float>& buffer)
+{
+    buffer.resize(numRows * numCols * 2);
+    six::Region region;
+    region.setStartRow(startRow);
+    region.setNumRows(numRows);
+    region.setStartCol(startCol);
+    region.setNumCols(numCols);
+    region.setBuffer(reinterpret_cast<six::UByte*>(&buffer[0]));
+    reader.interleaved(region, 0);
+}
+
+bool matches(const std::vector<float>& pixels,
+             const std::vector<float>& buffer,
+             size_t startRow,
+             size_t numRows,
+             size_t startCol,
+             size_t numCols)
+{
+    for (size_t row = 0; row < numRows; ++row)
+    {
+        for (size_t col = 0; col < numCols; ++col)
+        {
+            const size_t pixelIdx =
+                    ((row + startRow) * NUM_COLS + col + startCol) * 2;
+            const size_t bufferIdx = (row * numCols + col) * 2;
+            if (buffer[bufferIdx] != pixels[pixelIdx] ||
+                buffer[bufferIdx + 1] != pixels[pixelIdx + 1])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+class ReadWindow
+{
+public:
+    ReadWindow(six::NITFReadControl& reader,
+               const std::vector<float>& pixels,
+               std::vector<char>& results) :
+        mReader(reader),
+        mPixels(pixels),
+        mResults(results)
+    {
+    }
+
+    void operator()(size_t window) const
+    {
+        const size_t startRow = window % 20;
+        const size_t startCol = (window * 3) % 10;
+        std::vector<float> buffer;
+        read(mReader, startRow, 17, startCol, 13, buffer);
+        mResults[window] =
+                matches(mPixels, buffer, startRow, 17, startCol, 13);
+    }
+
+private:
+    six::NITFReadControl& mReader;
+    const std::vector<float>& mPixels;
+    std::vector<char>& mResults;
+};
+
+TEST_CASE(testLRU)
+{
+    six::NITFBlockCache cache(100);
+    const six::NITFBlockCache::Key key0(0, 0, 0);
+    const six::NITFBlockCache::Key key1(0, 0, 1);
+    const six::NITFBlockCache::Key key2(1, 0, 0);
+
+    TEST_ASSERT_NULL(cache.get(key0).get());
+    cache.put(key0, makeBlock(40, 0));
+    cache.put(key1, makeBlock(40, 1));
+    TEST_ASSERT_EQ(cache.getNumBytes(), static_cast<size_t>(80));
+
+    // key0 is now the most recently used, so key1 is evicted
+    TEST_ASSERT_EQ((*cache.get(key0))[0], 0);
+    cache.put(key2, makeBlock(40, 2));
+    TEST_ASSERT_EQ(cache.getNumBytes(), static_cast<size_t>(80));
+    TEST_ASSERT_NULL(cache.get(key1).get());
+    TEST_ASSERT_EQ((*cache.get(key2))[0], 2);
+
+    // Too big to keep at all
+    cache.put(key1, makeBlock(101, 1));
+    TEST_ASSERT_NULL(cache.peek(key1).get());
+
+    TEST_ASSERT_EQ(cache.getNumHits(), static_cast<size_t>(2));
+    TEST_ASSERT_EQ(cache.getNumMisses(), static_cast<size_t>(2));
+
+    cache.clear();
+    TEST_ASSERT_EQ(cache.getNumBytes(), static_cast<size_t>(0));
+    TEST_ASSERT_NULL(cache.peek(key0).get());
+}
+
+TEST_CASE(testCachedRead)
+{
+    six::XMLControlFactory::getInstance().addCreator(
+            six::DataType::COMPLEX,
+            new six::XMLControlCreatorT<six::sicd::ComplexXMLControl>());
+
+    io::TempFile temp;
+    std::vector<float> pixels;
+    writeSICD(temp.pathname(), pixels);
+
+    six::NITFReadControl reader;
+    reader.load(temp.pathname());
+    TEST_ASSERT_EQ(reader.getContainer()->getData(0)->getNumRows(), NUM_ROWS);
+    TEST_ASSERT_NULL(reader.getBlockCache());
+    reader.enableBlockCache(1024 * 1024, types::RowCol<size_t>(8, 6));
+    TEST_ASSERT(reader.getBlockCache() != NULL);
+
+    // Crosses segment and tile boundaries
+    std::vector<float> buffer;
+    read(reader, 3, 30, 2, 19, buffer);
+    TEST_ASSERT(matches(pixels, buffer, 3, 30, 2, 19));
+    const size_t numMisses = reader.getBlockCache()->getNumMisses();
+    TEST_ASSERT(numMisses > 0);
+    TEST_ASSERT_EQ(reader.getBlockCache()->getNumHits(),
+                   static_cast<size_t>(0));
+
+    // An overlapping window is served entirely from the cache
+    read(reader, 5, 20, 4, 10, buffer);
+    TEST_ASSERT(matches(pixels, buffer, 5, 20, 4, 10));
+    TEST_ASSERT_EQ(reader.getBlockCache()->getNumMisses(), numMisses);
+    TEST_ASSERT(reader.getBlockCache()->getNumHits() > 0);
+
+    // The whole image, including the partial tiles along the edges
+    read(reader, 0, NUM_ROWS, 0, NUM_COLS, buffer);
+    TEST_ASSERT(matches(pixels, buffer, 0, NUM_ROWS, 0, NUM_COLS));
+
+    reader.disableBlockCache();
+    TEST_ASSERT_NULL(reader.getBlockCache());
+    read(reader, 3, 30, 2, 19, buffer);
+    TEST_ASSERT(matches(pixels, buffer, 3, 30, 2, 19));
+}
+
+TEST_CASE(testConcurrentCachedRead)
+{
+    io::TempFile temp;
+    std::vector<float> pixels;
+    writeSICD(temp.pathname(), pixels);
+
+    six::NITFReadControl reader;
+    reader.load(temp.pathname());
+
+    // Small enough that blocks get evicted while other threads use them
+    reader.enableBlockCache(4 * 8 * 6 * sizeof(float) * 2,
+                            types::RowCol<size_t>(8, 6));
+
+    const size_t numWindows = 64;
+    std::vector<char> results(numWindows, 0);
+    mt::run1D(numWindows, 4, ReadWindow(reader, pixels, results));
+    for (size_t ii = 0; ii < numWindows; ++ii)
+    {
+        TEST_ASSERT(results[ii]);
+    }
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testLRU);
+    TEST_CHECK(testCachedRead);
+    TEST_CHECK(testConcurrentCachedRead);
+    return 0;
+}
@@ -0,0 +1,119 @@
+/* =========================================================================
+* This file is part of six.sicd-c++
+* =========================================================================
+*
+* (C) Copyright 2004 - 2019, MDA Information Systems LLC
+*
+* six.sicd-c++ is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this program; If not,
+* see <http://www.gnu.org/licenses/>.
+*
+*/
+#include <string>
+#include <vector>
+
+#include <import/six/sicd.h>
+#include <io/TempFile.h>
+#include <sys/File.h>
+#include "TestCase.h"
+#include "../tests/TestUtilities.h"
+
+namespace
+{
+const size_t NUM_ROWS = 37;
+const size_t NUM_COLS = 23;
+
+std::vector<sys::byte> readFile(const std::string& pathname)
+{
+    sys::File file(pathname);
+    std::vector<sys::byte> contents(static_cast<size_t>(file.length()));
+    if (!contents.empty())
+    {
+        file.readInto(&contents[0], contents.size());
+    }
+    return contents;
+}
+
+// Whether writing in parallel gives exactly the same file as writing
+// serially
+bool matchesSerialWrite(six::PixelType pixelType,
+                        size_t numThreads,
+                        size_t bufferSize,
+                        six::ThreadPool* threadPool = NULL)
+{
+    const FakeSICD sicd(pixelType, types::RowCol<size_t>(NUM_ROWS, NUM_COLS));
+    six::Options options;
+    options.setParameter(six::WriteControl::OPT_BUFFER_SIZE,
+                         six::Parameter(bufferSize));
+
+    io::TempFile serial;
+    options.setParameter(six::NITFWriteControl::OPT_NUM_WRITE_THREADS,
+                         six::Parameter(1));
+    sicd.write(serial.pathname(), 15, options);
+
+    io::TempFile parallel;
+    options.setParameter(six::NITFWriteControl::OPT_NUM_WRITE_THREADS,
+                         six::Parameter(numThreads));
+    sicd.write(parallel.pathname(), 15, options, threadPool);
+
+    // The caller's pixels are left alone
+    const FakeSICD original(pixelType,
+                            types::RowCol<size_t>(NUM_ROWS, NUM_COLS));
+    return sicd.pixels == original.pixels &&
+            readFile(serial.pathname()) == readFile(parallel.pathname());
+}
+
+TEST_CASE(testMultipleSegments)
+{
+    TEST_ASSERT_TRUE(matchesSerialWrite(six::PixelType::RE32F_IM32F,
+                                        4, 1024 * 1024));
+    TEST_ASSERT_TRUE(matchesSerialWrite(six::PixelType::RE16I_IM16I,
+                                        3, 1024 * 1024));
+    TEST_ASSERT_TRUE(matchesSerialWrite(six::PixelType::AMP8I_PHS8I,
+                                        2, 1024 * 1024));
+}
+
+TEST_CASE(testSmallBuffer)
+{
+    // A row at a time, and less than a row
+    TEST_ASSERT_TRUE(matchesSerialWrite(six::PixelType::RE32F_IM32F,
+                                        4, NUM_COLS * 8));
+    TEST_ASSERT_TRUE(matchesSerialWrite(six::PixelType::RE32F_IM32F,
+                                        4, 1));
+}
+
+TEST_CASE(testAllCPUs)
+{
+    TEST_ASSERT_TRUE(matchesSerialWrite(six::PixelType::RE32F_IM32F,
+                                        0, 1024 * 1024));
+}
+
+TEST_CASE(testSharedThreadPool)
+{
+    // The pool takes the place of the number of threads
+    six::ThreadPool threadPool(3);
+    TEST_ASSERT_TRUE(matchesSerialWrite(six::PixelType::RE16I_IM16I,
+                                        1, 1024 * 1024, &threadPool));
+    TEST_ASSERT_TRUE(matchesSerialWrite(six::PixelType::RE32F_IM32F,
+                                        1, NUM_COLS * 8, &threadPool));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testMultipleSegments);
+    TEST_CHECK(testSmallBuffer);
+    TEST_CHECK(testAllCPUs);
+    TEST_CHECK(testSharedThreadPool);
+    return 0;
+}
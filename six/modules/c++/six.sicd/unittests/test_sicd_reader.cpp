@@ -0,0 +1,171 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <complex>
+#include <vector>
+
+#include <import/six/sicd.h>
+#include <io/TempFile.h>
+#include <mt/Runnable1D.h>
+#include "TestCase.h"
+#include "../tests/TestUtilities.h"
+
+namespace
+{
+const size_t NUM_ROWS = 41;
+const size_t NUM_COLS = 29;
+
+std::complex<float> getPixel(size_t row, size_t col)
+{
+    return std::complex<float>(
+            static_cast<float>(static_cast<short>(row * 700 - col * 3)),
+            static_cast<float>(static_cast<short>(col * 900 - row * 13)));
+}
+
+void writeInt16SICD(const std::string& pathname)
+{
+    FakeSICD sicd(six::PixelType::RE16I_IM16I,
+                  types::RowCol<size_t>(NUM_ROWS, NUM_COLS));
+    short* const samples = sicd.getSamples<short>();
+    for (size_t row = 0; row < NUM_ROWS; ++row)
+    {
+        for (size_t col = 0; col < NUM_COLS; ++col)
+        {
+            const std::complex<float> pixel = getPixel(row, col);
+            samples[(row * NUM_COLS + col) * 2] =
+                    static_cast<short>(pixel.real());
+            samples[(row * NUM_COLS + col) * 2 + 1] =
+                    static_cast<short>(pixel.imag());
+        }
+    }
+    sicd.write(pathname);
+}
+
+bool matches(const std::vector<std::complex<float> >& buffer,
+             const types::RowCol<size_t>& offset,
+             const types::RowCol<size_t>& extent)
+{
+    for (size_t row = 0; row < extent.row; ++row)
+    {
+        for (size_t col = 0; col < extent.col; ++col)
+        {
+            if (buffer[row * extent.col + col] !=
+                getPixel(row + offset.row, col + offset.col))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+class ReadChip
+{
+public:
+    ReadChip(six::sicd::SICDReader& reader, std::vector<char>& results) :
+        mReader(reader),
+        mResults(results)
+    {
+    }
+
+    void operator()(size_t chip) const
+    {
+        const types::RowCol<size_t> offset(chip % 25, (chip * 7) % 13);
+        const types::RowCol<size_t> extent(16, 15);
+        std::vector<std::complex<float> > buffer(extent.area());
+        mReader.readRegion(offset, extent, &buffer[0]);
+        mResults[chip] = matches(buffer, offset, extent);
+    }
+
+private:
+    six::sicd::SICDReader& mReader;
+    std::vector<char>& mResults;
+};
+
+TEST_CASE(testReadRegions)
+{
+    io::TempFile temp;
+    writeInt16SICD(temp.pathname());
+
+    six::sicd::SICDReader reader(temp.pathname());
+    TEST_ASSERT_EQ(reader.getDims().row, NUM_ROWS);
+    TEST_ASSERT_EQ(reader.getDims().col, NUM_COLS);
+    TEST_ASSERT_EQ(reader.getComplexData().getPixelType(),
+                   six::PixelType::RE16I_IM16I);
+
+    // Many regions from the one open file, and the whole image
+    for (size_t ii = 0; ii < 10; ++ii)
+    {
+        const types::RowCol<size_t> offset(ii * 3, ii * 2);
+        const types::RowCol<size_t> extent(NUM_ROWS - offset.row - ii,
+                                           NUM_COLS - offset.col);
+        std::vector<std::complex<float> > buffer(extent.area());
+        reader.readRegion(offset, extent, &buffer[0], 5 * NUM_COLS * 4);
+        TEST_ASSERT_TRUE(matches(buffer, offset, extent));
+    }
+    std::vector<std::complex<float> > buffer(NUM_ROWS * NUM_COLS);
+    reader.readRegion(types::RowCol<size_t>(0, 0),
+                      reader.getDims(),
+                      &buffer[0]);
+    TEST_ASSERT_TRUE(
+            matches(buffer, types::RowCol<size_t>(0, 0), reader.getDims()));
+
+    // Empty regions read nothing, and regions past the edges throw
+    reader.readRegion(types::RowCol<size_t>(NUM_ROWS, 0),
+                      types::RowCol<size_t>(0, NUM_COLS),
+                      NULL);
+    TEST_EXCEPTION(reader.readRegion(types::RowCol<size_t>(1, 0),
+                                     reader.getDims(),
+                                     &buffer[0]));
+    TEST_EXCEPTION(reader.readRegion(types::RowCol<size_t>(0, NUM_COLS),
+                                     types::RowCol<size_t>(1, 1),
+                                     &buffer[0]));
+}
+
+TEST_CASE(testConcurrentReads)
+{
+    io::TempFile temp;
+    writeInt16SICD(temp.pathname());
+
+    // Serialized without a cache, and through the cache with one
+    const size_t cacheBytes[] = {0, 16 * 1024};
+    for (size_t ii = 0; ii < sizeof(cacheBytes) / sizeof(cacheBytes[0]); ++ii)
+    {
+        six::sicd::SICDReader reader(temp.pathname(),
+                                     std::vector<std::string>(),
+                                     cacheBytes[ii]);
+        const size_t numChips = 48;
+        std::vector<char> results(numChips, 0);
+        mt::run1D(numChips, 4, ReadChip(reader, results));
+        for (size_t chip = 0; chip < numChips; ++chip)
+        {
+            TEST_ASSERT_TRUE(results[chip]);
+        }
+    }
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testReadRegions);
+    TEST_CHECK(testConcurrentReads);
+    return 0;
+}
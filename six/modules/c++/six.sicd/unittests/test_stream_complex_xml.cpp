@@ -0,0 +1,173 @@
+/* =========================================================================
+* This file is part of six.sicd-c++
+* =========================================================================
+*
+* (C) Copyright 2004 - 2019, MDA Information Systems LLC
+*
+* six.sicd-c++ is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this program; If not,
+* see <http://www.gnu.org/licenses/>.
+*
+*/
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <import/six/sicd.h>
+#include <logging/NullLogger.h>
+#include "TestCase.h"
+
+namespace
+{
+std::string sampleXMLDir;
+
+std::string findSampleXMLDir(const sys::Path& exePath)
+{
+    sys::Path sixHome = exePath.join("..");
+    do
+    {
+        const sys::Path sampleXML = sixHome.join("six").join("modules").
+                join("c++").join("six.sicd").join("tests").join("sample_xml");
+        if (sys::OS().isDirectory(sampleXML.getAbsolutePath()))
+        {
+            return sampleXML.getAbsolutePath();
+        }
+        sixHome = sixHome.join("..");
+    } while (sixHome.getAbsolutePath() != sixHome.join("..").getAbsolutePath());
+    return "";
+}
+
+// What the XML was before it was streamed
+std::string printDOM(const six::Data& data)
+{
+    six::sicd::ComplexXMLControl xmlControl;
+    const std::auto_ptr<xml::lite::Document> doc(
+            xmlControl.toXML(&data, std::vector<std::string>()));
+
+    std::string xml;
+    six::appendXML(*doc->getRootElement(), xml);
+    return xml;
+}
+
+std::string stream(const six::Data& data)
+{
+    six::sicd::ComplexXMLControl xmlControl;
+    std::string xml;
+    xmlControl.toXML(&data, std::vector<std::string>(), xml);
+    return xml;
+}
+
+std::auto_ptr<six::sicd::ComplexData> createData(const std::string& version)
+{
+    std::auto_ptr<six::sicd::ComplexData> data =
+            six::sicd::Utilities::createFakeComplexData();
+    data->setPixelType(six::PixelType::RE32F_IM32F);
+    data->setVersion(version);
+
+    data->position->rcvAPC.reset(new six::sicd::RcvAPC());
+    data->position->rcvAPC->rcvAPCPolys.resize(2, six::PolyXYZ(1));
+    data->position->rcvAPC->rcvAPCPolys[1][1][0] = 3.5;
+
+    data->errorStatistics.reset(new six::ErrorStatistics());
+    data->errorStatistics->compositeSCP.reset(new six::CompositeSCP());
+    data->errorStatistics->compositeSCP->xErr = 1.25;
+    data->errorStatistics->compositeSCP->yErr = 2.5;
+    data->errorStatistics->compositeSCP->xyErr = 0.125;
+
+    six::Parameter parameter;
+    parameter.setName("Source");
+    parameter.setValue<std::string>("Test");
+    data->errorStatistics->additionalParameters.push_back(parameter);
+    return data;
+}
+
+TEST_CASE(testFakeData)
+{
+    const char* const versions[] =
+    {
+        "0.4.0", "0.4.1", "0.5.0", "1.0.0", "1.0.1", "1.1.0", "1.2.0", "1.2.1"
+    };
+    for (size_t ii = 0; ii < sizeof(versions) / sizeof(versions[0]); ++ii)
+    {
+        const std::auto_ptr<six::sicd::ComplexData> data =
+                createData(versions[ii]);
+        const std::string expected = printDOM(*data);
+        TEST_ASSERT_EQ(stream(*data), expected);
+    }
+}
+
+TEST_CASE(testSampleXML)
+{
+    const std::vector<std::string> files =
+            sys::OS().search(std::vector<std::string>(1, sampleXMLDir),
+                             "", ".xml", false);
+    TEST_ASSERT_FALSE(files.empty());
+
+    logging::NullLogger log;
+    for (size_t ii = 0; ii < files.size(); ++ii)
+    {
+        const std::auto_ptr<six::Data> data = six::parseDataFromFile(
+                six::XMLControlFactory::getInstance(),
+                files[ii],
+                std::vector<std::string>(),
+                log);
+
+        const std::string expected = printDOM(*data);
+        TEST_ASSERT_EQ(stream(*data), expected);
+    }
+}
+
+TEST_CASE(testParserStillBuildsDOM)
+{
+    const std::auto_ptr<six::sicd::ComplexData> data = createData("1.2.1");
+    six::sicd::ComplexXMLControl xmlControl;
+    std::auto_ptr<six::sicd::ComplexXMLParser> parser =
+            xmlControl.getParser(data->getVersion());
+
+    std::string xml("<?xml version=\"1.0\"?>");
+    parser->toXML(data.get(), xml);
+
+    const std::auto_ptr<xml::lite::Document> doc(parser->toXML(data.get()));
+    std::string domXML;
+    six::appendXML(*doc->getRootElement(), domXML);
+    TEST_ASSERT_EQ(xml, "<?xml version=\"1.0\"?>" + domXML);
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 0)
+    {
+        std::cerr << "This test makes assumptions about the directory structure."
+            << " Make sure to call with the executable name as argv[0] so "
+            << " we can find the necessary files.\n";
+        return 1;
+    }
+
+    sampleXMLDir = findSampleXMLDir(std::string(argv[0]));
+    if (sampleXMLDir.empty())
+    {
+        std::cerr << "Environment error: Cannot find sample_xml\n";
+        return 1;
+    }
+
+    six::XMLControlFactory::getInstance().addCreator(
+            six::DataType::COMPLEX,
+            new six::XMLControlCreatorT<six::sicd::ComplexXMLControl>());
+
+    TEST_CHECK(testFakeData);
+    TEST_CHECK(testSampleXML);
+    TEST_CHECK(testParserStillBuildsDOM);
+    return 0;
+}
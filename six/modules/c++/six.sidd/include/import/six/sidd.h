@@ -32,12 +32,17 @@
 #include "six/sidd/DerivedXMLControl.h"
 #include "six/sidd/Display.h"
 #include "six/sidd/DownstreamReprocessing.h"
+#include "six/sidd/DynamicRangeAdjuster.h"
 #include "six/sidd/ExploitationFeatures.h"
 #include "six/sidd/GeographicAndTarget.h"
 #include "six/sidd/GeoTIFFReadControl.h"
 #include "six/sidd/GeoTIFFWriteControl.h"
+#include "six/sidd/ImageFilter.h"
 #include "six/sidd/ProductCreation.h"
 #include "six/sidd/ProductProcessing.h"
+#include "six/sidd/RRDSBuilder.h"
+#include "six/sidd/RRDSReader.h"
+#include "six/sidd/RRDSWriter.h"
 #include "six/sidd/SFA.h"
 #include "six/sidd/Utilities.h"
 
@@ -48,6 +48,13 @@ protected:
      *  Returns a new allocated DOM document, created from the DerivedData*
      */
     virtual xml::lite::Document* toXMLImpl(const Data* data);
+
+    /*!
+     *  Writes the XML for the DerivedData* onto the end of xml, without
+     *  building a DOM
+     */
+    virtual void toXMLImpl(const Data* data, std::string& xml);
+
     /*!
      *  Returns a new allocated DerivedData*, created from the DOM Document*
      *
@@ -39,11 +39,31 @@ public:
                      logging::Logger* log = NULL,
                      bool ownLog = false);
 
-    virtual xml::lite::Document* toXML(const DerivedData* data) const = 0;
+    xml::lite::Document* toXML(const DerivedData* data) const;
+
+    /*!
+     *  Write the SIDD XML for data onto the end of xml.  This is the same
+     *  XML as printing the Document that toXML() returns, but each element
+     *  is written as soon as it's complete, so the Document is never built.
+     *  If the data can't be converted, xml is left as it was.
+     *
+     *  \param data The data to convert
+     *  \param[in,out] xml The XML is appended to this
+     */
+    void toXML(const DerivedData* data, std::string& xml);
 
     virtual DerivedData* fromXML(const xml::lite::Document* doc) const = 0;
 
+    virtual void setStreamWriter(XMLStreamWriter* writer);
+
 protected:
+    //! Add the elements under the SIDD root element
+    virtual void convertSectionsToXML(const DerivedData* data,
+                                      XMLElem root) const = 0;
+
+    //! Set the namespace prefixes on the SIDD root element
+    virtual void setNamespaces(XMLElem root) const = 0;
+
     virtual void parseDerivedClassificationFromXML(
             const XMLElem classificationElem,
             DerivedClassification& classification) const;
@@ -36,11 +36,14 @@ public:
     DerivedXMLParser200(logging::Logger* log = NULL,
                         bool ownLog = false);
 
-    virtual xml::lite::Document* toXML(const DerivedData* data) const;
-
     virtual DerivedData* fromXML(const xml::lite::Document* doc) const;
 
 protected:
+    virtual void convertSectionsToXML(const DerivedData* data,
+                                      XMLElem root) const;
+
+    virtual void setNamespaces(XMLElem root) const;
+
     virtual void parseDerivedClassificationFromXML(
             const XMLElem classificationElem,
             DerivedClassification& classification) const;
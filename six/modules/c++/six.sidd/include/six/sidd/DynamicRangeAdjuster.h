@@ -0,0 +1,368 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_SIDD_DYNAMIC_RANGE_ADJUSTER_H__
+#define __SIX_SIDD_DYNAMIC_RANGE_ADJUSTER_H__
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+#include <six/ReadControl.h>
+#include <six/ThreadPool.h>
+#include <six/Types.h>
+#include <six/sidd/DerivedData.h>
+#include <six/sidd/Display.h>
+#include <types/RowCol.h>
+
+namespace six
+{
+namespace sidd
+{
+/*!
+ * \class DynamicRangeAdjuster
+ * \brief Carries out the dynamic range adjustment (DRA) described by a SIDD
+ * 2.0 DynamicRangeAdjustment, remapping pixels to 8 bits for display
+ *
+ * The remap is linear with clipping:
+ *     output = clamp((input - subtractor) * multiplier, 0, 255)
+ * where the subtractor and multiplier are a DRAOverrides.  How they're
+ * chosen depends on the algorithm type:
+ * - MANUAL uses the DRAOverrides as given
+ * - NONE uses a subtractor of 0 and a multiplier of 1
+ * - AUTO computes a histogram of band bandStatsSource of the image.  The
+ *   pixel values at the pMin and pMax cumulative histogram fractions
+ *   (Pmin and Pmax) are pushed towards the smallest and largest pixel
+ *   values (Min and Max) by the modifiers:
+ *       Emin = Pmin - eMinModifier * (Pmin - Min)
+ *       Emax = Pmax + eMaxModifier * (Max - Pmax)
+ *   The subtractor is then Emin, and the multiplier maps Emax to 255.
+ *
+ * SIDD pixels may be MONO8I, MONO16I (in native byte order), or RGB24I,
+ * in which case every band is remapped the same way.  Complex SICD pixels
+ * are detected (the amplitude is taken) as they're read, and their histogram
+ * has 65536 bins starting at zero.  The bins are a power of two wide, just
+ * wide enough to hold the largest amplitude.
+ *
+ * Statistics can be computed from the whole image at once, or built up a
+ * swath at a time with addRows() and finishStatistics(), so that the image
+ * never has to be in memory all at once.  Either way gives the same result.
+ *
+ * Both the histogram and the remap are split by rows across a pool of
+ * threads, which is either passed in or started by the adjuster.  Integer
+ * pixels are remapped through a lookup table, and complex pixels through a
+ * branchless loop the compiler can vectorize.
+ */
+class DynamicRangeAdjuster
+{
+public:
+    //! Pixel values found by finishStatistics()
+    struct Statistics
+    {
+        Statistics();
+
+        //! Smallest and largest pixel values
+        double minValue;
+        double maxValue;
+
+        //! Pixel values at the pMin and pMax histogram fractions
+        double pMinValue;
+        double pMaxValue;
+    };
+
+    /*!
+     * \param dra The DRA to carry out
+     * \param numThreads Number of threads to use.  Defaults to 0, which means
+     * one per CPU.
+     *
+     * \throws except::Exception If the algorithm type isn't set, or the
+     * parameters it needs are missing or out of range
+     */
+    DynamicRangeAdjuster(const DynamicRangeAdjustment& dra,
+                         size_t numThreads = 0);
+
+    /*!
+     * \param dra The DRA to carry out
+     * \param threadPool Threads to split the histogram and remap across
+     *
+     * \throws except::Exception If the algorithm type isn't set, or the
+     * parameters it needs are missing or out of range
+     */
+    DynamicRangeAdjuster(const DynamicRangeAdjustment& dra,
+                         six::ThreadPool& threadPool);
+
+    //! \return Whether statistics must be computed before apply()
+    bool needsStatistics() const
+    {
+        return mAlgorithmType == DRAType::AUTO;
+    }
+
+    /*!
+     * Compute the histogram of SIDD pixels, and from it the remap.  Any rows
+     * that were added but not finished are discarded.
+     *
+     * \param image Pixel interleaved image data
+     * \param pixelType MONO8I, MONO16I, or RGB24I
+     * \param dims Rows and columns of the image
+     */
+    void computeStatistics(const UByte* image,
+                           PixelType pixelType,
+                           const types::RowCol<size_t>& dims);
+
+    /*!
+     * Compute the histogram of the amplitudes of complex pixels, and from it
+     * the remap.  Any rows that were added but not finished are discarded.
+     *
+     * \param image Complex image data
+     * \param dims Rows and columns of the image
+     */
+    void computeStatistics(const std::complex<float>* image,
+                           const types::RowCol<size_t>& dims);
+
+    /*!
+     * Compute the statistics of an image, reading it in swaths
+     *
+     * \param reader Reader that's loaded the image
+     * \param imageNumber Index of the image.  Its pixels may be MONO8I,
+     * MONO16I, RGB24I, or RE32F_IM32F.
+     * \param numRowsPerSwath Number of rows to read at once.  Defaults to 0,
+     * which means about 32 MB worth.
+     *
+     * \throws except::Exception If the image doesn't exist or its pixel type
+     * isn't supported
+     */
+    void computeStatistics(ReadControl& reader,
+                           size_t imageNumber,
+                           size_t numRowsPerSwath = 0);
+
+    /*!
+     * Add some rows of SIDD pixels to the histogram.  Rows may be added in
+     * any order, but they must all have the same pixel type.
+     *
+     * \param rows Pixel interleaved rows
+     * \param pixelType MONO8I, MONO16I, or RGB24I
+     * \param dims Number of rows being added, and columns in each
+     *
+     * \throws except::Exception If the pixel type isn't supported, or isn't
+     * the type of the rows that have already been added
+     */
+    void addRows(const UByte* rows,
+                 PixelType pixelType,
+                 const types::RowCol<size_t>& dims);
+
+    /*!
+     * Add the amplitudes of some rows of complex pixels to the histogram.
+     * Rows may be added in any order.
+     *
+     * \param rows Complex rows
+     * \param dims Number of rows being added, and columns in each
+     *
+     * \throws except::Exception If SIDD rows have already been added
+     */
+    void addRows(const std::complex<float>* rows,
+                 const types::RowCol<size_t>& dims);
+
+    //! \return Number of pixels added since statistics were last finished
+    sys::Uint64_T getNumPixelsAdded() const
+    {
+        return mNumPixelsAdded;
+    }
+
+    /*!
+     * Compute the statistics, and from them the remap, from every row added
+     * since statistics were last finished.  The histogram is then emptied
+     * so that another image can be added.
+     *
+     * \throws except::Exception If no pixels have been added
+     */
+    void finishStatistics();
+
+    //! \return Statistics from the last call to finishStatistics()
+    const Statistics& getStatistics() const
+    {
+        return mStatistics;
+    }
+
+    /*!
+     * \return The subtractor and multiplier of the remap
+     *
+     * \throws except::Exception If statistics are needed but haven't been
+     * computed
+     */
+    const DynamicRangeAdjustment::DRAOverrides& getRemap() const;
+
+    /*!
+     * Remap SIDD pixels to 8 bits
+     *
+     * \param image Pixel interleaved image data
+     * \param pixelType MONO8I, MONO16I, or RGB24I
+     * \param dims Rows and columns of the image
+     * \param[out] output Remapped image.  This has one byte per pixel,
+     * or three for RGB24I.
+     */
+    void apply(const UByte* image,
+               PixelType pixelType,
+               const types::RowCol<size_t>& dims,
+               UByte* output) const;
+
+    /*!
+     * Detect and remap complex pixels to 8 bits
+     *
+     * \param image Complex image data
+     * \param dims Rows and columns of the image
+     * \param[out] output Remapped image, one byte per pixel
+     */
+    void apply(const std::complex<float>* image,
+               const types::RowCol<size_t>& dims,
+               UByte* output) const;
+
+    /*!
+     * Record the remap that was chosen.  For AUTO, draOverrides is replaced
+     * with the computed subtractor and multiplier.  Nothing changes for the
+     * other algorithm types.
+     *
+     * \param dra The DRA to update
+     */
+    void update(DynamicRangeAdjustment& dra) const;
+
+    /*!
+     * Carry out the DRA of a SIDD product and record the chosen remap in it
+     *
+     * \param data The product.  The DRA is taken from, and written back to,
+     * display->interactiveProcessing[processingIndex].
+     * \param image The product's pixels
+     * \param[out] output Remapped image, as for apply()
+     * \param numThreads Number of threads to use, or 0 for one per CPU
+     * \param processingIndex Index of the interactive processing to use
+     */
+    static void adjust(DerivedData& data,
+                       const UByte* image,
+                       UByte* output,
+                       size_t numThreads = 0,
+                       size_t processingIndex = 0);
+
+    /*!
+     * Carry out the DRA of a SIDD product, as above, on threadPool
+     *
+     * \param data The product
+     * \param image The product's pixels
+     * \param[out] output Remapped image, as for apply()
+     * \param threadPool Threads to use
+     * \param processingIndex Index of the interactive processing to use
+     */
+    static void adjust(DerivedData& data,
+                       const UByte* image,
+                       UByte* output,
+                       six::ThreadPool& threadPool,
+                       size_t processingIndex = 0);
+
+    /*!
+     * Carry out the DRA of a SIDD product on the complex image it's being
+     * generated from, and record the chosen remap in the product
+     *
+     * \param data The product.  The DRA is taken from, and written back to,
+     * display->interactiveProcessing[processingIndex].
+     * \param image Complex image data
+     * \param dims Rows and columns of the complex image
+     * \param[out] output Remapped image, one byte per pixel
+     * \param numThreads Number of threads to use, or 0 for one per CPU
+     * \param processingIndex Index of the interactive processing to use
+     */
+    static void adjust(DerivedData& data,
+                       const std::complex<float>* image,
+                       const types::RowCol<size_t>& dims,
+                       UByte* output,
+                       size_t numThreads = 0,
+                       size_t processingIndex = 0);
+
+    /*!
+     * Carry out the DRA of a SIDD product on the complex image it's being
+     * generated from, as above, on threadPool
+     *
+     * \param data The product
+     * \param image Complex image data
+     * \param dims Rows and columns of the complex image
+     * \param[out] output Remapped image, one byte per pixel
+     * \param threadPool Threads to use
+     * \param processingIndex Index of the interactive processing to use
+     */
+    static void adjust(DerivedData& data,
+                       const std::complex<float>* image,
+                       const types::RowCol<size_t>& dims,
+                       UByte* output,
+                       six::ThreadPool& threadPool,
+                       size_t processingIndex = 0);
+
+private:
+    // Noncopyable
+    DynamicRangeAdjuster(const DynamicRangeAdjuster& );
+    const DynamicRangeAdjuster& operator=(const DynamicRangeAdjuster& );
+
+    void init(const DynamicRangeAdjustment& dra);
+
+    // Sets mStatistics and mRemap from a histogram whose bin i holds the
+    // pixels near firstValue + i * binWidth.  Bin values are clamped to
+    // [minValue, maxValue].
+    void setStatistics(const std::vector<sys::Uint64_T>& histogram,
+                       double firstValue,
+                       double binWidth,
+                       double minValue,
+                       double maxValue);
+
+    // Band of pixelType that statistics come from
+    size_t getStatsBand(PixelType pixelType) const;
+
+    // Rows of each piece of work when splitting dims across threads
+    size_t getRowsPerChunk(const types::RowCol<size_t>& dims) const;
+
+    // Checks that rows of a type can be added to the histogram
+    void startAdding(bool isComplex, PixelType pixelType);
+
+    // Empties the histogram
+    void clearHistogram();
+
+private:
+    DRAType mAlgorithmType;
+    size_t mBandStatsSource;
+    DynamicRangeAdjustment::DRAParameters mParameters;
+    DynamicRangeAdjustment::DRAOverrides mRemap;
+    bool mHaveRemap;
+    Statistics mStatistics;
+
+    // Histogram of the pixels added since statistics were last finished.
+    // Complex amplitudes are binned by mBinWidth, which starts out just wide
+    // enough for the first rows that are added, and is doubled as needed.
+    std::vector<sys::Uint64_T> mHistogram;
+    sys::Uint64_T mNumPixelsAdded;
+    bool mAddedComplex;
+    PixelType mAddedPixelType;
+    double mBinWidth;
+    double mMinAmplitude;
+    double mMaxAmplitude;
+
+    // Only set if the adjuster started its own threads
+    std::unique_ptr<six::ThreadPool> mOwnedThreadPool;
+    six::ThreadPool& mThreadPool;
+};
+}
+}
+
+#endif
@@ -0,0 +1,259 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_SIDD_IMAGE_FILTER_H__
+#define __SIX_SIDD_IMAGE_FILTER_H__
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+#include <six/ThreadPool.h>
+#include <six/Types.h>
+#include <six/sidd/Filter.h>
+#include <types/RowCol.h>
+
+namespace six
+{
+namespace sidd
+{
+/*!
+ * \class ImageFilter
+ * \brief Applies a SIDD Filter to an image, such as for sharpness
+ * enhancement, anti-aliasing, or RRDS interpolation
+ *
+ * A filter kernel is applied with apply().  The kernel is centered on each
+ * output pixel (at row (size.row - 1) / 2 and column (size.col - 1) / 2 of
+ * the kernel), and is flipped first if the filter's operation is
+ * CONVOLUTION.  A filter bank is a set of 1D interpolators, one per phase,
+ * and resample() applies it along the rows and then the columns to resize
+ * an image.  Pixels past the edges of the image repeat the nearest edge
+ * pixel.
+ *
+ * The output is split into tiles, which are filtered concurrently by a pool
+ * of threads.  The filter uses the pool it's given, or else starts its own
+ * that lives as long as it does.  Each tile reads the extra rows and
+ * columns around it (its halo) that the kernel needs.  Kernels
+ * are applied one of three ways:
+ * - Separable kernels (the outer product of a column and a row) as two 1D
+ *   passes
+ * - Other small kernels directly
+ * - Other large kernels by multiplying FFTs
+ * The direct loops are written so that the compiler can vectorize them.
+ *
+ * Custom kernels and banks can be applied, along with predefined banks
+ * from the BILINEAR, CUBIC, LAGRANGE, and NEAREST_NEIGHBOR databases.
+ * Predefined filter families and predefined kernels have no coefficients
+ * available to six, so they can't be applied.
+ *
+ * Images may be float, or SIDD MONO8I, MONO16I (in native byte order), or
+ * RGB24I pixels.  Each band is filtered separately.  Integer pixels are
+ * rounded and clamped to their range.
+ */
+class ImageFilter
+{
+public:
+    //! How kernels are applied
+    enum Method
+    {
+        //! Choose based on the kernel
+        AUTO,
+
+        //! Directly, in two passes if the kernel is separable
+        DIRECT,
+
+        //! By multiplying FFTs
+        FFT
+    };
+
+    /*!
+     * \param filter The filter to apply
+     * \param numThreads Number of threads to use.  Defaults to 0, which means
+     * one per CPU.
+     * \param method How to apply a kernel.  Ignored for filter banks.
+     *
+     * \throws except::Exception If the filter is malformed or has no
+     * coefficients available
+     */
+    ImageFilter(const Filter& filter,
+                size_t numThreads = 0,
+                Method method = AUTO);
+
+    /*!
+     * \param filter The filter to apply
+     * \param threadPool Threads to filter the tiles on
+     * \param method How to apply a kernel.  Ignored for filter banks.
+     *
+     * \throws except::Exception If the filter is malformed or has no
+     * coefficients available
+     */
+    ImageFilter(const Filter& filter,
+                six::ThreadPool& threadPool,
+                Method method = AUTO);
+
+    ~ImageFilter();
+
+    //! \return Whether the filter is a bank, rather than a kernel
+    bool isBank() const
+    {
+        return mNumPhasings != 0;
+    }
+
+    //! \return Whether the kernel is applied as two 1D passes
+    bool isSeparable() const
+    {
+        return !mRowKernel.empty();
+    }
+
+    //! \return Whether the kernel is applied with FFTs
+    bool usesFFT() const
+    {
+        return !mKernelSpectrum.empty();
+    }
+
+    /*!
+     * \return The most rows and columns on either side of an output pixel
+     * that the filter reads.  For a bank, this is for any resampling that
+     * doesn't enlarge the image.
+     */
+    types::RowCol<size_t> getHalo() const;
+
+    /*!
+     * Apply the filter kernel to a float image
+     *
+     * \param input Image to filter
+     * \param dims Rows and columns of the image
+     * \param[out] output Filtered image.  This can't overlap the input.
+     */
+    void apply(const float* input,
+               const types::RowCol<size_t>& dims,
+               float* output) const;
+
+    /*!
+     * Apply the filter kernel to SIDD pixels
+     *
+     * \param input Pixel interleaved image to filter
+     * \param pixelType MONO8I, MONO16I, or RGB24I
+     * \param dims Rows and columns of the image
+     * \param[out] output Filtered image.  This can't overlap the input.
+     */
+    void apply(const UByte* input,
+               PixelType pixelType,
+               const types::RowCol<size_t>& dims,
+               UByte* output) const;
+
+    /*!
+     * Resize a float image with the filter bank.  Output pixel centers are
+     * evenly spaced across the input, so output pixel (row, col) is
+     * interpolated at input position
+     * ((row + 0.5) * inRows / outRows - 0.5,
+     *  (col + 0.5) * inCols / outCols - 0.5)
+     *
+     * \param input Image to resize
+     * \param inDims Rows and columns of the input
+     * \param outDims Rows and columns of the output
+     * \param[out] output Resized image
+     */
+    void resample(const float* input,
+                  const types::RowCol<size_t>& inDims,
+                  const types::RowCol<size_t>& outDims,
+                  float* output) const;
+
+    /*!
+     * Resize SIDD pixels with the filter bank
+     *
+     * \param input Pixel interleaved image to resize
+     * \param pixelType MONO8I, MONO16I, or RGB24I
+     * \param inDims Rows and columns of the input
+     * \param outDims Rows and columns of the output
+     * \param[out] output Resized image
+     */
+    void resample(const UByte* input,
+                  PixelType pixelType,
+                  const types::RowCol<size_t>& inDims,
+                  const types::RowCol<size_t>& outDims,
+                  UByte* output) const;
+
+private:
+    // Noncopyable
+    ImageFilter(const ImageFilter& );
+    const ImageFilter& operator=(const ImageFilter& );
+
+    class FFTPlan;
+    template <typename T> class KernelTile;
+    template <typename T> class ResampleTile;
+
+    void init(const Filter& filter, Method method);
+
+    void initKernel(const Filter::Kernel& kernel,
+                    bool isConvolution,
+                    Method method);
+
+    void initBank(const Filter::Bank& bank);
+
+    void transform2D(std::vector<std::complex<double> >& data,
+                     bool inverse) const;
+
+    template <typename T>
+    void applyBands(const T* input,
+                    size_t numBands,
+                    const types::RowCol<size_t>& dims,
+                    T* output) const;
+
+    template <typename T>
+    void resampleBands(const T* input,
+                       size_t numBands,
+                       const types::RowCol<size_t>& inDims,
+                       const types::RowCol<size_t>& outDims,
+                       T* output) const;
+
+private:
+    // Kernel coefficients in row-major order, arranged for correlation
+    std::vector<float> mKernel;
+    types::RowCol<size_t> mKernelDims;
+
+    // Separable kernels are also split into the kernel for each row and
+    // for each column
+    std::vector<float> mRowKernel;
+    std::vector<float> mColKernel;
+
+    // For FFTs, the conjugate of the spectrum of the kernel, the
+    // dimensions of each FFT and of the output tile that fits in one, and
+    // the plans for the row and column transforms
+    std::vector<std::complex<double> > mKernelSpectrum;
+    types::RowCol<size_t> mFFTDims;
+    types::RowCol<size_t> mFFTTileDims;
+    std::unique_ptr<FFTPlan> mRowFFT;
+    std::unique_ptr<FFTPlan> mColFFT;
+
+    // Filter bank coefficients, mNumPoints for each of mNumPhasings
+    std::vector<float> mBank;
+    size_t mNumPhasings;
+    size_t mNumPoints;
+
+    // Only set if the filter started its own threads
+    std::unique_ptr<six::ThreadPool> mOwnedThreadPool;
+    six::ThreadPool& mThreadPool;
+};
+}
+}
+
+#endif
@@ -0,0 +1,161 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_SIDD_J2K_COMPRESSOR_H__
+#define __SIX_SIDD_J2K_COMPRESSOR_H__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <six/Options.h>
+#include <six/ThreadPool.h>
+#include <six/Types.h>
+#include <six/sidd/CompressedSIDDByteProvider.h>
+#include <six/sidd/DerivedData.h>
+
+namespace six
+{
+namespace sidd
+{
+/*!
+ * \class J2KCompressor
+ * \brief JPEG 2000 compresses a SIDD image on multiple threads, for
+ * writing out with CompressedSIDDByteProvider
+ *
+ * The image is laid out in image segments and blocks just as
+ * NITFWriteControl would for the same options.  Each image segment is a
+ * single J2K codestream with one tile per NITF block (or a single tile, if
+ * the SIDD isn't blocked).  The tiles are encoded with OpenJPEG
+ * concurrently, each on its own, and their tile-parts are then put together
+ * behind the segment's main header.  Blocking the SIDD is what gives the
+ * threads something to split up.
+ *
+ * The following options are used:
+ * - NITFHeaderCreator::OPT_J2K_COMPRESSION_BYTERATE is the target bytes per
+ *   pixel per band, which sets each block's compression ratio.  It's
+ *   required unless compressing losslessly.
+ * - NITFHeaderCreator::OPT_J2K_COMPRESSION_LOSSLESS compresses reversibly,
+ *   in which case there's no rate control.
+ * - NITFHeaderCreator::OPT_MAX_PRODUCT_SIZE,
+ *   NITFHeaderCreator::OPT_NUM_ROWS_PER_BLOCK, and
+ *   NITFHeaderCreator::OPT_NUM_COLS_PER_BLOCK determine the layout.
+ * - NITFWriteControl::OPT_NUM_WRITE_THREADS is the number of threads.
+ *   Defaults to 0, which means one per CPU.
+ */
+class J2KCompressor
+{
+public:
+    /*!
+     * \param data Representation of the derived data
+     * \param options Compression, layout, and thread options as described
+     * above
+     *
+     * \throws except::Exception If J2K compression isn't available, or the
+     * options or pixel type can't be compressed
+     */
+    J2KCompressor(const DerivedData& data, const Options& options);
+
+    //! \return Whether six.sidd was built with OpenJPEG
+    static bool isAvailable();
+
+    /*!
+     * Compress the whole image, replacing anything compressed before
+     *
+     * \param imageData The image's pixels, pixel interleaved and in native
+     * byte order
+     */
+    void compress(const UByte* imageData);
+
+    /*!
+     * Compress the whole image on a caller's thread pool rather than
+     * NITFWriteControl::OPT_NUM_WRITE_THREADS threads of its own
+     *
+     * \param imageData The image's pixels, pixel interleaved and in native
+     * byte order
+     * \param threadPool Runs the blocks
+     */
+    void compress(const UByte* imageData, ThreadPool& threadPool);
+
+    /*!
+     * \return The compressed size of each block, in bytes, per image
+     * segment.  This is what CompressedSIDDByteProvider takes.  The first
+     * block of each segment includes the codestream's main header and the
+     * last one includes its EOC marker.
+     */
+    const std::vector<std::vector<size_t> >& getBytesPerBlock() const
+    {
+        return mBytesPerBlock;
+    }
+
+    //! \return Each image segment's codestream, in the order they're written
+    const std::vector<UByte>& getCompressedData() const
+    {
+        return mCompressedData;
+    }
+
+    bool isNumericallyLossless() const
+    {
+        return mIsNumericallyLossless;
+    }
+
+    /*!
+     * Set up a byte provider for the compressed image.  Pass
+     * getCompressedData() to its getBytes() to get the NITF.
+     *
+     * \param schemaPaths Directories or files of schema locations
+     *
+     * \return The byte provider
+     */
+    std::auto_ptr<CompressedSIDDByteProvider>
+    createByteProvider(const std::vector<std::string>& schemaPaths) const;
+
+private:
+    // Noncopyable
+    J2KCompressor(const J2KCompressor& );
+    const J2KCompressor& operator=(const J2KCompressor& );
+
+private:
+    struct SegmentLayout
+    {
+        size_t firstRow;
+        size_t numRows;
+        size_t numRowsPerBlock;
+        size_t numColsPerBlock;
+        size_t numBlocksPerRow;
+        size_t numBlocksPerCol;
+    };
+
+    std::auto_ptr<DerivedData> mData;
+    bool mIsNumericallyLossless;
+    double mCompressionRatio;
+    size_t mMaxProductSize;
+    size_t mNumRowsPerBlock;
+    size_t mNumColsPerBlock;
+    size_t mNumThreads;
+    std::vector<SegmentLayout> mSegments;
+    std::vector<std::vector<size_t> > mBytesPerBlock;
+    std::vector<UByte> mCompressedData;
+};
+}
+}
+
+#endif
@@ -0,0 +1,257 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_SIDD_RRDS_BUILDER_H__
+#define __SIX_SIDD_RRDS_BUILDER_H__
+
+#include <memory>
+#include <vector>
+
+#include <six/ThreadPool.h>
+#include <six/Types.h>
+#include <six/sidd/Display.h>
+#include <six/sidd/ImageFilter.h>
+#include <types/RowCol.h>
+
+namespace six
+{
+namespace sidd
+{
+/*!
+ * \class RRDSBuilder
+ * \brief Builds a reduced resolution data set (RRDS) pyramid from the rows
+ * of a SIDD product as they stream by
+ *
+ * Level L of the pyramid is 2^L times smaller than the product in each
+ * dimension, rounding up, and is made from level L - 1 the way the RRDS
+ * metadata says to:
+ * - The anti-aliasing filter kernel is applied first, if there is one
+ * - DECIMATE keeps the top left pixel of each 2x2 block
+ * - MAX_PIXEL keeps the brightest pixel of each band of each 2x2 block
+ * - AVERAGE takes the mean of each 2x2 block
+ * - NEAREST_NEIGHBOR, BILINEAR, and LAGRANGE interpolate halfway between
+ *   the pixels of each 2x2 block with the interpolation filter bank.
+ *   Without a bank, NEAREST_NEIGHBOR decimates and BILINEAR averages.
+ * Pixels past the edges of a level repeat the nearest edge pixel.
+ *
+ * Rows are added in order, and every level is built in the same pass.
+ * Each level holds onto a strip of rows, along with the rows above and
+ * below it that the filters need, so memory use depends on the width of
+ * the product rather than its size.  As each strip of a level is finished
+ * it's handed to the Sink and fed to the next level.  Strips are filtered
+ * and reduced on one pool of threads, which the builder's filters share.
+ *
+ * Pixels may be SIDD MONO8I, MONO16I (in native byte order), or RGB24I.
+ */
+class RRDSBuilder
+{
+public:
+    //! Where the rows of each level go
+    struct Sink
+    {
+        virtual ~Sink()
+        {
+        }
+
+        /*!
+         * Take some rows of a level.  Each level's rows arrive in order.
+         *
+         * \param level Which level the rows are in, starting at 1
+         * \param startRow First row of the level that's being written
+         * \param numRows Number of rows being written
+         * \param rows Pixel interleaved rows, in the product's pixel type.
+         * These are only valid until this returns.
+         */
+        virtual void writeRows(size_t level,
+                               size_t startRow,
+                               size_t numRows,
+                               const UByte* rows) = 0;
+    };
+
+    //! Default number of rows of a level to build at once
+    static const size_t DEFAULT_ROWS_PER_STRIP = 256;
+
+    /*!
+     * \param dims Rows and columns of the product
+     * \param pixelType MONO8I, MONO16I, or RGB24I
+     * \param rrds How to downsample each level
+     * \param numLevels Number of levels to build, not counting the product
+     * itself
+     * \param sink Where to write the levels.  This must outlive the
+     * builder.
+     * \param numThreads Number of threads to use.  Defaults to 0, which
+     * means one per CPU.
+     * \param numRowsPerStrip Number of rows of each level to build at once
+     *
+     * \throws except::Exception If the pixel type isn't supported, if the
+     * RRDS downsampling method is NOT_SET or is missing the filter it
+     * needs, or if a filter can't be applied
+     */
+    RRDSBuilder(const types::RowCol<size_t>& dims,
+                PixelType pixelType,
+                const RRDS& rrds,
+                size_t numLevels,
+                Sink& sink,
+                size_t numThreads = 0,
+                size_t numRowsPerStrip = DEFAULT_ROWS_PER_STRIP);
+
+    /*!
+     * \param dims Rows and columns of the product
+     * \param pixelType MONO8I, MONO16I, or RGB24I
+     * \param rrds How to downsample each level
+     * \param numLevels Number of levels to build, not counting the product
+     * itself
+     * \param sink Where to write the levels.  This must outlive the
+     * builder.
+     * \param threadPool Threads to filter and reduce the strips on, for
+     * as long as the builder is in use
+     * \param numRowsPerStrip Number of rows of each level to build at once
+     *
+     * \throws except::Exception If the pixel type isn't supported, if the
+     * RRDS downsampling method is NOT_SET or is missing the filter it
+     * needs, or if a filter can't be applied
+     */
+    RRDSBuilder(const types::RowCol<size_t>& dims,
+                PixelType pixelType,
+                const RRDS& rrds,
+                size_t numLevels,
+                Sink& sink,
+                six::ThreadPool& threadPool,
+                size_t numRowsPerStrip = DEFAULT_ROWS_PER_STRIP);
+
+    /*!
+     * \param dims Rows and columns of the product
+     * \param minDim Size to stop at
+     *
+     * \return Number of levels needed for both dimensions of the smallest
+     * level to be at most minDim
+     */
+    static size_t getNumLevels(const types::RowCol<size_t>& dims,
+                               size_t minDim = 256);
+
+    /*!
+     * \param dims Rows and columns of the product
+     * \param level Level of the pyramid
+     *
+     * \return Rows and columns of the level
+     */
+    static types::RowCol<size_t> getLevelDims(
+            const types::RowCol<size_t>& dims,
+            size_t level);
+
+    //! \return Number of levels being built
+    size_t getNumLevels() const
+    {
+        return mLevels.size();
+    }
+
+    //! \return Number of rows of the product that have been added
+    size_t getNumRowsAdded() const
+    {
+        return mNumRowsAdded;
+    }
+
+    //! \return Whether every row has been added, so every level is written
+    bool isComplete() const
+    {
+        return mNumRowsAdded == mDims.row;
+    }
+
+    /*!
+     * Add the next rows of the product.  Any strips of any level that this
+     * finishes are written to the sink before this returns.
+     *
+     * \param rows Pixel interleaved rows, in the product's pixel type
+     * \param numRows Number of rows
+     *
+     * \throws except::Exception If this adds more rows than the product
+     * has
+     */
+    void addRows(const UByte* rows, size_t numRows);
+
+private:
+    // Noncopyable
+    RRDSBuilder(const RRDSBuilder& );
+    const RRDSBuilder& operator=(const RRDSBuilder& );
+
+    struct Level
+    {
+        // Rows and columns of the level below, which this is made from, and
+        // of this level
+        types::RowCol<size_t> inDims;
+        types::RowCol<size_t> outDims;
+
+        // Rows of the level below that are still needed, starting at
+        // firstRow
+        std::vector<UByte> rows;
+        size_t firstRow;
+        size_t numRowsAdded;
+
+        size_t nextOutputRow;
+    };
+
+    void init(const RRDS& rrds, size_t numLevels);
+
+    void addRows(size_t levelIndex, const UByte* rows, size_t numRows);
+
+    // Builds the next strip of a level, numRows rows tall
+    void buildStrip(Level& level, size_t numRows, UByte* output);
+
+    // Reduces each 2x2 block of a padded strip
+    template <typename T>
+    void reduce(const UByte* padded,
+                size_t numOutputRows,
+                size_t numOutputCols,
+                UByte* output);
+
+private:
+    const types::RowCol<size_t> mDims;
+    const PixelType mPixelType;
+    DownsamplingMethod mMethod;
+    Sink& mSink;
+
+    // Only set if the builder started its own threads
+    std::auto_ptr<six::ThreadPool> mOwnedThreadPool;
+    six::ThreadPool& mThreadPool;
+
+    const size_t mNumRowsPerStrip;
+    const size_t mNumBands;
+    const size_t mNumBytesPerPixel;
+
+    std::auto_ptr<ImageFilter> mAntiAlias;
+    std::auto_ptr<ImageFilter> mInterpolation;
+
+    // Rows of the level below above and below each strip that the filters
+    // need.  Always even, so strips stay aligned to 2x2 blocks.
+    size_t mHalo;
+
+    std::vector<Level> mLevels;
+    size_t mNumRowsAdded;
+
+    // Scratch space for building a strip
+    std::vector<UByte> mPadded;
+    std::vector<UByte> mFiltered;
+    std::vector<UByte> mResampled;
+};
+}
+}
+
+#endif
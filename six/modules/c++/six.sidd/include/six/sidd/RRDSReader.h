@@ -0,0 +1,127 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_SIDD_RRDS_READER_H__
+#define __SIX_SIDD_RRDS_READER_H__
+
+#include <string>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <sys/File.h>
+#include <types/RowCol.h>
+#include <six/Types.h>
+
+namespace six
+{
+namespace sidd
+{
+/*!
+ * \class RRDSReader
+ * \brief Reads the levels of an RRDS pyramid from a sidecar written by
+ * RRDSWriter
+ *
+ * Pixels are read straight out of the file, so regions of any level may
+ * be read from multiple threads at once.
+ */
+class RRDSReader
+{
+public:
+    /*!
+     * Reads the headers of the sidecar
+     *
+     * \param pathname Sidecar to read
+     *
+     * \throws except::Exception If the file isn't laid out the way that
+     * RRDSWriter writes it
+     */
+    explicit RRDSReader(const std::string& pathname);
+
+    //! \return Number of levels, not counting the product itself
+    size_t getNumLevels() const
+    {
+        return mLevels.size();
+    }
+
+    //! \return Pixel type of every level
+    PixelType getPixelType() const
+    {
+        return mPixelType;
+    }
+
+    /*!
+     * \param level Level of the pyramid, starting at 1
+     *
+     * \return Rows and columns of the level
+     */
+    types::RowCol<size_t> getLevelDims(size_t level) const
+    {
+        return getLevel(level).dims;
+    }
+
+    /*!
+     * Pick the level to display the product at a scale.  This is the
+     * smallest level that is still at least as large as the display, so
+     * it only ever needs to be shrunk further.
+     *
+     * \param scale Size of the display relative to the product, such as
+     * 0.25 to show the product at a quarter of its size.  Must be positive.
+     *
+     * \return The level, or 0 if the product itself should be used
+     */
+    size_t getLevelForScale(double scale) const;
+
+    /*!
+     * Read a region of a level
+     *
+     * \param level Level of the pyramid, starting at 1
+     * \param offset First row and column of the region
+     * \param extent Rows and columns of the region
+     * \param[out] buffer Pixel interleaved pixels in native byte order
+     *
+     * \throws except::Exception If the region is outside of the level
+     */
+    void readLevel(size_t level,
+                   const types::RowCol<size_t>& offset,
+                   const types::RowCol<size_t>& extent,
+                   UByte* buffer) const;
+
+private:
+    struct Level
+    {
+        types::RowCol<size_t> dims;
+        sys::Off_T dataOffset;
+    };
+
+    const Level& getLevel(size_t level) const;
+
+private:
+    PixelType mPixelType;
+    size_t mNumBytesPerPixel;
+    std::vector<Level> mLevels;
+
+    // Only read with readAt(), which doesn't move the file offset
+    mutable sys::File mFile;
+};
+}
+}
+
+#endif
@@ -0,0 +1,160 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_SIDD_RRDS_WRITER_H__
+#define __SIX_SIDD_RRDS_WRITER_H__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <import/nitf.hpp>
+#include <types/RowCol.h>
+#include <six/Types.h>
+#include <six/sidd/RRDSBuilder.h>
+
+namespace six
+{
+namespace sidd
+{
+/*!
+ * \class RRDSWriter
+ * \brief Writes the levels of an RRDS pyramid to a sidecar NITF
+ *
+ * The sidecar holds one uncompressed, unblocked image segment per level,
+ * in order.  Level L has IID1 "RRDS" followed by L as three digits, a
+ * display level (IDLVL) of L, and is attached (IALVL) to the level above
+ * it, with level 1 attached to the product itself at level 0.  Its
+ * magnification (IMAG) is "/2^L", and its pixels are in the product's
+ * pixel type.  Use RRDSReader to read it back.
+ *
+ * The headers are written up front, so rows are written straight to disk
+ * at their final place in the file as they come.
+ */
+class RRDSWriter : public RRDSBuilder::Sink
+{
+public:
+    //! NITF IMAG can't show reductions any larger than "/512"
+    static const size_t MAX_NUM_LEVELS = 9;
+
+    /*!
+     * Writes the headers of the sidecar
+     *
+     * \param pathname Where to write the sidecar
+     * \param dims Rows and columns of the product
+     * \param pixelType MONO8I, MONO16I, or RGB24I
+     * \param numLevels Number of levels, not counting the product itself
+     *
+     * \throws except::Exception If there are no levels or more than
+     * MAX_NUM_LEVELS, if the pixel type isn't supported, or if a level is
+     * too large for an image segment
+     */
+    RRDSWriter(const std::string& pathname,
+               const types::RowCol<size_t>& dims,
+               PixelType pixelType,
+               size_t numLevels);
+
+    /*!
+     * \param level Level of the pyramid, starting at 1
+     *
+     * \return The IID1 of the level's image segment
+     */
+    static std::string getImageId(size_t level);
+
+    /*!
+     * Write rows of a level to the sidecar
+     *
+     * \param level Which level the rows are in, starting at 1
+     * \param startRow First row of the level to write
+     * \param numRows Number of rows to write
+     * \param rows Pixel interleaved rows, in native byte order
+     *
+     * \throws except::Exception If the rows are outside of the level
+     */
+    virtual void writeRows(size_t level,
+                           size_t startRow,
+                           size_t numRows,
+                           const UByte* rows);
+
+    /*!
+     * Closes the sidecar.  This happens implicitly in the destructor if
+     * it's not called.
+     */
+    void close();
+
+private:
+    std::auto_ptr<nitf::IOInterface> mIO;
+    nitf::Writer mWriter;
+    nitf::Record mRecord;
+    const size_t mNumBytesPerPixel;
+    std::vector<types::RowCol<size_t> > mLevelDims;
+    std::vector<nitf::Off> mDataOffsets;
+    std::vector<UByte> mSwapped;
+};
+
+/*!
+ * Build the RRDS pyramid of a SIDD product and write it to a sidecar,
+ * reading the product in swaths.  The product's RRDS metadata says how
+ * to downsample.  SIDD 1.0 has none, so its recommended decimation
+ * method is used instead, or AVERAGE if there isn't one of those either.
+ *
+ * \param siddPathname SIDD to read
+ * \param rrdsPathname Where to write the sidecar
+ * \param schemaPaths Directories or files of schema locations
+ * \param imageNumber Index of the product in the SIDD
+ * \param numLevels Number of levels to build.  Defaults to 0, which means
+ * enough for the smallest level to be at most 256 pixels on a side, up to
+ * RRDSWriter::MAX_NUM_LEVELS.
+ * \param numThreads Number of threads to use.  Defaults to 0, which means
+ * one per CPU.
+ *
+ * \return Number of levels built
+ */
+size_t writeRRDS(const std::string& siddPathname,
+                 const std::string& rrdsPathname,
+                 const std::vector<std::string>& schemaPaths,
+                 size_t imageNumber = 0,
+                 size_t numLevels = 0,
+                 size_t numThreads = 0);
+
+/*!
+ * Build the RRDS pyramid of a SIDD product and write it to a sidecar, as
+ * above, filtering and reducing on threadPool
+ *
+ * \param siddPathname SIDD to read
+ * \param rrdsPathname Where to write the sidecar
+ * \param schemaPaths Directories or files of schema locations
+ * \param threadPool Threads to build the levels on
+ * \param imageNumber Index of the product in the SIDD
+ * \param numLevels Number of levels to build, or 0 for the default
+ *
+ * \return Number of levels built
+ */
+size_t writeRRDS(const std::string& siddPathname,
+                 const std::string& rrdsPathname,
+                 const std::vector<std::string>& schemaPaths,
+                 six::ThreadPool& threadPool,
+                 size_t imageNumber = 0,
+                 size_t numLevels = 0);
+}
+}
+
+#endif
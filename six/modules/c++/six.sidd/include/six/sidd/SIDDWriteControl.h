@@ -0,0 +1,207 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_SIDD_WRITE_CONTROL_H__
+#define __SIX_SIDD_WRITE_CONTROL_H__
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/Mutex.h>
+#include <types/RowCol.h>
+#include <six/NITFWriteControl.h>
+#include <six/sidd/DerivedData.h>
+
+namespace six
+{
+namespace sidd
+{
+/*!
+ * \class SIDDWriteControl
+ * \brief Specialized NITF write control that allows for writing a SIDD out
+ * in tiles
+ *
+ * This is the SIDD counterpart to SICDWriteControl.  Tiles of any product
+ * may be saved in any order, and from multiple threads at once.  The NITF
+ * blocking and byte order are taken care of here, so the tiles are simply
+ * pixels in the product's pixel type and in native byte order.
+ *
+ * When the NITF is blocked, pixels are held onto until their whole block
+ * has been saved, at which point the block is written to disk and freed.
+ * So, memory use depends on how many blocks are partially saved at any
+ * one time rather than on the size of the product.  Unblocked pixels are
+ * written straight to disk.
+ *
+ * Multiple products and legends are supported.  Legends are written out
+ * along with the headers.  Image compression and additional DESs are not.
+ */
+class SIDDWriteControl : public six::NITFWriteControl
+{
+public:
+    /*!
+     * Constructor
+     *
+     * \param outputPathname Full path to the output file to write
+     * \param schemaPaths Directories or files of schema locations
+     */
+    SIDDWriteControl(const std::string& outputPathname,
+                     const std::vector<std::string>& schemaPaths);
+
+    using NITFWriteControl::initialize;
+
+    /*!
+     * Initializes the control for a SIDD with a single product.  Either this
+     * or the base class's initialize() function must be called prior to any
+     * of the save() methods or doing anything to manipulate the underlying
+     * Record object.
+     *
+     * \param data Representation of the derived data
+     */
+    void initialize(const DerivedData& data);
+
+    using NITFWriteControl::save;
+
+    /*!
+     * Writes a tile of a product's pixels to the file.  The first time this
+     * is called, the headers and any legends will be written to the file.
+     * This may be called as many times as desired with different AOIs in
+     * any order, and from multiple threads at once.  Each pixel should only
+     * be saved once.
+     *
+     * \param imageData The image data pixels to write, in the product's
+     *     pixel type and native byte order.  The pixels are copied, so they
+     *     aren't modified and don't need to stay around after this returns.
+     * \param offset The global offset in pixels as to where these pixels are
+     *     in the product.  If this is a multi-segment NITF, this is still
+     *     simply the global pixel location (this class will take care of
+     *     writing it to the appropriate image segment).
+     * \param dims The dimensions of the image data pixels
+     * \param imageNumber Index of the product that the tile belongs to
+     *
+     * \throws except::Exception If the tile is outside of the product, or
+     *     if a NITF block gets more pixels saved than it has
+     */
+    void save(const void* imageData,
+              const types::RowCol<size_t>& offset,
+              const types::RowCol<size_t>& dims,
+              size_t imageNumber = 0);
+
+    /*!
+     * \return The number of bytes held for NITF blocks that haven't been
+     * completely saved yet
+     */
+    size_t getNumPendingBytes() const;
+
+    /*!
+     * Writes out any blocks that haven't been completely saved, with the
+     * pixels that weren't saved left as zeros, then closes the underlying
+     * IO interface.  Closing will occur implicitly in the destructor if
+     * it's not called, but partial blocks will be lost.
+     */
+    void close();
+
+private:
+    // Where an image segment's pixels go in the file
+    struct SegmentLayout
+    {
+        size_t recordIndex;
+        size_t firstRow;
+        size_t numRows;
+        nitf::Off dataOffset;
+        size_t numRowsPerBlock;
+        size_t numColsPerBlock;
+        size_t numBlocksPerRow;
+
+        // Whether rows aren't contiguous in the file
+        bool isBlocked;
+    };
+
+    struct ProductLayout
+    {
+        size_t numRows;
+        size_t numCols;
+        size_t numBytesPerPixel;
+
+        // The unit to byte swap
+        size_t numBytesPerElement;
+
+        std::vector<SegmentLayout> segments;
+    };
+
+    // A block that has only been partially saved.  Keyed by the index of
+    // the image segment in the record and of the block in the segment.
+    typedef std::pair<size_t, size_t> BlockKey;
+    struct PendingBlock
+    {
+        std::vector<sys::ubyte> pixels;
+        size_t numPixelsLeft;
+        nitf::Off fileOffset;
+        size_t numBytesPerElement;
+    };
+
+    void writeHeaders();
+
+    void writeLegend(const Legend& legend,
+                     nitf::Off dataOffset,
+                     nitf::Off dataLength);
+
+    void saveRows(const sys::ubyte* imageData,
+                  const types::RowCol<size_t>& offset,
+                  const types::RowCol<size_t>& dims,
+                  const ProductLayout& product,
+                  const SegmentLayout& segment,
+                  size_t startRow,
+                  size_t numRows);
+
+    void saveBlocks(const sys::ubyte* imageData,
+                    const types::RowCol<size_t>& offset,
+                    const types::RowCol<size_t>& dims,
+                    const ProductLayout& product,
+                    const SegmentLayout& segment,
+                    size_t startRow,
+                    size_t numRows);
+
+    // Byte swaps the pixels if needed, then writes them to the file
+    void writeAt(nitf::Off fileOffset,
+                 std::vector<sys::ubyte>& pixels,
+                 size_t numBytesPerElement);
+
+private:
+    std::auto_ptr<nitf::IOInterface> mIO;
+    const std::vector<std::string> mSchemaPaths;
+    bool mDoByteSwap;
+    std::vector<ProductLayout> mProducts;
+
+    std::map<BlockKey, PendingBlock> mPendingBlocks;
+    size_t mNumPendingBytes;
+    mutable sys::Mutex mBlockMutex;
+
+    // Guards mIO along with writing the headers
+    sys::Mutex mIOMutex;
+    bool mHaveWrittenHeaders;
+};
+}
+}
+
+#endif
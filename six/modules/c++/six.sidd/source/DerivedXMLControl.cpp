@@ -65,6 +65,17 @@ xml::lite::Document* DerivedXMLControl::toXMLImpl(const Data* data)
     return getParser(data->getVersion())->toXML(sidd);
 }
 
+void DerivedXMLControl::toXMLImpl(const Data* data, std::string& xml)
+{
+    if (data->getDataType() != DataType::DERIVED)
+    {
+        throw except::Exception(Ctxt("Data must be SIDD"));
+    }
+
+    const DerivedData* const sidd(reinterpret_cast<const DerivedData*>(data));
+    getParser(data->getVersion())->toXML(sidd, xml);
+}
+
 std::auto_ptr<DerivedXMLParser>
 DerivedXMLControl::getParser(const std::string& version) const
 {
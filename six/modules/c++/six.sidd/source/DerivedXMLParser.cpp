@@ -51,6 +51,53 @@ DerivedXMLParser::DerivedXMLParser(
 {
 }
 
+xml::lite::Document* DerivedXMLParser::toXML(const DerivedData* derived) const
+{
+    xml::lite::Document* doc = new xml::lite::Document();
+    XMLElem root = newElement("SIDD");
+    doc->setRootElement(root);
+
+    convertSectionsToXML(derived, root);
+
+    //set the ElemNS
+    setNamespaces(root);
+
+    return doc;
+}
+
+void DerivedXMLParser::toXML(const DerivedData* derived, std::string& xml)
+{
+    const size_t offset = xml.size();
+    XMLStreamWriter writer(xml);
+    setStreamWriter(&writer);
+
+    try
+    {
+        const std::auto_ptr<xml::lite::Element> root(newElement("SIDD"));
+
+        // The writer needs the ElemNS before it writes the root
+        setNamespaces(root.get());
+
+        convertSectionsToXML(derived, root.get());
+        writer.finish();
+    }
+    catch (...)
+    {
+        // Don't leave half a document behind
+        xml.resize(offset);
+        setStreamWriter(NULL);
+        throw;
+    }
+
+    setStreamWriter(NULL);
+}
+
+void DerivedXMLParser::setStreamWriter(XMLStreamWriter* writer)
+{
+    XMLParser::setStreamWriter(writer);
+    mCommon->setStreamWriter(writer);
+}
+
 void DerivedXMLParser::getAttributeList(
         const xml::lite::Attributes& attributes,
         const std::string& attributeName,
@@ -1032,7 +1079,25 @@ XMLElem DerivedXMLParser::convertMeasurementToXML(
 {
     XMLElem measurementElem = newElement("Measurement", parent);
 
-    XMLElem projectionElem = newElement("", measurementElem);
+    std::string projectionName;
+    switch (measurement->projection->projectionType)
+    {
+    case ProjectionType::POLYNOMIAL:
+        projectionName = "PolynomialProjection";
+        break;
+    case ProjectionType::GEOGRAPHIC:
+        projectionName = "GeographicProjection";
+        break;
+    case ProjectionType::PLANE:
+        projectionName = "PlaneProjection";
+        break;
+    case ProjectionType::CYLINDRICAL:
+        projectionName = "CylindricalProjection";
+        break;
+    default:
+        throw except::Exception(Ctxt("Unknown projection type!"));
+    }
+    XMLElem projectionElem = newElement(projectionName, measurementElem);
 
     // NOTE: ReferencePoint is present in all of the ProjectionTypes
     //       so its added here for ease
@@ -1054,8 +1119,6 @@ XMLElem DerivedXMLParser::convertMeasurementToXML(
     {
     case ProjectionType::POLYNOMIAL:
     {
-        projectionElem->setLocalName("PolynomialProjection");
-
         PolynomialProjection* polyProj
                 = (PolynomialProjection*) measurement->projection.get();
 
@@ -1075,8 +1138,6 @@ XMLElem DerivedXMLParser::convertMeasurementToXML(
 
     case ProjectionType::GEOGRAPHIC:
     {
-        projectionElem->setLocalName("GeographicProjection");
-
         GeographicProjection* geographicProj
                 = (GeographicProjection*) measurement->projection.get();
 
@@ -1091,8 +1152,6 @@ XMLElem DerivedXMLParser::convertMeasurementToXML(
 
     case ProjectionType::PLANE:
     {
-        projectionElem->setLocalName("PlaneProjection");
-
         PlaneProjection* planeProj
                 = (PlaneProjection*) measurement->projection.get();
 
@@ -1115,8 +1174,6 @@ XMLElem DerivedXMLParser::convertMeasurementToXML(
 
     case ProjectionType::CYLINDRICAL:
     {
-        projectionElem->setLocalName("CylindricalProjection");
-
         CylindricalProjection* cylindricalProj
                 = (CylindricalProjection*) measurement->projection.get();
 
@@ -287,13 +287,9 @@ XMLElem DerivedXMLParser100::convertDerivedClassificationToXML(
     return classElem;
 }
 
-xml::lite::Document*
-DerivedXMLParser100::toXML(const DerivedData* derived) const
+void DerivedXMLParser100::convertSectionsToXML(const DerivedData* derived,
+                                              XMLElem root) const
 {
-    xml::lite::Document* doc = new xml::lite::Document();
-    XMLElem root = newElement("SIDD");
-    doc->setRootElement(root);
-
     convertProductCreationToXML(derived->productCreation.get(), root);
     convertDisplayToXML(*derived->display, root);
     convertGeographicTargetToXML(*derived->geographicAndTarget, root);
@@ -333,14 +329,14 @@ DerivedXMLParser100::toXML(const DerivedData* derived) const
                                    annotationsElem);
         }
     }
+}
 
-    //set the ElemNS
+void DerivedXMLParser100::setNamespaces(XMLElem root) const
+{
     root->setNamespacePrefix("", getDefaultURI());
     root->setNamespacePrefix("si", SI_COMMON_URI);
     root->setNamespacePrefix("sfa", SFA_URI);
     root->setNamespacePrefix("ism", ISM_URI);
-
-    return doc;
 }
 
 XMLElem DerivedXMLParser100::convertDisplayToXML(
@@ -217,12 +217,9 @@ DerivedData* DerivedXMLParser200::fromXML(
     return data;
 }
 
-xml::lite::Document* DerivedXMLParser200::toXML(const DerivedData* derived) const
+void DerivedXMLParser200::convertSectionsToXML(const DerivedData* derived,
+                                              XMLElem root) const
 {
-    xml::lite::Document* doc = new xml::lite::Document();
-    XMLElem root = newElement("SIDD");
-    doc->setRootElement(root);
-
     convertProductCreationToXML(derived->productCreation.get(), root);
     convertDisplayToXML(*derived->display, root);
     convertGeoDataToXML(derived->geoData.get(), root);
@@ -279,14 +276,14 @@ xml::lite::Document* DerivedXMLParser200::toXML(const DerivedData* derived) cons
                                    annotationsElem);
         }
     }
+}
 
-    //set the ElemNS
+void DerivedXMLParser200::setNamespaces(XMLElem root) const
+{
     root->setNamespacePrefix("", getDefaultURI());
     root->setNamespacePrefix("si", SI_COMMON_URI);
     root->setNamespacePrefix("sfa", SFA_URI);
     root->setNamespacePrefix("ism", ISM_URI);
-
-    return doc;
 }
 
 void DerivedXMLParser200::parseDerivedClassificationFromXML(
@@ -1123,15 +1120,9 @@ XMLElem DerivedXMLParser200::convertNonInteractiveProcessingToXML(
         }
         for (size_t ii = 0; ii < bandEq.bandLUTs.size(); ++ii)
         {
-            convertLookupTableToXML("BandLUT", *bandEq.bandLUTs[ii], bandEqElem);
-        }
-
-        //add the attribute to each of the LUTs
-        std::vector<XMLElem> LUTElems;
-        bandEqElem->getElementsByTagName("BandLUT", LUTElems);
-        for (size_t ii = 0; ii < LUTElems.size(); ++ii)
-        {
-            setAttribute(LUTElems[ii], "k", str::toString(ii+1));
+            XMLElem lutElem = convertLookupTableToXML(
+                    "BandLUT", *bandEq.bandLUTs[ii], bandEqElem);
+            setAttribute(lutElem, "k", str::toString(ii+1));
         }
     }
 
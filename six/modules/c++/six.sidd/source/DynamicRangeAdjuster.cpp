@@ -0,0 +1,904 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <except/Exception.h>
+#include <str/Convert.h>
+#include <sys/Conf.h>
+#include <sys/OS.h>
+#include <sys/Runnable.h>
+#include <six/Init.h>
+#include <six/Region.h>
+#include <six/sidd/DynamicRangeAdjuster.h>
+
+namespace
+{
+// Fewer pixels than this aren't worth handing to another thread
+const size_t MIN_PIXELS_PER_CHUNK = 64 * 1024;
+
+// Number of bins in the histogram of complex amplitudes
+const size_t NUM_AMPLITUDE_BINS = 65536;
+
+const double MAX_OUTPUT = 255.0;
+
+// Default size of the swaths of an image to read at once
+const size_t SWATH_BYTES = 32 * 1024 * 1024;
+
+size_t getNumThreads(size_t numThreads)
+{
+    return (numThreads == 0) ? sys::OS().getNumCPUs() : numThreads;
+}
+
+bool isFraction(double value)
+{
+    return !six::Init::isUndefined(value) && value >= 0.0 && value <= 1.0;
+}
+
+six::UByte remapValue(double value, double subtractor, double multiplier)
+{
+    const double remapped = (value - subtractor) * multiplier;
+    return static_cast<six::UByte>(
+            std::min(std::max(remapped, 0.0), MAX_OUTPUT) + 0.5);
+}
+
+size_t getNumBands(six::PixelType pixelType)
+{
+    switch (pixelType)
+    {
+    case six::PixelType::MONO8I:
+    case six::PixelType::MONO16I:
+        return 1;
+    case six::PixelType::RGB24I:
+        return 3;
+    default:
+        throw except::Exception(Ctxt(
+                "Dynamic range adjustment isn't supported for pixel type " +
+                pixelType.toString()));
+    }
+}
+
+// Histogram of one band of some rows of an integer image
+template <typename T>
+class IntegerHistogram : public sys::Runnable
+{
+public:
+    IntegerHistogram(const T* image,
+                     size_t numPixels,
+                     size_t numBands,
+                     std::vector<sys::Uint64_T>& histogram) :
+        mImage(image),
+        mNumPixels(numPixels),
+        mNumBands(numBands),
+        mHistogram(histogram)
+    {
+    }
+
+    virtual void run()
+    {
+        mHistogram.assign(static_cast<size_t>(
+                std::numeric_limits<T>::max()) + 1, 0);
+        for (size_t ii = 0; ii < mNumPixels; ++ii)
+        {
+            ++mHistogram[mImage[ii * mNumBands]];
+        }
+    }
+
+private:
+    const T* mImage;
+    size_t mNumPixels;
+    size_t mNumBands;
+    std::vector<sys::Uint64_T>& mHistogram;
+};
+
+// Smallest and largest amplitudes of some complex pixels
+class AmplitudeRange : public sys::Runnable
+{
+public:
+    AmplitudeRange(const std::complex<float>* image, size_t numPixels) :
+        mImage(image),
+        mNumPixels(numPixels),
+        mMinNorm(std::numeric_limits<float>::max()),
+        mMaxNorm(0)
+    {
+    }
+
+    virtual void run()
+    {
+        // Compare the squared amplitudes, and only take the square roots of
+        // the extremes
+        float minNorm = mMinNorm;
+        float maxNorm = mMaxNorm;
+        for (size_t ii = 0; ii < mNumPixels; ++ii)
+        {
+            const float norm = mImage[ii].real() * mImage[ii].real() +
+                    mImage[ii].imag() * mImage[ii].imag();
+            minNorm = std::min(minNorm, norm);
+            maxNorm = std::max(maxNorm, norm);
+        }
+        mMinNorm = minNorm;
+        mMaxNorm = maxNorm;
+    }
+
+    double getMin() const
+    {
+        return std::sqrt(static_cast<double>(mMinNorm));
+    }
+
+    double getMax() const
+    {
+        return std::sqrt(static_cast<double>(mMaxNorm));
+    }
+
+private:
+    const std::complex<float>* mImage;
+    size_t mNumPixels;
+    float mMinNorm;
+    float mMaxNorm;
+};
+
+// Histogram of the amplitudes of some complex pixels
+class AmplitudeHistogram : public sys::Runnable
+{
+public:
+    AmplitudeHistogram(const std::complex<float>* image,
+                       size_t numPixels,
+                       double minAmplitude,
+                       double binsPerAmplitude,
+                       std::vector<sys::Uint64_T>& histogram) :
+        mImage(image),
+        mNumPixels(numPixels),
+        mMinAmplitude(minAmplitude),
+        mBinsPerAmplitude(binsPerAmplitude),
+        mHistogram(histogram)
+    {
+    }
+
+    virtual void run()
+    {
+        mHistogram.assign(NUM_AMPLITUDE_BINS, 0);
+        for (size_t ii = 0; ii < mNumPixels; ++ii)
+        {
+            const float norm = mImage[ii].real() * mImage[ii].real() +
+                    mImage[ii].imag() * mImage[ii].imag();
+            const double amplitude = std::sqrt(static_cast<double>(norm));
+            const double bin =
+                    (amplitude - mMinAmplitude) * mBinsPerAmplitude;
+            ++mHistogram[std::min(static_cast<size_t>(std::max(bin, 0.0)),
+                                  NUM_AMPLITUDE_BINS - 1)];
+        }
+    }
+
+private:
+    const std::complex<float>* mImage;
+    size_t mNumPixels;
+    double mMinAmplitude;
+    double mBinsPerAmplitude;
+    std::vector<sys::Uint64_T>& mHistogram;
+};
+
+// Remaps integer samples through a lookup table
+template <typename T>
+class LookupRemap : public sys::Runnable
+{
+public:
+    LookupRemap(const std::vector<six::UByte>& lut,
+                const T* input,
+                size_t numSamples,
+                six::UByte* output) :
+        mLUT(lut),
+        mInput(input),
+        mNumSamples(numSamples),
+        mOutput(output)
+    {
+    }
+
+    virtual void run()
+    {
+        const six::UByte* const lut = &mLUT[0];
+        for (size_t ii = 0; ii < mNumSamples; ++ii)
+        {
+            mOutput[ii] = lut[mInput[ii]];
+        }
+    }
+
+private:
+    const std::vector<six::UByte>& mLUT;
+    const T* mInput;
+    size_t mNumSamples;
+    six::UByte* mOutput;
+};
+
+// Detects and remaps complex pixels.  The loop has no branches so that it
+// vectorizes.
+class AmplitudeRemap : public sys::Runnable
+{
+public:
+    AmplitudeRemap(const std::complex<float>* input,
+                   size_t numPixels,
+                   double subtractor,
+                   double multiplier,
+                   six::UByte* output) :
+        mInput(reinterpret_cast<const float*>(input)),
+        mNumPixels(numPixels),
+        mSubtractor(static_cast<float>(subtractor)),
+        mMultiplier(static_cast<float>(multiplier)),
+        mOutput(output)
+    {
+    }
+
+    virtual void run()
+    {
+        const float maxOutput = static_cast<float>(MAX_OUTPUT);
+        for (size_t ii = 0; ii < mNumPixels; ++ii)
+        {
+            const float real = mInput[2 * ii];
+            const float imag = mInput[2 * ii + 1];
+            float value = (std::sqrt(real * real + imag * imag) -
+                    mSubtractor) * mMultiplier;
+            value = std::min(std::max(value, 0.0f), maxOutput);
+            mOutput[ii] = static_cast<six::UByte>(value + 0.5f);
+        }
+    }
+
+private:
+    const float* mInput;
+    size_t mNumPixels;
+    float mSubtractor;
+    float mMultiplier;
+    six::UByte* mOutput;
+};
+
+// Adds each histogram to the total, which may be empty
+void addHistograms(std::vector<std::vector<sys::Uint64_T> >& histograms,
+                   std::vector<sys::Uint64_T>& total)
+{
+    size_t chunk = 0;
+    if (total.empty())
+    {
+        total.swap(histograms[0]);
+        chunk = 1;
+    }
+    for (; chunk < histograms.size(); ++chunk)
+    {
+        for (size_t ii = 0; ii < total.size(); ++ii)
+        {
+            total[ii] += histograms[chunk][ii];
+        }
+    }
+}
+
+// Merges every 2^shift bins of a histogram into one, starting at bin 0
+void mergeBins(size_t shift, std::vector<sys::Uint64_T>& histogram)
+{
+    for (size_t ii = 0; ii < histogram.size(); ++ii)
+    {
+        const sys::Uint64_T count = histogram[ii];
+        histogram[ii] = 0;
+        histogram[ii >> shift] += count;
+    }
+}
+
+template <typename T>
+void computeIntegerHistogram(six::ThreadPool& threadPool,
+                             const T* image,
+                             const types::RowCol<size_t>& dims,
+                             size_t numBands,
+                             size_t band,
+                             size_t rowsPerChunk,
+                             std::vector<sys::Uint64_T>& histogram)
+{
+    const size_t numChunks = (dims.row + rowsPerChunk - 1) / rowsPerChunk;
+    std::vector<std::vector<sys::Uint64_T> > histograms(numChunks);
+    std::vector<IntegerHistogram<T> > runnables;
+    runnables.reserve(numChunks);
+    for (size_t chunk = 0; chunk < numChunks; ++chunk)
+    {
+        const size_t firstRow = chunk * rowsPerChunk;
+        const size_t numRows = std::min(rowsPerChunk, dims.row - firstRow);
+        runnables.push_back(IntegerHistogram<T>(
+                image + firstRow * dims.col * numBands + band,
+                numRows * dims.col,
+                numBands,
+                histograms[chunk]));
+    }
+    threadPool.runEach(runnables);
+    addHistograms(histograms, histogram);
+}
+
+template <typename T>
+void remapIntegers(six::ThreadPool& threadPool,
+                   const T* image,
+                   const types::RowCol<size_t>& dims,
+                   size_t numBands,
+                   size_t rowsPerChunk,
+                   const six::sidd::DynamicRangeAdjustment::DRAOverrides& remap,
+                   six::UByte* output)
+{
+    std::vector<six::UByte> lut(
+            static_cast<size_t>(std::numeric_limits<T>::max()) + 1);
+    for (size_t ii = 0; ii < lut.size(); ++ii)
+    {
+        lut[ii] = remapValue(static_cast<double>(ii),
+                             remap.subtractor,
+                             remap.multiplier);
+    }
+
+    const size_t samplesPerRow = dims.col * numBands;
+    std::vector<LookupRemap<T> > runnables;
+    for (size_t firstRow = 0; firstRow < dims.row; firstRow += rowsPerChunk)
+    {
+        const size_t numRows = std::min(rowsPerChunk, dims.row - firstRow);
+        runnables.push_back(LookupRemap<T>(
+                lut,
+                image + firstRow * samplesPerRow,
+                numRows * samplesPerRow,
+                output + firstRow * samplesPerRow));
+    }
+    threadPool.runEach(runnables);
+}
+
+six::sidd::DynamicRangeAdjustment& getDRA(six::sidd::DerivedData& data,
+                                          size_t processingIndex)
+{
+    if (data.display.get() == NULL ||
+        processingIndex >= data.display->interactiveProcessing.size() ||
+        data.display->interactiveProcessing[processingIndex].get() == NULL)
+    {
+        throw except::Exception(Ctxt(
+                "Interactive processing " + str::toString(processingIndex) +
+                " does not exist"));
+    }
+    return data.display->interactiveProcessing[processingIndex]->
+            dynamicRangeAdjustment;
+}
+}
+
+namespace six
+{
+namespace sidd
+{
+DynamicRangeAdjuster::Statistics::Statistics() :
+    minValue(Init::undefined<double>()),
+    maxValue(Init::undefined<double>()),
+    pMinValue(Init::undefined<double>()),
+    pMaxValue(Init::undefined<double>())
+{
+}
+
+DynamicRangeAdjuster::DynamicRangeAdjuster(const DynamicRangeAdjustment& dra,
+                                           size_t numThreads) :
+    mAlgorithmType(dra.algorithmType),
+    mBandStatsSource(dra.bandStatsSource),
+    mHaveRemap(false),
+    mNumPixelsAdded(0),
+    mAddedComplex(false),
+    mBinWidth(0.0),
+    mMinAmplitude(0.0),
+    mMaxAmplitude(0.0),
+    mOwnedThreadPool(new six::ThreadPool(getNumThreads(numThreads))),
+    mThreadPool(*mOwnedThreadPool)
+{
+    init(dra);
+}
+
+DynamicRangeAdjuster::DynamicRangeAdjuster(const DynamicRangeAdjustment& dra,
+                                           six::ThreadPool& threadPool) :
+    mAlgorithmType(dra.algorithmType),
+    mBandStatsSource(dra.bandStatsSource),
+    mHaveRemap(false),
+    mNumPixelsAdded(0),
+    mAddedComplex(false),
+    mBinWidth(0.0),
+    mMinAmplitude(0.0),
+    mMaxAmplitude(0.0),
+    mThreadPool(threadPool)
+{
+    init(dra);
+}
+
+void DynamicRangeAdjuster::init(const DynamicRangeAdjustment& dra)
+{
+    switch (mAlgorithmType)
+    {
+    case DRAType::AUTO:
+        if (dra.draParameters.get() == NULL)
+        {
+            throw except::Exception(Ctxt(
+                    "AUTO dynamic range adjustment requires DRA parameters"));
+        }
+        mParameters = *dra.draParameters;
+        if (!isFraction(mParameters.pMin) ||
+            !isFraction(mParameters.pMax) ||
+            !isFraction(mParameters.eMinModifier) ||
+            !isFraction(mParameters.eMaxModifier) ||
+            mParameters.pMin > mParameters.pMax)
+        {
+            throw except::Exception(Ctxt(
+                    "DRA parameters must be in [0, 1], with pMin <= pMax"));
+        }
+        break;
+    case DRAType::MANUAL:
+        if (dra.draOverrides.get() == NULL ||
+            Init::isUndefined(dra.draOverrides->subtractor) ||
+            Init::isUndefined(dra.draOverrides->multiplier))
+        {
+            throw except::Exception(Ctxt(
+                    "MANUAL dynamic range adjustment requires DRA overrides"));
+        }
+        mRemap = *dra.draOverrides;
+        mHaveRemap = true;
+        break;
+    case DRAType::NONE:
+        mRemap.subtractor = 0.0;
+        mRemap.multiplier = 1.0;
+        mHaveRemap = true;
+        break;
+    default:
+        throw except::Exception(Ctxt(
+                "Dynamic range adjustment algorithm type is not set"));
+    }
+}
+
+size_t DynamicRangeAdjuster::getStatsBand(PixelType pixelType) const
+{
+    const size_t numBands = getNumBands(pixelType);
+    if (Init::isUndefined(mBandStatsSource))
+    {
+        return 0;
+    }
+    if (mBandStatsSource == 0 || mBandStatsSource > numBands)
+    {
+        throw except::Exception(Ctxt(
+                "Band stats source " + str::toString(mBandStatsSource) +
+                " is not a band of " + pixelType.toString() + " pixels"));
+    }
+    return mBandStatsSource - 1;
+}
+
+size_t DynamicRangeAdjuster::getRowsPerChunk(
+        const types::RowCol<size_t>& dims) const
+{
+    const size_t numChunks = std::min(
+            mThreadPool.getNumChunks(dims.area(), MIN_PIXELS_PER_CHUNK),
+            std::max<size_t>(dims.row, 1));
+    return std::max<size_t>((dims.row + numChunks - 1) / numChunks, 1);
+}
+
+void DynamicRangeAdjuster::computeStatistics(const UByte* image,
+                                             PixelType pixelType,
+                                             const types::RowCol<size_t>& dims)
+{
+    if (dims.area() == 0)
+    {
+        throw except::Exception(Ctxt("Image is empty"));
+    }
+
+    clearHistogram();
+    addRows(image, pixelType, dims);
+    finishStatistics();
+}
+
+void DynamicRangeAdjuster::computeStatistics(
+        const std::complex<float>* image,
+        const types::RowCol<size_t>& dims)
+{
+    if (dims.area() == 0)
+    {
+        throw except::Exception(Ctxt("Image is empty"));
+    }
+
+    clearHistogram();
+    addRows(image, dims);
+    finishStatistics();
+}
+
+void DynamicRangeAdjuster::computeStatistics(ReadControl& reader,
+                                             size_t imageNumber,
+                                             size_t numRowsPerSwath)
+{
+    mem::SharedPtr<const Container> container = reader.getContainer();
+    if (container.get() == NULL || imageNumber >= container->getNumData())
+    {
+        throw except::Exception(Ctxt(
+                "Image " + str::toString(imageNumber) + " does not exist"));
+    }
+    const Data& data(*container->getData(imageNumber));
+    const PixelType pixelType = data.getPixelType();
+    const bool isComplex = (pixelType == PixelType::RE32F_IM32F);
+    if (!isComplex)
+    {
+        // Throws if the pixel type isn't supported
+        getNumBands(pixelType);
+    }
+
+    const types::RowCol<size_t> dims(data.getNumRows(), data.getNumCols());
+    if (dims.area() == 0)
+    {
+        throw except::Exception(Ctxt("Image is empty"));
+    }
+    const size_t numBytesPerRow = dims.col * data.getNumBytesPerPixel();
+    if (numRowsPerSwath == 0)
+    {
+        numRowsPerSwath = std::max<size_t>(SWATH_BYTES / numBytesPerRow, 1);
+    }
+    numRowsPerSwath = std::min(numRowsPerSwath, dims.row);
+
+    clearHistogram();
+    std::vector<UByte> swath(numRowsPerSwath * numBytesPerRow);
+    for (size_t row = 0; row < dims.row; row += numRowsPerSwath)
+    {
+        const size_t numRows = std::min(numRowsPerSwath, dims.row - row);
+        Region region;
+        region.setStartRow(row);
+        region.setNumRows(numRows);
+        region.setStartCol(0);
+        region.setNumCols(dims.col);
+        region.setBuffer(&swath[0]);
+        reader.interleaved(region, imageNumber);
+
+        const types::RowCol<size_t> swathDims(numRows, dims.col);
+        if (isComplex)
+        {
+            addRows(reinterpret_cast<const std::complex<float>*>(&swath[0]),
+                    swathDims);
+        }
+        else
+        {
+            addRows(&swath[0], pixelType, swathDims);
+        }
+    }
+    finishStatistics();
+}
+
+void DynamicRangeAdjuster::startAdding(bool isComplex, PixelType pixelType)
+{
+    if (mNumPixelsAdded != 0 &&
+        (isComplex != mAddedComplex || pixelType != mAddedPixelType))
+    {
+        throw except::Exception(Ctxt(
+                "Rows must have the same pixel type as the rows already "
+                "added"));
+    }
+    mAddedComplex = isComplex;
+    mAddedPixelType = pixelType;
+}
+
+void DynamicRangeAdjuster::clearHistogram()
+{
+    mHistogram.clear();
+    mNumPixelsAdded = 0;
+}
+
+void DynamicRangeAdjuster::addRows(const UByte* rows,
+                                   PixelType pixelType,
+                                   const types::RowCol<size_t>& dims)
+{
+    const size_t band = getStatsBand(pixelType);
+    startAdding(false, pixelType);
+    if (dims.area() == 0)
+    {
+        return;
+    }
+
+    if (pixelType == PixelType::MONO16I)
+    {
+        computeIntegerHistogram(mThreadPool,
+                                reinterpret_cast<const sys::Uint16_T*>(rows),
+                                dims, 1, band, getRowsPerChunk(dims),
+                                mHistogram);
+    }
+    else
+    {
+        computeIntegerHistogram(mThreadPool, rows, dims,
+                                getNumBands(pixelType), band,
+                                getRowsPerChunk(dims), mHistogram);
+    }
+    mNumPixelsAdded += dims.area();
+}
+
+void DynamicRangeAdjuster::addRows(const std::complex<float>* rows,
+                                   const types::RowCol<size_t>& dims)
+{
+    startAdding(true, PixelType::RE32F_IM32F);
+    if (dims.area() == 0)
+    {
+        return;
+    }
+
+    // One pass for the range of amplitudes, and another to bin them
+    const size_t rowsPerChunk = getRowsPerChunk(dims);
+    std::vector<AmplitudeRange> ranges;
+    for (size_t firstRow = 0; firstRow < dims.row; firstRow += rowsPerChunk)
+    {
+        const size_t numRows = std::min(rowsPerChunk, dims.row - firstRow);
+        ranges.push_back(AmplitudeRange(rows + firstRow * dims.col,
+                                        numRows * dims.col));
+    }
+    mThreadPool.runEach(ranges);
+
+    double minAmplitude = ranges[0].getMin();
+    double maxAmplitude = ranges[0].getMax();
+    for (size_t ii = 1; ii < ranges.size(); ++ii)
+    {
+        minAmplitude = std::min(minAmplitude, ranges[ii].getMin());
+        maxAmplitude = std::max(maxAmplitude, ranges[ii].getMax());
+    }
+
+    if (mNumPixelsAdded == 0)
+    {
+        // The smallest power of two that fits the largest amplitude in the
+        // last bin
+        int exponent;
+        std::frexp(std::max(maxAmplitude / NUM_AMPLITUDE_BINS,
+                            static_cast<double>(
+                                    std::numeric_limits<float>::min())),
+                   &exponent);
+        mBinWidth = std::ldexp(1.0, exponent);
+        mMinAmplitude = minAmplitude;
+        mMaxAmplitude = maxAmplitude;
+    }
+    else
+    {
+        mMinAmplitude = std::min(mMinAmplitude, minAmplitude);
+        mMaxAmplitude = std::max(mMaxAmplitude, maxAmplitude);
+
+        // Since the bins start at zero and double in width, each new bin is
+        // made of whole old ones
+        size_t shift = 0;
+        while (mBinWidth * NUM_AMPLITUDE_BINS <= mMaxAmplitude)
+        {
+            mBinWidth *= 2;
+            ++shift;
+        }
+        if (shift != 0)
+        {
+            mergeBins(shift, mHistogram);
+        }
+    }
+
+    std::vector<std::vector<sys::Uint64_T> > histograms(ranges.size());
+    std::vector<AmplitudeHistogram> runnables;
+    runnables.reserve(ranges.size());
+    for (size_t chunk = 0; chunk < ranges.size(); ++chunk)
+    {
+        const size_t firstRow = chunk * rowsPerChunk;
+        const size_t numRows = std::min(rowsPerChunk, dims.row - firstRow);
+        runnables.push_back(AmplitudeHistogram(rows + firstRow * dims.col,
+                                               numRows * dims.col,
+                                               0.0,
+                                               1.0 / mBinWidth,
+                                               histograms[chunk]));
+    }
+    mThreadPool.runEach(runnables);
+    addHistograms(histograms, mHistogram);
+    mNumPixelsAdded += dims.area();
+}
+
+void DynamicRangeAdjuster::finishStatistics()
+{
+    if (mNumPixelsAdded == 0)
+    {
+        throw except::Exception(Ctxt("No pixels have been added"));
+    }
+
+    if (mAddedComplex)
+    {
+        // Each bin is represented by its center
+        setStatistics(mHistogram, mBinWidth / 2, mBinWidth,
+                      mMinAmplitude, mMaxAmplitude);
+    }
+    else
+    {
+        size_t minBin = 0;
+        while (mHistogram[minBin] == 0)
+        {
+            ++minBin;
+        }
+        size_t maxBin = mHistogram.size() - 1;
+        while (mHistogram[maxBin] == 0)
+        {
+            --maxBin;
+        }
+        setStatistics(mHistogram, 0.0, 1.0, static_cast<double>(minBin),
+                      static_cast<double>(maxBin));
+    }
+    clearHistogram();
+}
+
+void DynamicRangeAdjuster::setStatistics(
+        const std::vector<sys::Uint64_T>& histogram,
+        double firstValue,
+        double binWidth,
+        double minValue,
+        double maxValue)
+{
+    sys::Uint64_T numPixels = 0;
+    for (size_t ii = 0; ii < histogram.size(); ++ii)
+    {
+        numPixels += histogram[ii];
+    }
+
+    // The first bins at which the cumulative histogram reaches pMin and
+    // pMax of the pixels
+    const double lowCount = std::max(
+            std::ceil(mParameters.pMin * numPixels), 1.0);
+    const double highCount = std::max(
+            std::ceil(mParameters.pMax * numPixels), 1.0);
+    size_t lowBin = histogram.size() - 1;
+    size_t highBin = histogram.size() - 1;
+    bool foundLow = false;
+    sys::Uint64_T count = 0;
+    for (size_t ii = 0; ii < histogram.size(); ++ii)
+    {
+        count += histogram[ii];
+        if (!foundLow && static_cast<double>(count) >= lowCount)
+        {
+            lowBin = ii;
+            foundLow = true;
+        }
+        if (static_cast<double>(count) >= highCount)
+        {
+            highBin = ii;
+            break;
+        }
+    }
+
+    mStatistics.minValue = minValue;
+    mStatistics.maxValue = maxValue;
+    mStatistics.pMinValue = std::min(std::max(
+            firstValue + lowBin * binWidth, minValue), maxValue);
+    mStatistics.pMaxValue = std::min(std::max(
+            firstValue + highBin * binWidth, minValue), maxValue);
+
+    if (mAlgorithmType == DRAType::AUTO)
+    {
+        const double eMin = mStatistics.pMinValue - mParameters.eMinModifier *
+                (mStatistics.pMinValue - minValue);
+        const double eMax = mStatistics.pMaxValue + mParameters.eMaxModifier *
+                (maxValue - mStatistics.pMaxValue);
+        mRemap.subtractor = eMin;
+        mRemap.multiplier = (eMax > eMin) ? MAX_OUTPUT / (eMax - eMin) : 1.0;
+        mHaveRemap = true;
+    }
+}
+
+const DynamicRangeAdjustment::DRAOverrides&
+DynamicRangeAdjuster::getRemap() const
+{
+    if (!mHaveRemap)
+    {
+        throw except::Exception(Ctxt(
+                "Statistics must be computed before AUTO dynamic range "
+                "adjustment"));
+    }
+    return mRemap;
+}
+
+void DynamicRangeAdjuster::apply(const UByte* image,
+                                 PixelType pixelType,
+                                 const types::RowCol<size_t>& dims,
+                                 UByte* output) const
+{
+    const DynamicRangeAdjustment::DRAOverrides& remap = getRemap();
+    const size_t numBands = getNumBands(pixelType);
+    if (pixelType == PixelType::MONO16I)
+    {
+        remapIntegers(mThreadPool,
+                      reinterpret_cast<const sys::Uint16_T*>(image),
+                      dims, numBands, getRowsPerChunk(dims), remap, output);
+    }
+    else
+    {
+        remapIntegers(mThreadPool, image, dims, numBands,
+                      getRowsPerChunk(dims), remap, output);
+    }
+}
+
+void DynamicRangeAdjuster::apply(const std::complex<float>* image,
+                                 const types::RowCol<size_t>& dims,
+                                 UByte* output) const
+{
+    const DynamicRangeAdjustment::DRAOverrides& remap = getRemap();
+    const size_t rowsPerChunk = getRowsPerChunk(dims);
+    std::vector<AmplitudeRemap> runnables;
+    for (size_t firstRow = 0; firstRow < dims.row; firstRow += rowsPerChunk)
+    {
+        const size_t numRows = std::min(rowsPerChunk, dims.row - firstRow);
+        runnables.push_back(AmplitudeRemap(image + firstRow * dims.col,
+                                           numRows * dims.col,
+                                           remap.subtractor,
+                                           remap.multiplier,
+                                           output + firstRow * dims.col));
+    }
+    mThreadPool.runEach(runnables);
+}
+
+void DynamicRangeAdjuster::update(DynamicRangeAdjustment& dra) const
+{
+    if (mAlgorithmType == DRAType::AUTO)
+    {
+        dra.draOverrides.reset(
+                new DynamicRangeAdjustment::DRAOverrides(getRemap()));
+    }
+}
+
+void DynamicRangeAdjuster::adjust(DerivedData& data,
+                                  const UByte* image,
+                                  UByte* output,
+                                  size_t numThreads,
+                                  size_t processingIndex)
+{
+    six::ThreadPool threadPool(getNumThreads(numThreads));
+    adjust(data, image, output, threadPool, processingIndex);
+}
+
+void DynamicRangeAdjuster::adjust(DerivedData& data,
+                                  const UByte* image,
+                                  UByte* output,
+                                  six::ThreadPool& threadPool,
+                                  size_t processingIndex)
+{
+    DynamicRangeAdjustment& dra = getDRA(data, processingIndex);
+    const types::RowCol<size_t> dims(data.getNumRows(), data.getNumCols());
+
+    DynamicRangeAdjuster adjuster(dra, threadPool);
+    if (adjuster.needsStatistics())
+    {
+        adjuster.computeStatistics(image, data.getPixelType(), dims);
+    }
+    adjuster.apply(image, data.getPixelType(), dims, output);
+    adjuster.update(dra);
+}
+
+void DynamicRangeAdjuster::adjust(DerivedData& data,
+                                  const std::complex<float>* image,
+                                  const types::RowCol<size_t>& dims,
+                                  UByte* output,
+                                  size_t numThreads,
+                                  size_t processingIndex)
+{
+    six::ThreadPool threadPool(getNumThreads(numThreads));
+    adjust(data, image, dims, output, threadPool, processingIndex);
+}
+
+void DynamicRangeAdjuster::adjust(DerivedData& data,
+                                  const std::complex<float>* image,
+                                  const types::RowCol<size_t>& dims,
+                                  UByte* output,
+                                  six::ThreadPool& threadPool,
+                                  size_t processingIndex)
+{
+    DynamicRangeAdjustment& dra = getDRA(data, processingIndex);
+
+    DynamicRangeAdjuster adjuster(dra, threadPool);
+    if (adjuster.needsStatistics())
+    {
+        adjuster.computeStatistics(image, dims);
+    }
+    adjuster.apply(image, dims, output);
+    adjuster.update(dra);
+}
+}
+}
@@ -0,0 +1,966 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <cmath>
+
+#include <except/Exception.h>
+#include <sys/Conf.h>
+#include <sys/OS.h>
+#include <sys/Runnable.h>
+#include <six/Init.h>
+#include <six/sidd/ImageFilter.h>
+
+namespace
+{
+// Rows and columns of each output tile, except with FFTs
+const size_t TILE_SIZE = 256;
+
+// Kernels with at least this many coefficients that aren't separable are
+// applied with FFTs
+const size_t MIN_FFT_KERNEL_SIZE = 121;
+
+// Number of phases to sample predefined filter banks at
+const size_t NUM_PREDEFINED_PHASINGS = 64;
+
+// How closely a kernel must match the outer product of its row and column
+// to be separable, relative to its largest coefficient
+const double SEPARABLE_TOLERANCE = 1e-6;
+
+size_t getNumThreads(size_t numThreads)
+{
+    return (numThreads == 0) ? sys::OS().getNumCPUs() : numThreads;
+}
+
+size_t getNumBands(six::PixelType pixelType)
+{
+    switch (pixelType)
+    {
+    case six::PixelType::MONO8I:
+    case six::PixelType::MONO16I:
+        return 1;
+    case six::PixelType::RGB24I:
+        return 3;
+    default:
+        throw except::Exception(Ctxt(
+                "Filtering isn't supported for pixel type " +
+                pixelType.toString()));
+    }
+}
+
+size_t nextPowerOfTwo(size_t value)
+{
+    size_t power = 1;
+    while (power < value)
+    {
+        power <<= 1;
+    }
+    return power;
+}
+
+size_t clampIndex(ptrdiff_t index, size_t size)
+{
+    return (index < 0) ? 0 : std::min(static_cast<size_t>(index), size - 1);
+}
+
+template <typename T>
+T toSample(float value);
+
+template <>
+float toSample<float>(float value)
+{
+    return value;
+}
+
+template <>
+six::UByte toSample<six::UByte>(float value)
+{
+    return static_cast<six::UByte>(
+            std::min(std::max(value, 0.0f), 255.0f) + 0.5f);
+}
+
+template <>
+sys::Uint16_T toSample<sys::Uint16_T>(float value)
+{
+    return static_cast<sys::Uint16_T>(
+            std::min(std::max(value, 0.0f), 65535.0f) + 0.5f);
+}
+
+// One band of a pixel interleaved image.  data points to the band's
+// sample of the first pixel.
+template <typename T>
+struct Band
+{
+    Band(T* data_, const types::RowCol<size_t>& dims_, size_t numBands_) :
+        data(data_),
+        dims(dims_),
+        numBands(numBands_)
+    {
+    }
+
+    T* data;
+    types::RowCol<size_t> dims;
+    size_t numBands;
+};
+
+// Reads a region of a band into a float buffer.  The region may extend past
+// the edges of the image, which are repeated.
+template <typename T>
+void readRegion(const Band<const T>& band,
+                ptrdiff_t firstRow,
+                ptrdiff_t firstCol,
+                size_t numRows,
+                size_t numCols,
+                float* buffer)
+{
+    std::vector<size_t> offsets(numCols);
+    for (size_t jj = 0; jj < numCols; ++jj)
+    {
+        offsets[jj] = clampIndex(firstCol + static_cast<ptrdiff_t>(jj),
+                                 band.dims.col) * band.numBands;
+    }
+
+    for (size_t ii = 0; ii < numRows; ++ii)
+    {
+        const size_t row = clampIndex(firstRow + static_cast<ptrdiff_t>(ii),
+                                      band.dims.row);
+        const T* const input = band.data + row * band.dims.col * band.numBands;
+        float* const out = buffer + ii * numCols;
+        for (size_t jj = 0; jj < numCols; ++jj)
+        {
+            out[jj] = static_cast<float>(input[offsets[jj]]);
+        }
+    }
+}
+
+// Writes a float buffer into a region of a band
+template <typename T>
+void writeRegion(const float* buffer,
+                 size_t firstRow,
+                 size_t firstCol,
+                 size_t numRows,
+                 size_t numCols,
+                 const Band<T>& band)
+{
+    for (size_t ii = 0; ii < numRows; ++ii)
+    {
+        T* const output = band.data +
+                ((firstRow + ii) * band.dims.col + firstCol) * band.numBands;
+        const float* const in = buffer + ii * numCols;
+        for (size_t jj = 0; jj < numCols; ++jj)
+        {
+            output[jj * band.numBands] = toSample<T>(in[jj]);
+        }
+    }
+}
+
+// Interpolation weights at fractional offset 'frac' past the first of
+// numPoints samples centered on the interpolation point
+void getPredefinedWeights(six::sidd::FilterDatabaseName name,
+                          double frac,
+                          double* weights)
+{
+    switch (name)
+    {
+    case six::sidd::FilterDatabaseName::NEAREST_NEIGHBOR:
+        weights[0] = (frac < 0.5) ? 1.0 : 0.0;
+        weights[1] = 1.0 - weights[0];
+        break;
+    case six::sidd::FilterDatabaseName::BILINEAR:
+        weights[0] = 1.0 - frac;
+        weights[1] = frac;
+        break;
+    case six::sidd::FilterDatabaseName::CUBIC:
+    {
+        // Keys' cubic convolution with a = -0.5, at samples -1 through 2
+        const double a = -0.5;
+        for (size_t ii = 0; ii < 4; ++ii)
+        {
+            const double x = std::abs(frac - (static_cast<double>(ii) - 1));
+            weights[ii] = (x <= 1) ?
+                    ((a + 2) * x - (a + 3)) * x * x + 1 :
+                    ((a * x - 5 * a) * x + 8 * a) * x - 4 * a;
+        }
+        break;
+    }
+    case six::sidd::FilterDatabaseName::LAGRANGE:
+        // Cubic Lagrange polynomials through samples -1 through 2
+        for (size_t ii = 0; ii < 4; ++ii)
+        {
+            const double node = static_cast<double>(ii) - 1;
+            weights[ii] = 1.0;
+            for (size_t jj = 0; jj < 4; ++jj)
+            {
+                if (jj != ii)
+                {
+                    const double other = static_cast<double>(jj) - 1;
+                    weights[ii] *= (frac - other) / (node - other);
+                }
+            }
+        }
+        break;
+    default:
+        throw except::Exception(Ctxt("Filter database name is not set"));
+    }
+}
+
+size_t getPredefinedNumPoints(six::sidd::FilterDatabaseName name)
+{
+    return (name == six::sidd::FilterDatabaseName::CUBIC ||
+            name == six::sidd::FilterDatabaseName::LAGRANGE) ? 4 : 2;
+}
+
+// Where an output sample of resample() falls in the input
+struct AxisSample
+{
+    // First input sample the bank is applied to
+    ptrdiff_t first;
+
+    // Phase of the bank to use
+    size_t phase;
+};
+
+std::vector<AxisSample> sampleAxis(size_t inSize,
+                                   size_t outSize,
+                                   size_t numPhasings,
+                                   size_t numPoints)
+{
+    const double scale =
+            static_cast<double>(inSize) / static_cast<double>(outSize);
+    std::vector<AxisSample> samples(outSize);
+    for (size_t ii = 0; ii < outSize; ++ii)
+    {
+        const double position = (ii + 0.5) * scale - 0.5;
+        const double base = std::floor(position);
+        ptrdiff_t nearest = static_cast<ptrdiff_t>(base);
+        size_t phase = static_cast<size_t>(
+                (position - base) * numPhasings + 0.5);
+        if (phase == numPhasings)
+        {
+            ++nearest;
+            phase = 0;
+        }
+        samples[ii].first =
+                nearest - static_cast<ptrdiff_t>((numPoints - 1) / 2);
+        samples[ii].phase = phase;
+    }
+    return samples;
+}
+}
+
+namespace six
+{
+namespace sidd
+{
+// Iterative radix-2 FFT of a power of two number of points.  The twiddles
+// and bit reversal table are computed once and shared by every tile.
+class ImageFilter::FFTPlan
+{
+public:
+    explicit FFTPlan(size_t size) :
+        mSize(size),
+        mTwiddles(size / 2),
+        mReversed(size, 0)
+    {
+        for (size_t ii = 0; ii < mTwiddles.size(); ++ii)
+        {
+            mTwiddles[ii] = std::polar(1.0, -2.0 * M_PI *
+                    static_cast<double>(ii) / static_cast<double>(size));
+        }
+        for (size_t ii = 1; ii < size; ++ii)
+        {
+            mReversed[ii] = (mReversed[ii >> 1] >> 1) |
+                    ((ii & 1) ? (size >> 1) : 0);
+        }
+    }
+
+    void transform(std::complex<double>* data, bool inverse) const
+    {
+        for (size_t ii = 0; ii < mSize; ++ii)
+        {
+            if (ii < mReversed[ii])
+            {
+                std::swap(data[ii], data[mReversed[ii]]);
+            }
+        }
+
+        for (size_t length = 2; length <= mSize; length <<= 1)
+        {
+            const size_t half = length / 2;
+            const size_t step = mSize / length;
+            for (size_t start = 0; start < mSize; start += length)
+            {
+                for (size_t ii = 0; ii < half; ++ii)
+                {
+                    const std::complex<double>& twiddle =
+                            mTwiddles[ii * step];
+                    const std::complex<double> odd = data[start + ii + half] *
+                            (inverse ? std::conj(twiddle) : twiddle);
+                    data[start + ii + half] = data[start + ii] - odd;
+                    data[start + ii] += odd;
+                }
+            }
+        }
+    }
+
+private:
+    size_t mSize;
+    std::vector<std::complex<double> > mTwiddles;
+    std::vector<size_t> mReversed;
+};
+
+// Unnormalized 2D FFT of row-major data the size of mFFTDims
+void ImageFilter::transform2D(std::vector<std::complex<double> >& data,
+                              bool inverse) const
+{
+    for (size_t row = 0; row < mFFTDims.row; ++row)
+    {
+        mRowFFT->transform(&data[row * mFFTDims.col], inverse);
+    }
+
+    std::vector<std::complex<double> > column(mFFTDims.row);
+    for (size_t col = 0; col < mFFTDims.col; ++col)
+    {
+        for (size_t row = 0; row < mFFTDims.row; ++row)
+        {
+            column[row] = data[row * mFFTDims.col + col];
+        }
+        mColFFT->transform(&column[0], inverse);
+        for (size_t row = 0; row < mFFTDims.row; ++row)
+        {
+            data[row * mFFTDims.col + col] = column[row];
+        }
+    }
+}
+
+template <typename T>
+class ImageFilter::KernelTile : public sys::Runnable
+{
+public:
+    KernelTile(const ImageFilter& filter,
+               const Band<const T>& input,
+               const Band<T>& output,
+               size_t firstRow,
+               size_t firstCol,
+               size_t numRows,
+               size_t numCols) :
+        mFilter(filter),
+        mInput(input),
+        mOutput(output),
+        mFirstRow(firstRow),
+        mFirstCol(firstCol),
+        mNumRows(numRows),
+        mNumCols(numCols)
+    {
+    }
+
+    virtual void run()
+    {
+        // The tile plus its halo
+        const types::RowCol<size_t>& kernelDims = mFilter.mKernelDims;
+        const size_t bufferRows = mNumRows + kernelDims.row - 1;
+        const size_t bufferCols = mNumCols + kernelDims.col - 1;
+        std::vector<float> buffer(bufferRows * bufferCols);
+        readRegion(mInput,
+                   static_cast<ptrdiff_t>(mFirstRow) -
+                           static_cast<ptrdiff_t>((kernelDims.row - 1) / 2),
+                   static_cast<ptrdiff_t>(mFirstCol) -
+                           static_cast<ptrdiff_t>((kernelDims.col - 1) / 2),
+                   bufferRows,
+                   bufferCols,
+                   &buffer[0]);
+
+        std::vector<float> filtered(mNumRows * mNumCols, 0.0f);
+        if (mFilter.usesFFT())
+        {
+            filterFFT(buffer, bufferRows, bufferCols, filtered);
+        }
+        else if (mFilter.isSeparable())
+        {
+            filterSeparable(buffer, bufferRows, bufferCols, filtered);
+        }
+        else
+        {
+            filterDirect(buffer, bufferCols, filtered);
+        }
+
+        writeRegion(&filtered[0], mFirstRow, mFirstCol, mNumRows, mNumCols,
+                    mOutput);
+    }
+
+private:
+    void filterDirect(const std::vector<float>& buffer,
+                      size_t bufferCols,
+                      std::vector<float>& filtered) const
+    {
+        const types::RowCol<size_t>& kernelDims = mFilter.mKernelDims;
+        for (size_t ii = 0; ii < mNumRows; ++ii)
+        {
+            float* const out = &filtered[ii * mNumCols];
+            for (size_t kk = 0; kk < kernelDims.row; ++kk)
+            {
+                const float* const in = &buffer[(ii + kk) * bufferCols];
+                const float* const weights =
+                        &mFilter.mKernel[kk * kernelDims.col];
+                for (size_t ll = 0; ll < kernelDims.col; ++ll)
+                {
+                    const float weight = weights[ll];
+                    const float* const shifted = in + ll;
+                    for (size_t jj = 0; jj < mNumCols; ++jj)
+                    {
+                        out[jj] += weight * shifted[jj];
+                    }
+                }
+            }
+        }
+    }
+
+    void filterSeparable(const std::vector<float>& buffer,
+                         size_t bufferRows,
+                         size_t bufferCols,
+                         std::vector<float>& filtered) const
+    {
+        // Along the rows, then down the columns
+        const std::vector<float>& rowKernel = mFilter.mRowKernel;
+        std::vector<float> rowFiltered(bufferRows * mNumCols, 0.0f);
+        for (size_t ii = 0; ii < bufferRows; ++ii)
+        {
+            const float* const in = &buffer[ii * bufferCols];
+            float* const out = &rowFiltered[ii * mNumCols];
+            for (size_t ll = 0; ll < rowKernel.size(); ++ll)
+            {
+                const float weight = rowKernel[ll];
+                const float* const shifted = in + ll;
+                for (size_t jj = 0; jj < mNumCols; ++jj)
+                {
+                    out[jj] += weight * shifted[jj];
+                }
+            }
+        }
+
+        const std::vector<float>& colKernel = mFilter.mColKernel;
+        for (size_t ii = 0; ii < mNumRows; ++ii)
+        {
+            float* const out = &filtered[ii * mNumCols];
+            for (size_t kk = 0; kk < colKernel.size(); ++kk)
+            {
+                const float weight = colKernel[kk];
+                const float* const in = &rowFiltered[(ii + kk) * mNumCols];
+                for (size_t jj = 0; jj < mNumCols; ++jj)
+                {
+                    out[jj] += weight * in[jj];
+                }
+            }
+        }
+    }
+
+    void filterFFT(const std::vector<float>& buffer,
+                   size_t bufferRows,
+                   size_t bufferCols,
+                   std::vector<float>& filtered) const
+    {
+        // Correlation is the inverse FFT of the product of the buffer's
+        // spectrum and the conjugate of the kernel's.  The buffer fits in
+        // the FFT, so none of the outputs kept wrap around.
+        const types::RowCol<size_t>& fftDims = mFilter.mFFTDims;
+        std::vector<std::complex<double> > data(fftDims.area());
+        for (size_t ii = 0; ii < bufferRows; ++ii)
+        {
+            for (size_t jj = 0; jj < bufferCols; ++jj)
+            {
+                data[ii * fftDims.col + jj] = buffer[ii * bufferCols + jj];
+            }
+        }
+
+        mFilter.transform2D(data, false);
+        for (size_t ii = 0; ii < data.size(); ++ii)
+        {
+            data[ii] *= mFilter.mKernelSpectrum[ii];
+        }
+        mFilter.transform2D(data, true);
+
+        const double scale = 1.0 / static_cast<double>(data.size());
+        for (size_t ii = 0; ii < mNumRows; ++ii)
+        {
+            for (size_t jj = 0; jj < mNumCols; ++jj)
+            {
+                filtered[ii * mNumCols + jj] = static_cast<float>(
+                        data[ii * fftDims.col + jj].real() * scale);
+            }
+        }
+    }
+
+    const ImageFilter& mFilter;
+    Band<const T> mInput;
+    Band<T> mOutput;
+    size_t mFirstRow;
+    size_t mFirstCol;
+    size_t mNumRows;
+    size_t mNumCols;
+};
+
+template <typename T>
+class ImageFilter::ResampleTile : public sys::Runnable
+{
+public:
+    ResampleTile(const ImageFilter& filter,
+                 const Band<const T>& input,
+                 const Band<T>& output,
+                 const std::vector<AxisSample>& rowSamples,
+                 const std::vector<AxisSample>& colSamples,
+                 size_t firstRow,
+                 size_t firstCol,
+                 size_t numRows,
+                 size_t numCols) :
+        mFilter(filter),
+        mInput(input),
+        mOutput(output),
+        mRowSamples(rowSamples),
+        mColSamples(colSamples),
+        mFirstRow(firstRow),
+        mFirstCol(firstCol),
+        mNumRows(numRows),
+        mNumCols(numCols)
+    {
+    }
+
+    virtual void run()
+    {
+        // The input samples every output pixel of the tile needs
+        const size_t numPoints = mFilter.mNumPoints;
+        const ptrdiff_t inFirstRow = mRowSamples[mFirstRow].first;
+        const ptrdiff_t inFirstCol = mColSamples[mFirstCol].first;
+        const size_t inNumRows = static_cast<size_t>(
+                mRowSamples[mFirstRow + mNumRows - 1].first - inFirstRow) +
+                numPoints;
+        const size_t inNumCols = static_cast<size_t>(
+                mColSamples[mFirstCol + mNumCols - 1].first - inFirstCol) +
+                numPoints;
+        std::vector<float> buffer(inNumRows * inNumCols);
+        readRegion(mInput, inFirstRow, inFirstCol, inNumRows, inNumCols,
+                   &buffer[0]);
+
+        // Along the rows, then down the columns
+        std::vector<float> rowResampled(inNumRows * mNumCols);
+        for (size_t ii = 0; ii < inNumRows; ++ii)
+        {
+            const float* const in = &buffer[ii * inNumCols];
+            float* const out = &rowResampled[ii * mNumCols];
+            for (size_t jj = 0; jj < mNumCols; ++jj)
+            {
+                const AxisSample& sample = mColSamples[mFirstCol + jj];
+                const float* const weights =
+                        &mFilter.mBank[sample.phase * numPoints];
+                const float* const shifted = in + (sample.first - inFirstCol);
+                float sum = 0.0f;
+                for (size_t kk = 0; kk < numPoints; ++kk)
+                {
+                    sum += weights[kk] * shifted[kk];
+                }
+                out[jj] = sum;
+            }
+        }
+
+        std::vector<float> resampled(mNumRows * mNumCols, 0.0f);
+        for (size_t ii = 0; ii < mNumRows; ++ii)
+        {
+            const AxisSample& sample = mRowSamples[mFirstRow + ii];
+            const float* const weights =
+                    &mFilter.mBank[sample.phase * numPoints];
+            float* const out = &resampled[ii * mNumCols];
+            for (size_t kk = 0; kk < numPoints; ++kk)
+            {
+                const float weight = weights[kk];
+                const float* const in = &rowResampled[
+                        (sample.first - inFirstRow + kk) * mNumCols];
+                for (size_t jj = 0; jj < mNumCols; ++jj)
+                {
+                    out[jj] += weight * in[jj];
+                }
+            }
+        }
+
+        writeRegion(&resampled[0], mFirstRow, mFirstCol, mNumRows, mNumCols,
+                    mOutput);
+    }
+
+private:
+    const ImageFilter& mFilter;
+    Band<const T> mInput;
+    Band<T> mOutput;
+    const std::vector<AxisSample>& mRowSamples;
+    const std::vector<AxisSample>& mColSamples;
+    size_t mFirstRow;
+    size_t mFirstCol;
+    size_t mNumRows;
+    size_t mNumCols;
+};
+
+ImageFilter::ImageFilter(const Filter& filter,
+                         size_t numThreads,
+                         Method method) :
+    mNumPhasings(0),
+    mNumPoints(0),
+    mOwnedThreadPool(new six::ThreadPool(getNumThreads(numThreads))),
+    mThreadPool(*mOwnedThreadPool)
+{
+    init(filter, method);
+}
+
+ImageFilter::ImageFilter(const Filter& filter,
+                         six::ThreadPool& threadPool,
+                         Method method) :
+    mNumPhasings(0),
+    mNumPoints(0),
+    mThreadPool(threadPool)
+{
+    init(filter, method);
+}
+
+ImageFilter::~ImageFilter()
+{
+}
+
+void ImageFilter::init(const Filter& filter, Method method)
+{
+    if ((filter.filterKernel.get() == NULL) ==
+        (filter.filterBank.get() == NULL))
+    {
+        throw except::Exception(Ctxt(
+                "Filter must have exactly one of a kernel or a bank"));
+    }
+
+    if (filter.filterKernel.get() != NULL)
+    {
+        if (filter.operation != FilterOperation::CONVOLUTION &&
+            filter.operation != FilterOperation::CORRELATION)
+        {
+            throw except::Exception(Ctxt("Filter operation is not set"));
+        }
+        initKernel(*filter.filterKernel,
+                   filter.operation == FilterOperation::CONVOLUTION,
+                   method);
+    }
+    else
+    {
+        initBank(*filter.filterBank);
+    }
+}
+
+void ImageFilter::initKernel(const Filter::Kernel& kernel,
+                             bool isConvolution,
+                             Method method)
+{
+    if (kernel.custom.get() == NULL)
+    {
+        throw except::Exception(Ctxt(
+                "Predefined filter kernels can't be applied"));
+    }
+
+    const Filter::Kernel::Custom& custom = *kernel.custom;
+    if (Init::isUndefined(custom.size) ||
+        custom.size.row <= 0 || custom.size.col <= 0 ||
+        custom.filterCoef.size() !=
+                static_cast<size_t>(custom.size.row * custom.size.col))
+    {
+        throw except::Exception(Ctxt(
+                "Filter kernel size doesn't match its coefficients"));
+    }
+
+    // Flipping both ways reverses the row-major order
+    mKernelDims.row = static_cast<size_t>(custom.size.row);
+    mKernelDims.col = static_cast<size_t>(custom.size.col);
+    const size_t numCoefs = custom.filterCoef.size();
+    mKernel.resize(numCoefs);
+    for (size_t ii = 0; ii < numCoefs; ++ii)
+    {
+        mKernel[ii] = static_cast<float>(
+                custom.filterCoef[isConvolution ? numCoefs - 1 - ii : ii]);
+    }
+
+    if (method != FFT)
+    {
+        // A separable kernel is the product of the column and the row
+        // through its largest coefficient, scaled by that coefficient
+        size_t pivot = 0;
+        for (size_t ii = 1; ii < numCoefs; ++ii)
+        {
+            if (std::abs(mKernel[ii]) > std::abs(mKernel[pivot]))
+            {
+                pivot = ii;
+            }
+        }
+        const double maxCoef = mKernel[pivot];
+        const size_t pivotRow = pivot / mKernelDims.col;
+        const size_t pivotCol = pivot % mKernelDims.col;
+
+        std::vector<float> rowKernel(mKernelDims.col, 0.0f);
+        std::vector<float> colKernel(mKernelDims.row, 0.0f);
+        if (maxCoef != 0.0)
+        {
+            for (size_t ll = 0; ll < mKernelDims.col; ++ll)
+            {
+                rowKernel[ll] = mKernel[pivotRow * mKernelDims.col + ll];
+            }
+            for (size_t kk = 0; kk < mKernelDims.row; ++kk)
+            {
+                colKernel[kk] = static_cast<float>(
+                        mKernel[kk * mKernelDims.col + pivotCol] / maxCoef);
+            }
+        }
+
+        bool isSeparable = true;
+        for (size_t kk = 0; kk < mKernelDims.row && isSeparable; ++kk)
+        {
+            for (size_t ll = 0; ll < mKernelDims.col; ++ll)
+            {
+                const double product =
+                        static_cast<double>(colKernel[kk]) * rowKernel[ll];
+                if (std::abs(mKernel[kk * mKernelDims.col + ll] - product) >
+                    SEPARABLE_TOLERANCE * std::abs(maxCoef))
+                {
+                    isSeparable = false;
+                    break;
+                }
+            }
+        }
+
+        if (isSeparable)
+        {
+            mRowKernel.swap(rowKernel);
+            mColKernel.swap(colKernel);
+            return;
+        }
+        if (method == DIRECT || numCoefs < MIN_FFT_KERNEL_SIZE)
+        {
+            return;
+        }
+    }
+
+    // Size the FFTs so a tile of at least TILE_SIZE and its halo fits
+    mFFTDims.row = nextPowerOfTwo(TILE_SIZE + mKernelDims.row - 1);
+    mFFTDims.col = nextPowerOfTwo(TILE_SIZE + mKernelDims.col - 1);
+    mFFTTileDims.row = mFFTDims.row - mKernelDims.row + 1;
+    mFFTTileDims.col = mFFTDims.col - mKernelDims.col + 1;
+    mRowFFT.reset(new FFTPlan(mFFTDims.col));
+    mColFFT.reset(new FFTPlan(mFFTDims.row));
+
+    mKernelSpectrum.assign(mFFTDims.area(), std::complex<double>(0.0));
+    for (size_t kk = 0; kk < mKernelDims.row; ++kk)
+    {
+        for (size_t ll = 0; ll < mKernelDims.col; ++ll)
+        {
+            mKernelSpectrum[kk * mFFTDims.col + ll] =
+                    mKernel[kk * mKernelDims.col + ll];
+        }
+    }
+    transform2D(mKernelSpectrum, false);
+    for (size_t ii = 0; ii < mKernelSpectrum.size(); ++ii)
+    {
+        mKernelSpectrum[ii] = std::conj(mKernelSpectrum[ii]);
+    }
+}
+
+void ImageFilter::initBank(const Filter::Bank& bank)
+{
+    if (bank.custom.get() != NULL)
+    {
+        const Filter::Bank::Custom& custom = *bank.custom;
+        if (Init::isUndefined(custom.numPhasings) ||
+            Init::isUndefined(custom.numPoints) ||
+            custom.numPhasings == 0 || custom.numPoints == 0 ||
+            custom.filterCoef.size() !=
+                    custom.numPhasings * custom.numPoints)
+        {
+            throw except::Exception(Ctxt(
+                    "Filter bank size doesn't match its coefficients"));
+        }
+
+        mNumPhasings = custom.numPhasings;
+        mNumPoints = custom.numPoints;
+        mBank.assign(custom.filterCoef.begin(), custom.filterCoef.end());
+        return;
+    }
+
+    if (bank.predefined.get() == NULL)
+    {
+        throw except::Exception(Ctxt(
+                "Filter bank must be predefined or custom"));
+    }
+    const Filter::Predefined& predefined = *bank.predefined;
+    if (predefined.databaseName == FilterDatabaseName::NOT_SET)
+    {
+        throw except::Exception(Ctxt(
+                "Predefined filter families can't be applied"));
+    }
+
+    mNumPhasings = NUM_PREDEFINED_PHASINGS;
+    mNumPoints = getPredefinedNumPoints(predefined.databaseName);
+    mBank.resize(mNumPhasings * mNumPoints);
+    std::vector<double> weights(mNumPoints);
+    for (size_t phase = 0; phase < mNumPhasings; ++phase)
+    {
+        getPredefinedWeights(predefined.databaseName,
+                             static_cast<double>(phase) / mNumPhasings,
+                             &weights[0]);
+        std::copy(weights.begin(), weights.end(),
+                  mBank.begin() + phase * mNumPoints);
+    }
+}
+
+template <typename T>
+void ImageFilter::applyBands(const T* input,
+                             size_t numBands,
+                             const types::RowCol<size_t>& dims,
+                             T* output) const
+{
+    if (isBank())
+    {
+        throw except::Exception(Ctxt(
+                "Filter banks must be applied with resample()"));
+    }
+
+    const types::RowCol<size_t> tileDims = usesFFT() ?
+            mFFTTileDims : types::RowCol<size_t>(TILE_SIZE, TILE_SIZE);
+    std::vector<KernelTile<T> > tiles;
+    for (size_t band = 0; band < numBands; ++band)
+    {
+        const Band<const T> inputBand(input + band, dims, numBands);
+        const Band<T> outputBand(output + band, dims, numBands);
+        for (size_t row = 0; row < dims.row; row += tileDims.row)
+        {
+            for (size_t col = 0; col < dims.col; col += tileDims.col)
+            {
+                tiles.push_back(KernelTile<T>(
+                        *this, inputBand, outputBand, row, col,
+                        std::min(tileDims.row, dims.row - row),
+                        std::min(tileDims.col, dims.col - col)));
+            }
+        }
+    }
+    mThreadPool.runEach(tiles);
+}
+
+template <typename T>
+void ImageFilter::resampleBands(const T* input,
+                                size_t numBands,
+                                const types::RowCol<size_t>& inDims,
+                                const types::RowCol<size_t>& outDims,
+                                T* output) const
+{
+    if (!isBank())
+    {
+        throw except::Exception(Ctxt(
+                "Only filter banks can resample images"));
+    }
+    if (inDims.area() == 0 || outDims.area() == 0)
+    {
+        throw except::Exception(Ctxt("Can't resample an empty image"));
+    }
+
+    const std::vector<AxisSample> rowSamples =
+            sampleAxis(inDims.row, outDims.row, mNumPhasings, mNumPoints);
+    const std::vector<AxisSample> colSamples =
+            sampleAxis(inDims.col, outDims.col, mNumPhasings, mNumPoints);
+
+    std::vector<ResampleTile<T> > tiles;
+    for (size_t band = 0; band < numBands; ++band)
+    {
+        const Band<const T> inputBand(input + band, inDims, numBands);
+        const Band<T> outputBand(output + band, outDims, numBands);
+        for (size_t row = 0; row < outDims.row; row += TILE_SIZE)
+        {
+            for (size_t col = 0; col < outDims.col; col += TILE_SIZE)
+            {
+                tiles.push_back(ResampleTile<T>(
+                        *this, inputBand, outputBand, rowSamples, colSamples,
+                        row, col,
+                        std::min(TILE_SIZE, outDims.row - row),
+                        std::min(TILE_SIZE, outDims.col - col)));
+            }
+        }
+    }
+    mThreadPool.runEach(tiles);
+}
+
+types::RowCol<size_t> ImageFilter::getHalo() const
+{
+    if (isBank())
+    {
+        // The nearest sample is rounded up when the phase wraps around
+        const size_t halo = mNumPoints / 2 + 1;
+        return types::RowCol<size_t>(halo, halo);
+    }
+    return types::RowCol<size_t>(mKernelDims.row / 2, mKernelDims.col / 2);
+}
+
+void ImageFilter::apply(const float* input,
+                        const types::RowCol<size_t>& dims,
+                        float* output) const
+{
+    applyBands(input, 1, dims, output);
+}
+
+void ImageFilter::apply(const UByte* input,
+                        PixelType pixelType,
+                        const types::RowCol<size_t>& dims,
+                        UByte* output) const
+{
+    const size_t numBands = getNumBands(pixelType);
+    if (pixelType == PixelType::MONO16I)
+    {
+        applyBands(reinterpret_cast<const sys::Uint16_T*>(input), numBands,
+                   dims, reinterpret_cast<sys::Uint16_T*>(output));
+    }
+    else
+    {
+        applyBands(input, numBands, dims, output);
+    }
+}
+
+void ImageFilter::resample(const float* input,
+                           const types::RowCol<size_t>& inDims,
+                           const types::RowCol<size_t>& outDims,
+                           float* output) const
+{
+    resampleBands(input, 1, inDims, outDims, output);
+}
+
+void ImageFilter::resample(const UByte* input,
+                           PixelType pixelType,
+                           const types::RowCol<size_t>& inDims,
+                           const types::RowCol<size_t>& outDims,
+                           UByte* output) const
+{
+    const size_t numBands = getNumBands(pixelType);
+    if (pixelType == PixelType::MONO16I)
+    {
+        resampleBands(reinterpret_cast<const sys::Uint16_T*>(input),
+                      numBands, inDims, outDims,
+                      reinterpret_cast<sys::Uint16_T*>(output));
+    }
+    else
+    {
+        resampleBands(input, numBands, inDims, outDims, output);
+    }
+}
+}
+}
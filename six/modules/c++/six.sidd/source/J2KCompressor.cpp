@@ -0,0 +1,749 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#include <except/Exception.h>
+#include <str/Convert.h>
+#include <sys/OS.h>
+#include <sys/Runnable.h>
+#include <six/ByteProvider.h>
+#include <six/NITFWriteControl.h>
+#include <six/sidd/J2KCompressor.h>
+
+#include <j2k/j2k_config.h>
+#ifdef HAVE_OPENJPEG_H
+#include <openjpeg.h>
+#endif
+
+namespace
+{
+// How the samples of each pixel are laid out
+struct PixelFormat
+{
+    size_t numBands;
+    size_t numBytesPerSample;
+    bool isRGB;
+};
+
+// JPEG 2000 codestream markers (ISO/IEC 15444-1 Annex A)
+const six::UByte MARKER = 0xFF;
+const six::UByte SIZ = 0x51;
+const six::UByte SOT = 0x90;
+const six::UByte EOC = 0xD9;
+
+// Offsets into the SIZ and SOT marker segments, from their markers
+const size_t SIZ_XSIZ = 4;
+const size_t SIZ_YSIZ = 8;
+const size_t SIZ_XOSIZ = 12;
+const size_t SIZ_YOSIZ = 16;
+const size_t SIZ_XTOSIZ = 28;
+const size_t SIZ_YTOSIZ = 32;
+const size_t SOT_ISOT = 4;
+const size_t SOT_PSOT = 6;
+const size_t SOT_LENGTH = 12;
+
+// Block dimensions of 0 mean the whole image
+size_t getBlockDim(nitf::Field field, size_t imageDim)
+{
+    const size_t blockDim = static_cast<nitf::Uint32>(field);
+    return (blockDim == 0) ? imageDim : blockDim;
+}
+
+// Codestreams are big endian
+void writeBigEndian(size_t value,
+                    size_t offset,
+                    size_t numBytes,
+                    std::vector<six::UByte>& bytes)
+{
+    for (size_t ii = numBytes; ii > 0; --ii, value >>= 8)
+    {
+        bytes[offset + ii - 1] = static_cast<six::UByte>(value & 0xFF);
+    }
+}
+
+bool isMarker(const std::vector<six::UByte>& bytes,
+              size_t offset,
+              six::UByte marker)
+{
+    return offset + 1 < bytes.size() &&
+            bytes[offset] == MARKER && bytes[offset + 1] == marker;
+}
+
+#ifdef HAVE_OPENJPEG_H
+size_t readBigEndian(const std::vector<six::UByte>& bytes,
+                     size_t offset,
+                     size_t numBytes)
+{
+    if (offset + numBytes > bytes.size())
+    {
+        throw except::Exception(Ctxt("J2K codestream is truncated"));
+    }
+
+    size_t value = 0;
+    for (size_t ii = 0; ii < numBytes; ++ii)
+    {
+        value = (value << 8) | bytes[offset + ii];
+    }
+    return value;
+}
+
+// Where OpenJPEG writes the codestream
+struct MemoryStream
+{
+    MemoryStream() :
+        position(0)
+    {
+    }
+
+    static OPJ_SIZE_T write(void* buffer, OPJ_SIZE_T numBytes, void* data)
+    {
+        MemoryStream* const stream = static_cast<MemoryStream*>(data);
+        if (stream->position + numBytes > stream->bytes.size())
+        {
+            stream->bytes.resize(stream->position + numBytes);
+        }
+        memcpy(&stream->bytes[stream->position], buffer, numBytes);
+        stream->position += numBytes;
+        return numBytes;
+    }
+
+    static OPJ_OFF_T skip(OPJ_OFF_T numBytes, void* data)
+    {
+        MemoryStream* const stream = static_cast<MemoryStream*>(data);
+        if (numBytes < 0 &&
+            static_cast<size_t>(-numBytes) > stream->position)
+        {
+            return -1;
+        }
+        stream->position += numBytes;
+        return numBytes;
+    }
+
+    static OPJ_BOOL seek(OPJ_OFF_T offset, void* data)
+    {
+        if (offset < 0)
+        {
+            return OPJ_FALSE;
+        }
+        static_cast<MemoryStream*>(data)->position =
+                static_cast<size_t>(offset);
+        return OPJ_TRUE;
+    }
+
+    std::vector<six::UByte> bytes;
+    size_t position;
+};
+
+// Encodes one block as the only tile of a J2K codestream, cleaning up the
+// OpenJPEG objects however it's left.  The image and the tile grid both
+// start where the block is in its image segment and tiles are the full
+// block size, so the tile is coded just as it would be in a codestream of
+// the whole segment.
+class BlockWriter
+{
+public:
+    BlockWriter(const PixelFormat& format,
+                size_t firstRow,
+                size_t firstCol,
+                size_t numRows,
+                size_t numCols,
+                size_t numRowsPerBlock,
+                size_t numColsPerBlock,
+                double compressionRatio) :
+        mCodec(NULL),
+        mImage(NULL),
+        mStream(NULL)
+    {
+        // Lossless unless there's a compression ratio.  OpenJPEG's rate is
+        // the inverse of ours.  This matches the j2k module's writer.
+        opj_cparameters_t parameters;
+        opj_set_default_encoder_parameters(&parameters);
+        if (compressionRatio > 0)
+        {
+            parameters.tcp_rates[0] =
+                    static_cast<float>(1.0 / compressionRatio);
+            parameters.irreversible = 1;
+        }
+        ++parameters.tcp_numlayers;
+        parameters.cp_disto_alloc = 1;
+
+        // OpenJPEG fails with more resolutions than the tiles can take.
+        // This has to be the same for every block of a segment, since it's
+        // in the main header.
+        const OPJ_UINT32 maxResolutions = static_cast<OPJ_UINT32>(floor(
+                log(static_cast<double>(std::min(numRowsPerBlock,
+                                                 numColsPerBlock))) /
+                log(2.0)));
+        parameters.numresolution = std::max<int>(
+                std::min<int>(parameters.numresolution, maxResolutions), 1);
+
+        parameters.tile_size_on = OPJ_TRUE;
+        parameters.cp_tx0 = static_cast<int>(firstCol);
+        parameters.cp_ty0 = static_cast<int>(firstRow);
+        parameters.cp_tdx = static_cast<int>(numColsPerBlock);
+        parameters.cp_tdy = static_cast<int>(numRowsPerBlock);
+
+        std::vector<opj_image_cmptparm_t> components(format.numBands);
+        memset(&components[0], 0,
+               sizeof(opj_image_cmptparm_t) * components.size());
+        for (size_t band = 0; band < components.size(); ++band)
+        {
+            components[band].dx = 1;
+            components[band].dy = 1;
+            components[band].w = static_cast<OPJ_UINT32>(numCols);
+            components[band].h = static_cast<OPJ_UINT32>(numRows);
+            components[band].x0 = static_cast<OPJ_UINT32>(firstCol);
+            components[band].y0 = static_cast<OPJ_UINT32>(firstRow);
+            components[band].prec =
+                    static_cast<OPJ_UINT32>(format.numBytesPerSample * 8);
+            components[band].sgnd = 0;
+        }
+
+        const OPJ_COLOR_SPACE colorSpace =
+                format.isRGB ? OPJ_CLRSPC_SRGB : OPJ_CLRSPC_GRAY;
+        mImage = opj_image_tile_create(
+                static_cast<OPJ_UINT32>(components.size()),
+                &components[0],
+                colorSpace);
+        if (!mImage)
+        {
+            throw except::Exception(Ctxt("Unable to create OpenJPEG image"));
+        }
+        mImage->x0 = static_cast<OPJ_UINT32>(firstCol);
+        mImage->y0 = static_cast<OPJ_UINT32>(firstRow);
+        mImage->x1 = static_cast<OPJ_UINT32>(firstCol + numCols);
+        mImage->y1 = static_cast<OPJ_UINT32>(firstRow + numRows);
+
+        mCodec = opj_create_compress(OPJ_CODEC_J2K);
+        if (!mCodec)
+        {
+            throw except::Exception(Ctxt("Unable to create OpenJPEG codec"));
+        }
+        opj_set_error_handler(mCodec, &BlockWriter::onError, &mError);
+        if (!opj_setup_encoder(mCodec, &parameters, mImage))
+        {
+            throwError("Unable to set up the OpenJPEG encoder");
+        }
+
+        mStream = opj_stream_create(OPJ_J2K_STREAM_CHUNK_SIZE, OPJ_FALSE);
+        if (!mStream)
+        {
+            throw except::Exception(Ctxt("Unable to create OpenJPEG stream"));
+        }
+        opj_stream_set_user_data(mStream, &mOutput, NULL);
+        opj_stream_set_write_function(mStream, &MemoryStream::write);
+        opj_stream_set_skip_function(mStream, &MemoryStream::skip);
+        opj_stream_set_seek_function(mStream, &MemoryStream::seek);
+    }
+
+    ~BlockWriter()
+    {
+        if (mStream)
+        {
+            opj_stream_destroy(mStream);
+        }
+        if (mCodec)
+        {
+            opj_destroy_codec(mCodec);
+        }
+        if (mImage)
+        {
+            opj_image_destroy(mImage);
+        }
+    }
+
+    // 'pixels' holds each band of the block one after the other
+    void write(std::vector<six::UByte>& pixels,
+               std::vector<six::UByte>& codestream)
+    {
+        if (!opj_start_compress(mCodec, mImage, mStream) ||
+            !opj_write_tile(mCodec, 0, &pixels[0],
+                            static_cast<OPJ_UINT32>(pixels.size()),
+                            mStream) ||
+            !opj_end_compress(mCodec, mStream))
+        {
+            throwError("Unable to compress block");
+        }
+        codestream.swap(mOutput.bytes);
+    }
+
+private:
+    // Noncopyable
+    BlockWriter(const BlockWriter& );
+    const BlockWriter& operator=(const BlockWriter& );
+
+    static void onError(const char* message, void* data)
+    {
+        std::string& error = *static_cast<std::string*>(data);
+        if (error.empty())
+        {
+            error = message;
+        }
+    }
+
+    void throwError(const std::string& message) const
+    {
+        throw except::Exception(Ctxt(
+                mError.empty() ? message : message + ": " + mError));
+    }
+
+private:
+    opj_codec_t* mCodec;
+    opj_image_t* mImage;
+    opj_stream_t* mStream;
+    MemoryStream mOutput;
+    std::string mError;
+};
+
+// The size of a codestream's main header, which is everything before the
+// first tile-part
+size_t getMainHeaderSize(const std::vector<six::UByte>& codestream)
+{
+    // SOC, then marker segments that each start with their length
+    size_t offset = 2;
+    while (!isMarker(codestream, offset, SOT))
+    {
+        if (offset >= codestream.size() || codestream[offset] != MARKER)
+        {
+            throw except::Exception(Ctxt(
+                    "J2K codestream has no tile-parts"));
+        }
+        offset += 2 + readBigEndian(codestream, offset + 2, 2);
+    }
+    return offset;
+}
+#endif
+
+// Pulls one block out of the image and compresses it into the tile-part(s)
+// for its tile of the segment's codestream
+class BlockCompressor : public sys::Runnable
+{
+public:
+    BlockCompressor(const six::UByte* imageData,
+                    size_t numCols,
+                    const PixelFormat& format,
+                    double compressionRatio,
+                    size_t segmentFirstRow,
+                    size_t firstRow,
+                    size_t firstCol,
+                    size_t numValidRows,
+                    size_t numValidCols,
+                    size_t numRowsPerBlock,
+                    size_t numColsPerBlock,
+                    size_t tileIndex,
+                    std::vector<six::UByte>* mainHeader,
+                    std::vector<six::UByte>* tileParts) :
+        mImageData(imageData),
+        mNumCols(numCols),
+        mFormat(format),
+        mCompressionRatio(compressionRatio),
+        mSegmentFirstRow(segmentFirstRow),
+        mFirstRow(firstRow),
+        mFirstCol(firstCol),
+        mNumValidRows(numValidRows),
+        mNumValidCols(numValidCols),
+        mNumRowsPerBlock(numRowsPerBlock),
+        mNumColsPerBlock(numColsPerBlock),
+        mTileIndex(tileIndex),
+        mMainHeader(mainHeader),
+        mTileParts(tileParts)
+    {
+    }
+
+    virtual void run()
+    {
+        // OpenJPEG wants each band of the tile one after the other, without
+        // any padding for partial blocks
+        const size_t sampleSize = mFormat.numBytesPerSample;
+        const size_t pixelSize = sampleSize * mFormat.numBands;
+        std::vector<six::UByte> pixels(
+                mNumValidRows * mNumValidCols * pixelSize);
+
+        for (size_t row = 0; row < mNumValidRows; ++row)
+        {
+            const six::UByte* const src = mImageData +
+                    ((mSegmentFirstRow + mFirstRow + row) * mNumCols +
+                     mFirstCol) * pixelSize;
+            if (mFormat.numBands == 1)
+            {
+                memcpy(&pixels[row * mNumValidCols * pixelSize],
+                       src,
+                       mNumValidCols * pixelSize);
+                continue;
+            }
+
+            for (size_t band = 0; band < mFormat.numBands; ++band)
+            {
+                six::UByte* const dest = &pixels[
+                        ((band * mNumValidRows + row) * mNumValidCols) *
+                        sampleSize];
+                for (size_t col = 0; col < mNumValidCols; ++col)
+                {
+                    memcpy(dest + col * sampleSize,
+                           src + col * pixelSize + band * sampleSize,
+                           sampleSize);
+                }
+            }
+        }
+
+#ifdef HAVE_OPENJPEG_H
+        std::vector<six::UByte> codestream;
+        {
+            BlockWriter writer(mFormat,
+                               mFirstRow,
+                               mFirstCol,
+                               mNumValidRows,
+                               mNumValidCols,
+                               mNumRowsPerBlock,
+                               mNumColsPerBlock,
+                               mCompressionRatio);
+            writer.write(pixels, codestream);
+        }
+        std::vector<six::UByte>().swap(pixels);
+
+        const size_t mainHeaderSize = getMainHeaderSize(codestream);
+        if (!isMarker(codestream, codestream.size() - 2, EOC))
+        {
+            throw except::Exception(Ctxt("J2K codestream has no EOC"));
+        }
+        if (mMainHeader)
+        {
+            mMainHeader->assign(codestream.begin(),
+                                codestream.begin() + mainHeaderSize);
+        }
+
+        // Everything between the main header and EOC belongs to tile 0,
+        // which is renumbered to be this block's tile of the segment
+        mTileParts->assign(codestream.begin() + mainHeaderSize,
+                           codestream.end() - 2);
+        for (size_t offset = 0; offset < mTileParts->size(); )
+        {
+            if (!isMarker(*mTileParts, offset, SOT))
+            {
+                throw except::Exception(Ctxt(
+                        "J2K tile-part doesn't start with SOT"));
+            }
+            writeBigEndian(mTileIndex, offset + SOT_ISOT, 2, *mTileParts);
+
+            // A length of 0 means the tile-part runs up to EOC
+            const size_t length =
+                    readBigEndian(*mTileParts, offset + SOT_PSOT, 4);
+            if (length == 0)
+            {
+                writeBigEndian(mTileParts->size() - offset,
+                               offset + SOT_PSOT, 4, *mTileParts);
+                break;
+            }
+            if (length < SOT_LENGTH)
+            {
+                throw except::Exception(Ctxt(
+                        "Invalid J2K tile-part length"));
+            }
+            offset += length;
+        }
+#else
+        throw except::Exception(Ctxt(
+                "six.sidd was built without OpenJPEG"));
+#endif
+    }
+
+private:
+    const six::UByte* mImageData;
+    size_t mNumCols;
+    PixelFormat mFormat;
+    double mCompressionRatio;
+    size_t mSegmentFirstRow;
+    size_t mFirstRow;
+    size_t mFirstCol;
+    size_t mNumValidRows;
+    size_t mNumValidCols;
+    size_t mNumRowsPerBlock;
+    size_t mNumColsPerBlock;
+    size_t mTileIndex;
+    std::vector<six::UByte>* mMainHeader;
+    std::vector<six::UByte>* mTileParts;
+};
+
+// Turns the main header of one block's codestream into the main header for
+// the whole segment.  Only SIZ differs, since every block was coded the
+// same way.
+void setSegmentSize(size_t numRows,
+                    size_t numCols,
+                    std::vector<six::UByte>& mainHeader)
+{
+    const size_t siz = 2;
+    if (!isMarker(mainHeader, siz, SIZ) ||
+        mainHeader.size() < siz + SIZ_YTOSIZ + 4)
+    {
+        throw except::Exception(Ctxt("J2K main header has no SIZ"));
+    }
+
+    writeBigEndian(numCols, siz + SIZ_XSIZ, 4, mainHeader);
+    writeBigEndian(numRows, siz + SIZ_YSIZ, 4, mainHeader);
+    writeBigEndian(0, siz + SIZ_XOSIZ, 4, mainHeader);
+    writeBigEndian(0, siz + SIZ_YOSIZ, 4, mainHeader);
+    writeBigEndian(0, siz + SIZ_XTOSIZ, 4, mainHeader);
+    writeBigEndian(0, siz + SIZ_YTOSIZ, 4, mainHeader);
+}
+
+PixelFormat getPixelFormat(const six::Data& data)
+{
+    PixelFormat format;
+    format.numBands = data.getNumChannels();
+    format.numBytesPerSample = data.getNumBytesPerPixel() / format.numBands;
+    format.isRGB = (data.getPixelType() == six::PixelType::RGB24I);
+    return format;
+}
+}
+
+namespace six
+{
+namespace sidd
+{
+J2KCompressor::J2KCompressor(const DerivedData& data,
+                             const Options& options) :
+    mData(static_cast<DerivedData*>(data.clone())),
+    mIsNumericallyLossless(static_cast<bool>(options.getParameter(
+            NITFHeaderCreator::OPT_J2K_COMPRESSION_LOSSLESS,
+            Parameter(false)))),
+    mCompressionRatio(0),
+    mMaxProductSize(options.getParameter(
+            NITFHeaderCreator::OPT_MAX_PRODUCT_SIZE, Parameter(0))),
+    mNumRowsPerBlock(options.getParameter(
+            NITFHeaderCreator::OPT_NUM_ROWS_PER_BLOCK, Parameter(0))),
+    mNumColsPerBlock(options.getParameter(
+            NITFHeaderCreator::OPT_NUM_COLS_PER_BLOCK, Parameter(0))),
+    mNumThreads(options.getParameter(
+            NITFWriteControl::OPT_NUM_WRITE_THREADS, Parameter(0)))
+{
+    if (!isAvailable())
+    {
+        throw except::Exception(Ctxt(
+                "J2K compression is unavailable since six.sidd was built "
+                "without OpenJPEG"));
+    }
+
+    const PixelType pixelType = mData->getPixelType();
+    if (pixelType != PixelType::MONO8I &&
+        pixelType != PixelType::MONO8LU &&
+        pixelType != PixelType::MONO16I &&
+        pixelType != PixelType::RGB8LU &&
+        pixelType != PixelType::RGB24I)
+    {
+        throw except::Exception(Ctxt(
+                "Pixel type " + pixelType.toString() +
+                " can't be J2K compressed"));
+    }
+
+    // The byterate is per band, while OpenJPEG wants the fraction of the
+    // uncompressed size
+    if (!mIsNumericallyLossless)
+    {
+        const double byterate = options.getParameter(
+                NITFHeaderCreator::OPT_J2K_COMPRESSION_BYTERATE,
+                Parameter(0));
+        if (byterate <= 0.0001 || byterate > 1.0)
+        {
+            throw except::Exception(Ctxt(
+                    "J2K compression needs a byterate in (0.0001, 1.0] "
+                    "unless it's lossless, not " + str::toString(byterate)));
+        }
+        mCompressionRatio = byterate / getPixelFormat(*mData).numBytesPerSample;
+    }
+
+    if (mNumThreads == 0)
+    {
+        mNumThreads = sys::OS().getNumCPUs();
+    }
+
+    // Lay the image out the same way CompressedSIDDByteProvider will
+    mem::SharedPtr<Container> container(new Container(DataType::DERIVED));
+    container->addData(mData->clone());
+    Options layoutOptions;
+    ByteProvider::populateOptions(container,
+                                  mMaxProductSize,
+                                  mNumRowsPerBlock,
+                                  mNumColsPerBlock,
+                                  layoutOptions);
+    NITFWriteControl writer(layoutOptions, container);
+
+    const NITFImageInfo& info = *writer.getInfos()[0];
+    const std::vector<NITFSegmentInfo> imageSegments =
+            info.getImageSegments();
+    nitf::Record record = writer.getRecord();
+    mSegments.resize(imageSegments.size());
+    for (size_t ii = 0; ii < imageSegments.size(); ++ii)
+    {
+        nitf::ImageSegment imageSegment =
+                record.getImages()[info.getStartIndex() + ii];
+        nitf::ImageSubheader subheader = imageSegment.getSubheader();
+
+        SegmentLayout& segment(mSegments[ii]);
+        segment.firstRow = imageSegments[ii].firstRow;
+        segment.numRows = imageSegments[ii].numRows;
+        segment.numRowsPerBlock = getBlockDim(
+                subheader.getNumPixelsPerVertBlock(), segment.numRows);
+        segment.numColsPerBlock = getBlockDim(
+                subheader.getNumPixelsPerHorizBlock(), mData->getNumCols());
+        segment.numBlocksPerRow =
+                static_cast<nitf::Uint32>(subheader.getNumBlocksPerRow());
+        segment.numBlocksPerCol =
+                static_cast<nitf::Uint32>(subheader.getNumBlocksPerCol());
+    }
+}
+
+bool J2KCompressor::isAvailable()
+{
+#ifdef HAVE_OPENJPEG_H
+    return true;
+#else
+    return false;
+#endif
+}
+
+void J2KCompressor::compress(const UByte* imageData)
+{
+    ThreadPool threadPool(mNumThreads);
+    compress(imageData, threadPool);
+}
+
+void J2KCompressor::compress(const UByte* imageData, ThreadPool& threadPool)
+{
+    const size_t numCols = mData->getNumCols();
+    const PixelFormat format = getPixelFormat(*mData);
+
+    size_t numBlocks = 0;
+    for (size_t ii = 0; ii < mSegments.size(); ++ii)
+    {
+        numBlocks += mSegments[ii].numBlocksPerRow *
+                mSegments[ii].numBlocksPerCol;
+    }
+
+    // Blocks go in the same order they're written in, and each segment's
+    // codestream takes its main header from its first block
+    std::vector<std::vector<UByte> > mainHeaders(mSegments.size());
+    std::vector<std::vector<UByte> > blocks(numBlocks);
+    std::vector<BlockCompressor> compressors;
+    compressors.reserve(numBlocks);
+    for (size_t ii = 0; ii < mSegments.size(); ++ii)
+    {
+        const SegmentLayout& segment(mSegments[ii]);
+        size_t tileIndex = 0;
+        for (size_t blockRow = 0; blockRow < segment.numBlocksPerCol;
+             ++blockRow)
+        {
+            const size_t startRow = blockRow * segment.numRowsPerBlock;
+            const size_t numValidRows = std::min(segment.numRowsPerBlock,
+                                                 segment.numRows - startRow);
+            for (size_t blockCol = 0; blockCol < segment.numBlocksPerRow;
+                 ++blockCol, ++tileIndex)
+            {
+                const size_t startCol = blockCol * segment.numColsPerBlock;
+                const size_t numValidCols = std::min(segment.numColsPerBlock,
+                                                     numCols - startCol);
+                compressors.push_back(BlockCompressor(
+                        imageData,
+                        numCols,
+                        format,
+                        mCompressionRatio,
+                        segment.firstRow,
+                        startRow,
+                        startCol,
+                        numValidRows,
+                        numValidCols,
+                        segment.numRowsPerBlock,
+                        segment.numColsPerBlock,
+                        tileIndex,
+                        (tileIndex == 0) ? &mainHeaders[ii] : NULL,
+                        &blocks[compressors.size()]));
+            }
+        }
+    }
+
+    threadPool.runEach(compressors);
+
+    size_t numCompressedBytes = 0;
+    for (size_t ii = 0; ii < mSegments.size(); ++ii)
+    {
+        setSegmentSize(mSegments[ii].numRows, numCols, mainHeaders[ii]);
+        numCompressedBytes += mainHeaders[ii].size() + 2;
+    }
+    for (size_t ii = 0; ii < blocks.size(); ++ii)
+    {
+        numCompressedBytes += blocks[ii].size();
+    }
+
+    // The main header is counted as part of the first block of its segment
+    // and EOC as part of the last
+    mBytesPerBlock.assign(mSegments.size(), std::vector<size_t>());
+    mCompressedData.clear();
+    mCompressedData.reserve(numCompressedBytes);
+    size_t block = 0;
+    for (size_t ii = 0; ii < mSegments.size(); ++ii)
+    {
+        const size_t numBlocksInSegment =
+                mSegments[ii].numBlocksPerRow * mSegments[ii].numBlocksPerCol;
+        for (size_t jj = 0; jj < numBlocksInSegment; ++jj, ++block)
+        {
+            const size_t startSize = mCompressedData.size();
+            if (jj == 0)
+            {
+                mCompressedData.insert(mCompressedData.end(),
+                                       mainHeaders[ii].begin(),
+                                       mainHeaders[ii].end());
+            }
+            mCompressedData.insert(mCompressedData.end(),
+                                   blocks[block].begin(),
+                                   blocks[block].end());
+            std::vector<UByte>().swap(blocks[block]);
+            if (jj + 1 == numBlocksInSegment)
+            {
+                mCompressedData.push_back(MARKER);
+                mCompressedData.push_back(EOC);
+            }
+            mBytesPerBlock[ii].push_back(mCompressedData.size() - startSize);
+        }
+    }
+}
+
+std::auto_ptr<CompressedSIDDByteProvider>
+J2KCompressor::createByteProvider(
+        const std::vector<std::string>& schemaPaths) const
+{
+    if (mBytesPerBlock.empty())
+    {
+        throw except::Exception(Ctxt("Nothing has been compressed yet"));
+    }
+
+    return std::auto_ptr<CompressedSIDDByteProvider>(
+            new CompressedSIDDByteProvider(*mData,
+                                           schemaPaths,
+                                           mBytesPerBlock,
+                                           mIsNumericallyLossless,
+                                           mNumRowsPerBlock,
+                                           mNumColsPerBlock,
+                                           mMaxProductSize));
+}
+}
+}
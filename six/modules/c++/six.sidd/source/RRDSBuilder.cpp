@@ -0,0 +1,446 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+#include <algorithm>
+
+#include <except/Exception.h>
+#include <mt/ThreadPlanner.h>
+#include <str/Convert.h>
+#include <sys/Conf.h>
+#include <sys/OS.h>
+#include <sys/Runnable.h>
+#include <six/sidd/RRDSBuilder.h>
+
+namespace
+{
+// Output pixels reduced per thread, at a minimum
+const size_t MIN_PIXELS_PER_CHUNK = 16 * 1024;
+
+size_t getNumBands(six::PixelType pixelType)
+{
+    switch (pixelType)
+    {
+    case six::PixelType::MONO8I:
+    case six::PixelType::MONO16I:
+        return 1;
+    case six::PixelType::RGB24I:
+        return 3;
+    default:
+        throw except::Exception(Ctxt(
+                "RRDS can't be built for pixel type " +
+                pixelType.toString()));
+    }
+}
+
+size_t getNumBytesPerPixel(six::PixelType pixelType)
+{
+    return (pixelType == six::PixelType::MONO16I) ?
+            2 : getNumBands(pixelType);
+}
+
+// Reduces rows of 2x2 blocks of a strip
+template <typename T>
+class ReduceRows : public sys::Runnable
+{
+public:
+    ReduceRows(six::sidd::DownsamplingMethod method,
+               const T* input,
+               size_t numCols,
+               size_t numBands,
+               size_t startRow,
+               size_t numRows,
+               T* output) :
+        mMethod(method),
+        mInput(input),
+        mNumCols(numCols),
+        mNumBands(numBands),
+        mStartRow(startRow),
+        mNumRows(numRows),
+        mOutput(output)
+    {
+    }
+
+    virtual void run()
+    {
+        // Each input row holds two output columns per pixel
+        const size_t numOutputSamples = mNumCols * mNumBands;
+        const size_t inputStride = 2 * numOutputSamples;
+        for (size_t row = mStartRow; row < mStartRow + mNumRows; ++row)
+        {
+            const T* const top = mInput + 2 * row * inputStride;
+            const T* const bottom = top + inputStride;
+            T* const out = mOutput + row * numOutputSamples;
+            for (size_t col = 0; col < mNumCols; ++col)
+            {
+                for (size_t band = 0; band < mNumBands; ++band)
+                {
+                    const size_t left = 2 * col * mNumBands + band;
+                    const size_t right = left + mNumBands;
+                    T& value = out[col * mNumBands + band];
+                    switch (mMethod)
+                    {
+                    case six::sidd::DownsamplingMethod::MAX_PIXEL:
+                        value = std::max(std::max(top[left], top[right]),
+                                         std::max(bottom[left],
+                                                  bottom[right]));
+                        break;
+                    case six::sidd::DownsamplingMethod::AVERAGE:
+                    {
+                        const size_t sum = static_cast<size_t>(top[left]) +
+                                top[right] + bottom[left] + bottom[right];
+                        value = static_cast<T>((sum + 2) / 4);
+                        break;
+                    }
+                    default:
+                        value = top[left];
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    const int mMethod;
+    const T* const mInput;
+    const size_t mNumCols;
+    const size_t mNumBands;
+    const size_t mStartRow;
+    const size_t mNumRows;
+    T* const mOutput;
+};
+}
+
+namespace six
+{
+namespace sidd
+{
+const size_t RRDSBuilder::DEFAULT_ROWS_PER_STRIP;
+
+RRDSBuilder::RRDSBuilder(const types::RowCol<size_t>& dims,
+                         PixelType pixelType,
+                         const RRDS& rrds,
+                         size_t numLevels,
+                         Sink& sink,
+                         size_t numThreads,
+                         size_t numRowsPerStrip) :
+    mDims(dims),
+    mPixelType(pixelType),
+    mMethod(rrds.downsamplingMethod),
+    mSink(sink),
+    mOwnedThreadPool(new six::ThreadPool(
+            (numThreads == 0) ? sys::OS().getNumCPUs() : numThreads)),
+    mThreadPool(*mOwnedThreadPool),
+    mNumRowsPerStrip(numRowsPerStrip),
+    mNumBands(getNumBands(pixelType)),
+    mNumBytesPerPixel(getNumBytesPerPixel(pixelType)),
+    mHalo(0),
+    mNumRowsAdded(0)
+{
+    init(rrds, numLevels);
+}
+
+RRDSBuilder::RRDSBuilder(const types::RowCol<size_t>& dims,
+                         PixelType pixelType,
+                         const RRDS& rrds,
+                         size_t numLevels,
+                         Sink& sink,
+                         six::ThreadPool& threadPool,
+                         size_t numRowsPerStrip) :
+    mDims(dims),
+    mPixelType(pixelType),
+    mMethod(rrds.downsamplingMethod),
+    mSink(sink),
+    mThreadPool(threadPool),
+    mNumRowsPerStrip(numRowsPerStrip),
+    mNumBands(getNumBands(pixelType)),
+    mNumBytesPerPixel(getNumBytesPerPixel(pixelType)),
+    mHalo(0),
+    mNumRowsAdded(0)
+{
+    init(rrds, numLevels);
+}
+
+void RRDSBuilder::init(const RRDS& rrds, size_t numLevels)
+{
+    if (mDims.area() == 0)
+    {
+        throw except::Exception(Ctxt("Can't build RRDS of an empty image"));
+    }
+    if (mNumRowsPerStrip == 0)
+    {
+        throw except::Exception(Ctxt("Strips must have at least one row"));
+    }
+    if (mMethod == DownsamplingMethod::NOT_SET)
+    {
+        throw except::Exception(Ctxt("RRDS downsampling method is not set"));
+    }
+
+    if (rrds.antiAlias.get())
+    {
+        mAntiAlias.reset(new ImageFilter(*rrds.antiAlias, mThreadPool));
+        if (mAntiAlias->isBank())
+        {
+            throw except::Exception(Ctxt(
+                    "RRDS anti-aliasing filter must be a kernel"));
+        }
+        mHalo += mAntiAlias->getHalo().row;
+    }
+
+    if (mMethod == DownsamplingMethod::NEAREST_NEIGHBOR ||
+        mMethod == DownsamplingMethod::BILINEAR ||
+        mMethod == DownsamplingMethod::LAGRANGE)
+    {
+        if (rrds.interpolation.get())
+        {
+            mInterpolation.reset(new ImageFilter(*rrds.interpolation,
+                                                 mThreadPool));
+            if (!mInterpolation->isBank())
+            {
+                throw except::Exception(Ctxt(
+                        "RRDS interpolation filter must be a bank"));
+            }
+            mHalo += mInterpolation->getHalo().row;
+        }
+        else if (mMethod == DownsamplingMethod::NEAREST_NEIGHBOR)
+        {
+            mMethod = DownsamplingMethod::DECIMATE;
+        }
+        else if (mMethod == DownsamplingMethod::BILINEAR)
+        {
+            mMethod = DownsamplingMethod::AVERAGE;
+        }
+        else
+        {
+            throw except::Exception(Ctxt(
+                    "LAGRANGE downsampling needs an interpolation filter"));
+        }
+    }
+    mHalo += mHalo % 2;
+
+    mLevels.resize(numLevels);
+    for (size_t ii = 0; ii < numLevels; ++ii)
+    {
+        Level& level(mLevels[ii]);
+        level.inDims = getLevelDims(mDims, ii);
+        level.outDims = getLevelDims(mDims, ii + 1);
+        level.firstRow = 0;
+        level.numRowsAdded = 0;
+        level.nextOutputRow = 0;
+    }
+}
+
+size_t RRDSBuilder::getNumLevels(const types::RowCol<size_t>& dims,
+                                 size_t minDim)
+{
+    if (minDim == 0)
+    {
+        throw except::Exception(Ctxt("Smallest level must be at least 1"));
+    }
+
+    size_t numLevels = 0;
+    types::RowCol<size_t> levelDims(dims);
+    while (std::max(levelDims.row, levelDims.col) > minDim)
+    {
+        levelDims = getLevelDims(levelDims, 1);
+        ++numLevels;
+    }
+    return numLevels;
+}
+
+types::RowCol<size_t> RRDSBuilder::getLevelDims(
+        const types::RowCol<size_t>& dims,
+        size_t level)
+{
+    types::RowCol<size_t> levelDims(dims);
+    for (size_t ii = 0; ii < level; ++ii)
+    {
+        levelDims.row = (levelDims.row + 1) / 2;
+        levelDims.col = (levelDims.col + 1) / 2;
+    }
+    return levelDims;
+}
+
+void RRDSBuilder::addRows(const UByte* rows, size_t numRows)
+{
+    if (mNumRowsAdded + numRows > mDims.row)
+    {
+        throw except::Exception(Ctxt(
+                "Adding " + str::toString(numRows) + " rows after " +
+                str::toString(mNumRowsAdded) + " would overrun the " +
+                str::toString(mDims.row) + " rows of the image"));
+    }
+    if (numRows == 0)
+    {
+        return;
+    }
+
+    mNumRowsAdded += numRows;
+    if (!mLevels.empty())
+    {
+        addRows(0, rows, numRows);
+    }
+}
+
+void RRDSBuilder::addRows(size_t levelIndex,
+                          const UByte* rows,
+                          size_t numRows)
+{
+    Level& level(mLevels[levelIndex]);
+    const size_t numBytesPerInputRow = level.inDims.col * mNumBytesPerPixel;
+    level.rows.insert(level.rows.end(),
+                      rows,
+                      rows + numRows * numBytesPerInputRow);
+    level.numRowsAdded += numRows;
+
+    while (level.nextOutputRow < level.outDims.row)
+    {
+        // The strip can be built once all the rows it reads are here
+        const size_t numOutputRows = std::min(
+                mNumRowsPerStrip, level.outDims.row - level.nextOutputRow);
+        const size_t endRow = std::min(
+                level.inDims.row,
+                2 * (level.nextOutputRow + numOutputRows) + mHalo);
+        if (level.numRowsAdded < endRow)
+        {
+            break;
+        }
+
+        std::vector<UByte> strip(
+                numOutputRows * level.outDims.col * mNumBytesPerPixel);
+        buildStrip(level, numOutputRows, &strip[0]);
+        const size_t startRow = level.nextOutputRow;
+        level.nextOutputRow += numOutputRows;
+
+        // Let go of the rows that the next strip doesn't need
+        const size_t nextFirstRow = std::min(
+                level.numRowsAdded,
+                std::max(2 * level.nextOutputRow, mHalo) - mHalo);
+        level.rows.erase(level.rows.begin(),
+                         level.rows.begin() +
+                                 (nextFirstRow - level.firstRow) *
+                                 numBytesPerInputRow);
+        level.firstRow = nextFirstRow;
+
+        mSink.writeRows(levelIndex + 1, startRow, numOutputRows, &strip[0]);
+        if (levelIndex + 1 < mLevels.size())
+        {
+            addRows(levelIndex + 1, &strip[0], numOutputRows);
+        }
+    }
+}
+
+void RRDSBuilder::buildStrip(Level& level, size_t numRows, UByte* output)
+{
+    // Copy the rows the strip reads, with its halo, repeating the edges of
+    // the level below.  The strip is padded to an even number of columns
+    // so that every output pixel has a whole 2x2 block.
+    const types::RowCol<size_t> paddedDims(2 * (numRows + mHalo),
+                                           2 * level.outDims.col);
+    const size_t numBytesPerInputRow = level.inDims.col * mNumBytesPerPixel;
+    const size_t numBytesPerPaddedRow = paddedDims.col * mNumBytesPerPixel;
+    const ptrdiff_t firstRow = static_cast<ptrdiff_t>(
+            2 * level.nextOutputRow) - static_cast<ptrdiff_t>(mHalo);
+    mPadded.resize(paddedDims.area() * mNumBytesPerPixel);
+    for (size_t row = 0; row < paddedDims.row; ++row)
+    {
+        const ptrdiff_t inputRow = std::min(
+                std::max<ptrdiff_t>(firstRow + static_cast<ptrdiff_t>(row),
+                                    0),
+                static_cast<ptrdiff_t>(level.inDims.row) - 1);
+        const UByte* const source = &level.rows[
+                (inputRow - level.firstRow) * numBytesPerInputRow];
+        UByte* const dest = &mPadded[row * numBytesPerPaddedRow];
+        memcpy(dest, source, numBytesPerInputRow);
+        if (numBytesPerPaddedRow > numBytesPerInputRow)
+        {
+            memcpy(dest + numBytesPerInputRow,
+                   source + numBytesPerInputRow - mNumBytesPerPixel,
+                   mNumBytesPerPixel);
+        }
+    }
+
+    const UByte* padded = &mPadded[0];
+    if (mAntiAlias.get())
+    {
+        mFiltered.resize(mPadded.size());
+        mAntiAlias->apply(padded, mPixelType, paddedDims, &mFiltered[0]);
+        padded = &mFiltered[0];
+    }
+
+    const size_t numBytesPerOutputRow =
+            level.outDims.col * mNumBytesPerPixel;
+    if (mInterpolation.get())
+    {
+        // Resampling the whole padded strip puts each output pixel halfway
+        // between the pixels of its block
+        const types::RowCol<size_t> resampledDims(numRows + mHalo,
+                                                  level.outDims.col);
+        mResampled.resize(resampledDims.area() * mNumBytesPerPixel);
+        mInterpolation->resample(padded, mPixelType, paddedDims,
+                                 resampledDims, &mResampled[0]);
+        memcpy(output,
+               &mResampled[mHalo / 2 * numBytesPerOutputRow],
+               numRows * numBytesPerOutputRow);
+    }
+    else if (mPixelType == PixelType::MONO16I)
+    {
+        reduce<sys::Uint16_T>(padded + mHalo * numBytesPerPaddedRow,
+                              numRows, level.outDims.col, output);
+    }
+    else
+    {
+        reduce<UByte>(padded + mHalo * numBytesPerPaddedRow,
+                      numRows, level.outDims.col, output);
+    }
+}
+
+template <typename T>
+void RRDSBuilder::reduce(const UByte* padded,
+                         size_t numOutputRows,
+                         size_t numOutputCols,
+                         UByte* output)
+{
+    const mt::ThreadPlanner planner(
+            numOutputRows,
+            mThreadPool.getNumChunks(numOutputRows * numOutputCols,
+                                     MIN_PIXELS_PER_CHUNK));
+
+    std::vector<ReduceRows<T> > runnables;
+    size_t threadNum(0);
+    size_t startRow(0);
+    size_t numRowsThisThread(0);
+    while (planner.getThreadInfo(threadNum++, startRow, numRowsThisThread))
+    {
+        runnables.push_back(ReduceRows<T>(
+                mMethod,
+                reinterpret_cast<const T*>(padded),
+                numOutputCols,
+                mNumBands,
+                startRow,
+                numRowsThisThread,
+                reinterpret_cast<T*>(output)));
+    }
+    mThreadPool.runEach(runnables);
+}
+}
+}
@@ -0,0 +1,201 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <except/Exception.h>
+#include <import/nitf.hpp>
+#include <str/Convert.h>
+#include <str/Manip.h>
+#include <six/sidd/RRDSReader.h>
+#include <six/sidd/RRDSWriter.h>
+
+namespace
+{
+std::string getField(nitf::Field field)
+{
+    std::string value = field.toString();
+    str::trim(value);
+    return value;
+}
+
+six::PixelType toPixelType(const std::string& irep, size_t nbpp)
+{
+    if (irep == "MONO" && nbpp == 8)
+    {
+        return six::PixelType::MONO8I;
+    }
+    if (irep == "MONO" && nbpp == 16)
+    {
+        return six::PixelType::MONO16I;
+    }
+    if (irep == "RGB" && nbpp == 8)
+    {
+        return six::PixelType::RGB24I;
+    }
+    throw except::Exception(Ctxt(
+            "RRDS pixels can't be " + str::toString(nbpp) + "-bit " + irep));
+}
+}
+
+namespace six
+{
+namespace sidd
+{
+RRDSReader::RRDSReader(const std::string& pathname) :
+    mNumBytesPerPixel(0)
+{
+    {
+        nitf::IOHandle handle(pathname);
+        nitf::Reader reader;
+        nitf::Record record = reader.read(handle);
+
+        const size_t numImages = record.getNumImages();
+        mLevels.resize(numImages);
+        for (size_t ii = 0; ii < numImages; ++ii)
+        {
+            nitf::ImageSegment imageSegment = record.getImages()[ii];
+            nitf::ImageSubheader subheader = imageSegment.getSubheader();
+            if (getField(subheader.getImageId()) !=
+                RRDSWriter::getImageId(ii + 1))
+            {
+                throw except::Exception(Ctxt(
+                        "Image segment " + str::toString(ii) + " of " +
+                        pathname + " isn't RRDS level " +
+                        str::toString(ii + 1)));
+            }
+            if (getField(subheader.getImageCompression()) != "NC" ||
+                static_cast<nitf::Uint32>(
+                        subheader.getNumBlocksPerRow()) != 1 ||
+                static_cast<nitf::Uint32>(
+                        subheader.getNumBlocksPerCol()) != 1)
+            {
+                throw except::Exception(Ctxt(
+                        "RRDS level " + str::toString(ii + 1) +
+                        " must be uncompressed and unblocked"));
+            }
+
+            const PixelType pixelType = toPixelType(
+                    getField(subheader.getImageRepresentation()),
+                    static_cast<nitf::Uint32>(
+                            subheader.getNumBitsPerPixel()));
+            if (ii == 0)
+            {
+                mPixelType = pixelType;
+            }
+            else if (pixelType != mPixelType)
+            {
+                throw except::Exception(Ctxt(
+                        "RRDS levels must all have the same pixel type"));
+            }
+
+            Level& level(mLevels[ii]);
+            level.dims.row = static_cast<nitf::Uint32>(
+                    subheader.getNumRows());
+            level.dims.col = static_cast<nitf::Uint32>(
+                    subheader.getNumCols());
+            level.dataOffset =
+                    static_cast<sys::Off_T>(imageSegment.getImageOffset());
+        }
+    }
+
+    if (mLevels.empty())
+    {
+        throw except::Exception(Ctxt(pathname + " has no RRDS levels"));
+    }
+    mNumBytesPerPixel = (mPixelType == PixelType::RGB24I) ? 3 :
+            (mPixelType == PixelType::MONO16I) ? 2 : 1;
+    mFile.create(pathname, sys::File::READ_ONLY, sys::File::EXISTING);
+}
+
+size_t RRDSReader::getLevelForScale(double scale) const
+{
+    if (!(scale > 0.0))
+    {
+        throw except::Exception(Ctxt("Scale must be positive"));
+    }
+
+    size_t level = 0;
+    double levelScale = 0.5;
+    while (level < mLevels.size() && levelScale >= scale)
+    {
+        ++level;
+        levelScale *= 0.5;
+    }
+    return level;
+}
+
+void RRDSReader::readLevel(size_t level,
+                           const types::RowCol<size_t>& offset,
+                           const types::RowCol<size_t>& extent,
+                           UByte* buffer) const
+{
+    const Level& levelInfo(getLevel(level));
+    if (offset.row + extent.row > levelInfo.dims.row ||
+        offset.col + extent.col > levelInfo.dims.col)
+    {
+        throw except::Exception(Ctxt(
+                "Region is outside of the " +
+                str::toString(levelInfo.dims.row) + " x " +
+                str::toString(levelInfo.dims.col) + " pixels of RRDS level " +
+                str::toString(level)));
+    }
+    if (extent.area() == 0)
+    {
+        return;
+    }
+
+    const size_t numBytesPerRow = levelInfo.dims.col * mNumBytesPerPixel;
+    const size_t numBytesToRead = extent.col * mNumBytesPerPixel;
+    const sys::Off_T firstOffset = levelInfo.dataOffset +
+            static_cast<sys::Off_T>(offset.row * numBytesPerRow +
+                                    offset.col * mNumBytesPerPixel);
+    if (extent.col == levelInfo.dims.col)
+    {
+        // Whole rows are contiguous
+        mFile.readAt(firstOffset, buffer, extent.row * numBytesPerRow);
+    }
+    else
+    {
+        for (size_t row = 0; row < extent.row; ++row)
+        {
+            mFile.readAt(firstOffset +
+                                 static_cast<sys::Off_T>(row * numBytesPerRow),
+                         buffer + row * numBytesToRead,
+                         numBytesToRead);
+        }
+    }
+
+    if (mNumBytesPerPixel == 2 && !sys::isBigEndianSystem())
+    {
+        sys::byteSwap(buffer, 2, extent.area());
+    }
+}
+
+const RRDSReader::Level& RRDSReader::getLevel(size_t level) const
+{
+    if (level == 0 || level > mLevels.size())
+    {
+        throw except::Exception(Ctxt(
+                "RRDS level " + str::toString(level) + " does not exist"));
+    }
+    return mLevels[level - 1];
+}
+}
+}
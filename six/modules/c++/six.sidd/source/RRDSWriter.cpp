@@ -0,0 +1,335 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include <except/Exception.h>
+#include <str/Convert.h>
+#include <sys/Conf.h>
+#include <sys/OS.h>
+#include <six/NITFHeaderCreator.h>
+#include <six/NITFImageInfo.h>
+#include <six/NITFReadControl.h>
+#include <six/XMLControlFactory.h>
+#include <six/sidd/DerivedData.h>
+#include <six/sidd/DerivedXMLControl.h>
+#include <six/sidd/RRDSWriter.h>
+
+namespace
+{
+// Bytes of the product to read at once when building from a SIDD
+const size_t SWATH_BYTES = 32 * 1024 * 1024;
+
+// Only used for pixel types that have a LUT
+struct NoLUT
+{
+    const six::LUT* operator()() const
+    {
+        return NULL;
+    }
+};
+
+// Unblocked (per 2500C, if > 8192, should be set to 0)
+nitf::Uint32 getBlockDim(size_t imageDim)
+{
+    return (imageDim > 8192) ? 0 : static_cast<nitf::Uint32>(imageDim);
+}
+
+six::sidd::RRDS getRRDS(const six::sidd::DerivedData& data)
+{
+    const six::sidd::Display* const display = data.display.get();
+    if (display && !display->nonInteractiveProcessing.empty() &&
+        display->nonInteractiveProcessing[0].get())
+    {
+        return display->nonInteractiveProcessing[0]->rrds;
+    }
+
+    six::sidd::RRDS rrds;
+    rrds.downsamplingMethod = six::sidd::DownsamplingMethod::AVERAGE;
+    if (display)
+    {
+        switch (display->decimationMethod)
+        {
+        case six::DecimationMethod::NEAREST_NEIGHBOR:
+            rrds.downsamplingMethod =
+                    six::sidd::DownsamplingMethod::DECIMATE;
+            break;
+        case six::DecimationMethod::BRIGHTEST_PIXEL:
+            rrds.downsamplingMethod =
+                    six::sidd::DownsamplingMethod::MAX_PIXEL;
+            break;
+        default:
+            break;
+        }
+    }
+    return rrds;
+}
+}
+
+namespace six
+{
+namespace sidd
+{
+const size_t RRDSWriter::MAX_NUM_LEVELS;
+
+RRDSWriter::RRDSWriter(const std::string& pathname,
+                       const types::RowCol<size_t>& dims,
+                       PixelType pixelType,
+                       size_t numLevels) :
+    mRecord(NITF_VER_21),
+    mNumBytesPerPixel(pixelType == PixelType::RGB24I ? 3 :
+                      pixelType == PixelType::MONO16I ? 2 : 1)
+{
+    if (numLevels == 0 || numLevels > MAX_NUM_LEVELS)
+    {
+        throw except::Exception(Ctxt(
+                "RRDS must have between 1 and " +
+                str::toString(MAX_NUM_LEVELS) + " levels, not " +
+                str::toString(numLevels)));
+    }
+    if (pixelType != PixelType::MONO8I && pixelType != PixelType::MONO16I &&
+        pixelType != PixelType::RGB24I)
+    {
+        throw except::Exception(Ctxt(
+                "RRDS can't be written for pixel type " +
+                pixelType.toString()));
+    }
+
+    const nitf::Uint32 nbpp =
+            static_cast<nitf::Uint32>(mNumBytesPerPixel * 8 /
+                    (pixelType == PixelType::RGB24I ? 3 : 1));
+    mLevelDims.resize(numLevels);
+    for (size_t level = 1; level <= numLevels; ++level)
+    {
+        const types::RowCol<size_t> levelDims =
+                RRDSBuilder::getLevelDims(dims, level);
+        if (static_cast<sys::Uint64_T>(levelDims.area()) * mNumBytesPerPixel >
+            Constants::IS_SIZE_MAX)
+        {
+            throw except::Exception(Ctxt(
+                    "RRDS level " + str::toString(level) +
+                    " is too large for an image segment"));
+        }
+        mLevelDims[level - 1] = levelDims;
+
+        nitf::ImageSegment imageSegment = mRecord.newImageSegment();
+        nitf::ImageSubheader subheader = imageSegment.getSubheader();
+        subheader.getImageId().set(getImageId(level));
+        subheader.getImageTitle().set("Reduced resolution data set");
+
+        std::vector<nitf::BandInfo> bandInfo =
+                NITFImageInfo::getBandInfoImpl(pixelType, NoLUT());
+        subheader.setPixelInformation(
+                NITFImageInfo::getPixelValueType(pixelType), nbpp, nbpp, "R",
+                NITFImageInfo::getRepresentation(pixelType), "SAR",
+                bandInfo);
+        subheader.setBlocking(static_cast<nitf::Uint32>(levelDims.row),
+                              static_cast<nitf::Uint32>(levelDims.col),
+                              getBlockDim(levelDims.row),
+                              getBlockDim(levelDims.col),
+                              NITFImageInfo::getMode(pixelType));
+
+        subheader.getImageSyncCode().set(0);
+        subheader.getImageDisplayLevel().set(
+                static_cast<nitf::Uint16>(level));
+        subheader.getImageAttachmentLevel().set(
+                static_cast<nitf::Uint16>(level - 1));
+        subheader.getImageLocation().set("0000000000");
+        subheader.getImageMagnification().set(
+                "/" + str::toString(static_cast<size_t>(1) << level));
+    }
+
+    // Same as SIDDWriteControl, without any DESs
+    mIO.reset(new nitf::BufferedWriter(
+            pathname, NITFHeaderCreator::DEFAULT_BUFFER_SIZE));
+    mWriter.prepareIO(*mIO, mRecord);
+    mRecord.setComplexityLevelIfUnset();
+
+    nitf::Off fileLenOff;
+    nitf::Uint32 hdrLen;
+    mWriter.writeHeader(fileLenOff, hdrLen);
+
+    std::vector<nitf::Off> imageSubheaderLengths(numLevels);
+    std::vector<nitf::Off> imageDataLengths(numLevels);
+    mDataOffsets.resize(numLevels);
+    for (size_t ii = 0; ii < numLevels; ++ii)
+    {
+        nitf::ImageSegment imageSegment = mRecord.getImages()[ii];
+        nitf::ImageSubheader subheader = imageSegment.getSubheader();
+
+        const nitf::Off subheaderOffset = mIO->tell();
+        nitf::Off comratOff(0);
+        mWriter.writeImageSubheader(subheader,
+                                    mRecord.getVersion(),
+                                    comratOff);
+        mDataOffsets[ii] = mIO->tell();
+        imageSubheaderLengths[ii] = mDataOffsets[ii] - subheaderOffset;
+        imageDataLengths[ii] = subheader.getNumBytesOfImageData();
+        mIO->seek(mDataOffsets[ii] + imageDataLengths[ii], NITF_SEEK_SET);
+    }
+
+    const nitf::Off fileLength = mIO->tell();
+    mIO->seek(fileLenOff, NITF_SEEK_SET);
+    mWriter.writeInt64Field(fileLength, NITF_FL_SZ, '0',
+                            NITF_WRITER_FILL_LEFT);
+    mWriter.writeInt64Field(hdrLen, NITF_HL_SZ, '0', NITF_WRITER_FILL_LEFT);
+
+    mIO->seek(NITF_NUMI_SZ, NITF_SEEK_CUR);
+    for (size_t ii = 0; ii < numLevels; ++ii)
+    {
+        mWriter.writeInt64Field(imageSubheaderLengths[ii], NITF_LISH_SZ, '0',
+                                NITF_WRITER_FILL_LEFT);
+        mWriter.writeInt64Field(imageDataLengths[ii], NITF_LI_SZ, '0',
+                                NITF_WRITER_FILL_LEFT);
+    }
+}
+
+std::string RRDSWriter::getImageId(size_t level)
+{
+    std::ostringstream ostr;
+    ostr << "RRDS" << std::setw(3) << std::setfill('0') << level;
+    return ostr.str();
+}
+
+void RRDSWriter::writeRows(size_t level,
+                           size_t startRow,
+                           size_t numRows,
+                           const UByte* rows)
+{
+    if (level == 0 || level > mLevelDims.size())
+    {
+        throw except::Exception(Ctxt(
+                "RRDS level " + str::toString(level) + " does not exist"));
+    }
+    const types::RowCol<size_t>& levelDims(mLevelDims[level - 1]);
+    if (startRow + numRows > levelDims.row)
+    {
+        throw except::Exception(Ctxt(
+                "Rows " + str::toString(startRow) + " to " +
+                str::toString(startRow + numRows) + " are past the " +
+                str::toString(levelDims.row) + " rows of RRDS level " +
+                str::toString(level)));
+    }
+    if (mIO.get() == NULL)
+    {
+        throw except::Exception(Ctxt("RRDS has already been closed"));
+    }
+
+    const size_t numBytesPerRow = levelDims.col * mNumBytesPerPixel;
+    const size_t numBytes = numRows * numBytesPerRow;
+    const UByte* data = rows;
+    if (mNumBytesPerPixel == 2 && !sys::isBigEndianSystem())
+    {
+        mSwapped.assign(rows, rows + numBytes);
+        sys::byteSwap(&mSwapped[0], 2, numBytes / 2);
+        data = &mSwapped[0];
+    }
+
+    mIO->seek(mDataOffsets[level - 1] + startRow * numBytesPerRow,
+              NITF_SEEK_SET);
+    mIO->write(data, numBytes);
+}
+
+void RRDSWriter::close()
+{
+    if (mIO.get())
+    {
+        mIO->close();
+        mIO.reset();
+    }
+}
+
+size_t writeRRDS(const std::string& siddPathname,
+                 const std::string& rrdsPathname,
+                 const std::vector<std::string>& schemaPaths,
+                 size_t imageNumber,
+                 size_t numLevels,
+                 size_t numThreads)
+{
+    six::ThreadPool threadPool(
+            (numThreads == 0) ? sys::OS().getNumCPUs() : numThreads);
+    return writeRRDS(siddPathname, rrdsPathname, schemaPaths, threadPool,
+                     imageNumber, numLevels);
+}
+
+size_t writeRRDS(const std::string& siddPathname,
+                 const std::string& rrdsPathname,
+                 const std::vector<std::string>& schemaPaths,
+                 six::ThreadPool& threadPool,
+                 size_t imageNumber,
+                 size_t numLevels)
+{
+    XMLControlRegistry xmlRegistry;
+    xmlRegistry.addCreator(DataType::DERIVED,
+                           new XMLControlCreatorT<DerivedXMLControl>());
+
+    NITFReadControl reader;
+    reader.setXMLControlRegistry(&xmlRegistry);
+    reader.load(siddPathname, schemaPaths);
+
+    mem::SharedPtr<const Container> container = reader.getContainer();
+    if (container->getDataType() != DataType::DERIVED ||
+        imageNumber >= container->getNumData())
+    {
+        throw except::Exception(Ctxt(
+                siddPathname + " has no product " +
+                str::toString(imageNumber)));
+    }
+    const DerivedData& data(
+            *reinterpret_cast<const DerivedData*>(
+                    container->getData(imageNumber)));
+
+    const types::RowCol<size_t> dims(data.getNumRows(), data.getNumCols());
+    if (numLevels == 0)
+    {
+        numLevels = std::min(RRDSBuilder::getNumLevels(dims),
+                             RRDSWriter::MAX_NUM_LEVELS);
+    }
+
+    RRDSWriter writer(rrdsPathname, dims, data.getPixelType(), numLevels);
+    RRDSBuilder builder(dims, data.getPixelType(), getRRDS(data), numLevels,
+                        writer, threadPool);
+
+    const size_t numBytesPerRow = dims.col * data.getNumBytesPerPixel();
+    const size_t numRowsPerSwath =
+            std::max<size_t>(SWATH_BYTES / numBytesPerRow, 1);
+    std::vector<UByte> swath(
+            std::min(numRowsPerSwath, dims.row) * numBytesPerRow);
+    for (size_t row = 0; row < dims.row; row += numRowsPerSwath)
+    {
+        const size_t numRows = std::min(numRowsPerSwath, dims.row - row);
+        Region region;
+        region.setStartRow(row);
+        region.setNumRows(numRows);
+        region.setStartCol(0);
+        region.setNumCols(dims.col);
+        region.setBuffer(&swath[0]);
+        reader.interleaved(region, imageNumber);
+        builder.addRows(&swath[0], numRows);
+    }
+
+    writer.close();
+    return numLevels;
+}
+}
+}
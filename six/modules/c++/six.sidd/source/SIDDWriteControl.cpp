@@ -0,0 +1,530 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+#include <algorithm>
+
+#include <except/Exception.h>
+#include <logging/NullLogger.h>
+#include <mt/CriticalSection.h>
+#include <str/Manip.h>
+#include <six/XMLControlFactory.h>
+#include <six/sidd/SIDDWriteControl.h>
+
+namespace
+{
+// Block dimensions of 0 mean the whole image
+size_t getBlockDim(nitf::Field field, size_t imageDim)
+{
+    const size_t blockDim = static_cast<nitf::Uint32>(field);
+    return (blockDim == 0) ? imageDim : blockDim;
+}
+}
+
+namespace six
+{
+namespace sidd
+{
+SIDDWriteControl::SIDDWriteControl(const std::string& outputPathname,
+                                   const std::vector<std::string>& schemaPaths) :
+    mIO(new nitf::BufferedWriter(outputPathname,
+                                 NITFHeaderCreator::DEFAULT_BUFFER_SIZE)),
+    mSchemaPaths(schemaPaths),
+    mDoByteSwap(false),
+    mNumPendingBytes(0),
+    mHaveWrittenHeaders(false)
+{
+}
+
+void SIDDWriteControl::initialize(const DerivedData& data)
+{
+    mem::SharedPtr<Container> container(new Container(DataType::DERIVED));
+
+    // The container wants to take ownership of the data
+    // To avoid memory problems, we'll just clone it. After calling
+    // initialize, the base class will refer to this Container.
+    container->addData(data.clone());
+    initialize(container);
+}
+
+void SIDDWriteControl::writeHeaders()
+{
+    if (!getSegmentWriters().empty())
+    {
+        throw except::NotImplementedException(Ctxt(
+                "Additional DESs are not supported"));
+    }
+
+    const double j2kCompression = getOptions().getParameter(
+            NITFHeaderCreator::OPT_J2K_COMPRESSION_BYTERATE, Parameter(0));
+    if (j2kCompression > 0.0001 && j2kCompression <= 1.0)
+    {
+        throw except::NotImplementedException(Ctxt(
+                "J2K compression is not supported"));
+    }
+
+    mDoByteSwap = shouldByteSwap();
+
+    mem::SharedPtr<const Container> container = getContainer();
+    logging::NullLogger logger;
+    std::vector<std::string> xmlStrings(container->getNumData());
+    for (size_t ii = 0; ii < xmlStrings.size(); ++ii)
+    {
+        xmlStrings[ii] = six::toValidXMLString(
+                container->getData(ii),
+                mSchemaPaths,
+                &logger,
+                getNITFHeaderCreator()->getXMLControlRegistry());
+    }
+
+    // Write the headers in file order, skipping over the image data.  The
+    // lengths in the file header aren't known until the end, so they're
+    // filled in afterwards.
+    nitf::Record record = getRecord();
+    mWriter.prepareIO(*mIO, record);
+    record.setComplexityLevelIfUnset();
+
+    nitf::Off fileLenOff;
+    nitf::Uint32 hdrLen;
+    mWriter.writeHeader(fileLenOff, hdrLen);
+
+    const size_t numImages = record.getNumImages();
+    std::vector<nitf::Off> imageSubheaderLengths(numImages);
+    std::vector<nitf::Off> imageDataOffsets(numImages);
+    std::vector<nitf::Off> imageDataLengths(numImages);
+    for (size_t ii = 0; ii < numImages; ++ii)
+    {
+        nitf::ImageSegment imageSegment = record.getImages()[ii];
+        nitf::ImageSubheader subheader = imageSegment.getSubheader();
+
+        const nitf::Off subheaderOffset = mIO->tell();
+        nitf::Off comratOff(0);
+        mWriter.writeImageSubheader(subheader,
+                                    record.getVersion(),
+                                    comratOff);
+        imageDataOffsets[ii] = mIO->tell();
+        imageSubheaderLengths[ii] = imageDataOffsets[ii] - subheaderOffset;
+        imageDataLengths[ii] = subheader.getNumBytesOfImageData();
+        mIO->seek(imageDataOffsets[ii] + imageDataLengths[ii],
+                  NITF_SEEK_SET);
+    }
+
+    const size_t numDESs = record.getNumDataExtensions();
+    if (numDESs != xmlStrings.size())
+    {
+        throw except::Exception(Ctxt(
+                "Record has " + str::toString(numDESs) + " DESs but " +
+                str::toString(xmlStrings.size()) + " XML strings"));
+    }
+
+    std::vector<nitf::Off> desSubheaderLengths(numDESs);
+    std::vector<nitf::Off> desDataLengths(numDESs);
+    for (size_t ii = 0; ii < numDESs; ++ii)
+    {
+        nitf::DESegment deSegment = record.getDataExtensions()[ii];
+        nitf::DESubheader subheader = deSegment.getSubheader();
+
+        const nitf::Off subheaderOffset = mIO->tell();
+        nitf::Uint32 userSublen;
+        mWriter.writeDESubheader(subheader, userSublen, record.getVersion());
+        desSubheaderLengths[ii] = mIO->tell() - subheaderOffset;
+
+        mIO->write(xmlStrings[ii].c_str(), xmlStrings[ii].length());
+        desDataLengths[ii] = xmlStrings[ii].length();
+    }
+
+    // Same as nitf::ByteProvider
+    const nitf::Off fileLength = mIO->tell();
+    mIO->seek(fileLenOff, NITF_SEEK_SET);
+    mWriter.writeInt64Field(fileLength, NITF_FL_SZ, '0',
+                            NITF_WRITER_FILL_LEFT);
+    mWriter.writeInt64Field(hdrLen, NITF_HL_SZ, '0', NITF_WRITER_FILL_LEFT);
+
+    mIO->seek(NITF_NUMI_SZ, NITF_SEEK_CUR);
+    for (size_t ii = 0; ii < numImages; ++ii)
+    {
+        mWriter.writeInt64Field(imageSubheaderLengths[ii], NITF_LISH_SZ, '0',
+                                NITF_WRITER_FILL_LEFT);
+        mWriter.writeInt64Field(imageDataLengths[ii], NITF_LI_SZ, '0',
+                                NITF_WRITER_FILL_LEFT);
+    }
+
+    mIO->seek(NITF_NUMS_SZ + NITF_NUMX_SZ + NITF_NUMT_SZ + NITF_NUMDES_SZ,
+              NITF_SEEK_CUR);
+    for (size_t ii = 0; ii < numDESs; ++ii)
+    {
+        mWriter.writeInt64Field(desSubheaderLengths[ii], NITF_LDSH_SZ, '0',
+                                NITF_WRITER_FILL_LEFT);
+        mWriter.writeInt64Field(desDataLengths[ii], NITF_LD_SZ, '0',
+                                NITF_WRITER_FILL_LEFT);
+    }
+
+    // Figure out where each product's pixels go
+    const std::vector<mem::SharedPtr<NITFImageInfo> > infos = getInfos();
+    mProducts.resize(infos.size());
+    for (size_t ii = 0; ii < infos.size(); ++ii)
+    {
+        const NITFImageInfo& info = *infos[ii];
+        const Data& data = *info.getData();
+        const std::vector<NITFSegmentInfo> imageSegments =
+                info.getImageSegments();
+
+        ProductLayout& product(mProducts[ii]);
+        product.numRows = data.getNumRows();
+        product.numCols = data.getNumCols();
+        product.numBytesPerPixel = data.getNumBytesPerPixel();
+        product.numBytesPerElement = std::max<size_t>(
+                product.numBytesPerPixel / data.getNumChannels(), 1);
+        product.segments.resize(imageSegments.size());
+
+        for (size_t jj = 0; jj < imageSegments.size(); ++jj)
+        {
+            const size_t recordIndex = info.getStartIndex() + jj;
+            nitf::ImageSegment imageSegment =
+                    record.getImages()[recordIndex];
+            nitf::ImageSubheader subheader = imageSegment.getSubheader();
+
+            const std::string mode = subheader.getImageMode().toString();
+            if (static_cast<nitf::Uint32>(subheader.getNumImageBands()) > 1 &&
+                mode != "P")
+            {
+                throw except::NotImplementedException(Ctxt(
+                        "Image mode " + mode + " is not supported"));
+            }
+
+            SegmentLayout& segment(product.segments[jj]);
+            segment.recordIndex = recordIndex;
+            segment.firstRow = imageSegments[jj].firstRow;
+            segment.numRows = imageSegments[jj].numRows;
+            segment.dataOffset = imageDataOffsets[recordIndex];
+            segment.numRowsPerBlock = getBlockDim(
+                    subheader.getNumPixelsPerVertBlock(), segment.numRows);
+            segment.numColsPerBlock = getBlockDim(
+                    subheader.getNumPixelsPerHorizBlock(), product.numCols);
+            segment.numBlocksPerRow =
+                    static_cast<nitf::Uint32>(subheader.getNumBlocksPerRow());
+
+            // Blocks that span all the columns are just rows in order
+            segment.isBlocked = (segment.numBlocksPerRow > 1 ||
+                                 segment.numColsPerBlock != product.numCols);
+        }
+
+        const Legend* const legend = container->getLegend(ii);
+        if (legend)
+        {
+            const size_t legendIndex =
+                    info.getStartIndex() + imageSegments.size();
+            writeLegend(*legend,
+                        imageDataOffsets.at(legendIndex),
+                        imageDataLengths.at(legendIndex));
+        }
+    }
+}
+
+void SIDDWriteControl::writeLegend(const Legend& legend,
+                                   nitf::Off dataOffset,
+                                   nitf::Off dataLength)
+{
+    if (legend.mDims.row * legend.mDims.col != legend.mImage.size())
+    {
+        throw except::Exception(Ctxt("Legend dimensions don't match"));
+    }
+
+    if (legend.mImage.empty())
+    {
+        throw except::Exception(Ctxt("Empty legend"));
+    }
+
+    if (static_cast<nitf::Off>(legend.mImage.size()) != dataLength)
+    {
+        throw except::Exception(Ctxt(
+                "Legend has " + str::toString(legend.mImage.size()) +
+                " pixels but its image segment holds " +
+                str::toString(dataLength)));
+    }
+
+    mIO->seek(dataOffset, NITF_SEEK_SET);
+    mIO->write(&legend.mImage[0], legend.mImage.size());
+}
+
+void SIDDWriteControl::save(const void* imageData,
+                            const types::RowCol<size_t>& offset,
+                            const types::RowCol<size_t>& dims,
+                            size_t imageNumber)
+{
+    if (getContainer().get() == NULL)
+    {
+        throw except::Exception(Ctxt(
+                "initialize() must be called prior to calling save()"));
+    }
+
+    // The first time through we'll write out all the headers
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mIOMutex);
+        if (!mHaveWrittenHeaders)
+        {
+            writeHeaders();
+            mHaveWrittenHeaders = true;
+        }
+    }
+
+    if (imageNumber >= mProducts.size())
+    {
+        throw except::Exception(Ctxt(
+                "Image " + str::toString(imageNumber) + " does not exist"));
+    }
+
+    const ProductLayout& product(mProducts[imageNumber]);
+    if (offset.row + dims.row > product.numRows ||
+        offset.col + dims.col > product.numCols)
+    {
+        throw except::Exception(Ctxt(
+                "Tile at (" + str::toString(offset.row) + ", " +
+                str::toString(offset.col) + ") with dimensions (" +
+                str::toString(dims.row) + ", " + str::toString(dims.col) +
+                ") is outside of image " + str::toString(imageNumber)));
+    }
+
+    const sys::ubyte* const pixels = static_cast<const sys::ubyte*>(imageData);
+    for (size_t seg = 0; seg < product.segments.size(); ++seg)
+    {
+        // See if we're in this segment
+        const SegmentLayout& segment(product.segments[seg]);
+        const size_t startRow = std::max(offset.row, segment.firstRow);
+        const size_t endRow = std::min(offset.row + dims.row,
+                                       segment.firstRow + segment.numRows);
+        if (startRow >= endRow || dims.col == 0)
+        {
+            continue;
+        }
+
+        if (segment.isBlocked)
+        {
+            saveBlocks(pixels, offset, dims, product, segment,
+                       startRow, endRow - startRow);
+        }
+        else
+        {
+            saveRows(pixels, offset, dims, product, segment,
+                     startRow, endRow - startRow);
+        }
+    }
+}
+
+void SIDDWriteControl::saveRows(const sys::ubyte* imageData,
+                                const types::RowCol<size_t>& offset,
+                                const types::RowCol<size_t>& dims,
+                                const ProductLayout& product,
+                                const SegmentLayout& segment,
+                                size_t startRow,
+                                size_t numRows)
+{
+    // Whole rows are contiguous in the file, so they can go out together
+    const size_t numBytesPerRow = dims.col * product.numBytesPerPixel;
+    const size_t numRowsPerWrite =
+            (dims.col == product.numCols) ? numRows : 1;
+    std::vector<sys::ubyte> buffer;
+
+    for (size_t row = startRow;
+         row < startRow + numRows;
+         row += numRowsPerWrite)
+    {
+        const sys::ubyte* const src =
+                imageData + (row - offset.row) * numBytesPerRow;
+        buffer.assign(src, src + numRowsPerWrite * numBytesPerRow);
+
+        const size_t pixelOffset =
+                (row - segment.firstRow) * product.numCols + offset.col;
+        writeAt(segment.dataOffset + pixelOffset * product.numBytesPerPixel,
+                buffer,
+                product.numBytesPerElement);
+    }
+}
+
+void SIDDWriteControl::saveBlocks(const sys::ubyte* imageData,
+                                  const types::RowCol<size_t>& offset,
+                                  const types::RowCol<size_t>& dims,
+                                  const ProductLayout& product,
+                                  const SegmentLayout& segment,
+                                  size_t startRow,
+                                  size_t numRows)
+{
+    const size_t numBytesPerPixel = product.numBytesPerPixel;
+    const size_t numBytesPerBlock = segment.numRowsPerBlock *
+            segment.numColsPerBlock * numBytesPerPixel;
+    const size_t endRow = startRow + numRows;
+    const size_t endCol = offset.col + dims.col;
+
+    const size_t firstBlockRow =
+            (startRow - segment.firstRow) / segment.numRowsPerBlock;
+    const size_t lastBlockRow =
+            (endRow - 1 - segment.firstRow) / segment.numRowsPerBlock;
+    const size_t firstBlockCol = offset.col / segment.numColsPerBlock;
+    const size_t lastBlockCol = (endCol - 1) / segment.numColsPerBlock;
+
+    for (size_t blockRow = firstBlockRow; blockRow <= lastBlockRow; ++blockRow)
+    {
+        // Global rows of the block, not counting pad rows
+        const size_t blockStartRow =
+                segment.firstRow + blockRow * segment.numRowsPerBlock;
+        const size_t blockEndRow =
+                std::min(blockStartRow + segment.numRowsPerBlock,
+                         segment.firstRow + segment.numRows);
+
+        // Rows of the tile that are in the block
+        const size_t tileStartRow = std::max(blockStartRow, startRow);
+        const size_t tileEndRow = std::min(blockEndRow, endRow);
+
+        for (size_t blockCol = firstBlockCol;
+             blockCol <= lastBlockCol;
+             ++blockCol)
+        {
+            const size_t blockStartCol = blockCol * segment.numColsPerBlock;
+            const size_t blockEndCol =
+                    std::min(blockStartCol + segment.numColsPerBlock,
+                             product.numCols);
+
+            const size_t tileStartCol = std::max(blockStartCol, offset.col);
+            const size_t tileEndCol = std::min(blockEndCol, endCol);
+            const size_t numBytesToCopy =
+                    (tileEndCol - tileStartCol) * numBytesPerPixel;
+            const size_t numPixelsToCopy =
+                    (tileEndRow - tileStartRow) * (tileEndCol - tileStartCol);
+
+            const size_t blockIndex =
+                    blockRow * segment.numBlocksPerRow + blockCol;
+            const BlockKey key(segment.recordIndex, blockIndex);
+            const nitf::Off blockOffset = segment.dataOffset +
+                    static_cast<nitf::Off>(blockIndex) * numBytesPerBlock;
+
+            std::vector<sys::ubyte> completedBlock;
+            {
+                mt::CriticalSection<sys::Mutex> lock(&mBlockMutex);
+
+                std::map<BlockKey, PendingBlock>::iterator it =
+                        mPendingBlocks.find(key);
+                if (it == mPendingBlocks.end())
+                {
+                    // Pad pixels are left as zeros
+                    PendingBlock newBlock;
+                    newBlock.numPixelsLeft = (blockEndRow - blockStartRow) *
+                            (blockEndCol - blockStartCol);
+                    newBlock.fileOffset = blockOffset;
+                    newBlock.numBytesPerElement = product.numBytesPerElement;
+                    it = mPendingBlocks.insert(
+                            std::make_pair(key, newBlock)).first;
+                    it->second.pixels.resize(numBytesPerBlock);
+                    mNumPendingBytes += numBytesPerBlock;
+                }
+
+                PendingBlock& block(it->second);
+                if (numPixelsToCopy > block.numPixelsLeft)
+                {
+                    throw except::Exception(Ctxt(
+                            "Pixels were saved more than once"));
+                }
+
+                for (size_t row = tileStartRow; row < tileEndRow; ++row)
+                {
+                    const sys::ubyte* const src = imageData +
+                            ((row - offset.row) * dims.col +
+                             tileStartCol - offset.col) * numBytesPerPixel;
+                    sys::ubyte* const dest = &block.pixels[
+                            ((row - blockStartRow) * segment.numColsPerBlock +
+                             tileStartCol - blockStartCol) * numBytesPerPixel];
+                    memcpy(dest, src, numBytesToCopy);
+                }
+
+                block.numPixelsLeft -= numPixelsToCopy;
+                if (block.numPixelsLeft == 0)
+                {
+                    completedBlock.swap(block.pixels);
+                    mPendingBlocks.erase(it);
+                    mNumPendingBytes -= numBytesPerBlock;
+                }
+            }
+
+            // Write outside of the lock so other threads can keep filling
+            // in blocks
+            if (!completedBlock.empty())
+            {
+                writeAt(blockOffset, completedBlock,
+                        product.numBytesPerElement);
+            }
+        }
+    }
+}
+
+void SIDDWriteControl::writeAt(nitf::Off fileOffset,
+                               std::vector<sys::ubyte>& pixels,
+                               size_t numBytesPerElement)
+{
+    if (mDoByteSwap && numBytesPerElement > 1)
+    {
+        sys::byteSwap(&pixels[0],
+                      static_cast<unsigned short>(numBytesPerElement),
+                      pixels.size() / numBytesPerElement);
+    }
+
+    mt::CriticalSection<sys::Mutex> lock(&mIOMutex);
+    mIO->seek(fileOffset, NITF_SEEK_SET);
+    mIO->write(&pixels[0], pixels.size());
+}
+
+size_t SIDDWriteControl::getNumPendingBytes() const
+{
+    mt::CriticalSection<sys::Mutex> lock(&mBlockMutex);
+    return mNumPendingBytes;
+}
+
+void SIDDWriteControl::close()
+{
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mIOMutex);
+        if (!mHaveWrittenHeaders && getContainer().get() != NULL)
+        {
+            writeHeaders();
+            mHaveWrittenHeaders = true;
+        }
+    }
+
+    std::map<BlockKey, PendingBlock> pendingBlocks;
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mBlockMutex);
+        pendingBlocks.swap(mPendingBlocks);
+        mNumPendingBytes = 0;
+    }
+
+    for (std::map<BlockKey, PendingBlock>::iterator it =
+                 pendingBlocks.begin();
+         it != pendingBlocks.end();
+         ++it)
+    {
+        writeAt(it->second.fileOffset,
+                it->second.pixels,
+                it->second.numBytesPerElement);
+    }
+
+    mt::CriticalSection<sys::Mutex> lock(&mIOMutex);
+    mIO->close();
+}
+}
+}
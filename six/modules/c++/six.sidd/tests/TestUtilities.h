@@ -0,0 +1,62 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __SIX_SIDD_TEST_UTILITIES_H__
+#define __SIX_SIDD_TEST_UTILITIES_H__
+
+#include <vector>
+
+#include <sys/Conf.h>
+#include <six/sidd/Filter.h>
+
+// A filter with a custom kernel of numRows x numCols coefficients
+inline six::sidd::Filter makeKernel(
+        size_t numRows,
+        size_t numCols,
+        const std::vector<double>& coefs,
+        six::sidd::FilterOperation operation =
+                six::sidd::FilterOperation::CORRELATION)
+{
+    six::sidd::Filter filter;
+    filter.operation = operation;
+    filter.filterKernel.reset(new six::sidd::Filter::Kernel());
+    filter.filterKernel->custom.reset(
+            new six::sidd::Filter::Kernel::Custom());
+    filter.filterKernel->custom->size =
+            six::RowColInt(static_cast<sys::SSize_T>(numRows),
+                           static_cast<sys::SSize_T>(numCols));
+    filter.filterKernel->custom->filterCoef = coefs;
+    return filter;
+}
+
+// A filter with one of the predefined filter banks
+inline six::sidd::Filter makeBank(six::sidd::FilterDatabaseName name)
+{
+    six::sidd::Filter filter;
+    filter.operation = six::sidd::FilterOperation::CONVOLUTION;
+    filter.filterBank.reset(new six::sidd::Filter::Bank());
+    filter.filterBank->predefined.reset(new six::sidd::Filter::Predefined());
+    filter.filterBank->predefined->databaseName = name;
+    return filter;
+}
+
+#endif
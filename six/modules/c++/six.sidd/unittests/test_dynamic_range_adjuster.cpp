@@ -0,0 +1,371 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+#include <import/six/sidd.h>
+#include <sys/Conf.h>
+#include "TestCase.h"
+
+namespace
+{
+six::sidd::DynamicRangeAdjustment makeAuto(double pMin,
+                                           double pMax,
+                                           double eMinModifier,
+                                           double eMaxModifier)
+{
+    six::sidd::DynamicRangeAdjustment dra;
+    dra.algorithmType = six::sidd::DRAType::AUTO;
+    dra.bandStatsSource = 1;
+    dra.draParameters.reset(
+            new six::sidd::DynamicRangeAdjustment::DRAParameters());
+    dra.draParameters->pMin = pMin;
+    dra.draParameters->pMax = pMax;
+    dra.draParameters->eMinModifier = eMinModifier;
+    dra.draParameters->eMaxModifier = eMaxModifier;
+    return dra;
+}
+
+// Every value in [0, 100) appears in a column of 100 rows
+std::vector<six::UByte> makeRamp()
+{
+    std::vector<six::UByte> image(100 * 100);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = static_cast<six::UByte>(ii % 100);
+    }
+    return image;
+}
+
+TEST_CASE(testAuto)
+{
+    const types::RowCol<size_t> dims(100, 100);
+    const std::vector<six::UByte> image = makeRamp();
+
+    six::sidd::DynamicRangeAdjustment dra = makeAuto(0.1, 0.9, 0.0, 0.0);
+    six::sidd::DynamicRangeAdjuster adjuster(dra, 2);
+    TEST_ASSERT_TRUE(adjuster.needsStatistics());
+    TEST_EXCEPTION(adjuster.getRemap());
+
+    adjuster.computeStatistics(&image[0], six::PixelType::MONO8I, dims);
+    const six::sidd::DynamicRangeAdjuster::Statistics& stats =
+            adjuster.getStatistics();
+    TEST_ASSERT_EQ(stats.minValue, 0.0);
+    TEST_ASSERT_EQ(stats.maxValue, 99.0);
+    TEST_ASSERT_EQ(stats.pMinValue, 9.0);
+    TEST_ASSERT_EQ(stats.pMaxValue, 89.0);
+    TEST_ASSERT_EQ(adjuster.getRemap().subtractor, 9.0);
+    TEST_ASSERT_ALMOST_EQ(adjuster.getRemap().multiplier, 255.0 / 80.0);
+
+    std::vector<six::UByte> output(image.size());
+    adjuster.apply(&image[0], six::PixelType::MONO8I, dims, &output[0]);
+    TEST_ASSERT_EQ(static_cast<int>(output[5]), 0);
+    TEST_ASSERT_EQ(static_cast<int>(output[9]), 0);
+    TEST_ASSERT_EQ(static_cast<int>(output[49]), 128);
+    TEST_ASSERT_EQ(static_cast<int>(output[89]), 255);
+    TEST_ASSERT_EQ(static_cast<int>(output[99]), 255);
+
+    // Only AUTO records the remap
+    TEST_ASSERT_TRUE(dra.draOverrides.get() == NULL);
+    adjuster.update(dra);
+    TEST_ASSERT_TRUE(dra.draOverrides.get() != NULL);
+    TEST_ASSERT_EQ(dra.draOverrides->subtractor, 9.0);
+}
+
+TEST_CASE(testModifiers)
+{
+    const types::RowCol<size_t> dims(100, 100);
+    const std::vector<six::UByte> image = makeRamp();
+
+    // Moving Emin and Emax all the way out uses the full range of the data
+    six::sidd::DynamicRangeAdjuster adjuster(makeAuto(0.1, 0.9, 1.0, 1.0));
+    adjuster.computeStatistics(&image[0], six::PixelType::MONO8I, dims);
+    TEST_ASSERT_EQ(adjuster.getRemap().subtractor, 0.0);
+    TEST_ASSERT_ALMOST_EQ(adjuster.getRemap().multiplier, 255.0 / 99.0);
+
+    six::sidd::DynamicRangeAdjuster halfway(makeAuto(0.1, 0.9, 0.5, 0.5));
+    halfway.computeStatistics(&image[0], six::PixelType::MONO8I, dims);
+    TEST_ASSERT_EQ(halfway.getRemap().subtractor, 4.5);
+    TEST_ASSERT_ALMOST_EQ(halfway.getRemap().multiplier, 255.0 / 89.5);
+}
+
+TEST_CASE(testStatsBand)
+{
+    // The second band has twice the values of the others
+    const types::RowCol<size_t> dims(100, 100);
+    const std::vector<six::UByte> ramp = makeRamp();
+    std::vector<six::UByte> image(ramp.size() * 3);
+    for (size_t ii = 0; ii < ramp.size(); ++ii)
+    {
+        image[ii * 3] = ramp[ii];
+        image[ii * 3 + 1] = static_cast<six::UByte>(ramp[ii] * 2);
+        image[ii * 3 + 2] = ramp[ii];
+    }
+
+    six::sidd::DynamicRangeAdjustment dra = makeAuto(0.0, 1.0, 0.0, 0.0);
+    dra.bandStatsSource = 2;
+    six::sidd::DynamicRangeAdjuster adjuster(dra);
+    adjuster.computeStatistics(&image[0], six::PixelType::RGB24I, dims);
+    TEST_ASSERT_EQ(adjuster.getStatistics().maxValue, 198.0);
+
+    std::vector<six::UByte> output(image.size());
+    adjuster.apply(&image[0], six::PixelType::RGB24I, dims, &output[0]);
+    TEST_ASSERT_EQ(static_cast<int>(output[66 * 3]), 85);
+    TEST_ASSERT_EQ(static_cast<int>(output[66 * 3 + 1]), 170);
+    TEST_ASSERT_EQ(static_cast<int>(output[66 * 3 + 2]), 85);
+
+    dra.bandStatsSource = 4;
+    six::sidd::DynamicRangeAdjuster badBand(dra);
+    TEST_EXCEPTION(badBand.computeStatistics(
+            &image[0], six::PixelType::RGB24I, dims));
+    TEST_EXCEPTION(badBand.computeStatistics(
+            &image[0], six::PixelType::MONO8LU, dims));
+}
+
+TEST_CASE(testThreadsAgree)
+{
+    // Big enough to be split up
+    const types::RowCol<size_t> dims(301, 499);
+    std::vector<sys::Uint16_T> image(dims.area());
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = static_cast<sys::Uint16_T>((ii * 7919) % 40000);
+    }
+    const six::UByte* const pixels =
+            reinterpret_cast<const six::UByte*>(&image[0]);
+
+    const six::sidd::DynamicRangeAdjustment dra =
+            makeAuto(0.02, 0.98, 0.2, 0.3);
+    six::sidd::DynamicRangeAdjuster serial(dra, 1);
+    six::ThreadPool threadPool(4);
+    six::sidd::DynamicRangeAdjuster parallel(dra, threadPool);
+    serial.computeStatistics(pixels, six::PixelType::MONO16I, dims);
+    parallel.computeStatistics(pixels, six::PixelType::MONO16I, dims);
+    TEST_ASSERT_EQ(serial.getRemap().subtractor,
+                   parallel.getRemap().subtractor);
+    TEST_ASSERT_EQ(serial.getRemap().multiplier,
+                   parallel.getRemap().multiplier);
+
+    std::vector<six::UByte> serialOutput(image.size());
+    std::vector<six::UByte> parallelOutput(image.size());
+    serial.apply(pixels, six::PixelType::MONO16I, dims, &serialOutput[0]);
+    parallel.apply(pixels, six::PixelType::MONO16I, dims, &parallelOutput[0]);
+    TEST_ASSERT_TRUE(serialOutput == parallelOutput);
+}
+
+TEST_CASE(testComplex)
+{
+    // Amplitudes 0 through 200, in a 3-4-5 triangle
+    const types::RowCol<size_t> dims(201, 1);
+    std::vector<std::complex<float> > image(dims.area());
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = std::complex<float>(ii * 0.6f, ii * 0.8f);
+    }
+
+    six::sidd::DynamicRangeAdjuster adjuster(makeAuto(0.0, 1.0, 0.0, 0.0));
+    adjuster.computeStatistics(&image[0], dims);
+    TEST_ASSERT_ALMOST_EQ_EPS(adjuster.getStatistics().minValue, 0.0, 1e-4);
+    TEST_ASSERT_ALMOST_EQ_EPS(adjuster.getStatistics().maxValue, 200.0, 1e-4);
+    TEST_ASSERT_ALMOST_EQ_EPS(adjuster.getRemap().subtractor, 0.0, 1e-2);
+    TEST_ASSERT_ALMOST_EQ_EPS(adjuster.getRemap().multiplier,
+                              255.0 / 200.0, 1e-4);
+
+    std::vector<six::UByte> output(image.size());
+    adjuster.apply(&image[0], dims, &output[0]);
+    TEST_ASSERT_EQ(static_cast<int>(output[0]), 0);
+    TEST_ASSERT_EQ(static_cast<int>(output[40]), 51);
+    TEST_ASSERT_EQ(static_cast<int>(output[200]), 255);
+}
+
+TEST_CASE(testAddRows)
+{
+    // 16-bit pixels, added a few uneven swaths at a time, out of order
+    const types::RowCol<size_t> dims(300, 70);
+    std::vector<sys::Uint16_T> image(dims.area());
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = static_cast<sys::Uint16_T>((ii * 7919) % 40000 + 100);
+    }
+    const six::UByte* const bytes =
+            reinterpret_cast<const six::UByte*>(&image[0]);
+
+    const six::sidd::DynamicRangeAdjustment dra =
+            makeAuto(0.05, 0.95, 0.5, 0.5);
+    six::sidd::DynamicRangeAdjuster whole(dra, 2);
+    whole.computeStatistics(bytes, six::PixelType::MONO16I, dims);
+
+    six::sidd::DynamicRangeAdjuster swaths(dra, 2);
+    TEST_EXCEPTION(swaths.finishStatistics());
+    const size_t rowBytes = dims.col * sizeof(sys::Uint16_T);
+    swaths.addRows(bytes + 120 * rowBytes, six::PixelType::MONO16I,
+                   types::RowCol<size_t>(180, dims.col));
+    swaths.addRows(bytes, six::PixelType::MONO16I,
+                   types::RowCol<size_t>(17, dims.col));
+    TEST_EXCEPTION(swaths.addRows(bytes, six::PixelType::MONO8I,
+                                  types::RowCol<size_t>(1, dims.col)));
+    swaths.addRows(bytes + 17 * rowBytes, six::PixelType::MONO16I,
+                   types::RowCol<size_t>(103, dims.col));
+    TEST_ASSERT_EQ(swaths.getNumPixelsAdded(),
+                   static_cast<sys::Uint64_T>(dims.area()));
+    swaths.finishStatistics();
+    TEST_ASSERT_EQ(swaths.getNumPixelsAdded(), static_cast<sys::Uint64_T>(0));
+
+    TEST_ASSERT_EQ(swaths.getStatistics().minValue,
+                   whole.getStatistics().minValue);
+    TEST_ASSERT_EQ(swaths.getStatistics().maxValue,
+                   whole.getStatistics().maxValue);
+    TEST_ASSERT_EQ(swaths.getStatistics().pMinValue,
+                   whole.getStatistics().pMinValue);
+    TEST_ASSERT_EQ(swaths.getStatistics().pMaxValue,
+                   whole.getStatistics().pMaxValue);
+    TEST_ASSERT_EQ(swaths.getRemap().subtractor,
+                   whole.getRemap().subtractor);
+    TEST_ASSERT_EQ(swaths.getRemap().multiplier,
+                   whole.getRemap().multiplier);
+}
+
+TEST_CASE(testAddComplexRows)
+{
+    // Amplitudes grow down the image, so the bins have to widen as each
+    // swath is added
+    const types::RowCol<size_t> dims(64, 50);
+    std::vector<std::complex<float> > image(dims.area());
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        const float amplitude = 0.001f * ii * ii;
+        image[ii] = std::complex<float>(amplitude * 0.6f, -amplitude * 0.8f);
+    }
+
+    const six::sidd::DynamicRangeAdjustment dra =
+            makeAuto(0.1, 0.9, 0.25, 0.25);
+    six::sidd::DynamicRangeAdjuster whole(dra, 3);
+    whole.computeStatistics(&image[0], dims);
+
+    six::sidd::DynamicRangeAdjuster swaths(dra, 3);
+    for (size_t row = 0; row < dims.row; row += 5)
+    {
+        const size_t numRows = std::min<size_t>(5, dims.row - row);
+        swaths.addRows(&image[row * dims.col],
+                       types::RowCol<size_t>(numRows, dims.col));
+    }
+    TEST_EXCEPTION(swaths.addRows(reinterpret_cast<const six::UByte*>(
+                                          &image[0]),
+                                  six::PixelType::MONO8I,
+                                  types::RowCol<size_t>(1, dims.col)));
+    swaths.finishStatistics();
+
+    TEST_ASSERT_EQ(swaths.getStatistics().minValue,
+                   whole.getStatistics().minValue);
+    TEST_ASSERT_EQ(swaths.getStatistics().maxValue,
+                   whole.getStatistics().maxValue);
+    TEST_ASSERT_EQ(swaths.getStatistics().pMinValue,
+                   whole.getStatistics().pMinValue);
+    TEST_ASSERT_EQ(swaths.getStatistics().pMaxValue,
+                   whole.getStatistics().pMaxValue);
+    TEST_ASSERT_EQ(swaths.getRemap().subtractor,
+                   whole.getRemap().subtractor);
+    TEST_ASSERT_EQ(swaths.getRemap().multiplier,
+                   whole.getRemap().multiplier);
+
+    // Once finished, a different kind of image may be added
+    const std::vector<six::UByte> ramp = makeRamp();
+    swaths.addRows(&ramp[0], six::PixelType::MONO8I,
+                   types::RowCol<size_t>(100, 100));
+    swaths.finishStatistics();
+    TEST_ASSERT_EQ(swaths.getStatistics().maxValue, 99.0);
+}
+
+TEST_CASE(testManualAndNone)
+{
+    const types::RowCol<size_t> dims(100, 100);
+    const std::vector<six::UByte> image = makeRamp();
+    std::vector<six::UByte> output(image.size());
+
+    six::sidd::DynamicRangeAdjustment dra;
+    TEST_EXCEPTION(six::sidd::DynamicRangeAdjuster(dra, 1));
+
+    dra.algorithmType = six::sidd::DRAType::MANUAL;
+    TEST_EXCEPTION(six::sidd::DynamicRangeAdjuster(dra, 1));
+    dra.draOverrides.reset(
+            new six::sidd::DynamicRangeAdjustment::DRAOverrides());
+    dra.draOverrides->subtractor = 10.0;
+    dra.draOverrides->multiplier = 2.0;
+    six::sidd::DynamicRangeAdjuster manual(dra);
+    TEST_ASSERT_FALSE(manual.needsStatistics());
+    manual.apply(&image[0], six::PixelType::MONO8I, dims, &output[0]);
+    TEST_ASSERT_EQ(static_cast<int>(output[5]), 0);
+    TEST_ASSERT_EQ(static_cast<int>(output[50]), 80);
+
+    dra.algorithmType = six::sidd::DRAType::NONE;
+    six::sidd::DynamicRangeAdjuster none(dra);
+    none.apply(&image[0], six::PixelType::MONO8I, dims, &output[0]);
+    TEST_ASSERT_TRUE(output == image);
+
+    six::sidd::DynamicRangeAdjustment badAuto = makeAuto(0.9, 0.1, 0.0, 0.0);
+    TEST_EXCEPTION(six::sidd::DynamicRangeAdjuster(badAuto, 1));
+    badAuto.draParameters.reset();
+    TEST_EXCEPTION(six::sidd::DynamicRangeAdjuster(badAuto, 1));
+}
+
+TEST_CASE(testAdjustDerivedData)
+{
+    std::auto_ptr<six::sidd::DerivedData> data =
+            six::sidd::Utilities::createFakeDerivedData();
+    data->setPixelType(six::PixelType::MONO8I);
+    data->setNumRows(100);
+    data->setNumCols(100);
+    const std::vector<six::UByte> image = makeRamp();
+    std::vector<six::UByte> output(image.size());
+
+    TEST_EXCEPTION(six::sidd::DynamicRangeAdjuster::adjust(
+            *data, &image[0], &output[0]));
+
+    data->display->interactiveProcessing.resize(1);
+    data->display->interactiveProcessing[0].reset(
+            new six::sidd::InteractiveProcessing());
+    data->display->interactiveProcessing[0]->dynamicRangeAdjustment =
+            makeAuto(0.1, 0.9, 0.0, 0.0);
+    six::sidd::DynamicRangeAdjuster::adjust(*data, &image[0], &output[0]);
+
+    const six::sidd::DynamicRangeAdjustment& dra =
+            data->display->interactiveProcessing[0]->dynamicRangeAdjustment;
+    TEST_ASSERT_TRUE(dra.draOverrides.get() != NULL);
+    TEST_ASSERT_EQ(dra.draOverrides->subtractor, 9.0);
+    TEST_ASSERT_EQ(static_cast<int>(output[49]), 128);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testAuto);
+    TEST_CHECK(testModifiers);
+    TEST_CHECK(testStatsBand);
+    TEST_CHECK(testThreadsAgree);
+    TEST_CHECK(testComplex);
+    TEST_CHECK(testAddRows);
+    TEST_CHECK(testAddComplexRows);
+    TEST_CHECK(testManualAndNone);
+    TEST_CHECK(testAdjustDerivedData);
+    return 0;
+}
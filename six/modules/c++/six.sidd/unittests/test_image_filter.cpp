@@ -0,0 +1,255 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <import/six/sidd.h>
+#include <sys/Conf.h>
+#include "TestCase.h"
+#include "../tests/TestUtilities.h"
+
+namespace
+{
+std::vector<float> makeImage(const types::RowCol<size_t>& dims)
+{
+    std::vector<float> image(dims.area());
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = static_cast<float>((ii * 7919) % 1000) / 10.0f;
+    }
+    return image;
+}
+
+// Straightforward correlation, repeating the edges
+std::vector<float> correlate(const std::vector<float>& image,
+                             const types::RowCol<size_t>& dims,
+                             size_t numRows,
+                             size_t numCols,
+                             const std::vector<double>& coefs)
+{
+    std::vector<float> output(image.size());
+    const ptrdiff_t centerRow = static_cast<ptrdiff_t>((numRows - 1) / 2);
+    const ptrdiff_t centerCol = static_cast<ptrdiff_t>((numCols - 1) / 2);
+    for (size_t row = 0; row < dims.row; ++row)
+    {
+        for (size_t col = 0; col < dims.col; ++col)
+        {
+            double sum = 0;
+            for (size_t kk = 0; kk < numRows; ++kk)
+            {
+                for (size_t ll = 0; ll < numCols; ++ll)
+                {
+                    const ptrdiff_t inRow = std::min<ptrdiff_t>(
+                            std::max<ptrdiff_t>(row + kk - centerRow, 0),
+                            dims.row - 1);
+                    const ptrdiff_t inCol = std::min<ptrdiff_t>(
+                            std::max<ptrdiff_t>(col + ll - centerCol, 0),
+                            dims.col - 1);
+                    sum += coefs[kk * numCols + ll] *
+                            image[inRow * dims.col + inCol];
+                }
+            }
+            output[row * dims.col + col] = static_cast<float>(sum);
+        }
+    }
+    return output;
+}
+
+float maxDifference(const std::vector<float>& lhs,
+                    const std::vector<float>& rhs)
+{
+    float maxDiff = 0;
+    for (size_t ii = 0; ii < lhs.size(); ++ii)
+    {
+        maxDiff = std::max(maxDiff, std::abs(lhs[ii] - rhs[ii]));
+    }
+    return maxDiff;
+}
+
+TEST_CASE(testSeparable)
+{
+    // Outer product of two different 1D kernels
+    const double rowCoefs[] = {0.1, 0.2, 0.4, 0.2, 0.1};
+    const double colCoefs[] = {-1.0, 3.0, -1.0};
+    std::vector<double> coefs;
+    for (size_t kk = 0; kk < 3; ++kk)
+    {
+        for (size_t ll = 0; ll < 5; ++ll)
+        {
+            coefs.push_back(colCoefs[kk] * rowCoefs[ll]);
+        }
+    }
+
+    const types::RowCol<size_t> dims(300, 280);
+    const std::vector<float> image = makeImage(dims);
+    const six::sidd::ImageFilter filter(makeKernel(3, 5, coefs), 3);
+    TEST_ASSERT_TRUE(filter.isSeparable());
+    TEST_ASSERT_FALSE(filter.usesFFT());
+
+    std::vector<float> output(image.size());
+    filter.apply(&image[0], dims, &output[0]);
+    TEST_ASSERT_LESSER(maxDifference(output,
+                                     correlate(image, dims, 3, 5, coefs)),
+                       1e-3f);
+}
+
+TEST_CASE(testDirectAndFFT)
+{
+    std::vector<double> coefs(13 * 13);
+    for (size_t ii = 0; ii < coefs.size(); ++ii)
+    {
+        coefs[ii] = static_cast<double>((ii * 31) % 17) / 100.0 - 0.08;
+    }
+
+    const types::RowCol<size_t> dims(300, 530);
+    const std::vector<float> image = makeImage(dims);
+    const std::vector<float> expected = correlate(image, dims, 13, 13, coefs);
+
+    // Both filters share one set of threads
+    six::ThreadPool threadPool(3);
+    const six::sidd::ImageFilter fftFilter(makeKernel(13, 13, coefs),
+                                           threadPool);
+    TEST_ASSERT_FALSE(fftFilter.isSeparable());
+    TEST_ASSERT_TRUE(fftFilter.usesFFT());
+    std::vector<float> output(image.size());
+    fftFilter.apply(&image[0], dims, &output[0]);
+    TEST_ASSERT_LESSER(maxDifference(output, expected), 1e-3f);
+
+    const six::sidd::ImageFilter directFilter(
+            makeKernel(13, 13, coefs), threadPool,
+            six::sidd::ImageFilter::DIRECT);
+    TEST_ASSERT_FALSE(directFilter.usesFFT());
+    directFilter.apply(&image[0], dims, &output[0]);
+    TEST_ASSERT_LESSER(maxDifference(output, expected), 1e-3f);
+}
+
+TEST_CASE(testConvolution)
+{
+    // Correlation shifts the image left, and convolution shifts it right
+    const types::RowCol<size_t> dims(2, 4);
+    const float image[] = {1, 2, 3, 4, 5, 6, 7, 8};
+    std::vector<double> coefs(3, 0.0);
+    coefs[2] = 1.0;
+    std::vector<float> output(dims.area());
+
+    const six::sidd::ImageFilter correlation(makeKernel(1, 3, coefs));
+    correlation.apply(image, dims, &output[0]);
+    TEST_ASSERT_EQ(output[0], 2.0f);
+    TEST_ASSERT_EQ(output[3], 4.0f);
+
+    const six::sidd::ImageFilter convolution(makeKernel(
+            1, 3, coefs, six::sidd::FilterOperation::CONVOLUTION));
+    convolution.apply(image, dims, &output[0]);
+    TEST_ASSERT_EQ(output[0], 1.0f);
+    TEST_ASSERT_EQ(output[3], 3.0f);
+}
+
+TEST_CASE(testPixelTypes)
+{
+    const types::RowCol<size_t> dims(20, 30);
+    std::vector<six::UByte> rgb(dims.area() * 3);
+    for (size_t ii = 0; ii < rgb.size(); ++ii)
+    {
+        rgb[ii] = static_cast<six::UByte>(ii * 13);
+    }
+
+    // Identity, applied to every band
+    std::vector<double> identity(9, 0.0);
+    identity[4] = 1.0;
+    const six::sidd::ImageFilter filter(makeKernel(3, 3, identity));
+    std::vector<six::UByte> output(rgb.size());
+    filter.apply(&rgb[0], six::PixelType::RGB24I, dims, &output[0]);
+    TEST_ASSERT_TRUE(output == rgb);
+
+    // Doubling clamps
+    const six::sidd::ImageFilter doubler(
+            makeKernel(1, 1, std::vector<double>(1, 2.0)));
+    std::vector<sys::Uint16_T> mono(dims.area(), 1000);
+    mono[0] = 40000;
+    std::vector<sys::Uint16_T> monoOutput(mono.size());
+    doubler.apply(reinterpret_cast<const six::UByte*>(&mono[0]),
+                  six::PixelType::MONO16I, dims,
+                  reinterpret_cast<six::UByte*>(&monoOutput[0]));
+    TEST_ASSERT_EQ(monoOutput[0], 65535);
+    TEST_ASSERT_EQ(monoOutput[1], 2000);
+
+    TEST_EXCEPTION(filter.apply(&rgb[0], six::PixelType::MONO8LU, dims,
+                                &output[0]));
+}
+
+TEST_CASE(testResample)
+{
+    // Bilinear halving averages pairs of pixels
+    const types::RowCol<size_t> inDims(40, 600);
+    std::vector<float> ramp(inDims.area());
+    for (size_t ii = 0; ii < ramp.size(); ++ii)
+    {
+        ramp[ii] = static_cast<float>(ii % inDims.col);
+    }
+    const six::sidd::ImageFilter bilinear(
+            makeBank(six::sidd::FilterDatabaseName::BILINEAR), 3);
+    TEST_ASSERT_TRUE(bilinear.isBank());
+    const types::RowCol<size_t> halfDims(20, 300);
+    std::vector<float> half(halfDims.area());
+    bilinear.resample(&ramp[0], inDims, halfDims, &half[0]);
+    TEST_ASSERT_ALMOST_EQ(half[0], 0.5f);
+    TEST_ASSERT_ALMOST_EQ(half[10], 20.5f);
+    TEST_ASSERT_ALMOST_EQ(half[halfDims.area() - 1], 598.5f);
+
+    // Interpolators preserve constant images
+    const six::sidd::ImageFilter cubic(
+            makeBank(six::sidd::FilterDatabaseName::CUBIC));
+    const std::vector<six::UByte> gray(10 * 10, 100);
+    std::vector<six::UByte> grayOutput(17 * 23);
+    cubic.resample(&gray[0], six::PixelType::MONO8I,
+                   types::RowCol<size_t>(10, 10),
+                   types::RowCol<size_t>(17, 23), &grayOutput[0]);
+    TEST_ASSERT_EQ(*std::min_element(grayOutput.begin(), grayOutput.end()),
+                   100);
+    TEST_ASSERT_EQ(*std::max_element(grayOutput.begin(), grayOutput.end()),
+                   100);
+
+    // Banks only resample, and kernels only filter
+    TEST_EXCEPTION(bilinear.apply(&ramp[0], inDims, &ramp[0]));
+    const six::sidd::ImageFilter kernel(
+            makeKernel(1, 1, std::vector<double>(1, 1.0)));
+    TEST_EXCEPTION(kernel.resample(&ramp[0], inDims, halfDims, &half[0]));
+
+    six::sidd::Filter family =
+            makeBank(six::sidd::FilterDatabaseName::NOT_SET);
+    family.filterBank->predefined->filterFamily = 1;
+    family.filterBank->predefined->filterMember = 2;
+    TEST_EXCEPTION(six::sidd::ImageFilter(family, 1));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testSeparable);
+    TEST_CHECK(testDirectAndFFT);
+    TEST_CHECK(testConvolution);
+    TEST_CHECK(testPixelTypes);
+    TEST_CHECK(testResample);
+    return 0;
+}
@@ -0,0 +1,335 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <import/six/sidd.h>
+#include <io/FileOutputStream.h>
+#include <io/TempFile.h>
+#include <nitf/IOHandle.hpp>
+#include <nitf/NITFBufferList.hpp>
+#include <nitf/NITFException.hpp>
+#include <nitf/Reader.hpp>
+#include <six/sidd/J2KCompressor.h>
+#include <j2k/j2k_config.h>
+#include <import/j2k.h>
+#include "TestCase.h"
+
+namespace
+{
+struct Product
+{
+    Product(six::PixelType pixelType, size_t numRows, size_t numCols) :
+        data(six::sidd::Utilities::createFakeDerivedData())
+    {
+        data->setPixelType(pixelType);
+        data->setNumRows(numRows);
+        data->setNumCols(numCols);
+
+        // Smooth enough to compress
+        const size_t numSamples = data->getNumBytesPerPixel();
+        pixels.resize(numRows * numCols * numSamples);
+        for (size_t row = 0, ii = 0; row < numRows; ++row)
+        {
+            for (size_t col = 0; col < numCols * numSamples; ++col, ++ii)
+            {
+                pixels[ii] = static_cast<six::UByte>((row + col / 4) & 0xFF);
+            }
+        }
+    }
+
+    std::auto_ptr<six::sidd::DerivedData> data;
+    std::vector<six::UByte> pixels;
+};
+
+six::Options makeOptions(double byterate, bool isNumericallyLossless)
+{
+    six::Options options;
+    options.setParameter(six::NITFHeaderCreator::OPT_J2K_COMPRESSION_BYTERATE,
+                         six::Parameter(byterate));
+    options.setParameter(six::NITFHeaderCreator::OPT_J2K_COMPRESSION_LOSSLESS,
+                         six::Parameter(isNumericallyLossless));
+    options.setParameter(six::NITFHeaderCreator::OPT_NUM_ROWS_PER_BLOCK,
+                         six::Parameter(64));
+    options.setParameter(six::NITFHeaderCreator::OPT_NUM_COLS_PER_BLOCK,
+                         six::Parameter(64));
+    options.setParameter(six::NITFWriteControl::OPT_NUM_WRITE_THREADS,
+                         six::Parameter(3));
+    return options;
+}
+
+#ifdef HAVE_OPENJPEG_H
+// Decodes an image segment's codestream a block at a time, checking that
+// each NITF block is its own tile, into row-major 8-bit pixels
+std::vector<six::UByte> decodeSegment(nitf::IOHandle& handle,
+                                      nitf::ImageSegment& segment)
+{
+    nitf::ImageSubheader subheader = segment.getSubheader();
+    const size_t numRows = static_cast<nitf::Uint32>(subheader.getNumRows());
+    const size_t numCols = static_cast<nitf::Uint32>(subheader.getNumCols());
+    const size_t numBlocksPerRow =
+            static_cast<nitf::Uint32>(subheader.getNumBlocksPerRow());
+    const size_t numBlocksPerCol =
+            static_cast<nitf::Uint32>(subheader.getNumBlocksPerCol());
+    const size_t numRowsPerBlock =
+            static_cast<nitf::Uint32>(subheader.getNumPixelsPerVertBlock());
+    const size_t numColsPerBlock =
+            static_cast<nitf::Uint32>(subheader.getNumPixelsPerHorizBlock());
+
+    handle.seek(segment.getImageOffset(), NITF_SEEK_SET);
+    nrt_Error error;
+    j2k_Reader* reader = j2k_Reader_openIO(handle.getNative(), &error);
+    if (!reader)
+    {
+        throw nitf::NITFException(&error);
+    }
+
+    j2k_Container* const container = j2k_Reader_getContainer(reader, &error);
+    if (j2k_Container_getTilesX(container, &error) != numBlocksPerRow ||
+        j2k_Container_getTilesY(container, &error) != numBlocksPerCol ||
+        j2k_Container_getTileWidth(container, &error) != numColsPerBlock ||
+        j2k_Container_getTileHeight(container, &error) != numRowsPerBlock)
+    {
+        j2k_Reader_destruct(&reader);
+        throw except::Exception(Ctxt("J2K tiles don't match the NITF blocks"));
+    }
+
+    // Each block is read on its own so that it only decodes its own tile
+    std::vector<six::UByte> pixels(numRows * numCols);
+    for (size_t blockRow = 0; blockRow < numBlocksPerCol; ++blockRow)
+    {
+        const size_t startRow = blockRow * numRowsPerBlock;
+        const size_t numValidRows =
+                std::min(numRowsPerBlock, numRows - startRow);
+        for (size_t blockCol = 0; blockCol < numBlocksPerRow; ++blockCol)
+        {
+            const size_t startCol = blockCol * numColsPerBlock;
+            const size_t numValidCols =
+                    std::min(numColsPerBlock, numCols - startCol);
+
+            nrt_Uint8* block = NULL;
+            if (j2k_Reader_readRegion(
+                        reader,
+                        static_cast<nrt_Uint32>(startCol),
+                        static_cast<nrt_Uint32>(startRow),
+                        static_cast<nrt_Uint32>(startCol + numValidCols),
+                        static_cast<nrt_Uint32>(startRow + numValidRows),
+                        &block,
+                        &error) == 0)
+            {
+                j2k_Reader_destruct(&reader);
+                throw nitf::NITFException(&error);
+            }
+
+            for (size_t row = 0; row < numValidRows; ++row)
+            {
+                std::copy(block + row * numValidCols,
+                          block + (row + 1) * numValidCols,
+                          &pixels[(startRow + row) * numCols + startCol]);
+            }
+            J2K_FREE(block);
+        }
+    }
+
+    j2k_Reader_destruct(&reader);
+    return pixels;
+}
+#endif
+
+size_t sum(const std::vector<size_t>& values)
+{
+    size_t total = 0;
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        total += values[ii];
+    }
+    return total;
+}
+
+TEST_CASE(testUnavailable)
+{
+    if (six::sidd::J2KCompressor::isAvailable())
+    {
+        return;
+    }
+
+    const Product product(six::PixelType::MONO8I, 100, 100);
+    TEST_EXCEPTION(six::sidd::J2KCompressor(*product.data,
+                                            makeOptions(0.5, false)));
+}
+
+TEST_CASE(testInvalidOptions)
+{
+    if (!six::sidd::J2KCompressor::isAvailable())
+    {
+        return;
+    }
+
+    const Product product(six::PixelType::MONO8I, 100, 100);
+    TEST_EXCEPTION(six::sidd::J2KCompressor(*product.data,
+                                            makeOptions(0, false)));
+    TEST_EXCEPTION(six::sidd::J2KCompressor(*product.data,
+                                            makeOptions(1.5, false)));
+
+    // No rate is needed to be lossless
+    six::sidd::J2KCompressor compressor(*product.data, makeOptions(0, true));
+    TEST_EXCEPTION(compressor.createByteProvider(std::vector<std::string>()));
+}
+
+TEST_CASE(testWriteNITF)
+{
+    if (!six::sidd::J2KCompressor::isAvailable())
+    {
+        return;
+    }
+
+    // Two image segments of 80 and 70 rows, each 2 x 3 blocks
+    const Product product(six::PixelType::MONO8I, 150, 130);
+    six::Options options = makeOptions(0, true);
+    options.setParameter(six::NITFHeaderCreator::OPT_MAX_PRODUCT_SIZE,
+                         six::Parameter(80 * 130));
+
+    six::sidd::J2KCompressor compressor(*product.data, options);
+    compressor.compress(&product.pixels[0]);
+    TEST_ASSERT_TRUE(compressor.isNumericallyLossless());
+
+    const std::vector<std::vector<size_t> >& bytesPerBlock =
+            compressor.getBytesPerBlock();
+    TEST_ASSERT_EQ(bytesPerBlock.size(), static_cast<size_t>(2));
+    size_t numCompressedBytes = 0;
+    for (size_t ii = 0; ii < bytesPerBlock.size(); ++ii)
+    {
+        TEST_ASSERT_EQ(bytesPerBlock[ii].size(), static_cast<size_t>(6));
+        for (size_t jj = 0; jj < bytesPerBlock[ii].size(); ++jj)
+        {
+            TEST_ASSERT_GREATER(bytesPerBlock[ii][jj], static_cast<size_t>(0));
+        }
+        numCompressedBytes += sum(bytesPerBlock[ii]);
+    }
+    TEST_ASSERT_EQ(compressor.getCompressedData().size(), numCompressedBytes);
+    TEST_ASSERT_LESSER(numCompressedBytes, product.pixels.size());
+
+    const std::auto_ptr<six::sidd::CompressedSIDDByteProvider> byteProvider =
+            compressor.createByteProvider(std::vector<std::string>());
+    nitf::Off fileOffset;
+    nitf::NITFBufferList buffers;
+    byteProvider->getBytes(&compressor.getCompressedData()[0],
+                           0,
+                           product.data->getNumRows(),
+                           fileOffset,
+                           buffers);
+    TEST_ASSERT_EQ(fileOffset, static_cast<nitf::Off>(0));
+    TEST_ASSERT_EQ(static_cast<nitf::Off>(buffers.getTotalNumBytes()),
+                   byteProvider->getNumBytes(0, product.data->getNumRows()));
+
+    io::TempFile file;
+    {
+        io::FileOutputStream outStream(file.pathname());
+        for (size_t ii = 0; ii < buffers.mBuffers.size(); ++ii)
+        {
+            outStream.write(
+                    static_cast<const sys::byte*>(buffers.mBuffers[ii].mData),
+                    buffers.mBuffers[ii].mNumBytes);
+        }
+    }
+
+    nitf::IOHandle handle(file.pathname(),
+                          NITF_ACCESS_READONLY,
+                          NITF_OPEN_EXISTING);
+    nitf::Reader reader;
+    nitf::Record record = reader.read(handle);
+    TEST_ASSERT_EQ(record.getNumImages(), static_cast<nitf::Uint32>(2));
+    for (nitf::Uint32 ii = 0; ii < record.getNumImages(); ++ii)
+    {
+        nitf::ImageSegment segment = record.getImages()[ii];
+        TEST_ASSERT_EQ(segment.getSubheader().getImageCompression().toString(),
+                       std::string("C8"));
+        TEST_ASSERT_EQ(segment.getImageEnd() - segment.getImageOffset(),
+                       static_cast<nitf::Uint64>(sum(bytesPerBlock[ii])));
+
+#ifdef HAVE_OPENJPEG_H
+        // Lossless, so every pixel has to come back
+        const std::vector<six::UByte> pixels = decodeSegment(handle, segment);
+        const size_t firstRow = ii * 80;
+        TEST_ASSERT_EQ(pixels.size(),
+                       std::min<size_t>(80, 150 - firstRow) * 130);
+        TEST_ASSERT_TRUE(std::equal(pixels.begin(),
+                                    pixels.end(),
+                                    product.pixels.begin() +
+                                            firstRow * 130));
+#endif
+    }
+}
+
+TEST_CASE(testSharedThreadPool)
+{
+    if (!six::sidd::J2KCompressor::isAvailable())
+    {
+        return;
+    }
+
+    const Product product(six::PixelType::MONO8I, 150, 130);
+    const six::Options options = makeOptions(0.5, false);
+    six::sidd::J2KCompressor ownThreads(*product.data, options);
+    ownThreads.compress(&product.pixels[0]);
+
+    six::ThreadPool threadPool(2);
+    six::sidd::J2KCompressor sharedThreads(*product.data, options);
+    sharedThreads.compress(&product.pixels[0], threadPool);
+    TEST_ASSERT_TRUE(sharedThreads.getBytesPerBlock() ==
+                     ownThreads.getBytesPerBlock());
+    TEST_ASSERT_TRUE(sharedThreads.getCompressedData() ==
+                     ownThreads.getCompressedData());
+}
+
+TEST_CASE(testByterate)
+{
+    if (!six::sidd::J2KCompressor::isAvailable())
+    {
+        return;
+    }
+
+    const Product product(six::PixelType::RGB24I, 100, 150);
+    six::sidd::J2KCompressor lossless(*product.data, makeOptions(0, true));
+    lossless.compress(&product.pixels[0]);
+
+    six::sidd::J2KCompressor lossy(*product.data, makeOptions(0.05, false));
+    lossy.compress(&product.pixels[0]);
+    TEST_ASSERT_FALSE(lossy.isNumericallyLossless());
+
+    TEST_ASSERT_EQ(lossy.getBytesPerBlock()[0].size(),
+                   lossless.getBytesPerBlock()[0].size());
+    TEST_ASSERT_LESSER(lossy.getCompressedData().size(),
+                       lossless.getCompressedData().size());
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testUnavailable);
+    TEST_CHECK(testInvalidOptions);
+    TEST_CHECK(testWriteNITF);
+    TEST_CHECK(testSharedThreadPool);
+    TEST_CHECK(testByterate);
+    return 0;
+}
@@ -0,0 +1,383 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <import/six/sidd.h>
+#include <io/TempFile.h>
+#include <sys/Conf.h>
+#include <six/sidd/SIDDWriteControl.h>
+#include "TestCase.h"
+#include "../tests/TestUtilities.h"
+
+namespace
+{
+// Keeps every level in memory
+class MemorySink : public six::sidd::RRDSBuilder::Sink
+{
+public:
+    MemorySink(const types::RowCol<size_t>& dims,
+               size_t numBytesPerPixel,
+               size_t numLevels) :
+        mDims(dims),
+        mNumBytesPerPixel(numBytesPerPixel),
+        levels(numLevels),
+        nextRows(numLevels, 0)
+    {
+        for (size_t ii = 0; ii < numLevels; ++ii)
+        {
+            levels[ii].resize(six::sidd::RRDSBuilder::getLevelDims(
+                    dims, ii + 1).area() * numBytesPerPixel);
+        }
+    }
+
+    virtual void writeRows(size_t level,
+                           size_t startRow,
+                           size_t numRows,
+                           const six::UByte* rows)
+    {
+        // Rows must come in order
+        if (startRow != nextRows.at(level - 1))
+        {
+            throw except::Exception(Ctxt("Rows are out of order"));
+        }
+        nextRows[level - 1] += numRows;
+
+        const size_t numBytesPerRow =
+                six::sidd::RRDSBuilder::getLevelDims(mDims, level).col *
+                mNumBytesPerPixel;
+        memcpy(&levels[level - 1].at(startRow * numBytesPerRow),
+               rows,
+               numRows * numBytesPerRow);
+    }
+
+private:
+    const types::RowCol<size_t> mDims;
+    const size_t mNumBytesPerPixel;
+
+public:
+    std::vector<std::vector<six::UByte> > levels;
+    std::vector<size_t> nextRows;
+};
+
+// The anti-aliasing kernel
+six::sidd::Filter makeAntiAlias()
+{
+    const double coefs[] = {0.05, 0.1, 0.05,
+                            0.15, 0.3, 0.15,
+                            0.1, 0.05, 0.05};
+    return makeKernel(3, 3, std::vector<double>(coefs, coefs + 9));
+}
+
+six::sidd::RRDS makeRRDS(six::sidd::DownsamplingMethod method,
+                         bool antiAlias = false,
+                         bool interpolation = false)
+{
+    six::sidd::RRDS rrds;
+    rrds.downsamplingMethod = method;
+    if (antiAlias)
+    {
+        rrds.antiAlias.reset(new six::sidd::Filter(makeAntiAlias()));
+    }
+    if (interpolation)
+    {
+        rrds.interpolation.reset(new six::sidd::Filter(
+                makeBank(six::sidd::FilterDatabaseName::LAGRANGE)));
+    }
+    return rrds;
+}
+
+std::vector<six::UByte> makeImage(size_t numBytes)
+{
+    std::vector<six::UByte> image(numBytes);
+    for (size_t ii = 0; ii < numBytes; ++ii)
+    {
+        image[ii] = static_cast<six::UByte>((ii * 37 + ii / 7) % 251);
+    }
+    return image;
+}
+
+// Builds every level, adding the rows a few at a time
+MemorySink build(const std::vector<six::UByte>& image,
+                 const types::RowCol<size_t>& dims,
+                 six::PixelType pixelType,
+                 size_t numBytesPerPixel,
+                 const six::sidd::RRDS& rrds,
+                 size_t numLevels,
+                 size_t numThreads,
+                 size_t numRowsPerStrip)
+{
+    MemorySink sink(dims, numBytesPerPixel, numLevels);
+    six::sidd::RRDSBuilder builder(dims, pixelType, rrds, numLevels, sink,
+                                   numThreads, numRowsPerStrip);
+    const size_t numBytesPerRow = dims.col * numBytesPerPixel;
+    for (size_t row = 0; row < dims.row; row += 5)
+    {
+        builder.addRows(&image[row * numBytesPerRow],
+                        std::min<size_t>(5, dims.row - row));
+    }
+    if (!builder.isComplete())
+    {
+        throw except::Exception(Ctxt("Builder isn't complete"));
+    }
+    return sink;
+}
+
+TEST_CASE(testDims)
+{
+    const types::RowCol<size_t> dims(1000, 301);
+    TEST_ASSERT_EQ(six::sidd::RRDSBuilder::getLevelDims(dims, 0).row,
+                   static_cast<size_t>(1000));
+    TEST_ASSERT_EQ(six::sidd::RRDSBuilder::getLevelDims(dims, 2).row,
+                   static_cast<size_t>(250));
+    TEST_ASSERT_EQ(six::sidd::RRDSBuilder::getLevelDims(dims, 2).col,
+                   static_cast<size_t>(76));
+    TEST_ASSERT_EQ(six::sidd::RRDSBuilder::getNumLevels(dims),
+                   static_cast<size_t>(2));
+    TEST_ASSERT_EQ(six::sidd::RRDSBuilder::getNumLevels(dims, 1),
+                   static_cast<size_t>(10));
+    TEST_ASSERT_EQ(six::sidd::RRDSBuilder::getNumLevels(dims, 1000),
+                   static_cast<size_t>(0));
+}
+
+TEST_CASE(testReduce)
+{
+    // Pixel (row, col) is row * 10 + col
+    const types::RowCol<size_t> dims(3, 5);
+    std::vector<six::UByte> image(dims.area());
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = static_cast<six::UByte>((ii / 5) * 10 + ii % 5);
+    }
+
+    const six::UByte decimated[] = {0, 2, 4, 20, 22, 24};
+    const MemorySink decimate = build(
+            image, dims, six::PixelType::MONO8I, 1,
+            makeRRDS(six::sidd::DownsamplingMethod::DECIMATE), 1, 1, 1);
+    TEST_ASSERT_TRUE(decimate.levels[0] ==
+                     std::vector<six::UByte>(decimated, decimated + 6));
+
+    const six::UByte maxed[] = {11, 13, 14, 21, 23, 24};
+    const MemorySink maxPixel = build(
+            image, dims, six::PixelType::MONO8I, 1,
+            makeRRDS(six::sidd::DownsamplingMethod::MAX_PIXEL), 1, 1, 1);
+    TEST_ASSERT_TRUE(maxPixel.levels[0] ==
+                     std::vector<six::UByte>(maxed, maxed + 6));
+
+    // Edge blocks repeat the last row and column
+    const six::UByte averaged[] = {6, 8, 9, 21, 23, 24};
+    const six::UByte averagedTwice[] = {15, 17};
+    const MemorySink average = build(
+            image, dims, six::PixelType::MONO8I, 1,
+            makeRRDS(six::sidd::DownsamplingMethod::AVERAGE), 2, 2, 1);
+    TEST_ASSERT_TRUE(average.levels[0] ==
+                     std::vector<six::UByte>(averaged, averaged + 6));
+    TEST_ASSERT_TRUE(average.levels[1] ==
+                     std::vector<six::UByte>(averagedTwice,
+                                             averagedTwice + 2));
+    TEST_ASSERT_EQ(average.nextRows[1], static_cast<size_t>(1));
+
+    // Without a bank, BILINEAR averages
+    const MemorySink bilinear = build(
+            image, dims, six::PixelType::MONO8I, 1,
+            makeRRDS(six::sidd::DownsamplingMethod::BILINEAR), 1, 1, 1);
+    TEST_ASSERT_TRUE(bilinear.levels[0] == average.levels[0]);
+}
+
+TEST_CASE(testMatchesWholeImage)
+{
+    // Filtering strips gives exactly the same levels as filtering the
+    // whole image at once
+    const types::RowCol<size_t> dims(22, 18);
+    const types::RowCol<size_t> levelDims(11, 9);
+    const std::vector<six::UByte> image = makeImage(dims.area());
+
+    const six::sidd::ImageFilter kernel(makeAntiAlias(), 1);
+    std::vector<six::UByte> filtered(image.size());
+    kernel.apply(&image[0], six::PixelType::MONO8I, dims, &filtered[0]);
+    std::vector<six::UByte> expected(levelDims.area());
+    for (size_t row = 0; row < levelDims.row; ++row)
+    {
+        for (size_t col = 0; col < levelDims.col; ++col)
+        {
+            const size_t ii = 2 * row * dims.col + 2 * col;
+            const size_t sum = filtered[ii] + filtered[ii + 1] +
+                    filtered[ii + dims.col] + filtered[ii + dims.col + 1];
+            expected[row * levelDims.col + col] =
+                    static_cast<six::UByte>((sum + 2) / 4);
+        }
+    }
+    const MemorySink average = build(
+            image, dims, six::PixelType::MONO8I, 1,
+            makeRRDS(six::sidd::DownsamplingMethod::AVERAGE, true), 1, 2, 3);
+    TEST_ASSERT_TRUE(average.levels[0] == expected);
+
+    const six::sidd::ImageFilter bank(
+            makeBank(six::sidd::FilterDatabaseName::LAGRANGE), 1);
+    bank.resample(&image[0], six::PixelType::MONO8I, dims, levelDims,
+                  &expected[0]);
+    const MemorySink lagrange = build(
+            image, dims, six::PixelType::MONO8I, 1,
+            makeRRDS(six::sidd::DownsamplingMethod::LAGRANGE, false, true),
+            1, 2, 2);
+    TEST_ASSERT_TRUE(lagrange.levels[0] == expected);
+}
+
+TEST_CASE(testStripsAgree)
+{
+    const types::RowCol<size_t> dims(37, 29);
+    const std::vector<six::UByte> rgb = makeImage(dims.area() * 3);
+    const six::sidd::RRDS rrds =
+            makeRRDS(six::sidd::DownsamplingMethod::LAGRANGE, true, true);
+    const MemorySink whole = build(rgb, dims, six::PixelType::RGB24I, 3,
+                                   rrds, 3, 1, 1000);
+    const MemorySink strips = build(rgb, dims, six::PixelType::RGB24I, 3,
+                                    rrds, 3, 3, 1);
+    TEST_ASSERT_TRUE(whole.levels == strips.levels);
+    TEST_ASSERT_EQ(strips.nextRows[2], static_cast<size_t>(5));
+
+    // The filters and the downsampling can share the caller's threads
+    six::ThreadPool threadPool(3);
+    MemorySink shared(dims, 3, 3);
+    six::sidd::RRDSBuilder builder(dims, six::PixelType::RGB24I, rrds, 3,
+                                   shared, threadPool, 4);
+    builder.addRows(&rgb[0], dims.row);
+    TEST_ASSERT_TRUE(builder.isComplete());
+    TEST_ASSERT_TRUE(whole.levels == shared.levels);
+
+    const std::vector<six::UByte> mono16 = makeImage(dims.area() * 2);
+    const six::sidd::RRDS maxPixel =
+            makeRRDS(six::sidd::DownsamplingMethod::MAX_PIXEL);
+    const MemorySink wholeMax = build(mono16, dims, six::PixelType::MONO16I,
+                                      2, maxPixel, 4, 1, 1000);
+    const MemorySink stripsMax = build(mono16, dims, six::PixelType::MONO16I,
+                                       2, maxPixel, 4, 4, 2);
+    TEST_ASSERT_TRUE(wholeMax.levels == stripsMax.levels);
+}
+
+TEST_CASE(testBadInput)
+{
+    const types::RowCol<size_t> dims(8, 8);
+    MemorySink sink(dims, 1, 1);
+    TEST_EXCEPTION(six::sidd::RRDSBuilder(
+            dims, six::PixelType::RE32F_IM32F,
+            makeRRDS(six::sidd::DownsamplingMethod::DECIMATE), 1, sink));
+    TEST_EXCEPTION(six::sidd::RRDSBuilder(
+            dims, six::PixelType::MONO8I, six::sidd::RRDS(), 1, sink));
+    TEST_EXCEPTION(six::sidd::RRDSBuilder(
+            dims, six::PixelType::MONO8I,
+            makeRRDS(six::sidd::DownsamplingMethod::LAGRANGE), 1, sink));
+
+    six::sidd::RRDSBuilder builder(
+            dims, six::PixelType::MONO8I,
+            makeRRDS(six::sidd::DownsamplingMethod::DECIMATE), 1, sink);
+    const std::vector<six::UByte> image(9 * 8);
+    TEST_EXCEPTION(builder.addRows(&image[0], 9));
+    builder.addRows(&image[0], 8);
+    TEST_ASSERT_TRUE(builder.isComplete());
+}
+
+TEST_CASE(testSidecar)
+{
+    const types::RowCol<size_t> dims(70, 45);
+    std::auto_ptr<six::sidd::DerivedData> data(
+            six::sidd::Utilities::createFakeDerivedData());
+    data->setPixelType(six::PixelType::MONO16I);
+    data->setNumRows(dims.row);
+    data->setNumCols(dims.col);
+
+    // MONO16I pixels in native byte order
+    const std::vector<six::UByte> image = makeImage(dims.area() * 2);
+    six::XMLControlFactory::getInstance().addCreator(
+            six::DataType::DERIVED,
+            new six::XMLControlCreatorT<six::sidd::DerivedXMLControl>());
+    io::TempFile sidd;
+    {
+        six::sidd::SIDDWriteControl writer(sidd.pathname(),
+                                           std::vector<std::string>());
+        writer.initialize(*data);
+        writer.save(&image[0], types::RowCol<size_t>(0, 0), dims);
+        writer.close();
+    }
+
+    io::TempFile rrds;
+    TEST_ASSERT_EQ(six::sidd::writeRRDS(sidd.pathname(), rrds.pathname(),
+                                        std::vector<std::string>(),
+                                        0, 3, 2),
+                   static_cast<size_t>(3));
+
+    // The fake product has no RRDS metadata, so it's averaged
+    const MemorySink expected = build(
+            image, dims, six::PixelType::MONO16I, 2,
+            makeRRDS(six::sidd::DownsamplingMethod::AVERAGE), 3, 1, 1000);
+
+    const six::sidd::RRDSReader reader(rrds.pathname());
+    TEST_ASSERT_EQ(reader.getNumLevels(), static_cast<size_t>(3));
+    TEST_ASSERT_EQ(reader.getPixelType(), six::PixelType::MONO16I);
+    TEST_ASSERT_EQ(reader.getLevelDims(1).row, static_cast<size_t>(35));
+    TEST_ASSERT_EQ(reader.getLevelDims(3).col, static_cast<size_t>(6));
+    for (size_t level = 1; level <= 3; ++level)
+    {
+        const types::RowCol<size_t> levelDims = reader.getLevelDims(level);
+        std::vector<six::UByte> pixels(levelDims.area() * 2);
+        reader.readLevel(level, types::RowCol<size_t>(0, 0), levelDims,
+                         &pixels[0]);
+        TEST_ASSERT_TRUE(pixels == expected.levels[level - 1]);
+    }
+
+    const types::RowCol<size_t> offset(2, 3);
+    const types::RowCol<size_t> extent(5, 4);
+    std::vector<sys::Uint16_T> region(extent.area());
+    reader.readLevel(2, offset, extent,
+                     reinterpret_cast<six::UByte*>(&region[0]));
+    const sys::Uint16_T* const level2 =
+            reinterpret_cast<const sys::Uint16_T*>(&expected.levels[1][0]);
+    TEST_ASSERT_EQ(region[0], level2[2 * 12 + 3]);
+    TEST_ASSERT_EQ(region[19], level2[6 * 12 + 6]);
+    TEST_EXCEPTION(reader.readLevel(2, offset, types::RowCol<size_t>(17, 4),
+                                    reinterpret_cast<six::UByte*>(
+                                            &region[0])));
+    TEST_EXCEPTION(reader.readLevel(4, offset, extent,
+                                    reinterpret_cast<six::UByte*>(
+                                            &region[0])));
+
+    TEST_ASSERT_EQ(reader.getLevelForScale(1.0), static_cast<size_t>(0));
+    TEST_ASSERT_EQ(reader.getLevelForScale(0.6), static_cast<size_t>(0));
+    TEST_ASSERT_EQ(reader.getLevelForScale(0.5), static_cast<size_t>(1));
+    TEST_ASSERT_EQ(reader.getLevelForScale(0.3), static_cast<size_t>(1));
+    TEST_ASSERT_EQ(reader.getLevelForScale(0.25), static_cast<size_t>(2));
+    TEST_ASSERT_EQ(reader.getLevelForScale(0.01), static_cast<size_t>(3));
+    TEST_EXCEPTION(reader.getLevelForScale(0.0));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testDims);
+    TEST_CHECK(testReduce);
+    TEST_CHECK(testMatchesWholeImage);
+    TEST_CHECK(testStripsAgree);
+    TEST_CHECK(testBadInput);
+    TEST_CHECK(testSidecar);
+    return 0;
+}
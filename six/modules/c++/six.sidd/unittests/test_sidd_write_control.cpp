@@ -0,0 +1,313 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string>
+#include <vector>
+
+#include <import/six/sidd.h>
+#include <io/TempFile.h>
+#include <mt/Runnable1D.h>
+#include <sys/File.h>
+#include <six/sidd/SIDDWriteControl.h>
+#include "TestCase.h"
+
+namespace
+{
+std::vector<sys::byte> readFile(const std::string& pathname)
+{
+    sys::File file(pathname);
+    std::vector<sys::byte> contents(static_cast<size_t>(file.length()));
+    if (!contents.empty())
+    {
+        file.readInto(&contents[0], contents.size());
+    }
+    return contents;
+}
+
+struct Product
+{
+    Product(six::PixelType pixelType, size_t numRows, size_t numCols) :
+        data(six::sidd::Utilities::createFakeDerivedData().release())
+    {
+        data->setPixelType(pixelType);
+        data->setNumRows(numRows);
+        data->setNumCols(numCols);
+
+        pixels.resize(numRows * numCols * data->getNumBytesPerPixel());
+        for (size_t ii = 0; ii < pixels.size(); ++ii)
+        {
+            pixels[ii] = static_cast<six::UByte>(ii * 13 + numRows);
+        }
+    }
+
+    mem::SharedPtr<six::sidd::DerivedData> data;
+    std::vector<six::UByte> pixels;
+};
+
+// A MONO8I product with a legend, which spans two image segments, and a
+// single segment MONO16I product
+std::vector<Product> makeProducts()
+{
+    std::vector<Product> products;
+    products.push_back(Product(six::PixelType::MONO8I, 37, 45));
+    products.push_back(Product(six::PixelType::MONO16I, 20, 30));
+    return products;
+}
+
+mem::SharedPtr<six::Container>
+makeContainer(const std::vector<Product>& products)
+{
+    six::XMLControlFactory::getInstance().addCreator(
+            six::DataType::DERIVED,
+            new six::XMLControlCreatorT<six::sidd::DerivedXMLControl>());
+
+    mem::SharedPtr<six::Container> container(
+            new six::Container(six::DataType::DERIVED));
+    for (size_t ii = 0; ii < products.size(); ++ii)
+    {
+        std::auto_ptr<six::Data> data(products[ii].data->clone());
+        if (ii == 0)
+        {
+            std::auto_ptr<six::Legend> legend(new six::Legend());
+            legend->mType = six::PixelType::MONO8I;
+            legend->setDims(types::RowCol<size_t>(5, 9));
+            for (size_t jj = 0; jj < legend->mImage.size(); ++jj)
+            {
+                legend->mImage[jj] = static_cast<sys::ubyte>(jj + 1);
+            }
+            container->addData(data, legend);
+        }
+        else
+        {
+            container->addData(data);
+        }
+    }
+    return container;
+}
+
+six::Options makeOptions(size_t numRowsPerBlock, size_t numColsPerBlock)
+{
+    six::Options options;
+    options.setParameter(six::NITFHeaderCreator::OPT_MAX_PRODUCT_SIZE,
+                         six::Parameter(1920));
+    if (numRowsPerBlock != 0)
+    {
+        options.setParameter(six::NITFHeaderCreator::OPT_NUM_ROWS_PER_BLOCK,
+                             six::Parameter(numRowsPerBlock));
+        options.setParameter(six::NITFHeaderCreator::OPT_NUM_COLS_PER_BLOCK,
+                             six::Parameter(numColsPerBlock));
+    }
+    return options;
+}
+
+size_t gcd(size_t lhs, size_t rhs)
+{
+    while (rhs != 0)
+    {
+        const size_t remainder = lhs % rhs;
+        lhs = rhs;
+        rhs = remainder;
+    }
+    return lhs;
+}
+
+// Saves one tile of a product
+class SaveTile
+{
+public:
+    SaveTile(six::sidd::SIDDWriteControl& writer,
+             const std::vector<Product>& products,
+             const types::RowCol<size_t>& tileDims) :
+        mWriter(writer),
+        mProducts(products),
+        mTileDims(tileDims),
+        mStride(7)
+    {
+        // Visits every tile as long as the stride and number of tiles don't
+        // have any common factors
+        while (gcd(mStride, getNumTiles()) != 1)
+        {
+            ++mStride;
+        }
+    }
+
+    void operator()(size_t index) const
+    {
+        // Spread the tiles of both products out in a scrambled order
+        const size_t numTiles = getNumTiles();
+        size_t tileIndex = (index * mStride) % numTiles;
+        size_t imageNumber = 0;
+        while (tileIndex >= getNumTiles(imageNumber))
+        {
+            tileIndex -= getNumTiles(imageNumber);
+            ++imageNumber;
+        }
+
+        const Product& product(mProducts[imageNumber]);
+        const size_t numRows = product.data->getNumRows();
+        const size_t numCols = product.data->getNumCols();
+        const size_t numBytesPerPixel = product.data->getNumBytesPerPixel();
+        const size_t numTileCols = (numCols + mTileDims.col - 1) / mTileDims.col;
+
+        const types::RowCol<size_t> offset(
+                (tileIndex / numTileCols) * mTileDims.row,
+                (tileIndex % numTileCols) * mTileDims.col);
+        const types::RowCol<size_t> dims(
+                std::min(mTileDims.row, numRows - offset.row),
+                std::min(mTileDims.col, numCols - offset.col));
+
+        std::vector<six::UByte> tile(dims.area() * numBytesPerPixel);
+        for (size_t row = 0; row < dims.row; ++row)
+        {
+            std::copy(&product.pixels[((offset.row + row) * numCols +
+                                       offset.col) * numBytesPerPixel],
+                      &product.pixels[((offset.row + row) * numCols +
+                                       offset.col + dims.col) *
+                                      numBytesPerPixel],
+                      &tile[row * dims.col * numBytesPerPixel]);
+        }
+        mWriter.save(&tile[0], offset, dims, imageNumber);
+    }
+
+    size_t getNumTiles(size_t imageNumber) const
+    {
+        const six::Data& data(*mProducts[imageNumber].data);
+        return ((data.getNumRows() + mTileDims.row - 1) / mTileDims.row) *
+                ((data.getNumCols() + mTileDims.col - 1) / mTileDims.col);
+    }
+
+    size_t getNumTiles() const
+    {
+        size_t numTiles = 0;
+        for (size_t ii = 0; ii < mProducts.size(); ++ii)
+        {
+            numTiles += getNumTiles(ii);
+        }
+        return numTiles;
+    }
+
+private:
+    six::sidd::SIDDWriteControl& mWriter;
+    const std::vector<Product>& mProducts;
+    const types::RowCol<size_t> mTileDims;
+    size_t mStride;
+};
+
+// Whether writing in tiles gives exactly the same file as writing all at
+// once
+bool matchesNITFWriteControl(size_t numRowsPerBlock,
+                             size_t numColsPerBlock,
+                             const types::RowCol<size_t>& tileDims,
+                             size_t numThreads)
+{
+    const std::vector<Product> products = makeProducts();
+    const six::Options options = makeOptions(numRowsPerBlock,
+                                             numColsPerBlock);
+
+    io::TempFile expected;
+    std::vector<six::UByte*> buffers;
+    for (size_t ii = 0; ii < products.size(); ++ii)
+    {
+        buffers.push_back(const_cast<six::UByte*>(&products[ii].pixels[0]));
+    }
+    six::NITFWriteControl nitfWriter(options, makeContainer(products));
+    nitfWriter.save(buffers, expected.pathname());
+
+    io::TempFile actual;
+    six::sidd::SIDDWriteControl siddWriter(actual.pathname(),
+                                           std::vector<std::string>());
+    siddWriter.initialize(options, makeContainer(products));
+    const SaveTile saveTile(siddWriter, products, tileDims);
+    mt::run1D(saveTile.getNumTiles(), numThreads, saveTile);
+
+    const bool allWritten = (siddWriter.getNumPendingBytes() == 0);
+    siddWriter.close();
+
+    return allWritten &&
+            readFile(expected.pathname()) == readFile(actual.pathname());
+}
+
+TEST_CASE(testBlocked)
+{
+    TEST_ASSERT_TRUE(matchesNITFWriteControl(
+            16, 16, types::RowCol<size_t>(7, 11), 1));
+    TEST_ASSERT_TRUE(matchesNITFWriteControl(
+            16, 16, types::RowCol<size_t>(5, 6), 4));
+}
+
+TEST_CASE(testUnblocked)
+{
+    TEST_ASSERT_TRUE(matchesNITFWriteControl(
+            0, 0, types::RowCol<size_t>(7, 11), 1));
+    TEST_ASSERT_TRUE(matchesNITFWriteControl(
+            0, 0, types::RowCol<size_t>(4, 100), 3));
+}
+
+TEST_CASE(testPendingBlocks)
+{
+    const std::vector<Product> products = makeProducts();
+    io::TempFile file;
+    six::sidd::SIDDWriteControl writer(file.pathname(),
+                                       std::vector<std::string>());
+    writer.initialize(makeOptions(16, 16), makeContainer(products));
+
+    // Half of the first block
+    std::vector<six::UByte> tile(8 * 16);
+    writer.save(&tile[0], types::RowCol<size_t>(0, 0),
+                types::RowCol<size_t>(8, 16));
+    TEST_ASSERT_EQ(writer.getNumPendingBytes(), static_cast<size_t>(256));
+
+    // More pixels than are left in the block, or outside of the image
+    std::vector<six::UByte> bigTile(12 * 16);
+    TEST_EXCEPTION(writer.save(&bigTile[0], types::RowCol<size_t>(0, 0),
+                               types::RowCol<size_t>(12, 16)));
+    TEST_EXCEPTION(writer.save(&tile[0], types::RowCol<size_t>(30, 0),
+                               types::RowCol<size_t>(8, 16)));
+    TEST_EXCEPTION(writer.save(&tile[0], types::RowCol<size_t>(0, 0),
+                               types::RowCol<size_t>(8, 16), 2));
+
+    // The other half finishes it
+    writer.save(&tile[0], types::RowCol<size_t>(8, 0),
+                types::RowCol<size_t>(8, 16));
+    TEST_ASSERT_EQ(writer.getNumPendingBytes(), static_cast<size_t>(0));
+
+    // Partial blocks are written when closing
+    writer.save(&tile[0], types::RowCol<size_t>(0, 16),
+                types::RowCol<size_t>(8, 16));
+    TEST_ASSERT_EQ(writer.getNumPendingBytes(), static_cast<size_t>(256));
+    writer.close();
+    TEST_ASSERT_EQ(writer.getNumPendingBytes(), static_cast<size_t>(0));
+
+    six::NITFReadControl reader;
+    reader.load(file.pathname());
+    TEST_ASSERT_EQ(reader.getContainer()->getNumData(),
+                   static_cast<size_t>(2));
+    TEST_ASSERT_TRUE(reader.getContainer()->getLegend(0) != NULL);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testBlocked);
+    TEST_CHECK(testUnblocked);
+    TEST_CHECK(testPendingBlocks);
+    return 0;
+}
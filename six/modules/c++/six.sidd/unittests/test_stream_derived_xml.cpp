@@ -0,0 +1,162 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <import/six/sidd.h>
+#include "TestCase.h"
+
+namespace
+{
+// What the XML was before it was streamed
+std::string printDOM(const six::Data& data)
+{
+    six::sidd::DerivedXMLControl xmlControl;
+    const std::auto_ptr<xml::lite::Document> doc(
+            xmlControl.toXML(&data, std::vector<std::string>()));
+
+    std::string xml;
+    six::appendXML(*doc->getRootElement(), xml);
+    return xml;
+}
+
+std::string stream(const six::Data& data)
+{
+    six::sidd::DerivedXMLControl xmlControl;
+    std::string xml;
+    xmlControl.toXML(&data, std::vector<std::string>(), xml);
+    return xml;
+}
+
+std::auto_ptr<six::GeoInfo> createGeoInfo()
+{
+    std::auto_ptr<six::GeoInfo> geoInfo(new six::GeoInfo());
+    geoInfo->name = "Region";
+    geoInfo->geometryLatLon.push_back(six::LatLon(30.0, -93.0));
+    geoInfo->geometryLatLon.push_back(six::LatLon(30.5, -93.5));
+    geoInfo->geometryLatLon.push_back(six::LatLon(30.5, -93.0));
+    return geoInfo;
+}
+
+std::auto_ptr<six::sidd::LookupTable> createLUT(const std::string& name)
+{
+    std::auto_ptr<six::sidd::LookupTable> lut(new six::sidd::LookupTable());
+    lut->lutName = name;
+    lut->predefined.reset(new six::sidd::LookupTable::Predefined());
+    lut->predefined->databaseName = name;
+    return lut;
+}
+
+std::auto_ptr<six::sidd::DerivedData> createData(const std::string& version)
+{
+    std::auto_ptr<six::sidd::DerivedData> data =
+            six::sidd::Utilities::createFakeDerivedData();
+    data->setPixelType(six::PixelType::MONO8I);
+    data->setVersion(version);
+    data->geographicAndTarget->geoInfos.push_back(
+            mem::ScopedCopyablePtr<six::GeoInfo>(createGeoInfo().release()));
+
+    // What SIDD 2.0 has in place of GeographicAndTarget and the 1.0
+    // Display
+    data->geoData.reset(new six::GeoDataBase());
+    data->geoData->imageCorners =
+            data->geographicAndTarget->geographicCoverage->footprint;
+    data->geoData->geoInfos.push_back(
+            mem::ScopedCopyablePtr<six::GeoInfo>(createGeoInfo().release()));
+
+    data->measurement->validData.push_back(six::RowColInt(0, 0));
+    data->measurement->validData.push_back(six::RowColInt(0, 99));
+    data->measurement->validData.push_back(six::RowColInt(99, 99));
+
+    six::sidd::Product& product = data->exploitationFeatures->product[0];
+    product.ellipticity = 0.5;
+    product.polarization.resize(1);
+    product.polarization[0].txPolarizationProc = six::PolarizationSequenceType::V;
+    product.polarization[0].rcvPolarizationProc = six::PolarizationSequenceType::H;
+
+    data->display->numBands = 1;
+    data->display->nonInteractiveProcessing.push_back(
+            mem::ScopedCopyablePtr<six::sidd::NonInteractiveProcessing>(
+                    new six::sidd::NonInteractiveProcessing()));
+    six::sidd::ProductGenerationOptions& options =
+            data->display->nonInteractiveProcessing[0]->
+                    productGenerationOptions;
+    options.bandEqualization.reset(new six::sidd::BandEqualization());
+    options.bandEqualization->algorithm =
+            six::sidd::BandEqualizationAlgorithm::LUT_1D;
+    for (size_t ii = 0; ii < 2; ++ii)
+    {
+        options.bandEqualization->bandLUTs.push_back(
+                mem::ScopedCopyablePtr<six::sidd::LookupTable>(
+                        createLUT("Band" + str::toString(ii)).release()));
+    }
+    options.dataRemapping.reset(createLUT("Remap").release());
+    data->display->nonInteractiveProcessing[0]->rrds.downsamplingMethod =
+            six::sidd::DownsamplingMethod::DECIMATE;
+    return data;
+}
+
+TEST_CASE(testFakeData)
+{
+    const char* const versions[] = { "1.0.0", "2.0.0" };
+    for (size_t ii = 0; ii < sizeof(versions) / sizeof(versions[0]); ++ii)
+    {
+        const std::auto_ptr<six::sidd::DerivedData> data =
+                createData(versions[ii]);
+        const std::string expected = printDOM(*data);
+        TEST_ASSERT_EQ(stream(*data), expected);
+    }
+}
+
+TEST_CASE(testBandLUTs)
+{
+    // The index is added to each LUT once it's been written
+    const std::auto_ptr<six::sidd::DerivedData> data = createData("2.0.0");
+    const std::string xml = stream(*data);
+    TEST_ASSERT(xml.find("<BandLUT k=\"1\"><LUTName>Band0</LUTName>") !=
+            std::string::npos);
+    TEST_ASSERT(xml.find("<BandLUT k=\"2\"><LUTName>Band1</LUTName>") !=
+            std::string::npos);
+}
+
+TEST_CASE(testConversionFails)
+{
+    // SIDD 2.0 needs at least three vertices
+    const std::auto_ptr<six::sidd::DerivedData> data = createData("2.0.0");
+    data->measurement->validData.clear();
+
+    six::sidd::DerivedXMLControl xmlControl;
+    std::string xml("<?xml version=\"1.0\"?>");
+    TEST_EXCEPTION(xmlControl.toXML(data.get(), std::vector<std::string>(),
+                                    xml));
+    TEST_ASSERT_EQ(xml, "<?xml version=\"1.0\"?>");
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testFakeData);
+    TEST_CHECK(testBandLUTs);
+    TEST_CHECK(testConversionFails);
+    return 0;
+}
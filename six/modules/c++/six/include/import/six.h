@@ -26,12 +26,15 @@
 #include "six/CollectionInformation.h"
 #include "six/Container.h"
 #include "six/Data.h"
+#include "six/DoubleConversion.h"
 #include "six/Enums.h"
 #include "six/ErrorStatistics.h"
+#include "six/MappedImageView.h"
 #include "six/MatchInformation.h"
 #include "six/GeoDataBase.h"
 #include "six/GeoInfo.h"
 #include "six/Mesh.h"
+#include "six/NITFBlockCache.h"
 #include "six/NITFImageInfo.h"
 #include "six/NITFImageInputStream.h"
 #include "six/NITFSegmentInfo.h"
@@ -41,6 +44,7 @@
 #include "six/Init.h"
 #include "six/Types.h"
 #include "six/Utilities.h"
+#include "six/ValidatorCache.h"
 #include "six/Parameter.h"
 #include "six/Radiometric.h"
 #include "six/Region.h"
@@ -0,0 +1,107 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_DECIMATION_H__
+#define __SIX_DECIMATION_H__
+
+#include <complex>
+#include <stddef.h>
+
+#include <six/ThreadPool.h>
+#include <types/RowCol.h>
+
+namespace six
+{
+/*!
+ *  \class Decimation
+ *  \brief How to shrink complex pixels into a detected quicklook image
+ *
+ *  Each decimated pixel covers a block of factor.row by factor.col full
+ *  resolution pixels, starting at the top left of the region being read.
+ *  Blocks along the bottom and right edges may be smaller.  A decimated
+ *  pixel is the power (|z|^2) of:
+ *  - SKIP: the top left pixel of its block, so only every factor.row-th
+ *    row needs to be read
+ *  - MEAN_POWER: the mean of the block
+ *  - MAX_POWER: the brightest pixel of the block
+ */
+struct Decimation
+{
+    //! How each block of pixels is reduced
+    enum Method
+    {
+        SKIP,
+        MEAN_POWER,
+        MAX_POWER
+    };
+
+    /*!
+     *  \param factor Rows and columns of each block.  Both must be
+     *  positive.
+     *  \param method How each block is reduced
+     *
+     *  \throws except::Exception If either factor is 0
+     */
+    explicit Decimation(const types::RowCol<size_t>& factor =
+                                types::RowCol<size_t>(1, 1),
+                        Method method = SKIP);
+
+    /*!
+     *  \param dims Rows and columns of the full resolution region
+     *
+     *  \return Rows and columns of the decimated region
+     */
+    types::RowCol<size_t> getDecimatedDims(
+            const types::RowCol<size_t>& dims) const;
+
+    //! \return How many full resolution rows each decimated row uses
+    size_t getRowsPerOutputRow() const
+    {
+        return method == SKIP ? 1 : factor.row;
+    }
+
+    /*!
+     *  Reduce full resolution rows to decimated rows, across threads
+     *
+     *  \param input The rows that each decimated row uses, one after
+     *  another: getRowsPerOutputRow() rows each, except that the last
+     *  decimated row may use fewer
+     *  \param numInputRows Total number of rows in input
+     *  \param numCols Number of full resolution columns in each row
+     *  \param threadPool Threads to reduce the rows on
+     *  \param[out] output The decimated rows, each
+     *  getDecimatedDims().col pixels wide
+     */
+    void reduce(const std::complex<float>* input,
+                size_t numInputRows,
+                size_t numCols,
+                ThreadPool& threadPool,
+                float* output) const;
+
+    //! Rows and columns of each block
+    types::RowCol<size_t> factor;
+
+    //! How each block is reduced
+    Method method;
+};
+}
+
+#endif
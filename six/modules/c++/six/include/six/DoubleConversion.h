@@ -0,0 +1,97 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_DOUBLE_CONVERSION_H__
+#define __SIX_DOUBLE_CONVERSION_H__
+
+#include <string>
+
+namespace six
+{
+/*!
+ *  Format a double the way SICD/SIDD/CPHD XML expects it: scientific
+ *  notation with an uppercase 'E' and no '+' (e.g. "1.5E00", "-2.25E-03").
+ *
+ *  The mantissa has the fewest digits that still parse back to exactly the
+ *  same double, so "0.1" is written as "1E-01" rather than
+ *  "1.00000000000000006E-01".  Infinities and NaN are written as the
+ *  xs:double values "INF", "-INF" and "NaN".
+ *
+ *  Unlike going through a std::ostringstream, the output doesn't depend
+ *  on the C or C++ global locale.
+ *
+ *  \param value Value to format
+ *
+ *  \return Shortest round-trip representation of 'value'
+ */
+std::string formatDouble(double value);
+
+/*!
+ *  Same as formatDouble(), but only as many digits as it takes to get the
+ *  same float back.
+ *
+ *  \param value Value to format
+ *
+ *  \return Shortest round-trip representation of 'value'
+ */
+std::string formatFloat(float value);
+
+/*!
+ *  Parse a double out of [begin, end), in the style of std::from_chars().
+ *  Accepts an optional sign, digits with an optional '.', and an optional
+ *  exponent, plus "INF", "INFINITY" and "NaN" in any case.  The result is
+ *  correctly rounded and doesn't depend on the locale.  No whitespace is
+ *  skipped.
+ *
+ *  \param begin Start of the text
+ *  \param end One past the end of the text
+ *  \param[out] value The parsed value.  Only set if something was parsed.
+ *
+ *  \return One past the last character parsed, or 'begin' if the text
+ *  doesn't start with a number
+ */
+const char* scanDouble(const char* begin, const char* end, double& value);
+
+/*!
+ *  Parse a string that holds a double and nothing else, other than
+ *  leading or trailing whitespace.
+ *
+ *  \param s String to parse
+ *
+ *  \return Parsed value
+ *  \throw except::BadCastException if 's' isn't a valid double or is
+ *  outside its range
+ */
+double toDouble(const std::string& s);
+
+/*!
+ *  Same as toDouble(), but for a float.
+ *
+ *  \param s String to parse
+ *
+ *  \return Parsed value
+ *  \throw except::BadCastException if 's' isn't a valid float or is
+ *  outside its range
+ */
+float toFloat(const std::string& s);
+}
+
+#endif
@@ -0,0 +1,96 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_MAPPED_FILE_H__
+#define __SIX_MAPPED_FILE_H__
+
+#include <string>
+#include <stddef.h>
+
+#include <sys/Conf.h>
+
+namespace six
+{
+/*!
+ *  \class MappedFile
+ *  \brief Read-only memory mapping of a file
+ *
+ *  Maps a byte range of a file into memory so its contents can be
+ *  accessed in place without being read through a buffer.  Pages are
+ *  only loaded by the OS as they are touched.  The range does not need
+ *  to be page aligned.  The mapping is released on destruction, so any
+ *  pointer obtained from getData() must not outlive this object.
+ */
+class MappedFile
+{
+public:
+    /*!
+     *  Map an entire file
+     *
+     *  \param pathname The file to map
+     *
+     *  \throws except::Exception If the file cannot be opened or mapped
+     */
+    explicit MappedFile(const std::string& pathname);
+
+    /*!
+     *  Map a byte range of a file
+     *
+     *  \param pathname The file to map
+     *  \param offset Byte offset of the start of the range
+     *  \param size Number of bytes in the range
+     *
+     *  \throws except::Exception If the range extends past the end of the
+     *  file, or if the file cannot be opened or mapped
+     */
+    MappedFile(const std::string& pathname, sys::Off_T offset, size_t size);
+
+    //! Unmaps the file
+    ~MappedFile();
+
+    //! \return Pointer to the first byte of the mapped range
+    const sys::ubyte* getData() const
+    {
+        return mData;
+    }
+
+    //! \return Number of bytes in the mapped range
+    size_t getSize() const
+    {
+        return mSize;
+    }
+
+private:
+    // Noncopyable
+    MappedFile(const MappedFile& );
+    const MappedFile& operator=(const MappedFile& );
+
+    void map(const std::string& pathname, sys::Off_T offset, size_t size);
+
+private:
+    void* mBase;
+    size_t mMappedSize;
+    const sys::ubyte* mData;
+    size_t mSize;
+};
+}
+
+#endif
@@ -0,0 +1,214 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_MAPPED_IMAGE_VIEW_H__
+#define __SIX_MAPPED_IMAGE_VIEW_H__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <except/Exception.h>
+#include <six/MappedFile.h>
+#include <six/NITFReadControl.h>
+#include <six/Types.h>
+
+namespace six
+{
+/*!
+ *  \class MappedImageView
+ *  \brief Zero-copy access to the pixels of an uncompressed NITF image
+ *
+ *  Maps the NITF once and hands out pointers straight into the pixel
+ *  data of each image segment, so nothing is read through a buffer.
+ *  Rows are addressed by their row in the whole image; which image
+ *  segment they're in is handled here.
+ *
+ *  Only images whose segments are uncompressed (IC of NC), have a single
+ *  block, and are pixel interleaved can be viewed this way.
+ *
+ *  Mapped pixels are in the file's big-endian byte order.  Use
+ *  readNative() to get a copy in the host's byte order, which only costs
+ *  a copy when the host is little-endian.
+ */
+class MappedImageView
+{
+public:
+    //! Rows of the image that are stored together in one image segment
+    struct Segment
+    {
+        //! Row of the image that the segment starts at
+        size_t firstRow;
+
+        //! Number of rows in the segment
+        size_t numRows;
+
+        //! First pixel of the segment's first row
+        const UByte* data;
+
+        //! Number of bytes from the start of one row to the next
+        size_t rowStride;
+    };
+
+    /*!
+     *  \param reader Reader that has already loaded 'pathname'
+     *  \param pathname The NITF to map
+     *  \param imageNumber Index of the image to view
+     *
+     *  \throws except::Exception If the image can't be viewed in place
+     */
+    MappedImageView(const NITFReadControl& reader,
+                    const std::string& pathname,
+                    size_t imageNumber = 0);
+
+    /*!
+     *  Loads the NITF with its own reader before mapping it
+     *
+     *  \param pathname The NITF to map
+     *  \param imageNumber Index of the image to view
+     *  \param schemaPaths Schemas to validate the XML against
+     *
+     *  \throws except::Exception If the image can't be viewed in place
+     */
+    MappedImageView(const std::string& pathname,
+                    size_t imageNumber = 0,
+                    const std::vector<std::string>& schemaPaths =
+                            std::vector<std::string>());
+
+    //! \return The image's data, which belongs to the reader
+    const Data& getData() const
+    {
+        return *mData;
+    }
+
+    size_t getNumRows() const
+    {
+        return mNumRows;
+    }
+
+    size_t getNumCols() const
+    {
+        return mNumCols;
+    }
+
+    size_t getNumBytesPerPixel() const
+    {
+        return mNumBytesPerPixel;
+    }
+
+    //! \return Size of each value in a pixel, i.e. the unit to byte swap
+    size_t getNumBytesPerElement() const
+    {
+        return mNumBytesPerElement;
+    }
+
+    //! \return Whether the mapped pixels differ from the host's byte order
+    bool needsByteSwap() const
+    {
+        return mNeedsByteSwap;
+    }
+
+    size_t getNumSegments() const
+    {
+        return mSegments.size();
+    }
+
+    const Segment& getSegment(size_t segment) const
+    {
+        return mSegments.at(segment);
+    }
+
+    //! \return The segment that holds 'row'
+    const Segment& getSegmentForRow(size_t row) const;
+
+    //! \return The first pixel of 'row', in the file's byte order
+    const UByte* getRow(size_t row) const
+    {
+        const Segment& segment(getSegmentForRow(row));
+        return segment.data + (row - segment.firstRow) * segment.rowStride;
+    }
+
+    /*!
+     *  Typed access to a row, for when the mapped pixels can be used as
+     *  they are (single byte elements, or a big-endian host)
+     *
+     *  \return The first pixel of 'row'
+     *
+     *  \throws except::Exception If T isn't the size of a pixel or the
+     *  pixels would have to be byte swapped
+     */
+    template <typename T>
+    const T* getRowAs(size_t row) const
+    {
+        if (sizeof(T) != mNumBytesPerPixel)
+        {
+            throw except::Exception(Ctxt(
+                    "Type does not match the size of a pixel"));
+        }
+        if (mNeedsByteSwap)
+        {
+            throw except::Exception(Ctxt(
+                    "Pixels are not in native byte order; use readNative()"));
+        }
+        return reinterpret_cast<const T*>(getRow(row));
+    }
+
+    /*!
+     *  Copy part of the image in the host's byte order.  This is the same
+     *  as what NITFReadControl::interleaved() would give.
+     *
+     *  \param startRow First row to copy
+     *  \param numRows Number of rows to copy
+     *  \param startCol First column to copy
+     *  \param numCols Number of columns to copy
+     *  \param[out] buffer numRows x numCols pixels
+     *
+     *  \throws except::Exception If the area is outside of the image
+     */
+    void readNative(size_t startRow,
+                    size_t numRows,
+                    size_t startCol,
+                    size_t numCols,
+                    UByte* buffer) const;
+
+private:
+    // Noncopyable
+    MappedImageView(const MappedImageView& );
+    const MappedImageView& operator=(const MappedImageView& );
+
+    void initialize(const NITFReadControl& reader,
+                    const std::string& pathname,
+                    size_t imageNumber);
+
+private:
+    std::auto_ptr<NITFReadControl> mReader;
+    std::auto_ptr<MappedFile> mFile;
+    const Data* mData;
+    size_t mNumRows;
+    size_t mNumCols;
+    size_t mNumBytesPerPixel;
+    size_t mNumBytesPerElement;
+    bool mNeedsByteSwap;
+    std::vector<Segment> mSegments;
+};
+}
+
+#endif
@@ -0,0 +1,141 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_NITF_BLOCK_CACHE_H__
+#define __SIX_NITF_BLOCK_CACHE_H__
+
+#include <list>
+#include <map>
+#include <vector>
+#include <stddef.h>
+
+#include <mem/SharedPtr.h>
+#include <sys/Mutex.h>
+#include "six/Types.h"
+
+namespace six
+{
+/*!
+ *  \class NITFBlockCache
+ *  \brief Size-bounded, least recently used cache of decoded image blocks
+ *
+ *  Blocks are identified by the image segment they came from and their
+ *  position within it.  All methods are thread-safe.  Blocks are handed
+ *  out as shared pointers, so a block that's evicted while another thread
+ *  is still copying out of it stays valid until that thread is done.
+ */
+class NITFBlockCache
+{
+public:
+    //! Identifies a block within a NITF
+    struct Key
+    {
+        Key(size_t segment, size_t blockRow, size_t blockCol) :
+            segment(segment),
+            blockRow(blockRow),
+            blockCol(blockCol)
+        {
+        }
+
+        bool operator<(const Key& rhs) const;
+
+        //! 0-based index of the image segment in the NITF
+        size_t segment;
+
+        //! 0-based block row within the segment
+        size_t blockRow;
+
+        //! 0-based block column within the segment
+        size_t blockCol;
+    };
+
+    //! Pixel interleaved data of a block
+    typedef mem::SharedPtr<const std::vector<UByte> > Block;
+
+    /*!
+     *  \param maxBytes Maximum total size of the cached blocks
+     */
+    explicit NITFBlockCache(size_t maxBytes);
+
+    /*!
+     *  Look up a block, counting it as a hit or miss
+     *
+     *  \param key The block to find
+     *
+     *  \return The block, or a NULL pointer if it isn't cached
+     */
+    Block get(const Key& key);
+
+    //! Same as get() but doesn't count towards the hits and misses
+    Block peek(const Key& key) const;
+
+    /*!
+     *  Add a block, evicting the least recently used blocks as needed to
+     *  make room.  Blocks larger than the whole cache aren't kept.
+     *
+     *  \param key The block's position
+     *  \param block The block's data
+     */
+    void put(const Key& key, const Block& block);
+
+    //! Removes every block.  The hit and miss counts are kept.
+    void clear();
+
+    //! \return Number of times get() found the block
+    size_t getNumHits() const;
+
+    //! \return Number of times get() didn't find the block
+    size_t getNumMisses() const;
+
+    //! \return Total size of the cached blocks
+    size_t getNumBytes() const;
+
+    //! \return Maximum total size of the cached blocks
+    size_t getMaxBytes() const
+    {
+        return mMaxBytes;
+    }
+
+private:
+    // Noncopyable
+    NITFBlockCache(const NITFBlockCache& );
+    const NITFBlockCache& operator=(const NITFBlockCache& );
+
+    typedef std::list<std::pair<Key, Block> > LRUList;
+
+    // Must be called with mMutex locked
+    void evict(size_t numBytes);
+
+private:
+    const size_t mMaxBytes;
+
+    // Guarded by mMutex
+    // The most recently used blocks are at the front of mLRU
+    LRUList mLRU;
+    std::map<Key, LRUList::iterator> mBlocks;
+    size_t mNumBytes;
+    size_t mNumHits;
+    size_t mNumMisses;
+    mutable sys::Mutex mMutex;
+};
+}
+
+#endif
@@ -23,12 +23,16 @@
 #define __SIX_NITF_READ_CONTROL_H__
 
 #include <map>
+#include <memory>
 
+#include "six/NITFBlockCache.h"
 #include "six/NITFImageInfo.h"
 #include "six/ReadControl.h"
 #include "six/ReadControlFactory.h"
 #include "six/Adapters.h"
 #include <io/SeekableStreams.h>
+#include <sys/Mutex.h>
+#include <types/RowCol.h>
 #include <import/nitf.hpp>
 #include <nitf/IOStreamReader.hpp>
 
@@ -154,6 +158,57 @@ public:
      */
     virtual UByte* interleaved(Region& region, size_t imageNumber);
 
+    /*!
+     * Read every skip.row-th row and skip.col-th column of a region of
+     * image data, starting with its first row and column.  Only the rows
+     * that are kept are read, one at a time, through one ImageReader per
+     * image segment.  NITRO skips the columns as it reads when the pixels
+     * and blocking allow it.  Each row is still a separate read of the
+     * NITF, so enable the block cache when reading blocked or compressed
+     * images with a large skip.
+     *
+     * \param region Rows and columns of the full resolution image to read,
+     * as for interleaved().  If the buffer is NULL, the memory is allocated
+     * and it is up to the caller to delete it.
+     * \param imageNumber Index of the image to read
+     * \param skip Row and column skip factors.  Both must be positive.
+     *
+     * \return Buffer of the skipped image data, which is
+     * ceil(numRows / skip.row) by ceil(numCols / skip.col) pixels
+     */
+    UByte* interleavedDecimated(Region& region,
+                                size_t imageNumber,
+                                const types::RowCol<size_t>& skip);
+
+    /*!
+     * Cache decoded blocks of image data so that overlapping calls to
+     * interleaved() don't read and decompress the same data again.  Blocked
+     * images are cached a NITF block at a time.  Other images are cached in
+     * tiles of tileDims.  The least recently used blocks are evicted once
+     * the cache is full.
+     *
+     * While the cache is enabled, interleaved() may be called from multiple
+     * threads at once.  Cache hits are served concurrently, while reads from
+     * the NITF are serialized.  The cache is emptied whenever a new file is
+     * loaded.
+     *
+     * \param maxBytes Maximum total size of the cached blocks
+     * \param tileDims (Optional) Rows and columns of each cached tile for
+     * images that aren't blocked
+     */
+    void enableBlockCache(size_t maxBytes,
+                          const types::RowCol<size_t>& tileDims =
+                                  types::RowCol<size_t>(512, 512));
+
+    //! Stop caching, freeing any cached blocks
+    void disableBlockCache();
+
+    //! \return The block cache, or NULL if it's not enabled
+    const NITFBlockCache* getBlockCache() const
+    {
+        return mBlockCache.get();
+    }
+
     virtual std::string getFileType() const
     {
         return "NITF";
@@ -171,6 +226,21 @@ public:
         return mReader;
     }
 
+    /*!
+     * \param imageNumber Index of the image
+     *
+     * \return How the image is laid out in image segments
+     */
+    const NITFImageInfo& getImageInfo(size_t imageNumber) const
+    {
+        if (imageNumber >= mInfos.size())
+        {
+            throw except::Exception(Ctxt(
+                    "Image " + str::toString(imageNumber) + " does not exist"));
+        }
+        return *mInfos[imageNumber];
+    }
+
 protected:
     //! We keep a ref to the reader
     mutable nitf::Reader mReader;
@@ -233,6 +303,50 @@ private:
                              size_t imageSeg,
                              Legend& legend);
 
+    //! Whether a segment's bands have to be read separately and then
+    //! interleaved, since NITRO won't treat them as a single band
+    bool isBandSequentialRead(size_t segmentIndex);
+
+    // Reads the rows and columns of one image segment in 'subWindow' into
+    // a pixel interleaved buffer
+    void readSubWindow(nitf::ImageReader& imageReader,
+                       size_t segmentIndex,
+                       const Data& data,
+                       nitf::SubWindow& subWindow,
+                       UByte* buffer);
+
+    //! Whether NITRO can skip colSkip columns at a time while reading a
+    //! segment
+    bool canSkipColumns(size_t segmentIndex,
+                        size_t numBytesPerPixel,
+                        size_t colSkip);
+
+    // Copies every colSkip-th pixel of a row
+    static
+    void skipColumns(const UByte* input,
+                     size_t numOutputCols,
+                     size_t colSkip,
+                     size_t numBytesPerPixel,
+                     UByte* output);
+
+    // interleaved() through mBlockCache
+    void readCached(const NITFImageInfo& info,
+                    size_t startRow,
+                    size_t numRows,
+                    size_t startCol,
+                    size_t numCols,
+                    UByte* buffer);
+
+    // Gets a block out of the cache, reading it from the NITF on a miss
+    NITFBlockCache::Block getBlock(const Data& data,
+                                   size_t segmentIndex,
+                                   const NITFBlockCache::Key& key,
+                                   const types::RowCol<size_t>& blockOffset,
+                                   const types::RowCol<size_t>& blockExtent);
+
+    // Dimensions of the cached blocks of a segment
+    types::RowCol<size_t> getBlockDims(size_t segmentIndex);
+
     static
     bool isLegend(nitf::ImageSubheader& subheader)
     {
@@ -247,6 +361,15 @@ private:
     // The issue occurs from the explicit destructor of
     // IOControl
     mem::SharedPtr<nitf::IOInterface> mInterface;
+
+    std::auto_ptr<NITFBlockCache> mBlockCache;
+    types::RowCol<size_t> mCacheTileDims;
+
+    // Guards reads through mReader while the cache is enabled, along with
+    // the members below
+    sys::Mutex mCacheReadMutex;
+    std::map<size_t, nitf::ImageReader> mImageReaders;
+    bool mCacheCompressionOptionsCreated;
 };
 
 
@@ -31,6 +31,7 @@
 #include "six/NITFImageInfo.h"
 #include "six/Adapters.h"
 #include <six/NITFHeaderCreator.h>
+#include <six/ThreadPool.h>
 
 namespace six
 {
@@ -48,6 +49,17 @@ namespace six
 class NITFWriteControl : public WriteControl
 {
 public:
+    /*!
+     *  Number of threads that save() uses to write an image from memory
+     *  to a file.  With more than one, the file layout is computed up front
+     *  and each thread byte swaps and writes its own band of rows directly
+     *  to its place in the file.  The headers and DES are written once the
+     *  pixels are done.  This only applies to a single unblocked,
+     *  uncompressed image with no legend or additional DES writers; anything
+     *  else is written with one thread.  Defaults to 1.  0 means one per
+     *  CPU.  Ignored once setThreadPool() has been given a pool.
+     */
+    static const char OPT_NUM_WRITE_THREADS[];
 
     //! Constructor. Must call initialize to use.
     NITFWriteControl();
@@ -138,6 +150,18 @@ public:
      */
     void setNITFHeaderCreator(std::auto_ptr<six::NITFHeaderCreator> headerCreator);
 
+    /*!
+     * Set the threads that save() writes an image from memory with, in
+     * place of starting OPT_NUM_WRITE_THREADS of them for each call.  The
+     * same restrictions on what can be written in parallel apply.
+     * \param threadPool Threads to write with, or NULL to go back to
+     * OPT_NUM_WRITE_THREADS.  This must outlive any calls to save().
+     */
+    void setThreadPool(ThreadPool* threadPool)
+    {
+        mThreadPool = threadPool;
+    }
+
     virtual void initialize(const six::Options& options,
                             mem::SharedPtr<Container> container);
 
@@ -432,6 +456,22 @@ protected:
     void setXMLControlRegistryImpl(const XMLControlRegistry* xmlRegistry);
 
 private:
+    //! \return Whether the image data can be written by saveInParallel()
+    bool canSaveInParallel();
+
+    /*!
+     * Write the file with each thread writing a band of rows at its
+     * precomputed offset.  Only valid if canSaveInParallel().
+     * \param imageData The one image's pixels
+     * \param outputFile Output path to write
+     * \param schemaPaths Directories or files of schema locations
+     * \param threadPool Threads to write with
+     */
+    void saveInParallel(const UByte* imageData,
+                        const std::string& outputFile,
+                        const std::vector<std::string>& schemaPaths,
+                        ThreadPool& threadPool);
+
     /*!
      * Get the DES type identifier.
      * \param data The data object.
@@ -491,6 +531,8 @@ private:
     //! Noncopyable
     NITFWriteControl(const NITFWriteControl& );
     const NITFWriteControl& operator=(const NITFWriteControl& );
+
+    ThreadPool* mThreadPool;
 };
 }
 #endif
@@ -23,6 +23,7 @@
 #define __SIX_PARAMETER_H__
 
 #include "six/Types.h"
+#include "six/DoubleConversion.h"
 #include <import/str.h>
 
 namespace six
@@ -58,7 +59,7 @@ public:
     template<typename T>
     Parameter(T value)
     {
-        mValue = str::toString<T>(value);
+        mValue = toString(value);
     }
 
     template<typename T>
@@ -75,7 +76,7 @@ public:
     template<typename T>
     inline operator T() const
     {
-        return str::toType<T>(mValue);
+        return fromString(mValue, static_cast<T*>(NULL));
     }
 
     //!  Get a string as a string
@@ -106,7 +107,7 @@ public:
     template<typename T>
     void setValue(T value)
     {
-        mValue = str::toString<T>(value);
+        mValue = toString(value);
     }
 
     //! Overload templated setValue function
@@ -136,6 +137,41 @@ protected:
     std::string mValue;
     std::string mName;
 
+private:
+    // Floating point values use the same locale-independent, round-trip
+    // conversions as the XML
+    template<typename T>
+    static std::string toString(const T& value)
+    {
+        return str::toString<T>(value);
+    }
+
+    static std::string toString(double value)
+    {
+        return formatDouble(value);
+    }
+
+    static std::string toString(float value)
+    {
+        return formatFloat(value);
+    }
+
+    template<typename T>
+    static T fromString(const std::string& value, T* )
+    {
+        return str::toType<T>(value);
+    }
+
+    static double fromString(const std::string& value, double* )
+    {
+        return toDouble(value);
+    }
+
+    static float fromString(const std::string& value, float* )
+    {
+        return toFloat(value);
+    }
+
 };
 
 }
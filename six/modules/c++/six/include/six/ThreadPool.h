@@ -0,0 +1,139 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_THREAD_POOL_H__
+#define __SIX_THREAD_POOL_H__
+
+#include <deque>
+#include <vector>
+#include <stddef.h>
+
+#include <mem/SharedPtr.h>
+#include <sys/Runnable.h>
+#include <sys/Thread.h>
+#include <sys/Mutex.h>
+#include <sys/ConditionVar.h>
+
+namespace six
+{
+/*!
+ *  \class ThreadPool
+ *  \brief Persistent set of worker threads for data-parallel loops
+ *
+ *  The worker threads are started once, when the pool is constructed, and
+ *  are reused by every call to run().  This avoids the cost of creating and
+ *  joining an mt::ThreadGroup each time a (possibly small) block of data
+ *  is processed.  The calling thread also does work while it waits, so a
+ *  pool of N threads only starts N - 1 workers.
+ *
+ *  run() may be called concurrently from multiple threads; each call only
+ *  waits for its own runnables.
+ */
+class ThreadPool
+{
+public:
+    /*!
+     *  Start the worker threads
+     *
+     *  \param numThreads Total number of threads to use, including the
+     *  calling thread.  If this is 0 or 1, no workers are started and
+     *  everything runs on the calling thread.
+     */
+    explicit ThreadPool(size_t numThreads);
+
+    //! Stops and joins the worker threads
+    ~ThreadPool();
+
+    //! \return Total number of threads used, including the calling thread
+    size_t getNumThreads() const
+    {
+        return mNumThreads;
+    }
+
+    /*!
+     *  Number of pieces to split a loop into so that each piece has at
+     *  least minElementsPerChunk elements, but there are no more pieces
+     *  than threads.  Small loops aren't worth dispatching to workers.
+     *
+     *  \param numElements Total number of elements in the loop
+     *  \param minElementsPerChunk Minimum amount of work per piece
+     *
+     *  \return The number of pieces, which is at least 1
+     */
+    size_t getNumChunks(size_t numElements,
+                        size_t minElementsPerChunk = 1) const;
+
+    /*!
+     *  Run each runnable and wait for all of them to finish.  The
+     *  runnables are still owned by the caller.
+     *
+     *  \param runnables The work to perform
+     *
+     *  \throws except::Exception If any of the runnables threw.  The
+     *  first exception thrown is rethrown once all runnables have finished.
+     */
+    void run(const std::vector<sys::Runnable*>& runnables);
+
+    /*!
+     *  Convenience overload of run() for a vector of one type of runnable
+     *
+     *  \param runnables The work to perform
+     */
+    template <typename RunnableT>
+    void runEach(std::vector<RunnableT>& runnables)
+    {
+        std::vector<sys::Runnable*> ptrs(runnables.size());
+        for (size_t ii = 0; ii < runnables.size(); ++ii)
+        {
+            ptrs[ii] = &runnables[ii];
+        }
+        run(ptrs);
+    }
+
+private:
+    // Noncopyable
+    ThreadPool(const ThreadPool& );
+    const ThreadPool& operator=(const ThreadPool& );
+
+    struct Batch;
+    class Worker;
+
+    void workerLoop();
+
+    // Claims the next runnable in mQueue.front()
+    // Must be called with mMutex locked and mQueue non-empty
+    Batch* claimNext(size_t& index);
+
+    // Runs a claimed runnable, then locks mMutex and marks it as finished
+    void execute(Batch& batch, size_t index);
+
+private:
+    const size_t mNumThreads;
+    bool mShutdown;
+    std::deque<Batch*> mQueue;
+    sys::Mutex mMutex;
+    sys::ConditionVar mWorkAvailable;
+    sys::ConditionVar mBatchFinished;
+    std::vector<mem::SharedPtr<sys::Thread> > mThreads;
+};
+}
+
+#endif
@@ -26,6 +26,7 @@
 #include <except/Exception.h>
 #include "six/Types.h"
 #include "six/Data.h"
+#include "six/DoubleConversion.h"
 #include "six/Enums.h"
 #include "six/XMLControlFactory.h"
 #include "logging/Logger.h"
@@ -82,8 +83,11 @@ template<typename T> T toType(const std::string& s)
     return str::toType<T>(s);
 }
 
+// Shortest round-trip representation; see formatDouble()
 template<> std::string toString(const float& value);
 template<> std::string toString(const double& value);
+template<> float toType<float>(const std::string& s);
+template<> double toType<double>(const std::string& s);
 template<> std::string toString(const six::Vector3 & v);
 template<> std::string toString(const six::PolyXYZ & p);
 template<> six::EarthModelType
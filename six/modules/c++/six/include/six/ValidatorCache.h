@@ -0,0 +1,116 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_VALIDATOR_CACHE_H__
+#define __SIX_VALIDATOR_CACHE_H__
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <logging/Logger.h>
+#include <sys/Mutex.h>
+#include <xml/lite/ValidatorInterface.h>
+
+namespace six
+{
+/*!
+ *  \class ValidatorCache
+ *  \brief Keeps compiled schemas around between validations
+ *
+ *  Creating an xml::lite::Validator loads and compiles every schema under
+ *  the schema paths, which usually costs far more than the validation
+ *  itself.  This cache holds onto validators once they've been used, keyed
+ *  by the set of schema paths they were compiled from.  A single validator
+ *  covers every namespace under its paths, so documents with different
+ *  namespace URIs share it.
+ *
+ *  Validators can't be used by more than one thread at once, so each
+ *  thread borrows its own for the duration of a validation.  A new one is
+ *  only compiled when every cached validator for the paths is in use.
+ */
+class ValidatorCache
+{
+public:
+    ValidatorCache();
+
+    virtual ~ValidatorCache();
+
+    //! \return The process-wide cache used by XMLControl
+    static ValidatorCache& getInstance();
+
+    /*!
+     *  Validate XML against the schemas under schemaPaths
+     *
+     *  \param xml The XML document text
+     *  \param xmlID Identifies the document in the errors, typically its
+     *  namespace URI
+     *  \param schemaPaths Directories or files of schema locations.  These
+     *  must all exist.
+     *  \param[out] errors Any errors found are appended
+     *  \param log Used to report schemas that fail to load
+     *
+     *  \return True if any errors were found
+     */
+    bool validate(const std::string& xml,
+                  const std::string& xmlID,
+                  const std::vector<std::string>& schemaPaths,
+                  std::vector<xml::lite::ValidationInfo>& errors,
+                  logging::Logger* log);
+
+    //! Discard all validators that aren't in use
+    void clear();
+
+    //! \return The number of validators that have been compiled
+    size_t getNumCompiled() const;
+
+protected:
+    //! Compile a validator for the schemas under schemaPaths
+    virtual std::auto_ptr<xml::lite::ValidatorInterface>
+    createValidator(const std::vector<std::string>& schemaPaths,
+                    logging::Logger* log) const;
+
+private:
+    // Noncopyable
+    ValidatorCache(const ValidatorCache& );
+    const ValidatorCache& operator=(const ValidatorCache& );
+
+    typedef std::vector<std::string> Key;
+    typedef std::vector<xml::lite::ValidatorInterface*> Validators;
+
+    // Takes an unused validator for 'key', or NULL if there isn't one
+    xml::lite::ValidatorInterface* acquire(const Key& key);
+
+    // Hands a validator back to the cache once a thread is done with it
+    void release(const Key& key, xml::lite::ValidatorInterface* validator);
+
+    class Lease;
+
+private:
+    // Guarded by mMutex
+    std::map<Key, Validators> mIdle;
+    size_t mNumCompiled;
+    mutable sys::Mutex mMutex;
+};
+}
+
+#endif
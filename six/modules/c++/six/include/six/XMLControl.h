@@ -74,6 +74,23 @@ class XMLControl
                          const std::vector<std::string>& schemaPaths,
                          logging::Logger* log);
 
+    /*
+     *  \func validate
+     *  \brief Validate XML text and log any errors
+     *
+     *  Schemas are compiled once per set of schema paths and then reused
+     *  by later validations (see ValidatorCache).
+     *
+     *  \param xml XML document text
+     *  \param uri Namespace URI of the document's root element
+     *  \param schemaPaths  Directories or files of schema locations
+     *  \param log Logs validation errors
+     */
+    static void validate(const std::string& xml,
+                         const std::string& uri,
+                         const std::vector<std::string>& schemaPaths,
+                         logging::Logger* log);
+
     /*!
      * Retrieve the proper schema paths for validation.
      * Schema paths can come from three sources, in
@@ -99,6 +116,18 @@ class XMLControl
     xml::lite::Document* toXML(const Data* data,
                                const std::vector<std::string>& schemaPaths);
 
+    /*!
+     *  Convert the Data model into XML text, without building a DOM.  The
+     *  text is the same as printing the DOM from the other toXML(), and
+     *  it's validated as it is rather than being pretty-printed first.
+     *  \param data         Data structure
+     *  \param schemaPaths  Directories or files of schema locations
+     *  \param[in,out] xml  The XML is appended to this
+     */
+    void toXML(const Data* data,
+               const std::vector<std::string>& schemaPaths,
+               std::string& xml);
+
     /*!
      *  Convert a document from a DOM into a Data model
      *  \param doc          XML Document
@@ -108,6 +137,19 @@ class XMLControl
     Data* fromXML(const xml::lite::Document* doc,
                   const std::vector<std::string>& schemaPaths);
 
+    /*!
+     *  Convert a document from a DOM into a Data model, validating the
+     *  XML text it was parsed from rather than printing the DOM back out.
+     *  Validation errors then refer to lines in the original text.
+     *  \param xml          XML text that doc was parsed from
+     *  \param doc          XML Document
+     *  \param schemaPaths  Directories or files of schema locations
+     *  \return a Data model
+     */
+    Data* fromXML(const std::string& xml,
+                  const xml::lite::Document* doc,
+                  const std::vector<std::string>& schemaPaths);
+
     /*!
      *  Provides a mapping from COMPLEX --> SICD and DERIVED --> SIDD
      */
@@ -141,12 +183,27 @@ class XMLControl
      */
     virtual xml::lite::Document* toXMLImpl(const Data* data) = 0;
 
+    /*!
+     *  Convert the Data model into XML text, appending it to xml.  By
+     *  default this prints the DOM from toXMLImpl().
+     *  \param data the Data model
+     *  \param[in,out] xml The XML is appended to this
+     */
+    virtual void toXMLImpl(const Data* data, std::string& xml);
+
     static std::string getDefaultURI(const Data& data);
 
     static std::string getVersionFromURI(const xml::lite::Document* doc);
 
     static void getVersionFromURI(const xml::lite::Document* doc,
                                   std::vector<std::string>& version);
+
+    private:
+    // Fills in 'paths' with the schema paths to validate against, throwing
+    // if any of them don't exist.  Returns false if there are none.
+    static bool getValidationPaths(const std::vector<std::string>& schemaPaths,
+                                   logging::Logger* log,
+                                   std::vector<std::string>& paths);
 };
 }
 
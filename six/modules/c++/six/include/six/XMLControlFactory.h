@@ -146,6 +146,17 @@ private:
     RegistryMap mRegistry;
 };
 
+/*!
+ *  Serialize an XML element and all of its children onto the end of 'xml'.
+ *  The output is byte-for-byte what xml::lite::Element::print() writes,
+ *  but it's built directly in the caller's buffer, in one pass, instead of
+ *  going through a stream and then being copied back out of it.
+ *
+ *  \param element The element to serialize
+ *  \param[in,out] xml The XML is appended to this
+ */
+void appendXML(const xml::lite::Element& element, std::string& xml);
+
 /*!
  *  Convenience method to convert from a ComplexData or DerivedData
  *  into a C++ style string containing XML.
@@ -28,6 +28,7 @@
 #include <logging/Logger.h>
 #include <six/Types.h>
 #include <six/Init.h>
+#include <six/XMLStreamWriter.h>
 
 namespace six
 {
@@ -45,6 +46,14 @@ public:
 
     void setLogger(logging::Logger* log, bool ownLog = false);
 
+    /*!
+     * Write the elements that newElement() creates to a stream writer,
+     * instead of adding them to their parents.  Pass NULL to go back to
+     * building a tree.
+     * \param writer The writer, which must outlive its use by the parser
+     */
+    virtual void setStreamWriter(XMLStreamWriter* writer);
+
     typedef xml::lite::Element* XMLElem;
 
 protected:
@@ -61,13 +70,11 @@ protected:
 
     XMLElem newElement(const std::string& name, XMLElem prnt = NULL) const;
 
-    static
     XMLElem newElement(const std::string& name, const std::string& uri,
-            XMLElem prnt = NULL);
+            XMLElem prnt = NULL) const;
 
-    static
     XMLElem newElement(const std::string& name, const std::string& uri,
-            const std::string& characterData, XMLElem parent = NULL);
+            const std::string& characterData, XMLElem parent = NULL) const;
 
     // generic element creation methods, w/URI
     XMLElem createString(const std::string& name,
@@ -183,6 +190,8 @@ private:
 
     logging::Logger* mLog;
     bool mOwnLog;
+
+    XMLStreamWriter* mStreamWriter;
 };
 }
 
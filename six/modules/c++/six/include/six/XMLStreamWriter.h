@@ -0,0 +1,153 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_XML_STREAM_WRITER_H__
+#define __SIX_XML_STREAM_WRITER_H__
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <xml/lite/Element.h>
+
+namespace six
+{
+/*!
+ *  \class XMLStreamWriter
+ *  \brief Writes XML onto the end of a string as the elements are created
+ *
+ *  An XMLParser that has been given a writer hands out elements from
+ *  newElement() that are written here instead of being added to their
+ *  parents, so the converters write their XML in one pass without building
+ *  a tree.  The text is byte-for-byte what printing the tree would give.
+ *
+ *  Elements are written in the order they're created, so a converter has
+ *  to finish each element before it starts a sibling of that element or of
+ *  any of its ancestors.  Adding a child to an element that has already
+ *  been written throws.  An element's attributes and character data can
+ *  still be changed after its children are created: its start tag is
+ *  patched when it's closed.  Its name can't be changed: it's written with
+ *  the name it was created with.
+ *
+ *  The elements are allocated a block at a time and are never reused, so
+ *  each one stays valid until the writer is destroyed.  finish() throws if
+ *  any of them were changed after they were written.
+ *
+ *  This class is not copyable.
+ */
+class XMLStreamWriter
+{
+public:
+    /*!
+     *  Constructor
+     *  \param[in,out] xml The XML is appended to this
+     */
+    explicit XMLStreamWriter(std::string& xml);
+
+    //! Destructor
+    ~XMLStreamWriter();
+
+    /*!
+     *  Start a new element, writing any open elements that aren't parent
+     *  or one of its ancestors.
+     *
+     *  The root element is the one without a parent, and the caller owns
+     *  it.  Any namespaces set on it with setNamespacePrefix() before its
+     *  first child is created are applied to every element and attribute
+     *  in the document, as they would be for the finished tree.  All of
+     *  the other elements are owned by the writer.
+     *
+     *  \param name Qualified name of the element
+     *  \param uri Namespace URI of the element
+     *  \param characterData Character data of the element
+     *  \param parent Parent of the element, or NULL for the root
+     *
+     *  \return The new element
+     */
+    xml::lite::Element* newElement(const std::string& name,
+                                   const std::string& uri,
+                                   const std::string& characterData,
+                                   xml::lite::Element* parent);
+
+    /*!
+     *  Write all of the open elements, including the root, and check that
+     *  none of the elements written before them have been changed since.
+     */
+    void finish();
+
+private:
+    // Unimplemented - XMLStreamWriter is not copyable
+    XMLStreamWriter(const XMLStreamWriter& other);
+    XMLStreamWriter& operator=(const XMLStreamWriter& other);
+
+private:
+    class StreamElement;
+
+    StreamElement* allocate(const std::string& name,
+                            const std::string& uri,
+                            const std::string& characterData);
+
+    StreamElement& getElement(size_t index) const;
+
+    // Writes the attributes, '>' and the character data
+    void appendHeader(const StreamElement& element, std::string& xml) const;
+
+    void writeHeader(StreamElement& element);
+
+    void closeElement();
+
+    // Notes the namespaces the root declares, and writes its name
+    void startRoot(StreamElement& root);
+
+    // Writes the qualified name for name, applying the root's namespaces
+    void appendTag(const std::string& name, const std::string& uri);
+
+    // The prefix for elements and attributes in uri, if the root declares
+    // one
+    const std::string* findPrefix(const std::string& uri) const;
+
+    static sys::Uint64_T hash(const std::string& str,
+                              size_t offset,
+                              size_t length);
+
+    static const size_t BLOCK_SIZE;
+
+    std::string& mXML;
+
+    // The root, then each open descendant of the one before it
+    std::vector<StreamElement*> mOpen;
+
+    // Every element but the root, in the order they were created
+    std::vector<StreamElement*> mBlocks;
+    size_t mNumElements;
+
+    // Namespace URIs and prefixes declared on the root
+    std::vector<std::pair<std::string, std::string> > mNamespaces;
+
+    // Scratch space for writing headers and end tags
+    std::string mScratch;
+
+    bool mHasRoot;
+};
+}
+
+#endif
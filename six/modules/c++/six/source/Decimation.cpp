@@ -0,0 +1,197 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <vector>
+
+#include <except/Exception.h>
+#include <mt/ThreadPlanner.h>
+#include <six/Decimation.h>
+
+namespace
+{
+// Full resolution pixels reduced per thread, at a minimum
+const size_t MIN_PIXELS_PER_CHUNK = 16 * 1024;
+
+inline float power(const std::complex<float>& pixel)
+{
+    return pixel.real() * pixel.real() + pixel.imag() * pixel.imag();
+}
+
+// Reduces one decimated row from the numRows rows that it uses
+void reduceRow(const six::Decimation& decimation,
+               const std::complex<float>* input,
+               size_t numRows,
+               size_t numCols,
+               float* output)
+{
+    const size_t colFactor = decimation.factor.col;
+    const size_t numOutputCols = (numCols + colFactor - 1) / colFactor;
+
+    if (decimation.method == six::Decimation::SKIP)
+    {
+        for (size_t col = 0; col < numOutputCols; ++col)
+        {
+            output[col] = power(input[col * colFactor]);
+        }
+        return;
+    }
+
+    const bool isMean = (decimation.method == six::Decimation::MEAN_POWER);
+    std::fill(output, output + numOutputCols, 0.0f);
+    for (size_t row = 0; row < numRows; ++row)
+    {
+        const std::complex<float>* const inputRow = input + row * numCols;
+        for (size_t col = 0; col < numOutputCols; ++col)
+        {
+            const size_t firstCol = col * colFactor;
+            const size_t endCol = std::min(firstCol + colFactor, numCols);
+            float value = output[col];
+            if (isMean)
+            {
+                for (size_t ii = firstCol; ii < endCol; ++ii)
+                {
+                    value += power(inputRow[ii]);
+                }
+            }
+            else
+            {
+                for (size_t ii = firstCol; ii < endCol; ++ii)
+                {
+                    value = std::max(value, power(inputRow[ii]));
+                }
+            }
+            output[col] = value;
+        }
+    }
+
+    if (isMean)
+    {
+        const size_t lastBlockCols = numCols - (numOutputCols - 1) * colFactor;
+        const float scale = 1.0f / (numRows * colFactor);
+        for (size_t col = 0; col + 1 < numOutputCols; ++col)
+        {
+            output[col] *= scale;
+        }
+        output[numOutputCols - 1] /= static_cast<float>(numRows *
+                                                        lastBlockCols);
+    }
+}
+
+class ReduceRows : public sys::Runnable
+{
+public:
+    ReduceRows(const six::Decimation& decimation,
+               const std::complex<float>* input,
+               size_t numInputRows,
+               size_t numCols,
+               size_t startRow,
+               size_t numRows,
+               float* output) :
+        mDecimation(decimation),
+        mInput(input),
+        mNumInputRows(numInputRows),
+        mNumCols(numCols),
+        mStartRow(startRow),
+        mNumRows(numRows),
+        mOutput(output)
+    {
+    }
+
+    virtual void run()
+    {
+        const size_t rowsPerOutputRow = mDecimation.getRowsPerOutputRow();
+        const size_t numOutputCols =
+                (mNumCols + mDecimation.factor.col - 1) /
+                mDecimation.factor.col;
+        for (size_t row = mStartRow; row < mStartRow + mNumRows; ++row)
+        {
+            const size_t firstInputRow = row * rowsPerOutputRow;
+            reduceRow(mDecimation,
+                      mInput + firstInputRow * mNumCols,
+                      std::min(rowsPerOutputRow,
+                               mNumInputRows - firstInputRow),
+                      mNumCols,
+                      mOutput + row * numOutputCols);
+        }
+    }
+
+private:
+    const six::Decimation& mDecimation;
+    const std::complex<float>* const mInput;
+    const size_t mNumInputRows;
+    const size_t mNumCols;
+    const size_t mStartRow;
+    const size_t mNumRows;
+    float* const mOutput;
+};
+}
+
+namespace six
+{
+Decimation::Decimation(const types::RowCol<size_t>& factor, Method method) :
+    factor(factor),
+    method(method)
+{
+    if (factor.row == 0 || factor.col == 0)
+    {
+        throw except::Exception(Ctxt("Decimation factors must be positive"));
+    }
+}
+
+types::RowCol<size_t> Decimation::getDecimatedDims(
+        const types::RowCol<size_t>& dims) const
+{
+    return types::RowCol<size_t>((dims.row + factor.row - 1) / factor.row,
+                                 (dims.col + factor.col - 1) / factor.col);
+}
+
+void Decimation::reduce(const std::complex<float>* input,
+                        size_t numInputRows,
+                        size_t numCols,
+                        ThreadPool& threadPool,
+                        float* output) const
+{
+    if (numInputRows == 0 || numCols == 0)
+    {
+        return;
+    }
+
+    const size_t rowsPerOutputRow = getRowsPerOutputRow();
+    const size_t numOutputRows =
+            (numInputRows + rowsPerOutputRow - 1) / rowsPerOutputRow;
+    const mt::ThreadPlanner planner(
+            numOutputRows,
+            threadPool.getNumChunks(numInputRows * numCols,
+                                    MIN_PIXELS_PER_CHUNK));
+
+    std::vector<ReduceRows> runnables;
+    size_t threadNum(0);
+    size_t startRow(0);
+    size_t numRowsThisThread(0);
+    while (planner.getThreadInfo(threadNum++, startRow, numRowsThisThread))
+    {
+        runnables.push_back(ReduceRows(*this, input, numInputRows, numCols,
+                                       startRow, numRowsThisThread, output));
+    }
+    threadPool.runEach(runnables);
+}
+}
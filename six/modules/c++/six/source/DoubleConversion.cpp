@@ -0,0 +1,616 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+#include <except/Exception.h>
+#include <sys/Conf.h>
+#include <six/DoubleConversion.h>
+
+namespace
+{
+// Significant digits beyond this are only checked for being nonzero
+const size_t MAX_MANTISSA_DIGITS = 19;
+
+// Keeps absurd exponents from overflowing an int.  Anything past this is
+// zero or infinity regardless of the digits.
+const int MAX_EXPONENT = 100000;
+
+// Every power of ten up to here is exactly representable as a double
+const int MAX_EXACT_DOUBLE_POWER = 22;
+const double DOUBLE_POWERS_OF_TEN[] =
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+const sys::Uint64_T MAX_EXACT_DOUBLE_INTEGER =
+        static_cast<sys::Uint64_T>(1) << std::numeric_limits<double>::digits;
+
+// Same as above, but for floats
+const int MAX_EXACT_FLOAT_POWER = 10;
+const float FLOAT_POWERS_OF_TEN[] =
+{
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+const sys::Uint64_T MAX_EXACT_FLOAT_INTEGER =
+        static_cast<sys::Uint64_T>(1) << std::numeric_limits<float>::digits;
+
+enum NumberKind
+{
+    FINITE,
+    INFINITE,
+    NOT_A_NUMBER
+};
+
+// A number that's been scanned but not yet rounded to a binary type.
+// For finite numbers, the value is
+//     mantissa * 10^exponent
+// if nothing was truncated.  Otherwise the digits have to be gone over
+// again to round correctly.
+struct ScannedNumber
+{
+    NumberKind kind;
+    bool negative;
+    sys::Uint64_T mantissa;
+    int exponent;
+    bool truncated;
+
+    // All of the digits, with a '.' possibly in the middle, and the
+    // exponent that goes with them if the '.' is ignored
+    const char* digitsBegin;
+    const char* digitsEnd;
+    int digitsExponent;
+};
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+char toUpper(char c)
+{
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+// \return Length of 'word' if [begin, end) starts with it, ignoring case,
+// or 0 otherwise
+size_t matchWord(const char* begin, const char* end, const char* word)
+{
+    size_t length = 0;
+    for (; word[length] != '\0'; ++length)
+    {
+        if (begin + length == end || toUpper(begin[length]) != word[length])
+        {
+            return 0;
+        }
+    }
+    return length;
+}
+
+// Scan digits, keeping as many as fit in the mantissa.  'inFraction' is
+// whether they're after the '.'.
+const char* scanDigits(const char* ptr,
+                       const char* end,
+                       bool inFraction,
+                       size_t& numSignificant,
+                       ScannedNumber& number)
+{
+    for (; ptr != end && isDigit(*ptr); ++ptr)
+    {
+        const unsigned int digit = static_cast<unsigned int>(*ptr - '0');
+        if (inFraction)
+        {
+            --number.digitsExponent;
+        }
+
+        if (numSignificant == 0 && digit == 0)
+        {
+            // Leading zero
+            if (inFraction)
+            {
+                --number.exponent;
+            }
+        }
+        else if (numSignificant < MAX_MANTISSA_DIGITS)
+        {
+            number.mantissa = number.mantissa * 10 + digit;
+            ++numSignificant;
+            if (inFraction)
+            {
+                --number.exponent;
+            }
+        }
+        else
+        {
+            number.truncated = number.truncated || (digit != 0);
+            if (!inFraction)
+            {
+                ++number.exponent;
+            }
+        }
+    }
+    return ptr;
+}
+
+const char* scanNumber(const char* begin,
+                       const char* end,
+                       ScannedNumber& number)
+{
+    const char* ptr = begin;
+    number.kind = FINITE;
+    number.negative = false;
+    number.mantissa = 0;
+    number.exponent = 0;
+    number.truncated = false;
+    number.digitsExponent = 0;
+
+    if (ptr != end && (*ptr == '-' || *ptr == '+'))
+    {
+        number.negative = (*ptr == '-');
+        ++ptr;
+    }
+
+    if (ptr != end && !isDigit(*ptr) && *ptr != '.')
+    {
+        size_t length = matchWord(ptr, end, "INFINITY");
+        if (length == 0)
+        {
+            length = matchWord(ptr, end, "INF");
+        }
+        if (length != 0)
+        {
+            number.kind = INFINITE;
+            return ptr + length;
+        }
+
+        length = matchWord(ptr, end, "NAN");
+        if (length != 0)
+        {
+            number.kind = NOT_A_NUMBER;
+            return ptr + length;
+        }
+        return begin;
+    }
+
+    size_t numSignificant = 0;
+    number.digitsBegin = ptr;
+    const char* const integerEnd =
+            scanDigits(ptr, end, false, numSignificant, number);
+    bool sawDigit = (integerEnd != ptr);
+    ptr = integerEnd;
+
+    if (ptr != end && *ptr == '.')
+    {
+        const char* const fractionEnd =
+                scanDigits(ptr + 1, end, true, numSignificant, number);
+        sawDigit = sawDigit || (fractionEnd != ptr + 1);
+        ptr = fractionEnd;
+    }
+    number.digitsEnd = ptr;
+
+    if (!sawDigit)
+    {
+        return begin;
+    }
+
+    // The exponent is only part of the number if it has digits
+    if (ptr != end && (*ptr == 'e' || *ptr == 'E'))
+    {
+        const char* exponentPtr = ptr + 1;
+        bool negativeExponent = false;
+        if (exponentPtr != end && (*exponentPtr == '-' || *exponentPtr == '+'))
+        {
+            negativeExponent = (*exponentPtr == '-');
+            ++exponentPtr;
+        }
+
+        if (exponentPtr != end && isDigit(*exponentPtr))
+        {
+            int exponent = 0;
+            for (; exponentPtr != end && isDigit(*exponentPtr); ++exponentPtr)
+            {
+                if (exponent < MAX_EXPONENT)
+                {
+                    exponent = exponent * 10 + (*exponentPtr - '0');
+                }
+            }
+            if (negativeExponent)
+            {
+                exponent = -exponent;
+            }
+            number.exponent += exponent;
+            number.digitsExponent += exponent;
+            ptr = exponentPtr;
+        }
+    }
+
+    return ptr;
+}
+
+void appendInt(int value, std::string& str)
+{
+    if (value < 0)
+    {
+        str += '-';
+        value = -value;
+    }
+
+    char digits[16];
+    size_t numDigits = 0;
+    do
+    {
+        digits[numDigits++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    while (numDigits > 0)
+    {
+        str += digits[--numDigits];
+    }
+}
+
+// Spell the digits out with no '.', so the C library parses them the
+// same way in every locale, and let it do the rounding
+std::string getPlainDigits(const ScannedNumber& number)
+{
+    std::string digits;
+    digits.reserve(number.digitsEnd - number.digitsBegin + 8);
+    for (const char* ptr = number.digitsBegin; ptr != number.digitsEnd; ++ptr)
+    {
+        if (*ptr != '.')
+        {
+            digits += *ptr;
+        }
+    }
+    digits += 'e';
+    appendInt(number.digitsExponent, digits);
+    return digits;
+}
+
+// Round 'number' to a T.  When the mantissa and the power of ten are both
+// exactly representable, one multiplication or division rounds correctly
+// (Clinger's fast path).
+template <typename T>
+T roundNumber(const ScannedNumber& number,
+              int maxExactPower,
+              const T* powersOfTen,
+              sys::Uint64_T maxExactInteger,
+              T (*parseDigits)(const char*, char**))
+{
+    T value;
+    if (number.kind == INFINITE)
+    {
+        value = std::numeric_limits<T>::infinity();
+    }
+    else if (number.kind == NOT_A_NUMBER)
+    {
+        value = std::numeric_limits<T>::quiet_NaN();
+    }
+    else if (number.mantissa == 0)
+    {
+        value = 0;
+    }
+    else
+    {
+        sys::Uint64_T mantissa = number.mantissa;
+        int exponent = number.exponent;
+
+        // Move extra powers of ten into the mantissa while it stays exact
+        while (!number.truncated &&
+               exponent > maxExactPower &&
+               mantissa <= maxExactInteger / 10)
+        {
+            mantissa *= 10;
+            --exponent;
+        }
+
+        if (!number.truncated &&
+            mantissa <= maxExactInteger &&
+            exponent >= -maxExactPower &&
+            exponent <= maxExactPower)
+        {
+            value = static_cast<T>(mantissa);
+            if (exponent < 0)
+            {
+                value /= powersOfTen[-exponent];
+            }
+            else
+            {
+                value *= powersOfTen[exponent];
+            }
+        }
+        else
+        {
+            value = parseDigits(getPlainDigits(number).c_str(), NULL);
+        }
+    }
+
+    return number.negative ? -value : value;
+}
+
+double toDoubleValue(const ScannedNumber& number)
+{
+    return roundNumber<double>(number,
+                               MAX_EXACT_DOUBLE_POWER,
+                               DOUBLE_POWERS_OF_TEN,
+                               MAX_EXACT_DOUBLE_INTEGER,
+                               &std::strtod);
+}
+
+float toFloatValue(const ScannedNumber& number)
+{
+    return roundNumber<float>(number,
+                              MAX_EXACT_FLOAT_POWER,
+                              FLOAT_POWERS_OF_TEN,
+                              MAX_EXACT_FLOAT_INTEGER,
+                              &std::strtof);
+}
+
+// Parse all of 's', other than surrounding whitespace
+template <typename T>
+T toValue(const std::string& s,
+          T (*convert)(const ScannedNumber&),
+          const std::string& typeName)
+{
+    const char* begin = s.c_str();
+    const char* end = begin + s.size();
+    while (begin != end && std::isspace(static_cast<unsigned char>(*begin)))
+    {
+        ++begin;
+    }
+    while (end != begin && std::isspace(static_cast<unsigned char>(end[-1])))
+    {
+        --end;
+    }
+
+    ScannedNumber number;
+    if (begin == end || scanNumber(begin, end, number) != end)
+    {
+        throw except::BadCastException(Ctxt(
+                "Conversion failed: '" + s + "' -> " + typeName));
+    }
+
+    const T value = convert(number);
+    if (number.kind == FINITE &&
+        std::abs(value) == std::numeric_limits<T>::infinity())
+    {
+        throw except::BadCastException(Ctxt(
+                "Overflow: '" + s + "' -> " + typeName));
+    }
+    return value;
+}
+
+// Print the significant digits of a nonnegative value, and the decimal
+// exponent of the first one.  The C library rounds correctly.  The only
+// locale-dependent part of its output is the decimal point, which gets
+// skipped over.
+void printDigits(double value,
+                 int precision,
+                 std::string& digits,
+                 int& exponent)
+{
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%.*e", precision - 1, value);
+
+    digits.clear();
+    const char* ptr = buffer;
+    for (; *ptr != 'e'; ++ptr)
+    {
+        if (isDigit(*ptr))
+        {
+            digits += *ptr;
+        }
+    }
+    exponent = std::atoi(ptr + 1);
+}
+
+// Round already-printed digits to fewer of them.  That's only the same as
+// rounding the value itself if the digits being dropped aren't exactly
+// half of the last digit kept, so ties are left to printDigits().
+bool roundDigits(const std::string& digits,
+                 size_t precision,
+                 std::string& rounded,
+                 int& exponent)
+{
+    const char next = digits[precision];
+    if (next == '5' &&
+        digits.find_first_not_of('0', precision + 1) == std::string::npos)
+    {
+        return false;
+    }
+
+    rounded.assign(digits, 0, precision);
+    if (next >= '5')
+    {
+        size_t ii = precision;
+        for (; ii > 0 && rounded[ii - 1] == '9'; --ii)
+        {
+            rounded[ii - 1] = '0';
+        }
+
+        if (ii == 0)
+        {
+            // 999... -> 1000...
+            rounded.insert(rounded.begin(), '1');
+            rounded.resize(precision);
+            ++exponent;
+        }
+        else
+        {
+            ++rounded[ii - 1];
+        }
+    }
+    return true;
+}
+
+template <typename T>
+bool roundTrips(const std::string& digits,
+                int exponent,
+                T value,
+                T (*convert)(const ScannedNumber&))
+{
+    ScannedNumber number;
+    number.kind = FINITE;
+    number.negative = false;
+    number.mantissa = 0;
+    number.truncated = false;
+    for (size_t ii = 0; ii < digits.size(); ++ii)
+    {
+        number.mantissa = number.mantissa * 10 + (digits[ii] - '0');
+    }
+    number.exponent = exponent - static_cast<int>(digits.size()) + 1;
+    number.digitsBegin = digits.c_str();
+    number.digitsEnd = digits.c_str() + digits.size();
+    number.digitsExponent = number.exponent;
+
+    return convert(number) == value;
+}
+
+// Find the fewest digits that parse back to 'value'.  For normal numbers,
+// every round-trip representation with digits10 digits or fewer shows up
+// as digits10 digits with trailing zeros, so there's no need to try any
+// fewer.  All of the candidates come from a single max_digits10 printout.
+// Subnormals have fewer bits of precision, so they start from one digit.
+template <typename T>
+std::string format(T value, T (*convert)(const ScannedNumber&))
+{
+    if (value != value)
+    {
+        return "NaN";
+    }
+
+    const T absValue = std::abs(value);
+    if (absValue == std::numeric_limits<T>::infinity())
+    {
+        return (value < 0) ? "-INF" : "INF";
+    }
+
+    std::string digits;
+    int exponent = 0;
+    if (absValue < std::numeric_limits<T>::min())
+    {
+        for (int precision = 1;
+             precision <= std::numeric_limits<T>::max_digits10;
+             ++precision)
+        {
+            printDigits(absValue, precision, digits, exponent);
+            if (roundTrips(digits, exponent, absValue, convert))
+            {
+                break;
+            }
+        }
+    }
+    else
+    {
+        printDigits(absValue, std::numeric_limits<T>::max_digits10,
+                    digits, exponent);
+
+        std::string rounded;
+        for (int precision = std::numeric_limits<T>::digits10;
+             precision < std::numeric_limits<T>::max_digits10;
+             ++precision)
+        {
+            int roundedExponent = exponent;
+            if (!roundDigits(digits, precision, rounded, roundedExponent))
+            {
+                printDigits(absValue, precision, rounded, roundedExponent);
+            }
+
+            if (roundTrips(rounded, roundedExponent, absValue, convert))
+            {
+                digits.swap(rounded);
+                exponent = roundedExponent;
+                break;
+            }
+        }
+    }
+
+    const size_t lastNonzero = digits.find_last_not_of('0');
+    digits.resize(lastNonzero == std::string::npos ? 1 : lastNonzero + 1);
+    if (digits == "0")
+    {
+        exponent = 0;
+    }
+
+    std::string str;
+    str.reserve(digits.size() + 8);
+    if (std::signbit(value))
+    {
+        str += '-';
+    }
+    str += digits[0];
+    if (digits.size() > 1)
+    {
+        str += '.';
+        str.append(digits, 1, std::string::npos);
+    }
+    str += 'E';
+    if (exponent < 0)
+    {
+        str += '-';
+        exponent = -exponent;
+    }
+    if (exponent < 10)
+    {
+        str += '0';
+    }
+    appendInt(exponent, str);
+    return str;
+}
+}
+
+namespace six
+{
+std::string formatDouble(double value)
+{
+    return format<double>(value, &toDoubleValue);
+}
+
+std::string formatFloat(float value)
+{
+    return format<float>(value, &toFloatValue);
+}
+
+const char* scanDouble(const char* begin, const char* end, double& value)
+{
+    ScannedNumber number;
+    const char* const ptr = scanNumber(begin, end, number);
+    if (ptr != begin)
+    {
+        value = toDoubleValue(number);
+    }
+    return ptr;
+}
+
+double toDouble(const std::string& s)
+{
+    return toValue<double>(s, &toDoubleValue, "double");
+}
+
+float toFloat(const std::string& s)
+{
+    return toValue<float>(s, &toFloatValue, "float");
+}
+}
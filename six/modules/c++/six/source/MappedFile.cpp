@@ -0,0 +1,159 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <sstream>
+
+#include <sys/OS.h>
+#include <except/Exception.h>
+#include <six/MappedFile.h>
+
+#if !defined(WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+// Mappings have to start on a multiple of this
+size_t getMapGranularity()
+{
+#if defined(WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwAllocationGranularity;
+#else
+    return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+}
+
+namespace six
+{
+MappedFile::MappedFile(const std::string& pathname) :
+    mBase(NULL),
+    mMappedSize(0),
+    mData(NULL),
+    mSize(0)
+{
+    map(pathname, 0, static_cast<size_t>(sys::OS().getSize(pathname)));
+}
+
+MappedFile::MappedFile(const std::string& pathname,
+                       sys::Off_T offset,
+                       size_t size) :
+    mBase(NULL),
+    mMappedSize(0),
+    mData(NULL),
+    mSize(0)
+{
+    map(pathname, offset, size);
+}
+
+MappedFile::~MappedFile()
+{
+    if (mBase)
+    {
+#if defined(WIN32)
+        UnmapViewOfFile(mBase);
+#else
+        munmap(mBase, mMappedSize);
+#endif
+    }
+}
+
+void MappedFile::map(const std::string& pathname,
+                     sys::Off_T offset,
+                     size_t size)
+{
+    const sys::Off_T fileSize = sys::OS().getSize(pathname);
+    if (offset < 0 || offset + static_cast<sys::Off_T>(size) > fileSize)
+    {
+        std::ostringstream ostr;
+        ostr << "Cannot map " << size << " bytes at offset " << offset
+             << " of " << pathname << " which is only " << fileSize
+             << " bytes";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+
+    mSize = size;
+    if (size == 0)
+    {
+        return;
+    }
+
+    // Round the start of the mapping down to the granularity the OS wants
+    const sys::Off_T granularity =
+            static_cast<sys::Off_T>(getMapGranularity());
+    const sys::Off_T mapOffset = (offset / granularity) * granularity;
+    const size_t leading = static_cast<size_t>(offset - mapOffset);
+    mMappedSize = leading + size;
+
+#if defined(WIN32)
+    HANDLE file = CreateFile(pathname.c_str(), GENERIC_READ,
+                             FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw except::Exception(Ctxt("Unable to open " + pathname));
+    }
+
+    HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL)
+    {
+        throw except::Exception(Ctxt("Unable to map " + pathname));
+    }
+
+    const sys::Uint64_T mapOffset64 = static_cast<sys::Uint64_T>(mapOffset);
+    mBase = MapViewOfFile(mapping, FILE_MAP_READ,
+                          static_cast<DWORD>(mapOffset64 >> 32),
+                          static_cast<DWORD>(mapOffset64 & 0xFFFFFFFF),
+                          mMappedSize);
+
+    // The view keeps the mapping alive
+    CloseHandle(mapping);
+    if (mBase == NULL)
+    {
+        throw except::Exception(Ctxt("Unable to map " + pathname));
+    }
+#else
+    const int fd = ::open(pathname.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw except::Exception(Ctxt("Unable to open " + pathname));
+    }
+
+    void* const base = mmap(NULL, mMappedSize, PROT_READ, MAP_SHARED,
+                            fd, mapOffset);
+
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+    if (base == MAP_FAILED)
+    {
+        throw except::Exception(Ctxt("Unable to map " + pathname));
+    }
+    mBase = base;
+#endif
+
+    mData = static_cast<const sys::ubyte*>(mBase) + leading;
+}
+}
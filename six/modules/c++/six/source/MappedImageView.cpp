@@ -0,0 +1,194 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+
+#include <str/Manip.h>
+#include <sys/Conf.h>
+#include <six/MappedImageView.h>
+
+namespace six
+{
+MappedImageView::MappedImageView(const NITFReadControl& reader,
+                                 const std::string& pathname,
+                                 size_t imageNumber)
+{
+    initialize(reader, pathname, imageNumber);
+}
+
+MappedImageView::MappedImageView(const std::string& pathname,
+                                 size_t imageNumber,
+                                 const std::vector<std::string>& schemaPaths) :
+    mReader(new NITFReadControl())
+{
+    mReader->load(pathname, schemaPaths);
+    initialize(*mReader, pathname, imageNumber);
+}
+
+void MappedImageView::initialize(const NITFReadControl& reader,
+                                 const std::string& pathname,
+                                 size_t imageNumber)
+{
+    const NITFImageInfo& info = reader.getImageInfo(imageNumber);
+    mData = info.getData();
+    mNumRows = mData->getNumRows();
+    mNumCols = mData->getNumCols();
+    mNumBytesPerPixel = mData->getNumBytesPerPixel();
+    mNumBytesPerElement = info.getNumBitsPerPixel() / 8;
+    mNeedsByteSwap = (mNumBytesPerElement > 1 && !sys::isBigEndianSystem());
+
+    mFile.reset(new MappedFile(pathname));
+
+    nitf::Record record = reader.getRecord();
+    const sys::Uint64_T fileLength = record.getHeader().getFileLength();
+    if (fileLength != mFile->getSize())
+    {
+        throw except::Exception(Ctxt(
+                pathname + " is not the file that was read"));
+    }
+
+    const std::vector<NITFSegmentInfo> imageSegments =
+            info.getImageSegments();
+    mSegments.resize(imageSegments.size());
+    for (size_t ii = 0; ii < imageSegments.size(); ++ii)
+    {
+        nitf::ImageSegment imageSegment =
+                record.getImages()[info.getStartIndex() + ii];
+        nitf::ImageSubheader subheader = imageSegment.getSubheader();
+
+        const std::string segmentName = "Image segment " +
+                str::toString(info.getStartIndex() + ii);
+
+        std::string compression = subheader.getImageCompression().toString();
+        str::trim(compression);
+        if (compression != "NC")
+        {
+            throw except::Exception(Ctxt(
+                    segmentName + " is compressed (IC = " + compression +
+                    ") and can't be mapped"));
+        }
+
+        if (static_cast<nitf::Uint32>(subheader.getNumBlocksPerRow()) > 1 ||
+            static_cast<nitf::Uint32>(subheader.getNumBlocksPerCol()) > 1)
+        {
+            throw except::Exception(Ctxt(
+                    segmentName + " is blocked and can't be mapped"));
+        }
+
+        const std::string mode = subheader.getImageMode().toString();
+        if (static_cast<nitf::Uint32>(subheader.getNumImageBands()) > 1 &&
+            mode != "P")
+        {
+            throw except::Exception(Ctxt(
+                    segmentName + " is not pixel interleaved (IMODE = " +
+                    mode + ") and can't be mapped"));
+        }
+
+        // A single block can still be wider than the image, in which case
+        // each row is padded out to the block width
+        size_t blockCols = static_cast<nitf::Uint32>(
+                subheader.getNumPixelsPerHorizBlock());
+        if (blockCols == 0)
+        {
+            blockCols = mNumCols;
+        }
+
+        Segment& segment(mSegments[ii]);
+        segment.firstRow = imageSegments[ii].firstRow;
+        segment.numRows = imageSegments[ii].numRows;
+        segment.rowStride = blockCols * mNumBytesPerPixel;
+
+        const sys::Uint64_T offset = imageSegment.getImageOffset();
+        const sys::Uint64_T end = imageSegment.getImageEnd();
+        if (blockCols < mNumCols ||
+            end > mFile->getSize() ||
+            end - offset < segment.numRows * segment.rowStride)
+        {
+            throw except::Exception(Ctxt(
+                    segmentName + " has an unexpected size"));
+        }
+        segment.data = mFile->getData() + offset;
+    }
+}
+
+const MappedImageView::Segment&
+MappedImageView::getSegmentForRow(size_t row) const
+{
+    if (row >= mNumRows)
+    {
+        throw except::Exception(Ctxt(
+                "Row " + str::toString(row) + " is out of bounds"));
+    }
+
+    // Last segment that starts at or before the row
+    size_t first = 0;
+    size_t last = mSegments.size();
+    while (last - first > 1)
+    {
+        const size_t middle = first + (last - first) / 2;
+        if (mSegments[middle].firstRow <= row)
+        {
+            first = middle;
+        }
+        else
+        {
+            last = middle;
+        }
+    }
+    return mSegments[first];
+}
+
+void MappedImageView::readNative(size_t startRow,
+                                 size_t numRows,
+                                 size_t startCol,
+                                 size_t numCols,
+                                 UByte* buffer) const
+{
+    if (startRow + numRows > mNumRows || startRow > mNumRows)
+    {
+        throw except::Exception(Ctxt(
+                "Too many rows requested [" + str::toString(numRows) + "]"));
+    }
+    if (startCol + numCols > mNumCols || startCol > mNumCols)
+    {
+        throw except::Exception(Ctxt(
+                "Too many cols requested [" + str::toString(numCols) + "]"));
+    }
+
+    const size_t rowSize = numCols * mNumBytesPerPixel;
+    for (size_t row = startRow; row < startRow + numRows; ++row)
+    {
+        const UByte* const src = getRow(row) + startCol * mNumBytesPerPixel;
+        if (mNeedsByteSwap)
+        {
+            sys::byteSwap(src,
+                          static_cast<unsigned short>(mNumBytesPerElement),
+                          rowSize / mNumBytesPerElement,
+                          buffer);
+        }
+        else
+        {
+            memcpy(buffer, src, rowSize);
+        }
+        buffer += rowSize;
+    }
+}
+}
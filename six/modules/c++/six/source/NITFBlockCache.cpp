@@ -0,0 +1,129 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <mt/CriticalSection.h>
+#include "six/NITFBlockCache.h"
+
+namespace six
+{
+bool NITFBlockCache::Key::operator<(const Key& rhs) const
+{
+    if (segment != rhs.segment)
+    {
+        return segment < rhs.segment;
+    }
+    if (blockRow != rhs.blockRow)
+    {
+        return blockRow < rhs.blockRow;
+    }
+    return blockCol < rhs.blockCol;
+}
+
+NITFBlockCache::NITFBlockCache(size_t maxBytes) :
+    mMaxBytes(maxBytes),
+    mNumBytes(0),
+    mNumHits(0),
+    mNumMisses(0)
+{
+}
+
+NITFBlockCache::Block NITFBlockCache::get(const Key& key)
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    const std::map<Key, LRUList::iterator>::iterator it = mBlocks.find(key);
+    if (it == mBlocks.end())
+    {
+        ++mNumMisses;
+        return Block();
+    }
+
+    ++mNumHits;
+    mLRU.splice(mLRU.begin(), mLRU, it->second);
+    return it->second->second;
+}
+
+NITFBlockCache::Block NITFBlockCache::peek(const Key& key) const
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    const std::map<Key, LRUList::iterator>::const_iterator it =
+            mBlocks.find(key);
+    return (it == mBlocks.end()) ? Block() : it->second->second;
+}
+
+void NITFBlockCache::put(const Key& key, const Block& block)
+{
+    const size_t numBytes = block->size();
+    if (numBytes > mMaxBytes)
+    {
+        return;
+    }
+
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    const std::map<Key, LRUList::iterator>::iterator it = mBlocks.find(key);
+    if (it != mBlocks.end())
+    {
+        mNumBytes -= it->second->second->size();
+        mLRU.erase(it->second);
+        mBlocks.erase(it);
+    }
+
+    evict(numBytes);
+    mLRU.push_front(std::make_pair(key, block));
+    mBlocks.insert(std::make_pair(key, mLRU.begin()));
+    mNumBytes += numBytes;
+}
+
+void NITFBlockCache::evict(size_t numBytes)
+{
+    while (!mLRU.empty() && mNumBytes + numBytes > mMaxBytes)
+    {
+        mNumBytes -= mLRU.back().second->size();
+        mBlocks.erase(mLRU.back().first);
+        mLRU.pop_back();
+    }
+}
+
+void NITFBlockCache::clear()
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    mLRU.clear();
+    mBlocks.clear();
+    mNumBytes = 0;
+}
+
+size_t NITFBlockCache::getNumHits() const
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    return mNumHits;
+}
+
+size_t NITFBlockCache::getNumMisses() const
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    return mNumMisses;
+}
+
+size_t NITFBlockCache::getNumBytes() const
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    return mNumBytes;
+}
+}
@@ -20,8 +20,12 @@
  *
  */
 
+#include <string.h>
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
+#include <mt/CriticalSection.h>
 #include <six/NITFReadControl.h>
 #include <six/XMLControlFactory.h>
 #include <six/Utilities.h>
@@ -81,7 +85,9 @@ six::PixelType getPixelType(nitf::ImageSubheader& subheader)
 
 namespace six
 {
-NITFReadControl::NITFReadControl()
+NITFReadControl::NITFReadControl() :
+    mCacheTileDims(512, 512),
+    mCacheCompressionOptionsCreated(false)
 {
     // Make sure that if we use XML_DATA_CONTENT that we've loaded it into the
     // singleton PluginRegistry
@@ -599,6 +605,23 @@ NITFReadControl::getIndices(nitf::ImageSubheader& subheader) const
     return imageAndSegment;
 }
 
+bool NITFReadControl::isBandSequentialRead(size_t segmentIndex)
+{
+    nitf::ImageSegment segment = mRecord.getImages()[segmentIndex];
+    nitf::ImageSubheader subheader = segment.getSubheader();
+    const size_t numBands =
+            static_cast<nitf::Uint32>(subheader.getNumImageBands());
+    if (numBands != 2)
+    {
+        return false;
+    }
+
+    std::string subcategory =
+            subheader.getBandInfo(0).getSubcategory().toString();
+    str::trim(subcategory);
+    return subcategory != "I";
+}
+
 UByte* NITFReadControl::interleaved(Region& region, size_t imageNumber)
 {
     NITFImageInfo* thisImage = mInfos[imageNumber];
@@ -632,9 +655,6 @@ UByte* NITFReadControl::interleaved(Region& region, size_t imageNumber)
         throw except::Exception(Ctxt(FmtX("Too many cols requested [%d]",
                                           numColsReq)));
 
-    // Allocate one band
-    nitf::Uint32 bandList(0);
-
     nitf::Uint8* buffer = region.getBuffer();
 
     size_t subWindowSize = numRowsReq * numColsReq
@@ -646,12 +666,17 @@ UByte* NITFReadControl::interleaved(Region& region, size_t imageNumber)
         region.setBuffer(buffer);
     }
 
+    if (mBlockCache.get())
+    {
+        readCached(*thisImage, startRow, numRowsReq, startCol, numColsReq,
+                   buffer);
+        return buffer;
+    }
+
     // Do segmenting here
     nitf::SubWindow sw;
     sw.setStartCol(static_cast<nitf::Uint32>(startCol));
     sw.setNumCols(static_cast<nitf::Uint32>(numColsReq));
-    sw.setNumBands(1);
-    sw.setBandList(&bandList);
 
     std::vector < NITFSegmentInfo > imageSegments
             = thisImage->getImageSegments();
@@ -700,9 +725,8 @@ UByte* NITFReadControl::interleaved(Region& region, size_t imageNumber)
                 mCompressionOptions);
 
         nitf::Uint8* bufferPtr = buffer + totalRead;
-
-        int padded;
-        imageReader.read(sw, &bufferPtr, &padded);
+        readSubWindow(imageReader, startIndex + i, *thisImage->getData(), sw,
+                      bufferPtr);
         totalRead += numColsReq * nbpp * numRowsReqSeg;
         sw.setStartRow(0);
         numRowsLeft -= numRowsReqSeg;
@@ -711,6 +735,399 @@ UByte* NITFReadControl::interleaved(Region& region, size_t imageNumber)
     return buffer;
 }
 
+UByte* NITFReadControl::interleavedDecimated(Region& region,
+                                             size_t imageNumber,
+                                             const types::RowCol<size_t>& skip)
+{
+    if (skip.row == 0 || skip.col == 0)
+    {
+        throw except::Exception(Ctxt("Skip factors must be positive"));
+    }
+    if (skip.row == 1 && skip.col == 1)
+    {
+        return interleaved(region, imageNumber);
+    }
+
+    const Data& data = *getImageInfo(imageNumber).getData();
+    if (region.getNumRows() == -1)
+    {
+        region.setNumRows(data.getNumRows() - region.getStartRow());
+    }
+    if (region.getNumCols() == -1)
+    {
+        region.setNumCols(data.getNumCols() - region.getStartCol());
+    }
+
+    const size_t numRows = region.getNumRows();
+    const size_t numCols = region.getNumCols();
+    const size_t startRow = region.getStartRow();
+    const size_t startCol = region.getStartCol();
+    if (startRow + numRows > data.getNumRows() ||
+        startCol + numCols > data.getNumCols())
+    {
+        throw except::Exception(Ctxt("Region is outside of the image"));
+    }
+
+    const size_t nbpp = data.getNumBytesPerPixel();
+    const size_t numOutputRows = (numRows + skip.row - 1) / skip.row;
+    const size_t numOutputCols = (numCols + skip.col - 1) / skip.col;
+
+    UByte* buffer = region.getBuffer();
+    if (buffer == NULL)
+    {
+        buffer = new UByte[numOutputRows * numOutputCols * nbpp];
+        region.setBuffer(buffer);
+    }
+
+    // Rows that can't be skipped by NITRO are read whole, then their
+    // columns are skipped here
+    std::vector<UByte> rowBuffer(skip.col == 1 ? 0 : numCols * nbpp);
+    const NITFImageInfo& info = *mInfos[imageNumber];
+    if (mBlockCache.get())
+    {
+        for (size_t row = 0; row < numOutputRows; ++row)
+        {
+            UByte* const outputRow = buffer + row * numOutputCols * nbpp;
+            readCached(info, startRow + row * skip.row, 1, startCol, numCols,
+                       rowBuffer.empty() ? outputRow : &rowBuffer[0]);
+            if (!rowBuffer.empty())
+            {
+                skipColumns(&rowBuffer[0], numOutputCols, skip.col, nbpp,
+                            outputRow);
+            }
+        }
+        return buffer;
+    }
+
+    // One ImageReader per segment reads all of its kept rows
+    const std::vector<NITFSegmentInfo> imageSegments =
+            info.getImageSegments();
+    const size_t startIndex = info.getStartIndex();
+    createCompressionOptions(mCompressionOptions);
+    size_t row = 0;
+    for (size_t seg = 0;
+         seg < imageSegments.size() && row < numOutputRows;
+         ++seg)
+    {
+        const size_t segFirstRow = imageSegments[seg].firstRow;
+        const size_t segEndRow = segFirstRow + imageSegments[seg].numRows;
+        if (startRow + row * skip.row >= segEndRow)
+        {
+            continue;
+        }
+
+        const size_t segmentIndex = startIndex + seg;
+        nitf::ImageReader imageReader = mReader.newImageReader(
+                static_cast<int>(segmentIndex), mCompressionOptions);
+
+        // The PixelSkip has to outlive the SubWindow that references it
+        const bool nitroSkips = skip.col > 1 &&
+                canSkipColumns(segmentIndex, nbpp, skip.col);
+        nitf::PixelSkip pixelSkip(1, static_cast<nitf::Uint32>(skip.col));
+        nitf::SubWindow sw;
+        sw.setStartCol(static_cast<nitf::Uint32>(startCol));
+        sw.setNumCols(static_cast<nitf::Uint32>(
+                nitroSkips ? numOutputCols : numCols));
+        sw.setNumRows(1);
+        if (nitroSkips)
+        {
+            sw.setDownSampler(&pixelSkip);
+        }
+
+        for (; row < numOutputRows; ++row)
+        {
+            const size_t fileRow = startRow + row * skip.row;
+            if (fileRow >= segEndRow)
+            {
+                break;
+            }
+
+            UByte* const outputRow = buffer + row * numOutputCols * nbpp;
+            const bool readDirectly = skip.col == 1 || nitroSkips;
+            sw.setStartRow(static_cast<nitf::Uint32>(fileRow - segFirstRow));
+            readSubWindow(imageReader, segmentIndex, data, sw,
+                          readDirectly ? outputRow : &rowBuffer[0]);
+            if (!readDirectly)
+            {
+                skipColumns(&rowBuffer[0], numOutputCols, skip.col, nbpp,
+                            outputRow);
+            }
+        }
+    }
+
+    return buffer;
+}
+
+bool NITFReadControl::canSkipColumns(size_t segmentIndex,
+                                     size_t numBytesPerPixel,
+                                     size_t colSkip)
+{
+    // NITRO skips whole pixels of these sizes.  It can't skip past the
+    // end of a block, and it skips bands read separately independently.
+    if (isBandSequentialRead(segmentIndex) ||
+        (numBytesPerPixel != 1 && numBytesPerPixel != 2 &&
+         numBytesPerPixel != 4 && numBytesPerPixel != 8 &&
+         numBytesPerPixel != 16))
+    {
+        return false;
+    }
+
+    nitf::ImageSegment segment = mRecord.getImages()[segmentIndex];
+    nitf::ImageSubheader subheader = segment.getSubheader();
+    const size_t numBlocksPerRow =
+            static_cast<nitf::Uint32>(subheader.getNumBlocksPerRow());
+    const size_t numColsPerBlock = (numBlocksPerRow == 1) ?
+            static_cast<nitf::Uint32>(subheader.getNumCols()) :
+            static_cast<nitf::Uint32>(subheader.getNumPixelsPerHorizBlock());
+    return colSkip <= numColsPerBlock;
+}
+
+void NITFReadControl::skipColumns(const UByte* input,
+                                  size_t numOutputCols,
+                                  size_t colSkip,
+                                  size_t numBytesPerPixel,
+                                  UByte* output)
+{
+    for (size_t col = 0; col < numOutputCols; ++col)
+    {
+        memcpy(output + col * numBytesPerPixel,
+               input + col * colSkip * numBytesPerPixel,
+               numBytesPerPixel);
+    }
+}
+
+void NITFReadControl::readSubWindow(nitf::ImageReader& imageReader,
+                                    size_t segmentIndex,
+                                    const Data& data,
+                                    nitf::SubWindow& subWindow,
+                                    UByte* buffer)
+{
+    int padded;
+    if (!isBandSequentialRead(segmentIndex))
+    {
+        nitf::Uint32 bandList(0);
+        subWindow.setNumBands(1);
+        subWindow.setBandList(&bandList);
+        imageReader.read(subWindow, &buffer, &padded);
+        subWindow.setBandList(NULL);
+        return;
+    }
+
+    // NITRO only presents the two bands as a single band of whole
+    // pixels when they're I and Q, so read each band separately
+    // and interleave them here
+    const size_t nbpp = data.getNumBytesPerPixel();
+    const size_t numBands = data.getNumChannels();
+    const size_t bandBytes = nbpp / numBands;
+    const size_t numPixels = static_cast<size_t>(subWindow.getNumCols()) *
+            subWindow.getNumRows();
+    std::vector<nitf::Uint32> bandList(numBands);
+    std::vector<nitf::Uint8> scratch(numPixels * nbpp);
+    std::vector<nitf::Uint8*> bandPtrs(numBands);
+    for (size_t band = 0; band < numBands; ++band)
+    {
+        bandList[band] = static_cast<nitf::Uint32>(band);
+        bandPtrs[band] = &scratch[band * numPixels * bandBytes];
+    }
+    subWindow.setNumBands(static_cast<nitf::Uint32>(numBands));
+    subWindow.setBandList(&bandList[0]);
+    imageReader.read(subWindow, &bandPtrs[0], &padded);
+    subWindow.setNumBands(0);
+    subWindow.setBandList(NULL);
+
+    for (size_t pixel = 0; pixel < numPixels; ++pixel)
+    {
+        for (size_t band = 0; band < numBands; ++band)
+        {
+            memcpy(buffer + (pixel * numBands + band) * bandBytes,
+                   bandPtrs[band] + pixel * bandBytes,
+                   bandBytes);
+        }
+    }
+}
+
+void NITFReadControl::enableBlockCache(size_t maxBytes,
+                                       const types::RowCol<size_t>& tileDims)
+{
+    if (tileDims.area() == 0)
+    {
+        throw except::Exception(Ctxt("Cached tiles must not be empty"));
+    }
+
+    mBlockCache.reset(new NITFBlockCache(maxBytes));
+    mCacheTileDims = tileDims;
+}
+
+void NITFReadControl::disableBlockCache()
+{
+    mBlockCache.reset();
+
+    mt::CriticalSection<sys::Mutex> lock(&mCacheReadMutex);
+    mImageReaders.clear();
+}
+
+types::RowCol<size_t>
+NITFReadControl::getBlockDims(size_t segmentIndex)
+{
+    nitf::ImageSegment segment = mRecord.getImages()[segmentIndex];
+    nitf::ImageSubheader subheader = segment.getSubheader();
+
+    const size_t numBlocksPerRow =
+            static_cast<nitf::Uint32>(subheader.getNumBlocksPerRow());
+    const size_t numBlocksPerCol =
+            static_cast<nitf::Uint32>(subheader.getNumBlocksPerCol());
+    if (numBlocksPerRow > 1 || numBlocksPerCol > 1)
+    {
+        // Reading anything less than a whole block means decoding it
+        // again later
+        return types::RowCol<size_t>(
+                static_cast<nitf::Uint32>(
+                        subheader.getNumPixelsPerVertBlock()),
+                static_cast<nitf::Uint32>(
+                        subheader.getNumPixelsPerHorizBlock()));
+    }
+    return mCacheTileDims;
+}
+
+void NITFReadControl::readCached(const NITFImageInfo& info,
+                                 size_t startRow,
+                                 size_t numRows,
+                                 size_t startCol,
+                                 size_t numCols,
+                                 UByte* buffer)
+{
+    const Data& data = *info.getData();
+    const size_t nbpp = data.getNumBytesPerPixel();
+    const size_t numColsTotal = data.getNumCols();
+    const size_t endRow = startRow + numRows;
+    const size_t endCol = startCol + numCols;
+    const std::vector<NITFSegmentInfo> imageSegments =
+            info.getImageSegments();
+
+    for (size_t ii = 0; ii < imageSegments.size(); ++ii)
+    {
+        const size_t segmentFirstRow = imageSegments[ii].firstRow;
+        const size_t segmentEndRow =
+                segmentFirstRow + imageSegments[ii].numRows;
+        if (segmentEndRow <= startRow || segmentFirstRow >= endRow)
+        {
+            continue;
+        }
+
+        const size_t segmentIndex = info.getStartIndex() + ii;
+        const types::RowCol<size_t> blockDims = getBlockDims(segmentIndex);
+
+        // Rows within the segment
+        const size_t firstRow =
+                std::max(startRow, segmentFirstRow) - segmentFirstRow;
+        const size_t lastRow =
+                std::min(endRow, segmentEndRow) - segmentFirstRow;
+
+        for (size_t blockRow = firstRow / blockDims.row;
+             blockRow * blockDims.row < lastRow;
+             ++blockRow)
+        {
+            for (size_t blockCol = startCol / blockDims.col;
+                 blockCol * blockDims.col < endCol;
+                 ++blockCol)
+            {
+                const types::RowCol<size_t> blockOffset(
+                        blockRow * blockDims.row,
+                        blockCol * blockDims.col);
+                const types::RowCol<size_t> blockExtent(
+                        std::min(blockDims.row,
+                                 imageSegments[ii].numRows - blockOffset.row),
+                        std::min(blockDims.col,
+                                 numColsTotal - blockOffset.col));
+
+                const NITFBlockCache::Block block = getBlock(
+                        data,
+                        segmentIndex,
+                        NITFBlockCache::Key(segmentIndex, blockRow, blockCol),
+                        blockOffset,
+                        blockExtent);
+
+                // Copy the part of the block that was asked for
+                const size_t copyFirstRow =
+                        std::max(firstRow, blockOffset.row);
+                const size_t copyLastRow =
+                        std::min(lastRow, blockOffset.row + blockExtent.row);
+                const size_t copyFirstCol =
+                        std::max(startCol, blockOffset.col);
+                const size_t copyLastCol =
+                        std::min(endCol, blockOffset.col + blockExtent.col);
+                const size_t copyBytes = (copyLastCol - copyFirstCol) * nbpp;
+
+                for (size_t row = copyFirstRow; row < copyLastRow; ++row)
+                {
+                    const UByte* const src = &(*block)[0] +
+                            ((row - blockOffset.row) * blockExtent.col +
+                             copyFirstCol - blockOffset.col) * nbpp;
+                    UByte* const dest = buffer +
+                            ((row + segmentFirstRow - startRow) * numCols +
+                             copyFirstCol - startCol) * nbpp;
+                    memcpy(dest, src, copyBytes);
+                }
+            }
+        }
+    }
+}
+
+NITFBlockCache::Block
+NITFReadControl::getBlock(const Data& data,
+                          size_t segmentIndex,
+                          const NITFBlockCache::Key& key,
+                          const types::RowCol<size_t>& blockOffset,
+                          const types::RowCol<size_t>& blockExtent)
+{
+    NITFBlockCache::Block block = mBlockCache->get(key);
+    if (block.get())
+    {
+        return block;
+    }
+
+    mt::CriticalSection<sys::Mutex> lock(&mCacheReadMutex);
+
+    // Another thread may have read it while we were waiting
+    block = mBlockCache->peek(key);
+    if (block.get())
+    {
+        return block;
+    }
+
+    if (!mCacheCompressionOptionsCreated)
+    {
+        createCompressionOptions(mCompressionOptions);
+        mCacheCompressionOptionsCreated = true;
+    }
+
+    std::map<size_t, nitf::ImageReader>::iterator readerIt =
+            mImageReaders.find(segmentIndex);
+    if (readerIt == mImageReaders.end())
+    {
+        readerIt = mImageReaders.insert(std::make_pair(
+                segmentIndex,
+                mReader.newImageReader(static_cast<int>(segmentIndex),
+                                       mCompressionOptions))).first;
+    }
+
+    std::vector<UByte>* const blockData =
+            new std::vector<UByte>(blockExtent.area() *
+                                   data.getNumBytesPerPixel());
+    block.reset(blockData);
+
+    nitf::SubWindow subWindow;
+    subWindow.setStartRow(static_cast<nitf::Uint32>(blockOffset.row));
+    subWindow.setNumRows(static_cast<nitf::Uint32>(blockExtent.row));
+    subWindow.setStartCol(static_cast<nitf::Uint32>(blockOffset.col));
+    subWindow.setNumCols(static_cast<nitf::Uint32>(blockExtent.col));
+    readSubWindow(readerIt->second, segmentIndex, data, subWindow,
+                  &(*blockData)[0]);
+
+    mBlockCache->put(key, block);
+    return block;
+}
+
 std::auto_ptr<Legend> NITFReadControl::findLegend(size_t productNum)
 {
     std::auto_ptr<Legend> legend;
@@ -788,6 +1205,14 @@ void NITFReadControl::reset()
         delete mInfos[ii];
     }
     mInfos.clear();
+
+    if (mBlockCache.get())
+    {
+        mBlockCache->clear();
+    }
+    mImageReaders.clear();
+    mCacheCompressionOptionsCreated = false;
+
     mInterface.reset();
 }
 
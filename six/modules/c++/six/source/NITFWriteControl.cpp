@@ -20,31 +20,144 @@
  *
  */
 
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
 
 #include <io/ByteStream.h>
 #include <math/Round.h>
 #include <mem/ScopedArray.h>
+#include <sys/File.h>
+#include <sys/OS.h>
+#include <six/ByteProvider.h>
 #include <six/NITFWriteControl.h>
+#include <six/ThreadPool.h>
 #include <six/XMLControlFactory.h>
 #include <nitf/IOStreamWriter.hpp>
 
+namespace
+{
+// Writes a band of rows directly to where they go in the output file.
+// Each band opens the file itself, so the bands can be written at the same
+// time without sharing a file offset.
+class RowBandWriter : public sys::Runnable
+{
+public:
+    RowBandWriter(const std::string& pathname,
+                  const six::UByte* imageData,
+                  const std::vector<six::NITFSegmentInfo>& segments,
+                  const std::vector<nitf::Off>& imageDataOffsets,
+                  size_t numBytesPerRow,
+                  size_t byteSwapSize,
+                  size_t maxRowsPerWrite,
+                  size_t startRow,
+                  size_t numRows) :
+        mPathname(pathname),
+        mImageData(imageData),
+        mSegments(segments),
+        mImageDataOffsets(imageDataOffsets),
+        mNumBytesPerRow(numBytesPerRow),
+        mByteSwapSize(byteSwapSize),
+        mMaxRowsPerWrite(maxRowsPerWrite),
+        mStartRow(startRow),
+        mNumRows(numRows)
+    {
+    }
+
+    virtual void run()
+    {
+        sys::File file(mPathname,
+                       sys::File::READ_AND_WRITE,
+                       sys::File::EXISTING);
+
+        std::vector<six::UByte> swapped;
+        if (mByteSwapSize > 1)
+        {
+            swapped.resize(std::min(mMaxRowsPerWrite, mNumRows) *
+                           mNumBytesPerRow);
+        }
+
+        for (size_t seg = 0; seg < mSegments.size(); ++seg)
+        {
+            size_t firstRow;
+            size_t numRows;
+            if (!mSegments[seg].isInRange(mStartRow, mNumRows,
+                                          firstRow, numRows))
+            {
+                continue;
+            }
+
+            const size_t endRow = firstRow + numRows;
+            for (size_t row = firstRow; row < endRow; row += mMaxRowsPerWrite)
+            {
+                const size_t numBytes =
+                        std::min(mMaxRowsPerWrite, endRow - row) *
+                        mNumBytesPerRow;
+                const six::UByte* pixels = mImageData + row * mNumBytesPerRow;
+                if (!swapped.empty())
+                {
+                    sys::byteSwap(pixels,
+                                  static_cast<unsigned short>(mByteSwapSize),
+                                  numBytes / mByteSwapSize,
+                                  &swapped[0]);
+                    pixels = &swapped[0];
+                }
+
+                file.seekTo(mImageDataOffsets[seg] +
+                                    static_cast<nitf::Off>(
+                                            row - mSegments[seg].firstRow) *
+                                    mNumBytesPerRow,
+                            sys::File::FROM_START);
+                file.writeFrom(pixels, numBytes);
+            }
+        }
+
+        file.close();
+    }
+
+private:
+    const std::string& mPathname;
+    const six::UByte* const mImageData;
+    const std::vector<six::NITFSegmentInfo>& mSegments;
+    const std::vector<nitf::Off>& mImageDataOffsets;
+    const size_t mNumBytesPerRow;
+    const size_t mByteSwapSize;
+    const size_t mMaxRowsPerWrite;
+    const size_t mStartRow;
+    const size_t mNumRows;
+};
+
+void writeAt(sys::File& file, nitf::Off offset,
+             const std::vector<sys::byte>& data)
+{
+    if (!data.empty())
+    {
+        file.seekTo(offset, sys::File::FROM_START);
+        file.writeFrom(&data[0], data.size());
+    }
+}
+}
+
 namespace six
 {
-NITFWriteControl::NITFWriteControl()
+const char NITFWriteControl::OPT_NUM_WRITE_THREADS[] = "NumWriteThreads";
+
+NITFWriteControl::NITFWriteControl() :
+    mThreadPool(NULL)
 {
     mNITFHeaderCreator.reset(new six::NITFHeaderCreator());
 }
 
-NITFWriteControl::NITFWriteControl(mem::SharedPtr<Container> container)
+NITFWriteControl::NITFWriteControl(mem::SharedPtr<Container> container) :
+    mThreadPool(NULL)
 {
     mNITFHeaderCreator.reset(new six::NITFHeaderCreator(container));
 }
 
 NITFWriteControl::NITFWriteControl(const six::Options& options,
                                    mem::SharedPtr<Container> container,
-                                   const XMLControlRegistry* xmlRegistry)
+                                   const XMLControlRegistry* xmlRegistry) :
+    mThreadPool(NULL)
 {
     mNITFHeaderCreator.reset(new six::NITFHeaderCreator(options, container));
     if (xmlRegistry)
@@ -230,6 +343,37 @@ void NITFWriteControl::save(const BufferList& imageData,
                             const std::string& outputFile,
                             const std::vector<std::string>& schemaPaths)
 {
+    size_t numThreads;
+    if (mThreadPool)
+    {
+        numThreads = mThreadPool->getNumThreads();
+    }
+    else
+    {
+        numThreads = getOptions().getParameter(
+                OPT_NUM_WRITE_THREADS, Parameter(1));
+        if (numThreads == 0)
+        {
+            numThreads = sys::OS().getNumCPUs();
+        }
+    }
+
+    if (numThreads > 1 && imageData.size() == 1 && canSaveInParallel())
+    {
+        if (mThreadPool)
+        {
+            saveInParallel(imageData[0], outputFile, schemaPaths,
+                           *mThreadPool);
+        }
+        else
+        {
+            ThreadPool threadPool(numThreads);
+            saveInParallel(imageData[0], outputFile, schemaPaths,
+                           threadPool);
+        }
+        return;
+    }
+
     const size_t bufferSize = getOptions().getParameter(
             WriteControl::OPT_BUFFER_SIZE,
             Parameter(NITFHeaderCreator::DEFAULT_BUFFER_SIZE));
@@ -378,6 +522,132 @@ void NITFWriteControl::save(const BufferList& imageData,
     addDataAndWrite(schemaPaths);
 }
 
+bool NITFWriteControl::canSaveInParallel()
+{
+    if (getInfos().size() != 1 ||
+        getContainer()->getLegend(0) != NULL ||
+        !getSegmentWriters().empty())
+    {
+        return false;
+    }
+
+    const double j2kCompression = getOptions().getParameter(
+            NITFHeaderCreator::OPT_J2K_COMPRESSION_BYTERATE, Parameter(0));
+    if (j2kCompression > 0.0001 && j2kCompression <= 1.0)
+    {
+        return false;
+    }
+
+    const NITFImageInfo& info = *getInfos()[0];
+    const std::vector<NITFSegmentInfo> imageSegments =
+            info.getImageSegments();
+    for (size_t ii = 0; ii < imageSegments.size(); ++ii)
+    {
+        nitf::ImageSegment imageSegment =
+                getRecord().getImages()[info.getStartIndex() + ii];
+        nitf::ImageSubheader subheader = imageSegment.getSubheader();
+        if (static_cast<nitf::Uint32>(subheader.getNumBlocksPerRow()) > 1 ||
+            static_cast<nitf::Uint32>(subheader.getNumBlocksPerCol()) > 1)
+        {
+            return false;
+        }
+    }
+
+    createCompressionOptions(mCompressionOptions);
+    return mCompressionOptions.empty();
+}
+
+void NITFWriteControl::saveInParallel(
+        const UByte* imageData,
+        const std::string& outputFile,
+        const std::vector<std::string>& schemaPaths,
+        ThreadPool& threadPool)
+{
+    // Lay out the whole file, headers and all, before writing anything
+    std::vector<std::string> xmlStrings;
+    std::vector<nitf::ByteProvider::PtrAndLength> desData;
+    size_t numRowsPerBlock;
+    size_t numColsPerBlock;
+    ByteProvider::populateInitArgs(*this,
+                                   schemaPaths,
+                                   xmlStrings,
+                                   desData,
+                                   numRowsPerBlock,
+                                   numColsPerBlock);
+    nitf::Record record = getRecord();
+    const nitf::ByteProvider layout(record,
+                                    desData,
+                                    numRowsPerBlock,
+                                    numColsPerBlock);
+
+    const std::vector<std::vector<sys::byte> >& imageSubheaders =
+            layout.getImageSubheaders();
+    const std::vector<nitf::Off>& imageSubheaderOffsets =
+            layout.getImageSubheaderFileOffsets();
+    std::vector<nitf::Off> imageDataOffsets(imageSubheaders.size());
+    for (size_t ii = 0; ii < imageSubheaders.size(); ++ii)
+    {
+        imageDataOffsets[ii] = imageSubheaderOffsets[ii] +
+                imageSubheaders[ii].size();
+    }
+
+    // Make the file its final size so that each thread only has to fill
+    // in its own part of it
+    sys::File file(outputFile,
+                   sys::File::READ_AND_WRITE,
+                   sys::File::CREATE | sys::File::TRUNCATE);
+    const nitf::Off fileNumBytes = layout.getFileNumBytes();
+    if (fileNumBytes > 0)
+    {
+        const std::vector<sys::byte> lastByte(1, 0);
+        writeAt(file, fileNumBytes - 1, lastByte);
+    }
+
+    // Split the rows evenly across the threads.  Each one writes at most a
+    // buffer's worth at a time.
+    const NITFImageInfo& info = *getInfos()[0];
+    const std::vector<NITFSegmentInfo> imageSegments =
+            info.getImageSegments();
+    const Data& data = *info.getData();
+    const size_t numRows = data.getNumRows();
+    const size_t numBytesPerRow = data.getNumBytesPerPixel() *
+            data.getNumCols();
+    const size_t byteSwapSize = shouldByteSwap() ?
+            data.getNumBytesPerPixel() / data.getNumChannels() : 1;
+    const size_t bufferSize = getOptions().getParameter(
+            WriteControl::OPT_BUFFER_SIZE,
+            Parameter(NITFHeaderCreator::DEFAULT_BUFFER_SIZE));
+    const size_t maxRowsPerWrite =
+            std::max<size_t>(bufferSize / numBytesPerRow, 1);
+
+    const size_t numBands = threadPool.getNumChunks(numRows);
+    const size_t rowsPerBand = (numRows + numBands - 1) / numBands;
+    std::vector<RowBandWriter> bands;
+    for (size_t row = 0; row < numRows; row += rowsPerBand)
+    {
+        bands.push_back(RowBandWriter(outputFile,
+                                      imageData,
+                                      imageSegments,
+                                      imageDataOffsets,
+                                      numBytesPerRow,
+                                      byteSwapSize,
+                                      maxRowsPerWrite,
+                                      row,
+                                      std::min(rowsPerBand, numRows - row)));
+    }
+    threadPool.runEach(bands);
+
+    // Now that all the pixels are in place, fill in the headers and DES
+    writeAt(file, 0, layout.getFileHeader());
+    for (size_t ii = 0; ii < imageSubheaders.size(); ++ii)
+    {
+        writeAt(file, imageSubheaderOffsets[ii], imageSubheaders[ii]);
+    }
+    writeAt(file, layout.getDesSubheaderFileOffset(),
+            layout.getDesSubheaderAndData());
+    file.close();
+}
+
 void NITFWriteControl::addDataAndWrite(
         const std::vector<std::string>& schemaPaths)
 {
@@ -187,24 +187,21 @@ XMLElem SICommonXMLParser::createPolyXYZ(const std::string& name,
     size_t order = polyXYZ.order();
     XMLElem polyXML = newElement(name, getDefaultURI(), parent);
 
-    XMLElem xXML = newElement("X", getSICommonURI(), polyXML);
-    XMLElem yXML = newElement("Y", getSICommonURI(), polyXML);
-    XMLElem zXML = newElement("Z", getSICommonURI(), polyXML);
-
-    setAttribute(xXML, "order1", six::toString(order));
-    setAttribute(yXML, "order1", six::toString(order));
-    setAttribute(zXML, "order1", six::toString(order));
-
-    for (size_t ii = 0; ii <= order; ++ii)
+    // Each coordinate is finished before the next one is started, so this
+    // can be streamed
+    const char* const coordNames[] = { "X", "Y", "Z" };
+    for (size_t jj = 0; jj < 3; ++jj)
     {
-        Vector3 v3 = polyXYZ[ii];
-        XMLElem xCoefXML = createDouble("Coef", getSICommonURI(), v3[0], xXML);
-        XMLElem yCoefXML = createDouble("Coef", getSICommonURI(), v3[1], yXML);
-        XMLElem zCoefXML = createDouble("Coef", getSICommonURI(), v3[2], zXML);
-
-        setAttribute(xCoefXML, "exponent1", six::toString(ii));
-        setAttribute(yCoefXML, "exponent1", six::toString(ii));
-        setAttribute(zCoefXML, "exponent1", six::toString(ii));
+        XMLElem coordXML = newElement(coordNames[jj], getSICommonURI(),
+                                      polyXML);
+        setAttribute(coordXML, "order1", six::toString(order));
+
+        for (size_t ii = 0; ii <= order; ++ii)
+        {
+            XMLElem coefXML = createDouble("Coef", getSICommonURI(),
+                                           polyXYZ[ii][jj], coordXML);
+            setAttribute(coefXML, "exponent1", six::toString(ii));
+        }
     }
     return polyXML;
 }
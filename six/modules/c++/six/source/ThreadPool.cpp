@@ -0,0 +1,211 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <exception>
+#include <memory>
+
+#include <except/Exception.h>
+#include <six/ThreadPool.h>
+
+namespace six
+{
+//! The runnables from a single call to run()
+struct ThreadPool::Batch
+{
+    explicit Batch(const std::vector<sys::Runnable*>& runnables_) :
+        runnables(runnables_),
+        next(0),
+        numRemaining(runnables_.size())
+    {
+    }
+
+    const std::vector<sys::Runnable*>& runnables;
+
+    //! Index of the next runnable to claim
+    size_t next;
+
+    //! Number of runnables that have not finished
+    size_t numRemaining;
+
+    //! First exception thrown by a runnable
+    std::unique_ptr<except::Exception> error;
+};
+
+class ThreadPool::Worker : public sys::Runnable
+{
+public:
+    explicit Worker(ThreadPool& pool) :
+        mPool(pool)
+    {
+    }
+
+    virtual void run()
+    {
+        mPool.workerLoop();
+    }
+
+private:
+    ThreadPool& mPool;
+};
+
+ThreadPool::ThreadPool(size_t numThreads) :
+    mNumThreads(std::max<size_t>(numThreads, 1)),
+    mShutdown(false),
+    mWorkAvailable(&mMutex),
+    mBatchFinished(&mMutex)
+{
+    for (size_t ii = 1; ii < mNumThreads; ++ii)
+    {
+        mem::SharedPtr<sys::Thread> thread(new sys::Thread(new Worker(*this)));
+        mThreads.push_back(thread);
+        thread->start();
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    mMutex.lock();
+    mShutdown = true;
+    mWorkAvailable.broadcast();
+    mMutex.unlock();
+
+    for (size_t ii = 0; ii < mThreads.size(); ++ii)
+    {
+        mThreads[ii]->join();
+    }
+}
+
+size_t ThreadPool::getNumChunks(size_t numElements,
+                                size_t minElementsPerChunk) const
+{
+    const size_t maxChunks =
+            numElements / std::max<size_t>(minElementsPerChunk, 1);
+    return std::max<size_t>(std::min(mNumThreads, maxChunks), 1);
+}
+
+void ThreadPool::run(const std::vector<sys::Runnable*>& runnables)
+{
+    if (mThreads.empty() || runnables.size() <= 1)
+    {
+        for (size_t ii = 0; ii < runnables.size(); ++ii)
+        {
+            runnables[ii]->run();
+        }
+        return;
+    }
+
+    Batch batch(runnables);
+
+    mMutex.lock();
+    mQueue.push_back(&batch);
+    mWorkAvailable.broadcast();
+
+    // Help out until everything in this batch has been claimed
+    while (batch.next < batch.runnables.size())
+    {
+        std::deque<Batch*>::iterator it =
+                std::find(mQueue.begin(), mQueue.end(), &batch);
+        const size_t index = batch.next++;
+        if (batch.next == batch.runnables.size())
+        {
+            mQueue.erase(it);
+        }
+        mMutex.unlock();
+        execute(batch, index);
+    }
+
+    while (batch.numRemaining > 0)
+    {
+        mBatchFinished.wait();
+    }
+    mMutex.unlock();
+
+    if (batch.error.get())
+    {
+        throw *batch.error;
+    }
+}
+
+ThreadPool::Batch* ThreadPool::claimNext(size_t& index)
+{
+    Batch* const batch = mQueue.front();
+    index = batch->next++;
+    if (batch->next == batch->runnables.size())
+    {
+        mQueue.pop_front();
+    }
+    return batch;
+}
+
+void ThreadPool::execute(Batch& batch, size_t index)
+{
+    std::unique_ptr<except::Exception> error;
+    try
+    {
+        batch.runnables[index]->run();
+    }
+    catch (const except::Exception& ex)
+    {
+        error.reset(new except::Exception(ex));
+    }
+    catch (const std::exception& ex)
+    {
+        error.reset(new except::Exception(Ctxt(ex.what())));
+    }
+    catch (...)
+    {
+        error.reset(new except::Exception(Ctxt("Unknown exception")));
+    }
+
+    mMutex.lock();
+    if (error.get() && !batch.error.get())
+    {
+        batch.error.reset(error.release());
+    }
+    if (--batch.numRemaining == 0)
+    {
+        mBatchFinished.broadcast();
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    mMutex.lock();
+    while (true)
+    {
+        while (!mShutdown && mQueue.empty())
+        {
+            mWorkAvailable.wait();
+        }
+        if (mQueue.empty())
+        {
+            break;
+        }
+
+        size_t index(0);
+        Batch* const batch = claimNext(index);
+        mMutex.unlock();
+        execute(*batch, index);
+    }
+    mMutex.unlock();
+}
+}
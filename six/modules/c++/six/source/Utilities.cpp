@@ -106,19 +106,7 @@ std::string six::toString<float>(const float& value)
                 Ctxt("Attempted use of uninitialized float value"));
     }
 
-    std::ostringstream os;
-    size_t precision = std::numeric_limits<float>::max_digits10;
-    os << std::uppercase << std::scientific << std::setprecision(precision)
-       << value;
-    std::string strValue = os.str();
-
-    // remove any + in scientific notation to meet SICD XML standard
-    size_t plusPos = strValue.find("+");
-    if (plusPos != std::string::npos)
-    {
-        strValue.erase(plusPos, 1);
-    }
-    return strValue;
+    return formatFloat(value);
 }
 
 template <>
@@ -130,19 +118,19 @@ std::string six::toString<double>(const double& value)
                 Ctxt("Attempted use of uninitialized double value"));
     }
 
-    std::ostringstream os;
-    size_t precision = std::numeric_limits<double>::max_digits10;
-    os << std::uppercase << std::scientific << std::setprecision(precision)
-       << value;
-    std::string strValue = os.str();
+    return formatDouble(value);
+}
 
-    // remove any + in scientific notation to meet SICD XML standard
-    size_t plusPos = strValue.find("+");
-    if (plusPos != std::string::npos)
-    {
-        strValue.erase(plusPos, 1);
-    }
-    return strValue;
+template <>
+float six::toType<float>(const std::string& s)
+{
+    return toFloat(s);
+}
+
+template <>
+double six::toType<double>(const std::string& s)
+{
+    return toDouble(s);
 }
 
 template <>
@@ -1142,11 +1130,17 @@ std::auto_ptr<Data> six::parseData(const XMLControlRegistry& xmlReg,
                                    const std::vector<std::string>& schemaPaths,
                                    logging::Logger& log)
 {
+    // Hold onto the text so that it's validated as-is, rather than being
+    // printed back out of the DOM
+    io::StringStream xmlText;
+    xmlStream.streamTo(xmlText);
+    const std::string xml = xmlText.stream().str();
+
     xml::lite::MinidomParser xmlParser;
     xmlParser.preserveCharacterData(true);
     try
     {
-        xmlParser.parse(xmlStream);
+        xmlParser.parse(xmlText);
     }
     catch (const except::Throwable& ex)
     {
@@ -1174,7 +1168,7 @@ std::auto_ptr<Data> six::parseData(const XMLControlRegistry& xmlReg,
     const std::auto_ptr<XMLControl> xmlControl(
             xmlReg.newXMLControl(xmlDataType, &log));
 
-    return std::auto_ptr<Data>(xmlControl->fromXML(doc, schemaPaths));
+    return std::auto_ptr<Data>(xmlControl->fromXML(xml, doc, schemaPaths));
 }
 
 std::auto_ptr<Data> six::parseDataFromFile(
@@ -0,0 +1,157 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+
+#include <mt/CriticalSection.h>
+#include <mt/Singleton.h>
+#include <xml/lite/Validator.h>
+#include <six/ValidatorCache.h>
+
+namespace six
+{
+// Hands the validator back to the cache even if validation throws
+class ValidatorCache::Lease
+{
+public:
+    Lease(ValidatorCache& cache,
+          const Key& key,
+          xml::lite::ValidatorInterface* validator) :
+        mCache(cache),
+        mKey(key),
+        mValidator(validator)
+    {
+    }
+
+    ~Lease()
+    {
+        mCache.release(mKey, mValidator);
+    }
+
+    xml::lite::ValidatorInterface& operator*() const
+    {
+        return *mValidator;
+    }
+
+private:
+    ValidatorCache& mCache;
+    const Key& mKey;
+    xml::lite::ValidatorInterface* const mValidator;
+};
+
+ValidatorCache::ValidatorCache() :
+    mNumCompiled(0)
+{
+}
+
+ValidatorCache::~ValidatorCache()
+{
+    clear();
+}
+
+ValidatorCache& ValidatorCache::getInstance()
+{
+    return mt::Singleton<ValidatorCache, true>::getInstance();
+}
+
+bool ValidatorCache::validate(const std::string& xml,
+                              const std::string& xmlID,
+                              const std::vector<std::string>& schemaPaths,
+                              std::vector<xml::lite::ValidationInfo>& errors,
+                              logging::Logger* log)
+{
+    // The same paths in a different order compile to the same validator
+    Key key(schemaPaths);
+    std::sort(key.begin(), key.end());
+    key.erase(std::unique(key.begin(), key.end()), key.end());
+
+    xml::lite::ValidatorInterface* validator = acquire(key);
+    if (validator == NULL)
+    {
+        // Compile outside the lock so that other threads can keep
+        // validating in the meantime
+        validator = createValidator(key, log).release();
+
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        ++mNumCompiled;
+    }
+
+    const Lease lease(*this, key, validator);
+    return (*lease).validate(xml, xmlID, errors);
+}
+
+xml::lite::ValidatorInterface* ValidatorCache::acquire(const Key& key)
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    const std::map<Key, Validators>::iterator it = mIdle.find(key);
+    if (it == mIdle.end() || it->second.empty())
+    {
+        return NULL;
+    }
+
+    xml::lite::ValidatorInterface* const validator = it->second.back();
+    it->second.pop_back();
+    return validator;
+}
+
+void ValidatorCache::release(const Key& key,
+                             xml::lite::ValidatorInterface* validator)
+{
+    try
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        mIdle[key].push_back(validator);
+    }
+    catch (...)
+    {
+        delete validator;
+    }
+}
+
+void ValidatorCache::clear()
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    for (std::map<Key, Validators>::iterator it = mIdle.begin();
+         it != mIdle.end();
+         ++it)
+    {
+        for (size_t ii = 0; ii < it->second.size(); ++ii)
+        {
+            delete it->second[ii];
+        }
+    }
+    mIdle.clear();
+}
+
+size_t ValidatorCache::getNumCompiled() const
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    return mNumCompiled;
+}
+
+std::auto_ptr<xml::lite::ValidatorInterface>
+ValidatorCache::createValidator(const std::vector<std::string>& schemaPaths,
+                                logging::Logger* log) const
+{
+    return std::auto_ptr<xml::lite::ValidatorInterface>(
+            new xml::lite::Validator(schemaPaths, log, true));
+}
+}
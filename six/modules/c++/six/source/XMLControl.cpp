@@ -20,8 +20,12 @@
  *
  */
 
+#include <memory>
+
 #include <logging/NullLogger.h>
+#include <six/ValidatorCache.h>
 #include <six/XMLControl.h>
+#include <six/XMLControlFactory.h>
 
 namespace six
 {
@@ -65,10 +69,79 @@ void XMLControl::loadSchemaPaths(std::vector<std::string>& schemaPaths)
 void XMLControl::validate(const xml::lite::Document* doc,
                           const std::vector<std::string>& schemaPaths,
                           logging::Logger* log)
+{
+    std::vector<std::string> paths;
+    if (!getValidationPaths(schemaPaths, log, paths))
+    {
+        return;
+    }
+
+    if (doc->getRootElement()->getUri().empty())
+    {
+        throw six::DESValidationException(Ctxt(
+                "INVALID XML: URI is empty so document version cannot be "
+                "determined to use for validation"));
+    }
+
+    // Pretty-print so that lines numbers are useful
+    io::StringStream xmlStream;
+    doc->getRootElement()->prettyPrint(xmlStream);
+
+    validate(xmlStream.stream().str(), doc->getRootElement()->getUri(),
+             paths, log);
+}
+
+void XMLControl::validate(const std::string& xml,
+                          const std::string& uri,
+                          const std::vector<std::string>& schemaPaths,
+                          logging::Logger* log)
+{
+    std::vector<std::string> paths;
+    if (!getValidationPaths(schemaPaths, log, paths))
+    {
+        return;
+    }
+
+    if (uri.empty())
+    {
+        throw six::DESValidationException(Ctxt(
+                "INVALID XML: URI is empty so document version cannot be "
+                "determined to use for validation"));
+    }
+
+    std::vector<xml::lite::ValidationInfo> errors;
+    ValidatorCache::getInstance().validate(xml, uri, paths, errors, log);
+
+    // log any error found and throw
+    if (!errors.empty())
+    {
+        if (log)
+        {
+            for (size_t i = 0; i < errors.size(); ++i)
+            {
+                log->critical(errors[i].toString());
+            }
+        }
+
+        //! this is a unique error thrown only in this location --
+        //  if the user wants a file written regardless of the consequences
+        //  they can catch this error, clear the vector and SIX_SCHEMA_PATH
+        //  and attempt to rewrite the file. Continuing in this manner is
+        //  highly discouraged
+        throw six::DESValidationException(
+                Ctxt("INVALID XML: Check both the XML being "
+                     "produced and the schemas available"));
+    }
+}
+
+bool XMLControl::getValidationPaths(
+        const std::vector<std::string>& schemaPaths,
+        logging::Logger* log,
+        std::vector<std::string>& paths)
 {
     // attempt to get the schema location from the
     // environment if nothing is specified
-    std::vector<std::string> paths(schemaPaths);
+    paths = schemaPaths;
     loadSchemaPaths(paths);
 
     if (schemaPaths.empty() && log)
@@ -93,46 +166,7 @@ void XMLControl::validate(const xml::lite::Document* doc,
     }
 
     // validate against any specified schemas
-    if (!paths.empty())
-    {
-        xml::lite::Validator validator(paths, log, true);
-
-        std::vector<xml::lite::ValidationInfo> errors;
-
-        if (doc->getRootElement()->getUri().empty())
-        {
-            throw six::DESValidationException(Ctxt(
-                    "INVALID XML: URI is empty so document version cannot be "
-                    "determined to use for validation"));
-        }
-
-        // Pretty-print so that lines numbers are useful
-        io::StringStream xmlStream;
-        doc->getRootElement()->prettyPrint(xmlStream);
-
-        validator.validate(xmlStream, doc->getRootElement()->getUri(), errors);
-
-        // log any error found and throw
-        if (!errors.empty())
-        {
-            if (log)
-            {
-                for (size_t i = 0; i < errors.size(); ++i)
-                {
-                    log->critical(errors[i].toString());
-                }
-            }
-
-            //! this is a unique error thrown only in this location --
-            //  if the user wants a file written regardless of the consequences
-            //  they can catch this error, clear the vector and SIX_SCHEMA_PATH
-            //  and attempt to rewrite the file. Continuing in this manner is
-            //  highly discouraged
-            throw six::DESValidationException(
-                    Ctxt("INVALID XML: Check both the XML being "
-                         "produced and the schemas available"));
-        }
-    }
+    return !paths.empty();
 }
 
 void XMLControl::setLogger(logging::Logger* log, bool own)
@@ -201,6 +235,29 @@ xml::lite::Document* XMLControl::toXML(
     return doc;
 }
 
+void XMLControl::toXML(const Data* data,
+                       const std::vector<std::string>& schemaPaths,
+                       std::string& xml)
+{
+    const size_t offset = xml.size();
+    toXMLImpl(data, xml);
+
+    if (offset == 0)
+    {
+        validate(xml, getDefaultURI(*data), schemaPaths, mLog);
+    }
+    else
+    {
+        validate(xml.substr(offset), getDefaultURI(*data), schemaPaths, mLog);
+    }
+}
+
+void XMLControl::toXMLImpl(const Data* data, std::string& xml)
+{
+    const std::auto_ptr<xml::lite::Document> doc(toXMLImpl(data));
+    appendXML(*doc->getRootElement(), xml);
+}
+
 Data* XMLControl::fromXML(const xml::lite::Document* doc,
                           const std::vector<std::string>& schemaPaths)
 {
@@ -210,6 +267,16 @@ Data* XMLControl::fromXML(const xml::lite::Document* doc,
     return data;
 }
 
+Data* XMLControl::fromXML(const std::string& xml,
+                          const xml::lite::Document* doc,
+                          const std::vector<std::string>& schemaPaths)
+{
+    validate(xml, doc->getRootElement()->getUri(), schemaPaths, mLog);
+    Data* const data = fromXMLImpl(doc);
+    data->setVersion(getVersionFromURI(doc));
+    return data;
+}
+
 std::string XMLControl::dataTypeToString(DataType dataType, bool appendXML)
 {
     std::string str;
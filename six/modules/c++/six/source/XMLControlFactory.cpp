@@ -92,12 +92,44 @@ std::string six::toValidXMLString(const Data* data,
         xmlControl(xmlRegistry->newXMLControl(data->getDataType(), log));
 
     // this will validate if SIX_SCHEMA_PATH EnvVar is set
-    const std::auto_ptr<xml::lite::Document> doc(
-        xmlControl->toXML(data, schemaPaths));
+    std::string xml;
+    xmlControl->toXML(data, schemaPaths, xml);
+    return xml;
+}
+
+void six::appendXML(const xml::lite::Element& element, std::string& xml)
+{
+    const std::string qname = element.getQName();
+    xml += '<';
+    xml += qname;
+
+    const xml::lite::Attributes& attributes = element.getAttributes();
+    for (int ii = 0; ii < attributes.getLength(); ++ii)
+    {
+        const xml::lite::AttributeNode& attribute = attributes.getNode(ii);
+        xml += ' ';
+        xml += attribute.getQName();
+        xml += "=\"";
+        xml += attribute.getValue();
+        xml += '"';
+    }
 
-    io::StringStream oss;
-    doc->getRootElement()->print(oss);
+    const std::vector<xml::lite::Element*>& children = element.getChildren();
+    const std::string characterData = element.getCharacterData();
+    if (characterData.empty() && children.empty())
+    {
+        xml += "/>";
+        return;
+    }
 
-    return oss.stream().str();
+    xml += '>';
+    xml += characterData;
+    for (size_t ii = 0; ii < children.size(); ++ii)
+    {
+        appendXML(*children[ii], xml);
+    }
+    xml += "</";
+    xml += qname;
+    xml += '>';
 }
 
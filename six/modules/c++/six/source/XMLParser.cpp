@@ -41,7 +41,8 @@ XMLParser::XMLParser(const std::string& defaultURI,
     mDefaultURI(defaultURI),
     mAddClassAttributes(addClassAttributes),
     mLog(NULL),
-    mOwnLog(false)
+    mOwnLog(false),
+    mStreamWriter(NULL)
 {
     setLogger(log, ownLog);
 }
@@ -74,21 +75,31 @@ void XMLParser::setLogger(logging::Logger* log, bool own)
     }
 }
 
+void XMLParser::setStreamWriter(XMLStreamWriter* writer)
+{
+    mStreamWriter = writer;
+}
+
 XMLElem XMLParser::newElement(const std::string& name, XMLElem parent) const
 {
     return newElement(name, mDefaultURI, parent);
 }
 
 XMLElem XMLParser::newElement(const std::string& name,
-        const std::string& uri, XMLElem parent)
+        const std::string& uri, XMLElem parent) const
 {
     return newElement(name, uri, "", parent);
 }
 
 XMLElem XMLParser::newElement(const std::string& name,
         const std::string& uri, const std::string& characterData,
-        XMLElem parent)
+        XMLElem parent) const
 {
+    if (mStreamWriter)
+    {
+        return mStreamWriter->newElement(name, uri, characterData, parent);
+    }
+
     XMLElem elem = new xml::lite::Element(name, uri, characterData);
     if (parent)
         parent->addChild(elem);
@@ -327,7 +338,7 @@ void XMLParser::parseDouble(XMLElem element, double& value) const
 {
     try
     {
-        value = str::toType<double>(element->getCharacterData());
+        value = six::toDouble(element->getCharacterData());
     }
     catch (const except::BadCastException& ex)
     {
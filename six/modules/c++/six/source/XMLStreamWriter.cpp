@@ -0,0 +1,346 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <memory>
+#include <new>
+
+#include <except/Exception.h>
+#include <six/XMLStreamWriter.h>
+
+namespace six
+{
+const size_t XMLStreamWriter::BLOCK_SIZE = 256;
+
+// An element that remembers where it was written
+class XMLStreamWriter::StreamElement : public xml::lite::Element
+{
+public:
+    StreamElement(const std::string& name,
+                  const std::string& uri,
+                  const std::string& characterData) :
+        xml::lite::Element(name, uri, characterData),
+        tagOffset(0),
+        tagLength(0),
+        started(false),
+        headerOffset(0),
+        headerLength(0),
+        headerHash(0)
+    {
+    }
+
+    const std::string& characterData() const
+    {
+        return mCharacterData;
+    }
+
+    // Where the name is in the XML
+    size_t tagOffset;
+    size_t tagLength;
+
+    // Whether the header has been written, where it is in the XML while the
+    // element is open, and the hash of the last header written
+    bool started;
+    size_t headerOffset;
+    size_t headerLength;
+    sys::Uint64_T headerHash;
+};
+
+XMLStreamWriter::XMLStreamWriter(std::string& xml) :
+    mXML(xml),
+    mNumElements(0),
+    mHasRoot(false)
+{
+}
+
+XMLStreamWriter::~XMLStreamWriter()
+{
+    // The root belongs to the caller
+    for (size_t ii = 0; ii < mNumElements; ++ii)
+    {
+        getElement(ii).~StreamElement();
+    }
+    for (size_t ii = 0; ii < mBlocks.size(); ++ii)
+    {
+        ::operator delete(mBlocks[ii]);
+    }
+}
+
+xml::lite::Element* XMLStreamWriter::newElement(
+        const std::string& name,
+        const std::string& uri,
+        const std::string& characterData,
+        xml::lite::Element* parent)
+{
+    if (!parent)
+    {
+        if (mHasRoot)
+        {
+            throw except::Exception(Ctxt(
+                    "Can't write " + name + " without a parent: the "
+                    "document already has a root element"));
+        }
+
+        std::auto_ptr<StreamElement> root(
+                new StreamElement(name, uri, characterData));
+        mOpen.push_back(root.get());
+        mHasRoot = true;
+        return root.release();
+    }
+
+    size_t numOpen = mOpen.size();
+    while (numOpen > 0 && mOpen[numOpen - 1] != parent)
+    {
+        --numOpen;
+    }
+    if (numOpen == 0)
+    {
+        throw except::Exception(Ctxt(
+                "Can't write " + name + ": its parent has already been "
+                "written"));
+    }
+    while (mOpen.size() > numOpen)
+    {
+        closeElement();
+    }
+
+    if (!mOpen.back()->started)
+    {
+        writeHeader(*mOpen.back());
+    }
+
+    StreamElement* const element = allocate(name, uri, characterData);
+    mXML += '<';
+    element->tagOffset = mXML.size();
+    appendTag(name, uri);
+    element->tagLength = mXML.size() - element->tagOffset;
+
+    mOpen.push_back(element);
+    return element;
+}
+
+void XMLStreamWriter::finish()
+{
+    while (!mOpen.empty())
+    {
+        closeElement();
+    }
+
+    for (size_t ii = 0; ii < mNumElements; ++ii)
+    {
+        const StreamElement& element = getElement(ii);
+        mScratch.clear();
+        appendHeader(element, mScratch);
+        if (hash(mScratch, 0, mScratch.size()) != element.headerHash)
+        {
+            throw except::Exception(Ctxt(
+                    "Element " + element.getLocalName() + " was changed "
+                    "after it was written"));
+        }
+    }
+}
+
+XMLStreamWriter::StreamElement* XMLStreamWriter::allocate(
+        const std::string& name,
+        const std::string& uri,
+        const std::string& characterData)
+{
+    const size_t index = mNumElements % BLOCK_SIZE;
+    if (index == 0 && mNumElements / BLOCK_SIZE == mBlocks.size())
+    {
+        mBlocks.push_back(static_cast<StreamElement*>(
+                ::operator new(BLOCK_SIZE * sizeof(StreamElement))));
+    }
+
+    StreamElement* const element = new (mBlocks.back() + index)
+            StreamElement(name, uri, characterData);
+    ++mNumElements;
+    return element;
+}
+
+XMLStreamWriter::StreamElement&
+XMLStreamWriter::getElement(size_t index) const
+{
+    return mBlocks[index / BLOCK_SIZE][index % BLOCK_SIZE];
+}
+
+void XMLStreamWriter::appendHeader(const StreamElement& element,
+                                   std::string& xml) const
+{
+    const xml::lite::Attributes& attributes = element.getAttributes();
+    for (int ii = 0; ii < attributes.getLength(); ++ii)
+    {
+        const xml::lite::AttributeNode& attribute = attributes.getNode(ii);
+        const std::string* const prefix = findPrefix(attribute.getUri());
+
+        xml += ' ';
+        if (prefix)
+        {
+            if (!prefix->empty())
+            {
+                xml += *prefix;
+                xml += ':';
+            }
+            xml += attribute.getLocalName();
+        }
+        else
+        {
+            xml += attribute.getQName();
+        }
+        xml += "=\"";
+        xml += attribute.getValue();
+        xml += '"';
+    }
+
+    xml += '>';
+    xml += element.characterData();
+}
+
+void XMLStreamWriter::writeHeader(StreamElement& element)
+{
+    if (&element == mOpen.front())
+    {
+        startRoot(element);
+    }
+
+    element.started = true;
+    element.headerOffset = mXML.size();
+    appendHeader(element, mXML);
+    element.headerLength = mXML.size() - element.headerOffset;
+    element.headerHash =
+            hash(mXML, element.headerOffset, element.headerLength);
+}
+
+void XMLStreamWriter::closeElement()
+{
+    StreamElement& element = *mOpen.back();
+
+    if (!element.started)
+    {
+        // Nothing has been written since the name, so the header goes
+        // straight after it
+        writeHeader(element);
+        if (element.characterData().empty())
+        {
+            // Nothing between the tags, so the '>' becomes "/>"
+            mXML[mXML.size() - 1] = '/';
+            mXML += '>';
+            mOpen.pop_back();
+            return;
+        }
+    }
+    else
+    {
+        // Patch the start tag if the attributes or character data changed
+        // after the children were created.  Only the element's descendants
+        // come after it, and they're all closed.
+        mScratch.clear();
+        appendHeader(element, mScratch);
+        if (mXML.compare(element.headerOffset, element.headerLength,
+                         mScratch) != 0)
+        {
+            mXML.replace(element.headerOffset, element.headerLength,
+                         mScratch);
+            element.headerLength = mScratch.size();
+            element.headerHash = hash(mScratch, 0, mScratch.size());
+        }
+    }
+
+    // Nothing before the start tag has moved
+    mScratch.assign(mXML, element.tagOffset, element.tagLength);
+    mXML += "</";
+    mXML += mScratch;
+    mXML += '>';
+    mOpen.pop_back();
+}
+
+void XMLStreamWriter::startRoot(StreamElement& root)
+{
+    const xml::lite::Attributes& attributes = root.getAttributes();
+    for (int ii = 0; ii < attributes.getLength(); ++ii)
+    {
+        const xml::lite::AttributeNode& attribute = attributes.getNode(ii);
+        if (attribute.getQName() == "xmlns")
+        {
+            mNamespaces.push_back(
+                    std::make_pair(attribute.getValue(), std::string()));
+        }
+        else if (attribute.getPrefix() == "xmlns")
+        {
+            mNamespaces.push_back(std::make_pair(attribute.getValue(),
+                                                 attribute.getLocalName()));
+        }
+    }
+
+    // Setting the namespaces has already given the root its prefix
+    mXML += '<';
+    root.tagOffset = mXML.size();
+    mXML += root.getQName();
+    root.tagLength = mXML.size() - root.tagOffset;
+}
+
+void XMLStreamWriter::appendTag(const std::string& name,
+                                const std::string& uri)
+{
+    const std::string* const prefix = findPrefix(uri);
+    if (!prefix)
+    {
+        mXML += name;
+        return;
+    }
+
+    if (!prefix->empty())
+    {
+        mXML += *prefix;
+        mXML += ':';
+    }
+    const std::string::size_type colon = name.find(':');
+    mXML.append(name, (colon == std::string::npos) ? 0 : colon + 1,
+                std::string::npos);
+}
+
+const std::string* XMLStreamWriter::findPrefix(const std::string& uri) const
+{
+    // Later declarations of the same URI win, as they would with
+    // xml::lite::Element::setNamespacePrefix()
+    for (size_t ii = mNamespaces.size(); ii > 0; --ii)
+    {
+        if (mNamespaces[ii - 1].first == uri)
+        {
+            return &mNamespaces[ii - 1].second;
+        }
+    }
+    return NULL;
+}
+
+sys::Uint64_T XMLStreamWriter::hash(const std::string& str,
+                                    size_t offset,
+                                    size_t length)
+{
+    // 64-bit FNV-1a
+    sys::Uint64_T value = 14695981039346656037ULL;
+    for (size_t ii = offset; ii < offset + length; ++ii)
+    {
+        value ^= static_cast<unsigned char>(str[ii]);
+        value *= 1099511628211ULL;
+    }
+    return value;
+}
+}
@@ -0,0 +1,96 @@
+/* =========================================================================
+* This file is part of six-c++
+* =========================================================================
+*
+* (C) Copyright 2004 - 2019, MDA Information Systems LLC
+*
+* six-c++ is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this program; If not,
+* see <http://www.gnu.org/licenses/>.
+*
+*/
+#include <string>
+
+#include "TestCase.h"
+#include <io/StringStream.h>
+#include <xml/lite/Document.h>
+#include <xml/lite/Element.h>
+#include <six/XMLControlFactory.h>
+
+namespace
+{
+std::string print(const xml::lite::Element& element)
+{
+    io::StringStream stream;
+    element.print(stream);
+    return stream.stream().str();
+}
+
+std::string appendXML(const xml::lite::Element& element)
+{
+    std::string xml;
+    six::appendXML(element, xml);
+    return xml;
+}
+
+TEST_CASE(testEmpty)
+{
+    xml::lite::Element element("Empty", "urn:test", "");
+    TEST_ASSERT_EQ(appendXML(element), print(element));
+    TEST_ASSERT_EQ(appendXML(element), "<Empty/>");
+}
+
+TEST_CASE(testMatchesPrint)
+{
+    xml::lite::Document doc;
+    xml::lite::Element* const root =
+            doc.createElement("SICD", "urn:SICD:1.2.1", "");
+    doc.setRootElement(root);
+    root->getAttributes()["xmlns:si"] = "urn:SICommon:1.0";
+    root->getAttributes()["xmlns"] = "urn:SICD:1.2.1";
+
+    xml::lite::Element* const info =
+            doc.createElement("CollectionInfo", "urn:SICD:1.2.1", "");
+    root->addChild(info);
+    info->addChild(doc.createElement(
+            "CollectorName", "urn:SICD:1.2.1", "Collector"));
+    info->addChild(doc.createElement("CoreName", "urn:SICD:1.2.1", ""));
+
+    xml::lite::Element* const point =
+            doc.createElement("si:Row", "urn:SICommon:1.0", "1.5E+00");
+    point->getAttributes()["index"] = "1";
+    point->getAttributes()["name"] = "first";
+    root->addChild(point);
+
+    // Character data alongside children
+    xml::lite::Element* const mixed =
+            doc.createElement("Mixed", "urn:SICD:1.2.1", "text");
+    mixed->addChild(doc.createElement("Child", "urn:SICD:1.2.1", "1"));
+    root->addChild(mixed);
+
+    const std::string expected = print(*root);
+    TEST_ASSERT_EQ(appendXML(*root), expected);
+
+    // Appends rather than replaces
+    std::string xml("<?xml version=\"1.0\"?>");
+    six::appendXML(*root, xml);
+    TEST_ASSERT_EQ(xml, "<?xml version=\"1.0\"?>" + expected);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testEmpty);
+    TEST_CHECK(testMatchesPrint);
+    return 0;
+}
@@ -0,0 +1,120 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include <six/Decimation.h>
+#include "TestCase.h"
+
+namespace
+{
+// Power of each pixel is row * 10 + col
+std::vector<std::complex<float> > makeImage(const types::RowCol<size_t>& dims)
+{
+    std::vector<std::complex<float> > image(dims.area());
+    for (size_t row = 0; row < dims.row; ++row)
+    {
+        for (size_t col = 0; col < dims.col; ++col)
+        {
+            image[row * dims.col + col] = std::complex<float>(
+                    std::sqrt(static_cast<float>(row * 10 + col)), 0.0f);
+        }
+    }
+    return image;
+}
+
+TEST_CASE(testDims)
+{
+    const six::Decimation decimation(types::RowCol<size_t>(3, 4),
+                                     six::Decimation::MEAN_POWER);
+    const types::RowCol<size_t> dims =
+            decimation.getDecimatedDims(types::RowCol<size_t>(7, 8));
+    TEST_ASSERT_EQ(dims.row, static_cast<size_t>(3));
+    TEST_ASSERT_EQ(dims.col, static_cast<size_t>(2));
+    TEST_ASSERT_EQ(decimation.getRowsPerOutputRow(), static_cast<size_t>(3));
+    TEST_ASSERT_EQ(six::Decimation(types::RowCol<size_t>(3, 4))
+                           .getRowsPerOutputRow(),
+                   static_cast<size_t>(1));
+
+    TEST_EXCEPTION(six::Decimation(types::RowCol<size_t>(0, 2),
+                                   six::Decimation::SKIP));
+}
+
+TEST_CASE(testReduce)
+{
+    // 5 x 7, decimated by 2 x 3, leaves partial blocks on both edges
+    const types::RowCol<size_t> dims(5, 7);
+    const std::vector<std::complex<float> > image = makeImage(dims);
+    const types::RowCol<size_t> factor(2, 3);
+    six::ThreadPool threadPool(2);
+    std::vector<float> output(9);
+
+    const six::Decimation mean(factor, six::Decimation::MEAN_POWER);
+    mean.reduce(&image[0], dims.row, dims.col, threadPool, &output[0]);
+    TEST_ASSERT_ALMOST_EQ_EPS(output[0], 6.0f, 1e-4f);
+    TEST_ASSERT_ALMOST_EQ_EPS(output[2], 11.0f, 1e-4f);
+    TEST_ASSERT_ALMOST_EQ_EPS(output[6], 41.0f, 1e-4f);
+    TEST_ASSERT_ALMOST_EQ_EPS(output[8], 46.0f, 1e-4f);
+
+    const six::Decimation max(factor, six::Decimation::MAX_POWER);
+    max.reduce(&image[0], dims.row, dims.col, threadPool, &output[0]);
+    TEST_ASSERT_ALMOST_EQ_EPS(output[0], 12.0f, 1e-4f);
+    TEST_ASSERT_ALMOST_EQ_EPS(output[4], 35.0f, 1e-4f);
+    TEST_ASSERT_ALMOST_EQ_EPS(output[8], 46.0f, 1e-4f);
+
+    // Skipping only takes the rows that are kept
+    const std::vector<std::complex<float> > rows(image.begin() + dims.col,
+                                                 image.begin() + 3 * dims.col);
+    const six::Decimation skip(factor, six::Decimation::SKIP);
+    skip.reduce(&rows[0], 2, dims.col, threadPool, &output[0]);
+    TEST_ASSERT_ALMOST_EQ_EPS(output[0], 10.0f, 1e-4f);
+    TEST_ASSERT_ALMOST_EQ_EPS(output[2], 16.0f, 1e-4f);
+    TEST_ASSERT_ALMOST_EQ_EPS(output[5], 26.0f, 1e-4f);
+}
+
+TEST_CASE(testThreadsAgree)
+{
+    const types::RowCol<size_t> dims(301, 257);
+    const std::vector<std::complex<float> > image = makeImage(dims);
+    const six::Decimation decimation(types::RowCol<size_t>(4, 5),
+                                     six::Decimation::MEAN_POWER);
+    const size_t numPixels = decimation.getDecimatedDims(dims).area();
+
+    six::ThreadPool serialPool(1);
+    six::ThreadPool parallelPool(4);
+    std::vector<float> serial(numPixels);
+    std::vector<float> parallel(numPixels);
+    decimation.reduce(&image[0], dims.row, dims.col, serialPool, &serial[0]);
+    decimation.reduce(&image[0], dims.row, dims.col, parallelPool,
+                      &parallel[0]);
+    TEST_ASSERT_TRUE(serial == parallel);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testDims);
+    TEST_CHECK(testReduce);
+    TEST_CHECK(testThreadsAgree);
+    return 0;
+}
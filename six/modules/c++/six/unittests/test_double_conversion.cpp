@@ -0,0 +1,316 @@
+/* =========================================================================
+* This file is part of six-c++
+* =========================================================================
+*
+* (C) Copyright 2004 - 2019, MDA Information Systems LLC
+*
+* six-c++ is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this program; If not,
+* see <http://www.gnu.org/licenses/>.
+*
+*/
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "TestCase.h"
+#include <io/FileInputStream.h>
+#include <sys/OS.h>
+#include <sys/Path.h>
+#include <xml/lite/MinidomParser.h>
+#include <six/DoubleConversion.h>
+
+namespace
+{
+std::vector<std::string> sampleXMLPaths;
+
+void findSampleXML(const sys::Path& exePath)
+{
+    sys::Path sixHome = exePath.join("..");
+    do
+    {
+        const sys::Path modules =
+                sixHome.join("six").join("modules").join("c++");
+        if (sys::OS().isDirectory(modules.join("six.sicd").join("tests").
+                join("sample_xml").getAbsolutePath()))
+        {
+            std::vector<std::string> dirs;
+            dirs.push_back(modules.join("six.sicd").join("tests").
+                    join("sample_xml").getAbsolutePath());
+            dirs.push_back(modules.join("cphd").join("tests").
+                    join("sample_xml").getAbsolutePath());
+            sampleXMLPaths = sys::OS().search(dirs, "", ".xml", false);
+            return;
+        }
+        sixHome = sixHome.join("..");
+    } while (sixHome.getAbsolutePath() != sixHome.join("..").getAbsolutePath());
+}
+
+template <typename T>
+bool sameBits(T lhs, T rhs)
+{
+    return std::memcmp(&lhs, &rhs, sizeof(T)) == 0;
+}
+
+// Whether the C library reads all of 'text' as a double
+bool isDouble(const std::string& text, double& value)
+{
+    if (text.empty() || text.find_first_of("0123456789") == std::string::npos)
+    {
+        return false;
+    }
+    char* end = NULL;
+    value = std::strtod(text.c_str(), &end);
+    return end == text.c_str() + text.size();
+}
+
+// Digits in the mantissa of formatDouble()'s output
+size_t countDigits(const std::string& str)
+{
+    const std::string mantissa = str.substr(0, str.find('E'));
+    size_t count = 0;
+    for (size_t ii = 0; ii < mantissa.size(); ++ii)
+    {
+        if (mantissa[ii] >= '0' && mantissa[ii] <= '9')
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void checkElement(const std::string& testName,
+                  const xml::lite::Element& element,
+                  size_t& numChecked)
+{
+    std::string text = element.getCharacterData();
+    str::trim(text);
+    double expected;
+    if (isDouble(text, expected))
+    {
+        const double actual = six::toDouble(text);
+        TEST_ASSERT_EQ_MSG(text, sameBits(actual, expected), true);
+
+        const std::string formatted = six::formatDouble(actual);
+        TEST_ASSERT_EQ_MSG(text + " -> " + formatted,
+                           sameBits(six::toDouble(formatted), actual), true);
+        TEST_ASSERT_TRUE(countDigits(formatted) <=
+                static_cast<size_t>(std::numeric_limits<double>::max_digits10));
+        ++numChecked;
+    }
+
+    const std::vector<xml::lite::Element*>& children = element.getChildren();
+    for (size_t ii = 0; ii < children.size(); ++ii)
+    {
+        checkElement(testName, *children[ii], numChecked);
+    }
+}
+
+// Simple, repeatable source of bit patterns
+class Random
+{
+public:
+    Random() :
+        mState(0x853C49E6748FEA9BULL)
+    {
+    }
+
+    sys::Uint64_T next()
+    {
+        mState = mState * 6364136223846793005ULL + 1442695040888963407ULL;
+        return mState ^ (mState >> 29);
+    }
+
+private:
+    sys::Uint64_T mState;
+};
+
+TEST_CASE(testSampleXML)
+{
+    TEST_ASSERT_FALSE(sampleXMLPaths.empty());
+
+    size_t numChecked = 0;
+    for (size_t ii = 0; ii < sampleXMLPaths.size(); ++ii)
+    {
+        io::FileInputStream stream(sampleXMLPaths[ii]);
+        xml::lite::MinidomParser parser;
+        parser.preserveCharacterData(true);
+        parser.parse(stream);
+        checkElement(testName,
+                     *parser.getDocument()->getRootElement(),
+                     numChecked);
+    }
+    TEST_ASSERT_TRUE(numChecked > 100);
+}
+
+TEST_CASE(testRandomRoundTrip)
+{
+    Random random;
+    for (size_t ii = 0; ii < 200000; ++ii)
+    {
+        const sys::Uint64_T bits = random.next();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        if (value != value)
+        {
+            continue;
+        }
+
+        const std::string formatted = six::formatDouble(value);
+        TEST_ASSERT_EQ_MSG(formatted,
+                           sameBits(six::toDouble(formatted), value), true);
+
+        // Also compare against the C library for long and
+        // non-round-tripping digit strings
+        char buffer[64];
+        for (int precision = 1; precision <= 25; precision += 8)
+        {
+            const int length = std::snprintf(buffer, sizeof(buffer), "%.*E",
+                                             precision, value);
+            double scanned = 0;
+            six::scanDouble(buffer, buffer + length, scanned);
+            TEST_ASSERT_EQ_MSG(std::string(buffer),
+                               sameBits(scanned, std::strtod(buffer, NULL)),
+                               true);
+        }
+
+        const sys::Uint32_T floatBits = static_cast<sys::Uint32_T>(bits);
+        float floatValue;
+        std::memcpy(&floatValue, &floatBits, sizeof(floatValue));
+        if (floatValue == floatValue)
+        {
+            const std::string floatFormatted = six::formatFloat(floatValue);
+            TEST_ASSERT_EQ_MSG(floatFormatted,
+                               sameBits(six::toFloat(floatFormatted),
+                                        floatValue),
+                               true);
+            TEST_ASSERT_TRUE(countDigits(floatFormatted) <=
+                    static_cast<size_t>(
+                            std::numeric_limits<float>::max_digits10));
+        }
+    }
+}
+
+TEST_CASE(testFormat)
+{
+    TEST_ASSERT_EQ(six::formatDouble(1.5), "1.5E00");
+    TEST_ASSERT_EQ(six::formatDouble(0.1), "1E-01");
+    TEST_ASSERT_EQ(six::formatDouble(-2.25e-3), "-2.25E-03");
+    TEST_ASSERT_EQ(six::formatDouble(123456789.0), "1.23456789E08");
+    TEST_ASSERT_EQ(six::formatDouble(1e300), "1E300");
+    TEST_ASSERT_EQ(six::formatDouble(0.0), "0E00");
+    TEST_ASSERT_EQ(six::formatDouble(-0.0), "-0E00");
+    TEST_ASSERT_EQ(six::formatDouble(1.0 / 3.0), "3.333333333333333E-01");
+    TEST_ASSERT_EQ(six::formatDouble(std::numeric_limits<double>::max()),
+                   "1.7976931348623157E308");
+    TEST_ASSERT_EQ(six::formatDouble(std::numeric_limits<double>::denorm_min()),
+                   "5E-324");
+    TEST_ASSERT_EQ(six::formatDouble(std::numeric_limits<double>::infinity()),
+                   "INF");
+    TEST_ASSERT_EQ(six::formatDouble(-std::numeric_limits<double>::infinity()),
+                   "-INF");
+    TEST_ASSERT_EQ(six::formatDouble(std::numeric_limits<double>::quiet_NaN()),
+                   "NaN");
+    TEST_ASSERT_EQ(six::formatFloat(0.1f), "1E-01");
+    TEST_ASSERT_EQ(six::formatFloat(1.0f / 3.0f), "3.3333334E-01");
+}
+
+TEST_CASE(testParse)
+{
+    TEST_ASSERT_EQ(six::toDouble(" 1.5\n"), 1.5);
+    TEST_ASSERT_EQ(six::toDouble("+.5"), 0.5);
+    TEST_ASSERT_EQ(six::toDouble("1."), 1.0);
+    TEST_ASSERT_EQ(six::toDouble("-2.25E-03"), -2.25e-3);
+    TEST_ASSERT_EQ(six::toDouble("1e+2"), 100.0);
+    TEST_ASSERT_TRUE(sameBits(six::toDouble("-0"), -0.0));
+    TEST_ASSERT_EQ(six::toDouble("1e-400"), 0.0);
+    TEST_ASSERT_EQ(six::toDouble("INF"), std::numeric_limits<double>::infinity());
+    TEST_ASSERT_EQ(six::toDouble("-infinity"),
+                   -std::numeric_limits<double>::infinity());
+    TEST_ASSERT_TRUE(six::toDouble("NaN") != six::toDouble("NaN"));
+
+    // Exact decimal expansion of 0.1, and halfway cases either side of 2^53
+    TEST_ASSERT_EQ(six::toDouble(
+            "0.1000000000000000055511151231257827021181583404541015625"), 0.1);
+    TEST_ASSERT_EQ(six::toDouble("9007199254740993"), 9007199254740992.0);
+    TEST_ASSERT_EQ(six::toDouble("9007199254740993.0000000000000000001"),
+                   9007199254740994.0);
+
+    TEST_EXCEPTION(six::toDouble(""));
+    TEST_EXCEPTION(six::toDouble("  "));
+    TEST_EXCEPTION(six::toDouble("abc"));
+    TEST_EXCEPTION(six::toDouble("1.5x"));
+    TEST_EXCEPTION(six::toDouble("1,5"));
+    TEST_EXCEPTION(six::toDouble("."));
+    TEST_EXCEPTION(six::toDouble("1e400"));
+    TEST_EXCEPTION(six::toFloat("1e39"));
+
+    // Like std::from_chars(), stops at the first character that isn't
+    // part of the number
+    const std::string text("1.5e+x");
+    double value = 0;
+    TEST_ASSERT_EQ(six::scanDouble(text.c_str(), text.c_str() + text.size(),
+                                   value) - text.c_str(), 3);
+    TEST_ASSERT_EQ(value, 1.5);
+    TEST_ASSERT_EQ(six::scanDouble(text.c_str() + 3,
+                                   text.c_str() + text.size(),
+                                   value) - text.c_str(), 3);
+}
+
+TEST_CASE(testLocale)
+{
+    // Try a locale that uses ',' as the decimal point, if one is installed
+    const char* const locales[] =
+    {
+        "de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "fr_FR.utf8"
+    };
+    const std::string original = std::setlocale(LC_NUMERIC, NULL);
+    for (size_t ii = 0; ii < sizeof(locales) / sizeof(locales[0]); ++ii)
+    {
+        if (std::setlocale(LC_NUMERIC, locales[ii]) != NULL)
+        {
+            const std::string formatted = six::formatDouble(1.5);
+            const double parsed = six::toDouble("2.75");
+            std::setlocale(LC_NUMERIC, original.c_str());
+            TEST_ASSERT_EQ(formatted, "1.5E00");
+            TEST_ASSERT_EQ(parsed, 2.75);
+            return;
+        }
+    }
+    std::cerr << "No comma decimal point locale installed; skipping\n";
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 0)
+    {
+        std::cerr << "This test makes assumptions about the directory structure."
+            << " Make sure to call with the executable name as argv[0] so "
+            << " we can find the necessary files.\n";
+        return 1;
+    }
+    findSampleXML(std::string(argv[0]));
+
+    TEST_CHECK(testSampleXML);
+    TEST_CHECK(testRandomRoundTrip);
+    TEST_CHECK(testFormat);
+    TEST_CHECK(testParse);
+    TEST_CHECK(testLocale);
+    return 0;
+}
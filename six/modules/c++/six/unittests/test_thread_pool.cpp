@@ -0,0 +1,131 @@
+/* =========================================================================
+* This file is part of six-c++
+* =========================================================================
+*
+* (C) Copyright 2004 - 2019, MDA Information Systems LLC
+*
+* six-c++ is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this program; If not,
+* see <http://www.gnu.org/licenses/>.
+*
+*/
+#include <vector>
+
+#include "TestCase.h"
+#include <except/Exception.h>
+#include <six/ThreadPool.h>
+
+namespace
+{
+class FillRunnable : public sys::Runnable
+{
+public:
+    FillRunnable(std::vector<size_t>& values, size_t start, size_t num) :
+        mValues(values),
+        mStart(start),
+        mNum(num)
+    {
+    }
+
+    virtual void run()
+    {
+        for (size_t ii = mStart; ii < mStart + mNum; ++ii)
+        {
+            mValues[ii] += ii;
+        }
+    }
+
+private:
+    std::vector<size_t>& mValues;
+    const size_t mStart;
+    const size_t mNum;
+};
+
+class ThrowRunnable : public sys::Runnable
+{
+public:
+    virtual void run()
+    {
+        throw except::Exception(Ctxt("Expected failure"));
+    }
+};
+
+bool runFill(six::ThreadPool& pool, size_t numRunnables)
+{
+    const size_t numPerRunnable = 1000;
+    std::vector<size_t> values(numRunnables * numPerRunnable, 0);
+    std::vector<FillRunnable> runnables;
+    for (size_t ii = 0; ii < numRunnables; ++ii)
+    {
+        runnables.push_back(FillRunnable(values,
+                                         ii * numPerRunnable,
+                                         numPerRunnable));
+    }
+    pool.runEach(runnables);
+
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        if (values[ii] != ii)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE(testSingleThread)
+{
+    six::ThreadPool pool(1);
+    TEST_ASSERT_EQ(pool.getNumThreads(), static_cast<size_t>(1));
+    TEST_ASSERT_TRUE(runFill(pool, 10));
+}
+
+TEST_CASE(testReuse)
+{
+    // More runnables than threads, and many calls on the same pool
+    six::ThreadPool pool(4);
+    for (size_t ii = 0; ii < 100; ++ii)
+    {
+        TEST_ASSERT_TRUE(runFill(pool, ii % 17));
+    }
+}
+
+TEST_CASE(testGetNumChunks)
+{
+    six::ThreadPool pool(4);
+    TEST_ASSERT_EQ(pool.getNumChunks(0), static_cast<size_t>(1));
+    TEST_ASSERT_EQ(pool.getNumChunks(2), static_cast<size_t>(2));
+    TEST_ASSERT_EQ(pool.getNumChunks(100), static_cast<size_t>(4));
+    TEST_ASSERT_EQ(pool.getNumChunks(100, 40), static_cast<size_t>(2));
+    TEST_ASSERT_EQ(pool.getNumChunks(100, 1000), static_cast<size_t>(1));
+}
+
+TEST_CASE(testException)
+{
+    six::ThreadPool pool(3);
+    std::vector<ThrowRunnable> runnables(5);
+    TEST_EXCEPTION(pool.runEach(runnables));
+
+    // The pool is still usable afterwards
+    TEST_ASSERT_TRUE(runFill(pool, 8));
+}
+}
+
+int main(int , char** )
+{
+    TEST_CHECK(testSingleThread);
+    TEST_CHECK(testReuse);
+    TEST_CHECK(testGetNumChunks);
+    TEST_CHECK(testException);
+    return 0;
+}
@@ -0,0 +1,178 @@
+/* =========================================================================
+* This file is part of six-c++
+* =========================================================================
+*
+* (C) Copyright 2004 - 2019, MDA Information Systems LLC
+*
+* six-c++ is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this program; If not,
+* see <http://www.gnu.org/licenses/>.
+*
+*/
+#include <string>
+#include <vector>
+
+#include "TestCase.h"
+#include <mt/CriticalSection.h>
+#include <mt/Runnable1D.h>
+#include <six/ValidatorCache.h>
+
+namespace
+{
+// Reports an error for any XML containing "bad", and notes whether it was
+// ever used by two threads at once
+class FakeValidator : public xml::lite::ValidatorInterface
+{
+public:
+    FakeValidator(const std::vector<std::string>& schemaPaths,
+                  bool& sharedUse) :
+        xml::lite::ValidatorInterface(schemaPaths, NULL),
+        mInUse(false),
+        mSharedUse(sharedUse)
+    {
+    }
+
+    using xml::lite::ValidatorInterface::validate;
+
+    virtual bool validate(const std::string& xml,
+                          const std::string& xmlID,
+                          std::vector<xml::lite::ValidationInfo>& errors) const
+    {
+        {
+            mt::CriticalSection<sys::Mutex> lock(&mMutex);
+            if (mInUse)
+            {
+                mSharedUse = true;
+            }
+            mInUse = true;
+        }
+
+        const bool invalid = (xml.find("bad") != std::string::npos);
+        if (invalid)
+        {
+            errors.push_back(xml::lite::ValidationInfo(
+                    "Found bad", "ERROR", xmlID, 1));
+        }
+
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        mInUse = false;
+        return invalid;
+    }
+
+private:
+    mutable bool mInUse;
+    bool& mSharedUse;
+    mutable sys::Mutex mMutex;
+};
+
+class FakeValidatorCache : public six::ValidatorCache
+{
+public:
+    FakeValidatorCache() :
+        mSharedUse(false)
+    {
+    }
+
+    bool wasShared() const
+    {
+        return mSharedUse;
+    }
+
+protected:
+    virtual std::auto_ptr<xml::lite::ValidatorInterface>
+    createValidator(const std::vector<std::string>& schemaPaths,
+                    logging::Logger* ) const
+    {
+        return std::auto_ptr<xml::lite::ValidatorInterface>(
+                new FakeValidator(schemaPaths, mSharedUse));
+    }
+
+private:
+    mutable bool mSharedUse;
+};
+
+std::vector<std::string> makePaths(const std::string& first,
+                                   const std::string& second)
+{
+    std::vector<std::string> paths;
+    paths.push_back(first);
+    paths.push_back(second);
+    return paths;
+}
+
+class Validate
+{
+public:
+    Validate(six::ValidatorCache& cache) :
+        mCache(cache)
+    {
+    }
+
+    void operator()(size_t ii) const
+    {
+        std::vector<xml::lite::ValidationInfo> errors;
+        mCache.validate((ii % 2) ? "<good/>" : "<bad/>",
+                        "urn:SICD:1.2.1",
+                        makePaths("a", "b"),
+                        errors,
+                        NULL);
+    }
+
+private:
+    six::ValidatorCache& mCache;
+};
+
+TEST_CASE(testReuse)
+{
+    FakeValidatorCache cache;
+    std::vector<xml::lite::ValidationInfo> errors;
+
+    TEST_ASSERT_FALSE(cache.validate("<good/>", "urn:SICD:1.2.1",
+                                     makePaths("a", "b"), errors, NULL));
+    TEST_ASSERT_TRUE(errors.empty());
+    TEST_ASSERT_EQ(cache.getNumCompiled(), static_cast<size_t>(1));
+
+    // Same set of paths, different order and namespace
+    TEST_ASSERT_TRUE(cache.validate("<bad/>", "urn:SIDD:2.0.0",
+                                    makePaths("b", "a"), errors, NULL));
+    TEST_ASSERT_EQ(errors.size(), static_cast<size_t>(1));
+    TEST_ASSERT_EQ(cache.getNumCompiled(), static_cast<size_t>(1));
+
+    // Different paths need their own
+    TEST_ASSERT_FALSE(cache.validate("<good/>", "urn:SICD:1.2.1",
+                                     makePaths("a", "c"), errors, NULL));
+    TEST_ASSERT_EQ(cache.getNumCompiled(), static_cast<size_t>(2));
+
+    cache.clear();
+    TEST_ASSERT_FALSE(cache.validate("<good/>", "urn:SICD:1.2.1",
+                                     makePaths("a", "b"), errors, NULL));
+    TEST_ASSERT_EQ(cache.getNumCompiled(), static_cast<size_t>(3));
+}
+
+TEST_CASE(testConcurrentValidation)
+{
+    FakeValidatorCache cache;
+    const size_t numThreads = 4;
+    mt::run1D(1000, numThreads, Validate(cache));
+    TEST_ASSERT_FALSE(cache.wasShared());
+    TEST_ASSERT_TRUE(cache.getNumCompiled() >= 1);
+    TEST_ASSERT_TRUE(cache.getNumCompiled() <= numThreads);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testReuse);
+    TEST_CHECK(testConcurrentValidation);
+    return 0;
+}
@@ -0,0 +1,219 @@
+/* =========================================================================
+* This file is part of six-c++
+* =========================================================================
+*
+* (C) Copyright 2004 - 2019, MDA Information Systems LLC
+*
+* six-c++ is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this program; If not,
+* see <http://www.gnu.org/licenses/>.
+*
+*/
+#include <memory>
+#include <string>
+
+#include "TestCase.h"
+#include <io/StringStream.h>
+#include <xml/lite/Element.h>
+#include <six/XMLStreamWriter.h>
+
+namespace
+{
+const char SIDD_URI[] = "urn:SIDD:2.0.0";
+const char SI_URI[] = "urn:SICommon:1.0";
+const char ISM_URI[] = "urn:us:gov:ic:ism:13";
+
+// Creates elements either in a tree or through a writer, the way
+// six::XMLParser::newElement() does
+class Builder
+{
+public:
+    explicit Builder(six::XMLStreamWriter* writer = NULL) :
+        mWriter(writer)
+    {
+    }
+
+    xml::lite::Element* newElement(const std::string& name,
+                                   const std::string& uri,
+                                   const std::string& characterData,
+                                   xml::lite::Element* parent) const
+    {
+        if (mWriter)
+        {
+            return mWriter->newElement(name, uri, characterData, parent);
+        }
+
+        xml::lite::Element* const element =
+                new xml::lite::Element(name, uri, characterData);
+        if (parent)
+        {
+            parent->addChild(element);
+        }
+        return element;
+    }
+
+private:
+    six::XMLStreamWriter* const mWriter;
+};
+
+void setNamespaces(xml::lite::Element& root)
+{
+    root.setNamespacePrefix("", SIDD_URI);
+    root.setNamespacePrefix("si", SI_URI);
+    root.setNamespacePrefix("ism", ISM_URI);
+}
+
+void addChildren(const Builder& builder, xml::lite::Element* root)
+{
+    xml::lite::Element* const creation =
+            builder.newElement("ProductCreation", SIDD_URI, "", root);
+    builder.newElement("ProcessorInformation", SIDD_URI, "", creation);
+
+    xml::lite::Element* const classification =
+            builder.newElement("Classification", SIDD_URI, "", creation);
+    xml::lite::AttributeNode node;
+    node.setQName("classification");
+    node.setUri(ISM_URI);
+    node.setValue("U");
+    classification->getAttributes().add(node);
+    builder.newElement("SecurityExtension", SIDD_URI, "", classification);
+
+    xml::lite::Element* const poly =
+            builder.newElement("TimeCOAPoly", SIDD_URI, "", root);
+    poly->getAttributes()["order1"] = "1";
+    for (size_t ii = 0; ii < 2; ++ii)
+    {
+        xml::lite::Element* const coef =
+                builder.newElement("Coef", SI_URI, "1.5E00", poly);
+        coef->getAttributes()["exponent1"] = ii == 0 ? "0" : "1";
+    }
+
+    // Not a declared namespace
+    builder.newElement("ext:Extension", "urn:other", "x", root);
+    builder.newElement("Empty", SIDD_URI, "", root);
+}
+
+TEST_CASE(testMatchesTree)
+{
+    xml::lite::Element root("SIDD", SIDD_URI, "");
+    addChildren(Builder(), &root);
+    setNamespaces(root);
+
+    io::StringStream stream;
+    root.print(stream);
+    const std::string expected = stream.stream().str();
+
+    std::string xml("<?xml version=\"1.0\"?>");
+    six::XMLStreamWriter writer(xml);
+    const Builder builder(&writer);
+    const std::auto_ptr<xml::lite::Element> streamRoot(
+            builder.newElement("SIDD", SIDD_URI, "", NULL));
+    setNamespaces(*streamRoot);
+    addChildren(builder, streamRoot.get());
+    writer.finish();
+
+    TEST_ASSERT_EQ(xml, "<?xml version=\"1.0\"?>" + expected);
+}
+
+TEST_CASE(testEmptyRoot)
+{
+    std::string xml;
+    six::XMLStreamWriter writer(xml);
+    const std::auto_ptr<xml::lite::Element> root(
+            writer.newElement("SICD", "urn:SICD:1.2.1", "", NULL));
+    root->setNamespacePrefix("", "urn:SICD:1.2.1");
+    writer.finish();
+    TEST_ASSERT_EQ(xml, "<SICD xmlns=\"urn:SICD:1.2.1\"/>");
+}
+
+TEST_CASE(testOutOfOrder)
+{
+    std::string xml;
+    six::XMLStreamWriter writer(xml);
+    const std::auto_ptr<xml::lite::Element> root(
+            writer.newElement("Root", "", "", NULL));
+
+    // A second root
+    TEST_EXCEPTION(writer.newElement("Root", "", "", NULL));
+
+    // Adding to an element whose end tag has been written
+    xml::lite::Element* const first =
+            writer.newElement("First", "", "", root.get());
+    writer.newElement("Child", "", "", first);
+    writer.newElement("Second", "", "", root.get());
+    TEST_EXCEPTION(writer.newElement("Child", "", "", first));
+    writer.finish();
+    TEST_EXCEPTION(writer.newElement("Child", "", "", root.get()));
+}
+
+TEST_CASE(testChangedAfterChildren)
+{
+    std::string xml;
+    six::XMLStreamWriter writer(xml);
+    const std::auto_ptr<xml::lite::Element> root(
+            writer.newElement("Root", "", "", NULL));
+    xml::lite::Element* const parent =
+            writer.newElement("Parent", "", "", root.get());
+    parent->getAttributes()["name"] = "first";
+    writer.newElement("Child", "", "1", parent);
+    writer.newElement("Child", "", "2", parent);
+
+    // Patched into the start tag that's already been written
+    parent->getAttributes()["name"] = "parent";
+    parent->getAttributes()["size"] = "2";
+    parent->setCharacterData("text");
+    writer.newElement("Sibling", "", "", root.get());
+    writer.finish();
+
+    TEST_ASSERT_EQ(xml,
+                   "<Root><Parent name=\"parent\" size=\"2\">text"
+                   "<Child>1</Child><Child>2</Child></Parent>"
+                   "<Sibling/></Root>");
+}
+
+TEST_CASE(testChangedAfterWritten)
+{
+    {
+        std::string xml;
+        six::XMLStreamWriter writer(xml);
+        const std::auto_ptr<xml::lite::Element> root(
+                writer.newElement("Root", "", "", NULL));
+        xml::lite::Element* const first =
+                writer.newElement("First", "", "", root.get());
+        writer.newElement("Second", "", "", root.get());
+        first->getAttributes()["name"] = "first";
+        TEST_EXCEPTION(writer.finish());
+    }
+    {
+        std::string xml;
+        six::XMLStreamWriter writer(xml);
+        const std::auto_ptr<xml::lite::Element> root(
+                writer.newElement("Root", "", "", NULL));
+        xml::lite::Element* const first =
+                writer.newElement("First", "", "1", root.get());
+        writer.newElement("Second", "", "", root.get());
+        first->setCharacterData("2");
+        TEST_EXCEPTION(writer.finish());
+    }
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testMatchesTree);
+    TEST_CHECK(testEmptyRoot);
+    TEST_CHECK(testOutOfOrder);
+    TEST_CHECK(testChangedAfterChildren);
+    TEST_CHECK(testChangedAfterWritten);
+    return 0;
+}
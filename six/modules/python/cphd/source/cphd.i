@@ -64,6 +64,9 @@ using six::Vector3;
     const std::string& xmlString,
     const std::vector<std::string>& schemaPaths);
 
+// The background prefetching stream is for C++ callers
+%ignore cphd::CPHDReader::getWidebandStream;
+
 // Nested class renames
 %rename(CphdAntenna) cphd::Antenna;
 %rename(DataChannel) cphd::Data::Channel;
@@ -142,10 +145,17 @@ using six::Vector3;
         void* buffer = reinterpret_cast<void*>(data);
         $self->getPVPdata(channel, buffer);
     }
+
+    void setPVPdata(size_t channel, size_t data)
+    {
+        const void* buffer = reinterpret_cast<const void*>(data);
+        $self->setPVPdata(channel, buffer);
+    }
 }
 
 %include "std_map.i"
 %template(MapStringAPVPType) std::map<std::string, cphd::APVPType>;
+%template(VectorAPVPType) std::vector<cphd::APVPType>;
 
 %extend cphd::PVPBlock
 {
@@ -169,7 +179,7 @@ using six::Vector3;
 %template(setStringAddedPVP) setAddedPVP<std::string>;
 }
 
-%extend cphd::PVPBlock
+%extend cphd::Pvp
 {
 %pythoncode
 %{
@@ -177,58 +187,182 @@ using six::Vector3;
     import numpy  # 'as np' doesn't work unless the import is in each method
 
     @staticmethod
-    def _validate_pvp_format(format_str):
-        if format_str.startswith('CI'):
-            # NumPy has no complex int type, need to use a structured array
-            # TODO: Support complex int PVP types
-            raise NotImplementedError('Complex int PVPs are not supported')
-
-        if '=' in format_str and ';' in format_str:
-            # Multiple values in parameter
-            param_types = [param[param.index('=') + 1:]
-                           for param in format_str.split(';') if param]
-            if not len(set(param_types)) == 1:
-                # TODO: support multiple different parameter types e.g.
-                #       ('A=U2;B=I2;') using NumPy structured arrays
-                raise ValueError('PVPs with different types are not supported')
-            return param_types[0]
-        return format_str
-
-    @staticmethod
-    def _format_to_dtype(format_str):
-        format_str = PVPBlock._validate_pvp_format(format_str)
-
-        first = format_str[0]
-        if first in ['U', 'I', 'F']:  # Unsigned int, signed int, float
-            return numpy.dtype(format_str.lower())
-        elif first == 'C':  # Complex float ('CF') or complex int ('CI')
-            if format_str[1] == 'I':  # Complex int
-                raise NotImplementedError('Complex int PVPs are not supported')
-            return numpy.dtype('c' + format_str[2:])
-        elif first == 'S':  # String
-            return numpy.dtype('U' + format_str[1:])
+    def _format_to_dtype(format_str, byte_order):
+        """NumPy dtype of one PVP value, e.g. 'F8', 'CI4' or 'S16'"""
+        kind = format_str.rstrip('0123456789')
+        size = int(format_str[len(kind):])
+        if kind in ('U', 'I', 'F'):  # Unsigned int, signed int, float
+            return numpy.dtype(byte_order + kind.lower() + str(size))
+        elif kind == 'CF':  # Complex float
+            return numpy.dtype(byte_order + 'c' + str(size))
+        elif kind == 'CI':
+            # NumPy has no complex int type, so use a structured type
+            component = byte_order + 'i' + str(size // 2)
+            return numpy.dtype([('re', component), ('im', component)])
+        elif kind == 'S':  # String
+            return numpy.dtype('S' + str(size))
 
         raise ValueError('Unknown or unsupported format string: {0}'
                          .format(format_str))
 
     @staticmethod
-    def _common_format(formats):
-        # Split parameters into a format dict with keys equal to
-        # param suffixes. Single parameters have entry suffix
-        # Example: 'F8' --> {'': 'F8'}
-        # Example: 'A=F8;B=I4' --> {'A': 'F8', 'B': 'I4'}
-        return len(set(formats)) == 1
+    def _parameter_dtype(format_str, byte_order):
+        """NumPy dtype of one PVP parameter
+
+        Parameters with several values of the same format (e.g. 'txPos',
+        which is 'X=F8;Y=F8;Z=F8;') become a subarray, so that a channel
+        of them is an (N,3)-shape array.  Values of different formats
+        (e.g. 'A=U2;B=I2;') become a structured type with a field for each.
+        """
+        if '=' not in format_str:
+            return Pvp._format_to_dtype(format_str, byte_order)
+
+        values = [value.split('=') for value in format_str.split(';')
+                  if value]
+        formats = set(value_format for _, value_format in values)
+        if len(formats) == 1:
+            return numpy.dtype((Pvp._format_to_dtype(formats.pop(),
+                                                     byte_order),
+                                (len(values),)))
+        return numpy.dtype([(name, Pvp._format_to_dtype(value_format,
+                                                        byte_order))
+                            for name, value_format in values])
+
+    def numpy_dtype(self, num_bytes=None, byte_order='='):
+        """Build a NumPy structured dtype describing a PVP set.
+
+        Each parameter with an offset, including optional and added
+        parameters, is a field at its offset in the set.  Parameters are
+        named as they are in this Pvp, e.g. 'txTime' or the name of an
+        added PVP.
+
+        Parameters
+        ----------
+        num_bytes: int
+            Number of bytes per PVP set.  Defaults to self.sizeInBytes(),
+            but may be larger, e.g. metadata.data.getNumBytesPVPSet()
+        byte_order: str
+            '=' for native order (as in a PVPBlock) or '>' for file order
+
+        Returns
+        -------
+        dtype: numpy.dtype
+        """
+        if num_bytes is None:
+            num_bytes = self.sizeInBytes()
+
+        names = []
+        formats = []
+        offsets = []
+        for parameter in self.getParameters():
+            names.append(parameter.getName())
+            formats.append(Pvp._parameter_dtype(parameter.getFormat(),
+                                                byte_order))
+            offsets.append(parameter.getByteOffset())
+
+        return numpy.dtype({'names': names,
+                            'formats': formats,
+                            'offsets': offsets,
+                            'itemsize': num_bytes})
+%}
+}
+
+%extend cphd::PVPBlock
+{
+%pythoncode
+%{
+
+    import numpy  # 'as np' doesn't work unless the import is in each method
+
+    def to_numpy(self, metadata):
+        """Copy this PVPBlock into NumPy structured arrays.
+
+        Each channel is copied with a single call, so this is fast even for
+        millions of vectors.
+
+        Parameters
+        ----------
+        metadata: cphd.Metadata
+            The metadata used to create this PVPBlock
+
+        Returns
+        -------
+        pvp_arrays: list of NumPy structured arrays
+            One array of shape (metadata.getNumVectors(channel),) for each
+            channel, with the dtype from metadata.pvp.numpy_dtype().  Any
+            added PVP parameters should also have been added to
+            metadata.pvp.addedPVP
+        """
+        dtype = metadata.pvp.numpy_dtype(self.getNumBytesPVPSet())
+        pvp_arrays = []
+        for channel in range(metadata.getNumChannels()):
+            array = numpy.empty(metadata.getNumVectors(channel), dtype=dtype)
+            if array.size:
+                self.getPVPdata(channel, array.__array_interface__['data'][0])
+            pvp_arrays.append(array)
+        return pvp_arrays
 
     @staticmethod
-    def _split_multi_format(fmt):
-        if ';' in fmt:
-            result = {}
-            for _fmt in fmt.split(';')[:fmt.count(';')]:
-                assert '=' in _fmt
-                name, __fmt = _fmt.split('=')
-                result[name] = __fmt
-            return result
-        return {'': fmt}
+    def from_numpy(pvp_arrays, metadata):
+        """Initialize and populate a PVPBlock from NumPy structured arrays.
+
+        Parameters
+        ----------
+        pvp_arrays: sequence of NumPy structured arrays
+            One array for each channel, laid out as returned by
+            PVPBlock.to_numpy() or CPHDReader.get_pvp_arrays().  Arrays
+            with the same fields but another layout or byte order are
+            converted first.
+        metadata: cphd.Metadata
+            Metadata used to create this PVPBlock
+
+        Returns
+        -------
+        pvp_block: cphd.PVPBlock
+        """
+        if len(pvp_arrays) != metadata.getNumChannels():
+            raise ValueError('Expected {0} channels of PVPs but received {1}'
+                             .format(metadata.getNumChannels(),
+                                     len(pvp_arrays)))
+
+        pvp_block = PVPBlock(metadata.pvp, metadata.data)
+        dtype = metadata.pvp.numpy_dtype(pvp_block.getNumBytesPVPSet())
+        for channel, array in enumerate(pvp_arrays):
+            if array.shape != (metadata.getNumVectors(channel),):
+                raise ValueError(
+                    'Expected {0} vectors of PVPs for channel {1} but '
+                    'received shape {2}'.format(
+                        metadata.getNumVectors(channel), channel,
+                        array.shape))
+            if array.dtype != dtype:
+                if array.dtype.names != dtype.names:
+                    raise ValueError(
+                        'PVP parameters for channel {0} do not match the '
+                        'metadata'.format(channel))
+                array = array.astype(dtype)
+            array = numpy.ascontiguousarray(array)
+            if array.size:
+                pvp_block.setPVPdata(channel,
+                                     array.__array_interface__['data'][0])
+        return pvp_block
+
+    @staticmethod
+    def _dict_keys(pvp):
+        """Map each list-of-dicts key to its (field, subfield)
+
+        Parameters whose values have different formats get a key for each
+        value, named by appending the value's name to the parameter's name
+        """
+        keys = {}
+        for parameter in pvp.getParameters():
+            name = parameter.getName()
+            dtype = Pvp._parameter_dtype(parameter.getFormat(), '=')
+            if '=' in parameter.getFormat() and dtype.names:
+                for subfield in dtype.names:
+                    keys[name + subfield] = (name, subfield)
+            else:
+                keys[name] = (name, None)
+        return keys
 
     def to_list_of_dicts(self, metadata):
         """Turn this PVPBlock into a list of Python dicts of NumPy arrays.
@@ -244,103 +378,24 @@ using six::Vector3;
             Each dictionary in the list corresponds to a CPHD data channel.
             The dictionary keys are string names of PVP parameters
             The dictionary values are NumPy arrays of shape
-              (metadata.getNumVectors(channel),metadata.getNumSamples(channel))
+              (metadata.getNumVectors(channel),) or, for parameters such as
+              'txPos' with several values,
+              (metadata.getNumVectors(channel), number of values)
+            Parameters whose values have different formats are split into
+              one entry per value, named by appending the value's name
             Any added PVP parameters should also have been added to
               metadata.pvp.addedPVP
         """
-        pvp_info = {}
-
-        # Methods to check if an optional PVP param is set
-        # Using .lower() since name capitalization is not 100% consistent
-        has_optional_param_methods = {name.lower(): getattr(self, name)
-                                      for name in dir(self)
-                                      if name.startswith('has')}
-
-        # Set required and optional PVP parameters
-        for name in dir(metadata.pvp):
-            try:
-                attr = getattr(metadata.pvp, name)
-            except AttributeError:
-                continue
-            if not isinstance(attr, pysix.cphd.PVPType):
-                continue
-            if attr.getSize() == 0:
-                continue
-            # Is this an optional parameter that is not set?
-            if ('has' + name.lower()) in has_optional_param_methods \
-                    and not has_optional_param_methods['has' + name.lower()]():
-                continue
-            pvp_info[name] = (
-                attr.getSize(), attr.getOffset(), attr.getFormat()
-            )
-        # Set any added PVP parameters
-        for name, added_pvp in metadata.pvp.addedPVP.items():
-            if added_pvp.getSize() == 0:
-                continue
-            PVPBlock._validate_pvp_format(added_pvp.getFormat())
-            pvp_info[name] = (added_pvp.getSize(),
-                              added_pvp.getOffset(),
-                              added_pvp.getFormat())
-
-        # Sort pvp_info by offset
-        from collections import OrderedDict  # SWIG won't import this above
-        sorted_pvp_info = OrderedDict(
-            sorted(pvp_info.items(), key=lambda item: item[1][1])
-        )
-
+        keys = PVPBlock._dict_keys(metadata.pvp)
         pvp_data = []
-        # Read data from each channel of this PVPBlock into list-of-dicts
-        for channel in range(metadata.getNumChannels()):
+        for array in self.to_numpy(metadata):
             channel_pvp = {}
-
-            num_vectors = metadata.getNumVectors(channel)
-            pvp_size = metadata.pvp.sizeInBytes()
-
-            channel_data = np.empty(
-                shape=num_vectors * pvp_size, dtype=np.bytes_
-            )
-            self.getPVPdata(
-                channel,channel_data.__array_interface__['data'][0]
-            )
-            channel_data = channel_data.reshape(num_vectors, pvp_size)
-
-            pvp_offset = 0
-            for name, (size, offset, fmt) in sorted_pvp_info.items():
-                suffix_to_format = PVPBlock._split_multi_format(fmt)
-
-                # Number of values in this parameter, not necessarily equal to
-                # _size (e.g. 'CF16' uses 2 8-byte words for 1 value)
-                # Store this in case suffix_to_format changes below
-                num_values = len(suffix_to_format)
-
-                # If a PVP has multiple parameters but all have the same
-                # format, collapse them into a single PVP. This is intended
-                # to simplify things like 'txPos', where it's more convenient
-                # to have an (N,3)-shape array than three length-N arrays
-                # for 'txPosX', 'txPosY', and 'txPosZ' separately.
-                _size = 1
-                formats = list(suffix_to_format.values())
-                if PVPBlock._common_format(formats):
-                    suffix_to_format = {'': formats[0]}
-                    _size = size
-
-                for suffix, _fmt in suffix_to_format.items():
-                    _name = name + suffix
-                    dtype = PVPBlock._format_to_dtype(_fmt)
-                    length = dtype.itemsize * num_values
-
-                    # For every vector (first index of channel_data), slice
-                    # the range with values for this parameter (second index)
-                    vals = channel_data[
-                        :, pvp_offset:(pvp_offset + length)
-                    ].copy().view(dtype)
-                    channel_pvp[_name] = vals.reshape(
-                        num_vectors, num_values
-                    ).squeeze()
-                    pvp_offset += 8 * _size  # Move to next 8-byte word
-
+            for name, (field, subfield) in keys.items():
+                values = array[field]
+                if subfield is not None:
+                    values = values[subfield]
+                channel_pvp[name] = values
             pvp_data.append(channel_pvp)
-
         return pvp_data
 
     @staticmethod
@@ -351,79 +406,28 @@ using six::Vector3;
         ----------
         pvp_data: list of Python dicts
             List of Python dicts (one for each channel) mapping parameter names
-            to NumPy arrays of data. See PVPBlock.toListOfDicts() for more info
-            on the structure expected here
+            to NumPy arrays of data. See PVPBlock.to_list_of_dicts() for more
+            info on the structure expected here
         metadata: cphd.Metadata
             Metadata used to create this PVPBlock
         """
-        pvp_block = PVPBlock(metadata.pvp, metadata.data)
-
-        # Methods to check if an optional PVP param is set
-        # Using .lower() since name capitalization is not 100% consistent
-        has_optional_param_methods = {name.lower(): getattr(pvp_block, name)
-                                      for name in dir(pvp_block)
-                                      if name.startswith('has')}
-
-        pvp_info = {}
-
-        # Set required and optional PVP parameters
-        for name in dir(metadata.pvp):
-            try:
-                attr = getattr(metadata.pvp, name)
-            except AttributeError:
-                continue
-            if not isinstance(attr, pysix.cphd.PVPType):
-                continue
-            if attr.getSize() == 0:
-                continue
-            # Is this an optional parameter that is not set?
-            if ('has' + name.lower()) in has_optional_param_methods \
-                    and not has_optional_param_methods['has' + name.lower()]():
-                continue
-            pvp_info[name] = (
-                attr.getSize(), attr.getOffset(), attr.getFormat()
-            )
-
-        # Using .lower() since name capitalization is not 100% consistent
-        default_params_in_use = [name.lower() for name in pvp_info]
-        default_param_setters = {
-            name[3:].lower(): getattr(pvp_block, name)
-            for name in dir(pvp_block)
-            if name.startswith('set')
-            and name[3:].lower() in default_params_in_use
-        }
-
-        # Populate PVPBlock object from pvp_data
-        for channel_index, channel_data in enumerate(pvp_data):
-            for vector_index in range(metadata.getNumVectors(channel_index)):
-                for name, data in channel_data.items():
-                    vector_data = data[vector_index]
-                    if isinstance(vector_data, numpy.ndarray):
-                        if len(vector_data) == 3:
-                            vector_data = coda.math_linear.Vector3(vector_data)
-                        else:
-                            raise ValueError(
-                                ('Only PVP parameters of size 1 or 3 are '
-                                 'supported, {0} has size {1}')
-                                .format(name, len(vector_data))
-                            )
-                    if 'numpy' in type(vector_data).__module__:
-                        # Change 1D arrays to scalars AND convert NumPy types
-                        # (e.g. np.int64) to Python types that SWIG understands
-                        vector_data = vector_data.item()
-                    if name not in metadata.pvp.addedPVP:
-                        # Get and call the setter method for this parameter
-                        # Use .lower() since capitalization isn't 100% the same
-                        default_param_setters[name.lower()](
-                            vector_data, channel_index, vector_index)
-                    else:
-                        param_format = metadata.pvp.addedPVP[name].getFormat()
-                        PVPBlock._validate_pvp_format(param_format)
-
-                        # Get and call setter method for the parameter type
-                        getattr(pvp_block, 'set' + param_format + 'AddedPVP')(
-                            vector_data, channel_index, vector_index, name)
-        return pvp_block
+        dtype = metadata.pvp.numpy_dtype()
+        keys = PVPBlock._dict_keys(metadata.pvp)
+        pvp_arrays = []
+        for channel, channel_pvp in enumerate(pvp_data):
+            array = numpy.zeros(metadata.getNumVectors(channel), dtype=dtype)
+            for name, values in channel_pvp.items():
+                if name not in keys:
+                    raise ValueError(
+                        'PVP parameter {0} is not in the metadata'
+                        .format(name))
+                field, subfield = keys[name]
+                if subfield is None:
+                    array[field] = values
+                else:
+                    array[field][subfield] = values
+            pvp_arrays.append(array)
+        return PVPBlock.from_numpy(pvp_arrays, metadata)
 %}
 }
 
@@ -452,6 +456,67 @@ using six::Vector3;
 
 %extend cphd::CPHDReader
 {
+    // Address of a channel's undecoded PVP sets, or 0 if the reader
+    // loaded the PVP block instead of viewing it
+    size_t getPVPViewData(size_t channel)
+    {
+        try
+        {
+            return reinterpret_cast<size_t>(
+                    $self->getPVPView().getPVPdata(channel));
+        }
+        catch (const except::Exception&)
+        {
+            return 0;
+        }
+    }
+
+%pythoncode
+%{
+
+    import numpy  # 'as np' doesn't work unless the import is in each method
+
+    def get_pvp_arrays(self):
+        """Get the PVPs as NumPy structured arrays, one per channel.
+
+        If the reader was opened with VIEW_PVP, the arrays are read-only,
+        zero-copy views of the PVP block as it is stored in the file, with
+        big-endian fields.  They keep the reader open while they exist.
+        Otherwise, the loaded PVPBlock is copied into native-endian arrays.
+        Either way, the dtype is metadata.pvp.numpy_dtype().
+
+        Returns
+        -------
+        pvp_arrays: list of NumPy structured arrays
+        """
+        metadata = self.getMetadata()
+        num_bytes = metadata.data.getNumBytesPVPSet()
+        if metadata.getNumChannels() == 0 or not self.getPVPViewData(0):
+            return self.getPVPBlock().to_numpy(metadata)
+
+        dtype = metadata.pvp.numpy_dtype(num_bytes, '>')
+        pvp_arrays = []
+        for channel in range(metadata.getNumChannels()):
+            num_vectors = metadata.getNumVectors(channel)
+            if num_vectors == 0:
+                pvp_arrays.append(numpy.empty(0, dtype=dtype))
+                continue
+            raw = numpy.asarray(CPHDReader._PVPBuffer(
+                self, self.getPVPViewData(channel), num_vectors * num_bytes))
+            pvp_arrays.append(raw.view(dtype))
+        return pvp_arrays
+
+    class _PVPBuffer(object):
+        """Exposes a read-only block of PVP bytes to NumPy"""
+        def __init__(self, reader, address, size):
+            # Holding the reader keeps the block alive
+            self.reader = reader
+            self.__array_interface__ = {'shape': (size,),
+                                        'typestr': '|u1',
+                                        'data': (address, True),
+                                        'version': 3}
+%}
+
     PyObject* getPHD(size_t channel)
     {
         const auto& wb = self->getWideband();
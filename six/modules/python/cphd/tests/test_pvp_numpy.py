@@ -0,0 +1,94 @@
+#!/usr/bin/env python
+
+#
+# =========================================================================
+# This file is part of cphd-python
+# =========================================================================
+#
+# (C) Copyright 2004 - 2020, MDA Information Systems LLC
+#
+# cphd-python is free software; you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this program; If not,
+# see <http://www.gnu.org/licenses/>.
+#
+
+# In general, if functionality in CPHD is borrowed from six.sicd,
+# refer to six.sicd's test script for more verification
+
+import os
+import sys
+import tempfile
+
+import numpy as np
+
+from pysix.cphd import PVPBlock, CPHDWriter, CPHDReader
+from coda.coda_types import VectorString
+
+from util import get_test_metadata, get_test_pvp_data, get_test_widebands
+
+
+def arrays_equal(lhs, rhs):
+    # Compare field by field, since byte order may differ
+    return lhs.shape == rhs.shape and lhs.dtype.names == rhs.dtype.names and \
+        all(np.array_equal(lhs[name], rhs[name]) for name in lhs.dtype.names)
+
+
+def main():
+    metadata, support_arrays = get_test_metadata(has_support_array=True, is_compressed=False)
+    pvp_block = PVPBlock.from_list_of_dicts(get_test_pvp_data(metadata), metadata)
+
+    # Round trip through structured arrays
+    pvp_arrays = pvp_block.to_numpy(metadata)
+    if len(pvp_arrays) != metadata.getNumChannels():
+        print('Test failed: expected {0} channels but received {1} from PVPBlock.to_numpy()'
+              .format(metadata.getNumChannels(), len(pvp_arrays)))
+        sys.exit(1)
+    if PVPBlock.from_numpy(pvp_arrays, metadata) != pvp_block:
+        print('Test failed: PVPBlock.from_numpy() differs from the original PVPBlock')
+        sys.exit(1)
+
+    # Fields match the list of dicts
+    pvp_data = pvp_block.to_list_of_dicts(metadata)
+    for channel in range(metadata.getNumChannels()):
+        for param in pvp_data[channel]:
+            if not np.array_equal(pvp_data[channel][param], pvp_arrays[channel][param]):
+                print('Test failed: PVP data differs for parameter {0}, channel {1}'
+                      .format(param, channel))
+                sys.exit(1)
+
+    schema_paths = VectorString()
+    schema_paths.push_back(os.environ['SIX_SCHEMA_PATH'])
+
+    with tempfile.NamedTemporaryFile() as temp_file:
+        cphd_filepath = temp_file.name
+        cphd_writer = CPHDWriter(metadata, cphd_filepath, schema_paths, 1)
+        cphd_writer.writeWideband(metadata, pvp_block, get_test_widebands(metadata),
+                                  support_arrays)
+        del cphd_writer
+
+        # Both reader modes produce the same arrays
+        for pvp_mode in (CPHDReader.LOAD_PVP, CPHDReader.VIEW_PVP):
+            reader = CPHDReader(cphd_filepath, 1, pvp_mode)
+            file_arrays = reader.get_pvp_arrays()
+            del reader  # The arrays keep the reader alive
+            for channel in range(metadata.getNumChannels()):
+                if not arrays_equal(file_arrays[channel], pvp_arrays[channel]):
+                    print('Test failed: PVPs from file differ for channel {0}'
+                          .format(channel))
+                    sys.exit(1)
+
+    print('Test passed')
+
+
+if __name__ == '__main__':
+    main()
@@ -37,6 +37,7 @@
 #include "import/six/sicd.h"
 #include "six/sicd/AreaPlaneUtility.h"
 #include "six/sicd/GeoLocator.h"
+#include "six/sicd/SICDReader.h"
 #include "six/sicd/SICDWriteControl.h"
 #include "six/sicd/Utilities.h"
 #include <numpyutils/numpyutils.h>
@@ -45,6 +46,23 @@
 using namespace six::sicd;
 using namespace six;
 
+/* Lets other Python threads run until it goes out of scope */
+class ReleaseGIL
+{
+public:
+    ReleaseGIL() : mState(PyEval_SaveThread())
+    {
+    }
+
+    ~ReleaseGIL()
+    {
+        PyEval_RestoreThread(mState);
+    }
+
+private:
+    PyThreadState* mState;
+};
+
 six::sicd::ComplexData * asComplexData(six::Data* data);
 
 /* Need this because we can't really do it on the python side of things */
@@ -289,6 +307,10 @@ def schema_path():
 %include "six/sicd/AreaPlaneUtility.h"
 %include "six/sicd/GeoLocator.h"
 
+%rename(_getComplexData) six::sicd::SICDReader::getComplexData;
+%ignore six::sicd::SICDReader::readRegion;
+%include "six/sicd/SICDReader.h"
+
 /* We need this because SWIG cannot do it itself, for some reason */
 /* TODO: write script to generate all of these instantiations for us? */
 
@@ -450,6 +472,64 @@ def readFromNITF(pathname, schemaPaths=VectorString()):
     }
 }
 
+%extend six::sicd::SICDReader
+{
+    void _readRegion(long long startRow, long long numRows,
+                     long long startCol, long long numCols,
+                     long long arrayBuffer)
+    {
+        std::complex<float>* const buffer =
+                reinterpret_cast<std::complex<float>* >(arrayBuffer);
+        const types::RowCol<size_t> offset(startRow, startCol);
+        const types::RowCol<size_t> extent(numRows, numCols);
+
+        ReleaseGIL releaseGIL;
+        $self->readRegion(offset, extent, buffer);
+    }
+
+    %pythoncode
+    %{
+        def getComplexData(self):
+            """Return the SICD's ComplexData, which lives as long as the
+            reader does"""
+            complexData = self._getComplexData()
+            complexData._reader = self
+            return complexData
+
+        def read_region(self, start_row, num_rows, start_col, num_cols,
+                        out=None):
+            """Read a region of the image as complex64
+
+            Other Python threads keep running during the read, and several
+            threads may read from the same reader at once.
+
+            Args:
+                start_row, num_rows, start_col, num_cols: The region to read
+                out: (Optional) C-contiguous complex64 array of shape
+                    (num_rows, num_cols) to read into, rather than
+                    allocating a new one
+
+            Returns:
+                The region's pixels
+            """
+            if min(start_row, num_rows, start_col, num_cols) < 0:
+                raise ValueError('Region must not be negative')
+
+            shape = (num_rows, num_cols)
+            if out is None:
+                out = np.empty(shape, dtype='complex64')
+            elif (out.dtype != np.complex64 or out.shape != shape or
+                    not out.flags['C_CONTIGUOUS'] or
+                    not out.flags['WRITEABLE']):
+                raise ValueError('out must be a writeable, C-contiguous '
+                                 'complex64 array of shape {0}'.format(shape))
+
+            self._readRegion(start_row, num_rows, start_col, num_cols,
+                             out.__array_interface__['data'][0])
+            return out
+    %}
+}
+
 %extend nitf::Record
 {
     nitf::ImageSegment getImageSegment(size_t index)
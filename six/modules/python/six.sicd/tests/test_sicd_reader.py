@@ -0,0 +1,113 @@
+#!/user/bin/env/python
+#
+# =========================================================================
+# This file is part of six.sicd-python
+# =========================================================================
+#
+# (C) Copyright 2004 - 2019, MDA Information Systems LLC
+#
+# six.sicd-python is free software; you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this program; If not,
+# see <http://www.gnu.org/licenses/>.
+#
+
+import os
+import subprocess
+import sys
+import threading
+
+import numpy as np
+
+from pysix.six_sicd import SICDReader, read
+
+
+def createNITF():
+    location = os.path.split(os.path.realpath(__file__))[0]
+    testPath = os.path.join(location, 'test_create_sicd_xml.py')
+    subprocess.call(['python', testPath, '--includeNITF'])
+    return os.path.join(os.getcwd(), 'test_create_sicd.nitf')
+
+
+def clean(pathname):
+    basename = os.path.splitext(pathname)[0]
+    for extension in ['.nitf', '.xml']:
+        os.remove(basename + extension)
+        os.remove(basename + '_rt' + extension)
+
+
+def testRegions(reader, expectedArray):
+    numRows, numCols = expectedArray.shape
+    assert (reader.read_region(0, numRows, 0, numCols) ==
+            expectedArray).all()
+
+    # Reuse one buffer for every chip
+    chip = np.empty((numRows // 2, numCols // 2), dtype='complex64')
+    for startRow in range(0, numRows - chip.shape[0] + 1, 3):
+        startCol = (startRow * 7) % (numCols - chip.shape[1] + 1)
+        result = reader.read_region(startRow, chip.shape[0],
+                                    startCol, chip.shape[1], out=chip)
+        assert result is chip
+        assert (chip == expectedArray[startRow:startRow + chip.shape[0],
+                                      startCol:startCol + chip.shape[1]]).all()
+
+    for badOut in [np.empty(chip.shape, dtype='complex128'),
+                   np.empty((chip.shape[0] + 1, chip.shape[1]),
+                            dtype='complex64'),
+                   np.empty((chip.shape[1], chip.shape[0]),
+                            dtype='complex64').T]:
+        try:
+            reader.read_region(0, chip.shape[0], 0, chip.shape[1], out=badOut)
+            assert False
+        except ValueError:
+            pass
+
+
+def testThreads(reader, expectedArray):
+    numRows, numCols = expectedArray.shape
+    failures = []
+
+    def readChips(threadNum):
+        for startRow in range(threadNum, numRows // 2, 4):
+            chip = reader.read_region(startRow, numRows // 2, 0, numCols)
+            if not (chip == expectedArray[startRow:startRow + numRows // 2,
+                                          :]).all():
+                failures.append(startRow)
+
+    threads = [threading.Thread(target=readChips, args=(ii,))
+               for ii in range(4)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    assert not failures
+
+
+if __name__ == '__main__':
+    pathname = createNITF()
+    assert os.path.exists(pathname)
+    expectedArray, expectedData = read(pathname)
+    try:
+        reader = SICDReader(pathname)
+        assert reader.getComplexData() == expectedData
+        testRegions(reader, expectedArray)
+        testThreads(reader, expectedArray)
+        del reader
+    except AssertionError:
+        print('SICDReader read the wrong pixels. Test failed')
+        sys.exit(1)
+    except Exception as e:
+        sys.exit(repr(e))
+    finally:
+        clean(pathname)
+    print('Test passed')
+    sys.exit(0)